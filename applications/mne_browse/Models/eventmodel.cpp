@@ -371,6 +371,7 @@ bool EventModel::loadEventData(QFile& qFile)
 
     if(!MNE::read_events(qFile, events)) {
         qDebug() << "Error while reading events.";
+        endResetModel();
         return false;
     }
 
@@ -378,6 +379,50 @@ bool EventModel::loadEventData(QFile& qFile)
 
     qDebug() << QString("Events read from %1").arg(qFile.fileName());
 
+    setEventData(events);
+
+    endResetModel();
+
+    m_bFileloaded = true;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool EventModel::loadEventIndex(const QString& sRawFileName)
+{
+    beginResetModel();
+    clearModel();
+
+    //Only the trigger channel is decoded, the raw file is opened separately from the one of the raw model
+    QFile t_fileRaw(sRawFileName);
+    FiffRawData raw(t_fileRaw);
+    FiffEventIndex eventIndex;
+
+    if(raw.rawdir.isEmpty() || !eventIndex.load_or_build(raw)) {
+        qDebug() << "Error while building the trigger event index.";
+        endResetModel();
+        return false;
+    }
+
+    qDebug() << QString("Trigger events of %1 read from channel %2").arg(sRawFileName).arg(eventIndex.trigger_channel());
+
+    setEventData(eventIndex.events());
+
+    endResetModel();
+
+    m_bFileloaded = true;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void EventModel::setEventData(const MatrixXi& events)
+{
     //set loaded fiff event data
     for(int i = 0; i < events.rows(); i++) {
         m_dataSamples.append(events(i,0));
@@ -397,12 +442,6 @@ bool EventModel::loadEventData(QFile& qFile)
             m_eventTypeList<<QString().number(m_dataTypes[i]);
 
     emit updateEventTypes("All");
-
-    endResetModel();
-
-    m_bFileloaded = true;
-
-    return true;
 }
 
 
@@ -71,6 +71,7 @@
 //=============================================================================================================
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_event_index.h>
 #include <mne/mne.h>
 
 
@@ -135,6 +136,15 @@ public:
     */
     bool loadEventData(QFile& qFile);
 
+    //=========================================================================================================
+    /**
+    * loadEventIndex loads the trigger events of a fiff raw data file. The trigger index is read from the event file
+    * next to the raw file if it is up to date, otherwise it is built in one pass over the trigger channel and stored.
+    *
+    * @param sRawFileName fiff raw data file to take the trigger events from
+    */
+    bool loadEventIndex(const QString& sRawFileName);
+
     //=========================================================================================================
     /**
     * saveEventData saves events to a fiff event data file
@@ -223,6 +233,14 @@ public:
     bool            m_bFileloaded;              /**< True when a Fiff event file is loaded. */
 
 private:
+    //=========================================================================================================
+    /**
+    * setEventData replaces the loaded events, the caller resets the model
+    *
+    * @param events the events in MNE format, column 0 holds the samples and column 2 the types
+    */
+    void setEventData(const MatrixXi& events);
+
     QVector<int>        m_dataSamples;              /**< Vector that holds the sample alues for each loaded event. */
     QVector<int>        m_dataTypes;                /**< Vector that holds the type alues for each loaded event. */
     QVector<int>        m_dataIsUserEvent;          /**< Vector that holds the flag whether the event is user defined or loaded from file. */
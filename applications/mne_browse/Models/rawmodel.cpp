@@ -78,9 +78,14 @@ RawModel::RawModel(QObject *parent)
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
 , m_filterChType("All")
 , m_bReloadBefore(0)
+, m_tileCache((qint64)MODEL_TILE_CACHE_SIZE*1024*1024)
+, m_iOperatorRevision(0)
+, m_iDataRevision(0)
 , m_iAbsFiffCursor(0)
 , m_iCurAbsScrollPos(0)
 {
+    m_tileThreadPool.setMaxThreadCount(MODEL_TILE_THREADS);
+
     m_iWindowSize = MODEL_WINDOW_SIZE;
     m_reloadPos = MODEL_RELOAD_POS;
     m_maxWindows = MODEL_MAX_WINDOWS;
@@ -93,8 +98,11 @@ RawModel::RawModel(QObject *parent)
     genStdFilterOps();
 
     //connect data reloading - this is done concurrently
-    connect(&m_reloadFutureWatcher,&QFutureWatcher<QPair<MatrixXd,MatrixXd> >::finished,[this](){
-        insertReloadedData(m_reloadFutureWatcher.future().result());
+    connect(&m_reloadFutureWatcher,&QFutureWatcher<QPair<qint32,QSharedPointer<DataPackage> > >::finished,[this](){
+        QPair<qint32,QSharedPointer<DataPackage> > result = m_reloadFutureWatcher.future().result();
+        qint32 iProcRevision;
+        m_tileCache.tile(result.first, iProcRevision);
+        insertReloadedData(result.first, result.second, iProcRevision == m_iOperatorRevision);
     });
 
     //connect filtering reloading - this is done after a new block has been loaded
@@ -127,7 +135,12 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
 , m_filterChType("All")
+, m_tileCache((qint64)MODEL_TILE_CACHE_SIZE*1024*1024)
+, m_iOperatorRevision(0)
+, m_iDataRevision(0)
 {
+    m_tileThreadPool.setMaxThreadCount(MODEL_TILE_THREADS);
+
     m_iWindowSize = MODEL_WINDOW_SIZE;
     m_reloadPos = MODEL_RELOAD_POS;
     m_maxWindows = MODEL_MAX_WINDOWS;
@@ -140,8 +153,11 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
     genStdFilterOps();
 
     //connect signal and slots
-    connect(&m_reloadFutureWatcher,&QFutureWatcher<QPair<MatrixXd,MatrixXd> >::finished,[this](){
-        insertReloadedData(m_reloadFutureWatcher.future().result());
+    connect(&m_reloadFutureWatcher,&QFutureWatcher<QPair<qint32,QSharedPointer<DataPackage> > >::finished,[this](){
+        QPair<qint32,QSharedPointer<DataPackage> > result = m_reloadFutureWatcher.future().result();
+        qint32 iProcRevision;
+        m_tileCache.tile(result.first, iProcRevision);
+        insertReloadedData(result.first, result.second, iProcRevision == m_iOperatorRevision);
     });
 
     connect(this,&RawModel::dataReloaded,[this](){
@@ -161,6 +177,17 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 }
 
 
+//*************************************************************************************************************
+
+RawModel::~RawModel()
+{
+    //the tile jobs and the operator processing access the members of this model
+    invalidateTiles();
+    m_tileThreadPool.waitForDone();
+    m_operatorFutureWatcher.waitForFinished();
+}
+
+
 //*************************************************************************************************************
 //virtual functions
 int RawModel::rowCount(const QModelIndex & /*parent*/) const
@@ -410,8 +437,12 @@ bool RawModel::loadFiffData(QFile* qFile)
     loadFiffInfos();
     genStdFilterOps();
 
+    m_tileCache.insert(0, newDataPackage, m_iOperatorRevision);
+
     endResetModel();
 
+    prefetchTiles();
+
     qFile->close();
 
     emit fileLoaded(m_pFiffInfo);
@@ -460,6 +491,9 @@ bool RawModel::writeFiffData(QIODevice *p_IODevice)
             return false;
         }
 
+        if(m_pProjOperator)
+            data = m_pProjOperator->apply(data);
+
         qDebug("Writing...");
         if (first_buffer) {
            if (first > 0)
@@ -496,9 +530,14 @@ void RawModel::loadFiffInfos()
 
 void RawModel::clearModel()
 {
+    //Tiles - wait for the background loading to finish since it accesses the FiffIO object
+    invalidateTiles();
+    m_tileThreadPool.waitForDone();
+
     //FiffIO object
     m_pfiffIO.clear();
     m_chInfolist.clear();
+    m_pProjOperator.clear();
 
     //data model structure
     m_data.clear();
@@ -530,30 +569,34 @@ void RawModel::resetPosition(qint32 position)
     m_bReloading = false;
     m_bProcessing = false;
 
-    //calculate multiple integer of m_iWindowSize from beginning of Fiff file (rounded down)
-    qint32 distance = position - firstSample();
-    qint32 mult = floor(distance / m_iWindowSize);
+    //calculate multiple integer of m_iWindowSize from beginning of Fiff file (rounded down), i.e. the tile which contains position
+    qint32 iTileIndex = tileIndex(qMax(position, firstSample()));
 
-    m_iAbsFiffCursor = firstSample() + mult*m_iWindowSize;
+    m_iAbsFiffCursor = firstSample() + iTileIndex*m_iWindowSize;
 
-    MatrixXd t_data,t_times; //type is later on (when append to m_data) casted into MatrixXdR (Row-Major)
+    //serve the tile from the cache if possible, otherwise read it from the fiff file
+    qint32 iProcRevision;
+    QSharedPointer<DataPackage> newDataPackage = m_tileCache.tile(iTileIndex, iProcRevision);
 
-    int start = m_iAbsFiffCursor;
-    int end = start + m_iWindowSize - 1;
+    if(!newDataPackage) {
+        int start = m_iAbsFiffCursor;
+        int end = qMin(start + m_iWindowSize - 1, lastSample());
 
-    m_Mutex.lock();
-    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(t_data, t_times, start, end))
-        qDebug() << "RawModel: Error resetting position of Fiff file!";
-    m_Mutex.unlock();
+        QPair<MatrixXd,MatrixXd> datatime = readSegment(start, end);
+        if(datatime.first.size() == 0)
+            qDebug() << "RawModel: Error resetting position of Fiff file!";
 
-    //build data package
-    QSharedPointer<DataPackage> newDataPackage;
-    newDataPackage = QSharedPointer<DataPackage>(new DataPackage((MatrixXdR)t_data, (MatrixXdR)t_times));
+        //build data package
+        newDataPackage = QSharedPointer<DataPackage>(new DataPackage((MatrixXdR)datatime.first, (MatrixXdR)datatime.second));
+        iProcRevision = -1;
+
+        m_tileCache.insert(iTileIndex, newDataPackage, iProcRevision);
+    }
 
     //append loaded block
     m_data.append(newDataPackage);
 
-    if(!m_assignedOperators.empty())
+    if(!m_assignedOperators.empty() && iProcRevision != m_iOperatorRevision)
         updateOperators();
 
     endResetModel();
@@ -561,9 +604,11 @@ void RawModel::resetPosition(qint32 position)
 //    if(!(m_iAbsFiffCursor<=firstSample()))
 //        updateScrollPos(m_iCurAbsScrollPos-firstSample()); //little hack: if the m_iCurAbsScrollPos is now close to the edge -> force reloading w/o scrolling
 
-    qDebug() << "RawModel: Model Position RESET, samples from " << m_iAbsFiffCursor << "to" << m_iAbsFiffCursor+m_iWindowSize-1 << "reloaded. actual loaded t_data cols: " << t_data.cols();
+    qDebug() << "RawModel: Model Position RESET, samples from " << m_iAbsFiffCursor << "to" << m_iAbsFiffCursor+m_iWindowSize-1 << "reloaded. actual loaded data cols: " << newDataPackage->dataRaw().cols();
 
     emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
+
+    prefetchTiles();
 }
 
 
@@ -609,8 +654,28 @@ void RawModel::reloadFiffData(bool before)
 
     m_bReloading = true;
 
+    //serve the tile from the cache if possible
+    qint32 iTileIndex = tileIndex(start);
+    qint32 iProcRevision;
+    QSharedPointer<DataPackage> pTile = m_tileCache.tile(iTileIndex, iProcRevision);
+
+    if(pTile) {
+        insertReloadedData(iTileIndex, pTile, iProcRevision == m_iOperatorRevision);
+        return;
+    }
+
     //read data with respect to start and end point
-    QFuture<QPair<MatrixXd,MatrixXd> > future = QtConcurrent::run(this,&RawModel::readSegment,start,end);
+    //all inputs are copied, the thread does not touch the members which are modified by the GUI thread
+    QMap<int,QSharedPointer<MNEOperator> > assignedOperators = m_assignedOperators;
+    qint32 iOperatorRevision = m_iOperatorRevision;
+    int iDataRevision = m_iDataRevision.load();
+    qint32 iWindowSize = m_iWindowSize;
+    int iFFTLength = m_iCurrentFFTLength;
+
+    QFuture<QPair<qint32,QSharedPointer<DataPackage> > > future = QtConcurrent::run(&m_tileThreadPool,
+                                                                                     [this, iTileIndex, assignedOperators, iOperatorRevision, iDataRevision, iWindowSize, iFFTLength]() {
+        return loadTile(iTileIndex, assignedOperators, iOperatorRevision, iDataRevision, iWindowSize, iFFTLength);
+    });
 
     //Wait for thread reloading is finished, then insert reloaded data
     //future.waitForFinished();
@@ -626,17 +691,157 @@ QPair<MatrixXd,MatrixXd> RawModel::readSegment(fiff_int_t from, fiff_int_t to)
 {
     QPair<MatrixXd,MatrixXd> datatime;
 
-    m_Mutex.lock();
+    QMutexLocker locker(&m_Mutex);
     if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(datatime.first, datatime.second, from, to)) {
         printf("RawModel: Error when reading raw data!");
         return datatime;
     }
-    m_Mutex.unlock();
+
+    //apply the projector in its low-rank form, which is cheaper than the dense projector read_raw_segment would use
+    if(m_pProjOperator)
+        datatime.first = m_pProjOperator->apply(datatime.first);
 
     return datatime;
 }
 
 
+//*************************************************************************************************************
+
+QPair<qint32,QSharedPointer<DataPackage> > RawModel::loadTile(qint32 iTileIndex, QMap<int,QSharedPointer<MNEOperator> > assignedOperators, qint32 iOperatorRevision, int iDataRevision, qint32 iWindowSize, int iFFTLength)
+{
+    QPair<qint32,QSharedPointer<DataPackage> > result(iTileIndex, QSharedPointer<DataPackage>());
+
+    //the tile might have been loaded by a prefetch meanwhile
+    qint32 iProcRevision;
+    QSharedPointer<DataPackage> pTile = m_tileCache.tile(iTileIndex, iProcRevision);
+
+    if(!pTile) {
+        fiff_int_t from = firstSample() + iTileIndex*iWindowSize;
+        fiff_int_t to = qMin(from + iWindowSize - 1, lastSample());
+
+        if(from > to)
+            return result;
+
+        QPair<MatrixXd,MatrixXd> datatime = readSegment(from, to);
+
+        if(datatime.first.cols() == 0)
+            return result;
+
+        pTile = QSharedPointer<DataPackage>(new DataPackage((MatrixXdR)datatime.first, (MatrixXdR)datatime.second));
+        iProcRevision = -1;
+    }
+    else if(iProcRevision != iOperatorRevision && !assignedOperators.empty()) {
+        //a cached tile might be displayed and modified by the GUI thread at the moment -> process a copy of it
+        QMutexLocker locker(&m_tileDataMutex);
+        pTile = QSharedPointer<DataPackage>(new DataPackage(*pTile));
+    }
+
+    //pTile is only seen by this thread from here on
+    if(iProcRevision != iOperatorRevision)
+        processTile(pTile, assignedOperators, iFFTLength);
+
+    //discard the tile if the projector or compensator changed while loading
+    if(iDataRevision != m_iDataRevision.load())
+        return result;
+
+    m_tileCache.insert(iTileIndex, pTile, iOperatorRevision);
+
+    result.second = pTile;
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::processTile(QSharedPointer<DataPackage> pTile, const QMap<int,QSharedPointer<MNEOperator> > &assignedOperators, int iFFTLength) const
+{
+    QList<int> listFilteredChs = assignedOperators.uniqueKeys();
+
+    int dataLength = pTile->dataRaw().cols();
+
+    for(int i = 0; i < listFilteredChs.size(); ++i) {
+        QPair<int,RowVectorXd> chdata(listFilteredChs[i], pTile->dataRawOrig().row(listFilteredChs[i]));
+        applyOperators(chdata, assignedOperators);
+
+        int cutFront = iFFTLength/4;
+        int cutBack = iFFTLength/4 + (chdata.second.cols()-iFFTLength/2-dataLength);
+
+        pTile->setOrigProcData(chdata.second, chdata.first, cutFront, cutBack);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::prefetchTiles()
+{
+    if(!m_bFileloaded || m_data.empty())
+        return;
+
+    qint32 iFirstTile = tileIndex(m_iAbsFiffCursor);
+    qint32 iLastTile = iFirstTile + m_data.size() - 1;
+    qint32 iMaxTile = tileIndex(lastSample());
+
+    QList<qint32> listTiles;
+    for(qint32 i = 1; i <= MODEL_PREFETCH_TILES; ++i) {
+        listTiles << iLastTile + i << iFirstTile - i;
+    }
+
+    QMap<int,QSharedPointer<MNEOperator> > assignedOperators = m_assignedOperators;
+    qint32 iOperatorRevision = m_iOperatorRevision;
+    int iDataRevision = m_iDataRevision.load();
+    qint32 iWindowSize = m_iWindowSize;
+    int iFFTLength = m_iCurrentFFTLength;
+
+    for(int i = 0; i < listTiles.size(); ++i) {
+        qint32 iTileIndex = listTiles[i];
+
+        if(iTileIndex < 0 || iTileIndex > iMaxTile)
+            continue;
+
+        qint32 iProcRevision;
+        if(m_tileCache.tile(iTileIndex, iProcRevision) && iProcRevision == iOperatorRevision)
+            continue;
+
+        m_pendingMutex.lock();
+        bool bPending = m_setPendingTiles.contains(iTileIndex);
+        if(!bPending)
+            m_setPendingTiles.insert(iTileIndex);
+        m_pendingMutex.unlock();
+
+        if(bPending)
+            continue;
+
+        QtConcurrent::run(&m_tileThreadPool, [this, iTileIndex, assignedOperators, iOperatorRevision, iDataRevision, iWindowSize, iFFTLength]() {
+            loadTile(iTileIndex, assignedOperators, iOperatorRevision, iDataRevision, iWindowSize, iFFTLength);
+
+            QMutexLocker locker(&m_pendingMutex);
+            m_setPendingTiles.remove(iTileIndex);
+        });
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::invalidateTiles()
+{
+    m_iDataRevision.ref();
+    m_tileCache.clear();
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::invalidateProcessedTiles()
+{
+    ++m_iOperatorRevision;
+
+    //the currently loaded windows are refiltered by the caller, the neighbouring tiles in the background
+    prefetchTiles();
+}
+
+
 //*************************************************************************************************************
 //public SLOTS
 void RawModel::updateScrollPos(int value)
@@ -715,6 +920,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
+    invalidateProcessedTiles();
+
     m_bProcessing = true;
 
     for(int i=0; i<m_data.size(); i++)
@@ -753,6 +960,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
+    invalidateProcessedTiles();
+
     m_bProcessing = true;
 
     for(int i=0; i<m_data.size(); i++)
@@ -772,11 +981,17 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
 
 void RawModel::applyOperatorsConcurrently(QPair<int,RowVectorXd>& chdata) const
 {
-    QSharedPointer<FilterOperator> filter;
+    applyOperators(chdata, m_assignedOperators);
+}
+
 
-    //QList<int> listFilteredChs = m_assignedOperators.keys();
+//*************************************************************************************************************
 
-    QList<QSharedPointer<MNEOperator> > ops = m_assignedOperators.values(chdata.first);
+void RawModel::applyOperators(QPair<int,RowVectorXd>& chdata, const QMap<int,QSharedPointer<MNEOperator> > &assignedOperators)
+{
+    QSharedPointer<FilterOperator> filter;
+
+    QList<QSharedPointer<MNEOperator> > ops = assignedOperators.values(chdata.first);
     for(qint32 i=0; i < ops.size(); ++i) {
         switch(ops[i]->m_OperatorType) {
         case MNEOperator::FILTER: {
@@ -864,6 +1079,7 @@ void RawModel::undoFilter(QModelIndexList chlist, const QSharedPointer<MNEOperat
                 it.next();
                 if(it.key()==chlist[i].row() && it.value()==filterPtr) {
                     it.remove();
+                    invalidateProcessedTiles();
                     qDebug() << "RawModel: Filter operator removed of type" << filterPtr->m_sName << "for channel" << chlist[i].row();
                     updateOperators(chlist[i]);
                     continue;
@@ -890,6 +1106,8 @@ void RawModel::undoFilter(QModelIndexList chlist)
         qDebug() << "RawModel: All filter operator removed of type for channel" << chlist[i].row();
     }
 
+    invalidateProcessedTiles();
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -905,6 +1123,8 @@ void RawModel::undoFilter(const QString &chType)
         for(qint32 i=0; i < m_chInfolist.size(); ++i)
             if(m_chInfolist.at(i).ch_name.contains(chType))
                 m_assignedOperators.remove(i);
+
+        invalidateProcessedTiles();
     }
 
     emit assignedOperatorsChanged(m_assignedOperators);
@@ -917,6 +1137,8 @@ void RawModel::undoFilter()
 {
     m_assignedOperators.clear();
 
+    invalidateProcessedTiles();
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -939,9 +1161,10 @@ void RawModel::updateProjections()
 
         if(bProjActivated)
         {
-            MatrixXd matProj;
-            qint32 nproj = this->m_pFiffInfo->make_projector(matProj);
-            qDebug() << "updateProjection :: New projection calculated."<<nproj;
+            //the operator is cached by the fiff info, unchanged projectors are not recomputed. The compensation is
+            //applied by read_raw_segment, see updateCompensator
+            FiffProjCompOperator::ConstSPtr pOperator = this->m_pFiffInfo->proj_comp_operator();
+            qDebug() << "updateProjection :: New projection calculated."<<pOperator->nproj();
 
             //set columns of matrix to zero depending on bad channels indexes
     //        for(qint32 j = 0; j < m_vecBadIdcs.cols(); ++j)
@@ -969,12 +1192,17 @@ void RawModel::updateProjections()
 //            if(tripletList.size() > 0)
 //                matSparseProj.setFromTriplets(tripletList.begin(), tripletList.end());
 
-            //set projection matrix for upcoming read raw segement calls
-            m_pfiffIO->m_qlistRaw[0]->proj = matProj;
+            //set projector for upcoming readSegment calls
+            QMutexLocker locker(&m_Mutex);
+            m_pProjOperator = pOperator;
         } else {
-            m_pfiffIO->m_qlistRaw[0]->proj.resize(0,0);
+            QMutexLocker locker(&m_Mutex);
+            m_pProjOperator.clear();
         }
 
+        //all cached tiles were read with the old projector
+        invalidateTiles();
+
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
         else
@@ -1006,7 +1234,12 @@ void RawModel::updateCompensator(int to)
         this->m_pFiffInfo->set_current_comp(to);
 
         //set compensator for upcoming read raw segement calls
+        m_Mutex.lock();
         m_pfiffIO->m_qlistRaw[0]->comp = newComp;
+        m_Mutex.unlock();
+
+        //all cached tiles were read with the old compensator
+        invalidateTiles();
 
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
@@ -1018,9 +1251,19 @@ void RawModel::updateCompensator(int to)
 
 //*************************************************************************************************************
 //private SLOTS
-void RawModel::insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair)
+void RawModel::insertReloadedData(qint32 iTileIndex, const QSharedPointer<DataPackage> &newDataPackage, bool bProcessed)
 {
-    QSharedPointer<DataPackage> newDataPackage = QSharedPointer<DataPackage>(new DataPackage((MatrixXdR)dataTimesPair.first, (MatrixXdR)dataTimesPair.second));
+    //discard the tile if loading failed or if it does not border the loaded data anymore, i.e. because the position was reset meanwhile
+    qint32 iExpectedTile = m_bReloadBefore ? tileIndex(m_iAbsFiffCursor) : tileIndex(m_iAbsFiffCursor) + m_data.size();
+
+    if(!newDataPackage || m_data.empty() || iTileIndex != iExpectedTile) {
+        //undo the cursor movement of reloadFiffData if the tile in front could not be loaded
+        if(m_bReloadBefore && iTileIndex == iExpectedTile)
+            m_iAbsFiffCursor += m_iWindowSize;
+
+        m_bReloading = false;
+        return;
+    }
 
     //extend m_data with reloaded data
     if(m_bReloadBefore) {
@@ -1043,10 +1286,18 @@ void RawModel::insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair)
 
     m_bReloading = false;
 
+    //the processed data of a cached tile only needs to be overlap-added with its new neighbours
+    if(bProcessed && !m_assignedOperators.empty())
+        performOverlapAdd();
+
     emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size()-1,1));
-    emit dataReloaded();
 
-    qDebug() << "RawModel: Fiff data Reloaded from " << dataTimesPair.second.coeff(0) << "secs to" << dataTimesPair.second.coeff(dataTimesPair.second.cols()-1) << "secs";
+    if(!bProcessed)
+        emit dataReloaded();
+
+    qDebug() << "RawModel: Fiff data Reloaded (tile" << iTileIndex << ") from sample" << firstSample() + iTileIndex*m_iWindowSize << "to" << firstSample() + iTileIndex*m_iWindowSize + newDataPackage->dataRaw().cols() - 1;
+
+    prefetchTiles();
 }
 
 
@@ -1138,6 +1389,8 @@ void RawModel::updateOperatorsConcurrently(int windowIndex)
     qDebug() << "RawModel: finished concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
 
     insertProcessedDataAll(windowIndex);
+
+    m_tileCache.setProcRevision(tileIndex(m_iAbsFiffCursor) + windowIndex, m_iOperatorRevision);
 }
 
 
@@ -1156,10 +1409,12 @@ void RawModel::insertProcessedDataRow(int rowIndex)
     int cutFront = m_iCurrentFFTLength/4;
     int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
 
+    m_tileDataMutex.lock();
     if(m_bReloadBefore)
         m_data.first()->setOrigProcData(m_listTmpChData[rowIndex].second, m_listTmpChData[rowIndex].first, cutFront, cutBack);
     else
         m_data.last()->setOrigProcData(m_listTmpChData[rowIndex].second, m_listTmpChData[rowIndex].first, cutFront, cutBack);
+    m_tileDataMutex.unlock();
 
     performOverlapAdd();
 
@@ -1185,8 +1440,10 @@ void RawModel::insertProcessedDataAll(int windowIndex)
     int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
 
     //Set and cut original data to window size and calculate mean for filtered data
+    m_tileDataMutex.lock();
     for(int i=0; i < listFilteredChs.size(); ++i)
         m_data[windowIndex]->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
+    m_tileDataMutex.unlock();
 
     emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
 
@@ -1210,15 +1467,22 @@ void RawModel::insertProcessedDataAll()
     int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
 
     //Set and cut original data to window size and calculate mean for filtered data
+    m_tileDataMutex.lock();
     for(int i=0; i < listFilteredChs.size(); ++i) {
         if(m_bReloadBefore)
             m_data.first()->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
         else
             m_data.last()->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
     }
+    m_tileDataMutex.unlock();
 
     performOverlapAdd();
 
+    if(m_bReloadBefore)
+        m_tileCache.setProcRevision(tileIndex(m_iAbsFiffCursor), m_iOperatorRevision);
+    else
+        m_tileCache.setProcRevision(tileIndex(m_iAbsFiffCursor) + m_data.size() - 1, m_iOperatorRevision);
+
     emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
 
     qDebug() << "RawModel: Finished inserting" << listFilteredChs.size() << "channels.";
@@ -1233,6 +1497,8 @@ void RawModel::performOverlapAdd()
     if(m_data.empty() || m_data.size()<2)
         return;
 
+    QMutexLocker locker(&m_tileDataMutex);
+
     QList<int> listFilteredChs = m_assignedOperators.keys();
 
     //Overlap add window data
@@ -1327,6 +1593,8 @@ void RawModel::performOverlapAdd(int windowIndex)
     if(windowIndex<0 || windowIndex>m_data.size()-1 || m_data.size()<2)
         return;
 
+    QMutexLocker locker(&m_tileDataMutex);
+
     QList<int> listFilteredChs = m_assignedOperators.keys();
 
     //Overlap add window data
@@ -50,10 +50,15 @@
 *
 *           In order to not freeze the GUI when reloading new data or filtering data, the RawModel class makes heavy use
 *           of the QtConcurrent features. [2]
-*           Therefore, the methods updateOperatorsConcurrently() and readSegment() is run in a background-thread. Once the results
+*           Therefore, the methods updateOperatorsConcurrently() and loadTile() is run in a background-thread. Once the results
 *           are ready the m_operatorFutureWatcher and m_reloadFutureWatcher emits a signal that is connect to the slots
 *           insertProcessedData() and insertReloadedData(), respectively.
 *
+*           The fiff file is divided into tiles of m_iWindowSize samples. Every loaded window is a tile and is kept together with
+*           its processed data in the memory-bounded LRU cache m_tileCache. Tiles next to the current scroll position are loaded and
+*           filtered in advance by the thread pool m_tileThreadPool, so that scrolling and jumps to already visited positions are
+*           served from the cache instead of the fiff file.
+*
 *           MNEOperators such as FilterOperators are stored in m_Operators. The MNEOperators that are applied to any
 *           individual channel are stored in the QMap m_assignedOperators.
 *
@@ -75,6 +80,7 @@
 #include "../Utils/filteroperator.h"
 #include "../Utils/rawsettings.h"
 #include "../Utils/datapackage.h"
+#include "../Utils/tilecache.h"
 
 
 //*************************************************************************************************************
@@ -88,6 +94,9 @@
 #include <QBrush>
 #include <QPalette>
 #include <QtConcurrent>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QSet>
 #include <QProgressDialog>
 
 
@@ -152,6 +161,12 @@ public:
     RawModel(QObject *parent);
     RawModel(QFile& qFile, QObject *parent);
 
+    //=========================================================================================================
+    /**
+    * Destroys the RawModel after the background loading of tiles has finished
+    */
+    ~RawModel();
+
     //=========================================================================================================
     /**
     * Reimplemented virtual functions
@@ -224,7 +239,8 @@ private:
 
     //=========================================================================================================
     /**
-    * @brief readSegment is the wrapper method to read a segment from the raw fiff file
+    * @brief readSegment is the wrapper method to read a segment from the raw fiff file, the projection is applied
+    * with m_pProjOperator
     *
     * @param from the start point to read from the file
     * @param to the end point to read from the file
@@ -232,6 +248,68 @@ private:
     */
     QPair<MatrixXd,MatrixXd> readSegment(fiff_int_t from, fiff_int_t to);
 
+    //=========================================================================================================
+    /**
+    * tileIndex returns the index of the tile which contains a sample
+    *
+    * @param absSample the absolute sample position in the fiff file
+    * @return the tile index
+    */
+    inline qint32 tileIndex(qint32 absSample) const;
+
+    //=========================================================================================================
+    /**
+    * loadTile reads a tile from the fiff file, applies the given operators and stores the result in the tile cache.
+    * This method is run in a background-thread of m_tileThreadPool.
+    *
+    * @param iTileIndex the index of the tile to load
+    * @param assignedOperators snapshot of the operators assigned to the channels
+    * @param iOperatorRevision the revision of assignedOperators
+    * @param iDataRevision the data revision at the time the loading was requested. The tile is discarded if the data revision changed meanwhile.
+    * @param iWindowSize the tile size [in samples] at the time the loading was requested
+    * @param iFFTLength the fft length of the operators at the time the loading was requested
+    * @return the tile index and the loaded tile
+    */
+    QPair<qint32,QSharedPointer<DataPackage> > loadTile(qint32 iTileIndex, QMap<int,QSharedPointer<MNEOperator> > assignedOperators, qint32 iOperatorRevision, int iDataRevision, qint32 iWindowSize, int iFFTLength);
+
+    //=========================================================================================================
+    /**
+    * processTile applies the given operators to all assigned channels of a tile and stores the result as the processed data of the tile
+    *
+    * @param pTile the tile to process
+    * @param assignedOperators the operators assigned to the channels
+    * @param iFFTLength the fft length used by the operators
+    */
+    void processTile(QSharedPointer<DataPackage> pTile, const QMap<int,QSharedPointer<MNEOperator> > &assignedOperators, int iFFTLength) const;
+
+    //=========================================================================================================
+    /**
+    * prefetchTiles schedules the loading of the MODEL_PREFETCH_TILES tiles at both sides of the currently loaded data,
+    * which are neither cached with up to date processed data nor already being loaded
+    */
+    void prefetchTiles();
+
+    //=========================================================================================================
+    /**
+    * invalidateTiles drops all cached tiles, i.e. because the raw data changed due to a new projector or compensator
+    */
+    void invalidateTiles();
+
+    //=========================================================================================================
+    /**
+    * invalidateProcessedTiles marks the processed data of all cached tiles as outdated, i.e. because the assigned operators changed
+    */
+    void invalidateProcessedTiles();
+
+    //=========================================================================================================
+    /**
+    * applyOperators applies the given MNEOperators to a given RowVectorXd and modifies it in-place
+    *
+    * @param chdata[in,out] represents the channel data as a RowVectorXd
+    * @param assignedOperators the operators assigned to the channels
+    */
+    static void applyOperators(QPair<int, RowVectorXd> &chdata, const QMap<int,QSharedPointer<MNEOperator> > &assignedOperators);
+
     //VARIABLES
     //Reload control
     bool                                    m_bStartReached;            /**< signals, whether the start of the fiff data file is reached. */
@@ -239,7 +317,7 @@ private:
     bool                                    m_bReloadBefore;            /**< bool value indicating if data was reloaded before (1) or after (0) the existing data. */
 
     //Concurrent reloading
-    QFutureWatcher<QPair<MatrixXd,MatrixXd> > m_reloadFutureWatcher;    /**< QFutureWatcher for watching process of reloading fiff data. */
+    QFutureWatcher<QPair<qint32,QSharedPointer<DataPackage> > > m_reloadFutureWatcher; /**< QFutureWatcher for watching process of reloading fiff data. */
     bool                                    m_bReloading;               /**< signals when the reloading is ongoing. */
 
     //Concurrent processing
@@ -250,10 +328,19 @@ private:
     QString                                 m_filterChType;
 
     QMutex                                  m_Mutex;                    /**< mutex for locking against simultaenous access to shared objects >. */
+    FiffProjCompOperator::ConstSPtr         m_pProjOperator;            /**< the SSP projector applied to the read data, guarded by m_Mutex. */
 
     //Fiff data structure
     QList<QSharedPointer<DataPackage> >     m_data;                     /**< List that holds the fiff matrix data <n_channels x n_samples>. */
 
+    //Tile caching
+    TileCache                               m_tileCache;                /**< LRU cache of the loaded and processed tiles. */
+    QSet<qint32>                            m_setPendingTiles;          /**< indices of the tiles which are currently loaded in the background. */
+    QMutex                                  m_pendingMutex;             /**< mutex for locking m_setPendingTiles. */
+    qint32                                  m_iOperatorRevision;        /**< revision of m_assignedOperators, incremented on each change. */
+    QAtomicInt                              m_iDataRevision;            /**< revision of the raw data, incremented if the projector or compensator changed. */
+    QMutex                                  m_tileDataMutex;            /**< mutex for locking the contents of tiles which are shared with the tile cache while they are modified or copied. */
+
     //Filter operators
     QMap<int,QSharedPointer<MNEOperator> >  m_assignedOperators;        /**< Map of MNEOperator types to channels.*/
 
@@ -266,10 +353,13 @@ private:
     qint16                                  m_iFilterTaps;              /**< Number of Filter taps */
     int                                     m_iCurrentFFTLength;        /**< Currently used fft length */
 
+    //Background tile loading
+    QThreadPool                             m_tileThreadPool;           /**< thread pool for loading and processing tiles in the background. Declared last so that it is destroyed, and waits for its tasks, before all other members. */
+
 signals:
     //=========================================================================================================
     /**
-    * dataReloaded is emitted when data reloading has finished in the background-thread
+    * dataReloaded is emitted when data reloading has finished in the background-thread and the reloaded data still needs to be processed
     */
     void dataReloaded();
 
@@ -407,11 +497,13 @@ public slots:
 private slots:
     //=========================================================================================================
     /**
-    * insertReloadedData inserts the reloaded data when the background has finished the operation
+    * insertReloadedData inserts a reloaded tile either from the tile cache or when the background has finished the loading operation
     *
-    * @param dataTimesPair contains the reloaded matrices of the data and times so it can be inserted into m_data and m_times
+    * @param iTileIndex the index of the tile
+    * @param pTile the reloaded tile
+    * @param bProcessed true if the processed data of the tile is up to date with the current operators
     */
-    void insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair);
+    void insertReloadedData(qint32 iTileIndex, const QSharedPointer<DataPackage> &pTile, bool bProcessed);
 
     //=========================================================================================================
     /**
@@ -518,6 +610,13 @@ public:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline qint32 RawModel::tileIndex(qint32 absSample) const {
+    return (absSample - firstSample()) / m_iWindowSize;
+}
+
+
+//*************************************************************************************************************
+
 inline qint32 RawModel::sizeOfFiffData() {
     if(!m_pfiffIO->m_qlistRaw.empty())
         return (m_pfiffIO->m_qlistRaw[0]->last_samp-m_pfiffIO->m_qlistRaw[0]->first_samp);
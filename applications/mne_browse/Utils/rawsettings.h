@@ -82,6 +82,9 @@
 #define MODEL_MAX_WINDOWS 3 //number of windows that are at maximum remained in m_data
 #define MODEL_NUM_FILTER_TAPS 80 //number of filter taps, required to take into account because of FFT convolution (zero padding)
 #define MODEL_MAX_NUM_FILTER_TAPS 0 //number of maximal filter taps
+#define MODEL_TILE_CACHE_SIZE 512 //memory budget of the tile cache holding the loaded and processed data windows [in MB]
+#define MODEL_PREFETCH_TILES 2 //number of tiles which are loaded in the background at each side of the current position
+#define MODEL_TILE_THREADS 2 //number of background threads used for loading and processing tiles
 
 //RawDelegate
 //Look
@@ -0,0 +1,202 @@
+//=============================================================================================================
+/**
+* @file     tilecache.cpp
+* @author   Lorenz Esch <lorenz.esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the TileCache class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "tilecache.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEBROWSE;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+TileCache::TileCache(qint64 iMaxBytes)
+: m_iMaxBytes(iMaxBytes)
+, m_iBytesUsed(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<DataPackage> TileCache::tile(qint32 iTileIndex, qint32 &iProcRevision)
+{
+    QMutexLocker locker(&m_mutex);
+
+    iProcRevision = -1;
+
+    QHash<qint32, TileEntry>::const_iterator it = m_hashTiles.constFind(iTileIndex);
+    if(it == m_hashTiles.constEnd()) {
+        return QSharedPointer<DataPackage>();
+    }
+
+    //Mark as most recently used
+    m_lUsage.removeOne(iTileIndex);
+    m_lUsage.append(iTileIndex);
+
+    iProcRevision = it->iProcRevision;
+    return it->pTile;
+}
+
+
+//*************************************************************************************************************
+
+void TileCache::insert(qint32 iTileIndex, const QSharedPointer<DataPackage> &pTile, qint32 iProcRevision)
+{
+    if(!pTile) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if(m_hashTiles.contains(iTileIndex)) {
+        m_iBytesUsed -= m_hashTiles[iTileIndex].iBytes;
+        m_lUsage.removeOne(iTileIndex);
+    }
+
+    TileEntry entry;
+    entry.pTile = pTile;
+    entry.iBytes = tileBytes(pTile);
+    entry.iProcRevision = iProcRevision;
+
+    m_hashTiles.insert(iTileIndex, entry);
+    m_lUsage.append(iTileIndex);
+    m_iBytesUsed += entry.iBytes;
+
+    evict();
+}
+
+
+//*************************************************************************************************************
+
+void TileCache::setProcRevision(qint32 iTileIndex, qint32 iProcRevision)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QHash<qint32, TileEntry>::iterator it = m_hashTiles.find(iTileIndex);
+    if(it != m_hashTiles.end()) {
+        it->iProcRevision = iProcRevision;
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool TileCache::contains(qint32 iTileIndex) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hashTiles.contains(iTileIndex);
+}
+
+
+//*************************************************************************************************************
+
+void TileCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_hashTiles.clear();
+    m_lUsage.clear();
+    m_iBytesUsed = 0;
+}
+
+
+//*************************************************************************************************************
+
+void TileCache::setMaxBytes(qint64 iMaxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_iMaxBytes = iMaxBytes;
+    evict();
+}
+
+
+//*************************************************************************************************************
+
+qint64 TileCache::bytesUsed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iBytesUsed;
+}
+
+
+//*************************************************************************************************************
+
+qint64 TileCache::tileBytes(const QSharedPointer<DataPackage> &pTile)
+{
+    //Original and mapped data matrices of the raw and processed data as well as the time vectors
+    qint64 iElements = pTile->dataRawOrig().size()
+                       + pTile->dataRaw().size()
+                       + pTile->dataProcOrig().size()
+                       + pTile->dataProc().size()
+                       + 2 * pTile->dataRaw().cols();
+
+    return iElements * (qint64)sizeof(double);
+}
+
+
+//*************************************************************************************************************
+
+void TileCache::evict()
+{
+    //Always keep the most recently used tile, even if it exceeds the budget on its own
+    while(m_iBytesUsed > m_iMaxBytes && m_lUsage.size() > 1) {
+        qint32 iTileIndex = m_lUsage.takeFirst();
+        m_iBytesUsed -= m_hashTiles.take(iTileIndex).iBytes;
+    }
+}
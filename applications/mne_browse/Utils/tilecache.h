@@ -0,0 +1,186 @@
+//=============================================================================================================
+/**
+* @file     tilecache.h
+* @author   Lorenz Esch <lorenz.esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the TileCache class.
+*
+*/
+
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "datapackage.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNEBROWSE
+//=============================================================================================================
+
+namespace MNEBROWSE
+{
+
+
+//=============================================================================================================
+/**
+* The TileCache holds fixed-size data tiles (DataPackage objects) of a fiff raw file. A tile is identified
+* by its index, i.e. tile i covers the samples [firstSample + i*tileSize, firstSample + (i+1)*tileSize - 1].
+* The cache is bounded by a memory budget. If the budget is exceeded, the least recently used tiles are dropped.
+* Each tile carries the revision of the operators which were used to compute its processed data, so that
+* outdated processed data can be detected after the user changed the filter settings.
+* All methods are thread safe, since tiles are inserted from the background loading threads.
+*
+* @brief The TileCache class provides a memory-bounded LRU cache for raw and processed data tiles.
+*/
+class TileCache
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a TileCache.
+    *
+    * @param iMaxBytes the memory budget of the cache [in bytes]
+    */
+    TileCache(qint64 iMaxBytes);
+
+    //=========================================================================================================
+    /**
+    * Returns the tile with the index iTileIndex and marks it as most recently used.
+    *
+    * @param[in] iTileIndex         the tile index.
+    * @param[out] iProcRevision     the operator revision the processed data was computed with (-1 if none).
+    *
+    * @return the tile or a null pointer if the tile is not cached.
+    */
+    QSharedPointer<DataPackage> tile(qint32 iTileIndex, qint32 &iProcRevision);
+
+    //=========================================================================================================
+    /**
+    * Inserts a tile. An already cached tile with the same index is replaced. Least recently used tiles are dropped
+    * until the memory budget is met again. The most recently inserted tile is never dropped.
+    *
+    * @param[in] iTileIndex     the tile index.
+    * @param[in] pTile          the tile data.
+    * @param[in] iProcRevision  the operator revision the processed data was computed with (-1 if none).
+    */
+    void insert(qint32 iTileIndex, const QSharedPointer<DataPackage> &pTile, qint32 iProcRevision = -1);
+
+    //=========================================================================================================
+    /**
+    * Updates the operator revision of an already cached tile, i.e. after its processed data was recomputed.
+    *
+    * @param[in] iTileIndex     the tile index.
+    * @param[in] iProcRevision  the operator revision the processed data was computed with.
+    */
+    void setProcRevision(qint32 iTileIndex, qint32 iProcRevision);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the tile with the index iTileIndex is cached.
+    *
+    * @param[in] iTileIndex     the tile index.
+    *
+    * @return true if the tile is cached.
+    */
+    bool contains(qint32 iTileIndex) const;
+
+    //=========================================================================================================
+    /**
+    * Removes all tiles from the cache.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Sets the memory budget and drops tiles if needed.
+    *
+    * @param[in] iMaxBytes  the memory budget of the cache [in bytes].
+    */
+    void setMaxBytes(qint64 iMaxBytes);
+
+    //=========================================================================================================
+    /**
+    * Returns the currently used memory.
+    *
+    * @return the memory used by the cached tiles [in bytes].
+    */
+    qint64 bytesUsed() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Estimates the memory which is occupied by a tile.
+    *
+    * @param[in] pTile  the tile.
+    *
+    * @return the estimated size [in bytes].
+    */
+    static qint64 tileBytes(const QSharedPointer<DataPackage> &pTile);
+
+    //=========================================================================================================
+    /**
+    * Drops the least recently used tiles until the memory budget is met. Assumes m_mutex to be locked.
+    */
+    void evict();
+
+    struct TileEntry {
+        QSharedPointer<DataPackage>     pTile;              /**< The cached tile. */
+        qint64                          iBytes;             /**< The estimated size of the tile [in bytes]. */
+        qint32                          iProcRevision;      /**< The operator revision of the processed data (-1 if none). */
+    };
+
+    mutable QMutex                      m_mutex;            /**< Mutex to guard the cache against concurrent access. */
+    QHash<qint32, TileEntry>            m_hashTiles;        /**< The cached tiles, accessed by their tile index. */
+    QList<qint32>                       m_lUsage;           /**< The tile indices ordered from least (front) to most (back) recently used. */
+    qint64                              m_iMaxBytes;        /**< The memory budget [in bytes]. */
+    qint64                              m_iBytesUsed;       /**< The currently used memory [in bytes]. */
+};
+
+} // NAMESPACE
+
+#endif // TILECACHE_H
@@ -535,6 +535,12 @@ void MainWindow::openFile()
     m_pEventWindow->getEventModel()->setFirstLastSample(m_pDataWindow->getDataModel()->firstSample(),
                                                         m_pDataWindow->getDataModel()->lastSample());
 
+    //Show the trigger events of the raw file until an event file is loaded
+    if(m_pEventWindow->getEventModel()->loadEventIndex(filename))
+        qDebug() << "Trigger events of" << filename << "loaded.";
+    else
+        qDebug("No trigger events found in fiff data file %s",filename.toUtf8().data());
+
     //resize columns to contents - needs to be done because the new data file can be shorter than the old one
     m_pDataWindow->updateDataTableViews();
     m_pDataWindow->getDataTableView()->resizeColumnsToContents();
@@ -95,7 +95,8 @@ SOURCES += \
     Windows/averagewindow.cpp \
     Windows/scalewindow.cpp \
     Windows/chinfowindow.cpp \
-    Utils/datapackage.cpp \    
+    Utils/datapackage.cpp \
+    Utils/tilecache.cpp \
     Windows/noisereductionwindow.cpp
 
 HEADERS += \
@@ -124,6 +125,7 @@ HEADERS += \
     Windows/chinfowindow.h \
     Windows/noisereductionwindow.h \
     Utils/datapackage.h \
+    Utils/tilecache.h \
 
 FORMS += \
     Windows/eventwindowdock.ui \
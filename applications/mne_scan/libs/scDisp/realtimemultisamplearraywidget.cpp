@@ -215,13 +215,17 @@ void RealTimeMultiSampleArrayWidget::update(SCMEASLIB::Measurement::SPtr)
         if(m_pRTMSA->isChInit()) {
             m_pFiffInfo = m_pRTMSA->info();
 
-            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArray().at(m_pRTMSA->getMultiSampleArray().size()-1).cols();
+            QVector<qint32> vecBlockSizes = m_pRTMSA->getMultiSampleBlockSizes();
+            m_iMaxFilterTapSize = vecBlockSizes.isEmpty() ? 0 : vecBlockSizes.last();
 
             init();
         }
     } else {
-        //Add data to table view
-        m_pChannelDataView->addData(m_pRTMSA->getMultiSampleArray());
+        //Add data to table view, reading the blocks in place
+        QSharedPointer<const MatrixXd> pMatSamples = m_pRTMSA->getMultiSampleMatrix();
+        if(pMatSamples) {
+            m_pChannelDataView->addData(*pMatSamples, m_pRTMSA->getMultiSampleBlockSizes());
+        }
     }
 }
 
@@ -41,6 +41,7 @@
 #include "measurement.h"
 
 #include <QWidget>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -51,6 +52,19 @@
 using namespace SCMEASLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -60,6 +74,9 @@ Measurement::Measurement(int type, QObject *parent)
 : QObject(parent)
 , m_iMetaTypeId(type)
 , m_bVisibility(true)
+, m_iTimestamp(-1)
+, m_iNextTimestamp(-1)
+, m_iSequenceNumber(0)
 {
 //    qWarning() << "QMetaType" << type;
 }
@@ -70,3 +87,26 @@ Measurement::Measurement(int type, QObject *parent)
 Measurement::~Measurement()
 {
 }
+
+
+//*************************************************************************************************************
+
+qint64 Measurement::monotonicTime()
+{
+    static const QElapsedTimer s_clock = startedClock();
+
+    return s_clock.nsecsElapsed();
+}
+
+
+//*************************************************************************************************************
+
+void Measurement::stamp()
+{
+    qint64 iNow = monotonicTime();
+
+    QMutexLocker locker(&m_qMutex);
+    m_iTimestamp = m_iNextTimestamp >= 0 ? m_iNextTimestamp : iNow;
+    m_iNextTimestamp = -1;
+    ++m_iSequenceNumber;
+}
@@ -142,10 +142,49 @@ public:
     */
     inline QList<QSharedPointer<QWidget> > getControlWidgets();
 
+    //=========================================================================================================
+    /**
+    * Returns the acquisition time of the data sent last, on the monotonicTime() clock.
+    *
+    * @return the acquisition time in nanoseconds, -1 if nothing was sent yet.
+    */
+    inline qint64 timestamp() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the acquisition time of the data sent next. Algorithm plugins pass on the timestamp of their input
+    * so that latencies are measured from the acquisition. If not set, the time of sending is used.
+    *
+    * @param[in] iTimestamp     the acquisition time in nanoseconds on the monotonicTime() clock.
+    */
+    inline void setTimestamp(qint64 iTimestamp);
+
+    //=========================================================================================================
+    /**
+    * Returns the running number of the data sent last.
+    *
+    * @return the sequence number, 0 if nothing was sent yet.
+    */
+    inline qint64 sequenceNumber() const;
+
+    //=========================================================================================================
+    /**
+    * Monotonic clock shared by all measurements.
+    *
+    * @return nanoseconds since the first call.
+    */
+    static qint64 monotonicTime();
+
 signals:
     void notify();
 
 protected:
+    //=========================================================================================================
+    /**
+    * Assigns timestamp and sequence number to the data about to be sent. Call right before notify().
+    */
+    void stamp();
+
     //=========================================================================================================
     /**
     * Sets the type of the Measurement. Use QMetaType::type("the type") to generate the type.
@@ -160,6 +199,9 @@ private:
     QString                             m_qString_Name;     /**< Name of the Measurement */
     bool                                m_bVisibility;      /**< Visibility status */
     QList<QSharedPointer<QWidget> >     m_lControlWidgets;  /**< The control widgets, which should be added to the corresponding real-time visualization. */
+    qint64                              m_iTimestamp;       /**< Acquisition time of the data sent last */
+    qint64                              m_iNextTimestamp;   /**< Acquisition time of the data sent next, -1 if not set */
+    qint64                              m_iSequenceNumber;  /**< Running number of the data sent last */
 
 };
 
@@ -238,6 +280,33 @@ inline QList<QSharedPointer<QWidget> > Measurement::getControlWidgets()
     return m_lControlWidgets;
 }
 
+
+//*************************************************************************************************************
+
+inline qint64 Measurement::timestamp() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iTimestamp;
+}
+
+
+//*************************************************************************************************************
+
+inline void Measurement::setTimestamp(qint64 iTimestamp)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iNextTimestamp = iTimestamp;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 Measurement::sequenceNumber() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iSequenceNumber;
+}
+
 } //NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::Measurement::SPtr)
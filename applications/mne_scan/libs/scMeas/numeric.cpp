@@ -78,6 +78,7 @@ void Numeric::setValue(double v)
     m_qMutex.lock();
     m_dValue = v;
     m_qMutex.unlock();
+    stamp();
     emit notify();
 }
 
@@ -112,6 +112,7 @@ void RealTimeConnectivityEstimate::setValue(const Network& v)
 
     m_qMutex.unlock();
 
+    stamp();
     emit notify();
 }
 
@@ -98,6 +98,7 @@ void RealTimeCov::setValue(const FiffCov& v)
     m_bInitialized = true;
     m_qMutex.unlock();
 
+    stamp();
     emit notify();
 }
 
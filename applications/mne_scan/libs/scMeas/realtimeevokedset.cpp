@@ -174,6 +174,7 @@ void RealTimeEvokedSet::setValue(const FiffEvokedSet &v,
         m_qMutex.unlock();
     }
 
+    stamp();
     emit notify();
 }
 
@@ -68,6 +68,8 @@ RealTimeMultiSampleArray::RealTimeMultiSampleArray(QObject *parent)
 : Measurement(QMetaType::type("RealTimeMultiSampleArray::SPtr"), parent)
 , m_dSamplingRate(0)
 , m_iMultiArraySize(10)
+, m_bSamplesValid(false)
+, m_iPendingCols(0)
 , m_bChInfoIsInit(false)
 {
     m_slDisplayFlag << "compensators" << "projections" << "filter" << "view" << "triggerdetection" << "scaling" << "sphara" << "colors";
@@ -236,6 +238,48 @@ void RealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr &p_pFiffInfo)
 }
 
 
+//*************************************************************************************************************
+
+const QList< MatrixXd >& RealTimeMultiSampleArray::getMultiSampleArray()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_bSamplesValid) {
+        m_matSamples.clear();
+
+        if(m_pMatSamples) {
+            qint32 iOffset = 0;
+            for(qint32 i = 0; i < m_vecBlockSizes.size(); ++i) {
+                m_matSamples.append(m_pMatSamples->middleCols(iOffset, m_vecBlockSizes[i]));
+                iOffset += m_vecBlockSizes[i];
+            }
+        }
+
+        m_bSamplesValid = true;
+    }
+
+    return m_matSamples;
+}
+
+
+//*************************************************************************************************************
+
+Eigen::Map<const MatrixXd> RealTimeMultiSampleArray::getMultiSampleBlock(qint32 i) const
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_pMatSamples || i < 0 || i >= m_vecBlockSizes.size())
+        return Eigen::Map<const MatrixXd>(Q_NULLPTR, 0, 0);
+
+    qint32 iOffset = 0;
+    for(qint32 j = 0; j < i; ++j)
+        iOffset += m_vecBlockSizes[j];
+
+    //Blocks are side by side in the column major matrix, hence contiguous
+    return Eigen::Map<const MatrixXd>(m_pMatSamples->data() + iOffset * m_pMatSamples->rows(), m_pMatSamples->rows(), m_vecBlockSizes[i]);
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
@@ -244,6 +288,75 @@ void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
         return;
 
     m_qMutex.lock();
+    bool bComplete = appendValue(mat);
+    m_qMutex.unlock();
+
+    if(bComplete)
+        publish();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArray::setValue(MatrixXd&& mat)
+{
+    if(!m_bChInfoIsInit)
+        return;
+
+    m_qMutex.lock();
+    bool bComplete;
+    if(m_iMultiArraySize <= 1 && m_vecPendingBlockSizes.isEmpty()) {
+        //check vector size
+        if(mat.rows() != m_qListChInfo.size())
+            qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setVector: Vector size does not match the number of channels! ";
+
+        //A single block is published as it is
+        m_matPending.swap(mat);
+        m_iPendingCols = m_matPending.cols();
+        m_vecPendingBlockSizes.append(m_iPendingCols);
+        bComplete = true;
+    } else {
+        bComplete = appendValue(mat);
+    }
+    m_qMutex.unlock();
+
+    if(bComplete)
+        publish();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArray::setValue(const QSharedPointer<const MatrixXd>& pMat)
+{
+    if(!m_bChInfoIsInit || !pMat)
+        return;
+
+    m_qMutex.lock();
+    bool bComplete;
+    if(m_iMultiArraySize <= 1 && m_vecPendingBlockSizes.isEmpty()) {
+        //check vector size
+        if(pMat->rows() != m_qListChInfo.size())
+            qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setVector: Vector size does not match the number of channels! ";
+
+        //Shared as it is, publish() must not take over the memory
+        m_pMatShared = pMat;
+        m_vecPendingBlockSizes.append(pMat->cols());
+        bComplete = true;
+    } else {
+        bComplete = appendValue(*pMat);
+    }
+    m_qMutex.unlock();
+
+    if(bComplete)
+        publish();
+}
+
+
+//*************************************************************************************************************
+
+bool RealTimeMultiSampleArray::appendValue(const MatrixXd& mat)
+{
     //check vector size
     if(mat.rows() != m_qListChInfo.size())
         qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setVector: Vector size does not match the number of channels! ";
@@ -256,16 +369,57 @@ void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
 //        else if(v[i] > m_qListChInfo[i].getMaxValue()) v[i] = m_qListChInfo[i].getMaxValue();
 //    }
 
+    qint32 iRemaining = qMax(m_iMultiArraySize - m_vecPendingBlockSizes.size(), 1);
+
+    if(m_vecPendingBlockSizes.isEmpty()) {
+        //Reserve room for all blocks, assuming they are of equal size
+        m_matPending.resize(mat.rows(), mat.cols() * iRemaining);
+        m_iPendingCols = 0;
+    } else if(mat.rows() != m_matPending.rows()) {
+        qCritical() << "Error Occured in RealTimeMultiSampleArray::setValue: Block size does not match the previous blocks, dropping it!";
+        return false;
+    } else if(m_iPendingCols + mat.cols() > m_matPending.cols()) {
+        m_matPending.conservativeResize(Eigen::NoChange, m_iPendingCols + mat.cols() * iRemaining);
+    }
+
     //Store
-    m_matSamples.push_back(mat);
+    m_matPending.middleCols(m_iPendingCols, mat.cols()) = mat;
+    m_iPendingCols += mat.cols();
+    m_vecPendingBlockSizes.append(mat.cols());
 
-    m_qMutex.unlock();
-    if(m_matSamples.size() >= m_iMultiArraySize)
-    {
-        emit notify();
-        m_qMutex.lock();
-        m_matSamples.clear();
-        m_qMutex.unlock();
-    }
+    return m_vecPendingBlockSizes.size() >= m_iMultiArraySize;
 }
 
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArray::publish()
+{
+    m_qMutex.lock();
+    if(m_pMatShared) {
+        m_pMatSamples = m_pMatShared;
+        m_pMatShared.clear();
+    } else {
+        if(m_iPendingCols < m_matPending.cols())
+            m_matPending.conservativeResize(Eigen::NoChange, m_iPendingCols);
+
+        //Hand the memory over to the published matrix, observers may keep it as long as they like
+        MatrixXd* pMatSamples = new MatrixXd;
+        pMatSamples->swap(m_matPending);
+        m_pMatSamples = QSharedPointer<const MatrixXd>(pMatSamples);
+    }
+    m_vecBlockSizes = m_vecPendingBlockSizes;
+
+    m_iPendingCols = 0;
+    m_vecPendingBlockSizes.clear();
+    m_bSamplesValid = false;
+    m_qMutex.unlock();
+
+    stamp();
+    emit notify();
+
+    m_qMutex.lock();
+    m_matSamples.clear();
+    m_bSamplesValid = false;
+    m_qMutex.unlock();
+}
@@ -223,21 +223,84 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the gathered multi sample array.
+    * Returns the gathered multi sample array. The list is split off the multi sample matrix on first request,
+    * which copies all blocks. Prefer getMultiSampleBlock() or getMultiSampleMatrix(), which do not copy.
     *
     * @return the current multi sample array.
     */
-    inline const QList< MatrixXd >& getMultiSampleArray();
+    const QList< MatrixXd >& getMultiSampleArray();
 
     //=========================================================================================================
     /**
-    * Attaches a value to the sample array list.
+    * Returns the gathered blocks as one matrix, side by side in the order they were set. A published matrix is
+    * never changed, hold on to the pointer to keep the data beyond the notification without copying them.
+    *
+    * @return the current multi sample matrix, null if nothing was sent yet.
+    */
+    inline QSharedPointer<const MatrixXd> getMultiSampleMatrix() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of columns of each block in the multi sample matrix.
+    *
+    * @return the block sizes.
+    */
+    inline QVector<qint32> getMultiSampleBlockSizes() const;
+
+    //=========================================================================================================
+    /**
+    * Returns a read-only view of one block of the multi sample matrix, without copying. The view stays valid
+    * until the next notification, keep getMultiSampleMatrix() to hold the data longer.
+    *
+    * @param [in] i     the index of the block.
+    *
+    * @return the block, empty if there is no such block.
+    */
+    Eigen::Map<const MatrixXd> getMultiSampleBlock(qint32 i) const;
+
+    //=========================================================================================================
+    /**
+    * Attaches a value to the sample array list. The value is copied once into the multi sample matrix.
     *
     * @param [in] mat   the value which is attached to the sample array list.
     */
     virtual void setValue(const MatrixXd& mat);
 
+    //=========================================================================================================
+    /**
+    * Attaches a value to the sample array list. If the multi array size is one, the memory of the value is
+    * taken over and published without copying. mat is left in a valid but unspecified state.
+    *
+    * @param [in] mat   the value which is attached to the sample array list.
+    */
+    void setValue(MatrixXd&& mat);
+
+    //=========================================================================================================
+    /**
+    * Attaches a shared value to the sample array list. If the multi array size is one, the matrix is published
+    * as it is, e.g. to pass on the data of an incoming block without copying. Otherwise it is copied.
+    *
+    * @param [in] pMat  the value which is attached to the sample array list, must not be changed afterwards.
+    */
+    void setValue(const QSharedPointer<const MatrixXd>& pMat);
+
 private:
+    //=========================================================================================================
+    /**
+    * Copies a block into the pending multi sample matrix. Call with m_qMutex locked.
+    *
+    * @param [in] mat   the block.
+    *
+    * @return true if the multi array size is reached.
+    */
+    bool appendValue(const MatrixXd& mat);
+
+    //=========================================================================================================
+    /**
+    * Publishes the pending multi sample matrix and notifies the observers.
+    */
+    void publish();
+
     mutable QMutex              m_qMutex;           /**< Mutex to ensure thread safety */
 
     FiffInfo::SPtr              m_pFiffInfo_orig;   /**< Original Fiff Info if initialized by fiff info. */
@@ -246,7 +309,14 @@ private:
     QString                     m_sXMLLayoutFile;   /**< Layout file name. */
     double                      m_dSamplingRate;    /**< Sampling rate of the RealTimeSampleArray.*/
     qint32                      m_iMultiArraySize;  /**< Sample size of the multi sample array.*/
-    QList<MatrixXd>             m_matSamples;       /**< The multi sample array.*/
+    QList<MatrixXd>             m_matSamples;       /**< The multi sample array, split off the multi sample matrix on request.*/
+    bool                        m_bSamplesValid;    /**< If m_matSamples matches the multi sample matrix.*/
+    QSharedPointer<const MatrixXd> m_pMatSamples;   /**< The published multi sample matrix.*/
+    QSharedPointer<const MatrixXd> m_pMatShared;    /**< A shared matrix to be published as it is, instead of m_matPending.*/
+    QVector<qint32>             m_vecBlockSizes;    /**< Number of columns of each block in m_pMatSamples.*/
+    MatrixXd                    m_matPending;       /**< The blocks gathered for the next notification.*/
+    qint32                      m_iPendingCols;     /**< Number of columns filled in m_matPending.*/
+    QVector<qint32>             m_vecPendingBlockSizes; /**< Number of columns of each block in m_matPending.*/
     bool                        m_bChInfoIsInit;    /**< If channel info is initialized.*/
 
     QList<RealTimeSampleArrayChInfo> m_qListChInfo; /**< Channel info list.*/
@@ -262,6 +332,13 @@ inline void RealTimeMultiSampleArray::clear()
 {
     QMutexLocker locker(&m_qMutex);
     m_matSamples.clear();
+    m_bSamplesValid = false;
+    m_pMatSamples.clear();
+    m_pMatShared.clear();
+    m_vecBlockSizes.clear();
+    m_matPending.resize(0, 0);
+    m_iPendingCols = 0;
+    m_vecPendingBlockSizes.clear();
 }
 
 
@@ -379,9 +456,19 @@ qint32 RealTimeMultiSampleArray::getMultiArraySize() const
 
 //*************************************************************************************************************
 
-inline const QList< MatrixXd >& RealTimeMultiSampleArray::getMultiSampleArray()
+inline QSharedPointer<const MatrixXd> RealTimeMultiSampleArray::getMultiSampleMatrix() const
 {
-    return m_matSamples;
+    QMutexLocker locker(&m_qMutex);
+    return m_pMatSamples;
+}
+
+
+//*************************************************************************************************************
+
+inline QVector<qint32> RealTimeMultiSampleArray::getMultiSampleBlockSizes() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_vecBlockSizes;
 }
 
 } // NAMESPACE
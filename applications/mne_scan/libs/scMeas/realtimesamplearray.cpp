@@ -104,6 +104,7 @@ void RealTimeSampleArray::setValue(double v)
     m_qMutex.unlock();
     if(m_vecSamples.size() >= m_ucArraySize)
     {
+        stamp();
         emit notify();
         m_qMutex.lock();
         m_vecSamples.clear();
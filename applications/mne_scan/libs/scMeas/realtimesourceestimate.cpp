@@ -105,6 +105,7 @@ void RealTimeSourceEstimate::setValue(MNESourceEstimate& v)
 
     if(m_pMNEStc.size() >= m_iSourceEstimateSize)
     {
+        stamp();
         emit notify();
         m_qMutex.lock();
         m_pMNEStc.clear();
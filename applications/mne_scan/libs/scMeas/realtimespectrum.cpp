@@ -112,6 +112,7 @@ void RealTimeSpectrum::setValue(MatrixXd& v)
 {
     //Store
     m_matValue = v;
+    stamp();
     emit notify();
 
     if(!m_bContainsValues)
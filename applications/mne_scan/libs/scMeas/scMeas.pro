@@ -75,7 +75,8 @@ SOURCES += \
     measurementtypes.cpp \
     realtimeevokedset.cpp \
     realtimecov.cpp \
-    realtimespectrum.cpp
+    realtimespectrum.cpp \
+    timestampqueue.cpp
 
 HEADERS += \
     scmeas_global.h \
@@ -89,7 +90,8 @@ HEADERS += \
     measurementtypes.h \
     realtimeevokedset.h \
     realtimecov.h \
-    realtimespectrum.h
+    realtimespectrum.h \
+    timestampqueue.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
@@ -0,0 +1,116 @@
+//=============================================================================================================
+/**
+* @file     timestampqueue.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the TimestampQueue class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "timestampqueue.h"
+#include "measurement.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+TimestampQueue::TimestampQueue(int iCapacity)
+: m_iCapacity(iCapacity > 0 ? iCapacity : 1)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TimestampQueue::push(qint64 iTimestamp, qint64 iSequence)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_qQueue.size() >= m_iCapacity)
+        m_qQueue.dequeue();
+
+    m_qQueue.enqueue(qMakePair(iTimestamp, iSequence));
+}
+
+
+//*************************************************************************************************************
+
+void TimestampQueue::pushNow()
+{
+    push(Measurement::monotonicTime());
+}
+
+
+//*************************************************************************************************************
+
+qint64 TimestampQueue::pop(qint64* pSequence)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    QPair<qint64, qint64> entry(-1, -1);
+    if(!m_qQueue.isEmpty())
+        entry = m_qQueue.dequeue();
+
+    if(pSequence)
+        *pSequence = entry.second;
+
+    return entry.first;
+}
+
+
+//*************************************************************************************************************
+
+void TimestampQueue::clear()
+{
+    QMutexLocker locker(&m_qMutex);
+    m_qQueue.clear();
+}
@@ -0,0 +1,125 @@
+//=============================================================================================================
+/**
+* @file     timestampqueue.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the TimestampQueue class.
+*
+*/
+
+#ifndef TIMESTAMPQUEUE_H
+#define TIMESTAMPQUEUE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QQueue>
+#include <QPair>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+//=============================================================================================================
+/**
+* Plugins hand their data from the receiving thread to their processing thread through a circular matrix
+* buffer, which only carries the samples. The TimestampQueue carries the acquisition timestamp and sequence
+* number of each buffered block alongside, so that the processing thread can pass them on with
+* Measurement::setTimestamp(). Push once per pushed block and pop once per popped block. Never blocks, an
+* empty queue pops -1 and a full queue drops its oldest entry.
+*
+* @brief Thread safe FIFO of block timestamps next to a data buffer
+*/
+class SCMEASSHARED_EXPORT TimestampQueue
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a TimestampQueue.
+    *
+    * @param[in] iCapacity  the number of entries kept, should match the capacity of the data buffer.
+    */
+    explicit TimestampQueue(int iCapacity = 64);
+
+    //=========================================================================================================
+    /**
+    * Adds the timestamp of a block about to be buffered.
+    *
+    * @param[in] iTimestamp acquisition time in nanoseconds on the Measurement::monotonicTime() clock.
+    * @param[in] iSequence  sequence number of the block, -1 if unknown.
+    */
+    void push(qint64 iTimestamp, qint64 iSequence = -1);
+
+    //=========================================================================================================
+    /**
+    * Adds the current time, use it in acquisition threads right after the data arrived.
+    */
+    void pushNow();
+
+    //=========================================================================================================
+    /**
+    * Takes the timestamp of the oldest buffered block.
+    *
+    * @param[out] pSequence  if given, receives the sequence number of the block.
+    *
+    * @return the acquisition time in nanoseconds, -1 if the queue is empty.
+    */
+    qint64 pop(qint64* pSequence = Q_NULLPTR);
+
+    //=========================================================================================================
+    /**
+    * Drops all entries, call it whenever the data buffer is cleared.
+    */
+    void clear();
+
+private:
+    QMutex                              m_qMutex;       /**< Guards the queue. */
+    QQueue<QPair<qint64, qint64> >      m_qQueue;       /**< Timestamps and sequence numbers, oldest first. */
+    int                                 m_iCapacity;    /**< Maximal number of entries. */
+};
+
+} //NAMESPACE
+
+#endif // TIMESTAMPQUEUE_H
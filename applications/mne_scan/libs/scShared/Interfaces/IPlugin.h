@@ -111,6 +111,12 @@ public:
     typedef QVector< QSharedPointer< PluginInputConnector > > InputConnectorList;  /**< List of input connectors. */
     typedef QVector< QSharedPointer< PluginOutputConnector > > OutputConnectorList; /**< List of output connectors. */
 
+    //=========================================================================================================
+    /**
+    * Constructs the IPlugin.
+    */
+    IPlugin() : m_bDataflowMode(false) {}
+
     //=========================================================================================================
     /**
     * Destroys the IPlugin.
@@ -200,6 +206,42 @@ public:
     inline InputConnectorList& getInputConnectors(){return m_inputConnectors;}
     inline OutputConnectorList& getOutputConnectors(){return m_outputConnectors;}
 
+    //=========================================================================================================
+    /**
+    * True if the plugin implements process() and can be driven by the DataflowScheduler instead of its own
+    * thread.
+    *
+    * @return true if the dataflow execution mode is supported.
+    */
+    virtual inline bool supportsDataflow() const;
+
+    //=========================================================================================================
+    /**
+    * Processes one block which arrived at an input connector. Only called in dataflow mode, by a thread of
+    * the shared pool. Calls for the same plugin never overlap and keep the order of arrival.
+    *
+    * @param[in] sInput     name of the input connector the block arrived at
+    * @param[in] pBlock     the immutable block
+    */
+    virtual void process(const QString& sInput, const DataBlock::ConstSPtr& pBlock);
+
+    //=========================================================================================================
+    /**
+    * Whether the plugin is driven by the DataflowScheduler. Plugins must not start their own thread in start()
+    * while this is set.
+    *
+    * @return true if running in dataflow mode.
+    */
+    inline bool isDataflowMode() const;
+
+    //=========================================================================================================
+    /**
+    * Switches the dataflow mode on or off. Called by the PluginSceneManager before start().
+    *
+    * @param[in] bDataflowMode  the new mode
+    */
+    inline void setDataflowMode(bool bDataflowMode);
+
 
 protected:
     //=========================================================================================================
@@ -223,6 +265,7 @@ protected:
 
 private:
     QList< QAction* >   m_qListPluginActions;  /**< List of plugin actions */
+    bool                m_bDataflowMode;        /**< Whether the plugin is driven by the DataflowScheduler */
 };
 
 //*************************************************************************************************************
@@ -236,6 +279,39 @@ inline bool IPlugin::multiInstanceAllowed() const
 }
 
 
+//*************************************************************************************************************
+
+inline bool IPlugin::supportsDataflow() const
+{
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+inline void IPlugin::process(const QString& sInput, const DataBlock::ConstSPtr& pBlock)
+{
+    Q_UNUSED(sInput);
+    Q_UNUSED(pBlock);
+}
+
+
+//*************************************************************************************************************
+
+inline bool IPlugin::isDataflowMode() const
+{
+    return m_bDataflowMode;
+}
+
+
+//*************************************************************************************************************
+
+inline void IPlugin::setDataflowMode(bool bDataflowMode)
+{
+    m_bDataflowMode = bDataflowMode;
+}
+
+
 //*************************************************************************************************************
 
 inline QList< QAction* > IPlugin::getPluginActions()
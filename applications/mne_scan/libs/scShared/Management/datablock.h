@@ -0,0 +1,203 @@
+//=============================================================================================================
+/**
+* @file     datablock.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains declaration of DataBlock class.
+*
+*/
+
+
+#ifndef DATABLOCK_H
+#define DATABLOCK_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+#include <scMeas/measurement.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=============================================================================================================
+/**
+* A DataBlock is a snapshot of one measurement update. It is created once by the sending output connector
+* and then handed to all connected plugins by reference, none of which may change it. The data are shared with
+* the sending measurement, not copied.
+*
+* @brief Immutable, reference counted block of data passed along the plugin graph
+*/
+class SCSHAREDSHARED_EXPORT DataBlock
+{
+public:
+    typedef QSharedPointer<DataBlock> SPtr;               /**< Shared pointer type for DataBlock. */
+    typedef QSharedPointer<const DataBlock> ConstSPtr;    /**< Const shared pointer type for DataBlock. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a DataBlock
+    *
+    * @param[in] pSource    the measurement which sent the block
+    * @param[in] pData      the data, all blocks side by side
+    * @param[in] iSequence  running number of the block
+    * @param[in] iTimestamp acquisition time of the data in nanoseconds, -1 if unknown
+    */
+    DataBlock(SCMEASLIB::Measurement::SPtr pSource, QSharedPointer<const Eigen::MatrixXd> pData, qint64 iSequence, qint64 iTimestamp = -1);
+
+    //=========================================================================================================
+    /**
+    * Takes a snapshot of the current state of a measurement. The multi sample matrix of a
+    * RealTimeMultiSampleArray is shared, not copied. Other measurement types only carry the source. Sequence number and timestamp are
+    * taken from the measurement.
+    *
+    * @param[in] pSource    the measurement which sent the block
+    *
+    * @return the new block
+    */
+    static ConstSPtr fromMeasurement(SCMEASLIB::Measurement::SPtr pSource);
+
+    //=========================================================================================================
+    /**
+    * Returns the measurement which sent this block. Use it for meta data only, its values may have changed
+    * since the block was created.
+    *
+    * @return the source measurement
+    */
+    inline SCMEASLIB::Measurement::SPtr source() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the data of the block, see SCMEASLIB::RealTimeMultiSampleArray::getMultiSampleMatrix()
+    *
+    * @return the data, empty if the source carries no sample data
+    */
+    inline const Eigen::MatrixXd& data() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the shared data of the block, e.g. to publish it again without copying
+    *
+    * @return the shared data, never null
+    */
+    inline QSharedPointer<const Eigen::MatrixXd> sharedData() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the running number of the block
+    *
+    * @return the sequence number
+    */
+    inline qint64 sequence() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the acquisition time of the data, see SCMEASLIB::Measurement::timestamp()
+    *
+    * @return the timestamp in nanoseconds, -1 if unknown
+    */
+    inline qint64 timestamp() const;
+
+private:
+    SCMEASLIB::Measurement::SPtr    m_pSource;      /**< The sending measurement. */
+    QSharedPointer<const Eigen::MatrixXd> m_pData;  /**< The data, never null. */
+    const qint64                    m_iSequence;    /**< Running number of the block. */
+    const qint64                    m_iTimestamp;   /**< Acquisition time of the data. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline SCMEASLIB::Measurement::SPtr DataBlock::source() const
+{
+    return m_pSource;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd& DataBlock::data() const
+{
+    return *m_pData;
+}
+
+
+//*************************************************************************************************************
+
+inline QSharedPointer<const Eigen::MatrixXd> DataBlock::sharedData() const
+{
+    return m_pData;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 DataBlock::sequence() const
+{
+    return m_iSequence;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 DataBlock::timestamp() const
+{
+    return m_iTimestamp;
+}
+
+} // NAMESPACE
+
+#endif // DATABLOCK_H
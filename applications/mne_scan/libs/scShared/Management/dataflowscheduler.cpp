@@ -0,0 +1,302 @@
+//=============================================================================================================
+/**
+* @file     dataflowscheduler.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the DataflowScheduler class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "dataflowscheduler.h"
+#include "latencytrace.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QRunnable>
+#include <QQueue>
+#include <QPair>
+#include <QWaitCondition>
+#include <QThreadStorage>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Set in threads of any scheduler pool, such senders must never wait for queue space.
+*/
+static QThreadStorage<bool> s_isPoolThread;
+
+/**
+* Number of blocks a task processes before it yields its pool thread to other plugins.
+*/
+static const int s_iBlocksPerTask = 4;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+struct DataflowScheduler::Node
+{
+    IPlugin::SPtr                                       plugin;     /**< The driven plugin. */
+    QMutex                                              lock;       /**< Guards the members below. */
+    QWaitCondition                                      notFull;    /**< Signaled when a block was taken. */
+    QQueue< QPair<QString, DataBlock::ConstSPtr> >      pending;    /**< Blocks waiting to be processed. */
+    bool                                                scheduled;  /**< A task for this node is queued or running. */
+    int                                                 traceNode;  /**< Id of the plugin in the latency trace. */
+};
+
+
+//*************************************************************************************************************
+
+namespace SCSHAREDLIB
+{
+
+/**
+* Pool task which drains the queue of one node.
+*/
+class DataflowTask : public QRunnable
+{
+public:
+    DataflowTask(DataflowScheduler* pScheduler, const DataflowScheduler::NodeSPtr& pNode)
+    : m_pScheduler(pScheduler)
+    , m_pNode(pNode)
+    {
+    }
+
+    virtual void run()
+    {
+        if(!s_isPoolThread.hasLocalData())
+            s_isPoolThread.setLocalData(true);
+        m_pScheduler->drain(m_pNode);
+    }
+
+private:
+    DataflowScheduler*          m_pScheduler;
+    DataflowScheduler::NodeSPtr m_pNode;        /**< Keeps the node alive while the task is queued or running. */
+};
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+
+DataflowScheduler::DataflowScheduler(QObject *parent)
+: QObject(parent)
+, m_bRunning(0)
+, m_iMaxQueuedBlocks(64)
+{
+    m_threadPool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+
+//*************************************************************************************************************
+
+DataflowScheduler::~DataflowScheduler()
+{
+    clear();
+}
+
+
+//*************************************************************************************************************
+
+bool DataflowScheduler::addPlugin(IPlugin::SPtr pPlugin)
+{
+    if(!pPlugin || !pPlugin->supportsDataflow()) {
+        qWarning() << "DataflowScheduler::addPlugin - Plugin does not support the dataflow mode.";
+        return false;
+    }
+
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_qHashNodes.contains(pPlugin.data()))
+        return true;
+
+    NodeSPtr pNode(new Node);
+    pNode->plugin = pPlugin;
+    pNode->scheduled = false;
+    pNode->traceNode = LatencyTrace::instance()->registerNode(pPlugin->getName());
+    m_qHashNodes.insert(pPlugin.data(), pNode);
+
+    IPlugin* pRawPlugin = pPlugin.data();
+    for(int i = 0; i < pPlugin->getInputConnectors().size(); ++i) {
+        QString sInput = pPlugin->getInputConnectors()[i]->getName();
+        m_qListConnections.append(connect(pPlugin->getInputConnectors()[i].data(), &PluginInputConnector::notifyBlock,
+                                          this, [this, pRawPlugin, sInput](DataBlock::ConstSPtr pBlock) {
+                                              schedule(pRawPlugin, sInput, pBlock);
+                                          }, Qt::DirectConnection));
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void DataflowScheduler::clear()
+{
+    stop();
+
+    QMutexLocker locker(&m_qMutex);
+
+    for(int i = 0; i < m_qListConnections.size(); ++i)
+        disconnect(m_qListConnections[i]);
+    m_qListConnections.clear();
+
+    //Nodes still referenced by waiting senders are released by them
+    m_qHashNodes.clear();
+}
+
+
+//*************************************************************************************************************
+
+void DataflowScheduler::start()
+{
+    m_bRunning.store(1);
+}
+
+
+//*************************************************************************************************************
+
+void DataflowScheduler::stop()
+{
+    m_bRunning.store(0);
+
+    {
+        QMutexLocker locker(&m_qMutex);
+
+        QHash<IPlugin*, NodeSPtr>::iterator it;
+        for(it = m_qHashNodes.begin(); it != m_qHashNodes.end(); ++it) {
+            QMutexLocker nodeLocker(&it.value()->lock);
+            it.value()->pending.clear();
+            it.value()->notFull.wakeAll();
+        }
+    }
+
+    m_threadPool.waitForDone();
+}
+
+
+//*************************************************************************************************************
+
+void DataflowScheduler::setMaxThreadCount(int iMaxThreadCount)
+{
+    m_threadPool.setMaxThreadCount(iMaxThreadCount);
+}
+
+
+//*************************************************************************************************************
+
+void DataflowScheduler::schedule(IPlugin* pPlugin, const QString& sInput, DataBlock::ConstSPtr pBlock)
+{
+    if(!m_bRunning.load())
+        return;
+
+    //Take a reference under the hash lock, clear() may drop the node from the hash at any time afterwards
+    NodeSPtr pNode;
+    {
+        QMutexLocker hashLocker(&m_qMutex);
+        pNode = m_qHashNodes.value(pPlugin);
+    }
+
+    if(!pNode)
+        return;
+
+    QMutexLocker locker(&pNode->lock);
+
+    //Back pressure for the sensors, pool threads must not wait on each other
+    if(!s_isPoolThread.hasLocalData())
+        while(pNode->pending.size() >= m_iMaxQueuedBlocks && m_bRunning.load())
+            pNode->notFull.wait(&pNode->lock);
+
+    if(!m_bRunning.load())
+        return;
+
+    pNode->pending.enqueue(qMakePair(sInput, pBlock));
+
+    if(!pNode->scheduled) {
+        pNode->scheduled = true;
+        m_threadPool.start(new DataflowTask(this, pNode));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void DataflowScheduler::drain(const NodeSPtr& pNode)
+{
+    QPair<QString, DataBlock::ConstSPtr> item;
+
+    for(int i = 0; i < s_iBlocksPerTask; ++i) {
+        {
+            QMutexLocker locker(&pNode->lock);
+            if(pNode->pending.isEmpty()) {
+                pNode->scheduled = false;
+                return;
+            }
+            item = pNode->pending.dequeue();
+            pNode->notFull.wakeAll();
+        }
+
+        LatencyTraceScope scope(pNode->traceNode, item.second->timestamp(), item.second->sequence());
+        pNode->plugin->process(item.first, item.second);
+    }
+
+    //Give the other plugins a turn and queue up again
+    QMutexLocker locker(&pNode->lock);
+    if(pNode->pending.isEmpty())
+        pNode->scheduled = false;
+    else
+        m_threadPool.start(new DataflowTask(this, pNode));
+}
@@ -0,0 +1,210 @@
+//=============================================================================================================
+/**
+* @file     dataflowscheduler.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains declaration of DataflowScheduler class.
+*
+*/
+
+
+#ifndef DATAFLOWSCHEDULER_H
+#define DATAFLOWSCHEDULER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+#include "../Interfaces/IPlugin.h"
+#include "datablock.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QAtomicInt>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=========================================================================================================
+/**
+* The DataflowScheduler drives plugins which support the dataflow mode. Blocks arriving at their input
+* connectors are queued per plugin and processed by a thread pool shared among all plugins. A plugin never
+* processes two blocks at once and sees its blocks in the order of arrival. Different plugins run in
+* parallel as soon as their inputs are ready.
+*
+* @brief Schedules plugin processing on a shared thread pool
+*/
+class SCSHAREDSHARED_EXPORT DataflowScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<DataflowScheduler> SPtr;            /**< Shared pointer type for DataflowScheduler. */
+    typedef QSharedPointer<const DataflowScheduler> ConstSPtr; /**< Const shared pointer type for DataflowScheduler. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a DataflowScheduler.
+    *
+    * @param[in] parent     the parent object
+    */
+    explicit DataflowScheduler(QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destructs the DataflowScheduler, waits for running blocks to finish.
+    */
+    ~DataflowScheduler();
+
+    //=========================================================================================================
+    /**
+    * Attaches a plugin to the scheduler. Its input connectors are connected to the scheduler.
+    *
+    * @param[in] pPlugin    the plugin, has to support the dataflow mode
+    *
+    * @return true if the plugin was added.
+    */
+    bool addPlugin(IPlugin::SPtr pPlugin);
+
+    //=========================================================================================================
+    /**
+    * Stops the scheduler and detaches all plugins.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Starts accepting blocks.
+    */
+    void start();
+
+    //=========================================================================================================
+    /**
+    * Stops accepting blocks, drops pending blocks and waits until running blocks are processed.
+    */
+    void stop();
+
+    //=========================================================================================================
+    /**
+    * Sets the number of pool threads.
+    *
+    * @param[in] iMaxThreadCount    the number of threads
+    */
+    void setMaxThreadCount(int iMaxThreadCount);
+
+    inline int maxThreadCount() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the number of blocks which may queue up for one plugin. Senders outside of the pool block until
+    * there is room again, senders inside of the pool never block.
+    *
+    * @param[in] iMaxQueuedBlocks   the number of blocks
+    */
+    inline void setMaxQueuedBlocks(int iMaxQueuedBlocks);
+
+    inline int maxQueuedBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Queues a block for a plugin and schedules the plugin if it is idle. Thread safe.
+    *
+    * @param[in] pPlugin    the receiving plugin
+    * @param[in] sInput     name of the input connector
+    * @param[in] pBlock     the block
+    */
+    void schedule(IPlugin* pPlugin, const QString& sInput, DataBlock::ConstSPtr pBlock);
+
+private:
+    struct Node;
+    typedef QSharedPointer<Node> NodeSPtr;      /**< Nodes are shared by the hash, the tasks and waiting senders. */
+    friend class DataflowTask;
+
+    //=========================================================================================================
+    /**
+    * Processes pending blocks of a node, at most a few in a row so that other plugins get their turn.
+    *
+    * @param[in] pNode      the node to drain
+    */
+    void drain(const NodeSPtr& pNode);
+
+    QThreadPool                     m_threadPool;           /**< The pool shared by all plugins. */
+    QMutex                          m_qMutex;               /**< Guards the node hash and the connections. */
+    QHash<IPlugin*, NodeSPtr>       m_qHashNodes;           /**< Per plugin queues. */
+    QList<QMetaObject::Connection>  m_qListConnections;     /**< Connections to the input connectors. */
+    QAtomicInt                      m_bRunning;             /**< Whether blocks are accepted. */
+    int                             m_iMaxQueuedBlocks;     /**< Queue limit per plugin. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int DataflowScheduler::maxThreadCount() const
+{
+    return m_threadPool.maxThreadCount();
+}
+
+
+//*************************************************************************************************************
+
+inline void DataflowScheduler::setMaxQueuedBlocks(int iMaxQueuedBlocks)
+{
+    m_iMaxQueuedBlocks = iMaxQueuedBlocks;
+}
+
+
+//*************************************************************************************************************
+
+inline int DataflowScheduler::maxQueuedBlocks() const
+{
+    return m_iMaxQueuedBlocks;
+}
+
+} //Namespace
+
+#endif // DATAFLOWSCHEDULER_H
@@ -0,0 +1,430 @@
+//=============================================================================================================
+/**
+* @file     latencytrace.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains definition of LatencyTrace class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "latencytrace.h"
+
+#include <scMeas/measurement.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+static QString kindName(qint32 kind)
+{
+    switch(kind) {
+        case LatencyTrace::Sent:
+            return QString("sent");
+        case LatencyTrace::Received:
+            return QString("received");
+        case LatencyTrace::ProcessBegin:
+            return QString("process_begin");
+        case LatencyTrace::ProcessEnd:
+            return QString("process_end");
+    }
+    return QString("unknown");
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+LatencyTrace::LatencyTrace()
+: m_pSlots(new Slot[s_iCapacity])
+, m_iWriteIndex(0)
+, m_iFirstIndex(0)
+, m_bEnabled(0)
+{
+    for(quint32 i = 0; i < s_iCapacity; ++i)
+        m_pSlots[i].version.store(0);
+}
+
+
+//*************************************************************************************************************
+
+LatencyTrace::~LatencyTrace()
+{
+    delete[] m_pSlots;
+}
+
+
+//*************************************************************************************************************
+
+LatencyTrace* LatencyTrace::instance()
+{
+    static LatencyTrace s_trace;
+    return &s_trace;
+}
+
+
+//*************************************************************************************************************
+
+int LatencyTrace::registerNode(const QString& sName)
+{
+    QMutexLocker locker(&m_qMutexNodes);
+
+    int iNode = m_lNodeNames.indexOf(sName);
+    if(iNode < 0) {
+        m_lNodeNames.append(sName);
+        iNode = m_lNodeNames.size() - 1;
+    }
+
+    return iNode;
+}
+
+
+//*************************************************************************************************************
+
+QString LatencyTrace::nodeName(int iNode) const
+{
+    QMutexLocker locker(&m_qMutexNodes);
+
+    return iNode >= 0 && iNode < m_lNodeNames.size() ? m_lNodeNames.at(iNode) : QString();
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTrace::write(int iNode, EventKind kind, qint64 iTimestamp, qint64 iSequence)
+{
+    quint32 iIndex = m_iWriteIndex.fetchAndAddRelaxed(1);
+    Slot& slot = m_pSlots[iIndex & (s_iCapacity - 1)];
+
+    slot.version.fetchAndStoreOrdered(2 * iIndex + 1);
+
+    slot.event.time = Measurement::monotonicTime();
+    slot.event.timestamp = iTimestamp;
+    slot.event.sequence = iSequence;
+    slot.event.node = iNode;
+    slot.event.kind = kind;
+
+    slot.version.storeRelease(2 * (iIndex + 1));
+}
+
+
+//*************************************************************************************************************
+
+QVector<LatencyTrace::Event> LatencyTrace::snapshot() const
+{
+    quint32 iEnd = m_iWriteIndex.loadAcquire();
+    quint32 iCount = qMin(iEnd - m_iFirstIndex.loadAcquire(), quint32(s_iCapacity));
+
+    QVector<Event> events;
+    events.reserve(iCount);
+
+    for(quint32 iIndex = iEnd - iCount; iIndex != iEnd; ++iIndex) {
+        Slot& slot = m_pSlots[iIndex & (s_iCapacity - 1)];
+        quint32 iVersion = 2 * (iIndex + 1);
+
+        //Skip events which are still being written or already overwritten
+        if(slot.version.loadAcquire() != iVersion)
+            continue;
+
+        Event event = slot.event;
+
+        if(slot.version.fetchAndAddOrdered(0) != iVersion)
+            continue;
+
+        events.append(event);
+    }
+
+    return events;
+}
+
+
+//*************************************************************************************************************
+
+QList<LatencyTrace::NodeStatistics> LatencyTrace::statistics(qint64 iWindow) const
+{
+    qint64 iNow = Measurement::monotonicTime();
+    qint64 iStart = iNow - iWindow;
+
+    QVector<Event> events = snapshot();
+
+    //Only count the time span actually covered by the trace
+    qint64 iFirst = iNow;
+    for(int i = 0; i < events.size(); ++i)
+        iFirst = qMin(iFirst, events[i].time);
+    double dSpan = (iNow - qMax(iStart, iFirst)) * 1e-9;
+
+    QHash<int, QVector<qint64> > hashLatencies;
+    QHash<int, int> hashCount;
+    QHash<int, qint64> hashBegin;
+    QHash<int, QPair<qint64, int> > hashProcessing;
+
+    for(int i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        if(event.time < iStart)
+            continue;
+
+        if(event.kind == ProcessBegin) {
+            hashBegin[event.node] = event.time;
+            continue;
+        }
+
+        if(event.kind == ProcessEnd && hashBegin.contains(event.node)) {
+            QPair<qint64, int>& processing = hashProcessing[event.node];
+            processing.first += event.time - hashBegin.take(event.node);
+            ++processing.second;
+        }
+
+        ++hashCount[event.node];
+        if(event.timestamp >= 0)
+            hashLatencies[event.node].append(event.time - event.timestamp);
+    }
+
+    QList<int> lNodes = hashCount.keys();
+    std::sort(lNodes.begin(), lNodes.end());
+
+    QList<NodeStatistics> lStatistics;
+
+    for(int i = 0; i < lNodes.size(); ++i) {
+        int iNode = lNodes[i];
+
+        NodeStatistics stats;
+        stats.name = nodeName(iNode);
+        stats.count = hashCount[iNode];
+        stats.throughput = dSpan > 0 ? stats.count / dSpan : 0;
+        stats.meanLatency = 0;
+        stats.p95Latency = 0;
+        stats.maxLatency = 0;
+        stats.meanProcessing = 0;
+        stats.histogram.fill(0, s_iHistogramBins);
+
+        QVector<qint64>& latencies = hashLatencies[iNode];
+        if(!latencies.isEmpty()) {
+            std::sort(latencies.begin(), latencies.end());
+
+            double dSum = 0;
+            for(int j = 0; j < latencies.size(); ++j) {
+                dSum += latencies[j];
+
+                qint64 iMicro = latencies[j] / 1000;
+                int iBin = 0;
+                while(iMicro >= 2 && iBin < s_iHistogramBins - 1) {
+                    iMicro >>= 1;
+                    ++iBin;
+                }
+                ++stats.histogram[iBin];
+            }
+
+            int iP95 = qMax(0, int(std::ceil(0.95 * latencies.size())) - 1);
+
+            stats.meanLatency = dSum / latencies.size() * 1e-6;
+            stats.p95Latency = latencies[iP95] * 1e-6;
+            stats.maxLatency = latencies.last() * 1e-6;
+        }
+
+        if(hashProcessing.contains(iNode)) {
+            const QPair<qint64, int>& processing = hashProcessing[iNode];
+            stats.meanProcessing = double(processing.first) / processing.second * 1e-6;
+        }
+
+        lStatistics.append(stats);
+    }
+
+    return lStatistics;
+}
+
+
+//*************************************************************************************************************
+
+bool LatencyTrace::exportCsv(const QString& sFileName) const
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "LatencyTrace::exportCsv - Could not open" << sFileName;
+        return false;
+    }
+
+    QVector<Event> events = snapshot();
+
+    QTextStream out(&file);
+    out << "time_ns,node,event,timestamp_ns,sequence,latency_ns\n";
+
+    for(int i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        out << event.time << ",\"" << nodeName(event.node) << "\"," << kindName(event.kind) << ","
+            << event.timestamp << "," << event.sequence << ","
+            << (event.timestamp >= 0 ? event.time - event.timestamp : -1) << "\n";
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool LatencyTrace::exportChromeTrace(const QString& sFileName) const
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "LatencyTrace::exportChromeTrace - Could not open" << sFileName;
+        return false;
+    }
+
+    QVector<Event> events = snapshot();
+    QJsonArray traceEvents;
+    QSet<int> setNodes;
+
+    for(int i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+
+        //Show every node as a thread of its own
+        if(!setNodes.contains(event.node)) {
+            setNodes.insert(event.node);
+
+            QJsonObject args;
+            args.insert("name", nodeName(event.node));
+
+            QJsonObject meta;
+            meta.insert("ph", QString("M"));
+            meta.insert("name", QString("thread_name"));
+            meta.insert("pid", 1);
+            meta.insert("tid", event.node);
+            meta.insert("args", args);
+            traceEvents.append(meta);
+        }
+
+        QJsonObject args;
+        args.insert("sequence", double(event.sequence));
+        if(event.timestamp >= 0)
+            args.insert("latency_ms", (event.time - event.timestamp) * 1e-6);
+
+        QJsonObject traceEvent;
+        traceEvent.insert("pid", 1);
+        traceEvent.insert("tid", event.node);
+        traceEvent.insert("ts", event.time * 1e-3);
+        traceEvent.insert("cat", QString("mne_scan"));
+        traceEvent.insert("args", args);
+
+        switch(event.kind) {
+            case ProcessBegin:
+                traceEvent.insert("ph", QString("B"));
+                traceEvent.insert("name", QString("process"));
+                break;
+            case ProcessEnd:
+                traceEvent.insert("ph", QString("E"));
+                traceEvent.insert("name", QString("process"));
+                break;
+            default:
+                traceEvent.insert("ph", QString("i"));
+                traceEvent.insert("s", QString("t"));
+                traceEvent.insert("name", kindName(event.kind));
+                break;
+        }
+
+        traceEvents.append(traceEvent);
+    }
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", QString("ms"));
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTrace::clear()
+{
+    m_iFirstIndex.storeRelease(m_iWriteIndex.loadAcquire());
+}
+
+
+//*************************************************************************************************************
+
+LatencyTraceScope::LatencyTraceScope(int iNode, qint64 iTimestamp, qint64 iSequence)
+: m_iNode(iNode)
+, m_iTimestamp(iTimestamp)
+, m_iSequence(iSequence)
+{
+    LatencyTrace::instance()->record(m_iNode, LatencyTrace::ProcessBegin, m_iTimestamp, m_iSequence);
+}
+
+
+//*************************************************************************************************************
+
+LatencyTraceScope::~LatencyTraceScope()
+{
+    LatencyTrace::instance()->record(m_iNode, LatencyTrace::ProcessEnd, m_iTimestamp, m_iSequence);
+}
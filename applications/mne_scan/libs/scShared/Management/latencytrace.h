@@ -0,0 +1,324 @@
+//=============================================================================================================
+/**
+* @file     latencytrace.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains declaration of LatencyTrace class.
+*
+*/
+
+
+#ifndef LATENCYTRACE_H
+#define LATENCYTRACE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=============================================================================================================
+/**
+* The LatencyTrace records when data blocks pass the connectors and plugins of the mne_scan pipeline. Events
+* are written into a fixed size ring without taking a lock, so recording can stay enabled during a measurement.
+* Latencies are measured against the acquisition timestamp of each block, see SCMEASLIB::Measurement.
+*
+* @brief Lock-free recorder of per-block pipeline timings
+*/
+class SCSHAREDSHARED_EXPORT LatencyTrace
+{
+public:
+    //=========================================================================================================
+    /**
+    * The kind of a trace event.
+    */
+    enum EventKind {
+        Sent = 0,           /**< A block left an output connector. */
+        Received = 1,       /**< A block arrived at an input connector. */
+        ProcessBegin = 2,   /**< A plugin started to process a block. */
+        ProcessEnd = 3      /**< A plugin finished processing a block. */
+    };
+
+    //=========================================================================================================
+    /**
+    * A single trace event. All times are in nanoseconds on the SCMEASLIB::Measurement::monotonicTime() clock.
+    */
+    struct Event {
+        qint64 time;        /**< When the event happened. */
+        qint64 timestamp;   /**< Acquisition time of the block, -1 if unknown. */
+        qint64 sequence;    /**< Sequence number of the block. */
+        qint32 node;        /**< The node, see registerNode(). */
+        qint32 kind;        /**< The EventKind. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Summary of the events of one node. Latencies and processing times are in milliseconds.
+    */
+    struct NodeStatistics {
+        QString         name;               /**< Name of the node. */
+        int             count;              /**< Number of blocks seen. */
+        double          throughput;         /**< Blocks per second. */
+        double          meanLatency;        /**< Mean latency since acquisition. */
+        double          p95Latency;         /**< 95th percentile of the latency. */
+        double          maxLatency;         /**< Maximum latency. */
+        double          meanProcessing;     /**< Mean processing time, 0 for connectors. */
+        QVector<int>    histogram;          /**< Latency counts, bin i holds [2^i, 2^(i+1)) microseconds, the outer bins are open. */
+    };
+
+    static const int s_iHistogramBins = 20;     /**< Number of latency histogram bins. */
+
+    //=========================================================================================================
+    /**
+    * Returns the trace of the application.
+    *
+    * @return the global trace
+    */
+    static LatencyTrace* instance();
+
+    //=========================================================================================================
+    /**
+    * Destroys the trace
+    */
+    ~LatencyTrace();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables recording. A disabled trace ignores record() calls. Disabled by default.
+    *
+    * @param[in] bEnabled   whether to record
+    */
+    inline void setEnabled(bool bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Returns whether events are recorded.
+    *
+    * @return true if recording
+    */
+    inline bool isEnabled() const;
+
+    //=========================================================================================================
+    /**
+    * Registers a node (a connector or a plugin). Registering the same name twice returns the same id.
+    *
+    * @param[in] sName      the unique node name
+    *
+    * @return the node id to pass to record()
+    */
+    int registerNode(const QString& sName);
+
+    //=========================================================================================================
+    /**
+    * Returns the name of a node.
+    *
+    * @param[in] iNode      the node id
+    *
+    * @return the name, empty if the id is unknown
+    */
+    QString nodeName(int iNode) const;
+
+    //=========================================================================================================
+    /**
+    * Records an event. Wait-free, may be called from any thread.
+    *
+    * @param[in] iNode      the node id
+    * @param[in] kind       the kind of the event
+    * @param[in] iTimestamp acquisition time of the block, -1 if unknown
+    * @param[in] iSequence  sequence number of the block
+    */
+    inline void record(int iNode, EventKind kind, qint64 iTimestamp, qint64 iSequence);
+
+    //=========================================================================================================
+    /**
+    * Returns the recorded events still held in the ring, oldest first. Events which are overwritten while
+    * being copied are left out.
+    *
+    * @return the events
+    */
+    QVector<Event> snapshot() const;
+
+    //=========================================================================================================
+    /**
+    * Computes per node statistics of the recent events.
+    *
+    * @param[in] iWindow    length of the evaluated time window in nanoseconds
+    *
+    * @return the statistics of all nodes with events in the window
+    */
+    QList<NodeStatistics> statistics(qint64 iWindow) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the recorded events to a CSV file, one event per line.
+    *
+    * @param[in] sFileName  the file to write
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool exportCsv(const QString& sFileName) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the recorded events in the Trace Event JSON format read by chrome://tracing and Perfetto.
+    * Processing is shown as slices, sends and receives as instant events.
+    *
+    * @param[in] sFileName  the file to write
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool exportChromeTrace(const QString& sFileName) const;
+
+    //=========================================================================================================
+    /**
+    * Drops all recorded events. Registered nodes are kept.
+    */
+    void clear();
+
+private:
+    //=========================================================================================================
+    /**
+    * Constructs the trace, use instance().
+    */
+    LatencyTrace();
+
+    //=========================================================================================================
+    /**
+    * Stores an event with the current time in the ring.
+    */
+    void write(int iNode, EventKind kind, qint64 iTimestamp, qint64 iSequence);
+
+    /**
+    * A ring slot, guarded by a sequence lock. The version is 2*(index+1) once event number index is
+    * complete and odd while it is being written.
+    */
+    struct Slot {
+        QAtomicInteger<quint32>     version;
+        Event                       event;
+    };
+
+    static const quint32 s_iCapacity = 1 << 16;    /**< Number of slots, a power of two. */
+
+    Slot*                       m_pSlots;           /**< The ring. */
+    QAtomicInteger<quint32>     m_iWriteIndex;      /**< Number of the next event to write. */
+    QAtomicInteger<quint32>     m_iFirstIndex;      /**< Number of the first event not cleared. */
+    QAtomicInt                  m_bEnabled;         /**< Whether to record. */
+    mutable QMutex              m_qMutexNodes;      /**< Guards the node names. */
+    QStringList                 m_lNodeNames;       /**< Names of the registered nodes. */
+};
+
+
+//=============================================================================================================
+/**
+* Records ProcessBegin on construction and ProcessEnd on destruction. Use it in plugins which process their
+* data in a thread of their own.
+*
+* @brief Scoped processing event pair
+*/
+class SCSHAREDSHARED_EXPORT LatencyTraceScope
+{
+public:
+    //=========================================================================================================
+    /**
+    * Records ProcessBegin.
+    *
+    * @param[in] iNode      the node id
+    * @param[in] iTimestamp acquisition time of the processed block, -1 if unknown
+    * @param[in] iSequence  sequence number of the processed block
+    */
+    LatencyTraceScope(int iNode, qint64 iTimestamp, qint64 iSequence);
+
+    //=========================================================================================================
+    /**
+    * Records ProcessEnd.
+    */
+    ~LatencyTraceScope();
+
+private:
+    int     m_iNode;        /**< The node. */
+    qint64  m_iTimestamp;   /**< Acquisition time of the block. */
+    qint64  m_iSequence;    /**< Sequence number of the block. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline void LatencyTrace::setEnabled(bool bEnabled)
+{
+    m_bEnabled.store(bEnabled ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+inline bool LatencyTrace::isEnabled() const
+{
+    return m_bEnabled.load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+inline void LatencyTrace::record(int iNode, EventKind kind, qint64 iTimestamp, qint64 iSequence)
+{
+    if(!isEnabled() || iNode < 0)
+        return;
+
+    write(iNode, kind, iTimestamp, iSequence);
+}
+
+} // NAMESPACE
+
+#endif // LATENCYTRACE_H
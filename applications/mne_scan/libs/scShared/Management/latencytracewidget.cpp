@@ -0,0 +1,232 @@
+//=============================================================================================================
+/**
+* @file     latencytracewidget.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains definition of LatencyTraceWidget class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "latencytracewidget.h"
+#include "latencytrace.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Length of the evaluated time window in nanoseconds.
+*/
+static const qint64 s_iWindow = 10000000000LL;
+
+/**
+* Draws a histogram as a row of block characters of increasing height.
+*/
+static QString histogramBar(const QVector<int>& histogram)
+{
+    //Space and the unicode lower block elements one to eight eighths
+    static const ushort s_levels[] = {0x0020, 0x2581, 0x2582, 0x2583, 0x2584, 0x2585, 0x2586, 0x2587, 0x2588};
+    static const int s_iLevels = sizeof(s_levels) / sizeof(s_levels[0]);
+
+    int iMax = 0;
+    int iFirst = histogram.size();
+    int iLast = -1;
+    for(int i = 0; i < histogram.size(); ++i) {
+        iMax = qMax(iMax, histogram[i]);
+        if(histogram[i] > 0) {
+            iFirst = qMin(iFirst, i);
+            iLast = i;
+        }
+    }
+
+    if(iMax == 0)
+        return QString();
+
+    QString sBar;
+    for(int i = iFirst; i <= iLast; ++i)
+        sBar += QChar(s_levels[(histogram[i] * (s_iLevels - 1) + iMax - 1) / iMax]);
+
+    return QString("%1us %2 %3us").arg(1 << iFirst).arg(sBar).arg(1 << (iLast + 1));
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+LatencyTraceWidget::LatencyTraceWidget(QWidget *parent)
+: QWidget(parent)
+{
+    m_pTable = new QTableWidget(0, 7, this);
+    m_pTable->setHorizontalHeaderLabels(QStringList() << tr("Node") << tr("Blocks/s") << tr("Mean [ms]")
+                                        << tr("P95 [ms]") << tr("Max [ms]") << tr("Processing [ms]") << tr("Latency histogram"));
+    m_pTable->horizontalHeader()->setStretchLastSection(true);
+    m_pTable->verticalHeader()->hide();
+    m_pTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_pCheckRecord = new QCheckBox(tr("Record"), this);
+    m_pCheckRecord->setChecked(LatencyTrace::instance()->isEnabled());
+    connect(m_pCheckRecord, &QCheckBox::toggled, this, [](bool bChecked) {
+        LatencyTrace::instance()->setEnabled(bChecked);
+    });
+
+    QPushButton* pButtonCsv = new QPushButton(tr("Export CSV..."), this);
+    connect(pButtonCsv, &QPushButton::clicked, this, &LatencyTraceWidget::exportCsv);
+
+    QPushButton* pButtonTrace = new QPushButton(tr("Export Trace..."), this);
+    connect(pButtonTrace, &QPushButton::clicked, this, &LatencyTraceWidget::exportChromeTrace);
+
+    QPushButton* pButtonClear = new QPushButton(tr("Clear"), this);
+    connect(pButtonClear, &QPushButton::clicked, this, &LatencyTraceWidget::clearTrace);
+
+    QHBoxLayout* pButtonLayout = new QHBoxLayout;
+    pButtonLayout->addWidget(m_pCheckRecord);
+    pButtonLayout->addStretch();
+    pButtonLayout->addWidget(pButtonCsv);
+    pButtonLayout->addWidget(pButtonTrace);
+    pButtonLayout->addWidget(pButtonClear);
+
+    QVBoxLayout* pLayout = new QVBoxLayout;
+    pLayout->setMargin(5);
+    pLayout->addWidget(m_pTable);
+    pLayout->addLayout(pButtonLayout);
+    setLayout(pLayout);
+
+    m_timer.setInterval(1000);
+    connect(&m_timer, &QTimer::timeout, this, &LatencyTraceWidget::refresh);
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTraceWidget::refresh()
+{
+    QList<LatencyTrace::NodeStatistics> lStatistics = LatencyTrace::instance()->statistics(s_iWindow);
+
+    m_pTable->setRowCount(lStatistics.size());
+
+    for(int i = 0; i < lStatistics.size(); ++i) {
+        const LatencyTrace::NodeStatistics& stats = lStatistics[i];
+
+        m_pTable->setItem(i, 0, new QTableWidgetItem(stats.name));
+        m_pTable->setItem(i, 1, new QTableWidgetItem(QString::number(stats.throughput, 'f', 1)));
+        m_pTable->setItem(i, 2, new QTableWidgetItem(QString::number(stats.meanLatency, 'f', 2)));
+        m_pTable->setItem(i, 3, new QTableWidgetItem(QString::number(stats.p95Latency, 'f', 2)));
+        m_pTable->setItem(i, 4, new QTableWidgetItem(QString::number(stats.maxLatency, 'f', 2)));
+        m_pTable->setItem(i, 5, new QTableWidgetItem(stats.meanProcessing > 0 ? QString::number(stats.meanProcessing, 'f', 2) : QString("-")));
+        m_pTable->setItem(i, 6, new QTableWidgetItem(histogramBar(stats.histogram)));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTraceWidget::showEvent(QShowEvent *event)
+{
+    m_pCheckRecord->setChecked(LatencyTrace::instance()->isEnabled());
+    refresh();
+    m_timer.start();
+
+    QWidget::showEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTraceWidget::hideEvent(QHideEvent *event)
+{
+    m_timer.stop();
+
+    QWidget::hideEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTraceWidget::exportCsv()
+{
+    QString sFileName = QFileDialog::getSaveFileName(this, tr("Export Latency Trace"), QString("latency_trace.csv"), tr("CSV files (*.csv)"));
+    if(sFileName.isEmpty())
+        return;
+
+    if(!LatencyTrace::instance()->exportCsv(sFileName))
+        QMessageBox::warning(this, tr("Export Latency Trace"), tr("Could not write %1").arg(sFileName));
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTraceWidget::exportChromeTrace()
+{
+    QString sFileName = QFileDialog::getSaveFileName(this, tr("Export Latency Trace"), QString("latency_trace.json"), tr("Trace files (*.json)"));
+    if(sFileName.isEmpty())
+        return;
+
+    if(!LatencyTrace::instance()->exportChromeTrace(sFileName))
+        QMessageBox::warning(this, tr("Export Latency Trace"), tr("Could not write %1").arg(sFileName));
+}
+
+
+//*************************************************************************************************************
+
+void LatencyTraceWidget::clearTrace()
+{
+    LatencyTrace::instance()->clear();
+    refresh();
+}
@@ -0,0 +1,117 @@
+//=============================================================================================================
+/**
+* @file     latencytracewidget.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains declaration of LatencyTraceWidget class.
+*
+*/
+
+
+#ifndef LATENCYTRACEWIDGET_H
+#define LATENCYTRACEWIDGET_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QWidget>
+#include <QTimer>
+#include <QTableWidget>
+#include <QCheckBox>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=============================================================================================================
+/**
+* Shows the throughput and the latency distribution of every connector and plugin as recorded by the
+* LatencyTrace, refreshed once a second. The recorded events can be exported for offline analysis.
+*
+* @brief Live view of the LatencyTrace
+*/
+class SCSHAREDSHARED_EXPORT LatencyTraceWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a LatencyTraceWidget which is a child of parent.
+    *
+    * @param [in] parent pointer to parent widget
+    */
+    LatencyTraceWidget(QWidget *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Recomputes the statistics and updates the table.
+    */
+    void refresh();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Starts the refresh timer.
+    */
+    void showEvent(QShowEvent *event);
+
+    //=========================================================================================================
+    /**
+    * Stops the refresh timer.
+    */
+    void hideEvent(QHideEvent *event);
+
+private:
+    void exportCsv();           /**< Asks for a file name and exports the events as CSV. */
+    void exportChromeTrace();   /**< Asks for a file name and exports the events as trace JSON. */
+    void clearTrace();          /**< Drops the recorded events. */
+
+    QTableWidget*   m_pTable;           /**< One row per node. */
+    QCheckBox*      m_pCheckRecord;     /**< Enables the recording. */
+    QTimer          m_timer;            /**< Refresh timer. */
+};
+
+} // NAMESPACE
+
+#endif // LATENCYTRACEWIDGET_H
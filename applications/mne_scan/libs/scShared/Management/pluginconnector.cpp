@@ -40,6 +40,7 @@
 
 #include "pluginconnector.h"
 #include "../Interfaces/IPlugin.h"
+#include "latencytrace.h"
 
 
 //*************************************************************************************************************
@@ -60,5 +61,20 @@ PluginConnector::PluginConnector(IPlugin *parent, const QString &name, const QSt
 , m_pPlugin(parent)
 , m_sName(name)
 , m_sDescription(descr)
+, m_iTraceNode(-1)
 {
 }
+
+
+//*************************************************************************************************************
+
+int PluginConnector::traceNode()
+{
+    int iNode = m_iTraceNode.load();
+    if(iNode < 0) {
+        //Registering twice yields the same id, so racing callers are harmless
+        iNode = LatencyTrace::instance()->registerNode(QString("%1::%2").arg(m_pPlugin ? m_pPlugin->getName() : QString(), m_sName));
+        m_iTraceNode.store(iNode);
+    }
+    return iNode;
+}
@@ -53,6 +53,7 @@
 #include <QMutex>
 #include <QSet>
 #include <QSharedPointer>
+#include <QAtomicInt>
 
 
 //*************************************************************************************************************
@@ -130,6 +131,14 @@ signals:
 
 
 protected:
+    //=========================================================================================================
+    /**
+    * Returns the id of this connector in the LatencyTrace, registered as "<plugin>::<connector>" on first use.
+    *
+    * @return the trace node id
+    */
+    int traceNode();
+
     IPlugin* m_pPlugin;  /**< Plugin to which connector belongs to */
 
     //actual obeserver pattern - think of an other implementation --> currently similiar to OpenWalnut
@@ -139,6 +148,7 @@ protected:
 private:
     QString m_sName;        /**< Connection name */
     QString m_sDescription; /**< Connection description */
+    QAtomicInt m_iTraceNode; /**< Id in the latency trace, -1 until registered */
 
 };
 
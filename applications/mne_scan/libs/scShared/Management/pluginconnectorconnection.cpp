@@ -89,6 +89,11 @@ void PluginConnectorConnection::clearConnection()
         disconnect(it.value());
 
     m_qHashConnections.clear();
+
+    for(qint32 i = 0; i < m_qListBlockConnections.size(); ++i)
+        disconnect(m_qListBlockConnections[i]);
+
+    m_qListBlockConnections.clear();
 }
 
 
@@ -170,6 +175,11 @@ bool PluginConnectorConnection::createConnection()
             break;
     }
 
+    //Blocks for plugins in dataflow mode take the same edge, directly in the thread of the sender
+    if(bConnected)
+        m_qListBlockConnections.append(connect(m_pSender->getOutputConnectors()[i].data(), &PluginOutputConnector::notifyBlock,
+                                               m_pReceiver->getInputConnectors()[j].data(), &PluginInputConnector::updateBlock, Qt::DirectConnection));
+
     //DEBUG
     QHash<QPair<QString, QString>, QMetaObject::Connection>::iterator it;
     for (it = m_qHashConnections.begin(); it != m_qHashConnections.end(); ++it)
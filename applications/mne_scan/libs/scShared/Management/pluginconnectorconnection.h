@@ -56,6 +56,7 @@
 #include <QObject>
 #include <QMetaObject>
 #include <QSharedPointer>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -147,6 +148,7 @@ private:
     IPlugin::SPtr m_pReceiver;
 
     QHash<QPair<QString, QString>, QMetaObject::Connection> m_qHashConnections; /**< QHash which holds the connections between sender and receiver QHash<QPair<Sender,Receiver>, Connection>. */
+    QList<QMetaObject::Connection> m_qListBlockConnections;                     /**< Connections which pass DataBlocks between sender and receiver. */
 };
 
 //*************************************************************************************************************
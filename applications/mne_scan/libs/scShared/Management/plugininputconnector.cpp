@@ -40,6 +40,7 @@
 
 #include "plugininputconnector.h"
 #include "../Interfaces/IPlugin.h"
+#include "latencytrace.h"
 
 
 //*************************************************************************************************************
@@ -81,5 +82,20 @@ bool PluginInputConnector::isOutputConnector() const
 
 void PluginInputConnector::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 {
+    if(m_pPlugin && m_pPlugin->isDataflowMode())
+        return;
+
+    LatencyTrace::instance()->record(traceNode(), LatencyTrace::Received, pMeasurement->timestamp(), pMeasurement->sequenceNumber());
+
     emit notify(pMeasurement);
 }
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::updateBlock(SCSHAREDLIB::DataBlock::ConstSPtr pBlock)
+{
+    LatencyTrace::instance()->record(traceNode(), LatencyTrace::Received, pBlock->timestamp(), pBlock->sequence());
+
+    emit notifyBlock(pBlock);
+}
@@ -112,9 +112,32 @@ public:
 signals:
     void notify(SCMEASLIB::Measurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Emitted when a block arrives at this connector, directly in the thread of the sender.
+    *
+    * @param[in] pBlock     the immutable block
+    */
+    void notifyBlock(SCSHAREDLIB::DataBlock::ConstSPtr pBlock);
+
 public slots:
+    //=========================================================================================================
+    /**
+    * Forwards the measurement to the plugin. Nothing is forwarded while the plugin runs in dataflow mode,
+    * it receives the same update through updateBlock instead.
+    *
+    * @param[in] pMeasurement   the updated measurement
+    */
     void update(SCMEASLIB::Measurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Forwards a block to the dataflow scheduler.
+    *
+    * @param[in] pBlock     the immutable block
+    */
+    void updateBlock(SCSHAREDLIB::DataBlock::ConstSPtr pBlock);
+
 
 
 };
@@ -40,6 +40,15 @@
 
 #include "pluginoutputconnector.h"
 #include "../Interfaces/IPlugin.h"
+#include "latencytrace.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMetaMethod>
 
 
 //*************************************************************************************************************
@@ -76,3 +85,15 @@ bool PluginOutputConnector::isOutputConnector() const
     return true;
 }
 
+
+//*************************************************************************************************************
+
+void PluginOutputConnector::send(SCMEASLIB::Measurement::SPtr pMeasurement)
+{
+    LatencyTrace::instance()->record(traceNode(), LatencyTrace::Sent, pMeasurement->timestamp(), pMeasurement->sequenceNumber());
+
+    emit notify(pMeasurement);
+
+    if(isSignalConnected(QMetaMethod::fromSignal(&PluginOutputConnector::notifyBlock)))
+        emit notifyBlock(DataBlock::fromMeasurement(pMeasurement));
+}
@@ -43,6 +43,7 @@
 #include "../scshared_global.h"
 
 #include "pluginconnector.h"
+#include "datablock.h"
 #include <scMeas/measurement.h>
 
 
@@ -99,9 +100,26 @@ public:
      */
     virtual bool isOutputConnector() const;
 
+    //=========================================================================================================
+    /**
+    * Sends a measurement to the connected plugins. Besides the notify signal, a DataBlock snapshot is created
+    * once and handed to plugins running in dataflow mode.
+    *
+    * @param[in] pMeasurement   the updated measurement
+    */
+    void send(SCMEASLIB::Measurement::SPtr pMeasurement);
+
 signals:
     void notify(SCMEASLIB::Measurement::SPtr);
 
+    //=========================================================================================================
+    /**
+    * Emitted for every sent measurement, directly in the thread of the sender.
+    *
+    * @param[in] pBlock     the immutable snapshot of the measurement
+    */
+    void notifyBlock(SCSHAREDLIB::DataBlock::ConstSPtr pBlock);
+
 };
 
 } // NAMESPACE
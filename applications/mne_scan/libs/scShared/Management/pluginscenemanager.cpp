@@ -56,6 +56,8 @@ using namespace SCSHAREDLIB;
 
 PluginSceneManager::PluginSceneManager(QObject *parent)
 : QObject(parent)
+, m_pDataflowScheduler(new DataflowScheduler)
+, m_bDataflowEnabled(false)
 {
 }
 
@@ -123,6 +125,7 @@ bool PluginSceneManager::removePlugin(const IPlugin::SPtr pPlugin)
     }
     if(pos != -1)
     {
+        m_pDataflowScheduler->clear();
         m_pluginList.removeAt(pos);
         return true;
     }
@@ -135,6 +138,9 @@ bool PluginSceneManager::removePlugin(const IPlugin::SPtr pPlugin)
 
 bool PluginSceneManager::startPlugins()
 {
+    // The scheduler has to accept blocks before the sensors send any
+    setupDataflow();
+
     // Start ISensor and IRTAlgorithm plugins first!
     bool bFlag = startSensorPlugins();
 
@@ -205,6 +211,9 @@ void PluginSceneManager::stopPlugins()
             if(!(*it)->stop())
                 qWarning() << "Could not stop IPlugin: " << (*it)->getName();
 
+    // No more blocks are flowing, let the running ones finish
+    m_pDataflowScheduler->stop();
+
     // Stop all other plugins!
     it = m_pluginList.begin();
     for( ; it != m_pluginList.end(); ++it)
@@ -218,5 +227,26 @@ void PluginSceneManager::stopPlugins()
 
 void PluginSceneManager::clear()
 {
+    m_pDataflowScheduler->clear();
 //    m_pluginList.clear();
 }
+
+
+//*************************************************************************************************************
+
+void PluginSceneManager::setupDataflow()
+{
+    m_pDataflowScheduler->clear();
+
+    QList<IPlugin::SPtr>::iterator it = m_pluginList.begin();
+    for( ; it != m_pluginList.end(); ++it)
+    {
+        bool bDataflow = m_bDataflowEnabled && (*it)->supportsDataflow();
+        (*it)->setDataflowMode(bDataflow);
+        if(bDataflow)
+            m_pDataflowScheduler->addPlugin(*it);
+    }
+
+    if(m_bDataflowEnabled)
+        m_pDataflowScheduler->start();
+}
@@ -44,6 +44,7 @@
 #include "../scshared_global.h"
 #include "../Interfaces/IPlugin.h"
 #include "pluginconnectorconnection.h"
+#include "dataflowscheduler.h"
 
 
 //*************************************************************************************************************
@@ -155,11 +156,38 @@ public:
     */
     void clear();
 
+    //=========================================================================================================
+    /**
+    * Switches the dataflow execution mode on or off. In dataflow mode, plugins which support it are driven by a
+    * shared DataflowScheduler instead of their own threads. Takes effect with the next startPlugins().
+    *
+    * @param[in] bEnabled   whether to use the dataflow mode
+    */
+    inline void setDataflowEnabled(bool bEnabled);
+
+    inline bool isDataflowEnabled() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the scheduler which drives the plugins in dataflow mode.
+    *
+    * @return the dataflow scheduler
+    */
+    inline DataflowScheduler::SPtr getDataflowScheduler();
+
 signals:
 
 
 private:
+    //=========================================================================================================
+    /**
+    * Sets the dataflow mode of all plugins and attaches the supporting ones to the scheduler.
+    */
+    void setupDataflow();
+
     PluginList m_pluginList;    /**< List of plugins associated with this set. */
+    DataflowScheduler::SPtr m_pDataflowScheduler;   /**< Drives the plugins in dataflow mode. */
+    bool m_bDataflowEnabled;                        /**< Whether the dataflow mode is used. */
 //    PluginConnectorConnectionList m_conConList; /**< List of connector connections. */
 
 //    QSharedPointer<PluginSet> m_pPluginSet;     /**< The Plugin set of the stage -> ToDo: check, if more than one set on the stage is usefull. */
@@ -175,6 +203,30 @@ inline PluginSceneManager::PluginList& PluginSceneManager::getPlugins()
     return m_pluginList;
 }
 
+
+//*************************************************************************************************************
+
+inline void PluginSceneManager::setDataflowEnabled(bool bEnabled)
+{
+    m_bDataflowEnabled = bEnabled;
+}
+
+
+//*************************************************************************************************************
+
+inline bool PluginSceneManager::isDataflowEnabled() const
+{
+    return m_bDataflowEnabled;
+}
+
+
+//*************************************************************************************************************
+
+inline DataflowScheduler::SPtr PluginSceneManager::getDataflowScheduler()
+{
+    return m_pDataflowScheduler;
+}
+
 } //Namespace
 
 #endif // PLUGINSCENEMANAGER_H
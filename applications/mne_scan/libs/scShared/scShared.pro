@@ -76,7 +76,11 @@ SOURCES += \
     Management/pluginconnectorconnection.cpp \
     Management/pluginconnectorconnectionwidget.cpp \
     Management/pluginscenemanager.cpp \
-    Management/displaymanager.cpp
+    Management/displaymanager.cpp \
+    Management/datablock.cpp \
+    Management/dataflowscheduler.cpp \
+    Management/latencytrace.cpp \
+    Management/latencytracewidget.cpp
 
 HEADERS += \
     scshared_global.h \
@@ -93,7 +97,11 @@ HEADERS += \
     Management/pluginconnectorconnection.h \
     Management/pluginconnectorconnectionwidget.h \
     Management/pluginscenemanager.h \
-    Management/displaymanager.h
+    Management/displaymanager.h \
+    Management/datablock.h \
+    Management/dataflowscheduler.h \
+    Management/latencytrace.h \
+    Management/latencytracewidget.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
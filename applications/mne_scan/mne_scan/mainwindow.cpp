@@ -41,6 +41,8 @@
 #include <scShared/Management/pluginmanager.h>
 #include <scShared/Management/pluginscenemanager.h>
 #include <scShared/Management/displaymanager.h>
+#include <scShared/Management/latencytrace.h>
+#include <scShared/Management/latencytracewidget.h>
 
 //GUI
 #include "mainwindow.h"
@@ -125,6 +127,7 @@ MainWindow::MainWindow(QWidget *parent)
     createToolBars();
     createPluginDockWindow();
     createLogDockWindow();
+    createLatencyTraceDockWindow();
 
 //    //ToDo Debug Startup
 //    writeToLog(tr("Test normal message, Max"), _LogKndMessage, _LogLvMax);
@@ -587,6 +590,22 @@ void MainWindow::createLogDockWindow()
 }
 
 
+//*************************************************************************************************************
+
+void MainWindow::createLatencyTraceDockWindow()
+{
+    m_pDockWidget_LatencyTrace = new QDockWidget(tr("Latency Trace"), this);
+    m_pDockWidget_LatencyTrace->setWidget(new SCSHAREDLIB::LatencyTraceWidget(m_pDockWidget_LatencyTrace));
+
+    m_pDockWidget_LatencyTrace->setAllowedAreas(Qt::BottomDockWidgetArea);
+    addDockWidget(Qt::BottomDockWidgetArea, m_pDockWidget_LatencyTrace);
+
+    m_pDockWidget_LatencyTrace->hide();
+
+    m_pMenuView->addAction(m_pDockWidget_LatencyTrace->toggleViewAction());
+}
+
+
 //*************************************************************************************************************
 //Plugin stuff
 void MainWindow::updatePluginWidget(SCSHAREDLIB::IPlugin::SPtr pPlugin)
@@ -690,6 +709,14 @@ void MainWindow::startMeasurement()
 {
     writeToLog(tr("Starting real-time measurement..."), _LogKndMessage, _LogLvMin);
 
+    //Opt-in: drive the plugins which support it by the shared dataflow scheduler
+    QSettings settings;
+    m_pPluginSceneManager->setDataflowEnabled(settings.value(QString("MNEScan/dataflowMode"), false).toBool());
+
+    //Tracing can also be switched on in the latency trace view
+    if(settings.value(QString("MNEScan/latencyTrace"), false).toBool())
+        SCSHAREDLIB::LatencyTrace::instance()->setEnabled(true);
+
     if(!m_pPluginSceneManager->startPlugins())
     {
         QMessageBox::information(0, tr("MNE Scan - Start"), QString(QObject::tr("Not able to start at least one sensor plugin!")), QMessageBox::Ok);
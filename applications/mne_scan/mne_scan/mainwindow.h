@@ -247,6 +247,7 @@ private:
 
     void createPluginDockWindow();                          /**< Creates plugin dock widget.*/
     void createLogDockWindow();                             /**< Creates log dock widget.*/
+    void createLatencyTraceDockWindow();                    /**< Creates latency trace dock widget.*/
 
     //Plugin Management
     QDockWidget*                        m_pPluginGuiDockWidget;         /**< Dock widget which holds the plugin gui. */
@@ -260,6 +261,9 @@ private:
 
     LogLevel                            m_eLogLevelCurrent;             /**< Holds the current log level.*/
 
+    //Latency trace
+    QDockWidget*                        m_pDockWidget_LatencyTrace;     /**< Holds the dock widget containing the latency trace view.*/
+
     QSharedPointer<QWidget>             m_pAboutWindow;                 /**< Holds the widget containing the about information.*/
 
     void updatePluginWidget(QSharedPointer<SCSHAREDLIB::IPlugin> pPlugin);                           /**< Sets the plugin widget to central widget of MainWindow class depending on the current plugin selected in m_pDockWidgetPlugins.*/
@@ -225,7 +225,7 @@ void Averaging::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pAveragingBuffer) {
-            m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pAveragingBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff information
@@ -234,9 +234,8 @@ void Averaging::update(SCMEASLIB::Measurement::SPtr pMeasurement)
         }
 
         if(m_bProcessData) {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i) {
-                MatrixXd t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pAveragingBuffer->push(&t_mat);
+            for(qint32 i = 0; i < pRTMSA->getMultiSampleBlockSizes().size(); ++i) {
+                m_pAveragingBuffer->push(pRTMSA->getMultiSampleBlock(i));
             }
         }
     }
@@ -111,7 +111,6 @@ BabyMEG::BabyMEG()
 , m_sFiffCompensators(QCoreApplication::applicationDirPath() + "/resources/mne_scan/plugins/babymeg/compensator.fif")
 , m_sBadChannels(QCoreApplication::applicationDirPath() + "/resources/mne_scan/plugins/babymeg/both.bad")
 , m_iRecordingMSeconds(5*60*1000)
-, m_iSplitCount(0)
 , m_bDoContinousHPI(false)
 {
     m_pActionSetupProject = new QAction(QIcon(":/images/database.png"), tr("Setup Project"),this);
@@ -168,6 +167,9 @@ BabyMEG::BabyMEG()
                 this, &BabyMEG::onRecordingRemainingTimeChange);
     }
 
+    //Init the raw data writer which records in its own thread
+    m_pRawWriter = FiffRawWriter::SPtr(new FiffRawWriter);
+
     //If the basic MNE Scan version is to be build hide the HPI and squid control actions in the toolbar
     #ifdef BUILD_BASIC_MNESCAN_VERSION
     m_pActionSqdCtrl->setVisible(false);
@@ -303,6 +305,7 @@ bool BabyMEG::stop()
 
     //Clear Buffers
     m_pRawMatrixBuffer->clear();
+    m_qTimestamps.clear();
 
     return true;
 }
@@ -344,12 +347,12 @@ QWidget* BabyMEG::setupWidget()
 void BabyMEG::run()
 {
     MatrixXf matValue;
-    qint32 size = 0;
 
     while(m_bIsRunning) {
         if(m_pRawMatrixBuffer) {
             //pop matrix
             matValue = m_pRawMatrixBuffer->pop();
+            qint64 iTimestamp = m_qTimestamps.pop();
 
             //Update HPI data (for single and continous HPI fitting)
             updateHPI(matValue);
@@ -362,23 +365,13 @@ void BabyMEG::run()
             //Create digital trigger information
             createDigTrig(matValue);
 
-            //Write raw data to fif file
+            //Write raw data to fif file. The writer thread does the disk I/O and the file splitting.
             if(m_bWriteToFile) {
-                size += matValue.rows()*matValue.cols() * 4;
-
-                if(size > MAX_DATA_LEN) {
-                    size = 0;
-                    this->splitRecordingFile();
-                }
-
-                m_mutex.lock();
-                m_pOutfid->write_raw_buffer(matValue.cast<double>());
-                m_mutex.unlock();
-            } else {
-                size = 0;
+                m_pRawWriter->writeUncalibrated(matValue);
             }
 
             if(m_pRTMSABabyMEG) {
+                m_pRTMSABabyMEG->data()->setTimestamp(iTimestamp);
                 m_pRTMSABabyMEG->data()->setValue(this->calibrate(matValue));
             }
         }
@@ -504,6 +497,9 @@ void BabyMEG::setFiffInfo(const FiffInfo& p_FiffInfo)
 
 void BabyMEG::setFiffData(QByteArray DATA)
 {
+    //the data arrived just now
+    qint64 iTimestamp = Measurement::monotonicTime();
+
     //get the first byte -- the data format
     int dformat = DATA.left(1).toInt();
 
@@ -524,6 +520,8 @@ void BabyMEG::setFiffData(QByteArray DATA)
         if(!m_pRawMatrixBuffer)
             m_pRawMatrixBuffer = CircularMatrixBuffer<float>::SPtr(new CircularMatrixBuffer<float>(40, rows, cols));
 
+        //Stamp before pushing, the block may be popped right away
+        m_qTimestamps.push(iTimestamp);
         m_pRawMatrixBuffer->push(&rawData);
     }
 
@@ -745,49 +743,14 @@ void BabyMEG::showSqdCtrlDialog()
 }
 
 
-//*************************************************************************************************************
-
-void BabyMEG::splitRecordingFile()
-{
-    //qDebug() << "Split recording file";
-    ++m_iSplitCount;
-    QString nextFileName = m_sRecordFile.remove("_raw.fif");
-    nextFileName += QString("-%1_raw.fif").arg(m_iSplitCount);
-
-    //Write the link to the next file
-    qint32 data;
-    m_pOutfid->start_block(FIFFB_REF);
-    data = FIFFV_ROLE_NEXT_FILE;
-    m_pOutfid->write_int(FIFF_REF_ROLE,&data);
-    m_pOutfid->write_string(FIFF_REF_FILE_NAME, nextFileName);
-    m_pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
-    data = m_iSplitCount - 1;
-    m_pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
-    m_pOutfid->end_block(FIFFB_REF);
-
-    //finish file
-    m_pOutfid->finish_writing_raw();
-
-    //start next file
-    m_qFileOut.setFileName(nextFileName);
-    m_pOutfid = FiffStream::start_writing_raw(m_qFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
-    fiff_int_t first = 0;
-    m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
-}
-
-
 //*************************************************************************************************************
 
 void BabyMEG::toggleRecordingFile()
 {
     //Setup writing to file
     if(m_bWriteToFile) {
-        m_mutex.lock();
-        m_pOutfid->finish_writing_raw();
-        m_mutex.unlock();
-
         m_bWriteToFile = false;
-        m_iSplitCount = 0;
+        m_pRawWriter->close();
 
         //Stop record timer
         m_pRecordTimer->stop();
@@ -796,8 +759,6 @@ void BabyMEG::toggleRecordingFile()
 
         m_pActionRecordFile->setIcon(QIcon(":/images/record.png"));
     } else {
-        m_iSplitCount = 0;
-
         if(!m_pFiffInfo) {
             QMessageBox msgBox;
             msgBox.setText("FiffInfo missing!");
@@ -807,8 +768,7 @@ void BabyMEG::toggleRecordingFile()
 
         //Initiate the stream for writing to the fif file
         m_sRecordFile = getFilePath(true);
-        m_qFileOut.setFileName(m_sRecordFile);
-        if(m_qFileOut.exists()) {
+        if(QFile::exists(m_sRecordFile)) {
             QMessageBox msgBox;
             msgBox.setText("The file you want to write already exists.");
             msgBox.setInformativeText("Do you want to overwrite this file?");
@@ -825,11 +785,13 @@ void BabyMEG::toggleRecordingFile()
         }
 
         //Start/Prepare writing process. Actual writing is done in run() method.
-        m_mutex.lock();
-        m_pOutfid = FiffStream::start_writing_raw(m_qFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
-        fiff_int_t first = 0;
-        m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
-        m_mutex.unlock();
+        m_pRawWriter->setSplitSize(MAX_DATA_LEN);
+        if(!m_pRawWriter->open(m_sRecordFile, *m_pFiffInfo)) {
+            QMessageBox msgBox;
+            msgBox.setText("The recording file could not be created.");
+            msgBox.exec();
+            return;
+        }
 
         m_bWriteToFile = true;
 
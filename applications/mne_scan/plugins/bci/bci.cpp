@@ -167,9 +167,6 @@ void BCI::init()
     // Intitalise feature selection
     m_slChosenFeatureSensor << "LA4" << "RA4"; //<< "TEST";
 
-    // Initalise sliding window stuff
-    m_bFillSensorWindowFirstTime = true;
-
     // Initialise filter stuff
     m_filterOperator = QSharedPointer<FilterData>(new FilterData());
 
@@ -211,7 +208,6 @@ bool BCI::start()
 
     // Initialise index
     m_iTBWIndexSensor = 0;
-    m_iNumberOfCalculatedFeatures = 0;
 
     // BCIFeatureWindow show and init
     if(m_bDisplayFeatures)
@@ -227,8 +223,6 @@ bool BCI::start()
 
     m_pFiffInfo_Sensor = FiffInfo::SPtr();
 
-    m_bFillSensorWindowFirstTime = true;
-
 //    // Set display ranges for output channels
 //    m_pBCIOutputOne->data()->setMaxValue(m_dDisplayRangeBoundary);
 //    m_pBCIOutputOne->data()->setMinValue(-m_dDisplayRangeBoundary);
@@ -367,35 +361,26 @@ void BCI::updateSensor(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         // Load Fiff information on sensor level
         if(!m_pFiffInfo_Sensor)
         {
-            m_pFiffInfo_Sensor = pRTMSA->info();
+            // The processing thread starts as soon as m_pFiffInfo_Sensor is set -> configure everything before
+            FiffInfo::SPtr pFiffInfo = pRTMSA->info();
 
-            // Adjust working matrixes (sliding window and time between windows matrix) size so that the samples from the tmsi plugin stream fit in the matrix perfectly
+            // Adjust sliding window and time between windows size so that the samples from the tmsi plugin stream fit in perfectly
             int arraySize = pRTMSA->getMultiArraySize();
-            int modulo = int(m_pFiffInfo_Sensor->sfreq*m_dSlidingWindowSize) % arraySize;
-            int rows = m_slChosenFeatureSensor.size();
-            int cols = m_pFiffInfo_Sensor->sfreq*m_dSlidingWindowSize-modulo;
-            m_matSlidingWindowSensor.resize(rows, cols);
+            int modulo = int(pFiffInfo->sfreq*m_dSlidingWindowSize) % arraySize;
+            int iWindowSize = pFiffInfo->sfreq*m_dSlidingWindowSize-modulo;
 
-            m_matStimChannelSensor.resize(1,cols);
+            m_matStimChannelSensor = MatrixXd::Zero(1, iWindowSize);
 
-            modulo = int(m_pFiffInfo_Sensor->sfreq*m_dTimeBetweenWindows) % arraySize;
-            rows = m_slChosenFeatureSensor.size();
-            cols = m_pFiffInfo_Sensor->sfreq*m_dTimeBetweenWindows-modulo;
-            m_matTimeBetweenWindowsSensor.resize(rows, cols);
-
-            m_matTimeBetweenWindowsStimSensor.resize(1,cols);
+            modulo = int(pFiffInfo->sfreq*m_dTimeBetweenWindows) % arraySize;
+            m_iTBWSizeSensor = pFiffInfo->sfreq*m_dTimeBetweenWindows-modulo;
 
             // Build filter operator
-            double dCenterFreqNyq = (m_dFilterLowerBound+((m_dFilterUpperBound - m_dFilterLowerBound)/2))/(m_pFiffInfo_Sensor->sfreq/2);
-            double dBandwidthNyq = (m_dFilterUpperBound - m_dFilterLowerBound)/(m_pFiffInfo_Sensor->sfreq/2);
-            double dParksWidth = m_dParcksWidth/(m_pFiffInfo_Sensor->sfreq/2);
-
-//            // Calculate needed fft length
-//            int exponent = ceil(log10(m_matSlidingWindowSensor.cols())/log10(2));
-//            int fftLength = pow(2,exponent+1);
+            double dCenterFreqNyq = (m_dFilterLowerBound+((m_dFilterUpperBound - m_dFilterLowerBound)/2))/(pFiffInfo->sfreq/2);
+            double dBandwidthNyq = (m_dFilterUpperBound - m_dFilterLowerBound)/(pFiffInfo->sfreq/2);
+            double dParksWidth = m_dParcksWidth/(pFiffInfo->sfreq/2);
 
             // Initialise filter operator
-            m_filterOperator = QSharedPointer<FilterData>(new FilterData(QString("BPF"),FilterData::BPF,m_iFilterOrder,dCenterFreqNyq,dBandwidthNyq,dParksWidth,m_matSlidingWindowSensor.cols()+m_iFilterOrder)); // letztes Argument muss 2er potenz sein - fft länge
+            m_filterOperator = QSharedPointer<FilterData>(new FilterData(QString("BPF"),FilterData::BPF,m_iFilterOrder,dCenterFreqNyq,dBandwidthNyq,dParksWidth,iWindowSize+m_iFilterOrder)); // letztes Argument muss 2er potenz sein - fft länge
 
             // Write filter coefficients to debug file
             for(int i = 0; i<m_filterOperator->m_dCoeffA.cols(); i++)
@@ -407,6 +392,20 @@ void BCI::updateSensor(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
                 m_outStreamDebug << m_filterOperator->m_dCoeffA(0,i) << endl;
 
             m_outStreamDebug << "---------------------------------------------------------------------" << endl;
+
+            // Set up the sensor level pipeline - the chosen electrodes are filtered once per sample with the time domain filter coefficients
+            QVector<int> vecPicks;
+            for(int i = 0; i < m_slChosenFeatureSensor.size(); i++)
+                vecPicks << m_mapElectrodePinningScheme[m_slChosenFeatureSensor.at(i)];
+
+            m_sensorPipeline.setChannelPicks(vecPicks);
+            m_sensorPipeline.setFilter(m_bUseFilter ? m_filterOperator->m_dCoeffA : RowVectorXd());
+            m_sensorPipeline.setWindowLength(iWindowSize);
+            m_sensorPipeline.setSubtractMean(m_bSubtractMean);
+            m_sensorPipeline.setFeatureType(m_iFeatureCalculationType == 1 ? SensorFeaturePipeline::LogVariance : SensorFeaturePipeline::Variance);
+            m_sensorPipeline.setFeatureCapacity(m_iNumberFeatures);
+
+            m_pFiffInfo_Sensor = pFiffInfo;
         }
 
         // Only process data when fiff info has been initialised in run() method
@@ -415,7 +414,7 @@ void BCI::updateSensor(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             MatrixXd t_mat(pRTMSA->getNumChannels(), pRTMSA->getMultiArraySize());
 
             for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-                t_mat.col(i) = pRTMSA->getMultiSampleArray()[i];
+                t_mat.col(i) = pRTMSA->getMultiSampleBlock(i);
 
             m_pBCIBuffer_Sensor->push(&t_mat);
         }
@@ -448,80 +447,12 @@ void BCI::updateSource(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 }
 
 
-//*************************************************************************************************************
-
-void BCI::applyMeanCorrectionConcurrently(QPair<int, RowVectorXd> &chdata)
-{
-    chdata.second = chdata.second.array() - chdata.second.mean(); // Row vector needs to be transformed to a array in order to subract a scalar
-}
-
-
-//*************************************************************************************************************
-
-void BCI::applyFilterOperatorConcurrently(QPair<int, RowVectorXd> &chdata)
-{
-    chdata.second = m_filterOperator->applyFFTFilter(chdata.second);
-}
-
-
-//*************************************************************************************************************
-
-QPair< int,QList<double> > BCI::applyFeatureCalcConcurrentlyOnSensorLevel(const QPair<int, RowVectorXd> &chdata)
-{
-    RowVectorXd data = chdata.second;
-    QList<double> features;
-
-    // TODO: Divide into subsignals
-    switch(m_iFeatureCalculationType)
-    {
-        case 0:
-            features << data.squaredNorm(); // Compute variance
-            break;
-        case 1:
-            features << std::abs(log10(data.squaredNorm())); // Compute log of variance
-            break;
-        default:
-            features << data.squaredNorm(); // Compute variance
-            break;
-    }
-
-    return QPair< int,QList<double> >(chdata.first, features);
-}
-
-
-//*************************************************************************************************************
-
-double BCI::applyClassificationCalcConcurrentlyOnSensorLevel(QList<double> &featData)
-{
-   return classificationBoundaryValue(featData);
-}
-
-
-//*************************************************************************************************************
-
-double BCI::classificationBoundaryValue(const QList<double> &featData)
-{
-    double return_val = 0;
-
-    if(featData.size() == m_vLoadedSensorBoundary[1].size())
-    {
-        VectorXd feat_temp(featData.size());
-        for(int i = 0; i<featData.size(); i++)
-            feat_temp(i) = featData.at(i);
-
-        return_val = m_vLoadedSensorBoundary[0](0) + m_vLoadedSensorBoundary[1].dot(feat_temp);
-    }
-
-    return return_val;
-}
-
-
 //*************************************************************************************************************
 
 void BCI::clearFeatures()
 {
     m_qMutex.lock();
-        m_lFeaturesSensor.clear();
+        m_sensorPipeline.clearFeatures();
     m_qMutex.unlock();
 }
 
@@ -538,35 +469,13 @@ void BCI::clearClassifications()
 
 //*************************************************************************************************************
 
-bool BCI::hasThresholdArtefact(const QList< QPair<int,RowVectorXd> > &data)
+bool BCI::hasThresholdArtefact() const
 {
-    // Perform simple threshold artefact reduction
-    double max = 0;
-    double min = 0;
-
-    if(m_bUseArtefactThresholdReduction)
-    {
-        // find min max in current m_matSlidingWindowSensor/qlMatrixRows after mean was subtracted
-        for(int i = 0; i<data.size(); i++)
-        {
-            if(data.at(i).second.maxCoeff() > max)
-                max = data.at(i).second.maxCoeff();
-
-            if(data.at(i).second.minCoeff() < min)
-                min = data.at(i).second.minCoeff();
-        }
-    }
-
-//    cout<<"max: "<<max<<endl;
-//    cout<<"min: "<<min<<endl;
-
-    if(max<m_dThresholdValue*1e-06 && min>m_dThresholdValue*-1e-06) // If max is outside the threshold -> completley discard m_matSlidingWindowSensor
+    // Perform simple threshold artefact reduction on the sliding window - the mean is removed first if chosen in the GUI
+    if(!m_bUseArtefactThresholdReduction)
         return false;
-    else
-    {
-        //cout<<"Rejected artefact"<<endl;
-        return true;
-    }
+
+    return m_sensorPipeline.peakAmplitude() >= m_dThresholdValue*1e-06; // If the peak is outside the threshold -> completley discard the sliding window
 }
 
 
@@ -612,258 +521,127 @@ void BCI::BCIOnSensorLevel()
     // Start filling buffers with data from the inputs
     m_bProcessData = true;
 
-    // Sensor level: Fill matrices with data
-    if(m_bFillSensorWindowFirstTime) // Sensor level: Fill m_matSlidingWindowSensor with data for the first time
-    {
-        if(m_iTBWIndexSensor < m_matSlidingWindowSensor.cols())
-        {
-            //cout<<"About to pop matrix"<<endl;
-            MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
-            //cout<<"poped matrix"<<endl;
+    //cout<<"About to pop matrix"<<endl;
+    MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
+    //cout<<"poped matrix"<<endl;
 
-            // Get only the rows from the matrix which correspond with the selected features, namely electrodes on sensor level and destrieux clustered regions on source level
-            for(int i = 0; i < m_matSlidingWindowSensor.rows(); i++)
-                m_matSlidingWindowSensor.block(i, m_iTBWIndexSensor, 1, t_mat.cols()) = t_mat.block(m_mapElectrodePinningScheme[m_slChosenFeatureSensor.at(i)], 0, 1, t_mat.cols());
+    // ----1---- Pick the chosen electrodes, filter them and push them into the sliding window
+    //cout<<"----1----"<<endl;
+    m_sensorPipeline.push(t_mat);
 
-            m_matStimChannelSensor.block(0, m_iTBWIndexSensor, 1, t_mat.cols()) = t_mat.block(136, 0, 1, t_mat.cols());
+    // Keep the stim channel aligned with the sliding window - channel 136 is the trigger channel
+    int iNew = qMin(int(t_mat.cols()), int(m_matStimChannelSensor.cols()));
+    int iKeep = m_matStimChannelSensor.cols() - iNew;
+    if(iKeep > 0)
+        m_matStimChannelSensor.leftCols(iKeep) = m_matStimChannelSensor.rightCols(iKeep).eval();
+    m_matStimChannelSensor.rightCols(iNew) = t_mat.block(136, t_mat.cols()-iNew, 1, iNew);
 
-            m_iTBWIndexSensor = m_iTBWIndexSensor + t_mat.cols();
-        }
-        else // m_matSlidingWindowSensor is full for the first time
-        {
-            m_iTBWIndexSensor = 0;
-            m_bFillSensorWindowFirstTime = false;
-        }
-    }
-    else // Sensor level: Fill m_matTimeBetweenWindowsSensor matrix until full -> Then -> recalculate m_matSlidingWindowSensor, calculate features and classify
-    {
-        if(m_iTBWIndexSensor < m_matTimeBetweenWindowsSensor.cols())
-        {
-            //cout<<"About to pop matrix"<<endl;
-            MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
-            //cout<<"poped matrix"<<endl;
-
-            // Get only the rows from the matrix which correspond with the selected features, namely electrodes on sensor level and destrieux clustered regions on source level
-            for(int i = 0; i < m_matTimeBetweenWindowsSensor.rows(); i++)
-                m_matTimeBetweenWindowsSensor.block(i, m_iTBWIndexSensor, 1, t_mat.cols()) = t_mat.block(m_mapElectrodePinningScheme[m_slChosenFeatureSensor.at(i)], 0, 1, t_mat.cols());
-
-            m_matTimeBetweenWindowsStimSensor.block(0, m_iTBWIndexSensor, 1, t_mat.cols()) = t_mat.block(136, 0, 1, t_mat.cols());
-
-            m_iTBWIndexSensor = m_iTBWIndexSensor + t_mat.cols();
-        }
-        else // Recalculate m_matSlidingWindowSensor -> Calculate features, classify and store results
-        {
-            // ----1---- Recalculate m_matSlidingWindowSensor
-            //cout<<"----1----"<<endl;
-            //Move block from the right to the left -> use eval() to resolve Eigens aliasing problem
-            m_matSlidingWindowSensor.block(0, 0, m_matSlidingWindowSensor.rows(), m_matSlidingWindowSensor.cols()-m_matTimeBetweenWindowsSensor.cols()) = m_matSlidingWindowSensor.block(0, m_matTimeBetweenWindowsSensor.cols(), m_matSlidingWindowSensor.rows(), m_matSlidingWindowSensor.cols()-m_matTimeBetweenWindowsSensor.cols()).eval();
-            m_matStimChannelSensor.block(0, 0, m_matStimChannelSensor.rows(), m_matStimChannelSensor.cols()-m_matTimeBetweenWindowsStimSensor.cols()) = m_matStimChannelSensor.block(0, m_matTimeBetweenWindowsStimSensor.cols(), m_matStimChannelSensor.rows(), m_matStimChannelSensor.cols()-m_matTimeBetweenWindowsStimSensor.cols()).eval();
-
-            // push m_matTimeBetweenWindowsSensor from the right
-            m_matSlidingWindowSensor.block(0, m_matSlidingWindowSensor.cols()-m_matTimeBetweenWindowsSensor.cols(), m_matTimeBetweenWindowsSensor.rows(), m_matTimeBetweenWindowsSensor.cols()) = m_matTimeBetweenWindowsSensor;
-            m_matStimChannelSensor.block(0, m_matStimChannelSensor.cols()-m_matTimeBetweenWindowsStimSensor.cols(), m_matTimeBetweenWindowsStimSensor.rows(), m_matTimeBetweenWindowsStimSensor.cols()) = m_matTimeBetweenWindowsStimSensor;
+    m_iTBWIndexSensor = m_iTBWIndexSensor + t_mat.cols();
 
-            //cout<<m_matStimChannelSensor;
+    // Calculate features, classify and store results once the window is full and the time between windows has passed
+    if(!m_sensorPipeline.isWindowFull() || m_iTBWIndexSensor < m_iTBWSizeSensor)
+        return;
 
-            // Test if data is correctly streamed to this plugin
-            if(m_slChosenFeatureSensor.contains("TEST"))
-            {
-                cout<<"Recalculate matrix"<<endl;
+    m_iTBWIndexSensor = 0;
 
-                for(int i = 0; i<m_matSlidingWindowSensor.cols() ; i++)
-                    cout << m_matSlidingWindowSensor(m_matSlidingWindowSensor.rows()-1,i) <<endl;
+    // Test if data is correctly streamed to this plugin
+    if(m_slChosenFeatureSensor.contains("TEST"))
+    {
+        cout<<"Recalculate matrix"<<endl;
 
-//                    for(int i = 1; i<m_matSlidingWindowSensor.cols() ; i++)
-//                    {
-//                        cout << m_matSlidingWindowSensor(m_matSlidingWindowSensor.rows()-1,i-1) <<endl;
-//                        if(m_matSlidingWindowSensor(m_matSlidingWindowSensor.rows()-1,i) - m_matSlidingWindowSensor(m_matSlidingWindowSensor.rows()-1,i-1) != 1)
-//                            cout<<"Sequence error while streaming from tmsi plugin at position: "<<i<<endl;
-//                    }
-            }
+        MatrixXd::ConstColsBlockXpr matWindow = m_sensorPipeline.rawWindow();
+        for(int i = 0; i<matWindow.cols() ; i++)
+            cout << matWindow(matWindow.rows()-1,i) <<endl;
+    }
 
-            // ----2---- Transform matrix into QList structure, so that QTConcurrent can handle it properly
-            //cout<<"----2----"<<endl;
-            QList< QPair<int,RowVectorXd> > qlMatrixRows;
-            for(int i = 0; i< m_matSlidingWindowSensor.rows(); i++)
-                qlMatrixRows << QPair<int,RowVectorXd>(i, m_matSlidingWindowSensor.row(i));
+    // The filtered window is a view into the pipeline's ring buffer - no copies needed
+    MatrixXd::ConstColsBlockXpr matFilteredWindow = m_sensorPipeline.filteredWindow();
 
-            int iNumberOfFeatures = qlMatrixRows.size();
+    // ----2---- Do simple threshold artefact reduction
+    //cout<<"----2----"<<endl;
+    if(hasThresholdArtefact() == false)
+    {
+        // Look for trigger flag
+        if(lookForTrigger(m_matStimChannelSensor) && !m_bTriggerActivated)
+        {
+            // cout << "Trigger activated" << endl;
+            //QFuture<void> future = QtConcurrent::run(Beep, 450, 700);
+            m_bTriggerActivated = true;
+        }
 
-            // ----3---- Subtract mean in m_matSlidingWindowSensor concurrently using map()
-            //cout<<"----3----"<<endl;
-            if(m_bSubtractMean)
-            {
-                QFuture<void> futureMean = QtConcurrent::map(qlMatrixRows,[this](QPair<int,RowVectorXd>& rowdata) {
-                    applyMeanCorrectionConcurrently(rowdata);
-                });
+        // ----3---- Calculate and store the features of all electrodes in one pass
+        //cout<<"----3----"<<endl;
+        m_qMutex.lock();
+            m_sensorPipeline.computeFeatures();
+        m_qMutex.unlock();
 
-                futureMean.waitForFinished();
-            }
+        // ----4---- If enough features (windows) have been calculated (processed) -> classify all features and average results
+        //cout<<"----4----"<<endl;
+        if(m_sensorPipeline.featureCount() >= m_iNumberFeatures)
+        {
+            // One column per feature point, one row per chosen electrode
+            MatrixXd::ConstColsBlockXpr matFeatures = m_sensorPipeline.features();
 
-            // ----4---- Do simple threshold artefact reduction
-            //cout<<"----4----"<<endl;
-            if(hasThresholdArtefact(qlMatrixRows) == false)
+            // Display features
+            if(m_bDisplayFeatures)
             {
-                // Look for trigger flag
-                if(lookForTrigger(m_matStimChannelSensor) && !m_bTriggerActivated)
-                {
-                    // cout << "Trigger activated" << endl;
-                    //QFuture<void> future = QtConcurrent::run(Beep, 450, 700);
-                    m_bTriggerActivated = true;
-                }
-
-                // ----5---- Filter data in m_matSlidingWindowSensor concurrently using map()
-                //cout<<"----5----"<<endl;
-                // TODO: work only on qlMatrixRows -> filteredRows doesnt need to be created -> more efficient
-                QList< QPair<int,RowVectorXd> > filteredRows = qlMatrixRows;
+                QList< QList<double> > lFeaturesSensor;
 
-                if(m_bUseFilter)
+                for(int i = 0; i<matFeatures.cols(); i++)
                 {
-                    QFuture<void> futureFilter = QtConcurrent::map(filteredRows,[this](QPair<int,RowVectorXd>& chdata) {
-                        applyFilterOperatorConcurrently(chdata);
-                    });
-
-                    futureFilter.waitForFinished();
+                    QList<double> temp;
+                    for(int t = 0; t<matFeatures.rows(); t++)
+                        temp.append(matFeatures(t,i));
+                    lFeaturesSensor.append(temp);
                 }
 
-//                    // Write data before and after filtering to debug file
-//                    for(int i=0; i<qlMatrixRows.size(); i++)
-//                        m_outStreamDebug << "qlMatrixRows at row " << i << ": " << qlMatrixRows.at(i).second << "\n";
-
-//                    m_outStreamDebug<<endl;
-
-//                    for(int i=0; i<filteredRows.size(); i++)
-//                        m_outStreamDebug << "filteredRows at row " << i << ": " << filteredRows.at(i).second << "\n";
-
-//                    m_outStreamDebug << endl << "---------------------------------------------------------" << endl << endl;
-
-//                    // Write filtered data continously to file
-//                    for(int i = 0; i<filteredRows.at(0).second.size() ;i++)
-//                        m_outStreamDebug << filteredRows.at(0).second(i)<<endl;
-
-                // ----6---- Calculate features concurrently using mapped()
-                //cout<<"----6----"<<endl;
-                std::function< QPair<int,QList<double> > (QPair<int,RowVectorXd>&)> applyOpsFeatures = [this](QPair<int,RowVectorXd>& chdata) -> QPair< int,QList<double> > {
-                    return applyFeatureCalcConcurrentlyOnSensorLevel(chdata);
-                };
-
-                QFuture< QPair< int,QList<double> > > futureCalculatedFeatures = QtConcurrent::mapped(filteredRows.begin(), filteredRows.end(), applyOpsFeatures);
-
-                futureCalculatedFeatures.waitForFinished();
-
-                m_iNumberOfCalculatedFeatures++;
-
-                // ----7---- Store features
-                //cout<<"----7----"<<endl;
-                m_lFeaturesSensor.append(futureCalculatedFeatures.results());
-
-                // ----8---- If enough features (windows) have been calculated (processed) -> classify all features and average results
-                //cout<<"----8----"<<endl;
-                if(m_iNumberOfCalculatedFeatures == m_iNumberFeatures)
-                {
-                    // Transform m_lFeaturesSensor into an easier file structure -> create feature points
-                    QList< QList<double> > lFeaturesSensor_new;
-
-                    for(int i = 0; i<m_lFeaturesSensor.size()-iNumberOfFeatures+1; i = i + iNumberOfFeatures) // iterate over QPair feature List
-                        for(int z = 0; z<m_lFeaturesSensor.at(0).second.size(); z++) // iterate over number of sub signals
-                        {
-                            QList<double> temp;
-                            for(int t = 0; t<iNumberOfFeatures; t++) // iterate over chosen features (electrodes)
-                                temp.append(m_lFeaturesSensor.at(i+t).second.at(z));
-                            lFeaturesSensor_new.append(temp);
-                        }
-
-//                        //Check sizes
-//                        cout<<"lFeaturesSensor_new.size()"<<lFeaturesSensor_new.size()<<endl;
-//                        cout<<"lFeaturesSensor_new.at(0).size()"<<lFeaturesSensor_new.at(0).size()<<endl;
-//                        cout<<"m_lFeaturesSensor.size()"<<m_lFeaturesSensor.size()<<endl;
-
-                    // Display features
-                    if(m_bDisplayFeatures)
-                        emit paintFeatures((MyQList)lFeaturesSensor_new, m_bTriggerActivated);
-
-                    // Reset trigger
-                    m_bTriggerActivated = false;
-
-                    // ----9---- Classify features concurrently using mapped() ----------
-                    //cout<<"----9----"<<endl;
-
-                    std::function<double (QList<double>&)> applyOpsClassification = [this](QList<double>& featData){
-                        return applyClassificationCalcConcurrentlyOnSensorLevel(featData);
-                    };
-
-                    QFuture<double> futureClassificationResults = QtConcurrent::mapped(lFeaturesSensor_new.begin(), lFeaturesSensor_new.end(), applyOpsClassification);
-
-                    futureClassificationResults.waitForFinished();
-
-                    // ----10---- Generate final classification result -> average all classification results
-                    //cout<<"----10----"<<endl;
-                    double dfinalResult = 0;
-
-                    for(int i = 0; i<futureClassificationResults.resultCount() ;i++)
-                        dfinalResult += futureClassificationResults.resultAt(i);
-
-                    dfinalResult = dfinalResult/futureClassificationResults.resultCount();
-                    cout << "dfinalResult: " << dfinalResult << endl << endl;
-
-                    // ----11---- Store final result
-                    //cout<<"----11----"<<endl;
-                    m_lClassResultsSensor.append(dfinalResult);
+                emit paintFeatures((MyQList)lFeaturesSensor, m_bTriggerActivated);
+            }
 
-                    // ----12---- Send result to the output stream, i.e. which is connected to the triggerbox
-                    //cout<<"----12----"<<endl;
-                    VectorXd variances(iNumberOfFeatures);
-                    variances.setZero();
+            // Reset trigger
+            m_bTriggerActivated = false;
 
-                    for(int i = 0; i<lFeaturesSensor_new.size(); i++)
-                        for(int t = 0; t<iNumberOfFeatures; t++)
-                            variances(t) = variances(t) + lFeaturesSensor_new.at(i).at(t);
+            // ----5---- Classify all feature points with one matrix-vector product and average the results
+            //cout<<"----5----"<<endl;
+            if(m_vLoadedSensorBoundary.size() > 1)
+                m_sensorPipeline.setClassifier(m_vLoadedSensorBoundary[0](0), m_vLoadedSensorBoundary[1]);
 
-                    variances = variances/lFeaturesSensor_new.size();
+            double dfinalResult = m_sensorPipeline.classify();
+            cout << "dfinalResult: " << dfinalResult << endl << endl;
 
-                    m_pBCIOutputOne->data()->setValue(dfinalResult);
-                    m_pBCIOutputTwo->data()->setValue(variances(0));
-                    m_pBCIOutputThree->data()->setValue(variances(1));
+            // ----6---- Store final result
+            //cout<<"----6----"<<endl;
+            m_lClassResultsSensor.append(dfinalResult);
 
-                    for(int i = 0; i<filteredRows.at(0).second.cols() ; i++)
-                    {
-                        m_pBCIOutputFour->data()->setValue(filteredRows.at(0).second(0,i));
-                        m_pBCIOutputFive->data()->setValue(filteredRows.at(1).second(0,i));
-                    }
+            // ----7---- Send result to the output stream, i.e. which is connected to the triggerbox
+            //cout<<"----7----"<<endl;
+            VectorXd variances = matFeatures.rowwise().mean();
 
-                    // Clear classifications
-                    clearFeatures();
+            m_pBCIOutputOne->data()->setValue(dfinalResult);
+            m_pBCIOutputTwo->data()->setValue(variances(0));
+            m_pBCIOutputThree->data()->setValue(variances(1));
 
-                    // Reset counter
-                    m_iNumberOfCalculatedFeatures = 0;
-                } // End if enough features (windows) have been calculated (processed)
-            } // End if artefact reduction
-            else
+            for(int i = 0; i<matFilteredWindow.cols() ; i++)
             {
-                // If trial has been rejected -> plot zeros as result and the filtered electrode channel
-                m_pBCIOutputOne->data()->setValue(0);
-                m_pBCIOutputTwo->data()->setValue(0);
-                m_pBCIOutputThree->data()->setValue(0);
-
-                QList< QPair<int,RowVectorXd> > filteredRows = qlMatrixRows;
-
-                if(m_bUseFilter)
-                {
-                    QFuture<void> futureFilter = QtConcurrent::map(filteredRows,[this](QPair<int,RowVectorXd>& chdata) {
-                        applyFilterOperatorConcurrently(chdata);
-                    });
-
-                    futureFilter.waitForFinished();
-                }
-
-                for(int i = 0; i<filteredRows.at(0).second.cols() ; i++)
-                {
-                    m_pBCIOutputFour->data()->setValue(filteredRows.at(0).second(0,i));
-                    m_pBCIOutputFive->data()->setValue(filteredRows.at(1).second(0,i));
-                }
+                m_pBCIOutputFour->data()->setValue(matFilteredWindow(0,i));
+                m_pBCIOutputFive->data()->setValue(matFilteredWindow(1,i));
             }
 
-            m_iTBWIndexSensor = 0;
+            // Clear features
+            clearFeatures();
+        } // End if enough features (windows) have been calculated (processed)
+    } // End if artefact reduction
+    else
+    {
+        // If trial has been rejected -> plot zeros as result and the filtered electrode channel
+        m_pBCIOutputOne->data()->setValue(0);
+        m_pBCIOutputTwo->data()->setValue(0);
+        m_pBCIOutputThree->data()->setValue(0);
+
+        for(int i = 0; i<matFilteredWindow.cols() ; i++)
+        {
+            m_pBCIOutputFour->data()->setValue(matFilteredWindow(0,i));
+            m_pBCIOutputFive->data()->setValue(matFilteredWindow(1,i));
         }
     }
 }
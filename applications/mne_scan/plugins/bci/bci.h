@@ -52,6 +52,7 @@
 #include <scMeas/realtimesourceestimate.h>
 
 #include <utils/filterTools/filterdata.h>
+#include <utils/sensorfeaturepipeline.h>
 
 #include <fstream>
 
@@ -164,49 +165,6 @@ protected:
     */
     void updateSource(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
-    //=========================================================================================================
-    /**
-    * Calculates the filtered signal of chdata
-    *
-    * @param [in] rowdata QPair with number of the row and the data samples as a RowVectorXd.
-    */
-    void applyMeanCorrectionConcurrently(QPair<int,RowVectorXd>& rowdata);
-
-    //=========================================================================================================
-    /**
-    * Calculates the filtered signal of chdata
-    *
-    * @param [in] chdata QPair with number of the row and the data samples as a RowVectorXd.
-    */
-    void applyFilterOperatorConcurrently(QPair<int,RowVectorXd> &chdata);
-
-    //=========================================================================================================
-    /**
-    * Calculates the features on sensor level
-    *
-    * @param [in] chdata QPair with number of the row and the data samples as a RowVectorXd.
-    * @param [out] QPair<int,QList<double>> calculated features.
-    */
-    QPair< int,QList<double> > applyFeatureCalcConcurrentlyOnSensorLevel(const QPair<int,RowVectorXd> &chdata);
-
-    //=========================================================================================================
-    /**
-    * Classifies the features on sensor level
-    *
-    * @param [in] featData QList<double> holds the feature data point (i.e. 2 electrodes make this parameter have size of 2).
-    * @param [out] double calculated classification value.
-    */
-    double applyClassificationCalcConcurrentlyOnSensorLevel(QList<double> &featData);
-
-    //=========================================================================================================
-    /**
-    * Calculates the function value of the decision function (boundary) for a given feature point
-    *
-    * @param [in] featData QList<double> holds the feature data point (i.e. 2 electrodes make this parameter have size of 2).
-    * @param [out] double function value.
-    */
-    double classificationBoundaryValue(const QList<double> &featData);
-
     //=========================================================================================================
     /**
     * Clears features
@@ -223,10 +181,10 @@ protected:
 
     //=========================================================================================================
     /**
-    * Check for artefact in data
+    * Check for artefact in the current sliding window
     *
     */
-    bool hasThresholdArtefact(const QList<QPair<int, RowVectorXd> > &data);
+    bool hasThresholdArtefact() const;
 
     //=========================================================================================================
     /**
@@ -274,6 +232,7 @@ private:
     IOBUFFER::CircularMatrixBuffer<double>::SPtr                  m_pBCIBuffer_Source;    /**< Holds incoming source level data.*/
 
     QSharedPointer<UTILSLIB::FilterData>                          m_filterOperator;       /**< Holds filter with specified properties by the user.*/
+    UTILSLIB::SensorFeaturePipeline                               m_sensorPipeline;       /**< Filters the chosen electrodes and calculates and classifies their features.*/
 
     QSharedPointer<BCIFeatureWindow>                    m_BCIFeatureWindow;     /**< Holds pointer to BCIFeatureWindow for visualization purposes.*/
 
@@ -288,18 +247,13 @@ private:
     // Sensor level
     SCMEASLIB::FiffInfo::SPtr          m_pFiffInfo_Sensor;                 /**< Sensor level: Fiff information for sensor data. */
     bool                    m_bFiffInfoInitialised_Sensor;      /**< Sensor level: Fiff information initialised. */
-    bool                    m_bFillSensorWindowFirstTime;       /**< Sensor level: Flag if the working matrix m_mSlidingWindowSensor is being filled for the first time. */
-    MatrixXd                m_matSlidingWindowSensor;           /**< Sensor level: Working (sliding) matrix, used to store data for feature calculation on sensor level. */
-    MatrixXd                m_matTimeBetweenWindowsSensor;      /**< Sensor level: Samples stored during time between windows on sensor level. */
+    int                     m_iTBWSizeSensor;                   /**< Sensor level: Number of samples between two windows on sensor level. */
     int                     m_iTBWIndexSensor;                  /**< Sensor level: Index of the amount of data which was already filled during the time between windows. */
-    int                     m_iNumberOfCalculatedFeatures;      /**< Sensor level: Index which is iterated until enough features are calculated and classified to generate a final classifcation result.*/
     QVector< VectorXd >     m_vLoadedSensorBoundary;            /**< Sensor level: Loaded decision boundary on sensor level. */
     QStringList             m_slChosenFeatureSensor;            /**< Sensor level: Features used to calculate data points in feature space on sensor level. */
     QMap<QString, int>      m_mapElectrodePinningScheme;        /**< Sensor level: Loaded pinning scheme of the Duke 128 EEG cap. */
-    QList< QPair< int,QList<double> > >  m_lFeaturesSensor;     /**< Sensor level: Features calculated on sensor level. */
     QList<double>           m_lClassResultsSensor;              /**< Sensor level: Classification results on sensor level. */
     MatrixXd                m_matStimChannelSensor;             /**< Sensor level: Stim channel. */
-    MatrixXd                m_matTimeBetweenWindowsStimSensor;  /**< Sensor level: Stim channel. */
 
     // Source level
     QVector< VectorXd >     m_vLoadedSourceBoundary;            /**< Source level: Loaded decision boundary on source level. */
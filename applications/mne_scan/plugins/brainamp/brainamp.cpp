@@ -48,6 +48,7 @@
 #include <direct.h>
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_raw_writer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 
 
@@ -85,6 +86,7 @@ BrainAMP::BrainAMP()
 : m_pRMTSA_BrainAMP(0)
 , m_qStringResourcePath(qApp->applicationDirPath()+"/resources/mne_scan/plugins/brainamp/")
 , m_pRawMatrixBuffer_In(0)
+, m_pRawWriter(new FiffRawWriter)
 , m_pBrainAMPProducer(new BrainAMPProducer(this))
 , m_dLPAShift(0.01)
 , m_dRPAShift(0.01)
@@ -324,6 +326,7 @@ bool BrainAMP::start()
     //Buffer
     m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8, m_pFiffInfo->nchan, m_iSamplesPerBlock));
     m_qListReceivedSamples.clear();
+    m_qTimestamps.clear();
 
     m_pBrainAMPProducer->start(m_iSamplesPerBlock,
                        m_iSamplingFreq,
@@ -362,6 +365,7 @@ bool BrainAMP::stop()
     m_pRMTSA_BrainAMP->data()->clear();
 
     m_qListReceivedSamples.clear();
+    m_qTimestamps.clear();
 
     return true;
 }
@@ -372,6 +376,7 @@ bool BrainAMP::stop()
 void BrainAMP::setSampleData(MatrixXd &matRawBuffer)
 {
     m_mutex.lock();
+    m_qTimestamps.pushNow();
     m_qListReceivedSamples.append(matRawBuffer);
     m_mutex.unlock();
 }
@@ -435,15 +440,17 @@ void BrainAMP::run()
                 MatrixXd matValue;
                 matValue = m_qListReceivedSamples.first();
                 m_qListReceivedSamples.removeFirst();
+                qint64 iTimestamp = m_qTimestamps.pop();
 
                 //Write raw data to fif file
                 if(m_bWriteToFile) {
-                    m_pOutfid->write_raw_buffer(matValue, m_cals);
+                    m_pRawWriter->write(matValue);
                 }
 
                 //emit values to real time multi sample array
                 //qDebug()<<"BrainAMP::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
                 //std::cout << "BrainAMP::run() - matValue.block(10,10)" << matValue.block(0,0,10,10) << std::endl;
+                m_pRMTSA_BrainAMP->data()->setTimestamp(iTimestamp);
                 m_pRMTSA_BrainAMP->data()->setValue(matValue);
             }
 
@@ -454,8 +461,8 @@ void BrainAMP::run()
     //Close the fif output stream
     if(m_bWriteToFile)
     {
-        m_pOutfid->finish_writing_raw();
         m_bWriteToFile = false;
+        m_pRawWriter->close();
         m_pTimerRecordingChange->stop();
         m_pActionStartRecording->setIcon(QIcon(":/images/record.png"));
     }
@@ -492,8 +499,8 @@ void BrainAMP::showStartRecording()
     //Setup writing to file
     if(m_bWriteToFile)
     {
-        m_pOutfid->finish_writing_raw();
         m_bWriteToFile = false;
+        m_pRawWriter->close();
         m_pTimerRecordingChange->stop();
         m_pActionStartRecording->setIcon(QIcon(":/images/record.png"));
     }
@@ -516,8 +523,7 @@ void BrainAMP::showStartRecording()
         }
 
         //Initiate the stream for writing to the fif file
-        m_fileOut.setFileName(m_sOutputFilePath);
-        if(m_fileOut.exists())
+        if(QFile::exists(m_sOutputFilePath))
         {
             QMessageBox msgBox;
             msgBox.setText("The file you want to write already exists.");
@@ -539,9 +545,13 @@ void BrainAMP::showStartRecording()
             dir.mkpath(fileDir);
         }
 
-        m_pOutfid = Fiff::start_writing_raw(m_fileOut, *m_pFiffInfo, m_cals);
-        fiff_int_t first = 0;
-        m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+        if(!m_pRawWriter->open(m_sOutputFilePath, *m_pFiffInfo))
+        {
+            QMessageBox msgBox;
+            msgBox.setText("The recording file could not be created.");
+            msgBox.exec();
+            return;
+        }
 
         m_bWriteToFile = true;
 
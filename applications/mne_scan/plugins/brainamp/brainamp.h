@@ -48,6 +48,7 @@
 #include <fstream>
 
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularmatrixbuffer.h>
 
 
@@ -78,7 +79,7 @@ namespace SCMEASLIB {
 }
 
 namespace FIFFLIB {
-    class FiffStream;
+    class FiffRawWriter;
     class FiffInfo;
 }
 
@@ -258,10 +259,8 @@ private:
     QString                             m_sRPA;                             /**< The electrode to take to function as the RPA.*/
     QString                             m_sNasion;                          /**< The electrode to take to function as the Nasion.*/
 
-    QFile                               m_fileOut;                          /**< QFile for writing to fif file.*/
-    QSharedPointer<FIFFLIB::FiffStream> m_pOutfid;                          /**< QFile for writing to fif file.*/
+    QSharedPointer<FIFFLIB::FiffRawWriter> m_pRawWriter;                    /**< Writes the recorded data to a fif file in its own thread.*/
     QSharedPointer<FIFFLIB::FiffInfo>   m_pFiffInfo;                        /**< Fiff measurement info.*/
-    Eigen::RowVectorXd                  m_cals;
 
     QSharedPointer<BrainAMPProducer>    m_pBrainAMPProducer;                /**< the BrainAMPProducer.*/
 
@@ -275,6 +274,7 @@ private:
     qint16                              m_iBlinkStatus;                     /**< flag for recording icon blinking */
 
     QList<Eigen::MatrixXd>              m_qListReceivedSamples;             /**< list with alle the received samples in form of differentley sized matrices. */
+    SCMEASLIB::TimestampQueue           m_qTimestamps;                      /**< Acquisition times of the blocks in m_qListReceivedSamples. */
 
     QMutex                              m_mutex;
 
@@ -242,12 +242,9 @@ void Covariance::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
-
             for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
             {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pRtCov->append(t_mat);
+                m_pRtCov->append(pRTMSA->getMultiSampleBlock(i));
             }
         }
     }
@@ -40,6 +40,8 @@
 
 #include "dummytoolbox.h"
 
+#include <scShared/Management/latencytrace.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -105,6 +107,9 @@ void DummyToolbox::init()
     m_pDummyOutput = PluginOutputData<RealTimeMultiSampleArray>::create(this, "DummyOut", "Dummy output data");
     m_outputConnectors.append(m_pDummyOutput);
 
+    //Processing spans of the own thread, the dataflow scheduler uses the same node
+    m_iTraceNode = LatencyTrace::instance()->registerNode(getName());
+
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pDummyBuffer.isNull())
         m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr();
@@ -129,6 +134,10 @@ bool DummyToolbox::start()
 
     m_bIsRunning = true;
 
+    //In dataflow mode the scheduler calls process(), no thread of our own
+    if(isDataflowMode())
+        return true;
+
     //Start thread
     QThread::start();
 
@@ -142,10 +151,14 @@ bool DummyToolbox::stop()
 {
     m_bIsRunning = false;
 
-    m_pDummyBuffer->releaseFromPop();
-    m_pDummyBuffer->releaseFromPush();
+    if(m_pDummyBuffer) {
+        m_pDummyBuffer->releaseFromPop();
+        m_pDummyBuffer->releaseFromPush();
 
-    m_pDummyBuffer->clear();
+        m_pDummyBuffer->clear();
+    }
+
+    m_qTimestamps.clear();
 
     return true;
 }
@@ -176,6 +189,46 @@ QWidget* DummyToolbox::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+bool DummyToolbox::supportsDataflow() const
+{
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void DummyToolbox::process(const QString& sInput, const DataBlock::ConstSPtr& pBlock)
+{
+    Q_UNUSED(sInput);
+
+    QSharedPointer<RealTimeMultiSampleArray> pRTMSA = pBlock->source().dynamicCast<RealTimeMultiSampleArray>();
+
+    if(pRTMSA && !m_pFiffInfo) {
+        m_pFiffInfo = pRTMSA->info();
+
+        m_pDummyOutput->data()->initFromFiffInfo(m_pFiffInfo);
+        m_pDummyOutput->data()->setMultiArraySize(1);
+        m_pDummyOutput->data()->setVisibility(true);
+    }
+
+    if(!m_bIsRunning || !m_pFiffInfo)
+        return;
+
+    if(pBlock->data().size() == 0)
+        return;
+
+    //ToDo: Implement your algorithm here. The block data must not be modified, read it in place, e.g. via
+    //Eigen::Ref<const MatrixXd>, and publish the result with setValue(std::move(matResult))
+
+    //Send the data to the connected plugins and the online display, latencies count from the acquisition.
+    //The block is passed on as it is, without copying
+    m_pDummyOutput->data()->setTimestamp(pBlock->timestamp());
+    m_pDummyOutput->data()->setValue(pBlock->sharedData());
+}
+
+
 //*************************************************************************************************************
 
 void DummyToolbox::update(SCMEASLIB::Measurement::SPtr pMeasurement)
@@ -185,7 +238,7 @@ void DummyToolbox::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pDummyBuffer) {
-            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pDummyBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff information
@@ -198,11 +251,9 @@ void DummyToolbox::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pDummyOutput->data()->setVisibility(true);
         }
 
-        MatrixXd t_mat;
-
         for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pDummyBuffer->push(&t_mat);
+            m_qTimestamps.push(pRTMSA->timestamp(), pRTMSA->sequenceNumber());
+            m_pDummyBuffer->push(pRTMSA->getMultiSampleBlock(i));
         }
     }
 }
@@ -224,10 +275,15 @@ void DummyToolbox::run()
         //Dispatch the inputs
         MatrixXd t_mat = m_pDummyBuffer->pop();
 
+        qint64 iSequence;
+        qint64 iTimestamp = m_qTimestamps.pop(&iSequence);
+        LatencyTraceScope scope(m_iTraceNode, iTimestamp, iSequence);
+
         //ToDo: Implement your algorithm here
 
         //Send the data to the connected plugins and the online display
         //Unocmment this if you also uncommented the m_pDummyOutput in the constructor above
+        m_pDummyOutput->data()->setTimestamp(iTimestamp);
         m_pDummyOutput->data()->setValue(t_mat);
     }
 }
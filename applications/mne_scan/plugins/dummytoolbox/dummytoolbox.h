@@ -47,6 +47,7 @@
 #include <scShared/Interfaces/IAlgorithm.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <scMeas/realtimemultisamplearray.h>
+#include <scMeas/timestampqueue.h>
 #include "FormFiles/dummysetupwidget.h"
 #include "FormFiles/dummyyourwidget.h"
 
@@ -122,6 +123,8 @@ public:
     virtual IPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual bool supportsDataflow() const;
+    virtual void process(const QString& sInput, const DataBlock::ConstSPtr& pBlock);
 
     //=========================================================================================================
     /**
@@ -148,6 +151,8 @@ private:
     QAction*                                        m_pActionShowYourWidget;/**< flag whether thread is running.*/
 
     IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pDummyBuffer;         /**< Holds incoming data.*/
+    SCMEASLIB::TimestampQueue                       m_qTimestamps;          /**< Acquisition times and sequence numbers of the blocks in m_pDummyBuffer.*/
+    int                                             m_iTraceNode;           /**< Id of the plugin in the latency trace.*/
 
     PluginInputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr      m_pDummyInput;      /**< The RealTimeMultiSampleArray of the DummyToolbox input.*/
     PluginOutputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr     m_pDummyOutput;     /**< The RealTimeMultiSampleArray of the DummyToolbox output.*/
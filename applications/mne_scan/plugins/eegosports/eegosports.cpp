@@ -528,6 +528,7 @@ bool EEGoSports::start()
 
     //Buffer
     m_qListReceivedSamples.clear();
+    m_qTimestamps.clear();
 
     m_pEEGoSportsProducer->start(m_iNumberOfChannels,
                        m_iSamplesPerBlock,
@@ -560,6 +561,7 @@ bool EEGoSports::stop()
     m_pRMTSA_EEGoSports->data()->clear();
 
     m_qListReceivedSamples.clear();
+    m_qTimestamps.clear();
 
     return true;
 }
@@ -570,6 +572,7 @@ bool EEGoSports::stop()
 void EEGoSports::setSampleData(MatrixXd &matRawBuffer)
 {
     m_mutex.lock();
+    m_qTimestamps.pushNow();
     m_qListReceivedSamples.append(matRawBuffer);
     m_mutex.unlock();
 }
@@ -745,6 +748,7 @@ void EEGoSports::run()
             if(m_qListReceivedSamples.isEmpty() == false) {
 
                 matValue = m_qListReceivedSamples.takeFirst();
+                qint64 iTimestamp = m_qTimestamps.pop();
 
                 //Write raw data to fif file
                 if(m_bWriteToFile) {
@@ -753,6 +757,7 @@ void EEGoSports::run()
 
                 //emit values to real time multi sample array
                 //qDebug()<<"EEGoSports::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
+                m_pRMTSA_EEGoSports->data()->setTimestamp(iTimestamp);
                 m_pRMTSA_EEGoSports->data()->setValue(matValue);
             }
 
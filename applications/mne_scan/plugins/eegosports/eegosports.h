@@ -49,6 +49,7 @@
 #include "FormFiles/eegosportssetupprojectwidget.h"
 
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <fstream>
 
@@ -275,6 +276,7 @@ private:
     qint16                              m_iBlinkStatus;                     /**< Flag for recording icon blinking */
 
     QList<Eigen::MatrixXd>              m_qListReceivedSamples;             /**< List with alle the received samples in form of differentley sized matrices. */
+    SCMEASLIB::TimestampQueue           m_qTimestamps;                      /**< Acquisition times of the blocks in m_qListReceivedSamples. */
 
 };
 
@@ -88,6 +88,8 @@ CalcMetric::CalcMetric()
     m_bSetNewFuzzyEn = false;
     m_bSetNewKurtosis = false;
     m_bHistoryReady=false;
+    m_iChannelCount = 0;
+    m_iDataLength = 0;
 
 }
 
@@ -116,65 +118,59 @@ QPair<RowVectorXd, QPair<QList<double>, int> > createInputList(RowVectorXd input
 
 double calcFuzzyEn(QPair<RowVectorXd, QPair<QList<double>, int> > input)//RowVectorXd data, double mean, double stdDev, int dim, double r, double n)
 {
-    RowVectorXd data = input.first;
-    QPair<QList<double>, int> inputValues = input.second;
-    QList<double> doubleInputValues= inputValues.first;
+    const RowVectorXd& data = input.first;
+    const QPair<QList<double>, int>& inputValues = input.second;
+    const QList<double>& doubleInputValues= inputValues.first;
     int dim = inputValues.second;
     double mean = doubleInputValues[0];
     double stdDev = doubleInputValues[1];
     double r = doubleInputValues[2];
     double n = doubleInputValues[3];
     int length = data.cols();
-    double fuzzyEn;
-    ArrayXd arDataNorm = (data.array()- mean).array()/(stdDev);
-    VectorXd dataNorm = arDataNorm;
+    ArrayXd dataNorm = (data.transpose().array() - mean)/stdDev;
     Vector2d phi;
 
+    // Prefix sums for the pattern means
+    ArrayXd cumSum(length+1);
+    cumSum(0) = 0;
+    for (int i = 0; i < length; i++)
+        cumSum(i+1) = cumSum(i) + dataNorm(i);
+
+    ArrayXd diff(length), patternsMeanDiff(length), distance(length);
+
     for(int j=0; j<2; j++)
     {
         int m = dim+j;
-        MatrixXd patterns;
-        patterns.resize(m, length-m+1);
-
-        if (m==1)
-            patterns = dataNorm;
-        else
-        {
-            for(int i=0; i<m; i++)
-                patterns.row(i)=dataNorm.segment(i,length-m+1);
+        int patternCount = length-m+1;
 
-        }
+        // Mean of the pattern starting at each sample
+        ArrayXd patternsMean = (cumSum.segment(m, patternCount) - cumSum.head(patternCount))/m;
 
-        VectorXd patternsMean = patterns.colwise().mean();
-        patterns = patterns.rowwise() - patternsMean.transpose(); //check whether correct
-        VectorXd aux;
-        aux.resize(length-m+1);
+        // The similarity is symmetric and 1 on the diagonal: visit each pair once, ordered by lag k. For a lag
+        // all pattern pairs (i, i+k) are handled at once, the sample differences are shared by their m offsets.
+        double similaritySum = 0;
 
-        for (int i = 0; i< length-m+1; i++)
+        for (int k = 1; k < patternCount; k++)
         {
-            MatrixXd column;
-            column.resize(patterns.rows(),patterns.cols());
-            for (int l= 0; l < patterns.cols(); l++)
-                column.col(l) = patterns.col(i);
+            int pairs = patternCount-k;
+            diff.head(pairs+m-1) = dataNorm.segment(0, pairs+m-1) - dataNorm.segment(k, pairs+m-1);
+            patternsMeanDiff.head(pairs) = patternsMean.head(pairs) - patternsMean.segment(k, pairs);
 
-            VectorXd distance = ((patterns.array()-column.array()).abs()).colwise().maxCoeff();
-                //cout <<  "dist " << i << ": " << distance << "\n";
-            VectorXd similarty = (((-1)*(distance.array().pow(n)))/r).exp();
-                //cout << "simi " << i << ": " << similarty << "\n";
-
-            aux(i) = ((similarty.sum()-1)/(length-m-1));
+            distance.head(pairs) = (diff.head(pairs) - patternsMeanDiff.head(pairs)).abs();
+            for (int l = 1; l < m; l++)
+                distance.head(pairs) = distance.head(pairs).max((diff.segment(l, pairs) - patternsMeanDiff.head(pairs)).abs());
 
+            if (n == 2.0)
+                similaritySum += ((-distance.head(pairs).square())/r).exp().sum();
+            else
+                similaritySum += ((-distance.head(pairs).pow(n))/r).exp().sum();
         }
 
-        phi[j] = (aux.sum()/(length-m));
-
+        // Sum over all ordered pairs without the diagonal, normalized like the pairwise definition
+        phi[j] = 2*similaritySum/((length-m-1)*double(length-m));
     }
 
-    fuzzyEn = log(phi[0])-log(phi[1]);
-
-
-    return fuzzyEn;
-
+    return log(phi[0])-log(phi[1]);
 }
 
 
@@ -228,7 +224,7 @@ MatrixXd CalcMetric::getP2PHistory()
 
 //*************************************************************************************************************
 
-void CalcMetric::setData(Eigen::MatrixXd input)
+void CalcMetric::setData(const Eigen::MatrixXd& input)
 {
     m_dmatData = input;
     m_iDataLength = m_dmatData.cols();
@@ -288,15 +284,6 @@ VectorXd CalcMetric::onSeizureDetection(int dim, double r, double n, QList<int>
 
 //*************************************************************************************************************
 
-VectorXd calcP2P(MatrixXd data)
-{
-    VectorXd max = data.rowwise().maxCoeff();
-    VectorXd min = data.rowwise().minCoeff();
-    VectorXd P2P = max-min;
-    return P2P;
-}
-
-
 //*************************************************************************************************************
 
 void CalcMetric::calcP2P()
@@ -313,59 +300,13 @@ void CalcMetric::calcP2P()
         }
     }
 
-    VectorXd max = m_dmatData.rowwise().maxCoeff();
-    VectorXd min = m_dmatData.rowwise().minCoeff();
-    m_dvecP2P = max-min;
+    m_dvecP2P = m_slidingStats.p2p();
     m_bSetNewP2P = true;
 }
 
 
 //*************************************************************************************************************
 
-QPair<VectorXd, VectorXd> calcKurtosis(MatrixXd data, VectorXd mean, int start, int end)
-{
-    if (end > data.rows())
-        end=data.rows();
-
-    double sum;
-    int length = data.cols();
-    VectorXd stdDev;
-    VectorXd kurtosis;
-
-    for(int i=start; i < end; i++)
-    {
-        for(int j=0; j < length; j++)
-        {
-            if (j==0)
-            {
-                sum = (data(i,j)-mean(i));
-                stdDev(i) = pow(sum, 2);
-                kurtosis(i) = pow(sum, 4);
-            }
-            else
-            {
-                sum = data(i,j) - mean(i);
-                stdDev(i) = stdDev(i) + pow(sum, 2);
-                kurtosis(i) = kurtosis(i) + pow(sum,4);
-            }
-        }
-
-
-        stdDev(i) = stdDev(i)/(length-1);
-        stdDev(i) = sqrt(stdDev(i));
-        kurtosis(i)=(kurtosis(i))/((length)*pow((stdDev(i)*sqrt(length-1))/sqrt(length),4));
-
-    }
-
-    QPair <VectorXd, VectorXd> outputPair;
-    outputPair.first = kurtosis;
-    outputPair.second = stdDev;
-    return outputPair;
-
-
-}
-
-
 //*************************************************************************************************************
 
 void CalcMetric::calcKurtosis(int start, int end)
@@ -382,31 +323,13 @@ void CalcMetric::calcKurtosis(int start, int end)
             m_iKurtosisHistoryPosition = 0;
     }
 
-    m_dvecMean = m_dmatData.rowwise().mean();
-    double sum;
-
-    for(int i=start; i < end; i++)
-    {        
-        for(int j=0; j < m_iDataLength; j++)
-        {
-            if (j==0)
-            {
-                sum = (m_dmatData(i,j)-m_dvecMean(i));
-                m_dvecStdDev(i) = pow(sum, 2);
-                m_dvecKurtosis(i) = pow(sum, 4);
-            }
-            else
-            {
-                sum = m_dmatData(i,j) - m_dvecMean(i);
-                m_dvecStdDev(i) = m_dvecStdDev(i) + pow(sum, 2);
-                m_dvecKurtosis(i) = m_dvecKurtosis(i) + pow(sum,4);
-            }
-        }
-
-        m_dvecStdDev(i) = m_dvecStdDev(i)/(m_iDataLength-1);
-        m_dvecStdDev(i) = sqrt(m_dvecStdDev(i));
-        m_dvecKurtosis(i)=(m_dvecKurtosis(i))/((m_iDataLength)*pow((m_dvecStdDev(i)*sqrt(m_iDataLength-1))/sqrt(m_iDataLength),4));
+    //Mean is needed by FuzzyEn for all channels
+    m_dvecMean = m_slidingStats.mean();
 
+    if (start < end)
+    {
+        m_dvecStdDev.segment(start, end-start) = m_slidingStats.stdDev().segment(start, end-start);
+        m_dvecKurtosis.segment(start, end-start) = m_slidingStats.kurtosis().segment(start, end-start);
     }
 
     m_bSetNewKurtosis = true;
@@ -416,9 +339,21 @@ void CalcMetric::calcKurtosis(int start, int end)
 
 //*************************************************************************************************************
 
-void CalcMetric::calcAll(Eigen::MatrixXd input, int dim, double r, double n)
+void CalcMetric::calcAll(const Eigen::MatrixXd& input, int dim, double r, double n, int newSamples)
 {
     this->setData(input);
+
+    //Only the samples which entered the window are pushed, the ones which left it are dropped by the window length
+    if (newSamples < 0 || newSamples > m_iDataLength || m_slidingStats.channels() != m_iChannelCount || m_slidingStats.windowLength() != m_iDataLength)
+    {
+        m_slidingStats.reset(m_iChannelCount, m_iDataLength);
+        m_slidingStats.push(m_dmatData);
+    }
+    else
+    {
+        m_slidingStats.push(m_dmatData.rightCols(newSamples));
+    }
+
     this->calcP2P();
     this->calcKurtosis(0,1000);
     m_lFuzzyEnUsedChs.clear();
@@ -43,6 +43,9 @@
 //=============================================================================================================
 
 
+#include "slidingwindowstats.h"
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
@@ -87,18 +90,20 @@ public:
     *
     * @param [in] input matrix containing the newest dataset.
     */
-    void setData(Eigen::MatrixXd input);
+    void setData(const Eigen::MatrixXd& input);
 
     //=========================================================================================================
     /**
-    * Handles calculation of measurements and multithreading.
+    * Handles calculation of measurements and multithreading. Kurtosis and peak-to-peak magnitude are updated
+    * incrementally with the samples which entered the window since the last call.
     *
     * @param [in] input matrix containing the newest dataset.
     * @param [in] dim embedding dimension of fuzzy entropy.
     * @param [in] r width of fuzzy exponential function.
     * @param [in] n step of fuzzy exponential function.
+    * @param [in] newSamples number of samples at the end of input which are new since the last call, -1 if all are new.
     */
-    void calcAll(Eigen::MatrixXd input, int dim, double r, double n);
+    void calcAll(const Eigen::MatrixXd& input, int dim, double r, double n, int newSamples = -1);
 
     //=========================================================================================================
     /**
@@ -211,6 +216,8 @@ private:
 
     Eigen::VectorXd                         m_dvecStdDev;               /**< Contains the standard deviation for each channel.*/
     Eigen::VectorXd                         m_dvecMean;                 /**< Contains the mean value for each channel.*/
+
+    SlidingWindowStats                      m_slidingStats;             /**< Running moments and extrema of the current window.*/
 };
 
 
@@ -199,7 +199,7 @@ void Epidetect::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pEpidetectBuffer) {
-            m_pEpidetectBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pEpidetectBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff information
@@ -212,11 +212,8 @@ void Epidetect::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pEpidetectOutput->data()->setVisibility(true);
         }
 
-        MatrixXd t_mat;
-
         for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pEpidetectBuffer->push(&t_mat);
+            m_pEpidetectBuffer->push(pRTMSA->getMultiSampleBlock(i));
         }
     }
 }
@@ -336,7 +333,8 @@ void Epidetect::run()
 
         calculator.m_iListLength = m_iListLength;
         calculator.m_iFuzzyEnStep = m_iFuzzyEnStep;
-        calculator.calcAll(window, m_iDim, m_dR , m_iN);
+        //On a new block the whole window is new, otherwise only its second half entered the window
+        calculator.calcAll(window, m_iDim, m_dR , m_iN, overlap ? -1 : lastHalfTrimmed.cols());
         MatrixXd mu;
         MatrixXd p2pHistory =calculator.getP2PHistory();
         MatrixXd kurtosisHistory = calculator.getKurtosisHistory();
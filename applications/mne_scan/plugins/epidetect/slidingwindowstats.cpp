@@ -0,0 +1,256 @@
+//=============================================================================================================
+/**
+* @file     slidingwindowstats.cpp
+* @author   Louis Eichhorst <louis.eichhorst@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     January, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Louis Eichhorst and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    SlidingWindowStats class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "slidingwindowstats.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SlidingWindowStats::SlidingWindowStats()
+{
+    reset(0, 1);
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowStats::reset(int channels, int windowLength)
+{
+    m_iChannels = channels;
+    m_iWindowLength = windowLength > 0 ? windowLength : 1;
+    m_iCount = 0;
+    m_iPushed = 0;
+    m_iSinceRecompute = 0;
+
+    m_matRing.resize(m_iChannels, m_iWindowLength);
+    m_vecShift = VectorXd::Zero(m_iChannels);
+    m_arrSum1 = ArrayXd::Zero(m_iChannels);
+    m_arrSum2 = ArrayXd::Zero(m_iChannels);
+    m_arrSum3 = ArrayXd::Zero(m_iChannels);
+    m_arrSum4 = ArrayXd::Zero(m_iChannels);
+
+    m_vecMaxDeques.assign(m_iChannels, std::deque<long long>());
+    m_vecMinDeques.assign(m_iChannels, std::deque<long long>());
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowStats::push(const Ref<const MatrixXd>& data)
+{
+    if (data.rows() != m_iChannels)
+        return;
+
+    for (int j = 0; j < data.cols(); j++)
+    {
+        if (m_iPushed == 0)
+            m_vecShift = data.col(0);
+
+        long long sample = m_iPushed;
+        int slot = sample % m_iWindowLength;
+
+        //The sample in this slot leaves the window
+        if (m_iCount == m_iWindowLength)
+        {
+            ArrayXd leaving = m_matRing.col(slot).array() - m_vecShift.array();
+            ArrayXd leaving2 = leaving.square();
+            m_arrSum1 -= leaving;
+            m_arrSum2 -= leaving2;
+            m_arrSum3 -= leaving2*leaving;
+            m_arrSum4 -= leaving2.square();
+        }
+        else
+        {
+            m_iCount++;
+        }
+
+        m_matRing.col(slot) = data.col(j);
+
+        ArrayXd entering = data.col(j).array() - m_vecShift.array();
+        ArrayXd entering2 = entering.square();
+        m_arrSum1 += entering;
+        m_arrSum2 += entering2;
+        m_arrSum3 += entering2*entering;
+        m_arrSum4 += entering2.square();
+
+        //Keep the deques monotonic and drop sample numbers which left the window
+        long long oldest = sample - m_iCount + 1;
+
+        for (int i = 0; i < m_iChannels; i++)
+        {
+            double value = data(i,j);
+
+            std::deque<long long>& maxDeque = m_vecMaxDeques[i];
+            while (!maxDeque.empty() && m_matRing(i, maxDeque.back() % m_iWindowLength) <= value)
+                maxDeque.pop_back();
+            maxDeque.push_back(sample);
+            if (maxDeque.front() < oldest)
+                maxDeque.pop_front();
+
+            std::deque<long long>& minDeque = m_vecMinDeques[i];
+            while (!minDeque.empty() && m_matRing(i, minDeque.back() % m_iWindowLength) >= value)
+                minDeque.pop_back();
+            minDeque.push_back(sample);
+            if (minDeque.front() < oldest)
+                minDeque.pop_front();
+        }
+
+        m_iPushed++;
+
+        if (++m_iSinceRecompute >= m_iWindowLength)
+            recomputeSums();
+    }
+}
+
+
+//*************************************************************************************************************
+
+int SlidingWindowStats::channels() const
+{
+    return m_iChannels;
+}
+
+
+//*************************************************************************************************************
+
+int SlidingWindowStats::windowLength() const
+{
+    return m_iWindowLength;
+}
+
+
+//*************************************************************************************************************
+
+int SlidingWindowStats::count() const
+{
+    return m_iCount;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd SlidingWindowStats::mean() const
+{
+    if (m_iCount == 0)
+        return VectorXd::Zero(m_iChannels);
+
+    return m_vecShift.array() + m_arrSum1/m_iCount;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd SlidingWindowStats::stdDev() const
+{
+    if (m_iCount < 2)
+        return VectorXd::Zero(m_iChannels);
+
+    ArrayXd mu = m_arrSum1/m_iCount;
+    ArrayXd m2 = (m_arrSum2/m_iCount - mu.square()).max(0.0);
+
+    return (m2*m_iCount/(m_iCount-1)).sqrt();
+}
+
+
+//*************************************************************************************************************
+
+VectorXd SlidingWindowStats::kurtosis() const
+{
+    if (m_iCount == 0)
+        return VectorXd::Zero(m_iChannels);
+
+    //Central moments from the power sums of the shifted samples
+    ArrayXd mu = m_arrSum1/m_iCount;
+    ArrayXd mu2 = mu.square();
+    ArrayXd m2 = m_arrSum2/m_iCount - mu2;
+    ArrayXd m4 = m_arrSum4/m_iCount - 4*mu*m_arrSum3/m_iCount + 6*mu2*m_arrSum2/m_iCount - 3*mu2.square();
+
+    return m4/m2.square();
+}
+
+
+//*************************************************************************************************************
+
+VectorXd SlidingWindowStats::p2p() const
+{
+    VectorXd p2p = VectorXd::Zero(m_iChannels);
+
+    for (int i = 0; i < m_iChannels; i++)
+    {
+        if (!m_vecMaxDeques[i].empty())
+            p2p(i) = m_matRing(i, m_vecMaxDeques[i].front() % m_iWindowLength) - m_matRing(i, m_vecMinDeques[i].front() % m_iWindowLength);
+    }
+
+    return p2p;
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowStats::recomputeSums()
+{
+    m_arrSum1.setZero();
+    m_arrSum2.setZero();
+    m_arrSum3.setZero();
+    m_arrSum4.setZero();
+
+    for (int j = 0; j < m_iCount; j++)
+    {
+        ArrayXd value = m_matRing.col(j).array() - m_vecShift.array();
+        ArrayXd value2 = value.square();
+        m_arrSum1 += value;
+        m_arrSum2 += value2;
+        m_arrSum3 += value2*value;
+        m_arrSum4 += value2.square();
+    }
+
+    m_iSinceRecompute = 0;
+}
@@ -0,0 +1,173 @@
+//=============================================================================================================
+/**
+* @file     slidingwindowstats.h
+* @author   Louis Eichhorst <louis.eichhorst@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     January, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Louis Eichhorst and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SlidingWindowStats class declaration.
+*
+*/
+
+#ifndef SLIDINGWINDOWSTATS_H
+#define SLIDINGWINDOWSTATS_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <deque>
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS SlidingWindowStats
+*
+* @brief Keeps mean, standard deviation, kurtosis and peak-to-peak magnitude of the last samples of every channel
+* up to date while new samples are pushed. Every sample is touched once when it enters and once when it leaves the
+* window: the moments are kept as running power sums, the extrema in monotonic deques.
+*/
+
+class SlidingWindowStats
+{
+
+public:
+    //=========================================================================================================
+    /**
+    * Constructs an empty SlidingWindowStats object.
+    */
+    SlidingWindowStats();
+
+    //=========================================================================================================
+    /**
+    * Removes all samples and sets the dimensions.
+    *
+    * @param [in] channels number of channels.
+    * @param [in] windowLength number of samples in the window.
+    */
+    void reset(int channels, int windowLength);
+
+    //=========================================================================================================
+    /**
+    * Pushes new samples. The oldest samples leave the window once it is full.
+    *
+    * @param [in] data new samples, one row per channel.
+    */
+    void push(const Eigen::Ref<const Eigen::MatrixXd>& data);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @param [out] number of channels.
+    */
+    int channels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the window length.
+    *
+    * @param [out] number of samples in a full window.
+    */
+    int windowLength() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples currently in the window.
+    *
+    * @param [out] number of samples.
+    */
+    int count() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the mean of every channel.
+    *
+    * @param [out] the mean values.
+    */
+    Eigen::VectorXd mean() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the sample standard deviation (normalized by n-1) of every channel.
+    *
+    * @param [out] the standard deviations.
+    */
+    Eigen::VectorXd stdDev() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the kurtosis (fourth central moment divided by the squared second central moment) of every channel.
+    *
+    * @param [out] the kurtosis values.
+    */
+    Eigen::VectorXd kurtosis() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the peak-to-peak magnitude of every channel.
+    *
+    * @param [out] the peak-to-peak magnitudes.
+    */
+    Eigen::VectorXd p2p() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Recomputes the power sums from the samples in the window to get rid of accumulated rounding errors.
+    */
+    void recomputeSums();
+
+    int                             m_iChannels;        /**< Number of channels.*/
+    int                             m_iWindowLength;    /**< Number of samples in a full window.*/
+    int                             m_iCount;           /**< Number of samples in the window.*/
+    long long                       m_iPushed;          /**< Number of samples pushed since the last reset.*/
+    int                             m_iSinceRecompute;  /**< Samples pushed since the power sums were last recomputed.*/
+
+    Eigen::MatrixXd                 m_matRing;          /**< The samples in the window, ring buffer over the columns.*/
+    Eigen::VectorXd                 m_vecShift;         /**< Per channel offset subtracted before summing, keeps the power sums well conditioned.*/
+    Eigen::ArrayXd                  m_arrSum1;          /**< Sum of the shifted samples.*/
+    Eigen::ArrayXd                  m_arrSum2;          /**< Sum of the squared shifted samples.*/
+    Eigen::ArrayXd                  m_arrSum3;          /**< Sum of the cubed shifted samples.*/
+    Eigen::ArrayXd                  m_arrSum4;          /**< Sum of the shifted samples to the power of four.*/
+
+    std::vector<std::deque<long long> > m_vecMaxDeques; /**< Per channel sample numbers with decreasing values, the front is the maximum.*/
+    std::vector<std::deque<long long> > m_vecMinDeques; /**< Per channel sample numbers with increasing values, the front is the minimum.*/
+};
+
+#endif // SLIDINGWINDOWSTATS_H
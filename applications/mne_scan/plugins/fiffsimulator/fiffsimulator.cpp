@@ -218,6 +218,7 @@ bool FiffSimulator::stop()
         m_pRawMatrixBuffer_In->releaseFromPop();
 
         m_pRawMatrixBuffer_In->clear();
+        m_qTimestamps.clear();
 
         m_pRTMSA_FiffSimulator->data()->clear();
     }
@@ -266,6 +267,7 @@ void FiffSimulator::run()
         }
         //pop matrix
         matValue = m_pRawMatrixBuffer_In->pop();
+        qint64 iTimestamp = m_qTimestamps.pop();
 
         //Update HPI data (for single and continous HPI fitting)
         updateHPI(matValue);
@@ -276,6 +278,7 @@ void FiffSimulator::run()
         }
 
         //emit values
+        m_pRTMSA_FiffSimulator->data()->setTimestamp(iTimestamp);
         m_pRTMSA_FiffSimulator->data()->setValue(matValue.cast<double>());
     }
 }
@@ -45,6 +45,7 @@
 #include "fiffsimulator_global.h"
 
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <communication/rtClient/rtcmdclient.h>
 
@@ -231,6 +232,7 @@ protected:
 
     QSharedPointer<FiffSimulatorProducer>       m_pFiffSimulatorProducer;   /**< Holds the FiffSimulatorProducer.*/
     QSharedPointer<IOBUFFER::RawMatrixBuffer>   m_pRawMatrixBuffer_In;      /**< Holds incoming raw data. */
+    SCMEASLIB::TimestampQueue                   m_qTimestamps;              /**< Acquisition times of the blocks in m_pRawMatrixBuffer_In. */
     QSharedPointer<FIFFLIB::FiffInfo>           m_pFiffInfo;                /**< Fiff measurement info.*/
     QSharedPointer<COMMUNICATIONLIB::RtCmdClient>    m_pRtCmdClient;             /**< The command client.*/
     QSharedPointer<DISP3DLIB::HpiView>          m_pHPIWidget;               /**< HPI widget. */
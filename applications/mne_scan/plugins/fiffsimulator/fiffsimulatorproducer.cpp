@@ -57,6 +57,7 @@
 
 using namespace FIFFSIMULATORPLUGIN;
 using namespace COMMUNICATIONLIB;
+using namespace SCMEASLIB;
 
 
 //*************************************************************************************************************
@@ -224,11 +225,13 @@ void FiffSimulatorProducer::run()
         if(m_bFlagMeasuring)
         {
             m_pRtDataClient->readRawBuffer(m_pFiffSimulator->m_pFiffInfo->nchan, t_matRawBuffer, kind);
+            qint64 iTimestamp = Measurement::monotonicTime();
 
             if(kind == FIFF_DATA_BUFFER)
             {
                 to += t_matRawBuffer.cols();
                 from += t_matRawBuffer.cols();
+                m_pFiffSimulator->m_qTimestamps.push(iTimestamp);
                 m_pFiffSimulator->m_pRawMatrixBuffer_In->push(&t_matRawBuffer);
             }
             else if(FIFF_DATA_BUFFER == FIFF_BLOCK_END)
@@ -292,6 +292,7 @@ bool GUSBAmp::stop()
     m_pRawMatrixBuffer_In->releaseFromPop();
 
     m_pRawMatrixBuffer_In->clear();
+    m_qTimestamps.clear();
 
     m_pRTMSA_GUSBAmp->data()->clear();
 
@@ -342,6 +343,7 @@ void GUSBAmp::run()
         {
             //qDebug()<<"GUSBAmp is running";
             MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
+            qint64 iTimestamp = m_qTimestamps.pop();
             MatrixXf matValue_show = matValue/1000000; //matvalue for showing
 
             for(int i = 0; i < matValue.cols(); i++){
@@ -349,6 +351,7 @@ void GUSBAmp::run()
             }
 
             //emit values to real time multi sample array
+            m_pRTMSA_GUSBAmp->data()->setTimestamp(iTimestamp);
             m_pRTMSA_GUSBAmp->data()->setValue(matValue_show.cast<double>());
             qDebug() << "PUSH!";
 
@@ -45,6 +45,7 @@
 
 #include "gusbamp_global.h"
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <fiff/fiff.h>
@@ -205,6 +206,7 @@ private:
     QSharedPointer<GUSBAmpSetupProjectWidget>                                   m_pGUSBampSetupProjectWidget;   /**< Widget for setup the project file*/
 
     QSharedPointer<IOBUFFER::RawMatrixBuffer>     m_pRawMatrixBuffer_In;    /**< Holds incoming raw data.*/
+    SCMEASLIB::TimestampQueue                     m_qTimestamps;            /**< Acquisition times of the blocks in m_pRawMatrixBuffer_In.*/
 
     QString                             m_qStringResourcePath;              /**< The path to the EEG resource directory.*/
     bool                                m_bIsRunning;                       /**< Whether GUSBAmp is running.*/
@@ -134,8 +134,10 @@ void GUSBAmpProducer::run()
     {
         //qDebug()<<"GUSBAmpProducer::run()"<<endl;
         //Get the GUSBAmp EEG data out of the device buffer and write received data to circular buffer
-        if(m_pGUSBAmpDriver->getSampleMatrixValue(matRawBuffer))
+        if(m_pGUSBAmpDriver->getSampleMatrixValue(matRawBuffer)) {
+            m_pGUSBAmp->m_qTimestamps.pushNow();
             m_pGUSBAmp->m_pRawMatrixBuffer_In->push(&matRawBuffer);
+        }
     }
 }
 
@@ -70,6 +70,7 @@
 #include <QtCore/QtPlugin>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QStandardPaths>
 
 
 //*************************************************************************************************************
@@ -295,7 +296,7 @@ void MNE::doClustering()
 
     m_qMutex.lock();
     m_bFinishedClustering = false;
-    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution(*m_pAnnotationSet.data(), 40)));
+    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution_cached(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/clusteredFwd", *m_pAnnotationSet.data(), 40)));
     //m_pClusteredFwd = m_pFwd;
     m_pRTSEOutput->data()->setFwdSolution(m_pClusteredFwd);
 
@@ -399,7 +400,7 @@ void MNE::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA && m_bReceiveData) {
         //Check if buffer initialized
         if(!m_pMatrixDataBuffer) {
-            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pMatrixDataBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff Information of the evoked
@@ -411,8 +412,8 @@ void MNE::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement)
         }
 
         if(m_bProcessData) {
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i) {
-                m_pMatrixDataBuffer->push(&pRTMSA->getMultiSampleArray()[i]);
+            for(qint32 i = 0; i < pRTMSA->getMultiSampleBlockSizes().size(); ++i) {
+                m_pMatrixDataBuffer->push(pRTMSA->getMultiSampleBlock(i));
             }
         }
     }
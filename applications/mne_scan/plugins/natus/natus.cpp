@@ -335,6 +335,7 @@ void Natus::onNewDataAvailable(const Eigen::MatrixXd &matData)
     m_mutex.lock();
     if(m_bIsRunning) {
         //qDebug()<<"Natus::onNewDataAvailable - appending data";
+        m_qTimestamps.pushNow();
         m_pListReceivedSamples->append(matData);
     }
     m_mutex.unlock();
@@ -351,6 +352,7 @@ void Natus::run()
         if(!m_pListReceivedSamples->isEmpty())
         {
             MatrixXd matData = m_pListReceivedSamples->takeFirst();
+            m_pRMTSA_Natus->data()->setTimestamp(m_qTimestamps.pop());
             //qDebug()<<"Natus::run - matData.rows(): "<< matData.rows();
             //qDebug()<<"Natus::run - matData.cols(): "<< matData.cols();
             m_pRMTSA_Natus->data()->setValue(matData);
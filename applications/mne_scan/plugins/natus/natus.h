@@ -45,6 +45,7 @@
 #include "natus_global.h"
 
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularmatrixbuffer.h>
 
 
@@ -194,6 +195,7 @@ protected:
     QThread                                         m_pProducerThread;          /**< The thread used to host the producer.*/
     QSharedPointer<NATUSPLUGIN::NatusProducer>      m_pNatusProducer;           /**< The producer object.*/
     QSharedPointer<QList<Eigen::MatrixXd> >         m_pListReceivedSamples;     /**< List with alle the received samples in form of differentley sized matrices. Use QSharedPointer so it is thread safe. */
+    SCMEASLIB::TimestampQueue                       m_qTimestamps;              /**< Acquisition times of the blocks in m_pListReceivedSamples. */
 
     QSharedPointer<SCSHAREDLIB::PluginOutputData<SCMEASLIB::RealTimeMultiSampleArray> >     m_pRMTSA_Natus;     /**< The RealTimeSampleArray to provide the EEG data.*/
     QSharedPointer<FIFFLIB::FiffInfo>                                                       m_pFiffInfo;        /**< Fiff measurement info.*/
@@ -364,6 +364,7 @@ bool Neuromag::stop()
         m_pRawMatrixBuffer_In->releaseFromPop();
 
         m_pRawMatrixBuffer_In->clear();
+        m_qTimestamps.clear();
 
         m_pRTMSA_Neuromag->data()->clear();
     }
@@ -450,6 +451,7 @@ void Neuromag::run()
         matValue = m_pRawMatrixBuffer_In->pop();
 
         //emit values
+        m_pRTMSA_Neuromag->data()->setTimestamp(m_qTimestamps.pop());
         m_pRTMSA_Neuromag->data()->setValue(matValue.cast<double>());
     }
 }
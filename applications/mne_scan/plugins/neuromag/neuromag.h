@@ -45,6 +45,7 @@
 #include "neuromag_global.h"
 
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularbuffer_old.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <scMeas/realtimemultisamplearray.h>
@@ -248,6 +249,7 @@ private:
     QTimer m_cmdConnectionTimer;                            /**< Timer for convinient command client connection. When timer times out a connection is tried to be established. */
 
     QSharedPointer<RawMatrixBuffer> m_pRawMatrixBuffer_In;  /**< Holds incoming raw data. */
+    SCMEASLIB::TimestampQueue       m_qTimestamps;          /**< Acquisition times of the blocks in m_pRawMatrixBuffer_In. */
 
     bool                            m_bIsRunning;           /**< Whether FiffSimulator is running.*/
 
@@ -48,6 +48,7 @@
 //=============================================================================================================
 
 using namespace MneRtClientPlugin;
+using namespace SCMEASLIB;
 
 
 //*************************************************************************************************************
@@ -211,12 +212,14 @@ void NeuromagProducer::run()
         if(m_bFlagMeasuring && !m_bFlagInfoRequest)
         {
             m_pRtDataClient->readRawBuffer(m_pNeuromag->m_pFiffInfo->nchan, t_matRawBuffer, kind);
+            qint64 iTimestamp = Measurement::monotonicTime();
 
             if(kind == FIFF_DATA_BUFFER)
             {
                 to += t_matRawBuffer.cols();
                 from += t_matRawBuffer.cols();
 
+                m_pNeuromag->m_qTimestamps.push(iTimestamp);
                 m_pNeuromag->m_pRawMatrixBuffer_In->push(&t_matRawBuffer);
             }
             else if(FIFF_DATA_BUFFER == FIFF_BLOCK_END)
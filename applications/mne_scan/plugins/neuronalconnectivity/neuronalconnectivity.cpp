@@ -326,8 +326,8 @@ void NeuronalConnectivity::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement
         }
 
         if(m_pFiffInfo) {            
-            if(!pRTMSA->getMultiSampleArray().isEmpty()) {
-                m_iBlockSize = pRTMSA->getMultiSampleArray()[0].cols();
+            if(!pRTMSA->getMultiSampleBlockSizes().isEmpty()) {
+                m_iBlockSize = pRTMSA->getMultiSampleBlock(0).cols();
             }
 
             //Generate node vertices because the number of bad channels changed
@@ -341,9 +341,9 @@ void NeuronalConnectivity::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement
             MatrixXd data;
             QList<MatrixXd> epochDataList;
 
-            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i)
+            for(qint32 i = 0; i < pRTMSA->getMultiSampleBlockSizes().size(); ++i)
             {
-                const MatrixXd& t_mat = pRTMSA->getMultiSampleArray()[i];
+                Eigen::Map<const MatrixXd> t_mat = pRTMSA->getMultiSampleBlock(i);
 
                 // Check row and colum integrity and restart if necessary
                 if(!m_connectivitySettings.m_matDataList.isEmpty()) {
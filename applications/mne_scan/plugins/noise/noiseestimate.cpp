@@ -254,7 +254,7 @@ void NoiseEstimate::update(SCMEASLIB::Measurement::SPtr pMeasurement)
         m_qMutex.lock();
         if(!m_pBuffer)
         {
-            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff information
@@ -267,12 +267,9 @@ void NoiseEstimate::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         if(m_bProcessData)
         {
-            MatrixXd t_mat;
-
             for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
             {
-                t_mat = pRTMSA->getMultiSampleArray()[i];
-                m_pBuffer->push(&t_mat);
+                m_pBuffer->push(pRTMSA->getMultiSampleBlock(i));
             }
         }
     }
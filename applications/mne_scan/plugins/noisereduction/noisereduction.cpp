@@ -40,6 +40,8 @@
 
 #include "noisereduction.h"
 
+#include <scShared/Management/latencytrace.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -152,6 +154,9 @@ void NoiseReduction::init()
             this, &NoiseReduction::update, Qt::DirectConnection);
     m_inputConnectors.append(m_pNoiseReductionInput);
 
+    //Processing spans of the own thread, the dataflow scheduler uses the same node
+    m_iTraceNode = LatencyTrace::instance()->registerNode(getName());
+
     // Output - Uncomment this if you don't want to send processed data (in form of a matrix) to other plugins.
     m_pNoiseReductionOutput = PluginOutputData<RealTimeMultiSampleArray>::create(this, "NoiseReductionOut", "NoiseReduction output data");
     m_outputConnectors.append(m_pNoiseReductionOutput);
@@ -207,6 +212,7 @@ bool NoiseReduction::stop()
 
     m_pNoiseReductionBuffer->releaseFromPop();
     m_pNoiseReductionBuffer->clear();
+    m_qTimestamps.clear();
 
     m_pNoiseReductionBuffer->clear();
 
@@ -250,7 +256,7 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(m_pRTMSA) {
         //Check if buffer initialized
         if(!m_pNoiseReductionBuffer) {
-            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff information
@@ -278,15 +284,13 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
             m_pNoiseReductionOutput->data()->setVisibility(true);            
 
             //Init the filter
-            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleArray().at(m_pRTMSA->getMultiSampleArray().size()-1).cols();
+            m_iMaxFilterTapSize = m_pRTMSA->getMultiSampleBlockSizes().last();
             initFilter();
         }
 
-        MatrixXd t_mat;
-
         for(unsigned char i = 0; i < m_pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = m_pRTMSA->getMultiSampleArray()[i];
-            m_pNoiseReductionBuffer->push(&t_mat);
+            m_qTimestamps.push(m_pRTMSA->timestamp(), m_pRTMSA->sequenceNumber());
+            m_pNoiseReductionBuffer->push(m_pRTMSA->getMultiSampleBlock(i));
         }
     }
 }
@@ -735,6 +739,10 @@ void NoiseReduction::run()
         //Dispatch the inputs
         MatrixXd t_mat = m_pNoiseReductionBuffer->pop();
 
+        qint64 iSequence;
+        qint64 iTimestamp = m_qTimestamps.pop(&iSequence);
+        LatencyTraceScope scope(m_iTraceNode, iTimestamp, iSequence);
+
         m_mutex.lock();
 
         //Do SSP's and compensators here
@@ -799,6 +807,7 @@ void NoiseReduction::run()
         m_mutex.unlock();
 
         //Send the data to the connected plugins and the online display
+        m_pNoiseReductionOutput->data()->setTimestamp(iTimestamp);
         m_pNoiseReductionOutput->data()->setValue(t_mat);
     }
 }
@@ -56,6 +56,7 @@
 #include <utils/generics/circularmatrixbuffer.h>
 
 #include <scMeas/realtimemultisamplearray.h>
+#include <scMeas/timestampqueue.h>
 
 #include "FormFiles/noisereductionsetupwidget.h"
 #include "FormFiles/noisereductionoptionswidget.h"
@@ -298,6 +299,8 @@ private:
     FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;                /**< Fiff measurement info.*/
 
     IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pNoiseReductionBuffer;    /**< Holds incoming data.*/
+    SCMEASLIB::TimestampQueue                       m_qTimestamps;          /**< Acquisition times and sequence numbers of the blocks in m_pNoiseReductionBuffer.*/
+    int                                             m_iTraceNode;           /**< Id of the plugin in the latency trace.*/
 
     NoiseReductionOptionsWidget::SPtr               m_pOptionsWidget;           /**< The noise reduction option widget object.*/
     QAction*                                        m_pActionShowOptionsWidget; /**< The noise reduction option widget action.*/
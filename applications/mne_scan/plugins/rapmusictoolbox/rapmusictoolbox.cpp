@@ -51,6 +51,7 @@
 #include <QtCore/QtPlugin>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QStandardPaths>
 
 
 //*************************************************************************************************************
@@ -172,7 +173,7 @@ void RapMusicToolbox::doClustering()
 
     m_qMutex.lock();
     m_bFinishedClustering = false;
-    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution(*m_pAnnotationSet.data(), 40)));
+    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution_cached(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/clusteredFwd", *m_pAnnotationSet.data(), 40)));
     m_qMutex.unlock();
 
     finishedClustering();
@@ -41,6 +41,8 @@
 
 #include "reference.h"
 
+#include <scShared/Management/latencytrace.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -107,6 +109,9 @@ void Reference::init()
     m_pRefOutput = PluginOutputData<RealTimeMultiSampleArray>::create(this, "ReferenceOut", "Reference output data");
     m_outputConnectors.append(m_pRefOutput);
 
+    //Processing spans of the own thread, the dataflow scheduler uses the same node
+    m_iTraceNode = LatencyTrace::instance()->registerNode(getName());
+
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pRefBuffer.isNull())
         m_pRefBuffer.clear();
@@ -131,6 +136,10 @@ bool Reference::start()
 
     m_bIsRunning = true;
 
+    //In dataflow mode the scheduler calls process(), no thread of our own
+    if(isDataflowMode())
+        return true;
+
     //Start thread
     QThread::start();
 
@@ -144,10 +153,14 @@ bool Reference::stop()
 {
     m_bIsRunning = false;
 
-    m_pRefBuffer->releaseFromPop();
-    m_pRefBuffer->releaseFromPush();
+    if(m_pRefBuffer) {
+        m_pRefBuffer->releaseFromPop();
+        m_pRefBuffer->releaseFromPush();
+
+        m_pRefBuffer->clear();
+    }
 
-    m_pRefBuffer->clear();
+    m_qTimestamps.clear();
 
     return true;
 }
@@ -178,6 +191,40 @@ QWidget* Reference::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+bool Reference::supportsDataflow() const
+{
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void Reference::process(const QString& sInput, const DataBlock::ConstSPtr& pBlock)
+{
+    Q_UNUSED(sInput);
+
+    QSharedPointer<RealTimeMultiSampleArray> pRTMSA = pBlock->source().dynamicCast<RealTimeMultiSampleArray>();
+
+    if(pRTMSA && !m_pFiffInfo)
+        initFiffInfo(pRTMSA);
+
+    if(!m_bIsRunning || !m_pFiffInfo)
+        return;
+
+    if(pBlock->data().size() == 0)
+        return;
+
+    //The reference is applied column by column, hence all blocks of the update at once
+    MatrixXd matCAR = EEGRef::applyCAR(pBlock->data(), m_pFiffInfo);
+
+    //Send the data to the connected plugins and the online display
+    m_pRefOutput->data()->setTimestamp(pBlock->timestamp());
+    m_pRefOutput->data()->setValue(std::move(matCAR));
+}
+
+
 //*************************************************************************************************************
 
 void Reference::update(SCMEASLIB::Measurement::SPtr pMeasurement)
@@ -187,26 +234,16 @@ void Reference::update(SCMEASLIB::Measurement::SPtr pMeasurement)
     if(pRTMSA) {
         //Check if buffer initialized
         if(!m_pRefBuffer) {
-            m_pRefBuffer = CircularMatrixBuffer<double>::SPtr(new _double_CircularMatrixBuffer(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pRefBuffer = CircularMatrixBuffer<double>::SPtr(new _double_CircularMatrixBuffer(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
         }
 
         //Fiff information
-        if(!m_pFiffInfo) {
-            m_pFiffInfo = pRTMSA->info();
-
-            //Init output - Unocmment this if you also uncommented the m_pRefOutput in the constructor above
-            m_pRefOutput->data()->initFromFiffInfo(m_pFiffInfo);
-            m_pRefOutput->data()->setMultiArraySize(1);
-            m_pRefOutput->data()->setVisibility(true);
-
-            m_pRefToolbarWidget->updateChannels(m_pFiffInfo);
-        }
-
-        MatrixXd t_mat;
+        if(!m_pFiffInfo)
+            initFiffInfo(pRTMSA);
 
         for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pRefBuffer->push(&t_mat);
+            m_qTimestamps.push(pRTMSA->timestamp(), pRTMSA->sequenceNumber());
+            m_pRefBuffer->push(pRTMSA->getMultiSampleBlock(i));
         }
     }
 }
@@ -227,21 +264,45 @@ void Reference::run()
         //Dispatch the inputs
         MatrixXd t_mat = m_pRefBuffer->pop();
 
+        qint64 iSequence;
+        qint64 iTimestamp = m_qTimestamps.pop(&iSequence);
+        LatencyTraceScope scope(m_iTraceNode, iTimestamp, iSequence);
+
         // apply common average reference
         MatrixXd matCAR = EEGRef::applyCAR(t_mat, m_pFiffInfo);
 
         //Send the data to the connected plugins and the online display
+        m_pRefOutput->data()->setTimestamp(iTimestamp);
         m_pRefOutput->data()->setValue(matCAR);
     }
 }
 
 
+//*************************************************************************************************************
+
+void Reference::initFiffInfo(QSharedPointer<RealTimeMultiSampleArray> pRTMSA)
+{
+    m_pFiffInfo = pRTMSA->info();
+
+    //Init output - Unocmment this if you also uncommented the m_pRefOutput in the constructor above
+    m_pRefOutput->data()->initFromFiffInfo(m_pFiffInfo);
+    m_pRefOutput->data()->setMultiArraySize(1);
+    m_pRefOutput->data()->setVisibility(true);
+
+    if(m_pRefToolbarWidget)
+        m_pRefToolbarWidget->updateChannels(m_pFiffInfo);
+}
+
+
 //*************************************************************************************************************
 
 void Reference::showRefToolbarWidget()
 {
     if(!m_pRefToolbarWidget){
         m_pRefToolbarWidget = QSharedPointer<ReferenceToolbarWidget>( new ReferenceToolbarWidget(this));
+
+        if(m_pFiffInfo)
+            m_pRefToolbarWidget->updateChannels(m_pFiffInfo);
     }
 
     if(!m_pRefToolbarWidget->isVisible()){
@@ -48,6 +48,7 @@
 #include <scShared/Interfaces/IAlgorithm.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <scMeas/realtimemultisamplearray.h>
+#include <scMeas/timestampqueue.h>
 #include <eegref.h>
 
 #include "FormFiles/referencesetupwidget.h"
@@ -118,6 +119,8 @@ public:
     virtual IPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual bool supportsDataflow() const;
+    virtual void process(const QString& sInput, const SCSHAREDLIB::DataBlock::ConstSPtr& pBlock);
 
     //=========================================================================================================
     /**
@@ -141,6 +144,14 @@ protected:
     void showRefToolbarWidget();
 
 private:
+    //=========================================================================================================
+    /**
+    * Initializes the output and the toolbar with the measurement info of the first incoming data.
+    *
+    * @param[in] pRTMSA    The incoming data.
+    */
+    void initFiffInfo(QSharedPointer<SCMEASLIB::RealTimeMultiSampleArray> pRTMSA);
+
     bool                                            m_bIsRunning;           /**< Flag whether thread is running.*/
 
     FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;            /**< Fiff measurement info.*/
@@ -149,6 +160,8 @@ private:
     QAction*                                            m_pActionRefToolbarWidget;      /**< flag whether thread is running.*/
 
     QSharedPointer<IOBUFFER::_double_CircularMatrixBuffer>  m_pRefBuffer;                   /**< Holds incoming data.*/
+    SCMEASLIB::TimestampQueue                       m_qTimestamps;          /**< Acquisition times and sequence numbers of the blocks in m_pRefBuffer.*/
+    int                                             m_iTraceNode;           /**< Id of the plugin in the latency trace.*/
 
     SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr      m_pRefInput;      /**< The RealTimeMultiSampleArray of the Reference input.*/
     SCSHAREDLIB::PluginOutputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr     m_pRefOutput;     /**< The RealTimeMultiSampleArray of the Reference output.*/
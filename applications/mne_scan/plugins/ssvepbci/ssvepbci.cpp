@@ -211,9 +211,8 @@ bool SsvepBci::start()
     m_iReadIndex    = 0;
     m_iCounter      = 0;
     m_iReadToWriteBuffer = 0;
-    m_iDownSampleIndex   = 0;
-    m_iFormerDownSampleIndex = 0;
     m_iWindowSize        = 8;
+    m_sensorPipeline.setChannelPicks(m_lElectrodeNumbers.toVector());
     m_bIsRunning    = true;
 
     // starting the thread for data processing
@@ -289,7 +288,7 @@ void SsvepBci::updateSensor(SCMEASLIB::Measurement::SPtr pMeasurement)
         //Check if buffer initialized
         m_qMutex.lock();
         if(!m_pBCIBuffer_Sensor)
-            m_pBCIBuffer_Sensor = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pBCIBuffer_Sensor = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleBlock(0).cols()));
     }
 
     //Fiff information
@@ -306,10 +305,10 @@ void SsvepBci::updateSensor(SCMEASLIB::Measurement::SPtr pMeasurement)
 
         // determine sliding time window parameters
         m_iReadSampleSize = 0.1*m_dSampleFrequency;    // about 0.1 second long time segment as basic read increment
-        m_iWriteSampleSize = pRTMSA->getMultiSampleArray()[0].cols();
-        m_iTimeWindowLength = int(5*m_dSampleFrequency) + int(pRTMSA->getMultiSampleArray()[0].cols()/m_iDownSampleIncrement) + 1 ;
+        m_iWriteSampleSize = pRTMSA->getMultiSampleBlock(0).cols();
+        m_iTimeWindowLength = int(5*m_dSampleFrequency) + int(pRTMSA->getMultiSampleBlock(0).cols()/m_iDownSampleIncrement) + 1 ;
         //m_iTimeWindowSegmentSize  = int(5*m_dSampleFrequency / m_iWriteSampleSize) + 1;   // 4 seconds long maximal sized window
-        m_matSlidingTimeWindow.resize(m_lElectrodeNumbers.size(), m_iTimeWindowLength);//m_matSlidingTimeWindow.resize(rows, m_iTimeWindowSegmentSize*pRTMSA->getMultiSampleArray()[0].cols());
+        m_matSlidingTimeWindow.resize(m_lElectrodeNumbers.size(), m_iTimeWindowLength);//m_matSlidingTimeWindow.resize(rows, m_iTimeWindowSegmentSize*pRTMSA->getMultiSampleBlock(0).cols());
 
         cout << "Down Sample Increment:" << m_iDownSampleIncrement << endl;
         cout << "Read Sample Size:" << m_iReadSampleSize << endl;
@@ -321,10 +320,8 @@ void SsvepBci::updateSensor(SCMEASLIB::Measurement::SPtr pMeasurement)
 
     // filling the matrix buffer
     if(m_bProcessData){
-        MatrixXd t_mat;
         for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i){
-            t_mat = pRTMSA->getMultiSampleArray()[i];
-            m_pBCIBuffer_Sensor->push(&t_mat);
+            m_pBCIBuffer_Sensor->push(pRTMSA->getMultiSampleBlock(i));
         }
     }
 }
@@ -539,8 +536,7 @@ void SsvepBci::changeSSVEPParameter(){
             m_iReadIndex    = 0;
             m_iCounter      = 0;
             m_iReadToWriteBuffer = 0;
-            m_iDownSampleIndex   = 0;
-            m_iFormerDownSampleIndex = 0;
+            m_sensorPipeline.setChannelPicks(m_lElectrodeNumbers.toVector());
 
             // resize the time window with new electrode numbers
             m_matSlidingTimeWindow.resize(m_lElectrodeNumbers.size(), m_iTimeWindowLength);
@@ -720,23 +716,19 @@ void SsvepBci::ssvepBciOnSensor()
     m_bProcessData = true;
     MatrixXd t_mat = m_pBCIBuffer_Sensor->pop();
 
-    // writing selected feature channels to the time window storage and increase the segment index
-    int   writtenSamples = 0;
-    while(m_iDownSampleIndex >= m_iFormerDownSampleIndex){
-
-        // write from t_mat to the sliding time window while doing channel select and downsampling
-        m_iFormerDownSampleIndex = m_iDownSampleIndex;
-        for(int i = 0; i < m_lElectrodeNumbers.size(); i++){
-            m_matSlidingTimeWindow(i, m_iWriteIndex) = t_mat(m_lElectrodeNumbers.at(i), m_iDownSampleIndex);
-        }
-        writtenSamples++;
-
-        // update counter variables
-        m_iWriteIndex = (m_iWriteIndex + 1) % m_iTimeWindowLength;
-        m_iDownSampleIndex = (m_iDownSampleIndex + m_iDownSampleIncrement ) % m_iWriteSampleSize;
-
+    // channel select and downsampling in one pass - the downsampling phase is carried over to the next block
+    m_sensorPipeline.setDecimation(m_iDownSampleIncrement);
+    const MatrixXd& matNewSamples = m_sensorPipeline.acquire(t_mat);
+
+    // writing selected feature channels to the time window storage and increase the segment index - blocks longer
+    // than the time window wrap around several times, so that only their last samples remain
+    int writtenSamples = matNewSamples.cols();
+    for(int offset = 0; offset < writtenSamples; ){
+        int chunkSamples = qMin(writtenSamples - offset, m_iTimeWindowLength - m_iWriteIndex);
+        m_matSlidingTimeWindow.middleCols(m_iWriteIndex, chunkSamples) = matNewSamples.middleCols(offset, chunkSamples);
+        m_iWriteIndex = (m_iWriteIndex + chunkSamples) % m_iTimeWindowLength;
+        offset += chunkSamples;
     }
-    m_iFormerDownSampleIndex = m_iDownSampleIndex;
 
     // calculate buffer between read- and write index
     m_iReadToWriteBuffer = m_iReadToWriteBuffer + writtenSamples;
@@ -51,6 +51,7 @@
 #include <scMeas/realtimemultisamplearray.h>
 #include <scMeas/realtimesourceestimate.h>
 #include <utils/filterTools/filterdata.h>
+#include <utils/sensorfeaturepipeline.h>
 
 #include <fstream>
 #include <iostream>
@@ -423,8 +424,7 @@ private:
     int                     m_iWriteIndex;                      /**< Index for writing a new increment from the buffer to the time window */
     int                     m_iReadIndex;                       /**< index for reading from the time window */
     int                     m_iDownSampleIncrement;             /**< Increment for downsampling from current sample rate to 128 Hz */
-    int                     m_iDownSampleIndex;                 /**< index for reading from the raw buffer in order to downsample to 128 Hz */
-    int                     m_iFormerDownSampleIndex;           /**< former downsampling Index: serves as comparison variable for handling storage overflow */
+    UTILSLIB::SensorFeaturePipeline m_sensorPipeline;           /**< Picks the chosen electrode channels and downsamples them */
     int                     m_iReadToWriteBuffer;               /**< number of samples from the current readindex to current write index */
     int                     m_iNumberOfClassBreaks;             /**< number of classifiactions whicht will be skipped if a classifiaction was made */
     int                     m_iWindowSize;                      /**< size of current time window */
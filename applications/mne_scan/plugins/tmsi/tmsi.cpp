@@ -563,6 +563,7 @@ bool TMSI::stop()
     m_pRawMatrixBuffer_In->releaseFromPop();
 
     m_pRawMatrixBuffer_In->clear();
+    m_qTimestamps.clear();
 
     m_pRMTSA_TMSI->data()->clear();
 
@@ -658,6 +659,7 @@ void TMSI::run()
         if(m_pTMSIProducer->isRunning() && m_bCheckImpedances)
         {
             MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
+            m_qTimestamps.pop();
 
             for(qint32 i = 0; i < matValue.cols(); ++i)
                 m_pTmsiImpedanceWidget->updateGraphicScene(matValue.col(i).cast<double>());
@@ -667,6 +669,7 @@ void TMSI::run()
         if(m_pTMSIProducer->isRunning() && !m_bCheckImpedances)
         {
             MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
+            qint64 iTimestamp = m_qTimestamps.pop();
 
             // Set Beep trigger (if activated)
             if(m_bBeepTrigger && m_qTimerTrigger.elapsed() >= m_iTriggerInterval)
@@ -769,6 +772,7 @@ void TMSI::run()
             }
 
             //emit values to real time multi sample array
+            m_pRMTSA_TMSI->data()->setTimestamp(iTimestamp);
             m_pRMTSA_TMSI->data()->setValue(matValue.cast<double>());
 
             // Reset keyboard trigger
@@ -49,6 +49,7 @@
 #include "tmsi_global.h"
 
 #include <scShared/Interfaces/ISensor.h>
+#include <scMeas/timestampqueue.h>
 #include <utils/generics/circularmatrixbuffer.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 
@@ -270,6 +271,7 @@ private:
     RowVectorXd                         m_cals;
 
     QSharedPointer<RawMatrixBuffer>     m_pRawMatrixBuffer_In;              /**< Holds incoming raw data.*/
+    SCMEASLIB::TimestampQueue           m_qTimestamps;                      /**< Acquisition times of the blocks in m_pRawMatrixBuffer_In.*/
 
     QSharedPointer<TMSIProducer>        m_pTMSIProducer;                    /**< the TMSIProducer.*/
 
@@ -136,8 +136,10 @@ void TMSIProducer::run()
     {
         //std::cout<<"TMSIProducer::run()"<<std::endl;
         //Get the TMSi EEG data out of the device buffer and write received data to circular buffer
-        if(m_pTMSIDriver->getSampleMatrixValue(matRawBuffer))
+        if(m_pTMSIDriver->getSampleMatrixValue(matRawBuffer)) {
+            m_pTMSI->m_qTimestamps.pushNow();
             m_pTMSI->m_pRawMatrixBuffer_In->push(&matRawBuffer);
+        }
     }
 
     //std::cout<<"EXITING - TMSIProducer::run()"<<std::endl;
@@ -0,0 +1,143 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   Lorenz Esch <lorenz.esch@tu-ilmenau.de>;
+*           Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Lorenz Esch, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmark of the adaptive Matching Pursuit on synthetic multichannel segments
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <iostream>
+#include <math.h>
+
+#include <utils/mp/adaptivemp.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Adaptive Matching Pursuit Benchmark Example");
+    parser.addHelpOption();
+
+    QCommandLineOption channelsOption("channels", "Number of <channels> of the synthetic segment.", "channels", "64");
+    QCommandLineOption samplesOption("samples", "Number of <samples> of the synthetic segment (1 second).", "samples", "1000");
+    QCommandLineOption iterationsOption("iterations", "Number of atoms to decompose, i.e. <iterations> of the algorithm.", "iterations", "10");
+    QCommandLineOption runsOption("runs", "Number of <runs> to average the timing over.", "runs", "3");
+    QCommandLineOption boostOption("boost", "Percentage of channels observed during the search (<boost>).", "boost", "100");
+
+    parser.addOption(channelsOption);
+    parser.addOption(samplesOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(runsOption);
+    parser.addOption(boostOption);
+
+    parser.process(app);
+
+    qint32 iChannels = parser.value(channelsOption).toInt();
+    qint32 iSamples = parser.value(samplesOption).toInt();
+    qint32 iIterations = parser.value(iterationsOption).toInt();
+    qint32 iRuns = qMax(1, parser.value(runsOption).toInt());
+    qint32 iBoost = parser.value(boostOption).toInt();
+
+    //
+    // Synthetic segment: a few gabor atoms with channel dependent amplitudes plus white noise
+    //
+    GaborAtom gaborAtom;
+    MatrixXd matSignal = 0.1 * MatrixXd::Random(iSamples, iChannels);
+    for(qint32 i = 0; i < 4; ++i)
+    {
+        VectorXd vecAtom = gaborAtom.create_real(iSamples, iSamples / (8.0 * (i + 1)), iSamples * (i + 1) / 5, iSamples / (16.0 * (i + 1)), 0.5 * i);
+        VectorXd vecAmplitudes = VectorXd::Random(iChannels);
+        matSignal += vecAtom * vecAmplitudes.transpose();
+    }
+
+    printf("Decomposing %d channels x %d samples into %d atoms, %d runs\n", iChannels, iSamples, iIterations, iRuns);
+
+    QElapsedTimer timer;
+    qint64 iTotalTime = 0;
+
+    for(qint32 r = 0; r < iRuns; ++r)
+    {
+        AdaptiveMp adaptiveMp;
+
+        timer.start();
+        adaptiveMp.matching_pursuit(matSignal, iIterations, 0.0, false, iBoost, 0, 1.0, 0.2, 0.5, 0.5, false);
+        qint64 iTime = timer.elapsed();
+
+        iTotalTime += iTime;
+        printf("Run %d: %lld ms (%.1f ms per atom)\n", r + 1, iTime, (double) iTime / qMax(1, adaptiveMp.it));
+    }
+
+    printf("Mean: %.1f ms per segment\n", (double) iTotalTime / iRuns);
+
+    return 0;
+}
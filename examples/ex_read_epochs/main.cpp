@@ -50,9 +50,11 @@
 //=============================================================================================================
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_event_index.h>
 #include <mne/mne.h>
 
 #include <mne/mne_epoch_data_list.h>
+#include <mne/mne_epoch_tensor.h>
 
 
 //*************************************************************************************************************
@@ -163,21 +165,28 @@ int main(int argc, char *argv[])
                                     raw.info.bads);
     }
 
-    // Read the events
-    MatrixXi events;    
-    MNE::read_events(t_sEventName,
-                     t_fileRawName,
-                     events);
-
-    // Read the epochs and reject epochs with EOG higher than 250e-06
-    MNEEpochDataList data = MNEEpochDataList::readEpochs(raw,
-                                                         events,
-                                                         fTMin,
-                                                         fTMax,
-                                                         event,
-                                                         250.0*0.0000010,
-                                                         "eog",
-                                                         picks);
+    // Read the events, without an event file take them from the trigger index of the raw file
+    MatrixXi events;
+    if(!MNE::read_events(t_sEventName,
+                         t_fileRawName,
+                         events)) {
+        FiffEventIndex eventIndex;
+        if(!eventIndex.load_or_build(raw)) {
+            printf("Could not find any events\n");
+            return 1;
+        }
+        events = eventIndex.events();
+    }
+
+    // Read the epochs into one contiguous block and reject epochs with EOG higher than 250e-06
+    MNEEpochTensorD data = MNEEpochDataList::readEpochTensor(raw,
+                                                             events,
+                                                             fTMin,
+                                                             fTMax,
+                                                             event,
+                                                             250.0*0.0000010,
+                                                             "eog",
+                                                             picks);
 
     // Drop rejected epochs
     data.dropRejected();
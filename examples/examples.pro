@@ -49,6 +49,7 @@ SUBDIRS += \
     ex_inverse_mne \
     ex_make_inverse_operator \
     ex_make_layout \
+    ex_mp_benchmark \
     ex_read_bem \
     ex_read_epochs \
     ex_read_evoked \
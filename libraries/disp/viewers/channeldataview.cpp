@@ -163,6 +163,14 @@ void ChannelDataView::addData(const QList<Eigen::MatrixXd> &data)
 }
 
 
+//*************************************************************************************************************
+
+void ChannelDataView::addData(const Eigen::MatrixXd &data, const QVector<qint32> &blockSizes)
+{
+    m_pModel->addData(data, blockSizes);
+}
+
+
 //*************************************************************************************************************
 
 MatrixXd ChannelDataView::getLastBlock()
@@ -136,6 +136,15 @@ public:
     */
     void addData(const QList<Eigen::MatrixXd>& data);
 
+    //=========================================================================================================
+    /**
+    * Add data to the view, several blocks stored side by side in one matrix.
+    *
+    * @param [in] data          The new data.
+    * @param [in] blockSizes    The number of columns of each block.
+    */
+    void addData(const Eigen::MatrixXd& data, const QVector<qint32>& blockSizes);
+
     //=========================================================================================================
     /**
     * Get the latest data block from the underlying model.
@@ -43,6 +43,7 @@
 
 #include <fiff/fiff_types.h>
 #include <fiff/fiff_info.h>
+#include <fiff/fiff_proj_comp_operator.h>
 
 #include <utils/mnemath.h>
 #include <utils/detecttrigger.h>
@@ -86,8 +87,6 @@ using namespace Eigen;
 ChannelDataModel::ChannelDataModel(QObject *parent)
 : QAbstractTableModel(parent)
 , m_bSpharaActivated(false)
-, m_bProjActivated(false)
-, m_bCompActivated(false)
 , m_fSps(1024.0f)
 , m_iT(10)
 , m_iDownsampling(10)
@@ -103,6 +102,7 @@ ChannelDataModel::ChannelDataModel(QObject *parent)
 , m_dTriggerThreshold(0.01)
 , m_iDistanceTimerSpacer(1000)
 , m_iDetectedTriggers(0)
+, m_iCompTo(0)
 , m_iCurrentSampleFreeze(0)
 , m_iCurrentTriggerChIndex(0)
 , m_pFiffInfo(FiffInfo::SPtr::create())
@@ -342,15 +342,8 @@ void ChannelDataModel::setFiffInfo(QSharedPointer<FIFFLIB::FiffInfo> &p_pFiffInf
 
         m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
 
-        m_matSparseProjMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-        m_matSparseCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseSpharaMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-        m_matSparseProjCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-
-        m_matSparseProjMult.setIdentity();
-        m_matSparseCompMult.setIdentity();
         m_matSparseSpharaMult.setIdentity();
-        m_matSparseProjCompMult.setIdentity();
 
         //Create the initial Compensator projector
         updateCompensator(0);
@@ -381,8 +374,7 @@ void ChannelDataModel::setFiffInfo(QSharedPointer<FIFFLIB::FiffInfo> &p_pFiffInf
         initSphara();
     } else {
         m_vecBadIdcs = RowVectorXi(0,0);
-        m_matProj = MatrixXd(0,0);
-        m_matComp = MatrixXd(0,0);
+        m_pProjCompOperator.clear();
     }
 }
 
@@ -434,153 +426,172 @@ MatrixXd ChannelDataModel::getLastBlock()
 
 void ChannelDataModel::addData(const QList<MatrixXd> &data)
 {
-    //SSP
-    bool doProj = m_bProjActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matProj.cols() ? true : false;
-
-    //Compensator
-    bool doComp = m_bCompActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matComp.cols() ? true : false;
+    //SSP and compensator
+    bool doProjComp = m_pProjCompOperator && !m_pProjCompOperator->isIdentity() && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_pProjCompOperator->nchan() ? true : false;
 
     //SPHARA
     bool doSphara = m_bSpharaActivated && m_matSparseSpharaMult.cols() > 0 && m_matDataRaw.rows() == m_matSparseSpharaMult.cols() ? true : false;
 
     //Copy new data into the global data matrix
     for(qint32 b = 0; b < data.size(); ++b) {
-        int nCol = data.at(b).cols();
-        int nRow = data.at(b).rows();
+        if(!addBlock(data.at(b), doProjComp, doSphara)) {
+            return;
+        }
+    }
+
+    //Update data content
+    QModelIndex topLeft = this->index(0,1);
+    QModelIndex bottomRight = this->index(m_pFiffInfo->ch_names.size()-1,1);
+    QVector<int> roles; roles << Qt::DisplayRole;
+    emit dataChanged(topLeft, bottomRight, roles);
+}
+
+
+//*************************************************************************************************************
+
+void ChannelDataModel::addData(const MatrixXd &data, const QVector<qint32> &blockSizes)
+{
+    //SSP and compensator
+    bool doProjComp = m_pProjCompOperator && !m_pProjCompOperator->isIdentity() && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_pProjCompOperator->nchan() ? true : false;
 
-        if(nRow != m_matDataRaw.rows()) {
-            qDebug()<<"incoming data does not match internal data row size. Returning...";
+    //SPHARA
+    bool doSphara = m_bSpharaActivated && m_matSparseSpharaMult.cols() > 0 && m_matDataRaw.rows() == m_matSparseSpharaMult.cols() ? true : false;
+
+    //Copy new data into the global data matrix, the blocks are read in place
+    qint32 iOffset = 0;
+    for(qint32 b = 0; b < blockSizes.size(); ++b) {
+        if(iOffset + blockSizes[b] > data.cols() || !addBlock(data.middleCols(iOffset, blockSizes[b]), doProjComp, doSphara)) {
             return;
         }
+        iOffset += blockSizes[b];
+    }
+
+    //Update data content
+    QModelIndex topLeft = this->index(0,1);
+    QModelIndex bottomRight = this->index(m_pFiffInfo->ch_names.size()-1,1);
+    QVector<int> roles; roles << Qt::DisplayRole;
+    emit dataChanged(topLeft, bottomRight, roles);
+}
 
-        //Reset m_iCurrentSample and start filling the data matrix from the beginning again. Also add residual amount of data to the end of the matrix.
-        if(m_iCurrentSample+nCol > m_matDataRaw.cols()) {
-            m_iResidual = nCol - ((m_iCurrentSample+nCol) % m_matDataRaw.cols());
 
-            if(m_iResidual == nCol) {
-                m_iResidual = 0;
-            }
+//*************************************************************************************************************
+
+bool ChannelDataModel::addBlock(const Eigen::Ref<const MatrixXd> &data, bool doProjComp, bool doSphara)
+{
+    int nCol = data.cols();
+    int nRow = data.rows();
+
+    if(nRow != m_matDataRaw.rows()) {
+        qDebug()<<"incoming data does not match internal data row size. Returning...";
+        return false;
+    }
+
+    //Reset m_iCurrentSample and start filling the data matrix from the beginning again. Also add residual amount of data to the end of the matrix.
+    if(m_iCurrentSample+nCol > m_matDataRaw.cols()) {
+        m_iResidual = nCol - ((m_iCurrentSample+nCol) % m_matDataRaw.cols());
+
+        if(m_iResidual == nCol) {
+            m_iResidual = 0;
+        }
 
 //            std::cout<<"incoming data exceeds internal data cols by: "<<(m_iCurrentSample+nCol) % m_matDataRaw.cols()<<std::endl;
 //            std::cout<<"m_iCurrentSample+nCol: "<<m_iCurrentSample+nCol<<std::endl;
 //            std::cout<<"m_matDataRaw.cols(): "<<m_matDataRaw.cols()<<std::endl;
 //            std::cout<<"nCol-m_iResidual: "<<nCol-m_iResidual<<std::endl<<std::endl;
 
-            if(doComp) {
-                if(doProj) {
-                    //Comp + Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * data.at(b).block(0,0,nRow,m_iResidual);
-                } else {
-                    //Comp
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * data.at(b).block(0,0,nRow,m_iResidual);
-                }
-            } else {
-                if(doProj)
-                {
-                    //Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * data.at(b).block(0,0,nRow,m_iResidual);
-                } else {
-                    //None - Raw
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = data.at(b).block(0,0,nRow,m_iResidual);
-                }
-            }
+        if(doProjComp) {
+            //Comp + Proj
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_pProjCompOperator->apply(data.block(0,0,nRow,m_iResidual));
+        } else {
+            //None - Raw
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = data.block(0,0,nRow,m_iResidual);
+        }
 
-            m_iCurrentSample = 0;
+        m_iCurrentSample = 0;
 
-            if(!m_bIsFreezed) {
-                m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
-                m_vecLastBlockFirstValuesRaw = m_matDataRaw.col(0);
-            }
+        if(!m_bIsFreezed) {
+            m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
+            m_vecLastBlockFirstValuesRaw = m_matDataRaw.col(0);
+        }
 
-            //Store old detected triggers
-            m_qMapDetectedTriggerOld = m_qMapDetectedTrigger;
+        //Store old detected triggers
+        m_qMapDetectedTriggerOld = m_qMapDetectedTrigger;
 
-            //Clear detected triggers
-            if(m_bTriggerDetectionActive) {
-                QMutableMapIterator<int,QList<QPair<int,double> > > i(m_qMapDetectedTrigger);
-                while (i.hasNext()) {
-                    i.next();
-                    i.value().clear();
-                }
+        //Clear detected triggers
+        if(m_bTriggerDetectionActive) {
+            QMutableMapIterator<int,QList<QPair<int,double> > > i(m_qMapDetectedTrigger);
+            while (i.hasNext()) {
+                i.next();
+                i.value().clear();
             }
-        } else {
-            m_iResidual = 0;
         }
+    } else {
+        m_iResidual = 0;
+    }
 
-        //std::cout<<"incoming data is ok"<<std::endl;
+    //std::cout<<"incoming data is ok"<<std::endl;
 
-        if(doComp) {
-            if(doProj) {
-                //Comp + Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * data.at(b);
-            } else {
-                //Comp
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * data.at(b);
-            }
-        } else {
-            if(doProj) {
-                //Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * data.at(b);
-            } else {
-                //None - Raw
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = data.at(b);
-            }
-        }
+    if(doProjComp) {
+        //Comp + Proj
+        m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_pProjCompOperator->apply(data);
+    } else {
+        //None - Raw
+        m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = data;
+    }
 
-        //Filter if neccessary else set filtered data matrix to zero
-        if(!m_filterData.isEmpty()) {
-            filterChannelsConcurrently(m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol), m_iCurrentSample);
+    //Filter if neccessary else set filtered data matrix to zero
+    if(!m_filterData.isEmpty()) {
+        filterChannelsConcurrently(m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol), m_iCurrentSample);
 
-            //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
-            if(doSphara) {
-                if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
-                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
-                }
-                else {
-                    if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
-                        m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
-                        int iResidual = m_iResidual+m_iMaxFilterLength/2;
-                        m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
-                    }
+        //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
+        if(doSphara) {
+            if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
+                m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
+            }
+            else {
+                if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
+                    m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
+                    int iResidual = m_iResidual+m_iMaxFilterLength/2;
+                    m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
                 }
             }
-        } else {
-            m_matDataFiltered.block(0, m_iCurrentSample, nRow, nCol).setZero();// = m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
+        }
+    } else {
+        m_matDataFiltered.block(0, m_iCurrentSample, nRow, nCol).setZero();// = m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
 
-            //Perform SPHARA on raw data data
-            if(doSphara) {
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseSpharaMult * m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
-            }
+        //Perform SPHARA on raw data data
+        if(doSphara) {
+            m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseSpharaMult * m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol);
         }
+    }
 
-        m_iCurrentSample += nCol;
-        m_iCurrentBlockSize = nCol;
+    m_iCurrentSample += nCol;
+    m_iCurrentBlockSize = nCol;
 
-        //detect the trigger flanks in the trigger channels
-        if(m_bTriggerDetectionActive) {
-            int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
+    //detect the trigger flanks in the trigger channels
+    if(m_bTriggerDetectionActive) {
+        int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
 
-            QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, true);
-            //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
+        //Only the trigger channel is passed on, data may be a view into a larger matrix
+        QList<QPair<int,double> > qMapDetectedTrigger;
+        if(m_iCurrentTriggerChIndex >= 0 && m_iCurrentTriggerChIndex < nRow) {
+            MatrixXd matTrigger = data.row(m_iCurrentTriggerChIndex);
+            qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(matTrigger, 0, m_iCurrentSample-nCol, m_dTriggerThreshold, true);
+        }
+        //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(data, m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
 
-            //Append results to already found triggers
-            m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].append(qMapDetectedTrigger);
+        //Append results to already found triggers
+        m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].append(qMapDetectedTrigger);
 
-            //Compute newly counted triggers
-            int newTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size() - iOldDetectedTriggers;
+        //Compute newly counted triggers
+        int newTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size() - iOldDetectedTriggers;
 
-            if(newTriggers!=0) {
-                m_iDetectedTriggers += newTriggers;
-                emit triggerDetected(m_iDetectedTriggers, m_qMapDetectedTrigger);
-            }
+        if(newTriggers!=0) {
+            m_iDetectedTriggers += newTriggers;
+            emit triggerDetected(m_iDetectedTriggers, m_qMapDetectedTrigger);
         }
     }
-
-    //Update data content
-    QModelIndex topLeft = this->index(0,1);
-    QModelIndex bottomRight = this->index(m_pFiffInfo->ch_names.size()-1,1);
-    QVector<int> roles; roles << Qt::DisplayRole;
-    emit dataChanged(topLeft, bottomRight, roles);
+    return true;
 }
 
 
@@ -717,56 +728,11 @@ void ChannelDataModel::setScaling(const QMap< qint32,float >& p_qMapChScaling)
 
 void ChannelDataModel::updateProjection()
 {
-    //  Update the SSP projector
+    //  Update the SSP projector, the compensator is reused from the fiff info cache
     if(m_pFiffInfo) {
-        //If a minimum of one projector is active set m_bProjActivated to true so that this model applies the ssp to the incoming data
-        m_bProjActivated = false;
-        for(qint32 i = 0; i < this->m_pFiffInfo->projs.size(); ++i) {
-            if(this->m_pFiffInfo->projs[i].active) {
-                m_bProjActivated = true;
-                break;
-            }
-        }
-
-        this->m_pFiffInfo->make_projector(m_matProj);
+        //Bad channels are set to zero by the projection
+        m_pProjCompOperator = m_pFiffInfo->proj_comp_operator(m_iCompTo, true);
         qDebug() << "ChannelDataModel::updateProjection - New projection calculated.";
-
-        //set columns of matrix to zero depending on bad channels indexes
-        for(qint32 j = 0; j < m_vecBadIdcs.cols(); ++j) {
-            m_matProj.col(m_vecBadIdcs[j]).setZero();
-        }
-
-//        std::cout << "Bads\n" << m_vecBadIdcs << std::endl;
-//        std::cout << "Proj\n";
-//        std::cout << m_matProj.block(0,0,10,10) << std::endl;
-
-        //
-        // Make proj sparse
-        //
-        qint32 nchan = this->m_pFiffInfo->nchan;
-        qint32 i, k;
-
-        typedef Eigen::Triplet<double> T;
-        std::vector<T> tripletList;
-        tripletList.reserve(nchan);
-
-        tripletList.clear();
-        tripletList.reserve(m_matProj.rows()*m_matProj.cols());
-        for(i = 0; i < m_matProj.rows(); ++i) {
-            for(k = 0; k < m_matProj.cols(); ++k) {
-                if(m_matProj(i,k) != 0) {
-                    tripletList.push_back(T(i, k, m_matProj(i,k)));
-                }
-            }
-        }
-
-        m_matSparseProjMult = SparseMatrix<double>(m_matProj.rows(),m_matProj.cols());
-        if(tripletList.size() > 0) {
-            m_matSparseProjMult.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-
-        //Create full multiplication matrix
-        m_matSparseProjCompMult = m_matSparseProjMult * m_matSparseCompMult;
     }
 }
 
@@ -775,53 +741,15 @@ void ChannelDataModel::updateProjection()
 
 void ChannelDataModel::updateCompensator(int to)
 {
-    //  Update the compensator
+    //  Update the compensator, the projection is reused from the fiff info cache
     if(m_pFiffInfo) {
-        if(to == 0) {
-            m_bCompActivated = false;
-        } else {
-            m_bCompActivated = true;
-        }
-
-//        qDebug()<<"to"<<to;
-//        qDebug()<<"from"<<from;
-//        qDebug()<<"m_bCompActivated"<<m_bCompActivated;
-
-        FiffCtfComp newComp;
-        this->m_pFiffInfo->make_compensator(0, to, newComp);//Do this always from 0 since we always read new raw data, we never actually perform a multiplication on already existing data
+        m_iCompTo = to;
 
         //We do not need to call this->m_pFiffInfo->set_current_comp(to);
         //Because we will set the compensators to the coil in the same FiffInfo which is already used to write to file.
         //Note that the data is written in raw form not in compensated form.
-        m_matComp = newComp.data->data;
-
-        //
-        // Make proj sparse
-        //
-        qint32 nchan = this->m_pFiffInfo->nchan;
-        qint32 i, k;
-
-        typedef Eigen::Triplet<double> T;
-        std::vector<T> tripletList;
-        tripletList.reserve(nchan);
-
-        tripletList.clear();
-        tripletList.reserve(m_matComp.rows()*m_matComp.cols());
-        for(i = 0; i < m_matComp.rows(); ++i) {
-            for(k = 0; k < m_matComp.cols(); ++k) {
-                if(m_matComp(i,k) != 0) {
-                    tripletList.push_back(T(i, k, m_matComp(i,k)));
-                }
-            }
-        }
-
-        m_matSparseCompMult = SparseMatrix<double>(m_matComp.rows(),m_matComp.cols());
-        if(tripletList.size() > 0) {
-            m_matSparseCompMult.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-
-        //Create full multiplication matrix
-        m_matSparseProjCompMult = m_matSparseProjMult * m_matSparseCompMult;
+        //The compensator is always made from 0 since we always read new raw data, we never actually perform a multiplication on already existing data
+        m_pProjCompOperator = m_pFiffInfo->proj_comp_operator(m_iCompTo, true);
     }
 }
 
@@ -74,6 +74,7 @@
 
 namespace FIFFLIB {
     class FiffInfo;
+    class FiffProjCompOperator;
 }
 
 namespace UTILSLIB {
@@ -203,6 +204,16 @@ public:
     */
     void addData(const QList<Eigen::MatrixXd> &data);
 
+    //=========================================================================================================
+    /**
+    * Adds several blocks of time points which are stored side by side in one matrix. The blocks are read in
+    * place without copying them first.
+    *
+    * @param[in] data       data to add, the blocks side by side
+    * @param[in] blockSizes number of columns of each block
+    */
+    void addData(const Eigen::MatrixXd &data, const QVector<qint32> &blockSizes);
+
     //=========================================================================================================
     /**
     * Returns the kind of a given channel number
@@ -530,14 +541,24 @@ private:
     */
     void filterChannelsConcurrently(const Eigen::MatrixXd &data, int iDataIndex);
 
+    //=========================================================================================================
+    /**
+    * Adds a single block of time points to the data matrices, filters it and detects triggers.
+    *
+    * @param [in] data          the block
+    * @param [in] doProjComp    whether to apply the projectors and the compensator
+    * @param [in] doSphara      whether to apply SPHARA
+    *
+    * @return false if the block does not fit the data matrices
+    */
+    bool addBlock(const Eigen::Ref<const Eigen::MatrixXd> &data, bool doProjComp, bool doSphara);
+
     //=========================================================================================================
     /**
     * Clears the model
     */
     void clearModel();
 
-    bool                                m_bProjActivated;                           /**< Projections activated */
-    bool                                m_bCompActivated;                           /**< Compensator activated */
     bool                                m_bSpharaActivated;                         /**< Sphara activated */
     bool                                m_bIsFreezed;                               /**< Display is freezed */
     bool                                m_bDrawFilterFront;                         /**< Flag whether to plot/write the delayed frontal part of the filtered signal. This flag is necessary to get rid of nasty signal jumps when changing the filter parameters. */
@@ -555,11 +576,13 @@ private:
     int                                 m_iCurrentTriggerChIndex;                   /**< The index of the current trigger channel */
     int                                 m_iDistanceTimerSpacer;                     /**< The distance for the horizontal time spacers in the view in ms */
     int                                 m_iDetectedTriggers;                        /**< Detected triggers since the last reset */
+    int                                 m_iCompTo;                                  /**< Compensation grade the data are compensated to */
 
     QString                             m_sCurrentTriggerCh;                        /**< Current trigger channel which is beeing scanned */
     QString                             m_sFilterChannelType;                       /**< Kind of channel which is to be filtered */
 
     QSharedPointer<FIFFLIB::FiffInfo>   m_pFiffInfo;                                /**< Fiff info */
+    QSharedPointer<const FIFFLIB::FiffProjCompOperator> m_pProjCompOperator;        /**< SSP projector and compensator, taken from the cache of the fiff info */
 
     Eigen::RowVectorXi                  m_vecBadIdcs;                               /**< Idcs of bad channels */
     Eigen::VectorXd                     m_vecLastBlockFirstValuesFiltered;          /**< The first value of the last complete filtered data display block */
@@ -578,12 +601,6 @@ private:
     Eigen::VectorXi                     m_vecIndicesFirstEEG;                       /**< The indices of the channels to pick for the second SPHARA operator in case of an EEG system.*/
 
     Eigen::SparseMatrix<double>         m_matSparseSpharaMult;                      /**< The final sparse SPHARA operator .*/
-    Eigen::SparseMatrix<double>         m_matSparseProjCompMult;                    /**< The final sparse projection + compensator operator.*/
-    Eigen::SparseMatrix<double>         m_matSparseProjMult;                        /**< The final sparse SSP projector */
-    Eigen::SparseMatrix<double>         m_matSparseCompMult;                        /**< The final sparse compensator matrix */
-
-    Eigen::MatrixXd                     m_matProj;                                  /**< SSP projector */
-    Eigen::MatrixXd                     m_matComp;                                  /**< Compensator */
 
     Eigen::MatrixXd                     m_matSpharaVVGradLoaded;                    /**< The loaded VectorView gradiometer basis functions.*/
     Eigen::MatrixXd                     m_matSpharaVVMagLoaded;                     /**< The loaded VectorView magnetometer basis functions.*/
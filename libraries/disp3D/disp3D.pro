@@ -128,6 +128,7 @@ SOURCES += \
     engine/model/items/sensordata/sensordatatreeitem.cpp \
     helpers/interpolation/interpolation.cpp \
     helpers/geometryinfo/geometryinfo.cpp \
+    helpers/geometryinfo/vertexkdtree.cpp \
     engine/model/3dhelpers/geometrymultiplier.cpp \
     engine/model/materials/geometrymultipliermaterial.cpp \
     engine/view/customframegraph.cpp \
@@ -185,6 +186,7 @@ HEADERS += \
     engine/model/items/sensordata/sensordatatreeitem.h \
     helpers/interpolation/interpolation.h \
     helpers/geometryinfo/geometryinfo.h \
+    helpers/geometryinfo/vertexkdtree.h \
     engine/model/3dhelpers/geometrymultiplier.h \
     engine/model/materials/geometrymultipliermaterial.h \
     engine/view/customframegraph.h \
@@ -113,6 +113,9 @@ RtSourceDataController::RtSourceDataController()
        connect(this, &RtSourceDataController::sFreqChanged,
                m_pRtSourceDataWorker.data(), &RtSourceDataWorker::setSFreq);
 
+       connect(this, &RtSourceDataController::timeIntervalChanged,
+               m_pRtSourceDataWorker.data(), &RtSourceDataWorker::setTimeInterval);
+
        connect(this, &RtSourceDataController::loopStateChanged,
                m_pRtSourceDataWorker.data(), &RtSourceDataWorker::setLoopState);
 
@@ -243,6 +246,8 @@ void RtSourceDataController::setTimeInterval(int iMSec)
 
     m_iMSecInterval = iMSec;
     m_timer.setInterval(m_iMSecInterval);
+
+    emit timeIntervalChanged(m_iMSecInterval);
 }
 
 
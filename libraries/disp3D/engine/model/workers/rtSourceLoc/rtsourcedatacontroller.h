@@ -411,6 +411,14 @@ signals:
     */
     void sFreqChanged(double dSFreq);
 
+    //=========================================================================================================
+    /**
+    * Emit this signal whenever the streaming time interval changed.
+    *
+    * @param[in] iMSec                  The new time interval in milli seconds.
+    */
+    void timeIntervalChanged(int iMSec);
+
     //=========================================================================================================
     /**
     * Emit this signal whenever the number of averages changed.
@@ -74,6 +74,17 @@ using namespace DISPLIB;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+    const int COLOR_LUT_SIZE = 1024;     /**< Number of entries of the sampled color map. */
+    const int FRAME_BATCH_SIZE = 8;      /**< Default number of frames to interpolate at once. */
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -81,16 +92,29 @@ using namespace FIFFLIB;
 
 RtSourceDataWorker::RtSourceDataWorker()
 : m_bIsLooping(true)
-, m_iAverageSamples(1)
-, m_dSFreq(1000.0)
 , m_bStreamSmoothedData(true)
-, m_iCurrentSample(0)
+, m_bStreamFromLoop(false)
+, m_bBatchIsValid(false)
+, m_bBatchFromLoop(false)
+, m_iDataQPos(0)
+, m_iLoopPos(0)
+, m_iAverageSamples(1)
 , m_iSampleCtr(0)
+, m_iMSecInterval(17)
+, m_iBatchStart(0)
+, m_iBatchFrames(0)
+, m_iBatchAverages(0)
+, m_iBatchSize(FRAME_BATCH_SIZE)
+, m_dSFreq(1000.0)
 {
     VisualizationInfo leftHemiInfo;
     VisualizationInfo rightHemiInfo;
     leftHemiInfo.functionHandlerColorMap = ColorMap::valueToHot;
     rightHemiInfo.functionHandlerColorMap = ColorMap::valueToHot;
+    createColorLut(leftHemiInfo.functionHandlerColorMap, leftHemiInfo.matColorLut);
+    rightHemiInfo.matColorLut = leftHemiInfo.matColorLut;
+    leftHemiInfo.iCurrentFrame = 0;
+    rightHemiInfo.iCurrentFrame = 0;
     leftHemiInfo.pMatInterpolationMatrix = QSharedPointer<SparseMatrix<float> >(new SparseMatrix<float>());
     rightHemiInfo.pMatInterpolationMatrix = QSharedPointer<SparseMatrix<float> >(new SparseMatrix<float>());
     m_lHemiVisualizationInfo << leftHemiInfo << rightHemiInfo;
@@ -106,17 +130,62 @@ void RtSourceDataWorker::addData(const MatrixXd& data)
         return;
     }
 
-    //Transform from matrix to list for easier handling in non loop mode
-    for(int i = 0; i<data.cols(); i++) {
-        if(m_lDataQ.size() < m_dSFreq) {
-            m_lDataQ.push_back(data.col(i));
-        } else {
-            qDebug() <<"RtSourceDataWorker::addData - worker is full ("<<m_lDataQ.size()<<")";
-            break;
+    if(m_matDataQ.rows() != data.rows()) {
+        clear();
+        m_matDataQ.resize(data.rows(), 0);
+    }
+
+    //Drop the samples which were already streamed but keep the ones of the current frame
+    const int iKeepFrom = m_bStreamFromLoop ? m_iDataQPos : m_iDataQPos - m_iSampleCtr;
+
+    if(iKeepFrom > 0) {
+        const int iKeep = m_matDataQ.cols() - iKeepFrom;
+        m_matDataQ.leftCols(iKeep) = m_matDataQ.rightCols(iKeep).eval();
+        m_matDataQ.conservativeResize(Eigen::NoChange, iKeep);
+        m_iDataQPos -= iKeepFrom;
+
+        if(!m_bBatchFromLoop) {
+            m_iBatchStart -= iKeepFrom;
         }
     }
 
-    m_lDataLoopQ = m_lDataQ;
+    //Append as many samples as fit into the queue
+    int iNumAdd = data.cols();
+    const int iNumQueued = m_matDataQ.cols() - m_iDataQPos;
+
+    if(iNumQueued + iNumAdd > m_dSFreq) {
+        iNumAdd = qMax(0, int(m_dSFreq) - iNumQueued);
+        qDebug() <<"RtSourceDataWorker::addData - worker is full ("<<iNumQueued<<")";
+    }
+
+    if(iNumAdd > 0) {
+        m_matDataQ.conservativeResize(Eigen::NoChange, m_matDataQ.cols() + iNumAdd);
+        m_matDataQ.rightCols(iNumAdd) = data.leftCols(iNumAdd);
+    }
+
+    m_matDataLoopQ = m_matDataQ.rightCols(m_matDataQ.cols() - m_iDataQPos);
+    m_iLoopPos = 0;
+
+    if(m_bStreamFromLoop) {
+        m_iSampleCtr = 0;
+    }
+
+    if(m_bBatchFromLoop) {
+        m_bBatchIsValid = false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtSourceDataWorker::clear()
+{
+    m_matDataQ.resize(0, 0);
+    m_matDataLoopQ.resize(0, 0);
+    m_iDataQPos = 0;
+    m_iLoopPos = 0;
+    m_iSampleCtr = 0;
+    m_bBatchIsValid = false;
 }
 
 
@@ -135,6 +204,7 @@ void RtSourceDataWorker::setNumberVertices(int iNumberVertsLeft,
 void RtSourceDataWorker::setNumberAverages(int iNumAvr)
 {
     m_iAverageSamples = iNumAvr;
+    m_iSampleCtr = 0;
 }
 
 
@@ -151,18 +221,23 @@ void RtSourceDataWorker::setStreamSmoothedData(bool bStreamSmoothedData)
 void RtSourceDataWorker::setColormapType(const QString& sColormapType)
 {
     //Create function handler to corresponding color map function
+    QRgb (*functionHandlerColorMap)(double v) = m_lHemiVisualizationInfo[0].functionHandlerColorMap;
+
     if(sColormapType == QStringLiteral("Hot Negative 1")) {
-        m_lHemiVisualizationInfo[0].functionHandlerColorMap = ColorMap::valueToHotNegative1;
-        m_lHemiVisualizationInfo[1].functionHandlerColorMap = ColorMap::valueToHotNegative1;
+        functionHandlerColorMap = ColorMap::valueToHotNegative1;
     } else if(sColormapType == QStringLiteral("Hot")) {
-        m_lHemiVisualizationInfo[0].functionHandlerColorMap = ColorMap::valueToHot;
-        m_lHemiVisualizationInfo[1].functionHandlerColorMap = ColorMap::valueToHot;
+        functionHandlerColorMap = ColorMap::valueToHot;
     } else if(sColormapType == QStringLiteral("Hot Negative 2")) {
-        m_lHemiVisualizationInfo[0].functionHandlerColorMap = ColorMap::valueToHotNegative2;
-        m_lHemiVisualizationInfo[1].functionHandlerColorMap = ColorMap::valueToHotNegative2;
+        functionHandlerColorMap = ColorMap::valueToHotNegative2;
     } else if(sColormapType == QStringLiteral("Jet")) {
-        m_lHemiVisualizationInfo[0].functionHandlerColorMap = ColorMap::valueToJet;
-        m_lHemiVisualizationInfo[1].functionHandlerColorMap = ColorMap::valueToJet;
+        functionHandlerColorMap = ColorMap::valueToJet;
+    }
+
+    if(functionHandlerColorMap != m_lHemiVisualizationInfo[0].functionHandlerColorMap) {
+        createColorLut(functionHandlerColorMap, m_lHemiVisualizationInfo[0].matColorLut);
+        m_lHemiVisualizationInfo[1].matColorLut = m_lHemiVisualizationInfo[0].matColorLut;
+        m_lHemiVisualizationInfo[0].functionHandlerColorMap = functionHandlerColorMap;
+        m_lHemiVisualizationInfo[1].functionHandlerColorMap = functionHandlerColorMap;
     }
 }
 
@@ -194,11 +269,20 @@ void RtSourceDataWorker::setSFreq(const double dSFreq)
 }
 
 
+//*************************************************************************************************************
+
+void RtSourceDataWorker::setTimeInterval(int iMSec)
+{
+    m_iMSecInterval = iMSec;
+}
+
+
 //*************************************************************************************************************
 
 void RtSourceDataWorker::setInterpolationMatrixLeft(QSharedPointer<Eigen::SparseMatrix<float> > pMatInterpolationMatrixLeft)
 {
     m_lHemiVisualizationInfo[0].pMatInterpolationMatrix = pMatInterpolationMatrixLeft;
+    m_bBatchIsValid = false;
 }
 
 
@@ -207,7 +291,7 @@ void RtSourceDataWorker::setInterpolationMatrixLeft(QSharedPointer<Eigen::Sparse
 void RtSourceDataWorker::setInterpolationMatrixRight(QSharedPointer<Eigen::SparseMatrix<float> > pMatInterpolationMatrixRight)
 {
     m_lHemiVisualizationInfo[1].pMatInterpolationMatrix = pMatInterpolationMatrixRight;
-
+    m_bBatchIsValid = false;
 }
 
 
@@ -217,62 +301,102 @@ void RtSourceDataWorker::streamData()
 {
     //QElapsedTimer time;
     //time.start();
-    if(m_lDataQ.isEmpty()) {
-        if(m_bIsLooping && !m_lDataLoopQ.isEmpty()) {
-            if(m_vecAverage.rows() != m_lDataLoopQ.front().rows()) {
-                m_vecAverage = m_lDataLoopQ.front();
-            } else if (m_iCurrentSample < m_lDataLoopQ.size()){
-                m_vecAverage += m_lDataLoopQ.at(m_iCurrentSample);
-            }
+    const int iDue = samplesDue();
 
-            //Set iterator back to the front if needed
-            if(m_iCurrentSample == m_lDataLoopQ.size()) {
-                m_iCurrentSample = 0;
-            }
+    //Stream from the queue as long as it holds data, otherwise repeat the loop data
+    bool bFromLoop = false;
+
+    if(m_iDataQPos >= m_matDataQ.cols()) {
+        if(m_bIsLooping && m_matDataLoopQ.cols() > 0) {
+            bFromLoop = true;
         } else {
             return;
         }
+    }
+
+    //Start a new frame whenever the source changes
+    if(bFromLoop != m_bStreamFromLoop) {
+        m_bStreamFromLoop = bFromLoop;
+        m_iSampleCtr = 0;
+    }
+
+    if(m_iAverageSamples <= 0) {
+        return;
+    }
+
+    //Advance the playback position by the due samples
+    int iPos = bFromLoop ? m_iLoopPos : m_iDataQPos;
+    const int iFrameStart = iPos - m_iSampleCtr;
+    int iNumSamples = iDue;
+
+    if(bFromLoop) {
+        m_iLoopPos = (m_iLoopPos + iNumSamples) % m_matDataLoopQ.cols();
     } else {
-        if(m_vecAverage.rows() != m_lDataQ.front().rows()) {
-            m_vecAverage = m_lDataQ.takeFirst();
-        } else {
-            m_vecAverage += m_lDataQ.takeFirst();
+        iNumSamples = qMin(iNumSamples, int(m_matDataQ.cols()) - m_iDataQPos);
+        m_iDataQPos += iNumSamples;
+    }
+
+    const int iFramesDone = (m_iSampleCtr + iNumSamples) / m_iAverageSamples;
+    m_iSampleCtr = (m_iSampleCtr + iNumSamples) % m_iAverageSamples;
+
+    if(iFramesDone == 0
+       || m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols() == 0
+       || m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols() == 0) {
+        return;
+    }
+
+    //Only show the latest completed frame, all frames in between are dropped
+    int iShowStart = iFrameStart + (iFramesDone - 1) * m_iAverageSamples;
+    if(bFromLoop) {
+        iShowStart = ((iShowStart % m_matDataLoopQ.cols()) + m_matDataLoopQ.cols()) % m_matDataLoopQ.cols();
+    }
+
+    const int iNumColsLeft = m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols();
+    const int iNumColsRight = m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols();
+
+    if(m_bStreamSmoothedData) {
+        //Look up the frame in the current batch and interpolate a new batch if needed
+        int iFrame = -1;
+
+        if(m_bBatchIsValid && m_bBatchFromLoop == bFromLoop && m_iBatchAverages == m_iAverageSamples) {
+            int iOffset = iShowStart - m_iBatchStart;
+            if(bFromLoop) {
+                iOffset = ((iOffset % m_matDataLoopQ.cols()) + m_matDataLoopQ.cols()) % m_matDataLoopQ.cols();
+            }
+            if(iOffset >= 0 && iOffset % m_iAverageSamples == 0 && iOffset / m_iAverageSamples < m_iBatchFrames) {
+                iFrame = iOffset / m_iAverageSamples;
+            }
         }
 
-        //Set iterator back to the front if needed
-        if(m_iCurrentSample == m_lDataQ.size()) {
-            m_iCurrentSample = 0;
+        if(iFrame < 0) {
+            computeBatch(bFromLoop, iShowStart, m_iAverageSamples);
+            iFrame = 0;
         }
-    }
 
-    m_iCurrentSample++;
-    m_iSampleCtr++;
-
-    if(m_iSampleCtr % m_iAverageSamples == 0
-       && m_iAverageSamples != 0
-       && m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols() != 0
-       && m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols() != 0) {
-        //Perform the actual interpolation and send signal
-        m_vecAverage /= (double)m_iAverageSamples;
-        if(m_bStreamSmoothedData) {
-            m_lHemiVisualizationInfo[0].vecSensorValues = m_vecAverage.segment(0, m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols());
-            m_lHemiVisualizationInfo[1].vecSensorValues = m_vecAverage.segment(m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols(), m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols());
-
-            //Do calculations for both hemispheres in parallel
-            QFuture<void> result = QtConcurrent::map(m_lHemiVisualizationInfo,
-                                                     generateColorsFromSensorValues);
-            result.waitForFinished();
-
-            emit newRtSmoothedData(m_lHemiVisualizationInfo[0].matFinalVertColor,
-                                   m_lHemiVisualizationInfo[1].matFinalVertColor);
-        } else {
-            emit newRtRawData(m_vecAverage.segment(0, m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols()),
-                              m_vecAverage.segment(m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols(), m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols()));
+        if(!m_bBatchIsValid) {
+            return;
         }
-        m_vecAverage.setZero(m_vecAverage.rows());
 
-        //reset sample counter
-        m_iSampleCtr = 0;
+        m_lHemiVisualizationInfo[0].iCurrentFrame = iFrame;
+        m_lHemiVisualizationInfo[1].iCurrentFrame = iFrame;
+
+        //Do calculations for both hemispheres in parallel
+        QFuture<void> result = QtConcurrent::map(m_lHemiVisualizationInfo,
+                                                 generateColorsFromSensorValues);
+        result.waitForFinished();
+
+        emit newRtSmoothedData(m_lHemiVisualizationInfo[0].matFinalVertColor,
+                               m_lHemiVisualizationInfo[1].matFinalVertColor);
+    } else {
+        const VectorXd vecAverage = frameAverage(bFromLoop ? m_matDataLoopQ : m_matDataQ, iShowStart, m_iAverageSamples);
+
+        if(vecAverage.rows() < iNumColsLeft + iNumColsRight) {
+            qDebug() << "RtSourceDataWorker::streamData - Number of sources (" << vecAverage.rows() << ") do not match the interpolation matrices. Returning...";
+            return;
+        }
+
+        emit newRtRawData(vecAverage.segment(0, iNumColsLeft),
+                          vecAverage.segment(iNumColsLeft, iNumColsRight));
     }
 
     //qDebug()<<"RtSourceDataWorker::streamData - this->thread() "<< this->thread();
@@ -282,67 +406,183 @@ void RtSourceDataWorker::streamData()
 
 //*************************************************************************************************************
 
-void RtSourceDataWorker::generateColorsFromSensorValues(VisualizationInfo &visualizationInfoHemi)
+int RtSourceDataWorker::samplesDue()
 {
-    if(visualizationInfoHemi.vecSensorValues.rows() != visualizationInfoHemi.pMatInterpolationMatrix->cols()) {
-        qDebug() << "RtSourceDataWorker::generateColorsFromSensorValues - Number of new vertex colors (" << visualizationInfoHemi.vecSensorValues.rows() << ") do not match with previously set number of sensors (" << visualizationInfoHemi.pMatInterpolationMatrix->cols() << "). Returning...";
+    if(!m_playbackTimer.isValid() || m_iMSecInterval <= 0) {
+        m_playbackTimer.start();
+        return 1;
+    }
+
+    const qint64 iElapsed = m_playbackTimer.restart();
+
+    //Streaming was paused in between, continue with the next sample
+    if(iElapsed > 1000) {
+        return 1;
+    }
+
+    return qMax(1, qRound(double(iElapsed) / double(m_iMSecInterval)));
+}
+
+
+//*************************************************************************************************************
+
+VectorXd RtSourceDataWorker::frameAverage(const MatrixXd& matData,
+                                          int iStart,
+                                          int iNumAvr)
+{
+    const int iCols = matData.cols();
+    VectorXd vecAverage = VectorXd::Zero(matData.rows());
+
+    if(iCols == 0 || iNumAvr <= 0) {
+        return vecAverage;
+    }
+
+    //Sum up contiguous column blocks, the frame might wrap around the end of the loop data
+    int iCol = iStart % iCols;
+    int iRemaining = iNumAvr;
+
+    while(iRemaining > 0) {
+        const int iBlock = qMin(iRemaining, iCols - iCol);
+        vecAverage += matData.middleCols(iCol, iBlock).rowwise().sum();
+        iRemaining -= iBlock;
+        iCol = 0;
+    }
+
+    return vecAverage / double(iNumAvr);
+}
+
+
+//*************************************************************************************************************
+
+void RtSourceDataWorker::computeBatch(bool bFromLoop,
+                                      int iStart,
+                                      int iNumAvr)
+{
+    const MatrixXd& matData = bFromLoop ? m_matDataLoopQ : m_matDataQ;
+
+    //Only use frames which are completely available
+    int iNumFrames = m_iBatchSize;
+    if(bFromLoop) {
+        iNumFrames = qMin(iNumFrames, qMax(1, int(matData.cols()) / iNumAvr));
+    } else {
+        iNumFrames = qMin(iNumFrames, qMax(1, (int(matData.cols()) - iStart) / iNumAvr));
+    }
+
+    const int iNumColsLeft = m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols();
+    const int iNumColsRight = m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols();
+
+    if(matData.rows() < iNumColsLeft + iNumColsRight) {
+        qDebug() << "RtSourceDataWorker::computeBatch - Number of sources (" << matData.rows() << ") do not match the interpolation matrices. Returning...";
+        m_bBatchIsValid = false;
         return;
     }
 
-    // interpolate sensor signals
-    VectorXf vecIntrpltdVals = Interpolation::interpolateSignal(*visualizationInfoHemi.pMatInterpolationMatrix, visualizationInfoHemi.vecSensorValues.cast<float>());
+    MatrixXf matFrames(matData.rows(), iNumFrames);
+    for(int i = 0; i < iNumFrames; ++i) {
+        matFrames.col(i) = frameAverage(matData, iStart + i * iNumAvr, iNumAvr).cast<float>();
+    }
+
+    m_lHemiVisualizationInfo[0].matSensorValues = matFrames.topRows(iNumColsLeft);
+    m_lHemiVisualizationInfo[1].matSensorValues = matFrames.middleRows(iNumColsLeft, iNumColsRight);
+
+    //Do the interpolation for both hemispheres in parallel
+    QFuture<void> result = QtConcurrent::map(m_lHemiVisualizationInfo,
+                                             interpolateBatch);
+    result.waitForFinished();
+
+    m_bBatchIsValid = true;
+    m_bBatchFromLoop = bFromLoop;
+    m_iBatchStart = iStart;
+    m_iBatchFrames = iNumFrames;
+    m_iBatchAverages = iNumAvr;
+}
+
+
+//*************************************************************************************************************
+
+void RtSourceDataWorker::interpolateBatch(VisualizationInfo &visualizationInfoHemi)
+{
+    //One sparse x dense product for all frames of the batch
+    visualizationInfoHemi.matInterpolatedValues = *visualizationInfoHemi.pMatInterpolationMatrix * visualizationInfoHemi.matSensorValues;
+}
+
 
-    // Reset to original color as default
+//*************************************************************************************************************
+
+void RtSourceDataWorker::generateColorsFromSensorValues(VisualizationInfo &visualizationInfoHemi)
+{
+    if(visualizationInfoHemi.matSensorValues.rows() != visualizationInfoHemi.pMatInterpolationMatrix->cols()) {
+        qDebug() << "RtSourceDataWorker::generateColorsFromSensorValues - Number of new vertex colors (" << visualizationInfoHemi.matSensorValues.rows() << ") do not match with previously set number of sensors (" << visualizationInfoHemi.pMatInterpolationMatrix->cols() << "). Returning...";
+        return;
+    }
+
+    // Reset to original color as default, this does not reallocate if the sizes did not change
     visualizationInfoHemi.matFinalVertColor = visualizationInfoHemi.matOriginalVertColor;
 
     //Generate color data for vertices
-    normalizeAndTransformToColor(vecIntrpltdVals,
+    normalizeAndTransformToColor(visualizationInfoHemi.matInterpolatedValues,
+                                 visualizationInfoHemi.iCurrentFrame,
                                  visualizationInfoHemi.matFinalVertColor,
                                  visualizationInfoHemi.dThresholdX,
                                  visualizationInfoHemi.dThresholdZ,
-                                 visualizationInfoHemi.functionHandlerColorMap);
+                                 visualizationInfoHemi.matColorLut);
 }
 
 
 //*************************************************************************************************************
 
-void RtSourceDataWorker::normalizeAndTransformToColor(const VectorXf& vecData,
+void RtSourceDataWorker::createColorLut(QRgb (*functionHandlerColorMap)(double v),
+                                        MatrixX3f& matColorLut)
+{
+    matColorLut.resize(COLOR_LUT_SIZE, 3);
+
+    for(int i = 0; i < COLOR_LUT_SIZE; ++i) {
+        const QRgb qRgb = functionHandlerColorMap(double(i) / double(COLOR_LUT_SIZE - 1));
+
+        matColorLut(i,0) = (float)qRed(qRgb)/255.0f;
+        matColorLut(i,1) = (float)qGreen(qRgb)/255.0f;
+        matColorLut(i,2) = (float)qBlue(qRgb)/255.0f;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtSourceDataWorker::normalizeAndTransformToColor(const MatrixXf& matData,
+                                                      int iFrame,
                                                       MatrixX3f& matFinalVertColor,
                                                       double dThresholdX,
                                                       double dThresholdZ,
-                                                      QRgb (*functionHandlerColorMap)(double v))
+                                                      const MatrixX3f& matColorLut)
 {
     //Note: This function needs to be implemented extremly efficient.
-    if(vecData.rows() != matFinalVertColor.rows()) {
-        qDebug() << "RtSourceDataWorker::normalizeAndTransformToColor - Sizes of input data (" << vecData.rows() <<") do not match output data ("<< matFinalVertColor.rows() <<"). Returning ...";
+    if(matData.rows() != matFinalVertColor.rows() || iFrame < 0 || iFrame >= matData.cols()) {
+        qDebug() << "RtSourceDataWorker::normalizeAndTransformToColor - Sizes of input data (" << matData.rows() <<") do not match output data ("<< matFinalVertColor.rows() <<"). Returning ...";
+        return;
+    }
+
+    if(matColorLut.rows() == 0) {
         return;
     }
 
-    float fSample;
-    QRgb qRgb;
     const double dTresholdDiff = dThresholdZ - dThresholdX;
+    const float fScale = dTresholdDiff != 0.0 ? float((matColorLut.rows() - 1) / dTresholdDiff) : 0.0f;
+    const float fThresholdX = dThresholdX;
+    const float fThresholdZ = dThresholdZ;
+    const int iMaxIndex = matColorLut.rows() - 1;
 
-    for(int r = 0; r < vecData.rows(); ++r) {
-        //Take the absolute values because the histogram threshold is also calcualted using the absolute values
-        fSample = std::fabs(vecData(r));
-
-        if(fSample >= dThresholdX) {
-            //Check lower and upper thresholds and normalize to one
-            if(fSample >= dThresholdZ) {
-                fSample = 1.0f;
-            } else {
-                if(fSample != 0.0f && dTresholdDiff != 0.0 ) {
-                    fSample = (fSample - dThresholdX) / (dTresholdDiff);
-                } else {
-                    fSample = 0.0f;
-                }
-            }
+    //Take the absolute values because the histogram threshold is also calcualted using the absolute values
+    const ArrayXf arrSamples = matData.col(iFrame).array().abs();
+
+    //Normalize to the look up table range in one vectorized pass, values above the upper threshold are mapped to the last entry
+    const ArrayXi arrIndex = ((arrSamples - fThresholdX) * fScale + 0.5f).max(0.0f).min(float(iMaxIndex)).cast<int>();
 
-            qRgb = functionHandlerColorMap(fSample);
+    for(int r = 0; r < arrSamples.rows(); ++r) {
+        const float fSample = arrSamples(r);
 
-            matFinalVertColor(r,0) = (float)qRed(qRgb)/255.0f;
-            matFinalVertColor(r,1) = (float)qGreen(qRgb)/255.0f;
-            matFinalVertColor(r,2) = (float)qBlue(qRgb)/255.0f;
+        if(fSample >= fThresholdX) {
+            const int iIndex = fSample >= fThresholdZ ? iMaxIndex : arrIndex(r);
+            matFinalVertColor.row(r) = matColorLut.row(iIndex);
         }
     }
 }
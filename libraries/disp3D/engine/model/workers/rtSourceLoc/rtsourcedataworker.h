@@ -54,6 +54,7 @@
 #include <QRgb>
 #include <QSharedPointer>
 #include <QLinkedList>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -61,6 +62,7 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Core>
 #include <Eigen/SparseCore>
 
 
@@ -82,9 +84,13 @@ struct VisualizationInfo {
     double                      dThresholdX;
     double                      dThresholdZ;
 
-    Eigen::VectorXd             vecSensorValues;
+    Eigen::MatrixXf             matSensorValues;                                    /**< The source values of the current batch <n_sources x n_frames>. */
+    Eigen::MatrixXf             matInterpolatedValues;                              /**< The interpolated values of the current batch <n_vertices x n_frames>. */
+    int                         iCurrentFrame;                                      /**< The frame of the current batch which is to be converted to colors. */
+
     Eigen::MatrixX3f            matOriginalVertColor;
     Eigen::MatrixX3f            matFinalVertColor;
+    Eigen::MatrixX3f            matColorLut;                                        /**< The sampled color map <n_entries x 3>. */
 
     QSharedPointer<Eigen::SparseMatrix<float> >  pMatInterpolationMatrix;         /**< The interpolation matrix. */
 
@@ -200,6 +206,15 @@ public:
     */
     void setSFreq(const double dSFreq);
 
+    //=========================================================================================================
+    /**
+    * Set the time interval in which streamData is called. The interval is used to compute how many samples are due
+    * if a call was delayed, e.g., because the color computation took longer than one interval.
+    *
+    * @param[in] iMSec                  The new time interval in milli seconds.
+    */
+    void setTimeInterval(int iMSec);
+
     //=========================================================================================================
     /**
     * Set the interpolation matrix for the left hemisphere.
@@ -218,48 +233,114 @@ public:
 
     //=========================================================================================================
     /**
-    * Streams the data.
+    * Streams the data. The playback position advances by the number of samples which are due since the last call.
+    * If more than one frame became due, only the latest one is shown and the others are dropped.
     */
     void streamData();
 
 protected:
     //=========================================================================================================
     /**
-    * @brief normalizeAndTransformToColor  This method normalizes final values for all vertices of the mesh and converts them to rgb using the specified color converter
+    * Returns the number of samples which are due since the last call to streamData. This is at least one.
+    * Reimplement to drive the playback by another clock.
+    *
+    * @return The number of due samples.
+    */
+    virtual int samplesDue();
+
+    //=========================================================================================================
+    /**
+    * Averages the samples of one frame.
+    *
+    * @param[in] matData        The data to take the samples from. Column indices are taken modulo the number of columns.
+    * @param[in] iStart         The first column of the frame.
+    * @param[in] iNumAvr        The number of samples per frame.
+    *
+    * @return The averaged frame.
+    */
+    static Eigen::VectorXd frameAverage(const Eigen::MatrixXd& matData,
+                                        int iStart,
+                                        int iNumAvr);
+
+    //=========================================================================================================
+    /**
+    * Computes the interpolated values for a batch of consecutive frames, starting with the frame at iStart.
     *
-    * @param[in] vecData                       The final values for each vertex of the surface
+    * @param[in] bFromLoop      Whether to take the frames from the loop data or from the data queue.
+    * @param[in] iStart         The first column of the first frame.
+    * @param[in] iNumAvr        The number of samples per frame.
+    */
+    void computeBatch(bool bFromLoop,
+                      int iStart,
+                      int iNumAvr);
+
+    //=========================================================================================================
+    /**
+    * @brief interpolateBatch                   Interpolates all frames of the current batch with one sparse x dense matrix product
+    *
+    * @param[in/out] visualizationInfoHemi      The needed visualization info
+    */
+    static void interpolateBatch(VisualizationInfo &visualizationInfoHemi);
+
+    //=========================================================================================================
+    /**
+    * @brief createColorLut                 Samples the color map function into a look up table
+    *
+    * @param[in] functionHandlerColorMap    The pointer to the function which converts scalar values to rgb
+    * @param[out] matColorLut               The look up table holding one normalized rgb triplet per row
+    */
+    static void createColorLut(QRgb (*functionHandlerColorMap)(double v),
+                               Eigen::MatrixX3f& matColorLut);
+
+    //=========================================================================================================
+    /**
+    * @brief normalizeAndTransformToColor  This method normalizes final values for all vertices of the mesh and converts them to rgb using the color look up table
+    *
+    * @param[in] matData                       The final values for each vertex of the surface <n_vertices x n_frames>
+    * @param[in] iFrame                        The column of matData to convert
     * @param[in,out] matFinalVertColor         The color matrix which the results are to be written to
     * @param[in] dThresholdX                   Lower threshold for normalizing
-    * @param[in] dThresholdZ                    Upper threshold for normalizing
-    * @param[in] functionHandlerColorMap       The pointer to the function which converts scalar values to rgb
+    * @param[in] dThresholdZ                   Upper threshold for normalizing
+    * @param[in] matColorLut                   The look up table holding one normalized rgb triplet per row
     */
-    static void normalizeAndTransformToColor(const Eigen::VectorXf& vecData,
-                                      Eigen::MatrixX3f& matFinalVertColor,
-                                      double dThresholdX,
-                                      double dThresholdZ,
-                                      QRgb (*functionHandlerColorMap)(double v));
+    static void normalizeAndTransformToColor(const Eigen::MatrixXf& matData,
+                                             int iFrame,
+                                             Eigen::MatrixX3f& matFinalVertColor,
+                                             double dThresholdX,
+                                             double dThresholdZ,
+                                             const Eigen::MatrixX3f& matColorLut);
 
     //=========================================================================================================
     /**
-    * @brief generateColorsFromSensorValues     Produces the final color matrix that is to be emitted
+    * @brief generateColorsFromSensorValues     Produces the final color matrix of the current frame that is to be emitted
     *
     * @param[in/out] visualizationInfoHemi      The needed visualization info
     */
     static void generateColorsFromSensorValues(VisualizationInfo &visualizationInfoHemi);
 
-    QList<Eigen::VectorXd>                              m_lDataQ;                           /**< List that holds the matrix data <n_channels x n_samples>. */
-    QList<Eigen::VectorXd>                              m_lDataLoopQ;                       /**< List that holds the matrix data <n_channels x n_samples> for looping. */
-    Eigen::VectorXd                                     m_vecAverage;                       /**< The averaged data to be streamed. */
+    Eigen::MatrixXd                                     m_matDataQ;                         /**< Matrix that holds the queued data <n_channels x n_samples>. */
+    Eigen::MatrixXd                                     m_matDataLoopQ;                     /**< Matrix that holds the data <n_channels x n_samples> for looping. */
 
     bool                                                m_bIsLooping;                       /**< Flag if this thread should repeat sending the same data over and over again. */
     bool                                                m_bStreamSmoothedData;              /**< Flag if this thread's streams the raw or already smoothed data. Latter are produced by multiplying the smoothing operator here in this thread. */
+    bool                                                m_bStreamFromLoop;                  /**< Flag whether the last streamed samples were taken from the loop data. */
+    bool                                                m_bBatchIsValid;                    /**< Flag whether the interpolated values of the current batch can be used. */
+    bool                                                m_bBatchFromLoop;                   /**< Flag whether the current batch was taken from the loop data. */
 
-    int                                                 m_iCurrentSample;                   /**< Iterator to current sample which is/was streamed. */
+    int                                                 m_iDataQPos;                        /**< Column of the next sample to be streamed from m_matDataQ. */
+    int                                                 m_iLoopPos;                         /**< Column of the next sample to be streamed from m_matDataLoopQ. */
     int                                                 m_iAverageSamples;                  /**< Number of average to compute. */
-    int                                                 m_iSampleCtr;                       /**< The sample counter. */
+    int                                                 m_iSampleCtr;                       /**< The number of samples streamed for the current frame. */
+    int                                                 m_iMSecInterval;                    /**< The time interval in which streamData is called. */
+    int                                                 m_iBatchStart;                      /**< First column of the first frame of the current batch. */
+    int                                                 m_iBatchFrames;                     /**< Number of frames in the current batch. */
+    int                                                 m_iBatchAverages;                   /**< Number of samples per frame in the current batch. */
+    int                                                 m_iBatchSize;                       /**< Maximum number of frames to interpolate at once. */
 
     double                                              m_dSFreq;                           /**< The current sampling frequency. */
 
+    QElapsedTimer                                       m_playbackTimer;                    /**< Measures the time between two calls to streamData. */
+
     QList<VisualizationInfo>                            m_lHemiVisualizationInfo;           /**< The visualization info for each hemisphere. */
 
 signals:
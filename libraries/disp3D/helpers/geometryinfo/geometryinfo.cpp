@@ -52,6 +52,8 @@
 #include <cmath>
 #include <fstream>
 #include <set>
+#include <queue>
+#include <functional>
 
 
 //*************************************************************************************************************
@@ -60,6 +62,9 @@
 //=============================================================================================================
 
 #include <QtConcurrent/QtConcurrent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -155,102 +160,120 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
 
 //*************************************************************************************************************
 
-QVector<qint32> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
-                                             const QVector<Vector3f> &vecSensorPositions)
+QSharedPointer<SparseMatrix<double, RowMajor> > GeometryInfo::scdcSparse(const MatrixX3f &matVertices,
+                                                                         const QVector<QVector<int> > &vecNeighborVertices,
+                                                                         QVector<qint32> &vecVertSubset,
+                                                                         double dCancelDist)
 {
-    QVector<qint32> vecOutputArray;
+    // check for empty subset:
+    if(vecVertSubset.empty()) {
+        // caller passed an empty subset, need to fill in all vertex IDs
+        qDebug() << "[WARNING] SCDC received empty subset, calculating distances for all vertices.";
+        vecVertSubset.reserve(matVertices.rows());
+        for(qint32 id = 0; id < matVertices.rows(); ++id) {
+            vecVertSubset.push_back(id);
+        }
+    }
 
-    qint32 iCores = QThread::idealThreadCount();
-    if (iCores <= 0)
-    {
+    // distribute calculation on cores
+    int iCores = QThread::idealThreadCount();
+    if (iCores <= 0) {
         // assume that we have at least two available cores
         iCores = 2;
     }
 
-    const qint32 iSubArraySize = ceil(vecSensorPositions.size() / iCores);
-
-    //small input size no threads needed
-    if(iSubArraySize <= 1)
-    {
-        vecOutputArray.append(nearestNeighbor(matVertices,
-                                              vecSensorPositions.constBegin(),
-                                              vecSensorPositions.constEnd()));
-        return vecOutputArray;
-    }
-    // split input array + thread start
-    QVector<QFuture<QVector<qint32> > > vecThreads(iCores - 1);
-    qint32 iBeginOffset = iSubArraySize;
-    qint32 iEndOffset = iBeginOffset + iSubArraySize;
-    for(qint32 i = 0; i < vecThreads.size(); ++i)
-    {
-        //last round
-        if(i == vecThreads.size() -1)
-        {
-            vecThreads[i] = QtConcurrent::run(nearestNeighbor,
-                                              matVertices,
-                                              vecSensorPositions.constBegin() + iBeginOffset,
-                                              vecSensorPositions.constEnd());
-            break;
-        }
-        else
-        {
-            vecThreads[i] = QtConcurrent::run(nearestNeighbor,
-                                              matVertices,
-                                              vecSensorPositions.constBegin() + iBeginOffset,
-                                              vecSensorPositions.constBegin() + iEndOffset);
-            iBeginOffset = iEndOffset;
-            iEndOffset += iSubArraySize;
-        }
+    // each thread collects the entries of its part of the subset
+    qint32 iSubArraySize = (vecVertSubset.size() + iCores - 1) / iCores;
+    QVector<std::vector<Triplet<double> > > vecThreadTriplets(iCores);
+    QVector<QFuture<void> > vecThreads;
+    qint32 iBegin = iSubArraySize;
+
+    for (int i = 1; i < iCores && iBegin < vecVertSubset.size(); ++i) {
+        vecThreads.append(QtConcurrent::run(std::bind(boundedDijkstra,
+                                                      std::ref(vecThreadTriplets[i]),
+                                                      std::cref(matVertices),
+                                                      std::cref(vecNeighborVertices),
+                                                      std::cref(vecVertSubset),
+                                                      iBegin,
+                                                      std::min(iBegin + iSubArraySize, qint32(vecVertSubset.size())),
+                                                      dCancelDist)));
+        iBegin += iSubArraySize;
     }
-    //calc while waiting for other threads
-    vecOutputArray.append(nearestNeighbor(matVertices,
-                                          vecSensorPositions.constBegin(),
-                                          vecSensorPositions.constBegin() + iSubArraySize));
 
-    //wait for threads to finish
-    for (QFuture<QVector<qint32> >& f : vecThreads) {
+    // use main thread to calculate first part of the subset
+    boundedDijkstra(vecThreadTriplets[0],
+                    matVertices,
+                    vecNeighborVertices,
+                    vecVertSubset,
+                    0,
+                    std::min(iSubArraySize, qint32(vecVertSubset.size())),
+                    dCancelDist);
+
+    // wait for all other threads to finish
+    for (QFuture<void>& f : vecThreads) {
         f.waitForFinished();
     }
 
-    //move sub arrays back into output
-    for(qint32 i = 0; i < vecThreads.size(); ++i)
-    {
-        vecOutputArray.append(std::move(vecThreads[i].result()));
+    // convention: first dimension in distance table is "from", second dimension "to"
+    std::vector<Triplet<double> > vecTriplets;
+    size_t iNumEntries = 0;
+    for(const std::vector<Triplet<double> >& vecPart : vecThreadTriplets) {
+        iNumEntries += vecPart.size();
+    }
+    vecTriplets.reserve(iNumEntries);
+    for(std::vector<Triplet<double> >& vecPart : vecThreadTriplets) {
+        vecTriplets.insert(vecTriplets.end(), vecPart.begin(), vecPart.end());
+        std::vector<Triplet<double> >().swap(vecPart);
     }
 
-    return vecOutputArray;
+    QSharedPointer<SparseMatrix<double, RowMajor> > returnMat = QSharedPointer<SparseMatrix<double, RowMajor> >::create(matVertices.rows(), vecVertSubset.size());
+    returnMat->setFromTriplets(vecTriplets.begin(), vecTriplets.end());
+
+    return returnMat;
 }
 
 
 //*************************************************************************************************************
 
-QVector<qint32> GeometryInfo::nearestNeighbor(const MatrixX3f &matVertices,
-                                              QVector<Vector3f>::const_iterator itSensorBegin,
-                                              QVector<Vector3f>::const_iterator itSensorEnd)
+QVector<qint32> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
+                                             const QVector<Vector3f> &vecSensorPositions)
 {
-    ///lin search sensor positions
-    QVector<qint32> vecMappedSensors;
-    vecMappedSensors.reserve(std::distance(itSensorBegin, itSensorEnd));
-
-    for(auto sensor = itSensorBegin; sensor != itSensorEnd; ++sensor)
-    {
-        qint32 iChampionId;
-        double iChampDist = std::numeric_limits<double>::max();
-        for(qint32 i = 0; i < matVertices.rows(); ++i)
-        {
-            //calculate 3d euclidian distance
-            double dDist = sqrt(squared(matVertices(i, 0) - (*sensor)[0])  // x-cord
-                    + squared(matVertices(i, 1) - (*sensor)[1])    // y-cord
-                    + squared(matVertices(i, 2) - (*sensor)[2]));  // z-cord
-            if(dDist < iChampDist)
-            {
-                iChampionId = i;
-                iChampDist = dDist;
-            }
+    if(vecSensorPositions.isEmpty()) {
+        return QVector<qint32>();
+    }
+
+    return vertexIndex(matVertices)->nearestNeighbors(vecSensorPositions);
+}
+
+
+//*************************************************************************************************************
+
+VertexKdTree::ConstSPtr GeometryInfo::vertexIndex(const MatrixX3f &matVertices)
+{
+    // number of surfaces whose trees are kept, e.g. both hemispheres plus the sensor surfaces
+    const int iMaxCachedTrees = 4;
+
+    static QMutex mutex;
+    static QList<VertexKdTree::ConstSPtr> lCachedTrees;
+
+    QMutexLocker locker(&mutex);
+
+    for(int i = 0; i < lCachedTrees.size(); ++i) {
+        if(lCachedTrees.at(i)->matches(matVertices)) {
+            // move to the front of the list, i.e. mark as most recently used
+            lCachedTrees.move(i, 0);
+            return lCachedTrees.first();
         }
-        vecMappedSensors.push_back(iChampionId);
     }
-    return vecMappedSensors;
+
+    VertexKdTree::ConstSPtr pTree(new VertexKdTree(matVertices));
+
+    lCachedTrees.prepend(pTree);
+    if(lCachedTrees.size() > iMaxCachedTrees) {
+        lCachedTrees.removeLast();
+    }
+
+    return pTree;
 }
 
 
@@ -319,6 +342,76 @@ void GeometryInfo::iterativeDijkstra(QSharedPointer<MatrixXd> matOutputDistMatri
 }
 
 
+//*************************************************************************************************************
+
+void GeometryInfo::boundedDijkstra(std::vector<Triplet<double> > &vecTriplets,
+                                   const MatrixX3f &matVertices,
+                                   const QVector<QVector<int> > &vecNeighborVertices,
+                                   const QVector<qint32> &vecVertSubset,
+                                   qint32 iBegin,
+                                   qint32 iEnd,
+                                   double dCancelDistance) {
+    // scratch buffers, reused for all roots of this call
+    typedef std::pair<double, qint32> QueueEntry;
+    const double INF = FLOAT_INFINITY;
+    std::vector<double> vecMinDists(vecNeighborVertices.size(), INF);
+    std::vector<qint32> vecVisited;
+    std::vector<QueueEntry> vecQueueStorage;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > vertexQ(std::greater<QueueEntry>(), std::move(vecQueueStorage));
+
+    for (qint32 i = iBegin; i < iEnd; ++i) {
+        const qint32 iRoot = vecVertSubset.at(i);
+        vecMinDists[iRoot] = 0.0;
+        vecVisited.push_back(iRoot);
+        vertexQ.push(QueueEntry(0.0, iRoot));
+
+        // dijkstra main loop, outdated queue entries are skipped instead of removed (lazy deletion)
+        while (!vertexQ.empty()) {
+            const double dDist = vertexQ.top().first;
+            const qint32 u = vertexQ.top().second;
+            vertexQ.pop();
+
+            if (dDist > vecMinDists[u]) {
+                continue;
+            }
+
+            // vertices beyond the cancel distance are neither stored nor expanded
+            if (dDist > dCancelDistance) {
+                continue;
+            }
+
+            vecTriplets.push_back(Triplet<double>(u, i, dDist));
+
+            // visit each neighbour of u
+            const QVector<int>& vecNeighbours = vecNeighborVertices[u];
+
+            for (qint32 ne = 0; ne < vecNeighbours.length(); ++ne) {
+                const qint32 v = vecNeighbours[ne];
+
+                const double dDistX = matVertices(u, 0) - matVertices(v, 0);
+                const double dDistY = matVertices(u, 1) - matVertices(v, 1);
+                const double dDistZ = matVertices(u, 2) - matVertices(v, 2);
+                const double dDistWithU = dDist + sqrt(dDistX * dDistX + dDistY * dDistY + dDistZ * dDistZ);
+
+                if (dDistWithU < vecMinDists[v] && dDistWithU <= dCancelDistance) {
+                    if (vecMinDists[v] == INF) {
+                        vecVisited.push_back(v);
+                    }
+                    vecMinDists[v] = dDistWithU;
+                    vertexQ.push(QueueEntry(dDistWithU, v));
+                }
+            }
+        }
+
+        // only reset the entries which were touched by this run
+        for (qint32 v : vecVisited) {
+            vecMinDists[v] = INF;
+        }
+        vecVisited.clear();
+    }
+}
+
+
 //*************************************************************************************************************
 
 QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::MatrixXd> matDistanceTable,
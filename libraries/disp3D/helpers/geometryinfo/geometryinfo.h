@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../../disp3D_global.h"
+#include "vertexkdtree.h"
 #include <fiff/fiff_evoked.h>
 
 
@@ -51,6 +52,7 @@
 //=============================================================================================================
 
 #include <limits>
+#include <vector>
 
 
 //*************************************************************************************************************
@@ -68,6 +70,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 
 //*************************************************************************************************************
@@ -138,7 +141,25 @@ public:
 
     //=========================================================================================================
     /**
-    * @brief                            Calculates the nearest neighbor (euclidian distance) vertex to each sensor
+    * @brief scdcSparse                     Calculates surface constrained distances on a mesh and only keeps the distances within the cancel distance.
+    *                                       Each Dijkstra run stops as soon as the cancel distance is exceeded, so the computation time and memory
+    *                                       consumption are proportional to the size of the neighborhoods instead of the size of the mesh.
+    *
+    * @param[in] matVertices                The surface on which distances should be calculated.
+    * @param[in] vecNeighborVertices        The neighbor vertex information.
+    * @param[in/out] pVecVertSubset         The subset of IDs for which the distances should be calculated.
+    * @param[in] dCancelDist                Distances higher than this are not stored.
+    *
+    * @return                               A row major (CSR) sparse matrix. Row i holds the distances of vertex i to the vertices of the passed subset, missing entries represent infinity.
+    */
+    static QSharedPointer<Eigen::SparseMatrix<double, Eigen::RowMajor> > scdcSparse(const Eigen::MatrixX3f &matVertices,
+                                                                                    const QVector<QVector<int> > &vecNeighborVertices,
+                                                                                    QVector<qint32> &pVecVertSubset,
+                                                                                    double dCancelDist = FLOAT_INFINITY);
+
+    //=========================================================================================================
+    /**
+    * @brief                            Calculates the nearest neighbor (euclidian distance) vertex to each sensor. Uses the cached spatial index of the surface (see vertexIndex).
     *
     * @param[in] matVertices            Holds all vertex information that is needed.
     * @param[in] vecSensorPositions     Each sensor postion in saved in an Eigen vector with x, y & z coord.
@@ -148,6 +169,17 @@ public:
     static QVector<qint32> projectSensors(const Eigen::MatrixX3f &matVertices,
                                           const QVector<Eigen::Vector3f> &vecSensorPositions);
 
+    //=========================================================================================================
+    /**
+    * @brief vertexIndex                Returns a k-d tree over the passed vertices for nearest neighbor, k-nearest neighbor and radius queries.
+    *                                   The trees of the most recently used surfaces are cached, i.e. the tree is only built once per surface.
+    *
+    * @param[in] matVertices            The surface vertices.
+    *
+    * @return                           The spatial index of the surface.
+    */
+    static VertexKdTree::ConstSPtr vertexIndex(const Eigen::MatrixX3f &matVertices);
+
     //=========================================================================================================
     /**
     * @brief filterBadChannels          Filters bad channels from distance table
@@ -173,20 +205,6 @@ protected:
     */
     static inline  double squared(double dBase);
 
-    //=========================================================================================================
-    /**
-    * @brief nearestNeighbor        Calculates the nearest vertex of an MNEmatVertices for each position between the two iterators
-    *
-    * @param[in] matVertices        The MNEmatVertices that holds the vertex information
-    * @param[in] itSensorBegin      The iterator that indicates the start of the wanted section of positions
-    * @param[in] itSensorEnd        The iterator that indicates the end of the wanted section of positions
-    *
-    * @return                       A vector of nearest vertex IDs that corresponds to the subvector between the two iterators
-    */
-    static QVector<qint32> nearestNeighbor(const Eigen::MatrixX3f &matVertices,
-                                           QVector<Eigen::Vector3f>::const_iterator itSensorBegin,
-                                           QVector<Eigen::Vector3f>::const_iterator itSensorEnd);
-
     //=========================================================================================================
     /**
     * @brief iterativeDijkstra     Calculates shortest distances on the mesh that is held by the MNEmatVertices for each vertex of the passed vector that lies between the two indices
@@ -206,6 +224,28 @@ protected:
                                   qint32 iBegin,
                                   qint32 iEnd,
                                   double dCancelDistance);
+
+    //=========================================================================================================
+    /**
+    * @brief boundedDijkstra           Calculates shortest distances on the mesh for each vertex of the passed subset that lies between the two indices.
+    *                                  Only the vertices within the cancel distance are visited. The scratch buffers are allocated once per call
+    *                                  and only the visited entries are reset after each run.
+    *
+    * @param[out] vecTriplets          The (vertex, subset index, distance) entries within the cancel distance.
+    * @param[in] matVertices           The surface on which distances should be calculated
+    * @param[in] vecNeighborVertices   The neighbor vertex information.
+    * @param[in] vecVertSubset         The subset of vertices
+    * @param[in] iBegin                Start index of distance calculation
+    * @param[in] iEnd                  End index of distance calculation, exclusive
+    * @param[in] dCancelDistance       Distance threshold: vertices that have a higher distance to the respective root vertex are not stored
+    */
+    static void boundedDijkstra(std::vector<Eigen::Triplet<double> > &vecTriplets,
+                                const Eigen::MatrixX3f &matVertices,
+                                const QVector<QVector<int> > &vecNeighborVertices,
+                                const QVector<qint32> &vecVertSubset,
+                                qint32 iBegin,
+                                qint32 iEnd,
+                                double dCancelDistance);
 };
 
 
@@ -0,0 +1,392 @@
+//=============================================================================================================
+/**
+* @file     vertexkdtree.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    VertexKdTree class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "vertexkdtree.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* Runs a query for each of the passed positions. The positions are split into one block per core.
+*
+* @param[in] vecPoints      The query positions.
+* @param[in] query          The query to run for each position.
+*
+* @return The query results, in the order of the query positions.
+*/
+template<typename T, typename Query>
+QVector<T> runBatched(const QVector<Vector3f> &vecPoints, const Query &query)
+{
+    QVector<T> vecResult(vecPoints.size());
+    T* pResult = vecResult.data();
+
+    int iCores = QThread::idealThreadCount();
+    if (iCores <= 0) {
+        // assume that we have at least two available cores
+        iCores = 2;
+    }
+
+    const qint32 iSubArraySize = (vecPoints.size() + iCores - 1) / iCores;
+
+    // small input size no threads needed
+    if(iSubArraySize <= 1) {
+        for(qint32 i = 0; i < vecPoints.size(); ++i) {
+            pResult[i] = query(vecPoints.at(i));
+        }
+        return vecResult;
+    }
+
+    auto queryRange = [&vecPoints, &query, pResult](qint32 iBegin, qint32 iEnd) {
+        for(qint32 i = iBegin; i < iEnd; ++i) {
+            pResult[i] = query(vecPoints.at(i));
+        }
+    };
+
+    QVector<QFuture<void> > vecThreads;
+    for(qint32 iBegin = iSubArraySize; iBegin < vecPoints.size(); iBegin += iSubArraySize) {
+        vecThreads.append(QtConcurrent::run(queryRange, iBegin, std::min(iBegin + iSubArraySize, qint32(vecPoints.size()))));
+    }
+
+    // calc while waiting for other threads
+    queryRange(0, iSubArraySize);
+
+    for (QFuture<void>& f : vecThreads) {
+        f.waitForFinished();
+    }
+
+    return vecResult;
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+VertexKdTree::VertexKdTree(const MatrixX3f &matVertices)
+: m_vecIds(static_cast<int>(matVertices.rows()))
+, m_vecSplitDims(static_cast<int>(matVertices.rows()), 0)
+{
+    for(qint32 i = 0; i < m_vecIds.size(); ++i) {
+        m_vecIds[i] = i;
+    }
+
+    build(matVertices, 0, m_vecIds.size());
+
+    // store the positions in tree order, so that each subrange is contiguous in memory
+    m_matPoints.resize(m_vecIds.size(), 3);
+    for(qint32 i = 0; i < m_vecIds.size(); ++i) {
+        m_matPoints.row(i) = matVertices.row(m_vecIds[i]);
+    }
+}
+
+
+//*************************************************************************************************************
+
+qint32 VertexKdTree::size() const
+{
+    return m_vecIds.size();
+}
+
+
+//*************************************************************************************************************
+
+bool VertexKdTree::matches(const MatrixX3f &matVertices) const
+{
+    if(matVertices.rows() != m_vecIds.size()) {
+        return false;
+    }
+
+    for(qint32 i = 0; i < m_vecIds.size(); ++i) {
+        if(m_matPoints.row(i) != matVertices.row(m_vecIds[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint32 VertexKdTree::nearestNeighbor(const Vector3f &vecPoint) const
+{
+    QVector<qint32> vecNearest = kNearestNeighbors(vecPoint, 1);
+
+    return vecNearest.isEmpty() ? -1 : vecNearest.first();
+}
+
+
+//*************************************************************************************************************
+
+QVector<qint32> VertexKdTree::kNearestNeighbors(const Vector3f &vecPoint,
+                                                qint32 k) const
+{
+    QVector<qint32> vecResult;
+
+    if(k <= 0 || m_vecIds.isEmpty()) {
+        return vecResult;
+    }
+
+    std::vector<Candidate> vecHeap;
+    vecHeap.reserve(k);
+
+    searchKnn(0, m_vecIds.size(), vecPoint, k, vecHeap);
+
+    std::sort_heap(vecHeap.begin(), vecHeap.end());
+
+    vecResult.reserve(static_cast<int>(vecHeap.size()));
+    for(const Candidate& c : vecHeap) {
+        vecResult.push_back(c.second);
+    }
+
+    return vecResult;
+}
+
+
+//*************************************************************************************************************
+
+QVector<qint32> VertexKdTree::radiusSearch(const Vector3f &vecPoint,
+                                           float fRadius) const
+{
+    QVector<qint32> vecResult;
+
+    if(fRadius < 0.0f || m_vecIds.isEmpty()) {
+        return vecResult;
+    }
+
+    searchRadius(0, m_vecIds.size(), vecPoint, fRadius * fRadius, vecResult);
+
+    std::sort(vecResult.begin(), vecResult.end());
+
+    return vecResult;
+}
+
+
+//*************************************************************************************************************
+
+QVector<qint32> VertexKdTree::nearestNeighbors(const QVector<Vector3f> &vecPoints) const
+{
+    return runBatched<qint32>(vecPoints, [this](const Vector3f &vecPoint) {
+        return nearestNeighbor(vecPoint);
+    });
+}
+
+
+//*************************************************************************************************************
+
+QVector<QVector<qint32> > VertexKdTree::kNearestNeighbors(const QVector<Vector3f> &vecPoints,
+                                                          qint32 k) const
+{
+    return runBatched<QVector<qint32> >(vecPoints, [this, k](const Vector3f &vecPoint) {
+        return kNearestNeighbors(vecPoint, k);
+    });
+}
+
+
+//*************************************************************************************************************
+
+QVector<QVector<qint32> > VertexKdTree::radiusSearch(const QVector<Vector3f> &vecPoints,
+                                                     float fRadius) const
+{
+    return runBatched<QVector<qint32> >(vecPoints, [this, fRadius](const Vector3f &vecPoint) {
+        return radiusSearch(vecPoint, fRadius);
+    });
+}
+
+
+//*************************************************************************************************************
+
+void VertexKdTree::build(const MatrixX3f &matVertices,
+                         qint32 iBegin,
+                         qint32 iEnd)
+{
+    if(iEnd - iBegin <= s_iLeafSize) {
+        return;
+    }
+
+    // split along the dimension of the largest extent
+    Vector3f vecMin = Vector3f::Constant(std::numeric_limits<float>::max());
+    Vector3f vecMax = Vector3f::Constant(-std::numeric_limits<float>::max());
+    for(qint32 i = iBegin; i < iEnd; ++i) {
+        vecMin = vecMin.cwiseMin(matVertices.row(m_vecIds[i]).transpose());
+        vecMax = vecMax.cwiseMax(matVertices.row(m_vecIds[i]).transpose());
+    }
+
+    int iDim;
+    (vecMax - vecMin).maxCoeff(&iDim);
+
+    const qint32 iMid = iBegin + (iEnd - iBegin) / 2;
+    std::nth_element(m_vecIds.begin() + iBegin,
+                     m_vecIds.begin() + iMid,
+                     m_vecIds.begin() + iEnd,
+                     [&matVertices, iDim](qint32 a, qint32 b) {
+                         return matVertices(a, iDim) < matVertices(b, iDim);
+                     });
+
+    m_vecSplitDims[iMid] = static_cast<qint8>(iDim);
+
+    build(matVertices, iBegin, iMid);
+    build(matVertices, iMid + 1, iEnd);
+}
+
+
+//*************************************************************************************************************
+
+void VertexKdTree::searchKnn(qint32 iBegin,
+                             qint32 iEnd,
+                             const Vector3f &vecPoint,
+                             qint32 k,
+                             std::vector<Candidate> &vecHeap) const
+{
+    auto consider = [&](qint32 iNode) {
+        const Candidate candidate(squaredDistance(iNode, vecPoint), m_vecIds[iNode]);
+
+        if(static_cast<qint32>(vecHeap.size()) < k) {
+            vecHeap.push_back(candidate);
+            std::push_heap(vecHeap.begin(), vecHeap.end());
+        } else if(candidate < vecHeap.front()) {
+            std::pop_heap(vecHeap.begin(), vecHeap.end());
+            vecHeap.back() = candidate;
+            std::push_heap(vecHeap.begin(), vecHeap.end());
+        }
+    };
+
+    if(iEnd - iBegin <= s_iLeafSize) {
+        for(qint32 i = iBegin; i < iEnd; ++i) {
+            consider(i);
+        }
+        return;
+    }
+
+    const qint32 iMid = iBegin + (iEnd - iBegin) / 2;
+    const int iDim = m_vecSplitDims[iMid];
+    const float fDiff = vecPoint[iDim] - m_matPoints(iMid, iDim);
+
+    consider(iMid);
+
+    // descend into the half containing the query first
+    if(fDiff < 0.0f) {
+        searchKnn(iBegin, iMid, vecPoint, k, vecHeap);
+        if(static_cast<qint32>(vecHeap.size()) < k || fDiff * fDiff <= vecHeap.front().first) {
+            searchKnn(iMid + 1, iEnd, vecPoint, k, vecHeap);
+        }
+    } else {
+        searchKnn(iMid + 1, iEnd, vecPoint, k, vecHeap);
+        if(static_cast<qint32>(vecHeap.size()) < k || fDiff * fDiff <= vecHeap.front().first) {
+            searchKnn(iBegin, iMid, vecPoint, k, vecHeap);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void VertexKdTree::searchRadius(qint32 iBegin,
+                                qint32 iEnd,
+                                const Vector3f &vecPoint,
+                                float fRadiusSquared,
+                                QVector<qint32> &vecResult) const
+{
+    if(iEnd - iBegin <= s_iLeafSize) {
+        for(qint32 i = iBegin; i < iEnd; ++i) {
+            if(squaredDistance(i, vecPoint) <= fRadiusSquared) {
+                vecResult.push_back(m_vecIds[i]);
+            }
+        }
+        return;
+    }
+
+    const qint32 iMid = iBegin + (iEnd - iBegin) / 2;
+    const int iDim = m_vecSplitDims[iMid];
+    const float fDiff = vecPoint[iDim] - m_matPoints(iMid, iDim);
+
+    if(squaredDistance(iMid, vecPoint) <= fRadiusSquared) {
+        vecResult.push_back(m_vecIds[iMid]);
+    }
+
+    if(fDiff <= 0.0f || fDiff * fDiff <= fRadiusSquared) {
+        searchRadius(iBegin, iMid, vecPoint, fRadiusSquared, vecResult);
+    }
+    if(fDiff >= 0.0f || fDiff * fDiff <= fRadiusSquared) {
+        searchRadius(iMid + 1, iEnd, vecPoint, fRadiusSquared, vecResult);
+    }
+}
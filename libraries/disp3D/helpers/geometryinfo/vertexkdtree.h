@@ -0,0 +1,282 @@
+//=============================================================================================================
+/**
+* @file     vertexkdtree.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    VertexKdTree class declaration.
+*
+*/
+
+
+#ifndef DISP3DLIB_VERTEXKDTREE_H
+#define DISP3DLIB_VERTEXKDTREE_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../disp3D_global.h"
+
+#include <vector>
+#include <utility>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//=============================================================================================================
+/**
+* The tree is built once from the vertex positions of a surface. The vertices are reordered so that every subrange
+* of the tree is stored contiguously; the split dimension is chosen along the largest extent of each subrange.
+* Queries work on squared euclidian distances. Ties are resolved in favour of the smaller vertex ID, i.e.
+* the results are identical to a linear search over all vertices.
+*
+* @brief k-d tree over the vertices of a surface for nearest neighbor, k-nearest neighbor and radius queries.
+*/
+
+class DISP3DSHARED_EXPORT VertexKdTree
+{
+
+public:
+    typedef QSharedPointer<VertexKdTree> SPtr;            /**< Shared pointer type for VertexKdTree. */
+    typedef QSharedPointer<const VertexKdTree> ConstSPtr; /**< Const shared pointer type for VertexKdTree. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the tree from the passed vertex positions.
+    *
+    * @param[in] matVertices            The vertex positions, one vertex per row.
+    */
+    explicit VertexKdTree(const Eigen::MatrixX3f &matVertices);
+
+    //=========================================================================================================
+    /**
+    * @brief size                       Returns the number of vertices stored in the tree.
+    *
+    * @return                           The number of vertices.
+    */
+    qint32 size() const;
+
+    //=========================================================================================================
+    /**
+    * @brief matches                    Checks whether the tree was built from the passed vertex positions.
+    *
+    * @param[in] matVertices            The vertex positions to compare against.
+    *
+    * @return                           True if the tree holds exactly the passed vertices.
+    */
+    bool matches(const Eigen::MatrixX3f &matVertices) const;
+
+    //=========================================================================================================
+    /**
+    * @brief nearestNeighbor            Finds the vertex closest to a position.
+    *
+    * @param[in] vecPoint               The query position.
+    *
+    * @return                           The ID of the closest vertex, -1 if the tree is empty.
+    */
+    qint32 nearestNeighbor(const Eigen::Vector3f &vecPoint) const;
+
+    //=========================================================================================================
+    /**
+    * @brief kNearestNeighbors          Finds the k vertices closest to a position.
+    *
+    * @param[in] vecPoint               The query position.
+    * @param[in] k                      The number of vertices to find.
+    *
+    * @return                           The IDs of the min(k, size()) closest vertices, sorted by ascending distance.
+    */
+    QVector<qint32> kNearestNeighbors(const Eigen::Vector3f &vecPoint,
+                                      qint32 k) const;
+
+    //=========================================================================================================
+    /**
+    * @brief radiusSearch               Finds all vertices within a radius around a position.
+    *
+    * @param[in] vecPoint               The query position.
+    * @param[in] fRadius                The search radius.
+    *
+    * @return                           The IDs of all vertices with a distance <= fRadius, sorted by ascending ID.
+    */
+    QVector<qint32> radiusSearch(const Eigen::Vector3f &vecPoint,
+                                 float fRadius) const;
+
+    //=========================================================================================================
+    /**
+    * @brief nearestNeighbors           Batch version of nearestNeighbor. The queries are distributed on all available cores.
+    *
+    * @param[in] vecPoints              The query positions.
+    *
+    * @return                           For each query position the ID of the closest vertex.
+    */
+    QVector<qint32> nearestNeighbors(const QVector<Eigen::Vector3f> &vecPoints) const;
+
+    //=========================================================================================================
+    /**
+    * @brief kNearestNeighbors          Batch version of kNearestNeighbors. The queries are distributed on all available cores.
+    *
+    * @param[in] vecPoints              The query positions.
+    * @param[in] k                      The number of vertices to find per query position.
+    *
+    * @return                           For each query position the IDs of the closest vertices, sorted by ascending distance.
+    */
+    QVector<QVector<qint32> > kNearestNeighbors(const QVector<Eigen::Vector3f> &vecPoints,
+                                                qint32 k) const;
+
+    //=========================================================================================================
+    /**
+    * @brief radiusSearch               Batch version of radiusSearch. The queries are distributed on all available cores.
+    *
+    * @param[in] vecPoints              The query positions.
+    * @param[in] fRadius                The search radius.
+    *
+    * @return                           For each query position the IDs of the vertices within the radius, sorted by ascending ID.
+    */
+    QVector<QVector<qint32> > radiusSearch(const QVector<Eigen::Vector3f> &vecPoints,
+                                           float fRadius) const;
+
+private:
+    typedef std::pair<float, qint32> Candidate;     /**< Squared distance and vertex ID of a query candidate. */
+
+    //=========================================================================================================
+    /**
+    * @brief build                      Recursively sorts the subrange [iBegin, iEnd) of m_vecIds into a k-d tree.
+    *
+    * @param[in] matVertices            The vertex positions the tree is built from.
+    * @param[in] iBegin                 Start of the subrange.
+    * @param[in] iEnd                   End of the subrange, exclusive.
+    */
+    void build(const Eigen::MatrixX3f &matVertices,
+               qint32 iBegin,
+               qint32 iEnd);
+
+    //=========================================================================================================
+    /**
+    * @brief searchKnn                  Recursively collects the k closest candidates of the subrange [iBegin, iEnd) in a max-heap.
+    *
+    * @param[in] iBegin                 Start of the subrange.
+    * @param[in] iEnd                   End of the subrange, exclusive.
+    * @param[in] vecPoint               The query position.
+    * @param[in] k                      The number of vertices to find.
+    * @param[in, out] vecHeap           The max-heap of the best candidates found so far.
+    */
+    void searchKnn(qint32 iBegin,
+                   qint32 iEnd,
+                   const Eigen::Vector3f &vecPoint,
+                   qint32 k,
+                   std::vector<Candidate> &vecHeap) const;
+
+    //=========================================================================================================
+    /**
+    * @brief searchRadius               Recursively collects all vertices of the subrange [iBegin, iEnd) within the squared radius.
+    *
+    * @param[in] iBegin                 Start of the subrange.
+    * @param[in] iEnd                   End of the subrange, exclusive.
+    * @param[in] vecPoint               The query position.
+    * @param[in] fRadiusSquared         The squared search radius.
+    * @param[in, out] vecResult         The IDs found so far.
+    */
+    void searchRadius(qint32 iBegin,
+                      qint32 iEnd,
+                      const Eigen::Vector3f &vecPoint,
+                      float fRadiusSquared,
+                      QVector<qint32> &vecResult) const;
+
+    //=========================================================================================================
+    /**
+    * @brief squaredDistance            Squared euclidian distance between a stored vertex and a position.
+    *
+    * @param[in] iNode                  The position of the vertex in the tree order.
+    * @param[in] vecPoint               The query position.
+    *
+    * @return                           The squared distance.
+    */
+    inline float squaredDistance(qint32 iNode,
+                                 const Eigen::Vector3f &vecPoint) const;
+
+    static const qint32     s_iLeafSize = 8;        /**< Subranges of this size or smaller are searched linearly. */
+
+    Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor>    m_matPoints;    /**< The vertex positions in tree order. */
+    QVector<qint32>                                             m_vecIds;       /**< The vertex IDs in tree order. */
+    QVector<qint8>                                              m_vecSplitDims; /**< The split dimension of each inner node, stored at the position of the node's median. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline float VertexKdTree::squaredDistance(qint32 iNode, const Eigen::Vector3f &vecPoint) const
+{
+    const float dX = m_matPoints(iNode, 0) - vecPoint[0];
+    const float dY = m_matPoints(iNode, 1) - vecPoint[1];
+    const float dZ = m_matPoints(iNode, 2) - vecPoint[2];
+    return dX * dX + dY * dY + dZ * dZ;
+}
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_VERTEXKDTREE_H
@@ -150,6 +150,83 @@ QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const
 }
 
 
+//*************************************************************************************************************
+
+QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const QVector<qint32> &vecProjectedSensors,
+                                                                           const QSharedPointer<SparseMatrix<double, RowMajor> > matDistanceTable,
+                                                                           double (*interpolationFunction) (double),
+                                                                           const double dCancelDist,
+                                                                           const QVector<qint32> &vecExcludeIndex)
+{
+    if(matDistanceTable->rows() == 0 && matDistanceTable->cols() == 0) {
+        qDebug() << "[WARNING] Interpolation::createInterpolationMat - received an empty distance table.";
+        return QSharedPointer<SparseMatrix<float> >::create();
+    }
+
+    // initialization
+    QSharedPointer<Eigen::SparseMatrix<float> > matInterpolationMatrix = QSharedPointer<SparseMatrix<float> >::create(matDistanceTable->rows(), vecProjectedSensors.size());
+
+    // temporary helper structure for filling sparse matrix
+    QVector<Triplet<float> > vecNonZeroEntries;
+    vecNonZeroEntries.reserve(matDistanceTable->nonZeros());
+    const qint32 iRows = matInterpolationMatrix->rows();
+
+    // mark excluded columns, e.g. bad channels
+    QVector<bool> vecExcluded(vecProjectedSensors.size(), false);
+    for(const qint32& idx : vecExcludeIndex) {
+        if(idx >= 0 && idx < vecExcluded.size()) {
+            vecExcluded[idx] = true;
+        }
+    }
+
+    // insert all sensor nodes into set for faster lookup during later computation. Also consider bad channels here.
+    QSet<qint32> sensorLookup;
+
+    for(qint32 idx = 0; idx < vecProjectedSensors.size(); ++idx){
+        if(!vecExcluded.at(idx)){
+            sensorLookup.insert(vecProjectedSensors.at(idx));
+        }
+    }
+
+    // main loop: go through all rows of distance table and calculate weights
+    QVector<QPair<qint32, float> > vecBelowThresh;
+
+    for (qint32 r = 0; r < iRows; ++r) {
+        if (sensorLookup.contains(r) == false) {
+            // "normal" node, i.e. one which was not assigned a sensor
+            // only the stored entries of this row can be below the passed distance threshold (dCancelDist)
+            vecBelowThresh.clear();
+            float dWeightsSum = 0.0;
+
+            for (SparseMatrix<double, RowMajor>::InnerIterator it(*matDistanceTable, r); it; ++it) {
+                const qint32 c = it.col();
+                const float dDist = it.value();
+
+                if (!vecExcluded.at(c) && dDist < dCancelDist) {
+                    const float dValueWeight = std::fabs(1.0 / interpolationFunction(dDist));
+                    dWeightsSum += dValueWeight;
+                    vecBelowThresh.push_back(qMakePair<qint32, float> (c, dValueWeight));
+                }
+            }
+
+            for (const QPair<qint32, float> &qp : vecBelowThresh) {
+                vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, qp.first, qp.second / dWeightsSum));
+            }
+        } else {
+            // a sensor has been assigned to this node, we do not need to interpolate anything
+            //(final vertex signal is equal to sensor input signal, thus factor 1)
+            const int iIndexInSubset = vecProjectedSensors.indexOf(r);
+
+            vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, iIndexInSubset, 1));
+        }
+    }
+
+    matInterpolationMatrix->setFromTriplets(vecNonZeroEntries.begin(), vecNonZeroEntries.end());
+
+    return matInterpolationMatrix;
+}
+
+
 //*************************************************************************************************************
 
 VectorXf Interpolation::interpolateSignal(const QSharedPointer<SparseMatrix<float> > matInterpolationMatrix,
@@ -134,6 +134,26 @@ public:
                                                                               const double dCancelDist = FLOAT_INFINITY,
                                                                               const QVector<qint32> &vecExcludeIndex = QVector<qint32>());
 
+    //=========================================================================================================
+    /**
+    * Overloaded version which works on a sparse distance table as it is created by <i>GeometryInfo::scdcSparse</i>.
+    * Missing entries of the distance table are treated as infinite distances. Only the stored entries of each row are visited,
+    * and the columns listed in vecExcludeIndex are skipped, so bad channels do not need to be filtered from the distance table beforehand.
+    *
+    * @param[in] vecProjectedSensors           Vector of IDs of sensor vertices
+    * @param[in] matDistanceTable              Row major sparse matrix that contains all distances within the cancel distance
+    * @param[in] interpolationFunction         Function that computes interpolation coefficients using the distance values
+    * @param[in] dCancelDist                   Distances higher than this are ignored, i.e. the respective coefficients are set to zero
+    * @param[in] vecExcludeIndex               The indices to be excluded from vecProjectedSensors, e.g., bad channels (empty by default)
+    *
+    * @return                                  The distance matrix created
+    */
+    static QSharedPointer<Eigen::SparseMatrix<float> > createInterpolationMat(const QVector<qint32> &vecProjectedSensors,
+                                                                              const QSharedPointer<Eigen::SparseMatrix<double, Eigen::RowMajor> > matDistanceTable,
+                                                                              double (*interpolationFunction) (double),
+                                                                              const double dCancelDist = FLOAT_INFINITY,
+                                                                              const QVector<qint32> &vecExcludeIndex = QVector<qint32>());
+
     //=========================================================================================================
     /**
     * The interpolation essentially corresponds to a matrix * vector multiplication. A vector of sensor data (i.e. a vector of double-values)
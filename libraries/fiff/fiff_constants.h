@@ -434,6 +434,21 @@ namespace FIFFLIB
 */
 #define FIFFB_MNE_RT_MEAS_INFO      3710              /**< Fiff Real-Time Measurement Info */
 
+/*
+* 3720... Clustered forward solution cache
+*/
+#define FIFFB_MNE_CLUSTERED_FWD_CACHE       3720      /**< Cached clustered forward solution */
+#define FIFFB_MNE_CLUSTER_INFO              3721      /**< Cluster information of one hemisphere */
+#define FIFF_MNE_CLUSTER_HASH               3722      /**< Hash of the clustering input */
+#define FIFF_MNE_CLUSTER_VERTNO             3723      /**< Vertex numbers of the clustered hemisphere */
+#define FIFF_MNE_CLUSTER_LABEL_IDS          3724      /**< Label ids of the clusters */
+#define FIFF_MNE_CLUSTER_LABEL_NAMES        3725      /**< Label names of the clusters */
+#define FIFF_MNE_CLUSTER_CENTROID_VERTNO    3726      /**< Vertex numbers of the cluster centroids */
+#define FIFF_MNE_CLUSTER_CENTROID_RR        3727      /**< Locations of the cluster centroids */
+#define FIFF_MNE_CLUSTER_VERTNOS            3728      /**< Vertex numbers belonging to one cluster */
+#define FIFF_MNE_CLUSTER_SOURCE_RR          3729      /**< Source locations belonging to one cluster */
+#define FIFF_MNE_CLUSTER_DISTANCES          3730      /**< Distances to the centroid of one cluster */
+
 /*
 * Fiff values associated with MNE computations
 */
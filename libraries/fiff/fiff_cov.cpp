@@ -52,6 +52,8 @@
 //=============================================================================================================
 
 #include <QPair>
+#include <QHash>
+#include <QSet>
 
 
 //*************************************************************************************************************
@@ -176,8 +178,9 @@ FiffCov FiffCov::pick_channels(const QStringList &p_include, const QStringList &
             res.data(i, j) = this->data(sel(i), sel(j));
     res.projs = this->projs;
 
+    QSet<QString> t_resNames = res.names.toSet();
     for(qint32 k = 0; k < this->bads.size(); ++k)
-        if(res.names.contains(this->bads[k]))
+        if(t_resNames.contains(this->bads[k]))
             res.bads << this->bads[k];
     res.nfree = this->nfree;
 
@@ -191,11 +194,17 @@ FiffCov FiffCov::prepare_noise_cov(const FiffInfo &p_Info, const QStringList &p_
 {
     FiffCov p_NoiseCov(*this);
 
+    //Index of the first occurrence of each name, as QStringList::indexOf would find it
+    QHash<QString, qint32> t_covIndex;
+    t_covIndex.reserve(p_NoiseCov.names.size());
+    for(qint32 i = p_NoiseCov.names.size() - 1; i >= 0; --i)
+        t_covIndex.insert(p_NoiseCov.names[i], i);
+
     VectorXi C_ch_idx = VectorXi::Zero(p_NoiseCov.names.size());
     qint32 count = 0;
     for(qint32 i = 0; i < p_ChNames.size(); ++i)
     {
-        qint32 idx = p_NoiseCov.names.indexOf(p_ChNames[i]);
+        qint32 idx = t_covIndex.value(p_ChNames[i], -1);
         if(idx > -1)
         {
             C_ch_idx[count] = idx;
@@ -233,15 +242,15 @@ FiffCov FiffCov::prepare_noise_cov(const FiffInfo &p_Info, const QStringList &p_
     RowVectorXi pick_meg = p_Info.pick_types(true, false, false, defaultQStringList, p_Info.bads);
     RowVectorXi pick_eeg = p_Info.pick_types(false, true, false, defaultQStringList, p_Info.bads);
 
-    QStringList meg_names, eeg_names;
+    QSet<QString> meg_names, eeg_names;
 
     for(qint32 i = 0; i < pick_meg.size(); ++i)
-        meg_names << p_Info.chs[pick_meg[i]].ch_name;
+        meg_names.insert(p_Info.chs[pick_meg[i]].ch_name);
     VectorXi C_meg_idx = VectorXi::Zero(p_NoiseCov.names.size());
     count = 0;
     for(qint32 k = 0; k < C.rows(); ++k)
     {
-        if(meg_names.indexOf(p_ChNames[k]) > -1)
+        if(meg_names.contains(p_ChNames[k]))
         {
             C_meg_idx[count] = k;
             ++count;
@@ -254,12 +263,12 @@ FiffCov FiffCov::prepare_noise_cov(const FiffInfo &p_Info, const QStringList &p_
 
     //
     for(qint32 i = 0; i < pick_eeg.size(); ++i)
-        eeg_names << p_Info.chs[pick_eeg(0,i)].ch_name;
+        eeg_names.insert(p_Info.chs[pick_eeg(0,i)].ch_name);
     VectorXi C_eeg_idx = VectorXi::Zero(p_NoiseCov.names.size());
     count = 0;
     for(qint32 k = 0; k < C.rows(); ++k)
     {
-        if(eeg_names.indexOf(p_ChNames[k]) > -1)
+        if(eeg_names.contains(p_ChNames[k]))
         {
             C_eeg_idx[count] = k;
             ++count;
@@ -357,13 +366,13 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
     RowVectorXi sel_grad = p_info.pick_types(QString("grad"), false, false, defaultQStringList, p_exclude);
 
     QStringList info_ch_names = p_info.ch_names;
-    QStringList ch_names_eeg, ch_names_mag, ch_names_grad;
+    QSet<QString> ch_names_eeg, ch_names_mag, ch_names_grad;
     for(qint32 i = 0; i < sel_eeg.size(); ++i)
-        ch_names_eeg << info_ch_names[sel_eeg(i)];
+        ch_names_eeg.insert(info_ch_names[sel_eeg(i)]);
     for(qint32 i = 0; i < sel_mag.size(); ++i)
-        ch_names_mag << info_ch_names[sel_mag(i)];
+        ch_names_mag.insert(info_ch_names[sel_mag(i)]);
     for(qint32 i = 0; i < sel_grad.size(); ++i)
-        ch_names_grad << info_ch_names[sel_grad(i)];
+        ch_names_grad.insert(info_ch_names[sel_grad(i)]);
 
     // This actually removes bad channels from the cov, which is not backward
     // compatible, so let's leave all channels in
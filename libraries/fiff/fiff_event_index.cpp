@@ -0,0 +1,542 @@
+//=============================================================================================================
+/**
+* @file     fiff_event_index.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffEventIndex class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_event_index.h"
+#include "fiff_raw_data.h"
+#include "fiff_info.h"
+#include "fiff_stream.h"
+#include "fiff_tag.h"
+#include "fiff_dir_node.h"
+#include "fiff_constants.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Decodes one channel of a raw data buffer in file (big endian) byte order. The other channels are skipped.
+*
+* @param[in] pData      The buffer data, nchan x nsamp in sample major order
+* @param[in] iType      The data type of the buffer
+* @param[in] iNchan     Number of channels in the buffer
+* @param[in] iCh        The channel to decode
+* @param[in] dCal       Calibration of the channel
+* @param[out] vecValues The calibrated values, rounded to integers (nsamp)
+*
+* @return false if the data type is not supported
+*/
+bool decodeChannel(const uchar* pData, fiff_int_t iType, qint32 iNchan, qint32 iCh, double dCal, VectorXi& vecValues)
+{
+    qint32 nsamp = vecValues.size();
+
+    switch(iType) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT: {
+            const uchar* p = pData + iCh*sizeof(qint16);
+            for(qint32 s = 0; s < nsamp; ++s, p += iNchan*sizeof(qint16))
+                vecValues[s] = qRound(qFromBigEndian<qint16>(p)*dCal);
+            return true;
+        }
+        case FIFFT_INT: {
+            const uchar* p = pData + iCh*sizeof(qint32);
+            for(qint32 s = 0; s < nsamp; ++s, p += iNchan*sizeof(qint32))
+                vecValues[s] = qRound(qFromBigEndian<qint32>(p)*dCal);
+            return true;
+        }
+        case FIFFT_FLOAT: {
+            const uchar* p = pData + iCh*sizeof(float);
+            for(qint32 s = 0; s < nsamp; ++s, p += iNchan*sizeof(float)) {
+                quint32 bits = qFromBigEndian<quint32>(p);
+                float value;
+                std::memcpy(&value, &bits, sizeof(float));
+                vecValues[s] = qRound(value*dCal);
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+
+//=============================================================================================================
+/**
+* Size of one sample of one channel for the raw data buffer types.
+*/
+qint32 sampleSize(fiff_int_t iType)
+{
+    switch(iType) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            return sizeof(qint16);
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            return sizeof(qint32);
+        default:
+            return 0;
+    }
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffEventIndex::FiffEventIndex()
+: m_iMask(0)
+, m_iFirstSample(-1)
+, m_iLastSample(-1)
+, m_matEvents(0,3)
+{
+}
+
+
+//*************************************************************************************************************
+
+void FiffEventIndex::clear()
+{
+    m_sTriggerCh.clear();
+    m_iMask = 0;
+    m_iFirstSample = -1;
+    m_iLastSample = -1;
+    m_matEvents.resize(0,3);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventIndex::build(const FiffRawData& raw, const QString& sTriggerCh, fiff_int_t iMask)
+{
+    clear();
+
+    QString sCh = sTriggerCh.isEmpty() ? default_trigger_channel(raw.info) : sTriggerCh;
+    qint32 iCh = raw.info.channel_index(sCh);
+
+    if(iCh < 0) {
+        printf("Trigger channel %s not found in the raw data\n", sCh.toUtf8().constData());
+        return false;
+    }
+
+    if (!raw.file->device()->isOpen()) {
+        if (!raw.file->device()->open(QIODevice::ReadOnly)) {
+            printf("Cannot open file %s\n", raw.info.filename.toUtf8().constData());
+            return false;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint32 nchan = raw.info.nchan;
+    double dCal = iCh < raw.cals.size() ? raw.cals[iCh] : 1.0;
+
+    QVector<fiff_int_t> events;
+    QByteArray data;
+    VectorXi vecValues, vecBefore;
+    fiff_int_t iLast = 0;
+
+    for(qint32 k = 0; k < raw.rawdir.size(); ++k) {
+        const FiffRawDir& thisRawDir = raw.rawdir[k];
+        qint32 nsamp = thisRawDir.nsamp;
+
+        if(nsamp <= 0)
+            continue;
+
+        vecValues.resize(nsamp);
+
+        if(thisRawDir.ent->kind == -1) {
+            //Skips are translated to zeros like in read_raw_segment
+            vecValues.setZero();
+        } else {
+            //Read the buffer as it is stored, only the trigger channel is converted
+            qint32 iSampleSize = sampleSize(thisRawDir.ent->type);
+            qint64 iSize = (qint64)nchan*nsamp*iSampleSize;
+
+            if(iSampleSize == 0) {
+                printf("Data Storage Format not known jet [5]!! Type: %d\n", thisRawDir.ent->type);
+                return false;
+            }
+
+            if(!raw.file->device()->seek(thisRawDir.ent->pos + FIFFC_DATA_OFFSET)) {
+                printf("Cannot seek to raw buffer %d\n", k);
+                return false;
+            }
+
+            data.resize(iSize);
+            if(raw.file->device()->read(data.data(), iSize) != iSize) {
+                printf("Cannot read raw buffer %d\n", k);
+                return false;
+            }
+
+            decodeChannel(reinterpret_cast<const uchar*>(data.constData()), thisRawDir.ent->type, nchan, iCh, dCal, vecValues);
+        }
+
+        if(iMask != 0)
+            vecValues = vecValues.unaryExpr([iMask](int v) { return v & iMask; });
+
+        //
+        //   Vectorised edge detection: compare each sample with its predecessor
+        //
+        vecBefore.resize(nsamp);
+        vecBefore[0] = iLast;
+        vecBefore.tail(nsamp-1) = vecValues.head(nsamp-1);
+
+        Array<bool, Dynamic, 1> changed = vecValues.array() != vecBefore.array();
+        qint32 nChanged = changed.count();
+
+        if(nChanged > 0) {
+            events.reserve(events.size() + 3*nChanged);
+            for(qint32 s = 0; s < nsamp; ++s) {
+                if(changed[s]) {
+                    events.append(thisRawDir.first + s);
+                    events.append(vecBefore[s]);
+                    events.append(vecValues[s]);
+                }
+            }
+        }
+
+        iLast = vecValues[nsamp-1];
+    }
+
+    m_matEvents = Map<const Matrix<fiff_int_t, Dynamic, 3, RowMajor> >(events.constData(), events.size()/3, 3);
+    m_sTriggerCh = sCh;
+    m_iMask = iMask;
+    m_iFirstSample = raw.first_samp;
+    m_iLastSample = raw.last_samp;
+
+    printf("%d trigger changes found on %s in %d buffers (%lld ms)\n", (int)m_matEvents.rows(), sCh.toUtf8().constData(), (int)raw.rawdir.size(), timer.elapsed());
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventIndex::load_or_build(const FiffRawData& raw, const QString& sTriggerCh, fiff_int_t iMask, bool bPersist)
+{
+    QString sCh = sTriggerCh.isEmpty() ? default_trigger_channel(raw.info) : sTriggerCh;
+    QString sFileName = default_file_name(raw.info.filename);
+
+    QFileInfo t_rawInfo(raw.info.filename);
+    QFileInfo t_indexInfo(sFileName);
+
+    //
+    //   Use the stored index if it was made for this raw file, trigger channel and mask
+    //
+    if(!raw.info.filename.isEmpty() && t_indexInfo.exists() && t_indexInfo.lastModified() >= t_rawInfo.lastModified()) {
+        QFile t_file(sFileName);
+        FiffEventIndex t_index;
+
+        if(t_index.read(t_file)
+                && t_index.m_sTriggerCh == sCh
+                && t_index.m_iMask == iMask
+                && t_index.m_iFirstSample == raw.first_samp
+                && t_index.m_iLastSample == raw.last_samp) {
+            *this = t_index;
+            printf("Events read from %s\n", sFileName.toUtf8().constData());
+            return true;
+        }
+    }
+
+    if(!build(raw, sCh, iMask))
+        return false;
+
+    if(bPersist && !raw.info.filename.isEmpty()) {
+        QFile t_file(sFileName);
+        if(write(t_file))
+            printf("Events written to %s\n", sFileName.toUtf8().constData());
+        else
+            printf("Could not write the events to %s\n", sFileName.toUtf8().constData());
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventIndex::read(QIODevice& p_IODevice)
+{
+    clear();
+
+    FiffStream::SPtr t_pStream(new FiffStream(&p_IODevice));
+
+    if(!t_pStream->open())
+        return false;
+
+    QList<FiffDirNode::SPtr> blocks = t_pStream->dirtree()->dir_tree_find(FIFFB_MNE_EVENTS);
+
+    if (blocks.size() == 0) {
+        printf("Could not find event data\n");
+        p_IODevice.close();
+        return false;
+    }
+
+    bool bFound = false;
+    FiffTag::SPtr t_pTag;
+
+    for(qint32 k = 0; k < blocks[0]->nent(); ++k) {
+        fiff_int_t kind = blocks[0]->dir[k]->kind;
+        fiff_int_t pos  = blocks[0]->dir[k]->pos;
+
+        switch(kind) {
+            case FIFF_MNE_EVENT_LIST:
+                t_pStream->read_tag(t_pTag, pos);
+                if(t_pTag->type == FIFFT_INT || t_pTag->type == FIFFT_UINT) {
+                    qint32 nevent = t_pTag->size()/(3*sizeof(fiff_int_t));
+                    if(nevent > 0)
+                        m_matEvents = Map<const Matrix<fiff_int_t, Dynamic, 3, RowMajor> >((const fiff_int_t*)t_pTag->data(), nevent, 3);
+                    bFound = true;
+                }
+                break;
+            case FIFF_EVENT_CHANNEL:
+                t_pStream->read_tag(t_pTag, pos);
+                m_sTriggerCh = t_pTag->toString();
+                break;
+            case FIFF_EVENT_BITS:
+                t_pStream->read_tag(t_pTag, pos);
+                if(t_pTag->toInt())
+                    m_iMask = *t_pTag->toInt();
+                break;
+            case FIFF_FIRST_SAMPLE:
+                t_pStream->read_tag(t_pTag, pos);
+                if(t_pTag->toInt())
+                    m_iFirstSample = *t_pTag->toInt();
+                break;
+            case FIFF_LAST_SAMPLE:
+                t_pStream->read_tag(t_pTag, pos);
+                if(t_pTag->toInt())
+                    m_iLastSample = *t_pTag->toInt();
+                break;
+            default:
+                break;
+        }
+    }
+
+    p_IODevice.close();
+
+    if(!bFound) {
+        printf("Could not find any events\n");
+        return false;
+    }
+
+    //
+    //   Event files which were not written by the index may be unsorted
+    //
+    bool bSorted = true;
+    for(qint32 k = 1; k < m_matEvents.rows() && bSorted; ++k)
+        bSorted = m_matEvents(k-1,0) <= m_matEvents(k,0);
+
+    if(!bSorted) {
+        QVector<qint32> order(m_matEvents.rows());
+        for(qint32 k = 0; k < order.size(); ++k)
+            order[k] = k;
+
+        const MatrixXi& matEvents = m_matEvents;
+        std::stable_sort(order.begin(), order.end(), [&matEvents](qint32 a, qint32 b) { return matEvents(a,0) < matEvents(b,0); });
+
+        MatrixXi matSorted(m_matEvents.rows(), 3);
+        for(qint32 k = 0; k < order.size(); ++k)
+            matSorted.row(k) = m_matEvents.row(order[k]);
+        m_matEvents = matSorted;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventIndex::write(QIODevice& p_IODevice) const
+{
+    FiffStream::SPtr t_pStream = FiffStream::start_file(p_IODevice);
+
+    if(!t_pStream)
+        return false;
+
+    t_pStream->start_block(FIFFB_MNE_EVENTS);
+
+    //Row major, as read by MNE::read_events
+    Matrix<fiff_int_t, Dynamic, 3, RowMajor> matEvents = m_matEvents;
+    t_pStream->write_int(FIFF_MNE_EVENT_LIST, matEvents.data(), matEvents.size());
+
+    if(!m_sTriggerCh.isEmpty()) {
+        t_pStream->write_string(FIFF_EVENT_CHANNEL, m_sTriggerCh);
+        t_pStream->write_int(FIFF_EVENT_BITS, &m_iMask);
+        t_pStream->write_int(FIFF_FIRST_SAMPLE, &m_iFirstSample);
+        t_pStream->write_int(FIFF_LAST_SAMPLE, &m_iLastSample);
+    }
+
+    t_pStream->end_block(FIFFB_MNE_EVENTS);
+    t_pStream->end_file();
+
+    p_IODevice.close();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi FiffEventIndex::events(bool bOnsetsOnly) const
+{
+    return pick_rows(0, m_matEvents.rows(), bOnsetsOnly);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi FiffEventIndex::events_in_range(fiff_int_t iFrom, fiff_int_t iTo, bool bOnsetsOnly) const
+{
+    if(iTo < iFrom)
+        return MatrixXi(0,3);
+
+    return pick_rows(lower_bound(iFrom), lower_bound(iTo + 1), bOnsetsOnly);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi FiffEventIndex::events_of_type(fiff_int_t iEvent) const
+{
+    return pick_rows(0, m_matEvents.rows(), true, iEvent);
+}
+
+
+//*************************************************************************************************************
+
+QString FiffEventIndex::default_file_name(const QString& sRawFileName)
+{
+    QString sFileName = sRawFileName;
+    qint32 p = sFileName.lastIndexOf(".fif");
+
+    if(p > 0)
+        return sFileName.replace(p, 4, "-trig-eve.fif");
+
+    return sFileName + "-trig-eve.fif";
+}
+
+
+//*************************************************************************************************************
+
+QString FiffEventIndex::default_trigger_channel(const FiffInfo& info)
+{
+    QStringList candidates;
+    candidates << "STI 014" << "STI101" << "STI 101";
+
+    for(qint32 k = 0; k < candidates.size(); ++k)
+        if(info.channel_index(candidates[k]) >= 0)
+            return candidates[k];
+
+    for(qint32 k = 0; k < info.chs.size(); ++k)
+        if(info.chs[k].kind == FIFFV_STIM_CH)
+            return info.chs[k].ch_name;
+
+    return QString();
+}
+
+
+//*************************************************************************************************************
+
+qint32 FiffEventIndex::lower_bound(fiff_int_t iSample) const
+{
+    const fiff_int_t* pSamples = m_matEvents.col(0).data();
+    return std::lower_bound(pSamples, pSamples + m_matEvents.rows(), iSample) - pSamples;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi FiffEventIndex::pick_rows(qint32 iFirst, qint32 iLast, bool bOnsetsOnly, fiff_int_t iEvent) const
+{
+    qint32 nrow = 0;
+    for(qint32 k = iFirst; k < iLast; ++k)
+        if((!bOnsetsOnly || m_matEvents(k,2) != 0) && (iEvent < 0 || m_matEvents(k,2) == iEvent))
+            ++nrow;
+
+    MatrixXi matPicked(nrow, 3);
+    nrow = 0;
+    for(qint32 k = iFirst; k < iLast; ++k)
+        if((!bOnsetsOnly || m_matEvents(k,2) != 0) && (iEvent < 0 || m_matEvents(k,2) == iEvent))
+            matPicked.row(nrow++) = m_matEvents.row(k);
+
+    return matPicked;
+}
@@ -0,0 +1,307 @@
+//=============================================================================================================
+/**
+* @file     fiff_event_index.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffEventIndex class declaration.
+*
+*/
+
+
+#ifndef FIFF_EVENT_INDEX_H
+#define FIFF_EVENT_INDEX_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QIODevice>
+#include <QString>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+class FiffRawData;
+class FiffInfo;
+
+
+//=============================================================================================================
+/**
+* Table of all value changes of a trigger channel in a raw file, sorted by sample. The index is built in one pass
+* over the raw buffers which decodes only the trigger channel and skips all other channels. It can be stored next
+* to the raw file as MNE event file, so that it is built only once per file.
+*
+* The events are given in the MNE format: one row per event with the sample, the trigger value before and the
+* trigger value after the change. Onsets are changes to a non-zero value.
+*
+* @brief Trigger event index of a raw file.
+*/
+class FIFFSHARED_EXPORT FiffEventIndex
+{
+public:
+    typedef QSharedPointer<FiffEventIndex> SPtr;              /**< Shared pointer type for FiffEventIndex. */
+    typedef QSharedPointer<const FiffEventIndex> ConstSPtr;   /**< Const shared pointer type for FiffEventIndex. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty event index.
+    */
+    FiffEventIndex();
+
+    //=========================================================================================================
+    /**
+    * Clears the event index.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Builds the index from the raw data. Only the trigger channel is decoded, skips count as zero.
+    *
+    * @param[in] raw            The raw data
+    * @param[in] sTriggerCh     The trigger channel, empty for default_trigger_channel
+    * @param[in] iMask          Mask applied to the trigger values before the changes are detected, 0 for none
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool build(const FiffRawData& raw, const QString& sTriggerCh = QString(), fiff_int_t iMask = 0);
+
+    //=========================================================================================================
+    /**
+    * Reads the index from the event file stored next to the raw file if it is up to date with the raw file,
+    * trigger channel and mask. Builds it otherwise, and stores it if requested.
+    *
+    * @param[in] raw            The raw data
+    * @param[in] sTriggerCh     The trigger channel, empty for default_trigger_channel
+    * @param[in] iMask          Mask applied to the trigger values before the changes are detected, 0 for none
+    * @param[in] bPersist       Whether to store a newly built index next to the raw file
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool load_or_build(const FiffRawData& raw, const QString& sTriggerCh = QString(), fiff_int_t iMask = 0, bool bPersist = true);
+
+    //=========================================================================================================
+    /**
+    * Reads the index from an event file. Plain MNE event files without trigger channel information are read too.
+    *
+    * @param[in] p_IODevice     The I/O device to read from
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read(QIODevice& p_IODevice);
+
+    //=========================================================================================================
+    /**
+    * Writes the index as MNE event file, which can be read by MNE::read_events as well.
+    *
+    * @param[in] p_IODevice     The I/O device to write to
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool write(QIODevice& p_IODevice) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the events in the MNE format.
+    *
+    * @param[in] bOnsetsOnly    Whether to return only the changes to a non-zero value
+    *
+    * @return The events (n x 3: sample, value before, value after)
+    */
+    Eigen::MatrixXi events(bool bOnsetsOnly = true) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the events within a sample range. The range is looked up by binary search.
+    *
+    * @param[in] iFrom          First sample of the range
+    * @param[in] iTo            Last sample of the range
+    * @param[in] bOnsetsOnly    Whether to return only the changes to a non-zero value
+    *
+    * @return The events (n x 3: sample, value before, value after)
+    */
+    Eigen::MatrixXi events_in_range(fiff_int_t iFrom, fiff_int_t iTo, bool bOnsetsOnly = true) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the onsets of one event type.
+    *
+    * @param[in] iEvent     The trigger value
+    *
+    * @return The events (n x 3: sample, value before, value after)
+    */
+    Eigen::MatrixXi events_of_type(fiff_int_t iEvent) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the event file which is stored next to a raw file, e.g. sample_audvis_raw-trig-eve.fif
+    * for sample_audvis_raw.fif.
+    *
+    * @param[in] sRawFileName   The raw file
+    *
+    * @return The name of the event file
+    */
+    static QString default_file_name(const QString& sRawFileName);
+
+    //=========================================================================================================
+    /**
+    * Returns the default trigger channel: STI 014 or STI101 if present, the first stimulus channel otherwise.
+    *
+    * @param[in] info       The measurement info
+    *
+    * @return The trigger channel, empty if there is no stimulus channel
+    */
+    static QString default_trigger_channel(const FiffInfo& info);
+
+    //=========================================================================================================
+    /**
+    * Returns all value changes of the trigger channel sorted by sample.
+    *
+    * @return The events (n x 3: sample, value before, value after)
+    */
+    inline const Eigen::MatrixXi& table() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the trigger channel the index was built for.
+    *
+    * @return The trigger channel, empty if unknown
+    */
+    inline const QString& trigger_channel() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the mask the index was built with.
+    *
+    * @return The mask, 0 for none
+    */
+    inline fiff_int_t mask() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the index holds no events.
+    *
+    * @return true if there are no events
+    */
+    inline bool isEmpty() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Index of the first event at or after a sample.
+    *
+    * @param[in] iSample    The sample
+    *
+    * @return The row in m_matEvents
+    */
+    qint32 lower_bound(fiff_int_t iSample) const;
+
+    //=========================================================================================================
+    /**
+    * Picks rows of m_matEvents.
+    *
+    * @param[in] iFirst         First row
+    * @param[in] iLast          One past the last row
+    * @param[in] bOnsetsOnly    Whether to pick only the changes to a non-zero value
+    * @param[in] iEvent         Pick only onsets to this value, -1 for all
+    *
+    * @return The picked rows
+    */
+    Eigen::MatrixXi pick_rows(qint32 iFirst, qint32 iLast, bool bOnsetsOnly, fiff_int_t iEvent = -1) const;
+
+    QString             m_sTriggerCh;       /**< The trigger channel. */
+    fiff_int_t          m_iMask;            /**< Mask applied to the trigger values, 0 for none. */
+    fiff_int_t          m_iFirstSample;     /**< First sample of the raw data, -1 if unknown. */
+    fiff_int_t          m_iLastSample;      /**< Last sample of the raw data, -1 if unknown. */
+    Eigen::MatrixXi     m_matEvents;        /**< All value changes (n x 3: sample, value before, value after). */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXi& FiffEventIndex::table() const
+{
+    return m_matEvents;
+}
+
+
+//*************************************************************************************************************
+
+inline const QString& FiffEventIndex::trigger_channel() const
+{
+    return m_sTriggerCh;
+}
+
+
+//*************************************************************************************************************
+
+inline fiff_int_t FiffEventIndex::mask() const
+{
+    return m_iMask;
+}
+
+
+//*************************************************************************************************************
+
+inline bool FiffEventIndex::isEmpty() const
+{
+    return m_matEvents.rows() == 0;
+}
+
+} // NAMESPACE FIFFLIB
+
+#endif // FIFF_EVENT_INDEX_H
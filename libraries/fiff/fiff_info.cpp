@@ -45,6 +45,15 @@
 #include <utils/ioutils.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QHash>
+#include <QMutexLocker>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -54,6 +63,51 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Whether two projector lists give the same projection. The data are compared by their shared data pointer,
+* the cache keeps a reference so that any modification detaches them.
+*/
+bool sameProjs(const QList<FiffProj>& projsA, const QList<FiffProj>& projsB)
+{
+    if(projsA.size() != projsB.size())
+        return false;
+
+    for(qint32 k = 0; k < projsA.size(); ++k)
+        if(projsA[k].active != projsB[k].active || projsA[k].data.constData() != projsB[k].data.constData())
+            return false;
+
+    return true;
+}
+
+
+//=============================================================================================================
+/**
+* Whether two compensator lists give the same compensation, compared like sameProjs.
+*/
+bool sameComps(const QList<FiffCtfComp>& compsA, const QList<FiffCtfComp>& compsB)
+{
+    if(compsA.size() != compsB.size())
+        return false;
+
+    for(qint32 k = 0; k < compsA.size(); ++k)
+        if(compsA[k].kind != compsB[k].kind || compsA[k].data.constData() != compsB[k].data.constData())
+            return false;
+
+    return true;
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -247,15 +301,8 @@ bool FiffInfo::make_compensator(fiff_int_t kind, MatrixXd& this_comp) const//pri
 
             for(col = 0; col < this_data->ncol; ++col)
             {
-                channelAvailable = 0;
-                for (c = 0; c < this->ch_names.size(); ++c)
-                {
-                    if (QString::compare(this_data->col_names.at(col),this->ch_names.at(c)) == 0)
-                    {
-                        ++channelAvailable;
-                        ch = c;
-                    }
-                }
+                channelAvailable = this->channel_count(this_data->col_names.at(col));
+                ch = this->channel_index(this_data->col_names.at(col));
                 if (channelAvailable == 0)
                 {
                     printf("Channel %s is not available in data\n",this_data->col_names.at(col).toUtf8().constData());
@@ -273,17 +320,19 @@ bool FiffInfo::make_compensator(fiff_int_t kind, MatrixXd& this_comp) const//pri
             //
             postsel = MatrixXd::Zero(this->nchan,this_data->nrow);
 
+            QHash<QString, qint32> rowIndex;
+            QHash<QString, qint32> rowCount;
+            rowIndex.reserve(this_data->row_names.size());
+            for (row = 0; row < this_data->row_names.size(); ++row)
+            {
+                rowIndex.insert(this_data->row_names.at(row), row);
+                ++rowCount[this_data->row_names.at(row)];
+            }
+
             for (c = 0; c  < this->nchan; ++c)
             {
-                channelAvailable = 0;
-                for (row = 0; row < this_data->row_names.size(); ++row)
-                {
-                    if (QString::compare(this->ch_names.at(c),this_data->row_names.at(row)) == 0)
-                    {
-                        ++channelAvailable;
-                        row_ch = row;
-                    }
-                }
+                channelAvailable = rowCount.value(this->ch_names.at(c), 0);
+                row_ch = rowIndex.value(this->ch_names.at(c), 0);
                 if (channelAvailable > 1)
                 {
                     printf("Ambiguous channel %s", this->ch_names.at(c).toUtf8().constData());
@@ -303,6 +352,97 @@ bool FiffInfo::make_compensator(fiff_int_t kind, MatrixXd& this_comp) const//pri
 }
 
 
+//*************************************************************************************************************
+
+FiffProjCompOperator::ConstSPtr FiffInfo::proj_comp_operator(fiff_int_t compTo, bool zeroBads) const
+{
+    QMutexLocker locker(&m_projComp.mutex);
+
+    ProjCompEntry& entry = m_projComp.entries[qMakePair(compTo, zeroBads)];
+    FiffProjCompOperator::ConstSPtr pOld = entry.pOperator;
+
+    bool projChanged = !pOld
+            || pOld->nchan() != this->nchan
+            || !(entry.projChNames == this->ch_names)
+            || !(entry.projBads == this->bads)
+            || !sameProjs(entry.projProjs, this->projs);
+
+    bool compChanged = !pOld
+            || pOld->nchan() != this->nchan
+            || !(entry.compChNames == this->ch_names)
+            || !sameComps(entry.compComps, this->comps);
+
+    if(!projChanged && !compChanged)
+        return pOld;
+
+    qint32 nchan = qMax(this->nchan, 0);
+
+    //
+    //   Projection, reuse the old one if its inputs did not change
+    //
+    bool bProj = false;
+    MatrixXd matU;
+    VectorXd vecKeep = VectorXd::Ones(nchan);
+
+    if(projChanged) {
+        for(qint32 k = 0; k < this->projs.size(); ++k) {
+            if(this->projs[k].active) {
+                bProj = true;
+                break;
+            }
+        }
+
+        if(bProj && nchan > 0) {
+            MatrixXd matProj;
+            FiffProj::make_projector(this->projs, this->ch_names, matProj, this->bads, matU);
+
+            if(zeroBads) {
+                for(qint32 k = 0; k < this->bads.size(); ++k) {
+                    qint32 idx = this->channel_index(this->bads[k]);
+                    if(idx >= 0 && idx < nchan)
+                        vecKeep[idx] = 0.0;
+                }
+            }
+        }
+
+        entry.projChNames = this->ch_names;
+        entry.projBads = this->bads;
+        entry.projProjs = this->projs;
+    } else {
+        bProj = pOld->hasProj();
+        matU = pOld->projVectors();
+        vecKeep = pOld->keep();
+    }
+
+    //
+    //   Compensation, reuse the old one if its inputs did not change
+    //
+    bool bComp = false;
+    SparseMatrix<double> matComp;
+
+    if(compChanged) {
+        if(compTo != 0 && nchan > 0) {
+            FiffCtfComp newComp;
+            //Always from 0 since the operator is applied to raw data
+            if(this->make_compensator(0, compTo, newComp) && newComp.data->data.rows() == nchan) {
+                matComp = newComp.data->data.sparseView();
+                bComp = true;
+            }
+        }
+
+        entry.compChNames = this->ch_names;
+        entry.compComps = this->comps;
+    } else {
+        bComp = pOld->hasComp();
+        matComp = pOld->comp();
+    }
+
+    entry.pOperator = FiffProjCompOperator::ConstSPtr(new FiffProjCompOperator(nchan, bProj, matU, vecKeep, bComp, matComp));
+
+    return entry.pOperator;
+}
+
+
 //*************************************************************************************************************
 
 FiffInfo FiffInfo::pick_info(const RowVectorXi &sel) const
@@ -52,6 +52,7 @@
 #include "fiff_ctf_comp.h"
 #include "fiff_coord_trans.h"
 #include "fiff_proj.h"
+#include "fiff_proj_comp_operator.h"
 
 
 //*************************************************************************************************************
@@ -62,6 +63,9 @@
 #include <QList>
 #include <QStringList>
 #include <QSharedPointer>
+#include <QMutex>
+#include <QMap>
+#include <QPair>
 
 
 //*************************************************************************************************************
@@ -183,6 +187,19 @@ public:
     */
     inline qint32 make_projector(MatrixXd& proj, const QStringList& p_chNames) const;
 
+    //=========================================================================================================
+    /**
+    * Returns the combined SSP projection and CTF compensation operator for the current projs, bads and comps.
+    * The operators are cached per compTo and zeroBads. Only the part whose inputs changed (active projectors,
+    * bads, compensators) is recomputed, repeated calls with unchanged inputs return the same operator.
+    *
+    * @param[in] compTo     Compensation grade to compensate the raw data to, 0 for no compensation
+    * @param[in] zeroBads   Whether the projection sets the bad channels to zero
+    *
+    * @return The operator
+    */
+    FiffProjCompOperator::ConstSPtr proj_comp_operator(fiff_int_t compTo = 0, bool zeroBads = false) const;
+
     //=========================================================================================================
     /**
     * fiff_pick_info
@@ -254,6 +271,40 @@ private:
     */
     bool make_compensator(fiff_int_t kind, MatrixXd& this_comp) const;
 
+    //=========================================================================================================
+    /**
+    * Inputs and parts of the last operator handed out by proj_comp_operator for one compTo and zeroBads.
+    */
+    struct ProjCompEntry
+    {
+        FiffProjCompOperator::ConstSPtr pOperator;      /**< The last operator. */
+
+        QStringList                     projChNames;    /**< ch_names the projection was made for. */
+        QStringList                     projBads;       /**< bads the projection was made for. */
+        QList<FiffProj>                 projProjs;      /**< projs the projection was made for. */
+
+        QStringList                     compChNames;    /**< ch_names the compensator was made for. */
+        QList<FiffCtfComp>              compComps;      /**< comps the compensator was made for. */
+    };
+
+    //=========================================================================================================
+    /**
+    * The operators handed out by proj_comp_operator, keyed by compTo and zeroBads, so that callers with different
+    * arguments do not evict each other. A copy starts empty.
+    */
+    class ProjCompCache
+    {
+    public:
+        ProjCompCache() {}
+        ProjCompCache(const ProjCompCache&) {}
+        ProjCompCache& operator=(const ProjCompCache&) { return *this; }
+
+        QMutex                                          mutex;      /**< Guards the cache, infos are shared between threads. */
+        QMap<QPair<fiff_int_t, bool>, ProjCompEntry>    entries;    /**< The entries by compTo and zeroBads. */
+    };
+
+    mutable ProjCompCache m_projComp;   /**< Cache of proj_comp_operator. */
+
 public: //Public because it's a mne struct
     FiffId file_id;             /**< File ID. */
     fiff_int_t  meas_date[2];   /**< Measurement date. TODO: use fiffTime instead to be MNE-C consistent*/
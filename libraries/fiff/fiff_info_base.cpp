@@ -43,6 +43,15 @@
 #include <iostream>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QSet>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -124,6 +133,57 @@ QString FiffInfoBase::channel_type(qint32 idx) const
 }
 
 
+//*************************************************************************************************************
+
+qint32 FiffInfoBase::channel_index(const QString& ch_name) const
+{
+    QMutexLocker locker(&m_channelIndex.mutex);
+    update_channel_index();
+
+    return m_channelIndex.index.value(ch_name, -1);
+}
+
+
+//*************************************************************************************************************
+
+qint32 FiffInfoBase::channel_count(const QString& ch_name) const
+{
+    QMutexLocker locker(&m_channelIndex.mutex);
+    update_channel_index();
+
+    if(!m_channelIndex.index.contains(ch_name))
+        return 0;
+
+    return m_channelIndex.duplicates.value(ch_name, 1);
+}
+
+
+//*************************************************************************************************************
+
+void FiffInfoBase::update_channel_index() const
+{
+    //QStringList compares the shared data pointers first, an unchanged list is recognized in constant time
+    if(!(m_channelIndex.names == this->ch_names))
+    {
+        m_channelIndex.index.clear();
+        m_channelIndex.duplicates.clear();
+        m_channelIndex.index.reserve(this->ch_names.size());
+
+        for(qint32 k = 0; k < this->ch_names.size(); ++k)
+        {
+            const QString& name = this->ch_names[k];
+            if(m_channelIndex.index.contains(name))
+                m_channelIndex.duplicates[name] = m_channelIndex.duplicates.value(name, 1) + 1;
+            else
+                m_channelIndex.index.insert(name, k);
+        }
+    }
+
+    //Share the list data, so that the next check is a pointer comparison again
+    m_channelIndex.names = this->ch_names;
+}
+
+
 //*************************************************************************************************************
 
 void FiffInfoBase::clear()
@@ -212,19 +272,23 @@ RowVectorXi FiffInfoBase::pick_channels(const QStringList& ch_names, const QStri
 {
     RowVectorXi sel = RowVectorXi::Zero(ch_names.size());
 
-    QStringList t_includedSelection;
+    //Hash the name lists, so that picking is linear in the number of channels
+    QSet<QString> t_includeSet = include.toSet();
+    QSet<QString> t_excludeSet = exclude.toSet();
+    QSet<QString> t_includedSelection;
+    t_includedSelection.reserve(ch_names.size());
 
     qint32 count = 0;
     for(qint32 k = 0; k < ch_names.size(); ++k)
     {
-        if( (include.size() == 0 || include.contains(ch_names[k])) && !exclude.contains(ch_names[k]))
+        if( (include.size() == 0 || t_includeSet.contains(ch_names[k])) && !t_excludeSet.contains(ch_names[k]))
         {
             //make sure channel is unique
             if(!t_includedSelection.contains(ch_names[k]))
             {
                 sel[count] = k;
                 ++count;
-                t_includedSelection << ch_names[k];
+                t_includedSelection.insert(ch_names[k]);
             }
         }
     }
@@ -59,6 +59,8 @@
 #include <QList>
 #include <QStringList>
 #include <QSharedPointer>
+#include <QHash>
+#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -124,6 +126,26 @@ public:
     */
     QString channel_type(qint32 idx) const;
 
+    //=========================================================================================================
+    /**
+    * Looks up a channel by name. The name to index table is built once and rebuilt only after ch_names changed.
+    *
+    * @param[in] ch_name    Name of the channel
+    *
+    * @return Index of the first channel with this name, -1 if there is none
+    */
+    qint32 channel_index(const QString& ch_name) const;
+
+    //=========================================================================================================
+    /**
+    * Number of channels with the given name. Uses the same table as channel_index.
+    *
+    * @param[in] ch_name    Name of the channel
+    *
+    * @return Number of channels named ch_name
+    */
+    qint32 channel_count(const QString& ch_name) const;
+
     //=========================================================================================================
     /**
     * True if FIFF measurement file information is empty.
@@ -208,6 +230,32 @@ public: //Public because it's a mne struct
     QStringList ch_names;       /**< List of all channel names. */
     FiffCoordTrans dev_head_t;  /**< Coordinate transformation ToDo... */
     FiffCoordTrans ctf_head_t;  /**< Coordinate transformation ToDo... */
+
+private:
+    //=========================================================================================================
+    /**
+    * Name to index table of ch_names. A copy starts empty, since it is rebuilt on first use anyway.
+    */
+    class ChannelIndexCache
+    {
+    public:
+        ChannelIndexCache() {}
+        ChannelIndexCache(const ChannelIndexCache&) {}
+        ChannelIndexCache& operator=(const ChannelIndexCache&) { return *this; }
+
+        QMutex                  mutex;          /**< Guards the table, lookups can come from several threads. */
+        QStringList             names;          /**< The channel names the table was built from. */
+        QHash<QString, qint32>  index;          /**< Index of the first channel with a given name. */
+        QHash<QString, qint32>  duplicates;     /**< Number of channels for names which occur more than once. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Rebuilds the name to index table if ch_names changed. Call with the mutex of the table locked.
+    */
+    void update_channel_index() const;
+
+    mutable ChannelIndexCache m_channelIndex;   /**< Name to index table of ch_names. */
 };
 
 //*************************************************************************************************************
@@ -52,6 +52,15 @@
 #include <Eigen/SVD>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QHash>
+#include <QSet>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -165,9 +174,9 @@ fiff_int_t FiffProj::make_projector(const QList<FiffProj>& projs, const QStringL
     MatrixXd vecs = MatrixXd::Zero(nchan,nvec);
     nvec = 0;
     fiff_int_t nonzero = 0;
-    qint32 p, c, i, j, v;
+    qint32 p, c, i, v;
     double onesize;
-    bool isBad = false;
+    QSet<QString> badSet = bads.toSet();
     RowVectorXi sel(nchan);
     RowVectorXi vecSel(nchan);
     sel.setConstant(-1);
@@ -178,11 +187,12 @@ fiff_int_t FiffProj::make_projector(const QList<FiffProj>& projs, const QStringL
         {
             FiffProj one = projs[k];
 
-            QMap<QString, int> uniqueMap;
+            QHash<QString, qint32> colIndex;
+            colIndex.reserve(one.data->col_names.size());
             for(l = 0; l < one.data->col_names.size(); ++l)
-                uniqueMap[one.data->col_names[l] ] = 0;
+                colIndex.insert(one.data->col_names[l], l);
 
-            if (one.data->col_names.size() != uniqueMap.keys().size())
+            if (one.data->col_names.size() != colIndex.size())
             {
                 printf("Channel name list in projection item %d contains duplicate items",k);
                 return 0;
@@ -199,27 +209,12 @@ fiff_int_t FiffProj::make_projector(const QList<FiffProj>& projs, const QStringL
             p = 0;
             for (c = 0; c < nchan; ++c)
             {
-                for (i = 0; i < one.data->col_names.size(); ++i)
+                i = colIndex.value(ch_names.at(c), -1);
+                if (i >= 0 && !badSet.contains(ch_names.at(c)) && sel[p] != c)
                 {
-                    if (QString::compare(ch_names.at(c),one.data->col_names[i]) == 0)
-                    {
-                        isBad = false;
-                        for (j = 0; j < bads.size(); ++j)
-                        {
-                            if (QString::compare(ch_names.at(c),bads.at(j)) == 0)
-                            {
-                                isBad = true;
-                            }
-                        }
-
-                        if (!isBad && sel[p] != c)
-                        {
-                            sel[p] = c;
-                            vecSel[p] = i;
-                            ++p;
-                        }
-
-                    }
+                    sel[p] = c;
+                    vecSel[p] = i;
+                    ++p;
                 }
             }
             sel.conservativeResize(p);
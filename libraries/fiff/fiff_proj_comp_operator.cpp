@@ -0,0 +1,132 @@
+//=============================================================================================================
+/**
+* @file     fiff_proj_comp_operator.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffProjCompOperator class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_proj_comp_operator.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffProjCompOperator::FiffProjCompOperator()
+: m_iNchan(0)
+, m_bProj(false)
+, m_bComp(false)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffProjCompOperator::FiffProjCompOperator(qint32 iNchan,
+                                           bool bProj,
+                                           const MatrixXd& matU,
+                                           const VectorXd& vecKeep,
+                                           bool bComp,
+                                           const SparseMatrix<double>& matComp)
+: m_iNchan(iNchan)
+, m_bProj(bProj)
+, m_matU(matU)
+, m_vecKeep(vecKeep)
+, m_bComp(bComp)
+, m_matComp(matComp)
+{
+    if(m_matU.rows() != m_iNchan) {
+        m_matU.resize(m_iNchan, 0);
+    }
+
+    if(m_vecKeep.size() != m_iNchan) {
+        m_vecKeep = VectorXd::Ones(m_iNchan);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffProjCompOperator::apply(const Ref<const MatrixXd>& data, Ref<MatrixXd> result) const
+{
+    if(m_bComp) {
+        result.noalias() = m_matComp * data;
+    } else {
+        result = data;
+    }
+
+    if(m_bProj) {
+        //(diag(keep) - U*U^T)*x, U has zero rows for the channels which are not kept
+        MatrixXd matCoeff = m_matU.transpose() * result;
+        result.array().colwise() *= m_vecKeep.array();
+        result.noalias() -= m_matU * matCoeff;
+    }
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd FiffProjCompOperator::apply(const Ref<const MatrixXd>& data) const
+{
+    MatrixXd result(data.rows(), data.cols());
+    apply(data, result);
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd FiffProjCompOperator::proj() const
+{
+    if(!m_bProj) {
+        return MatrixXd::Identity(m_iNchan, m_iNchan);
+    }
+
+    MatrixXd matProj = m_vecKeep.asDiagonal();
+    matProj.noalias() -= m_matU * m_matU.transpose();
+    return matProj;
+}
@@ -0,0 +1,281 @@
+//=============================================================================================================
+/**
+* @file     fiff_proj_comp_operator.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffProjCompOperator class declaration.
+*
+*/
+
+
+#ifndef FIFF_PROJ_COMP_OPERATOR_H
+#define FIFF_PROJ_COMP_OPERATOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//=============================================================================================================
+/**
+* The combined SSP projection and CTF compensation operator proj*comp. The projector is kept in its low-rank form
+* diag(keep) - U*U^T, where U is the orthonormal basis of the projection vectors, and the compensator as sparse
+* matrix. Applying the operator costs O(nchan*nproj) per sample instead of O(nchan^2).
+*
+* @brief Combined projection and compensation operator.
+*/
+class FIFFSHARED_EXPORT FiffProjCompOperator
+{
+public:
+    typedef QSharedPointer<FiffProjCompOperator> SPtr;              /**< Shared pointer type for FiffProjCompOperator. */
+    typedef QSharedPointer<const FiffProjCompOperator> ConstSPtr;   /**< Const shared pointer type for FiffProjCompOperator. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty operator.
+    */
+    FiffProjCompOperator();
+
+    //=========================================================================================================
+    /**
+    * Constructs the operator from its parts.
+    *
+    * @param[in] iNchan     Number of channels
+    * @param[in] bProj      Whether the projection is applied
+    * @param[in] matU       Orthonormal basis of the projection vectors (nchan x nproj)
+    * @param[in] vecKeep    Diagonal of the projector, zero for channels which are set to zero (nchan)
+    * @param[in] bComp      Whether the compensation is applied
+    * @param[in] matComp    The compensator (nchan x nchan)
+    */
+    FiffProjCompOperator(qint32 iNchan,
+                         bool bProj,
+                         const Eigen::MatrixXd& matU,
+                         const Eigen::VectorXd& vecKeep,
+                         bool bComp,
+                         const Eigen::SparseMatrix<double>& matComp);
+
+    //=========================================================================================================
+    /**
+    * Applies the operator, result = proj*comp*data. result must not overlap data.
+    *
+    * @param[in] data       The data (nchan x samples)
+    * @param[out] result    The projected and compensated data (nchan x samples)
+    */
+    void apply(const Eigen::Ref<const Eigen::MatrixXd>& data, Eigen::Ref<Eigen::MatrixXd> result) const;
+
+    //=========================================================================================================
+    /**
+    * Applies the operator.
+    *
+    * @param[in] data       The data (nchan x samples)
+    *
+    * @return proj*comp*data
+    */
+    Eigen::MatrixXd apply(const Eigen::Ref<const Eigen::MatrixXd>& data) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the projector as dense matrix, for code which expects the output of FiffProj::make_projector.
+    *
+    * @return The projector (nchan x nchan), identity if no projection is applied
+    */
+    Eigen::MatrixXd proj() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the orthonormal basis U of the projection vectors.
+    *
+    * @return U (nchan x nproj)
+    */
+    inline const Eigen::MatrixXd& projVectors() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the diagonal of the projector.
+    *
+    * @return The diagonal (nchan), zero for channels which are set to zero
+    */
+    inline const Eigen::VectorXd& keep() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the compensator.
+    *
+    * @return The compensator (nchan x nchan), empty if no compensation is applied
+    */
+    inline const Eigen::SparseMatrix<double>& comp() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return The number of channels
+    */
+    inline qint32 nchan() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of linearly independent projection vectors.
+    *
+    * @return The rank of U
+    */
+    inline qint32 nproj() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the projection is applied, i.e., at least one projector is active.
+    *
+    * @return true if the projection is applied
+    */
+    inline bool hasProj() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the compensation is applied.
+    *
+    * @return true if the compensation is applied
+    */
+    inline bool hasComp() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the operator leaves the data untouched.
+    *
+    * @return true if neither projection nor compensation are applied
+    */
+    inline bool isIdentity() const;
+
+private:
+    qint32                      m_iNchan;       /**< Number of channels. */
+    bool                        m_bProj;        /**< Whether the projection is applied. */
+    Eigen::MatrixXd             m_matU;         /**< Orthonormal basis of the projection vectors. */
+    Eigen::VectorXd             m_vecKeep;      /**< Diagonal of the projector. */
+    bool                        m_bComp;        /**< Whether the compensation is applied. */
+    Eigen::SparseMatrix<double> m_matComp;      /**< The compensator. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXd& FiffProjCompOperator::projVectors() const
+{
+    return m_matU;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::VectorXd& FiffProjCompOperator::keep() const
+{
+    return m_vecKeep;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::SparseMatrix<double>& FiffProjCompOperator::comp() const
+{
+    return m_matComp;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 FiffProjCompOperator::nchan() const
+{
+    return m_iNchan;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 FiffProjCompOperator::nproj() const
+{
+    return m_matU.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline bool FiffProjCompOperator::hasProj() const
+{
+    return m_bProj;
+}
+
+
+//*************************************************************************************************************
+
+inline bool FiffProjCompOperator::hasComp() const
+{
+    return m_bComp;
+}
+
+
+//*************************************************************************************************************
+
+inline bool FiffProjCompOperator::isIdentity() const
+{
+    return !m_bProj && !m_bComp;
+}
+
+} // NAMESPACE FIFFLIB
+
+#endif // FIFF_PROJ_COMP_OPERATOR_H
@@ -182,7 +182,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
             else if (this->comp.kind == -1)
                 mult_full = this->proj*cal;
             else
-                mult_full = this->proj*this->comp.data->data*cal;
+                mult_full = (this->proj*this->comp.data->data.sparseView())*cal;//The compensator is sparse, avoid the dense triple product
         }
     }
     else
@@ -225,7 +225,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                 for( i = 0; i  < sel.size(); ++i)
                     selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
 
-                mult_full = selVect*this->comp.data->data*cal;
+                mult_full = (selVect*this->comp.data->data.sparseView())*cal;
             }
         }
     }
@@ -516,7 +516,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
             else if (this->comp.kind == -1)
                 mult_full = this->proj*cal;
             else
-                mult_full = this->proj*this->comp.data->data*cal;
+                mult_full = (this->proj*this->comp.data->data.sparseView())*cal;//The compensator is sparse, avoid the dense triple product
         }
     }
     else
@@ -559,7 +559,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                 for( i = 0; i  < sel.size(); ++i)
                     selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
 
-                mult_full = selVect*this->comp.data->data*cal;
+                mult_full = (selVect*this->comp.data->data.sparseView())*cal;
             }
         }
     }
@@ -807,3 +807,119 @@ bool FiffRawData::read_raw_segment_times(MatrixXd& data,
     //
     return this->read_raw_segment(data, times, (qint32)from, (qint32)to, sel);
 }
+
+
+//*************************************************************************************************************
+
+SparseMatrix<double> FiffRawData::create_operator(const RowVectorXi& sel) const
+{
+    qint32 nchan = this->info.nchan;
+    qint32 i, k;
+
+    //
+    //  The selection combined with the calibration
+    //
+    RowVectorXi selNew = sel;
+    if(sel.size() == 0) {
+        selNew.resize(nchan);
+        for(i = 0; i < nchan; ++i)
+            selNew[i] = i;
+    }
+
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
+
+    bool projAvailable = this->proj.size() != 0;
+
+    if (!projAvailable && this->comp.kind == -1)
+    {
+        tripletList.reserve(selNew.size());
+        for(i = 0; i < selNew.size(); ++i)
+            tripletList.push_back(T(i, selNew[i], this->cals[selNew[i]]));
+    }
+    else
+    {
+        //
+        //  Projection and compensation are dense, make the combined operator sparse afterwards
+        //
+        MatrixXd mult_full;
+        MatrixXd selVect(selNew.size(), nchan);
+
+        for(i = 0; i < selNew.size(); ++i) {
+            if(projAvailable)
+                selVect.row(i) = this->proj.row(selNew[i]);
+            else
+                selVect.row(i) = this->comp.data->data.row(selNew[i]);
+        }
+
+        if(projAvailable && this->comp.kind != -1)
+            mult_full = (selVect*this->comp.data->data.sparseView())*this->cals.asDiagonal();//The compensator is sparse, avoid the dense triple product
+        else
+            mult_full = selVect*this->cals.asDiagonal();
+
+        tripletList.reserve(mult_full.rows()*mult_full.cols());
+        for(i = 0; i < mult_full.rows(); ++i)
+            for(k = 0; k < mult_full.cols(); ++k)
+                if(mult_full(i,k) != 0)
+                    tripletList.push_back(T(i, k, mult_full(i,k)));
+    }
+
+    SparseMatrix<double> mult(selNew.size(), nchan);
+    mult.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    return mult;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::read_raw_buffer(qint32 iBuffer,
+                                  const SparseMatrix<double>& mult,
+                                  MatrixXd& data) const
+{
+    if(iBuffer < 0 || iBuffer >= this->rawdir.size()) {
+        qDebug() << "FiffRawData::read_raw_buffer - Buffer index" << iBuffer << "out of range";
+        return false;
+    }
+
+    const FiffRawDir& thisRawDir = this->rawdir[iBuffer];
+    qint32 nchan = this->info.nchan;
+
+    if (thisRawDir.ent->kind == -1)
+    {
+        //
+        //  Take the easy route: skip is translated to zeros
+        //
+        data = MatrixXd::Zero(mult.rows(), thisRawDir.nsamp);
+        return true;
+    }
+
+    if (!this->file->device()->isOpen())
+    {
+        if (!this->file->device()->open(QIODevice::ReadOnly))
+        {
+            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+            return false;
+        }
+    }
+
+    FiffTag::SPtr t_pTag;
+    if(!this->file->read_tag(t_pTag, thisRawDir.ent->pos))
+        return false;
+
+    if (t_pTag->type == FIFFT_DAU_PACK16)
+        data = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+    else if(t_pTag->type == FIFFT_INT)
+        data = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+    else if(t_pTag->type == FIFFT_FLOAT)
+        data = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+    else if(t_pTag->type == FIFFT_SHORT)
+        data = mult*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
+    else
+    {
+        printf("Data Storage Format not known jet [4]!! Type: %d\n", t_pTag->type);
+        return false;
+    }
+
+    return true;
+}
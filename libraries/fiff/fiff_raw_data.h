@@ -205,6 +205,32 @@ public:
                                 float to,
                                 const RowVectorXi& sel = defaultRowVectorXi) const;
 
+    //=========================================================================================================
+    /**
+    * Creates the operator which read_raw_buffer applies to each raw data buffer, i.e., the channel selection
+    * combined with the calibration, the compensator and the SSP projection. The operator only needs to be
+    * created once when reading many segments with the same channel selection.
+    *
+    * @param[in] sel        channel selection vector (optional)
+    *
+    * @return the operator (selected channels x all channels)
+    */
+    SparseMatrix<double> create_operator(const RowVectorXi& sel = defaultRowVectorXi) const;
+
+    //=========================================================================================================
+    /**
+    * Reads and decodes a single raw data buffer. Skip buffers are returned as zeros.
+    *
+    * @param[in] iBuffer    index of the buffer in rawdir
+    * @param[in] mult       the operator to apply to the buffer, see create_operator
+    * @param[out] data      returns the data matrix (rows of mult x samples of the buffer)
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_raw_buffer(qint32 iBuffer,
+                         const SparseMatrix<double>& mult,
+                         MatrixXd& data) const;
+
 public:
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
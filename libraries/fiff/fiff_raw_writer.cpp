@@ -0,0 +1,634 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_writer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawWriter class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_writer.h"
+#include "fiff_constants.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SYSTEM INCLUDES
+//=============================================================================================================
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+    const qint64 s_iDefaultSplitSize = 2000000000;              /**< Stay below the 2 GB limit of fif files. */
+    const qint64 s_iDefaultMaxPendingBytes = 512*1024*1024;     /**< About 30 s of a 400 channel system at 10 kHz. */
+    const int s_iMaxFreeBuffers = 8;                            /**< Staging buffers kept for reuse. */
+    const int s_iTagHeaderSize = 16;                            /**< kind, type, size and next of a tag. */
+
+    void writeTagHeader(char* header, fiff_int_t iKind, fiff_int_t iType, fiff_int_t iSize)
+    {
+        uchar* p = reinterpret_cast<uchar*>(header);
+        qToBigEndian<qint32>(iKind, p);
+        qToBigEndian<qint32>(iType, p + 4);
+        qToBigEndian<qint32>(iSize, p + 8);
+        qToBigEndian<qint32>(FIFFV_NEXT_SEQ, p + 12);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawWriter::FiffRawWriter(QObject *parent)
+: QThread(parent)
+, m_bOpen(false)
+, m_bStopRequested(false)
+, m_iPendingBytes(0)
+, m_iMaxPendingBytes(s_iDefaultMaxPendingBytes)
+, m_iDroppedBuffers(0)
+, m_iSamplesDropped(0)
+, m_iSamplesWritten(0)
+, m_iSplitSize(s_iDefaultSplitSize)
+, m_syncPolicy(SyncOnClose)
+, m_iSyncIntervalMSecs(1000)
+, m_bResetRange(false)
+, m_iFirstSample(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffRawWriter::~FiffRawWriter()
+{
+    close();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::open(const QString& sFileName, const FiffInfo& info, const MatrixXi& sel, fiff_int_t iFirstSample, bool resetRange)
+{
+    if(isOpen()) {
+        printf("FiffRawWriter::open - A recording is already in progress.\n");
+        return false;
+    }
+
+    m_info = info;
+    m_matSel = sel;
+    m_bResetRange = resetRange;
+    m_iFirstSample = iFirstSample;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queuePending.clear();
+        m_lFileNames.clear();
+        m_bStopRequested = false;
+        m_iPendingBytes = 0;
+        m_iDroppedBuffers = 0;
+        m_iSamplesDropped = 0;
+        m_iSamplesWritten = 0;
+    }
+
+    RowVectorXd cals;
+    if(!startFile(sFileName, iFirstSample, cals)) {
+        return false;
+    }
+    m_vecInvCals = cals.transpose().cwiseInverse();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bOpen = true;
+    }
+
+    start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::write(const MatrixXd& buf)
+{
+    if(!isOpen()) {
+        return false;
+    }
+
+    if(buf.rows() != m_vecInvCals.size()) {
+        printf("FiffRawWriter::write - buffer and calibration sizes do not match\n");
+        return false;
+    }
+
+    PendingBuffer buffer;
+    float* data = acquireBuffer(buf.rows(), buf.cols(), buffer);
+    if(!data) {
+        return false;
+    }
+
+    Map<MatrixXf>(data, buf.rows(), buf.cols()) = (m_vecInvCals.asDiagonal() * buf).cast<float>();
+
+    submitBuffer(buffer);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::writeUncalibrated(const MatrixXf& buf)
+{
+    PendingBuffer buffer;
+    float* data = acquireBuffer(buf.rows(), buf.cols(), buffer);
+    if(!data) {
+        return false;
+    }
+
+    Map<MatrixXf>(data, buf.rows(), buf.cols()) = buf;
+
+    submitBuffer(buffer);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::close()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if(!m_bOpen) {
+            return;
+        }
+        m_bOpen = false;
+        m_bStopRequested = true;
+        m_condition.wakeOne();
+    }
+
+    //The writer thread drains the queue and finishes the last file
+    wait();
+
+    m_pStream.clear();
+
+    if(m_iDroppedBuffers > 0) {
+        printf("FiffRawWriter::close - %d buffers could not be written.\n", m_iDroppedBuffers);
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bOpen;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::setSplitSize(qint64 iSplitSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_iSplitSize = iSplitSize;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawWriter::splitSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iSplitSize;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::setSyncPolicy(SyncPolicy policy, int iIntervalMSecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_syncPolicy = policy;
+    m_iSyncIntervalMSecs = iIntervalMSecs;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::setMaxPendingBytes(qint64 iMaxPendingBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_iMaxPendingBytes = iMaxPendingBytes;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawWriter::pendingBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iPendingBytes;
+}
+
+
+//*************************************************************************************************************
+
+int FiffRawWriter::droppedBuffers() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iDroppedBuffers;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawWriter::samplesDropped() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iSamplesDropped;
+}
+
+
+//*************************************************************************************************************
+
+qint64 FiffRawWriter::samplesWritten() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_iSamplesWritten;
+}
+
+
+//*************************************************************************************************************
+
+QStringList FiffRawWriter::fileNames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lFileNames;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::run()
+{
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+
+    //Samples dropped since the last written buffer, skipped in front of the next one
+    qint64 iSkipSamples = 0;
+
+    forever {
+        PendingBuffer buffer;
+        qint64 iSplitSize;
+        SyncPolicy syncPolicy;
+        int iSyncIntervalMSecs;
+
+        {
+            QMutexLocker locker(&m_mutex);
+            while(m_queuePending.isEmpty() && !m_bStopRequested) {
+                m_condition.wait(&m_mutex);
+            }
+
+            if(m_queuePending.isEmpty()) {
+                break;
+            }
+
+            buffer = m_queuePending.dequeue();
+            iSplitSize = m_iSplitSize;
+            syncPolicy = m_syncPolicy;
+            iSyncIntervalMSecs = m_iSyncIntervalMSecs;
+
+            //Buffers dropped by the producer, in queue order
+            if(buffer.data.isEmpty()) {
+                iSkipSamples += buffer.iNumSamples;
+                m_iSamplesDropped += buffer.iNumSamples;
+                continue;
+            }
+        }
+
+        //Continue in a new file before this buffer would cross the split size
+        bool bWritten = false;
+        if(m_pStream) {
+            if(m_file.pos() + buffer.data.size() > iSplitSize && m_iSamplesWritten > 0) {
+                //The first sample of the new file accounts for the dropped samples, nothing left to skip
+                splitFile();
+                iSkipSamples = 0;
+            }
+
+            if(m_pStream) {
+                qint64 iPos = m_file.pos();
+                qint32 iNumChannels = qint32((buffer.data.size() - s_iTagHeaderSize) / (4 * qint64(buffer.iNumSamples)));
+
+                bWritten = writeSkip(iSkipSamples, iNumChannels, buffer.iNumSamples)
+                           && m_file.write(buffer.data) == buffer.data.size();
+                if(bWritten) {
+                    iSkipSamples = 0;
+                } else {
+                    printf("FiffRawWriter::run - Could not write to %s: %s\n",
+                           m_file.fileName().toUtf8().constData(), m_file.errorString().toUtf8().constData());
+                    //Remove the incomplete tags, the skip is written again in front of the next buffer
+                    m_file.seek(iPos);
+                    m_file.resize(iPos);
+                }
+            }
+        }
+
+        if(!bWritten) {
+            iSkipSamples += buffer.iNumSamples;
+        }
+
+        if(syncPolicy == SyncPeriodically && syncTimer.elapsed() >= iSyncIntervalMSecs) {
+            syncFile();
+            syncTimer.restart();
+        }
+
+        QMutexLocker locker(&m_mutex);
+        m_iPendingBytes -= buffer.data.size();
+        if(bWritten) {
+            m_iSamplesWritten += buffer.iNumSamples;
+        } else {
+            ++m_iDroppedBuffers;
+            m_iSamplesDropped += buffer.iNumSamples;
+        }
+
+        //Hand the allocation back so that the next buffer of the same size can reuse it
+        if(m_lFreeBuffers.size() < s_iMaxFreeBuffers) {
+            m_lFreeBuffers.append(buffer.data);
+        }
+        buffer.data.clear();
+    }
+
+    finishFile();
+}
+
+
+//*************************************************************************************************************
+
+float* FiffRawWriter::acquireBuffer(qint32 iRows, qint32 iCols, PendingBuffer& buffer)
+{
+    qint64 iDataSize = qint64(iRows) * iCols * 4;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if(!m_bOpen) {
+            return NULL;
+        }
+
+        if(m_iPendingBytes + s_iTagHeaderSize + iDataSize > m_iMaxPendingBytes) {
+            if(m_iDroppedBuffers++ == 0) {
+                printf("FiffRawWriter - The disk does not keep up. Dropping buffers.\n");
+            }
+
+            //Queue a marker so that the writer thread skips the samples at the right position
+            if(!m_queuePending.isEmpty() && m_queuePending.last().data.isEmpty()) {
+                m_queuePending.last().iNumSamples += iCols;
+            } else {
+                PendingBuffer skip;
+                skip.iNumSamples = iCols;
+                m_queuePending.enqueue(skip);
+                m_condition.wakeOne();
+            }
+            return NULL;
+        }
+
+        if(!m_lFreeBuffers.isEmpty()) {
+            buffer.data = m_lFreeBuffers.takeLast();
+        }
+    }
+
+    buffer.data.resize(s_iTagHeaderSize + iDataSize);
+    buffer.iNumSamples = iCols;
+
+    writeTagHeader(buffer.data.data(), FIFF_DATA_BUFFER, FIFFT_FLOAT, fiff_int_t(iDataSize));
+
+    return reinterpret_cast<float*>(buffer.data.data() + s_iTagHeaderSize);
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::submitBuffer(PendingBuffer& buffer)
+{
+    FiffStream::float_to_big_endian(buffer.data.data() + s_iTagHeaderSize, qint64(buffer.data.size() - s_iTagHeaderSize) / 4);
+
+    QMutexLocker locker(&m_mutex);
+    m_iPendingBytes += buffer.data.size();
+    m_queuePending.enqueue(buffer);
+    buffer.data.clear();
+    m_condition.wakeOne();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::startFile(const QString& sFileName, fiff_int_t iFirstSample, RowVectorXd& cals)
+{
+    m_file.setFileName(sFileName);
+
+    //FiffStream::start_file does not report a failing open, check beforehand
+    if(!m_file.open(QIODevice::WriteOnly)) {
+        printf("FiffRawWriter::startFile - Could not open %s: %s\n",
+               sFileName.toUtf8().constData(), m_file.errorString().toUtf8().constData());
+        m_pStream.clear();
+        return false;
+    }
+    m_file.close();
+
+    m_pStream = FiffStream::start_writing_raw(m_file, m_info, cals, m_matSel, m_bResetRange);
+    m_pStream->write_int(FIFF_FIRST_SAMPLE, &iFirstSample);
+
+    QMutexLocker locker(&m_mutex);
+    m_lFileNames.append(sFileName);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::writeSkip(qint64 iSkipSamples, qint32 iNumChannels, qint32 iNumSamples)
+{
+    if(iSkipSamples <= 0 || iNumSamples <= 0) {
+        return true;
+    }
+
+    //The reader applies a skip to the size of the following buffer, hence the zeros come first
+    qint64 iRemainder = iSkipSamples % iNumSamples;
+    if(iRemainder > 0) {
+        qint64 iDataSize = qint64(iNumChannels) * iRemainder * 4;
+        QByteArray zeros(int(s_iTagHeaderSize + iDataSize), 0);
+        writeTagHeader(zeros.data(), FIFF_DATA_BUFFER, FIFFT_FLOAT, fiff_int_t(iDataSize));
+        if(m_file.write(zeros) != zeros.size()) {
+            return false;
+        }
+    }
+
+    fiff_int_t nskip = fiff_int_t(iSkipSamples / iNumSamples);
+    if(nskip > 0) {
+        m_pStream->resetStatus();
+        m_pStream->write_int(FIFF_DATA_SKIP, &nskip);
+        return m_pStream->status() == QDataStream::Ok;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawWriter::splitFile()
+{
+    QString sFirstFileName;
+    int iPart;
+    fiff_int_t iFirstSample;
+    {
+        QMutexLocker locker(&m_mutex);
+        sFirstFileName = m_lFileNames.first();
+        iPart = m_lFileNames.size();
+        iFirstSample = m_iFirstSample + fiff_int_t(m_iSamplesWritten + m_iSamplesDropped);
+    }
+
+    QString sNextFileName = splitFileName(sFirstFileName, iPart);
+
+    //Write the link to the next file
+    fiff_int_t data;
+    m_pStream->start_block(FIFFB_REF);
+    data = FIFFV_ROLE_NEXT_FILE;
+    m_pStream->write_int(FIFF_REF_ROLE, &data);
+    m_pStream->write_string(FIFF_REF_FILE_NAME, QFileInfo(sNextFileName).fileName());
+    m_pStream->write_id(FIFF_REF_FILE_ID);
+    data = iPart;
+    m_pStream->write_int(FIFF_REF_FILE_NUM, &data);
+    m_pStream->end_block(FIFFB_REF);
+
+    finishFile();
+
+    //The calibration does not change between the files of one recording
+    RowVectorXd cals;
+    return startFile(sNextFileName, iFirstSample, cals);
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::finishFile()
+{
+    if(!m_pStream) {
+        return;
+    }
+
+    m_pStream->end_block(FIFFB_RAW_DATA);
+    m_pStream->end_block(FIFFB_MEAS);
+    m_pStream->end_file();
+
+    SyncPolicy syncPolicy;
+    {
+        QMutexLocker locker(&m_mutex);
+        syncPolicy = m_syncPolicy;
+    }
+
+    if(syncPolicy != NoSync) {
+        syncFile();
+    }
+
+    m_pStream->close();
+    m_pStream.clear();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawWriter::syncFile()
+{
+    if(!m_file.isOpen()) {
+        return;
+    }
+
+    m_file.flush();
+
+#ifdef Q_OS_WIN
+    _commit(m_file.handle());
+#else
+    fsync(m_file.handle());
+#endif
+}
+
+
+//*************************************************************************************************************
+
+QString FiffRawWriter::splitFileName(const QString& sFileName, int iPart)
+{
+    QString sSuffix;
+    if(sFileName.endsWith("_raw.fif")) {
+        sSuffix = "_raw.fif";
+    } else if(sFileName.endsWith(".fif")) {
+        sSuffix = ".fif";
+    }
+
+    QString sBase = sFileName.left(sFileName.size() - sSuffix.size());
+
+    return QString("%1-%2%3").arg(sBase).arg(iPart).arg(sSuffix);
+}
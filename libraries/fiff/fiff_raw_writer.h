@@ -0,0 +1,373 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_writer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawWriter class declaration.
+*
+*/
+
+
+#ifndef FIFF_RAW_WRITER_H
+#define FIFF_RAW_WRITER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_info.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QQueue>
+#include <QByteArray>
+#include <QStringList>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//=============================================================================================================
+/**
+* FiffRawWriter records raw data to fif files without blocking the acquisition. The caller converts each buffer
+* to the on-disk float format into a reusable staging buffer and hands it to a writer thread, which does the
+* actual disk I/O and splits the recording into several files before the 2 GB fif limit is reached.
+*
+* @brief Streaming raw data writer with a background I/O thread.
+*/
+class FIFFSHARED_EXPORT FiffRawWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<FiffRawWriter> SPtr;             /**< Shared pointer type for FiffRawWriter. */
+    typedef QSharedPointer<const FiffRawWriter> ConstSPtr;  /**< Const shared pointer type for FiffRawWriter. */
+
+    //=========================================================================================================
+    /**
+    * When the written data are forced from the operating system cache to the disk.
+    */
+    enum SyncPolicy {
+        NoSync,             /**< Leave it to the operating system. */
+        SyncOnClose,        /**< Sync every file before it is closed. */
+        SyncPeriodically    /**< Sync in regular intervals and before a file is closed. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a FiffRawWriter.
+    *
+    * @param[in] parent     Parent QObject (optional)
+    */
+    explicit FiffRawWriter(QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the FiffRawWriter. An open recording is closed first.
+    */
+    ~FiffRawWriter();
+
+    //=========================================================================================================
+    /**
+    * Creates the file, writes the measurement info and starts the writer thread.
+    *
+    * @param[in] sFileName      The file to write. Split files get the suffix -1, -2, ... before _raw.fif or .fif.
+    * @param[in] info           The measurement info
+    * @param[in] sel            Which channels to write (default all)
+    * @param[in] iFirstSample   The first sample number of the recording
+    * @param[in] resetRange     Whether to reset the channel ranges to 1.0 in the written info
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool open(const QString& sFileName,
+              const FiffInfo& info,
+              const Eigen::MatrixXi& sel = defaultMatrixXi,
+              fiff_int_t iFirstSample = 0,
+              bool resetRange = false);
+
+    //=========================================================================================================
+    /**
+    * Queues a calibrated buffer for writing. The calibration of the selected channels is removed before the
+    * data are stored. Never waits for the disk.
+    *
+    * @param[in] buf    The buffer to write (channels x samples)
+    *
+    * @return true if the buffer was queued, false if the writer is closed or the queue is full
+    */
+    bool write(const Eigen::MatrixXd& buf);
+
+    //=========================================================================================================
+    /**
+    * Queues a buffer which already holds the raw values for writing. Never waits for the disk.
+    *
+    * @param[in] buf    The buffer to write (channels x samples)
+    *
+    * @return true if the buffer was queued, false if the writer is closed or the queue is full
+    */
+    bool writeUncalibrated(const Eigen::MatrixXf& buf);
+
+    //=========================================================================================================
+    /**
+    * Writes all queued buffers, finishes the current file and stops the writer thread.
+    */
+    void close();
+
+    //=========================================================================================================
+    /**
+    * Returns whether a recording is in progress.
+    *
+    * @return true if open, false otherwise
+    */
+    bool isOpen() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the size in bytes after which the recording continues in a new file.
+    *
+    * @param[in] iSplitSize     The split size
+    */
+    void setSplitSize(qint64 iSplitSize);
+
+    //=========================================================================================================
+    /**
+    * Returns the size in bytes after which the recording continues in a new file.
+    *
+    * @return the split size
+    */
+    qint64 splitSize() const;
+
+    //=========================================================================================================
+    /**
+    * Sets when the written data are synced to disk.
+    *
+    * @param[in] policy             The sync policy
+    * @param[in] iIntervalMSecs     Interval for SyncPeriodically in milliseconds
+    */
+    void setSyncPolicy(SyncPolicy policy, int iIntervalMSecs = 1000);
+
+    //=========================================================================================================
+    /**
+    * Sets how many bytes may wait for the disk. Buffers beyond this limit are dropped and counted.
+    *
+    * @param[in] iMaxPendingBytes   The limit in bytes
+    */
+    void setMaxPendingBytes(qint64 iMaxPendingBytes);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of bytes which were queued but are not written yet.
+    *
+    * @return the pending bytes
+    */
+    qint64 pendingBytes() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of buffers dropped since open() because the queue was full or the disk failed. The
+    * files mark the dropped samples with FIFF_DATA_SKIP, so that the following samples keep their numbers.
+    *
+    * @return the number of dropped buffers
+    */
+    int droppedBuffers() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples dropped since open() which the writer thread has accounted for.
+    *
+    * @return the number of dropped samples
+    */
+    qint64 samplesDropped() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples written to disk since open().
+    *
+    * @return the number of written samples
+    */
+    qint64 samplesWritten() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the names of all files of the current or last recording.
+    *
+    * @return the file names
+    */
+    QStringList fileNames() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * Writes queued buffers until close() is called and the queue is empty.
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * A staging buffer holding one complete FIFF_DATA_BUFFER tag in file byte order.
+    */
+    struct PendingBuffer {
+        QByteArray  data;           /**< Tag header and data, empty if the buffer marks dropped samples. */
+        qint32      iNumSamples;    /**< Number of samples in the buffer or number of dropped samples. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Takes a staging buffer from the pool and writes the tag header.
+    *
+    * @param[in] iRows      Number of channels
+    * @param[in] iCols      Number of samples
+    * @param[out] buffer    The staging buffer
+    *
+    * @return pointer to the float data in the staging buffer, NULL if the buffer has to be dropped
+    */
+    float* acquireBuffer(qint32 iRows, qint32 iCols, PendingBuffer& buffer);
+
+    //=========================================================================================================
+    /**
+    * Converts the floats to file byte order and queues the buffer for the writer thread.
+    *
+    * @param[in] buffer     The staging buffer filled by the caller
+    */
+    void submitBuffer(PendingBuffer& buffer);
+
+    //=========================================================================================================
+    /**
+    * Creates a file and writes the measurement info and the first sample number. Called by open() and in the
+    * writer thread for split files.
+    *
+    * @param[in] sFileName      The file to write
+    * @param[in] iFirstSample   The first sample number of this file
+    * @param[out] cals          The calibration factors of the selected channels
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool startFile(const QString& sFileName, fiff_int_t iFirstSample, Eigen::RowVectorXd& cals);
+
+    //=========================================================================================================
+    /**
+    * Writes the skip for dropped samples in front of the next buffer. FIFF_DATA_SKIP counts buffers of the size
+    * of the following buffer, a remainder is written as a buffer of zeros.
+    *
+    * @param[in] iSkipSamples   Number of dropped samples
+    * @param[in] iNumChannels   Number of channels of the next buffer
+    * @param[in] iNumSamples    Number of samples of the next buffer
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool writeSkip(qint64 iSkipSamples, qint32 iNumChannels, qint32 iNumSamples);
+
+    //=========================================================================================================
+    /**
+    * Finishes the current file and continues in the next split file.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool splitFile();
+
+    //=========================================================================================================
+    /**
+    * Finishes the current file.
+    */
+    void finishFile();
+
+    //=========================================================================================================
+    /**
+    * Forces the written data from the operating system cache to the disk.
+    */
+    void syncFile();
+
+    //=========================================================================================================
+    /**
+    * Returns the name of a split file.
+    *
+    * @param[in] sFileName  The name of the first file
+    * @param[in] iPart      The split index (> 0)
+    *
+    * @return the name of the split file
+    */
+    static QString splitFileName(const QString& sFileName, int iPart);
+
+    mutable QMutex              m_mutex;                /**< Guards the queue, the pool and the counters. */
+    QWaitCondition              m_condition;            /**< Wakes the writer thread. */
+    QQueue<PendingBuffer>       m_queuePending;         /**< Buffers waiting for the disk. */
+    QList<QByteArray>           m_lFreeBuffers;         /**< Staging buffers ready for reuse. */
+    bool                        m_bOpen;                /**< Whether a recording is in progress. */
+    bool                        m_bStopRequested;       /**< Whether the writer thread should drain and stop. */
+    qint64                      m_iPendingBytes;        /**< Bytes waiting for the disk. */
+    qint64                      m_iMaxPendingBytes;     /**< Limit of the bytes waiting for the disk. */
+    int                         m_iDroppedBuffers;      /**< Number of dropped buffers. */
+    qint64                      m_iSamplesDropped;      /**< Number of dropped samples, counted by the writer thread. */
+    qint64                      m_iSamplesWritten;      /**< Number of samples written to disk. */
+    QStringList                 m_lFileNames;           /**< Names of the written files. */
+
+    qint64                      m_iSplitSize;           /**< Size after which a new file is started. */
+    SyncPolicy                  m_syncPolicy;           /**< When to sync to disk. */
+    int                         m_iSyncIntervalMSecs;   /**< Interval for SyncPeriodically. */
+
+    FiffInfo                    m_info;                 /**< The measurement info written to every file. */
+    Eigen::MatrixXi             m_matSel;               /**< The selected channels. */
+    bool                        m_bResetRange;          /**< Whether to reset the channel ranges. */
+    Eigen::VectorXd             m_vecInvCals;           /**< Inverse calibration of the selected channels. */
+    fiff_int_t                  m_iFirstSample;         /**< First sample number of the recording. */
+
+    QFile                       m_file;                 /**< The file currently written. */
+    FiffStream::SPtr            m_pStream;              /**< The stream currently written. */
+};
+
+} // NAMESPACE FIFFLIB
+
+#endif // FIFF_RAW_WRITER_H
@@ -93,6 +93,7 @@
 
 #include <QFile>
 #include <QTcpSocket>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -1828,6 +1829,7 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
             if (nskip > 0)
             {
                 FiffRawDir t_RawDir;
+                t_RawDir.ent = FiffDirEntry::SPtr(new FiffDirEntry);//kind -1 marks the skip
                 t_RawDir.first = first_samp;
                 t_RawDir.last  = first_samp + nskip*nsamp - 1;//ToDo -1 right or is that MATLAB syntax
                 t_RawDir.nsamp = nskip*nsamp;
@@ -2637,15 +2639,27 @@ fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    //Convert the whole block at once instead of streaming element by element
+    QByteArray bytes(reinterpret_cast<const char*>(data), datasize);
+    float_to_big_endian(bytes.data(), nel);
+    this->writeRawData(bytes.constData(), datasize);
 
     return pos;
 }
 
 
+//*************************************************************************************************************
+
+void FiffStream::float_to_big_endian(char* data, qint64 nel)
+{
+    quint32 value;
+    for(qint64 i = 0; i < nel; ++i) {
+        memcpy(&value, data + 4*i, 4);
+        qToBigEndian(value, reinterpret_cast<uchar*>(data + 4*i));
+    }
+}
+
+
 //*************************************************************************************************************
 
 fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
@@ -3113,16 +3127,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
         return false;
     }
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(cals.cols());
-    for(qint32 i = 0; i < cals.cols(); ++i)
-        tripletList.push_back(T(i, i, 1.0/cals[i]));
-
-    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
-    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
-
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
+    MatrixXf tmp = (cals.cwiseInverse().asDiagonal()*buf).cast<float>();
     this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
     return true;
 }
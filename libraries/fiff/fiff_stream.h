@@ -716,6 +716,15 @@ public:
     */
     fiff_long_t write_float(fiff_int_t kind, const float* data, fiff_int_t nel = 1);
 
+    //=========================================================================================================
+    /**
+    * Converts single-precision floats in place from host to the big endian byte order of fif files.
+    *
+    * @param[in, out] data  The float data, stored as raw bytes
+    * @param[in] nel        Number of floats to convert
+    */
+    static void float_to_big_endian(char* data, qint64 nel);
+
     //=========================================================================================================
     /**
     * Writes a single-precision floating-point matrix tag
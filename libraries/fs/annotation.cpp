@@ -43,6 +43,8 @@
 #include "label.h"
 #include "surface.h"
 
+#include <utils/ioutils.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -69,6 +71,7 @@
 //=============================================================================================================
 
 using namespace FSLIB;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -188,14 +191,25 @@ bool Annotation::read(const QString& p_sFileName, Annotation &p_Annotation)
     qint32 numEl;
     t_Stream >> numEl;
 
-    p_Annotation.m_Vertices = VectorXi(numEl);
-    p_Annotation.m_LabelIds = VectorXi(numEl);
+    if(numEl < 0)
+    {
+        printf("\tError: Invalid number of annotated vertices\n");
+        return false;
+    }
 
-    for(qint32 i = 0; i < numEl; ++i)
+    //vertex/label pairs are read at once and byte swapped in bulk
+    Matrix<qint32, 2, Dynamic> t_matVertLabel(2, numEl);
+    if(t_Stream.readRawData((char *)t_matVertLabel.data(), numEl*2*sizeof(qint32)) != (int)(numEl*2*sizeof(qint32)))
     {
-        t_Stream >> p_Annotation.m_Vertices[i];
-        t_Stream >> p_Annotation.m_LabelIds[i];
+        printf("\tError: Unexpected end of the annotation file\n");
+        return false;
     }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    IOUtils::swap_intp(t_matVertLabel.data(), t_matVertLabel.size());
+#endif
+
+    p_Annotation.m_Vertices = t_matVertLabel.row(0).transpose();
+    p_Annotation.m_LabelIds = t_matVertLabel.row(1).transpose();
 
     qint32 hasColortable;
     t_Stream >> hasColortable;
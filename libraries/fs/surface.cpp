@@ -52,6 +52,8 @@
 #include <QFile>
 #include <QDataStream>
 #include <QTextStream>
+#include <QtConcurrent>
+#include <QFuture>
 
 
 //*************************************************************************************************************
@@ -144,48 +146,57 @@ void Surface::clear()
 MatrixX3f Surface::compute_normals(const MatrixX3f& rr, const MatrixX3i& tris)
 {
     printf("\tcomputing normals\n");
-    // first, compute triangle normals
-    MatrixX3f r1(tris.rows(),3); MatrixX3f r2(tris.rows(),3); MatrixX3f r3(tris.rows(),3);
 
-    for(qint32 i = 0; i < tris.rows(); ++i)
-    {
-        r1.row(i) = rr.row(tris(i, 0));
-        r2.row(i) = rr.row(tris(i, 1));
-        r3.row(i) = rr.row(tris(i, 2));
-    }
+    //blocks of triangles/vertices processed in parallel
+    const qint32 iBlockSize = 16384;
+    QList<QPair<qint32,qint32> > qListTriBlocks;
+    for(qint32 i = 0; i < tris.rows(); i += iBlockSize)
+        qListTriBlocks.append(qMakePair(i, qMin(i + iBlockSize, (qint32) tris.rows())));
+    QList<QPair<qint32,qint32> > qListVertBlocks;
+    for(qint32 i = 0; i < rr.rows(); i += iBlockSize)
+        qListVertBlocks.append(qMakePair(i, qMin(i + iBlockSize, (qint32) rr.rows())));
 
-    MatrixX3f x = r2 - r1;
-    MatrixX3f y = r3 - r1;
-    MatrixX3f tri_nn(x.rows(),y.cols());
-    tri_nn.col(0) = x.col(1).cwiseProduct(y.col(2)) - x.col(2).cwiseProduct(y.col(1));
-    tri_nn.col(1) = x.col(2).cwiseProduct(y.col(0)) - x.col(0).cwiseProduct(y.col(2));
-    tri_nn.col(2) = x.col(0).cwiseProduct(y.col(1)) - x.col(1).cwiseProduct(y.col(0));
+    // first, compute triangle normals and areas
+    MatrixX3f tri_nn(tris.rows(), 3);
 
-    //   Triangle normals and areas
-    MatrixX3f tmp = tri_nn.cwiseProduct(tri_nn);
-    VectorXf normSize = tmp.rowwise().sum();
-    normSize = normSize.cwiseSqrt();
+    QtConcurrent::blockingMap(qListTriBlocks, [&rr, &tris, &tri_nn](const QPair<qint32,qint32>& block) {
+        for(qint32 i = block.first; i < block.second; ++i)
+        {
+            RowVector3f r1 = rr.row(tris(i, 0));
+            RowVector3f x = rr.row(tris(i, 1)) - r1;
+            RowVector3f y = rr.row(tris(i, 2)) - r1;
 
-    for(qint32 i = 0; i < normSize.size(); ++i)
-        if(normSize(i) != 0)
-            tri_nn.row(i) /= normSize(i);
+            tri_nn(i, 0) = x(1) * y(2) - x(2) * y(1);
+            tri_nn(i, 1) = x(2) * y(0) - x(0) * y(2);
+            tri_nn(i, 2) = x(0) * y(1) - x(1) * y(0);
 
-    MatrixX3f nn = MatrixX3f::Zero(rr.rows(), 3);
+            float normSize = std::sqrt(tri_nn.row(i).squaredNorm());
+            if(normSize != 0)
+                tri_nn.row(i) /= normSize;
+        }
+    });
 
+    // every vertex takes the normal of the last triangle it belongs to
+    VectorXi vecLastTri = VectorXi::Constant(rr.rows(), -1);
     for(qint32 p = 0; p < tris.rows(); ++p)
-    {
-        Vector3i verts = tris.row(p);
-        for(qint32 j = 0; j < verts.size(); ++j)
-            nn.row(verts(j)) = tri_nn.row(p);
-    }
+        for(qint32 j = 0; j < 3; ++j)
+            vecLastTri(tris(p, j)) = p;
+
+    MatrixX3f nn = MatrixX3f::Zero(rr.rows(), 3);
+
+    QtConcurrent::blockingMap(qListVertBlocks, [&tri_nn, &vecLastTri, &nn](const QPair<qint32,qint32>& block) {
+        for(qint32 i = block.first; i < block.second; ++i)
+        {
+            if(vecLastTri(i) < 0)
+                continue;
 
-    tmp = nn.cwiseProduct(nn);
-    normSize = tmp.rowwise().sum();
-    normSize = normSize.cwiseSqrt();
+            nn.row(i) = tri_nn.row(vecLastTri(i));
 
-    for(qint32 i = 0; i < normSize.size(); ++i)
-        if(normSize(i) != 0)
-            nn.row(i) /= normSize(i);
+            float normSize = std::sqrt(nn.row(i).squaredNorm());
+            if(normSize != 0)
+                nn.row(i) /= normSize;
+        }
+    });
 
     return nn;
 }
@@ -263,9 +274,12 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     qint32 nvert = 0;
     qint32 nquad = 0;
     qint32 nface = 0;
-    MatrixXf verts;
-    MatrixXi faces;
+    MatrixXf verts;     // 3 x nvert, i.e., the vertex order of the file
+    MatrixXi faces;     // 3 x nface
 
+    //
+    //   All arrays are read at once and, on little endian hosts, byte swapped in bulk
+    //
     if(magic == QUAD_FILE_MAGIC_NUMBER || magic == NEW_QUAD_FILE_MAGIC_NUMBER)
     {
         nvert = IOUtils::fread3(t_DataStream);
@@ -276,69 +290,62 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
             printf("\t%s is a new quad file (nvert = %d nquad = %d)\n", p_sFile.toUtf8().constData(),nvert,nquad);
 
         //vertices
-        verts.resize(nvert, 3);
         if(magic == QUAD_FILE_MAGIC_NUMBER)
         {
-            qint16 iVal;
-            for(qint32 i = 0; i < nvert; ++i)
+            Matrix<qint16, Dynamic, Dynamic> iVerts(3, nvert);
+            if(t_DataStream.readRawData((char *)iVerts.data(), nvert*3*sizeof(qint16)) != (int)(nvert*3*sizeof(qint16)))
             {
-                for(qint32 j = 0; j < 3; ++j)
-                {
-                    t_DataStream >> iVal;
-                    IOUtils::swap_short(iVal);
-                    verts(i,j) = ((float)iVal) / 100;
-                }
+                qWarning("Unexpected end of surface file %s", p_sFile.toUtf8().constData());
+                return false;
             }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            IOUtils::swap_shortp(iVerts.data(), iVerts.size());
+#endif
+            verts = iVerts.cast<float>() / 100;
         }
         else
         {
-            t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
-            for(qint32 i = 0; i < nvert; ++i)
-                for(qint32 j = 0; j < 3; ++j)
-                    IOUtils::swap_floatp(&verts(i,j));
-        }
-
-        MatrixXi quads = IOUtils::fread3_many(t_DataStream, nquad*4);
-        MatrixXi quads_new(4, nquad);
-        qint32 count = 0;
-        for(qint32 j = 0; j < quads.cols(); ++j)
-        {
-            for(qint32 i = 0; i < quads.rows(); ++i)
+            verts.resize(3, nvert);
+            if(t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float)) != (int)(nvert*3*sizeof(float)))
             {
-                quads_new(i,j) = quads(count, 0);
-                ++count;
+                qWarning("Unexpected end of surface file %s", p_sFile.toUtf8().constData());
+                return false;
             }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            IOUtils::swap_floatp(verts.data(), verts.size());
+#endif
         }
-        quads = quads_new.transpose();
+
+        VectorXi quads = IOUtils::fread3_many(t_DataStream, nquad*4);
+        Map<MatrixXi> quads_new(quads.data(), 4, nquad);
         //
         //  Face splitting follows
         //
-        faces = MatrixXi::Zero(2*nquad,3);
+        faces = MatrixXi::Zero(3, 2*nquad);
         for(qint32 k = 0; k < nquad; ++k)
         {
-            RowVectorXi quad = quads.row(k);
-            if ((quad[0] % 2) == 0)
+            if ((quads_new(0,k) % 2) == 0)
             {
-                faces(nface,0) = quad[0];
-                faces(nface,1) = quad[1];
-                faces(nface,2) = quad[3];
+                faces(0,nface) = quads_new(0,k);
+                faces(1,nface) = quads_new(1,k);
+                faces(2,nface) = quads_new(3,k);
                 ++nface;
 
-                faces(nface,0) = quad[2];
-                faces(nface,1) = quad[3];
-                faces(nface,2) = quad[1];
+                faces(0,nface) = quads_new(2,k);
+                faces(1,nface) = quads_new(3,k);
+                faces(2,nface) = quads_new(1,k);
                 ++nface;
             }
             else
             {
-                faces(nface,0) = quad(0);
-                faces(nface,1) = quad(1);
-                faces(nface,2) = quad(2);
+                faces(0,nface) = quads_new(0,k);
+                faces(1,nface) = quads_new(1,k);
+                faces(2,nface) = quads_new(2,k);
                 ++nface;
 
-                faces(nface,0) = quad(0);
-                faces(nface,1) = quad(2);
-                faces(nface,2) = quad(3);
+                faces(0,nface) = quads_new(0,k);
+                faces(1,nface) = quads_new(2,k);
+                faces(2,nface) = quads_new(3,k);
                 ++nface;
             }
         }
@@ -350,31 +357,26 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
 
         t_DataStream >> nvert;
         t_DataStream >> nface;
-        IOUtils::swap_int(nvert);
-        IOUtils::swap_int(nface);
 
         printf("\t%s is a triangle file (nvert = %d ntri = %d)\n", p_sFile.toUtf8().constData(), nvert, nface);
         printf("\t%s", s.toUtf8().constData());
 
         //vertices
         verts.resize(3, nvert);
-        t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
-        for(qint32 i = 0; i < 3; ++i)
-            for(qint32 j = 0; j < nvert; ++j)
-                IOUtils::swap_floatp(&verts(i,j));
-
         //faces
-        faces.resize(nface, 3);
-        qint32 iVal;
-        for(qint32 i = 0; i < nface; ++i)
+        faces.resize(3, nface);
+
+        if(t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float)) != (int)(nvert*3*sizeof(float))
+                || t_DataStream.readRawData((char *)faces.data(), nface*3*sizeof(qint32)) != (int)(nface*3*sizeof(qint32)))
         {
-            for(qint32 j = 0; j < 3; ++j)
-            {
-                t_DataStream >> iVal;
-                IOUtils::swap_int(iVal);
-                faces(i,j) = iVal;
-            }
+            qWarning("Unexpected end of surface file %s", p_sFile.toUtf8().constData());
+            return false;
         }
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        IOUtils::swap_floatp(verts.data(), verts.size());
+        IOUtils::swap_intp(faces.data(), faces.size());
+#endif
     }
     else
     {
@@ -382,14 +384,10 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
         return false;
     }
 
-    verts.transposeInPlace();
     verts.array() *= 0.001f;
 
-    p_Surface.m_matRR = verts.block(0,0,verts.rows(),3);
-    p_Surface.m_matTris = faces.block(0,0,faces.rows(),3);
-
-    //-> not needed since qglbuilder is doing that for us
-    p_Surface.m_matNN = compute_normals(p_Surface.m_matRR, p_Surface.m_matTris);
+    p_Surface.m_matRR = verts.transpose();
+    p_Surface.m_matTris = faces.transpose();
 
     // hemi info
     if(t_File.fileName().contains("lh."))
@@ -405,6 +403,9 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     //Loaded surface
     p_Surface.m_sSurf = t_File.fileName().mid((t_NameIdx+3),t_File.fileName().size() - (t_NameIdx+3));
 
+    //-> not needed since qglbuilder is doing that for us; computed in the background while the curvature is read
+    QFuture<MatrixX3f> t_futureNormals = QtConcurrent::run(&Surface::compute_normals, p_Surface.m_matRR, p_Surface.m_matTris);
+
     //Load curvature
     if(p_bLoadCurvature)
     {
@@ -413,6 +414,8 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
         p_Surface.m_vecCurv = Surface::read_curv(t_sCurvatureFile);
     }
 
+    p_Surface.m_matNN = t_futureNormals.result();
+
     t_File.close();
     printf("\tRead a surface with %d vertices from %s\n[done]\n",nvert,p_sFile.toUtf8().constData());
 
@@ -449,23 +452,36 @@ VectorXf Surface::read_curv(const QString &p_sFileName)
         t_DataStream >> fnum;
         t_DataStream >> vals_per_vertex;
 
+        if(vnum < 0)
+        {
+            printf("\tError: Invalid number of vertices in the curvature file\n");
+            return VectorXf();
+        }
+
         curv.resize(vnum, 1);
-        t_DataStream.readRawData((char *)curv.data(), vnum*sizeof(float));
-        for(qint32 i = 0; i < vnum; ++i)
-           IOUtils::swap_floatp(&curv(i));
+        if(t_DataStream.readRawData((char *)curv.data(), vnum*sizeof(float)) != (int)(vnum*sizeof(float)))
+        {
+            printf("\tError: Unexpected end of the curvature file\n");
+            return VectorXf();
+        }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        IOUtils::swap_floatp(curv.data(), vnum);
+#endif
     }
     else
     {
         qint32 fnum = IOUtils::fread3(t_DataStream);
         Q_UNUSED(fnum)
-        qint16 iVal;
-        curv.resize(vnum, 1);
-        for(qint32 i = 0; i < vnum; ++i)
+        Matrix<qint16, Dynamic, 1> iCurv(vnum);
+        if(t_DataStream.readRawData((char *)iCurv.data(), vnum*sizeof(qint16)) != (int)(vnum*sizeof(qint16)))
         {
-            t_DataStream >> iVal;
-            IOUtils::swap_short(iVal);
-            curv(i) = ((float)iVal) / 100;
+            printf("\tError: Unexpected end of the curvature file\n");
+            return VectorXf();
         }
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        IOUtils::swap_shortp(iCurv.data(), vnum);
+#endif
+        curv = iCurv.cast<float>() / 100;
     }
     t_File.close();
 
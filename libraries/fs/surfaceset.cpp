@@ -47,6 +47,8 @@
 //=============================================================================================================
 
 #include <QStringList>
+#include <QtConcurrent>
+#include <QFuture>
 
 
 //*************************************************************************************************************
@@ -80,10 +82,14 @@ SurfaceSet::SurfaceSet(const QString &subject_id, qint32 hemi, const QString &su
     }
     else if(hemi == 2)
     {
+        //both hemispheres are read concurrently
+        Surface t_SurfaceRH;
+        QFuture<bool> t_futureRH = QtConcurrent::run([&]() { return Surface::read(subject_id, 1, surf, subjects_dir, t_SurfaceRH); });
+
         if(Surface::read(subject_id, 0, surf, subjects_dir, t_Surface))
             insert(t_Surface);
-        if(Surface::read(subject_id, 1, surf, subjects_dir, t_Surface))
-            insert(t_Surface);
+        if(t_futureRH.result())
+            insert(t_SurfaceRH);
     }
 
     calcOffset();
@@ -102,10 +108,14 @@ SurfaceSet::SurfaceSet(const QString &path, qint32 hemi, const QString &surf)
     }
     else if(hemi == 2)
     {
+        //both hemispheres are read concurrently
+        Surface t_SurfaceRH;
+        QFuture<bool> t_futureRH = QtConcurrent::run([&]() { return Surface::read(path, 1, surf, t_SurfaceRH); });
+
         if(Surface::read(path, 0, surf, t_Surface))
             insert(t_Surface);
-        if(Surface::read(path, 1, surf, t_Surface))
-            insert(t_Surface);
+        if(t_futureRH.result())
+            insert(t_SurfaceRH);
     }
 
     calcOffset();
@@ -178,10 +188,21 @@ bool SurfaceSet::read(const QString& p_sLHFileName, const QString& p_sRHFileName
     QStringList t_qListFileName;
     t_qListFileName << p_sLHFileName << p_sRHFileName;
 
+    //both hemispheres are read concurrently
+    Surface t_SurfaceLH, t_SurfaceRH;
+    QFuture<bool> t_futureRH = QtConcurrent::run([&]() { return Surface::read(p_sRHFileName, t_SurfaceRH); });
+    bool t_bReadLH = Surface::read(p_sLHFileName, t_SurfaceLH);
+    bool t_bReadRH = t_futureRH.result();
+
+    QList<Surface> t_qListSurfaces;
+    t_qListSurfaces << t_SurfaceLH << t_SurfaceRH;
+    QList<bool> t_qListRead;
+    t_qListRead << t_bReadLH << t_bReadRH;
+
     for(qint32 i = 0; i < t_qListFileName.size(); ++i)
     {
-        Surface t_Surface;
-        if(Surface::read(t_qListFileName[i], t_Surface))
+        const Surface& t_Surface = t_qListSurfaces.at(i);
+        if(t_qListRead.at(i))
         {
             if(t_qListFileName[i].contains("lh."))
                 p_SurfaceSet.m_qMapSurfs.insert(0, t_Surface);
@@ -2316,7 +2316,9 @@ int mne_proj_op_make_proj_bad(MneProjOp* op, char **bad, int nbad)
 #endif
 
     FREE_CMATRIX_3(op->proj_data);
+    FREE_3(op->proj_work);
     op->proj_data = NULL;
+    op->proj_work = NULL;
     op->nvec      = 0;
 
     if (op->nch <= 0)
@@ -2453,6 +2455,7 @@ int mne_proj_op_make_proj_bad(MneProjOp* op, char **bad, int nbad)
     fprintf(stderr,"Number of linearly independent vectors = %d\n",op->nvec);
 #endif
     op->proj_data = ALLOC_CMATRIX_3(op->nvec,op->nch);
+    op->proj_work = MALLOC_3(op->nch,float);
 #ifdef DEBUG
     fprintf(stdout,"Final projection data:\n");
 #endif
@@ -247,6 +247,29 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
 }
 
 
+//*************************************************************************************************************
+
+bool MinimumNorm::calculateInverse(const MatrixXd &data,
+                                   float tmin,
+                                   float tstep,
+                                   MNEChunkedSourceEstimateWriter &writer,
+                                   qint32 iBlockSize) const
+{
+    iBlockSize = qMax(1, iBlockSize);
+
+    for(qint32 t = 0; t < data.cols(); t += iBlockSize) {
+        const qint32 n = qMin(iBlockSize, static_cast<qint32>(data.cols()) - t);
+
+        MNESourceEstimate stc = calculateInverse(data.middleCols(t, n), tmin + t * tstep, tstep);
+        if(stc.isEmpty() || !writer.append(stc)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
@@ -45,6 +45,7 @@
 #include "../IInverseAlgorithm.h"
 
 #include <mne/mne_inverse_operator.h>
+#include <mne/mne_chunked_sourceestimate_writer.h>
 #include <fs/label.h>
 
 #include <QSharedPointer>
@@ -127,6 +128,25 @@ public:
 
     virtual MNESourceEstimate calculateInverse(const MatrixXd &data, float tmin, float tstep) const;
 
+    //=========================================================================================================
+    /**
+    * Computes the inverse solution block by block and streams it to a chunked source estimate file. The full
+    * source estimate is never held in memory. doInverseSetup has to be called before.
+    *
+    * @param[in] data           The sensor data [n_channels x n_times].
+    * @param[in] tmin           The time of the first sample in seconds.
+    * @param[in] tstep          The time step in seconds.
+    * @param[in] writer         The writer the solution is appended to. It is finished by the caller.
+    * @param[in] iBlockSize     The number of samples computed at once.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool calculateInverse(const MatrixXd &data,
+                          float tmin,
+                          float tstep,
+                          MNEChunkedSourceEstimateWriter &writer,
+                          qint32 iBlockSize = 1024) const;
+
     virtual void doInverseSetup(qint32 nave, bool pick_normal = false);
 
 
@@ -251,6 +251,7 @@ MneProjOp::MneProjOp()
 , nch (0)
 , nvec (0)
 , proj_data (NULL)
+, proj_work (NULL)
 {
 
 }
@@ -266,7 +267,8 @@ MneProjOp::~MneProjOp()
             delete items[k];
 
     // mne_free_proj_op_proj
-
+    FREE_CMATRIX_23(proj_data);
+    FREE_23(proj_work);
 }
 
 
@@ -278,11 +280,13 @@ void MneProjOp::mne_free_proj_op_proj(MneProjOp *op)
         return;
 
     FREE_CMATRIX_23(op->proj_data);
+    FREE_23(op->proj_work);
 
     op->names.clear();
     op->nch  = 0;
     op->nvec = 0;
     op->proj_data = NULL;
+    op->proj_work = NULL;
 
     return;
 }
@@ -474,14 +478,14 @@ int MneProjOp::mne_proj_op_affect_chs(MneProjOp *op, fiffChInfo chs, int nch)
 
 //*************************************************************************************************************
 
-int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int do_complement)
+int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int do_complement, float *work)
 /*
     * Apply projection operator to a vector (floats)
     * Assume that all dimension checking etc. has been done before
+    * Threads projecting at the same time must provide their own work space
     */
 {
-    static float *res = NULL;
-    int    res_size   = 0;
+    float *res;
     float *pvec;
     float  w;
     int k,p;
@@ -494,11 +498,13 @@ int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int
         return FAIL;
     }
 
-    if (op->nch > res_size) {
-        res = REALLOC_23(res,op->nch,float);
-        res_size = op->nch;
+    if (work)
+        res = work;
+    else {
+        if (!op->proj_work)
+            op->proj_work = MALLOC_23(op->nch,float);
+        res = op->proj_work;
     }
-
     for (k = 0; k < op->nch; k++)
         res[k] = 0.0;
 
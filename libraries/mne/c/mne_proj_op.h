@@ -139,7 +139,20 @@ public:
     static int mne_proj_op_affect_chs(MneProjOp* op, FIFFLIB::fiffChInfo chs, int nch);
 
 
-    static int mne_proj_op_proj_vector(MneProjOp* op, float *vec, int nvec, int do_complement);
+    //=========================================================================================================
+    /**
+    * Apply the projection operator to a vector. The work space must hold nch values. If it is not given,
+    * the work space owned by the operator is used, which is not safe if several threads project at once.
+    *
+    * @param[in] op             The projection operator.
+    * @param[in, out] vec       The vector to project.
+    * @param[in] nvec           The length of vec.
+    * @param[in] do_complement  Apply the complement (I - P) instead of P.
+    * @param[in] work           Optional caller provided work space.
+    *
+    * @return OK or FAIL.
+    */
+    static int mne_proj_op_proj_vector(MneProjOp* op, float *vec, int nvec, int do_complement, float *work = NULL);
 
 
 
@@ -174,6 +187,7 @@ public:
     int         nch;                    /* Number of channels in the final projector */
     int         nvec;                   /* Number of vectors in the final projector */
     float**     proj_data;            /* The orthogonalized projection vectors picked and orthogonalized from the original data */
+    float*      proj_work;            /* Work space of nch values for mne_proj_op_proj_vector, allocated with proj_data */
 
 //// ### OLD STRUCT ###
 //typedef struct {                            /* Collection of projection items and the projector itself */
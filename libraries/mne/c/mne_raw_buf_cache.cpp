@@ -0,0 +1,368 @@
+//=============================================================================================================
+/**
+* @file     mne_raw_buf_cache.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MneRawBufCache Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_raw_buf_cache.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/*
+ * This used to be the compile-time ring buffer size of MNE-C
+ */
+static qint64 default_memory_budget = 600*1024*1024;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MneRawBufCache::View::View()
+: m_pCache(NULL)
+, m_pEntry(NULL)
+{
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::View::View(MneRawBufCache* p_pCache, Entry* p_pEntry)
+: m_pCache(p_pCache)
+, m_pEntry(p_pEntry)
+{
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::View::View(const View& p_View)
+: m_pCache(p_View.m_pCache)
+, m_pEntry(p_View.m_pEntry)
+{
+    if(m_pEntry)
+        m_pCache->ref(m_pEntry);
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::View::~View()
+{
+    release();
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::View& MneRawBufCache::View::operator=(const View& p_View)
+{
+    if(this != &p_View) {
+        if(p_View.m_pEntry)
+            p_View.m_pCache->ref(p_View.m_pEntry);
+        release();
+        m_pCache = p_View.m_pCache;
+        m_pEntry = p_View.m_pEntry;
+    }
+    return *this;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::View::release()
+{
+    if(m_pEntry)
+        m_pCache->unref(m_pEntry);
+    m_pCache = NULL;
+    m_pEntry = NULL;
+}
+
+
+//*************************************************************************************************************
+
+bool MneRawBufCache::View::isValid() const
+{
+    return m_pEntry && m_pEntry->valid.load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+QMutex* MneRawBufCache::View::fillLock() const
+{
+    return m_pEntry ? &m_pEntry->fill : NULL;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::View::setValid(bool valid) const
+{
+    if(m_pEntry)
+        m_pEntry->valid.store(valid ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::MneRawBufCache(qint64 p_iMemoryBudget, int p_iNumShards)
+: m_iMemoryBudget(p_iMemoryBudget < 0 ? defaultMemoryBudget() : p_iMemoryBudget)
+{
+    if(p_iNumShards < 1)
+        p_iNumShards = 1;
+
+    for(int k = 0; k < p_iNumShards; ++k) {
+        Shard* s = new Shard;
+        s->usage  = 0;
+        s->budget = m_iMemoryBudget/p_iNumShards;
+        s->tick   = 0;
+        m_qListShards.append(s);
+    }
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::~MneRawBufCache()
+{
+    clear();
+    qDeleteAll(m_qListShards);
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::View MneRawBufCache::pin(const void* p_pKey, int nrow, int ncol)
+{
+    Shard& s = shard(p_pKey);
+    QMutexLocker locker(&s.lock);
+
+    Entry* e = s.entries.value(p_pKey, NULL);
+    if(e && (e->nrow != nrow || e->ncol != ncol)) {
+        /*
+         * The buffer layout changed, the old data are of no use
+         */
+        s.entries.remove(p_pKey);
+        s.usage -= e->bytes;
+        if(e->pins > 0)
+            e->detached = true;
+        else
+            free_entry(e);
+        e = NULL;
+    }
+    if(!e) {
+        e = new Entry;
+        e->key      = p_pKey;
+        e->shard    = &s;
+        e->nrow     = nrow;
+        e->ncol     = ncol;
+        e->bytes    = (qint64)nrow*ncol*sizeof(float) + nrow*sizeof(float*);
+        e->data     = new float[(size_t)nrow*ncol];
+        e->rows     = new float*[nrow];
+        e->pins     = 0;
+        e->detached = false;
+        e->valid.store(0);
+        for(int j = 0; j < nrow; ++j)
+            e->rows[j] = e->data + (size_t)j*ncol;
+
+        s.entries.insert(p_pKey, e);
+        s.usage += e->bytes;
+    }
+    e->pins++;
+    e->lastUse = ++s.tick;
+
+    evict(s);
+
+    return View(this, e);
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::clear()
+{
+    for(int k = 0; k < m_qListShards.size(); ++k) {
+        Shard* s = m_qListShards[k];
+        QMutexLocker locker(&s->lock);
+
+        QHash<const void*, Entry*>::iterator it;
+        for(it = s->entries.begin(); it != s->entries.end(); ++it) {
+            if(it.value()->pins > 0)
+                it.value()->detached = true;
+            else
+                free_entry(it.value());
+        }
+        s->entries.clear();
+        s->usage = 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::setMemoryBudget(qint64 p_iMemoryBudget)
+{
+    m_iMemoryBudget = p_iMemoryBudget;
+
+    for(int k = 0; k < m_qListShards.size(); ++k) {
+        Shard* s = m_qListShards[k];
+        QMutexLocker locker(&s->lock);
+        s->budget = m_iMemoryBudget/m_qListShards.size();
+        evict(*s);
+    }
+}
+
+
+//*************************************************************************************************************
+
+qint64 MneRawBufCache::memoryUsage() const
+{
+    qint64 usage = 0;
+
+    for(int k = 0; k < m_qListShards.size(); ++k) {
+        const Shard* s = m_qListShards[k];
+        QMutexLocker locker(&s->lock);
+        usage += s->usage;
+    }
+    return usage;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::setDefaultMemoryBudget(qint64 p_iMemoryBudget)
+{
+    default_memory_budget = p_iMemoryBudget;
+}
+
+
+//*************************************************************************************************************
+
+qint64 MneRawBufCache::defaultMemoryBudget()
+{
+    return default_memory_budget;
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::Shard& MneRawBufCache::shard(const void* p_pKey)
+{
+    return *m_qListShards[qHash(p_pKey) % (uint)m_qListShards.size()];
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::ref(Entry* p_pEntry)
+{
+    QMutexLocker locker(&p_pEntry->shard->lock);
+    p_pEntry->pins++;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::unref(Entry* p_pEntry)
+{
+    Shard* s = p_pEntry->shard;
+    QMutexLocker locker(&s->lock);
+
+    if(--p_pEntry->pins > 0)
+        return;
+    if(p_pEntry->detached)
+        free_entry(p_pEntry);
+    else
+        evict(*s);
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::evict(Shard& p_shard)
+{
+    while(p_shard.usage > p_shard.budget) {
+        /*
+         * Find the least recently used buffer which is not pinned
+         */
+        Entry* victim = NULL;
+        QHash<const void*, Entry*>::const_iterator it;
+        for(it = p_shard.entries.constBegin(); it != p_shard.entries.constEnd(); ++it) {
+            if(it.value()->pins == 0 && (!victim || it.value()->lastUse < victim->lastUse))
+                victim = it.value();
+        }
+        if(!victim)
+            return;             /* Everything is in use, the budget is exceeded temporarily */
+
+        p_shard.entries.remove(victim->key);
+        p_shard.usage -= victim->bytes;
+        free_entry(victim);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::free_entry(Entry* p_pEntry)
+{
+    delete[] p_pEntry->rows;
+    delete[] p_pEntry->data;
+    delete p_pEntry;
+}
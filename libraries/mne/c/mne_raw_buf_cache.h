@@ -0,0 +1,317 @@
+//=============================================================================================================
+/**
+* @file     mne_raw_buf_cache.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MneRawBufCache class declaration.
+*
+*/
+
+
+#ifndef MNERAWBUFCACHE_H
+#define MNERAWBUFCACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../mne_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class MneRawData;
+
+
+//=============================================================================================================
+/**
+* Thread-safe cache of loaded raw data buffers (Replaces the ring buffer of MNE-C mne_ringbuffer.c).
+* The cache is split into shards which are locked independently and share the memory budget evenly.
+* Buffers which are not pinned by a View are evicted in least recently used order once a shard
+* exceeds its share of the budget.
+*
+* @brief Sharded LRU cache of raw data buffers
+*/
+class MNESHARED_EXPORT MneRawBufCache
+{
+private:
+    struct Entry;
+
+public:
+    typedef QSharedPointer<MneRawBufCache> SPtr;              /**< Shared pointer type for MneRawBufCache. */
+    typedef QSharedPointer<const MneRawBufCache> ConstSPtr;   /**< Const shared pointer type for MneRawBufCache. */
+
+    //=========================================================================================================
+    /**
+    * Pinned, read-only view of one cached buffer. The buffer is not evicted as long as a view refers to it.
+    * Only MneRawData may fill the buffer, and only while holding the fill lock.
+    */
+    class MNESHARED_EXPORT View
+    {
+    public:
+        //=====================================================================================================
+        /**
+        * Constructs a null view
+        */
+        View();
+
+        //=====================================================================================================
+        /**
+        * Copy constructor, pins the buffer once more
+        *
+        * @param[in] p_View     The view to copy
+        */
+        View(const View& p_View);
+
+        //=====================================================================================================
+        /**
+        * Destroys the view and releases the pin
+        */
+        ~View();
+
+        //=====================================================================================================
+        /**
+        * Assignment, releases the current pin and pins the buffer of p_View
+        *
+        * @param[in] p_View     The view to assign
+        *
+        * @return this view
+        */
+        View& operator=(const View& p_View);
+
+        //=====================================================================================================
+        /**
+        * Releases the pin, the view is null afterwards
+        */
+        void release();
+
+        inline bool isNull() const;
+
+        //=====================================================================================================
+        /**
+        * @return true if the buffer holds loaded data
+        */
+        bool isValid() const;
+
+        inline int nrow() const;
+        inline int ncol() const;
+
+        //=====================================================================================================
+        /**
+        * @return the rows of the buffer, nrow() pointers to ncol() values each
+        */
+        inline const float* const* rows() const;
+
+    private:
+        friend class MneRawBufCache;
+        friend class MneRawData;
+
+        View(MneRawBufCache* p_pCache, Entry* p_pEntry);
+
+        inline float** vals() const;
+        QMutex* fillLock() const;
+        void setValid(bool valid) const;
+
+        MneRawBufCache* m_pCache;   /**< The cache owning the entry */
+        Entry*          m_pEntry;   /**< The pinned entry */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs the cache
+    *
+    * @param[in] p_iMemoryBudget    Maximum amount of buffer memory in bytes (the default budget if negative)
+    * @param[in] p_iNumShards       Number of independently locked shards
+    */
+    explicit MneRawBufCache(qint64 p_iMemoryBudget = -1, int p_iNumShards = 16);
+
+    //=========================================================================================================
+    /**
+    * Destroys the cache. No views may be alive at this point.
+    */
+    ~MneRawBufCache();
+
+    //=========================================================================================================
+    /**
+    * Looks up the buffer identified by p_pKey and pins it. A new, invalid buffer of the requested size is
+    * allocated if the key is not yet cached.
+    *
+    * @param[in] p_pKey     Identifies the buffer, usually the MneRawBufDef it belongs to
+    * @param[in] nrow       Number of rows (channels)
+    * @param[in] ncol       Number of columns (samples)
+    *
+    * @return the pinned view
+    */
+    View pin(const void* p_pKey, int nrow, int ncol);
+
+    //=========================================================================================================
+    /**
+    * Drops all buffers. Buffers still pinned are detached and freed when their last view is released.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Sets the memory budget and evicts buffers which exceed the new budget
+    *
+    * @param[in] p_iMemoryBudget    Maximum amount of buffer memory in bytes
+    */
+    void setMemoryBudget(qint64 p_iMemoryBudget);
+
+    inline qint64 memoryBudget() const;
+
+    //=========================================================================================================
+    /**
+    * @return the amount of memory currently held by cached buffers in bytes
+    */
+    qint64 memoryUsage() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the memory budget used by caches constructed without an explicit budget
+    *
+    * @param[in] p_iMemoryBudget    Maximum amount of buffer memory in bytes
+    */
+    static void setDefaultMemoryBudget(qint64 p_iMemoryBudget);
+
+    static qint64 defaultMemoryBudget();
+
+private:
+    struct Shard {
+        mutable QMutex lock;                /**< Guards the entries and the usage of this shard */
+        QHash<const void*, Entry*> entries; /**< The cached buffers */
+        qint64 usage;                       /**< Bytes held by the entries */
+        qint64 budget;                      /**< Share of the memory budget in bytes */
+        quint64 tick;                       /**< Use counter for the LRU order */
+    };
+
+    Shard& shard(const void* p_pKey);
+    void ref(Entry* p_pEntry);
+    void unref(Entry* p_pEntry);
+    void evict(Shard& p_shard);             /**< Call with the shard locked */
+    static void free_entry(Entry* p_pEntry);
+
+    QVector<Shard*> m_qListShards;          /**< The shards */
+    qint64 m_iMemoryBudget;                 /**< Budget over all shards in bytes */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+struct MneRawBufCache::Entry {
+    const void* key;        /**< The key of this buffer */
+    Shard*      shard;      /**< The shard this entry lives in */
+    float*      data;       /**< nrow x ncol values */
+    float**     rows;       /**< Row pointers into data */
+    int         nrow;       /**< Number of rows */
+    int         ncol;       /**< Number of columns */
+    qint64      bytes;      /**< Memory held by this entry */
+    int         pins;       /**< Number of views, guarded by the shard lock */
+    bool        detached;   /**< Removed from the shard while pinned */
+    quint64     lastUse;    /**< Tick of the last pin */
+    QMutex      fill;       /**< Held while the data are being loaded or modified */
+    QAtomicInt  valid;      /**< Are the data meaningful? */
+};
+
+
+//*************************************************************************************************************
+
+inline bool MneRawBufCache::View::isNull() const
+{
+    return m_pEntry == NULL;
+}
+
+
+//*************************************************************************************************************
+
+inline int MneRawBufCache::View::nrow() const
+{
+    return m_pEntry ? m_pEntry->nrow : 0;
+}
+
+
+//*************************************************************************************************************
+
+inline int MneRawBufCache::View::ncol() const
+{
+    return m_pEntry ? m_pEntry->ncol : 0;
+}
+
+
+//*************************************************************************************************************
+
+inline const float* const* MneRawBufCache::View::rows() const
+{
+    return m_pEntry ? m_pEntry->rows : NULL;
+}
+
+
+//*************************************************************************************************************
+
+inline float** MneRawBufCache::View::vals() const
+{
+    return m_pEntry ? m_pEntry->rows : NULL;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 MneRawBufCache::memoryBudget() const
+{
+    return m_iMemoryBudget;
+}
+
+} // NAMESPACE MNELIB
+
+#endif // MNERAWBUFCACHE_H
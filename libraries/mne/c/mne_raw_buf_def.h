@@ -113,10 +113,8 @@ public:
     int   ns;               /* Number of samples (last - first + 1) */
     int   nchan;            /* Number of channels */
     int   is_skip;          /* Is this a skip? */
-    float **vals;           /* Values (null if not in memory) */
-    int   valid;            /* Are the data meaningful? */
-    int   *ch_filtered;     /* For filtered buffers: has this channel filtered already */
-    int   comp_status;      /* For raw buffers: compensation status */
+    int   *ch_filtered;     /* For filtered buffers: has this channel filtered already (guarded by the fill lock) */
+    int   comp_status;      /* For raw buffers: compensation status (guarded by the fill lock) */
 
 
 //// ### OLD STRUCT ###
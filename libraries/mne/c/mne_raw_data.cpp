@@ -41,6 +41,7 @@
 #include "mne_raw_data.h"
 
 #include <QFile>
+#include <QMutexLocker>
 
 #include <Eigen/Core>
 
@@ -164,37 +165,6 @@ void mne_free_cmatrix_36 (float **m)
 
 
 
-typedef struct {
-    int   size;		        /* Size of this buffer in floats */
-    float *data;			/* The allocated buffer */
-    float ***datap;		/* The matrix which uses this */
-} *ringBufBuf_36,ringBufBufRec_36;
-
-typedef struct {
-    ringBufBuf_36 *bufs;
-    int        nbuf;
-    int        next;
-} *ringBuf_36,ringBufRec_36;
-
-
-
-void mne_free_ring_buffer_36(void *thisp)
-
-{
-    int k;
-    ringBuf_36 this_buf = (ringBuf_36)thisp;
-
-    if (!this_buf)
-        return;
-
-    for (k = 0; k < this_buf->nbuf; k++)
-        FREE_36(this_buf->bufs[k]->data);
-    FREE_36(this_buf->bufs);
-    FREE_36(this_buf);
-    return;
-}
-
-
 void mne_free_event(mneEvent e)
 {
     if (!e)
@@ -637,100 +607,6 @@ void mne_create_filter_response(mneFilterDef    filter,
 
 
 
-//============================= mne_ringbuffer.c =============================
-
-typedef struct {
-    int   size;		        /* Size of this buffer in floats */
-    float *data;			/* The allocated buffer */
-    float ***datap;		/* The matrix which uses this */
-} *ringBufBuf,ringBufBufRec;
-
-typedef struct {
-    ringBufBuf *bufs;
-    int        nbuf;
-    int        next;
-} *ringBuf,ringBufRec;
-
-
-void mne_free_ring_buffer(void *thisp)
-
-{
-    int k;
-    ringBuf this_buf = (ringBuf)thisp;
-
-    if (!this_buf)
-        return;
-
-    for (k = 0; k < this_buf->nbuf; k++)
-        FREE_36(this_buf->bufs[k]->data);
-    FREE_36(this_buf->bufs);
-    FREE_36(this_buf);
-    return;
-}
-
-void *mne_initialize_ring(int nbuf)
-
-{
-    int k;
-    ringBuf ring;
-
-    ring = MALLOC_36(1,ringBufRec);
-    ring->bufs = MALLOC_36(nbuf,ringBufBuf);
-    ring->nbuf = nbuf;
-
-    for (k = 0; k < nbuf; k++) {
-        ring->bufs[k] = MALLOC_36(1,ringBufBufRec);
-        ring->bufs[k]->size  = 0;
-        ring->bufs[k]->data  = NULL;
-        ring->bufs[k]->datap = NULL;
-    }
-    ring->next = 0;
-
-#ifdef DEBUG
-    fprintf(stderr,"Ring buffer structure with %d entries initialized\n",ring->nbuf);
-#endif
-
-    return ring;
-}
-
-void mne_allocate_from_ring(void *ringp, int nrow, int ncol, float ***res)
-/*
- * Get a new buffer
- */
-{
-    float **mat;
-    int   j;
-    ringBufBuf buf;
-    ringBuf    ring = (ringBuf)ringp;
-
-    if (ring->next > ring->nbuf-1)
-        ring->next = 0;
-
-#ifdef DEBUG
-    fprintf(stderr,"Allocating buf # %d\n",ring->next);
-#endif
-
-    buf = ring->bufs[ring->next++];
-
-    if (buf->datap) {		/* Clear the reference */
-        FREE_36(*buf->datap);
-        *buf->datap = NULL;
-    }
-    *res = mat = MALLOC_36(nrow,float *);
-    if (buf->size < nrow*ncol)
-        buf->data = REALLOC_36(buf->data,nrow*ncol,float);
-
-    for (j = 0; j < nrow; j++)
-        mat[j] = buf->data + j*ncol;
-
-    buf->datap = res;
-
-    return;
-}
-
-
-
-
 //============================= mne_raw_routines.c =============================
 
 
@@ -974,12 +850,6 @@ int  mne_sparse_mat_mult2(FiffSparseMatrix* mat,     /* The sparse matrix */
 
 
 
-#define APPROX_RING_BUF_SIZE (600*1024*1024)
-
-static int approx_ring_buf_size = APPROX_RING_BUF_SIZE;
-
-
-
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -998,8 +868,8 @@ MneRawData::MneRawData()
 ,event_list(NULL)
 ,max_event(0)
 ,dig_trigger_mask(0)
-,ring(NULL)
-,filt_ring(NULL)
+,cache(NULL)
+,filt_cache(NULL)
 ,filt_bufs(NULL)
 ,nfilt_buf(0)
 ,first_sample_val(NULL)
@@ -1031,10 +901,10 @@ MneRawData::~MneRawData()
     this->ch_names.clear();
 
     MneRawBufDef::free_bufs(this->bufs,this->nbuf);
-    mne_free_ring_buffer_36(this->ring);
+    delete this->cache;
 
     MneRawBufDef::free_bufs(this->filt_bufs,this->nfilt_buf);
-    mne_free_ring_buffer_36(this->filt_ring);
+    delete this->filt_cache;
 
     if(this->proj)
         delete this->proj;
@@ -1107,14 +977,16 @@ void MneRawData::setup_filter_bufs(MneRawData *data)
     MneRawBufDef* bufs;
     int       j,k;
     int       firstsamp;
-    int       nring_buf;
     int       highpass_effective;
 
+    /*
+     * The cache is keyed by the buffer definitions which are about to go away
+     */
+    if (data->filt_cache)
+        data->filt_cache->clear();
     MneRawBufDef::free_bufs(data->filt_bufs,data->nfilt_buf);
     data->filt_bufs = NULL;
     data->nfilt_buf = 0;
-    mne_free_ring_buffer(data->filt_ring);
-    data->filt_ring = NULL;
 
     if (!data || !data->filter)
         return;
@@ -1136,8 +1008,6 @@ void MneRawData::setup_filter_bufs(MneRawData *data)
         //        bufs[k].ent         = NULL;
         bufs[k].nchan       = data->info->nchan;
         bufs[k].is_skip     = FALSE;
-        bufs[k].vals        = NULL;
-        bufs[k].valid       = FALSE;
         bufs[k].ch_filtered = MALLOC_36(data->info->nchan,int);
         bufs[k].comp_status = MNE_CTFV_NOGRAD;
 
@@ -1146,9 +1016,8 @@ void MneRawData::setup_filter_bufs(MneRawData *data)
     }
     data->filt_bufs = bufs;
     data->nfilt_buf = nfilt_buf;
-    nring_buf       = approx_ring_buf_size/((2*filter->taper_size+filter->size)*
-                                            data->info->nchan*sizeof(float));
-    data->filt_ring = mne_initialize_ring(nring_buf);
+    if (!data->filt_cache)
+        data->filt_cache = new MneRawBufCache;
     mne_raw_add_filter_response(data,&highpass_effective);
 
     return;
@@ -1157,45 +1026,62 @@ void MneRawData::setup_filter_bufs(MneRawData *data)
 
 //*************************************************************************************************************
 
-int MneRawData::load_one_buffer(MneRawData *data, MneRawBufDef *buf)
+int MneRawData::load_one_buffer(MneRawData *data, MneRawBufDef *buf, MneRawBufCache::View& view)
 /*
      * load just one
      */
 {
+    int res;
+
+    view.release();
     if (buf->ent->kind == FIFF_DATA_SKIP) {
         printf("Cannot load a skip");
         return FAIL;
     }
-    if (!buf->vals) {		/* The data space may have been reused */
-        buf->valid = FALSE;
-        mne_allocate_from_ring(data->ring, buf->nchan,buf->ns,&buf->vals);
-    }
-    if (buf->valid)
-        return OK;
-
+    view = data->cache->pin(buf,buf->nchan,buf->ns);
+    /*
+       * Whoever gets here first loads the data, the others wait
+       */
+    view.fillLock()->lock();
+    if (!view.isValid()) {
 #ifdef DEBUG
-    fprintf(stderr,"Read buffer %d .. %d\n",buf->firsts,buf->lasts);
+        fprintf(stderr,"Read buffer %d .. %d\n",buf->firsts,buf->lasts);
 #endif
+        data->read_lock.lock();
+        res = mne_read_raw_buffer_t(data->stream,
+                                    buf->ent,
+                                    view.vals(),
+                                    buf->nchan,
+                                    buf->ns,
+                                    data->info->chInfo,
+                                    NULL,0);
+        data->read_lock.unlock();
+        if (res != OK)
+            goto bad;
+        buf->comp_status = data->comp_file;
+        view.setValid(true);
+    }
+    /*
+       * Apply compensation
+       */
+    if (compensate_buffer(data,buf,view) != OK) {
+        view.setValid(false);
+        goto bad;
+    }
+    view.fillLock()->unlock();
+    return OK;
 
-    if (mne_read_raw_buffer_t(data->stream,
-                              buf->ent,
-                              buf->vals,
-                              buf->nchan,
-                              buf->ns,
-                              data->info->chInfo,
-                              NULL,0) != OK) {
-        buf->valid = FALSE;
+bad : {
+        view.fillLock()->unlock();
+        view.release();
         return FAIL;
     }
-    buf->valid       = TRUE;
-    buf->comp_status = data->comp_file;
-    return OK;
 }
 
 
 //*************************************************************************************************************
 
-int MneRawData::compensate_buffer(MneRawData *data, MneRawBufDef *buf)
+int MneRawData::compensate_buffer(MneRawData *data, MneRawBufDef *buf, const MneRawBufCache::View& view)
 /*
      * Apply compensation channels
      */
@@ -1208,11 +1094,12 @@ int MneRawData::compensate_buffer(MneRawData *data, MneRawBufDef *buf)
         return OK;
     if (buf->comp_status == data->comp_now)
         return OK;
-    if (!buf->vals)
+    if (view.isNull())
         return OK;
     /*
-       * Have to do the hard job
+       * Have to do the hard job, the current and undo operators are swapped temporarily
        */
+    QMutexLocker locker(&data->proc_lock);
     if (data->comp->undo) {
         temp = data->comp->current;
         data->comp->current = data->comp->undo;
@@ -1220,7 +1107,7 @@ int MneRawData::compensate_buffer(MneRawData *data, MneRawBufDef *buf)
         /*
          * Undo the previous compensation
          */
-        if (MneCTFCompDataSet::mne_apply_ctf_comp_t(data->comp,FALSE,buf->vals,data->info->nchan,buf->ns) != OK) {
+        if (MneCTFCompDataSet::mne_apply_ctf_comp_t(data->comp,FALSE,view.vals(),data->info->nchan,buf->ns) != OK) {
             temp                = data->comp->undo;
             data->comp->undo    = data->comp->current;
             data->comp->current = temp;
@@ -1234,7 +1121,7 @@ int MneRawData::compensate_buffer(MneRawData *data, MneRawBufDef *buf)
         /*
          * Apply new compensation
          */
-        if (MneCTFCompDataSet::mne_apply_ctf_comp_t(data->comp,TRUE,buf->vals,data->info->nchan,buf->ns) != OK)
+        if (MneCTFCompDataSet::mne_apply_ctf_comp_t(data->comp,TRUE,view.vals(),data->info->nchan,buf->ns) != OK)
             goto bad;
     }
     buf->comp_status = data->comp_now;
@@ -1245,6 +1132,19 @@ bad :
 }
 
 
+//*************************************************************************************************************
+
+int MneRawData::mne_raw_pin_buffer(MneRawData *data, int k, MneRawBufCache::View& view)
+{
+    view.release();
+    if (!data || k < 0 || k >= data->nbuf) {
+        printf("Buffer index out of range");
+        return FAIL;
+    }
+    return load_one_buffer(data,&data->bufs[k],view);
+}
+
+
 //*************************************************************************************************************
 
 int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firsts, int ns, float **picked)
@@ -1255,6 +1155,8 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
     int          k,s,p,start,c,fills;
     int          ns2,s2;
     MneRawBufDef* this_buf;
+    MneRawBufCache::View view;
+    float        **vals;
     float        *values;
     int          need_some;
 
@@ -1312,15 +1214,13 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
             }
             else {
                 /*
-             * Load the buffer
-             */
-                if (load_one_buffer(data,this_buf) != OK)
-                    return FAIL;
-                /*
-             * Apply compensation
+             * Load and compensate the buffer
              */
-                if (compensate_buffer(data,this_buf) != OK)
+                if (load_one_buffer(data,this_buf,view) != OK) {
+                    FREE_CMATRIX_36(deriv_vals);
                     return FAIL;
+                }
+                vals = view.vals();
                 ns2 = s2 = 0;
                 if (sel) {
                     /*
@@ -1333,7 +1233,7 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
                             nderiv      = data->deriv_matched->deriv_data->nrow;
                             deriv_ns    = this_buf->ns;
                         }
-                        if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,this_buf->vals,this_buf->ns,deriv_vals) == FAIL) {
+                        if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,vals,this_buf->ns,deriv_vals) == FAIL) {
                             FREE_CMATRIX_36(deriv_vals);
                             return FAIL;
                         }
@@ -1343,7 +1243,7 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
                  * First pick the ordinary channels...
                  */
                         if (sel->pick[c] >= 0) {
-                            values = this_buf->vals[sel->pick[c]];
+                            values = vals[sel->pick[c]];
                             for (p = start, s2 = s, ns2 = ns; p < this_buf->ns && ns2 > 0; p++, ns2--, s2++)
                                 picked[c][s2] = values[p];
                         }
@@ -1360,7 +1260,7 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
                 else {
                     for (c = 0; c < data->info->nchan; c++)
                         for (p = start, s2 = s, ns2 = ns; p < this_buf->ns && ns2 > 0; p++, ns2--, s2++)
-                            picked[c][s2] = this_buf->vals[c][p];
+                            picked[c][s2] = vals[c][p];
                 }
                 s  = s2;
                 ns = ns2;
@@ -1407,8 +1307,10 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
 {
     int          k,s,p,start,c,fills;
     MneRawBufDef* this_buf;
+    MneRawBufCache::View view;
     float        **values;
     float        *pvalues;
+    float        *pwork;
     float        *deriv_pvalues = NULL;
 
     if (!data->proj || (sel && !MneProjOp::mne_proj_op_affect(data->proj,sel->chspick,sel->nchan) && !MneProjOp::mne_proj_op_affect(data->proj,sel->chspick_nospace,sel->nchan)))
@@ -1428,7 +1330,11 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
     }
     else
         s = 0;
+    /*
+       * Own projection work space, several threads may pick at once
+       */
     pvalues = MALLOC_36(data->info->nchan,float);
+    pwork   = MALLOC_36(data->info->nchan,float);
     for (k = 0, this_buf = data->bufs; k < data->nbuf; k++, this_buf++) {
         if (this_buf->lasts >= firsts) {
             start = firsts - this_buf->firsts;
@@ -1449,30 +1355,33 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
             }
             else {
                 /*
-             * Load the buffer
-             */
-                if (load_one_buffer(data,this_buf) != OK)
-                    return FAIL;
-                /*
-             * Apply compensation
+             * Load and compensate the buffer
              */
-                if (compensate_buffer(data,this_buf) != OK)
+                if (load_one_buffer(data,this_buf,view) != OK) {
+                    FREE_36(deriv_pvalues);
+                    FREE_36(pwork);
+                    FREE_36(pvalues);
                     return FAIL;
+                }
                 /*
              * Apply projection
              */
-                values = this_buf->vals;
-                if (sel && sel->nderiv > 0 && data->deriv_matched)
+                values = view.vals();
+                if (sel && sel->nderiv > 0 && data->deriv_matched && !deriv_pvalues)
                     deriv_pvalues = MALLOC_36(data->deriv_matched->deriv_data->nrow,float);
                 for (p = start; p < this_buf->ns && ns > 0; p++, ns--, s++) {
                     for (c = 0; c < data->info->nchan; c++)
                         pvalues[c] = values[c][p];
-                    if (MneProjOp::mne_proj_op_proj_vector(data->proj,pvalues,data->info->nchan,TRUE) != OK)
+                    if (MneProjOp::mne_proj_op_proj_vector(data->proj,pvalues,data->info->nchan,TRUE,pwork) != OK)
                         qWarning()<<"Error";
                     if (sel) {
                         if (sel->nderiv > 0 && data->deriv_matched) {
-                            if (mne_sparse_vec_mult2(data->deriv_matched->deriv_data->data,pvalues,deriv_pvalues) == FAIL)
+                            if (mne_sparse_vec_mult2(data->deriv_matched->deriv_data->data,pvalues,deriv_pvalues) == FAIL) {
+                                FREE_36(deriv_pvalues);
+                                FREE_36(pwork);
+                                FREE_36(pvalues);
                                 return FAIL;
+                            }
                         }
                         for (c = 0; c < sel->nchan; c++) {
                             /*
@@ -1499,6 +1408,7 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
         }
     }
     FREE_36(deriv_pvalues);
+    FREE_36(pwork);
     FREE_36(pvalues);
     /*
        * Extend with the last available sample or zero if the request is beyond the data
@@ -1530,7 +1440,7 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
 
 //*************************************************************************************************************
 
-int MneRawData::load_one_filt_buf(MneRawData *data, MneRawBufDef *buf)
+int MneRawData::load_one_filt_buf(MneRawData *data, MneRawBufDef *buf, MneRawBufCache::View& view)
 /*
      * Load and filter one buffer
      */
@@ -1540,17 +1450,18 @@ int MneRawData::load_one_filt_buf(MneRawData *data, MneRawBufDef *buf)
 
     float **vals;
 
-    if (!buf->vals) {
-        buf->valid = FALSE;
-        mne_allocate_from_ring(data->filt_ring, buf->nchan, buf->ns,&buf->vals);
-    }
-    if (buf->valid)
+    view.release();
+    view = data->filt_cache->pin(buf,buf->nchan,buf->ns);
+    view.fillLock()->lock();
+    if (view.isValid()) {
+        view.fillLock()->unlock();
         return OK;
+    }
 
     vals = MALLOC_36(buf->nchan,float *);
     for (k = 0; k < buf->nchan; k++) {
         buf->ch_filtered[k] = FALSE;
-        vals[k] = buf->vals[k] + data->filter->taper_size;
+        vals[k] = view.vals()[k] + data->filter->taper_size;
     }
 
     res = mne_raw_pick_data_proj(data,NULL,buf->firsts + data->filter->taper_size,buf->ns - 2*data->filter->taper_size,vals);
@@ -1562,7 +1473,10 @@ int MneRawData::load_one_filt_buf(MneRawData *data, MneRawBufDef *buf)
         fprintf(stderr,"Loaded filtered buffer %d...%d %d %d last = %d\n",
                 buf->firsts,buf->lasts,buf->lasts-buf->firsts+1,buf->ns,data->first_samp + data->nsamp);
 #endif
-    buf->valid = res == OK;
+    view.setValid(res == OK);
+    view.fillLock()->unlock();
+    if (res != OK)
+        view.release();
     return res;
 }
 
@@ -1577,13 +1491,16 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
     int          k,s,bs,c;
     int          bs1,bs2,s1,s2,lasts;
     MneRawBufDef* this_buf;
+    MneRawBufCache::View view;
+    float        **vals;
     float        *values;
     float        **deriv_vals = NULL;
     float        *dc          = NULL;
     float        dc_offset;
     int          deriv_ns     = 0;
     int          nderiv       = 0;
-    int          filter_was;
+    mneFilterDef this_filter;
+    mneFilterDefRec no_filter;
 
     if (!data->filter || !data->filter->filter_on)
         return mne_raw_pick_data_proj(data,sel,firsts,ns,picked);
@@ -1613,11 +1530,20 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
         if (data->comp && data->comp->current)
             if (MneCTFCompDataSet::mne_apply_ctf_comp(data->comp,TRUE,dc,data->info->nchan,NULL,0) != OK)
                 goto bad;
-        if (data->proj)
-            if (MneProjOp::mne_proj_op_proj_vector(data->proj,dc,data->info->nchan,TRUE) != OK)
+        if (data->proj) {
+            float *dc_work = MALLOC_36(data->info->nchan,float);
+            int   res      = MneProjOp::mne_proj_op_proj_vector(data->proj,dc,data->info->nchan,TRUE,dc_work);
+            FREE_36(dc_work);
+            if (res != OK)
                 goto bad;
+        }
     }
-    filter_was = data->filter->filter_on;
+    /*
+       * Stimulus channels are only zero padded. Use a copy of the filter definition for them
+       * rather than switching the shared one off and on.
+       */
+    no_filter           = *data->filter;
+    no_filter.filter_on = FALSE;
     /*
        * Find the first buffer to consider
        */
@@ -1632,11 +1558,15 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
         /*
          * Load the buffer first and apply projection
          */
-        if (load_one_filt_buf(data,this_buf) != OK)
+        if (load_one_filt_buf(data,this_buf,view) != OK)
             goto bad;
+        vals = view.vals();
         /*
-         * Then filter all relevant channels (not stimuli)
+         * Then filter all relevant channels (not stimuli). The channels are filtered in place and
+         * the filter work space is shared, hence both locks.
          */
+        view.fillLock()->lock();
+        data->proc_lock.lock();
         if (sel) {
             for (c = 0; c < sel->nchan; c++) {
                 if (sel->pick[c] >= 0) {
@@ -1644,18 +1574,19 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
                         /*
                  * Do not filter stimulus channels
                  */
-                        dc_offset = 0.0;
+                        dc_offset   = 0.0;
+                        this_filter = data->filter;
                         if (data->info->chInfo[sel->pick[c]].kind == FIFFV_STIM_CH)
-                            data->filter->filter_on = FALSE;
+                            this_filter = &no_filter;
                         else if (dc)
                             dc_offset = dc[sel->pick[c]];
-                        if (mne_apply_filter(data->filter,data->filter_data,this_buf->vals[sel->pick[c]],this_buf->ns,TRUE,
+                        if (mne_apply_filter(this_filter,data->filter_data,vals[sel->pick[c]],this_buf->ns,TRUE,
                                              dc_offset,data->info->chInfo[sel->pick[c]].kind) != OK) {
-                            data->filter->filter_on = filter_was;
+                            data->proc_lock.unlock();
+                            view.fillLock()->unlock();
                             goto bad;
                         }
                         this_buf->ch_filtered[sel->pick[c]] = TRUE;
-                        data->filter->filter_on = filter_was;
                     }
                 }
             }
@@ -1670,18 +1601,19 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
                         /*
                  * Do not filter stimulus channels
                  */
-                        dc_offset = 0.0;
+                        dc_offset   = 0.0;
+                        this_filter = data->filter;
                         if (data->info->chInfo[c].kind == FIFFV_STIM_CH)
-                            data->filter->filter_on = FALSE;
+                            this_filter = &no_filter;
                         else if (dc)
                             dc_offset = dc[c];
-                        if (mne_apply_filter(data->filter,data->filter_data,this_buf->vals[c],this_buf->ns,TRUE,
+                        if (mne_apply_filter(this_filter,data->filter_data,vals[c],this_buf->ns,TRUE,
                                              dc_offset,data->info->chInfo[c].kind) != OK) {
-                            data->filter->filter_on = filter_was;
+                            data->proc_lock.unlock();
+                            view.fillLock()->unlock();
                             goto bad;
                         }
                         this_buf->ch_filtered[c] = TRUE;
-                        data->filter->filter_on = filter_was;
                     }
                 }
             }
@@ -1695,21 +1627,24 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
                     /*
                * Do not filter stimulus channels
                */
-                    dc_offset = 0.0;
+                    dc_offset   = 0.0;
+                    this_filter = data->filter;
                     if (data->info->chInfo[c].kind == FIFFV_STIM_CH)
-                        data->filter->filter_on = FALSE;
+                        this_filter = &no_filter;
                     else if (dc)
                         dc_offset = dc[c];
-                    if (mne_apply_filter(data->filter,data->filter_data,this_buf->vals[c],this_buf->ns,TRUE,
+                    if (mne_apply_filter(this_filter,data->filter_data,vals[c],this_buf->ns,TRUE,
                                          dc_offset,data->info->chInfo[c].kind) != OK) {
-                        data->filter->filter_on = filter_was;
+                        data->proc_lock.unlock();
+                        view.fillLock()->unlock();
                         goto bad;
                     }
                     this_buf->ch_filtered[c] = TRUE;
-                    data->filter->filter_on = filter_was;
                 }
             }
         }
+        data->proc_lock.unlock();
+        view.fillLock()->unlock();
         /*
          * Decide the picking limits
          */
@@ -1747,7 +1682,7 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
                     nderiv      = data->deriv_matched->deriv_data->nrow;
                     deriv_ns    = this_buf->ns;
                 }
-                if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,this_buf->vals,this_buf->ns,deriv_vals) == FAIL)
+                if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,vals,this_buf->ns,deriv_vals) == FAIL)
                     goto bad;
             }
             for (c = 0; c < sel->nchan; c++) {
@@ -1755,7 +1690,7 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
              * First the ordinary channels
              */
                 if (sel->pick[c] >= 0) {
-                    values = this_buf->vals[sel->pick[c]];
+                    values = vals[sel->pick[c]];
                     for (s = s1, bs = bs1; s < s2; s++, bs++)
                         picked[c][s] += values[bs];
                 }
@@ -1768,7 +1703,7 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
         }
         else {
             for (c = 0; c < data->info->nchan; c++) {
-                values = this_buf->vals[c];
+                values = vals[c];
                 for (s = s1, bs = bs1; s < s2; s++, bs++)
                     picked[c][s] += values[bs];
             }
@@ -1954,8 +1889,6 @@ MneRawData *MneRawData::mne_raw_open_file_comp(const QString& name, int omit_ski
             bufs[nbuf].ent         = dir0[k];
             bufs[nbuf].nchan       = data->info->nchan;
             bufs[nbuf].is_skip     = dir0[k]->kind == FIFF_DATA_SKIP;
-            bufs[nbuf].vals        = NULL;
-            bufs[nbuf].valid       = FALSE;
             bufs[nbuf].ch_filtered = NULL;
             bufs[nbuf].comp_status = data->comp_file;
             nbuf++;
@@ -2022,8 +1955,7 @@ MneRawData *MneRawData::mne_raw_open_file_comp(const QString& name, int omit_ski
     /*
        * Initialize the raw data buffers
        */
-    nbuf = approx_ring_buf_size/(data->info->buf_size*data->info->nchan*sizeof(float));
-    data->ring = mne_initialize_ring(nbuf);
+    data->cache = new MneRawBufCache;
     /*
        * Initialize the filter buffers
        */
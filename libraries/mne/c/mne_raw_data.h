@@ -47,6 +47,7 @@
 #include <fiff/fiff_stream.h>
 #include "mne_raw_info.h"
 #include "mne_raw_buf_def.h"
+#include "mne_raw_buf_cache.h"
 #include "mne_proj_op.h"
 #include "mne_sss_data.h"
 #include "mne_ctf_comp_data_set.h"
@@ -70,6 +71,7 @@
 
 #include <QSharedPointer>
 #include <QList>
+#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -125,11 +127,43 @@ public:
 
 
 
-    static int load_one_buffer(MneRawData* data, MneRawBufDef* buf);
-
+    //=========================================================================================================
+    /**
+    * Pins a raw data buffer in the buffer cache and loads and compensates it unless this has been done already.
+    * Safe to call from several threads at once.
+    *
+    * @param[in] data   The raw data
+    * @param[in] buf    The buffer to load
+    * @param[out] view  The pinned buffer
+    *
+    * @return OK or FAIL
+    */
+    static int load_one_buffer(MneRawData* data, MneRawBufDef* buf, MneRawBufCache::View& view);
 
+    //=========================================================================================================
+    /**
+    * Brings the compensation of a buffer up to date. Call with the fill lock of the view held.
+    *
+    * @param[in] data   The raw data
+    * @param[in] buf    The buffer definition
+    * @param[in] view   The pinned buffer
+    *
+    * @return OK or FAIL
+    */
+    static int compensate_buffer(MneRawData* data, MneRawBufDef* buf, const MneRawBufCache::View& view);
 
-    static int compensate_buffer(MneRawData* data, MneRawBufDef* buf);
+    //=========================================================================================================
+    /**
+    * Read-only access to a loaded and compensated raw data buffer. The data stay in memory as long as the view
+    * is alive.
+    *
+    * @param[in] data   The raw data
+    * @param[in] k      Index of the buffer in data->bufs
+    * @param[out] view  The pinned buffer
+    *
+    * @return OK or FAIL
+    */
+    static int mne_raw_pin_buffer(MneRawData* data, int k, MneRawBufCache::View& view);
 
 
     static int mne_raw_pick_data(MneRawData*    data,
@@ -145,7 +179,7 @@ public:
                                int            ns,
                                float          **picked);
 
-    static int load_one_filt_buf(MneRawData* data, MneRawBufDef* buf);
+    static int load_one_filt_buf(MneRawData* data, MneRawBufDef* buf, MneRawBufCache::View& view);
 
 
 
@@ -194,8 +228,10 @@ public:
     QString         dig_trigger;        /* Name of the digital trigger channel */
     unsigned int     dig_trigger_mask;  /* Mask applied to digital trigger channel before considering it */
     float            *offsets;          /* Dc offset corrections for display */
-    void             *ring;             /* The ringbuffer (structure is of no interest to us) */
-    void             *filt_ring;        /* Separate ring buffer for filtered data */
+    MNELIB::MneRawBufCache* cache;      /* Cache of loaded raw data buffers */
+    MNELIB::MneRawBufCache* filt_cache; /* Separate cache for filtered data */
+    QMutex           read_lock;         /* Serializes reading from the stream */
+    QMutex           proc_lock;         /* Serializes compensation and filtering which modify shared state */
     MNELIB::MneDerivSet*  deriv;        /* Derivation data */
     MNELIB::MneDeriv*     deriv_matched;/* Derivation data matched to this raw data and collected into a single item */
     float            *deriv_offsets;        /* Dc offset corrections for display of the derived channels */
@@ -0,0 +1,383 @@
+//=============================================================================================================
+/**
+* @file     mne_surface_bvh.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MneSurfaceBvh Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_surface_bvh.h"
+#include "mne_surface_old.h"
+#include "mne_triangle.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+
+#define X_BVH 0
+#define Y_BVH 1
+#define Z_BVH 2
+
+#define VEC_DOT_BVH(x,y) ((x)[X_BVH]*(y)[X_BVH] + (x)[Y_BVH]*(y)[Y_BVH] + (x)[Z_BVH]*(y)[Z_BVH])
+#define VEC_LEN_BVH(x) sqrt(VEC_DOT_BVH(x,x))
+
+#define VEC_DIFF_BVH(from,to,diff) {\
+    (diff)[X_BVH] = (to)[X_BVH] - (from)[X_BVH];\
+    (diff)[Y_BVH] = (to)[Y_BVH] - (from)[Y_BVH];\
+    (diff)[Z_BVH] = (to)[Z_BVH] - (from)[Z_BVH];\
+    }
+
+#define CROSS_PRODUCT_BVH(x,y,xy) {\
+    (xy)[X_BVH] =   (x)[Y_BVH]*(y)[Z_BVH]-(y)[Y_BVH]*(x)[Z_BVH];\
+    (xy)[Y_BVH] = -((x)[X_BVH]*(y)[Z_BVH]-(y)[X_BVH]*(x)[Z_BVH]);\
+    (xy)[Z_BVH] =   (x)[X_BVH]*(y)[Y_BVH]-(y)[X_BVH]*(x)[Y_BVH];\
+    }
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+/*
+ * A node is replaced by its far field expansion once the point is further away than this many enclosing radii.
+ * The error of the second order expansion falls off with the third power of the ratio.
+ */
+const double far_field_ratio = 2.5;
+
+/*
+ * Winding numbers further away than this from an integer are recomputed exactly
+ */
+const double winding_tolerance = 0.25;
+
+/*
+ * Enough for any balanced hierarchy which fits into memory
+ */
+const int max_stack = 128;
+
+/*
+ * Squared distance from a point to a bounding box
+ */
+inline double box_dist2(const float *from, const float *bmin, const float *bmax)
+{
+    double d2 = 0.0;
+    for (int c = 0; c < 3; c++) {
+        double d = 0.0;
+        if (from[c] < bmin[c])
+            d = bmin[c] - from[c];
+        else if (from[c] > bmax[c])
+            d = from[c] - bmax[c];
+        d2 += d*d;
+    }
+    return d2;
+}
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MneSurfaceBvh::MneSurfaceBvh(MneSurfaceOld* surf, int p_iLeafSize)
+: m_pSurf(surf)
+, m_iLeafSize(p_iLeafSize < 1 ? 1 : p_iLeafSize)
+, m_iDepth(0)
+{
+    int k,c;
+
+    if (!surf || surf->ntri <= 0)
+        return;
+    m_qVecTris.resize(surf->ntri);
+    m_qVecCent.resize(3*surf->ntri);
+    for (k = 0; k < surf->ntri; k++) {
+        MneTriangle* tri = surf->tris+k;
+        m_qVecTris[k] = k;
+        for (c = 0; c < 3; c++)
+            m_qVecCent[3*k+c] = (tri->r1[c]+tri->r2[c]+tri->r3[c])/3.0f;
+    }
+    m_qVecNodes.reserve(2*(surf->ntri/m_iLeafSize)+1);
+    m_qVecNodes.append(Node());
+    build(0,0,surf->ntri,1);
+    m_qVecCent.clear();
+    m_qVecCent.squeeze();
+}
+
+
+//*************************************************************************************************************
+
+MneSurfaceBvh::~MneSurfaceBvh()
+{
+}
+
+
+//*************************************************************************************************************
+
+void MneSurfaceBvh::build(int node, int first, int ntri, int depth)
+{
+    double cent[3]  = { 0.0, 0.0, 0.0 };
+    double area[3]  = { 0.0, 0.0, 0.0 };
+    double atot     = 0.0;
+    float  cmin[3],cmax[3];
+    float  *verts[3];
+    double r12[3],r13[3],an[3],len,diff[3],dist2;
+    int    k,c,j;
+
+    m_iDepth = std::max(m_iDepth,depth);
+    Node& n = m_qVecNodes[node];
+    /*
+     * Bounding box, area vector and area weighted centroid
+     */
+    for (c = 0; c < 3; c++) {
+        n.bmin[c] = cmin[c] =  HUGE_VALF;
+        n.bmax[c] = cmax[c] = -HUGE_VALF;
+    }
+    for (k = first; k < first+ntri; k++) {
+        MneTriangle* tri = m_pSurf->tris+m_qVecTris[k];
+        verts[0] = tri->r1;
+        verts[1] = tri->r2;
+        verts[2] = tri->r3;
+        for (j = 0; j < 3; j++)
+            for (c = 0; c < 3; c++) {
+                n.bmin[c] = std::min(n.bmin[c],verts[j][c]);
+                n.bmax[c] = std::max(n.bmax[c],verts[j][c]);
+            }
+        for (c = 0; c < 3; c++) {
+            r12[c] = (double)tri->r2[c] - tri->r1[c];
+            r13[c] = (double)tri->r3[c] - tri->r1[c];
+            cmin[c] = std::min(cmin[c],m_qVecCent[3*m_qVecTris[k]+c]);
+            cmax[c] = std::max(cmax[c],m_qVecCent[3*m_qVecTris[k]+c]);
+        }
+        CROSS_PRODUCT_BVH(r12,r13,an);
+        len = 0.5*VEC_LEN_BVH(an);
+        for (c = 0; c < 3; c++) {
+            area[c] += 0.5*an[c];
+            cent[c] += len*m_qVecCent[3*m_qVecTris[k]+c];
+        }
+        atot += len;
+    }
+    for (c = 0; c < 3; c++) {
+        n.area[c] = area[c];
+        n.cent[c] = atot > 0.0 ? cent[c]/atot : 0.5*((double)n.bmin[c]+n.bmax[c]);
+    }
+    n.radius2 = 0.0;
+    for (j = 0; j < 9; j++)
+        n.moment[j] = 0.0;
+    for (k = first; k < first+ntri; k++) {
+        MneTriangle* tri = m_pSurf->tris+m_qVecTris[k];
+        for (c = 0; c < 3; c++) {
+            r12[c] = (double)tri->r2[c] - tri->r1[c];
+            r13[c] = (double)tri->r3[c] - tri->r1[c];
+            diff[c] = m_qVecCent[3*m_qVecTris[k]+c] - n.cent[c];
+        }
+        CROSS_PRODUCT_BVH(r12,r13,an);
+        for (c = 0; c < 3; c++)
+            for (j = 0; j < 3; j++)
+                n.moment[3*c+j] += 0.5*diff[c]*an[j];
+        verts[0] = tri->r1;
+        verts[1] = tri->r2;
+        verts[2] = tri->r3;
+        for (j = 0; j < 3; j++) {
+            VEC_DIFF_BVH(n.cent,verts[j],diff);
+            dist2 = VEC_DOT_BVH(diff,diff);
+            if (dist2 > n.radius2)
+                n.radius2 = dist2;
+        }
+    }
+    if (ntri <= m_iLeafSize) {
+        n.first = first;
+        n.ntri  = ntri;
+        return;
+    }
+    /*
+     * Split at the median centroid along the longest extent of the centroids
+     */
+    int axis = 0;
+    for (c = 1; c < 3; c++)
+        if (cmax[c]-cmin[c] > cmax[axis]-cmin[axis])
+            axis = c;
+    int half = ntri/2;
+    const float *tri_cent = m_qVecCent.constData();
+    std::nth_element(m_qVecTris.begin()+first,m_qVecTris.begin()+first+half,m_qVecTris.begin()+first+ntri,
+                     [tri_cent,axis](int a, int b) { return tri_cent[3*a+axis] < tri_cent[3*b+axis]; });
+    int child = m_qVecNodes.size();
+    n.first = child;
+    n.ntri  = 0;
+    m_qVecNodes.append(Node());     /* n is not valid after this */
+    m_qVecNodes.append(Node());
+    build(child,first,half,depth+1);
+    build(child+1,first+half,ntri-half,depth+1);
+}
+
+
+//*************************************************************************************************************
+
+double MneSurfaceBvh::sum_solids(const float *from) const
+{
+    float  r[3] = { from[X_BVH], from[Y_BVH], from[Z_BVH] };
+    double tot_angle = 0.0;
+    double diff[3],dist2,dist,trace,quad;
+    int    stack[max_stack];
+    int    nstack = 0;
+    int    k,c;
+
+    if (m_qVecNodes.isEmpty())
+        return 0.0;
+    const Node* nodes = m_qVecNodes.constData();
+    const int*  tris  = m_qVecTris.constData();
+    stack[nstack++] = 0;
+    while (nstack > 0) {
+        const Node& n = nodes[stack[--nstack]];
+        VEC_DIFF_BVH(r,n.cent,diff);
+        dist2 = VEC_DOT_BVH(diff,diff);
+        if (dist2 > far_field_ratio*far_field_ratio*n.radius2) {
+            /*
+             * Far away: expand the solid angles of the triangles around the centroid of the cluster
+             */
+            dist   = sqrt(dist2);
+            trace  = n.moment[0] + n.moment[4] + n.moment[8];
+            quad   = 0.0;
+            for (c = 0; c < 3; c++)
+                quad += diff[c]*VEC_DOT_BVH(n.moment+3*c,diff);
+            tot_angle += VEC_DOT_BVH(n.area,diff)/(dist2*dist) + (trace - 3.0*quad/dist2)/(dist2*dist);
+        }
+        else if (n.ntri > 0) {
+            for (k = n.first; k < n.first+n.ntri; k++)
+                tot_angle += MneSurfaceOrVolume::solid_angle(r,m_pSurf->tris+tris[k]);
+        }
+        else {
+            stack[nstack++] = n.first;
+            stack[nstack++] = n.first+1;
+        }
+    }
+    return tot_angle;
+}
+
+
+//*************************************************************************************************************
+
+bool MneSurfaceBvh::is_inside(const float *from) const
+{
+    double tot_angle = sum_solids(from)/(4*M_PI);
+
+    if (std::fabs(tot_angle-1.0) < winding_tolerance)
+        return true;
+    if (std::fabs(tot_angle) < winding_tolerance)
+        return false;
+    /*
+     * Practically on the surface or the surface is not closed
+     */
+    float r[3] = { from[X_BVH], from[Y_BVH], from[Z_BVH] };
+    tot_angle = MneSurfaceOrVolume::sum_solids(r,m_pSurf)/(4*M_PI);
+    return std::fabs(tot_angle-1.0) <= 1e-5;
+}
+
+
+//*************************************************************************************************************
+
+float MneSurfaceBvh::closest_vertex(const float *from, float limit, int *nearest) const
+{
+    float  mindist = limit;
+    int    minnode = -1;
+    float  dist,diff[3];
+    int    *vert;
+    int    stack[max_stack];
+    int    nstack = 0;
+    int    k,j;
+
+    if (!m_qVecNodes.isEmpty())
+        stack[nstack++] = 0;
+    const Node* nodes = m_qVecNodes.constData();
+    const int*  tris  = m_qVecTris.constData();
+    while (nstack > 0) {
+        const Node& n = nodes[stack[--nstack]];
+        if (box_dist2(from,n.bmin,n.bmax) > (double)mindist*mindist)
+            continue;
+        if (n.ntri > 0) {
+            for (k = n.first; k < n.first+n.ntri; k++) {
+                vert = m_pSurf->tris[tris[k]].vert;
+                for (j = 0; j < 3; j++) {
+                    VEC_DIFF_BVH(from,m_pSurf->rr[vert[j]],diff);
+                    dist = VEC_LEN_BVH(diff);
+                    if (dist < mindist || (dist == mindist && vert[j] < minnode)) {
+                        mindist = dist;
+                        minnode = vert[j];
+                    }
+                }
+            }
+        }
+        else {
+            /*
+             * Visit the closer child first
+             */
+            const Node& a = nodes[n.first];
+            const Node& b = nodes[n.first+1];
+            if (box_dist2(from,a.bmin,a.bmax) < box_dist2(from,b.bmin,b.bmax)) {
+                stack[nstack++] = n.first+1;
+                stack[nstack++] = n.first;
+            }
+            else {
+                stack[nstack++] = n.first;
+                stack[nstack++] = n.first+1;
+            }
+        }
+    }
+    if (nearest)
+        *nearest = minnode;
+    return mindist;
+}
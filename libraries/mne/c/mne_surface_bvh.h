@@ -0,0 +1,188 @@
+//=============================================================================================================
+/**
+* @file     mne_surface_bvh.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MneSurfaceBvh class declaration.
+*
+*/
+
+
+#ifndef MNESURFACEBVH_H
+#define MNESURFACEBVH_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../mne_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class MneSurfaceOld;
+
+
+//=============================================================================================================
+/**
+* Bounding volume hierarchy over the triangles of a surface. Each node keeps the bounding box of its triangles
+* together with their summed area vectors, which is enough to approximate the solid angle the node subtends
+* from far away points (Barill et al., Fast winding numbers for soups and clouds, 2018). Nearby nodes are
+* opened down to the leaves, where the exact formula of van Oosterom is used.
+*
+* The surface must outlive the hierarchy and its vertices must not move.
+*
+* @brief Bounding volume hierarchy for solid angle and distance queries on a triangulated surface
+*/
+class MNESHARED_EXPORT MneSurfaceBvh
+{
+public:
+    typedef QSharedPointer<MneSurfaceBvh> SPtr;              /**< Shared pointer type for MneSurfaceBvh. */
+    typedef QSharedPointer<const MneSurfaceBvh> ConstSPtr;   /**< Const shared pointer type for MneSurfaceBvh. */
+
+    //=========================================================================================================
+    /**
+    * Builds the hierarchy
+    *
+    * @param[in] surf           The triangulated surface
+    * @param[in] p_iLeafSize    Maximum number of triangles in a leaf
+    */
+    explicit MneSurfaceBvh(MneSurfaceOld* surf, int p_iLeafSize = 8);
+
+    //=========================================================================================================
+    /**
+    * Destroys the hierarchy
+    */
+    ~MneSurfaceBvh();
+
+    //=========================================================================================================
+    /**
+    * Approximates the total solid angle the surface subtends at a point, see MneSurfaceOrVolume::sum_solids.
+    * The far field error stays within a few percent of 4 pi, enough to round the winding number of a closed
+    * surface but not to replace the exact sum where the value itself matters.
+    *
+    * @param[in] from   The point
+    *
+    * @return the solid angle in steradians
+    */
+    double sum_solids(const float *from) const;
+
+    //=========================================================================================================
+    /**
+    * Winding number test against a closed surface. Points for which the hierarchical estimate is not clearly
+    * an integer, i.e., points practically on the surface, are decided with the exact sum over all triangles
+    * using the criterion of MneSurfaceOrVolume::mne_filter_source_spaces.
+    *
+    * @param[in] from   The point
+    *
+    * @return true if the point is inside the surface
+    */
+    bool is_inside(const float *from) const;
+
+    //=========================================================================================================
+    /**
+    * Finds the surface vertex closest to a point. Only vertices which belong to at least one triangle are
+    * considered.
+    *
+    * @param[in] from       The point
+    * @param[in] limit      Only look for vertices closer than this
+    * @param[out] nearest   Index of the closest vertex, -1 if none is closer than limit (optional)
+    *
+    * @return the distance to the closest vertex or limit if no vertex is closer
+    */
+    float closest_vertex(const float *from, float limit, int *nearest = NULL) const;
+
+    inline MneSurfaceOld* surface() const;
+
+    inline int nnode() const;
+
+private:
+    struct Node {
+        float  bmin[3];     /**< Lower corner of the bounding box */
+        float  bmax[3];     /**< Upper corner of the bounding box */
+        double cent[3];     /**< Area weighted centroid of the triangles */
+        double area[3];     /**< Sum of the area vectors (area times normal) of the triangles */
+        double moment[9];   /**< Sum of (centroid - cent) * area vector^T over the triangles, row major */
+        double radius2;     /**< Squared radius of the sphere around cent which encloses the triangles */
+        int    first;       /**< Leaves: first entry in m_qVecTris, other nodes: index of the first child */
+        int    ntri;        /**< Leaves: number of triangles, other nodes: 0 */
+    };
+
+    void build(int node, int first, int ntri, int depth);
+
+    MneSurfaceOld*      m_pSurf;        /**< The surface */
+    int                 m_iLeafSize;    /**< Maximum number of triangles in a leaf */
+    QVector<Node>       m_qVecNodes;    /**< The nodes, the root comes first and siblings are adjacent */
+    QVector<int>        m_qVecTris;     /**< Triangle indices ordered by leaf */
+    QVector<float>      m_qVecCent;     /**< Triangle centroids, only used while building */
+    int                 m_iDepth;       /**< Depth of the hierarchy */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline MneSurfaceOld* MneSurfaceBvh::surface() const
+{
+    return m_pSurf;
+}
+
+
+//*************************************************************************************************************
+
+inline int MneSurfaceBvh::nnode() const
+{
+    return m_qVecNodes.size();
+}
+
+} // NAMESPACE MNELIB
+
+#endif // MNESURFACEBVH_H
@@ -41,6 +41,7 @@
 
 #include "mne_surface_or_volume.h"
 #include "mne_surface_old.h"
+#include "mne_surface_bvh.h"
 #include "mne_source_space_old.h"
 #include "mne_patch_info.h"
 //#include "fwd_bem_model.h"
@@ -462,12 +463,9 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     */
 {
     MneSourceSpaceOld* s;
-    int k,p1,p2;
+    int k,p1;
     float r1[3];
-    float mindist,dist,diff[3];
-    int   minnode;
     int   omit,omit_outside;
-    double tot_angle;
 
     if (surf == NULL)
         return OK;
@@ -489,6 +487,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     if (limit > 0.0)
         printf("and at least %6.1f mm away",1000*limit);
     printf(" (will take a few...)\n");
+    MneSurfaceBvh bvh(surf);
     omit         = 0;
     omit_outside = 0;
     for (k = 0; k < nspace; k++) {
@@ -501,8 +500,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
                 /*
                 * Check that the source is inside the inner skull surface
                 */
-                tot_angle = sum_solids(r1,surf)/(4*M_PI);
-                if (std::fabs(tot_angle-1.0) > 1e-5) {
+                if (!bvh.is_inside(r1)) {
                     omit_outside++;
                     s->inuse[p1] = FALSE;
                     s->nuse--;
@@ -514,17 +512,7 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
                     /*
                         * Check the distance limit
                         */
-                    mindist = 1.0;
-                    minnode = 0;
-                    for (p2 = 0; p2 < surf->np; p2++) {
-                        VEC_DIFF_17(r1,surf->rr[p2],diff);
-                        dist = VEC_LEN_17(diff);
-                        if (dist < mindist) {
-                            mindist = dist;
-                            minnode = p2;
-                        }
-                    }
-                    if (mindist < limit) {
+                    if (bvh.closest_vertex(r1,limit) < limit) {
                         omit++;
                         s->inuse[p1] = FALSE;
                         s->nuse--;
@@ -670,12 +658,10 @@ void MneSurfaceOrVolume::rearrange_source_space(MneSourceSpaceOld* s)
 void *MneSurfaceOrVolume::filter_source_space(void *arg)
 {
     FilterThreadArg* a = (FilterThreadArg*)arg;
-    int    p1,p2;
-    double tot_angle;
+    int    p1;
     int    omit,omit_outside;
     float  r1[3];
-    float  mindist,dist,diff[3];
-    int    minnode;
+    MneSurfaceBvh* bvh = a->bvh ? a->bvh : new MneSurfaceBvh(a->surf);
 
     omit         = 0;
     omit_outside = 0;
@@ -688,8 +674,7 @@ void *MneSurfaceOrVolume::filter_source_space(void *arg)
             /*
            * Check that the source is inside the inner skull surface
            */
-            tot_angle = sum_solids(r1,a->surf)/(4*M_PI);
-            if (std::fabs(tot_angle-1.0) > 1e-5) {
+            if (!bvh->is_inside(r1)) {
                 omit_outside++;
                 a->s->inuse[p1] = FALSE;
                 a->s->nuse--;
@@ -701,17 +686,7 @@ void *MneSurfaceOrVolume::filter_source_space(void *arg)
                 /*
          * Check the distance limit
          */
-                mindist = 1.0;
-                minnode = 0;
-                for (p2 = 0; p2 < a->surf->np; p2++) {
-                    VEC_DIFF_17(r1,a->surf->rr[p2],diff);
-                    dist = VEC_LEN_17(diff);
-                    if (dist < mindist) {
-                        mindist = dist;
-                        minnode = p2;
-                    }
-                }
-                if (mindist < a->limit) {
+                if (bvh->closest_vertex(r1,a->limit) < a->limit) {
                     omit++;
                     a->s->inuse[p1] = FALSE;
                     a->s->nuse--;
@@ -728,6 +703,8 @@ void *MneSurfaceOrVolume::filter_source_space(void *arg)
     if (omit > 0)
         fprintf(stderr,"%d source space points omitted because of the %6.1f-mm distance limit.\n",
                 omit,1000*a->limit);
+    if (bvh != a->bvh)
+        delete bvh;
     a->stat = OK;
     return NULL;
 }
@@ -742,6 +719,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
 {
     MneSurfaceOld*    surf = NULL;
     int             k;
+    MneSurfaceBvh*  bvh = NULL;
     int             nproc = QThread::idealThreadCount();
     FilterThreadArg* a;
 
@@ -766,6 +744,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
     if (limit > 0.0)
         fprintf(stderr,"and at least %6.1f mm away",1000*limit);
     fprintf(stderr," (will take a few...)\n");
+    bvh = new MneSurfaceBvh(surf);
     if (nproc < 2 || nspace == 1 || !use_threads) {
         /*
         * This is the conventional calculation
@@ -775,6 +754,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
             a->s = spaces[k];
             a->mri_head_t = mri_head_t;
             a->surf = surf;
+            a->bvh = bvh;
             a->limit = limit;
             a->filtered = filtered;
             filter_source_space(a);
@@ -794,6 +774,7 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
             a->s = spaces[k];
             a->mri_head_t = mri_head_t;
             a->surf = surf;
+            a->bvh = bvh;
             a->limit = limit;
             a->filtered = filtered;
             args.append(a);
@@ -809,6 +790,8 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
                 delete args[k];
         }
     }
+    if(bvh)
+        delete bvh;
     if(surf)
         delete surf;
     printf("Thank you for waiting.\n\n");
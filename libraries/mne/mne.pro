@@ -75,6 +75,8 @@ SOURCES += \
     mne_sourcespace.cpp \
     mne_forwardsolution.cpp \
     mne_sourceestimate.cpp \
+    mne_chunked_sourceestimate.cpp \
+    mne_chunked_sourceestimate_writer.cpp \
     mne_hemisphere.cpp \
     mne_inverse_operator.cpp \
     mne_epoch_data.cpp \
@@ -95,6 +97,7 @@ SOURCES += \
     c/mne_proj_item.cpp \
     c/mne_proj_op.cpp \
     c/mne_raw_buf_def.cpp \
+    c/mne_raw_buf_cache.cpp \
     c/mne_raw_data.cpp \
     c/mne_raw_info.cpp \
     c/mne_sss_data.cpp \
@@ -105,6 +108,7 @@ SOURCES += \
     c/mne_source_space_old.cpp \
     c/mne_surface_old.cpp \
     c/mne_surface_or_volume.cpp \
+    c/mne_surface_bvh.cpp \
     c/filter_thread_arg.cpp \
     c/mne_msh_display_surface.cpp \
     c/mne_msh_display_surface_set.cpp \
@@ -126,9 +130,12 @@ HEADERS += \
     mne_hemisphere.h \
     mne_forwardsolution.h \
     mne_sourceestimate.h \
+    mne_chunked_sourceestimate.h \
+    mne_chunked_sourceestimate_writer.h \
     mne_inverse_operator.h \
     mne_epoch_data.h \
     mne_epoch_data_list.h \
+    mne_epoch_tensor.h \
     mne_cluster_info.h \
     mne_surface.h \
     mne_corsourceestimate.h\
@@ -145,6 +152,7 @@ HEADERS += \
     c/mne_proj_item.h \
     c/mne_proj_op.h \
     c/mne_raw_buf_def.h \
+    c/mne_raw_buf_cache.h \
     c/mne_raw_data.h \
     c/mne_raw_info.h \
     c/mne_sss_data.h \
@@ -157,6 +165,7 @@ HEADERS += \
     c/mne_source_space_old.h \
     c/mne_surface_old.h \
     c/mne_surface_or_volume.h \
+    c/mne_surface_bvh.h \
     c/filter_thread_arg.h \
     c/mne_msh_display_surface.h \
     c/mne_msh_display_surface_set.h \
@@ -0,0 +1,317 @@
+//=============================================================================================================
+/**
+* @file     mne_chunked_sourceestimate.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEChunkedSourceEstimate class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_chunked_sourceestimate.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+#include <limits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QtEndian>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC MEMBERS
+//=============================================================================================================
+
+const char MNEChunkedSourceEstimate::FILE_ID[8] = {'M','N','E','C','S','T','C','\0'};
+const quint32 MNEChunkedSourceEstimate::FILE_VERSION = 1;
+const qint64 MNEChunkedSourceEstimate::HEADER_SIZE = 48;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MNEChunkedSourceEstimate::MNEChunkedSourceEstimate()
+: m_pMap(Q_NULLPTR)
+, m_iNumTimes(0)
+, m_iTileVertices(0)
+, m_iTileTimes(0)
+, m_iNumVertexTiles(0)
+, m_fTmin(0)
+, m_fTstep(-1)
+{
+}
+
+
+//*************************************************************************************************************
+
+MNEChunkedSourceEstimate::MNEChunkedSourceEstimate(const QString& sFileName)
+: m_pMap(Q_NULLPTR)
+, m_iNumTimes(0)
+, m_iTileVertices(0)
+, m_iTileTimes(0)
+, m_iNumVertexTiles(0)
+, m_fTmin(0)
+, m_fTstep(-1)
+{
+    if(!open(sFileName)) {
+        qWarning() << "MNEChunkedSourceEstimate - Could not open" << sFileName;
+    }
+}
+
+
+//*************************************************************************************************************
+
+MNEChunkedSourceEstimate::~MNEChunkedSourceEstimate()
+{
+    close();
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimate::open(const QString& sFileName)
+{
+    close();
+
+    m_file.setFileName(sFileName);
+    if(!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream t_stream(&m_file);
+    t_stream.setByteOrder(QDataStream::LittleEndian);
+    t_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    char t_fileId[8];
+    quint32 t_iVersion, t_nVertices, t_nTimes, t_iTileVertices, t_iTileTimes, t_iReserved;
+    quint64 t_iIndexOffset;
+
+    if(t_stream.readRawData(t_fileId, sizeof(t_fileId)) != sizeof(t_fileId) || memcmp(t_fileId, FILE_ID, sizeof(t_fileId)) != 0) {
+        qWarning() << "MNEChunkedSourceEstimate::open - Not a chunked source estimate file" << sFileName;
+        m_file.close();
+        return false;
+    }
+
+    t_stream >> t_iVersion >> t_nVertices >> t_nTimes >> t_iTileVertices >> t_iTileTimes >> m_fTmin >> m_fTstep >> t_iReserved >> t_iIndexOffset;
+
+    if(t_stream.status() != QDataStream::Ok || t_iVersion != FILE_VERSION || t_iTileVertices == 0 || t_iTileTimes == 0) {
+        qWarning() << "MNEChunkedSourceEstimate::open - Unsupported or corrupt header in" << sFileName;
+        m_file.close();
+        return false;
+    }
+
+    // Check the sizes against the file before anything is allocated or mapped
+    const quint64 t_iFileSize = m_file.size();
+    const quint64 t_iDataStart = HEADER_SIZE + static_cast<quint64>(t_nVertices) * sizeof(qint32);
+    const quint64 t_iNumVertexTiles = (static_cast<quint64>(t_nVertices) + t_iTileVertices - 1) / t_iTileVertices;
+    const quint64 t_iNumTimeTiles = (static_cast<quint64>(t_nTimes) + t_iTileTimes - 1) / t_iTileTimes;
+    const quint64 t_iNumTiles = t_iNumVertexTiles * t_iNumTimeTiles;
+
+    if(t_nVertices > static_cast<quint32>(std::numeric_limits<qint32>::max())
+       || t_nTimes > static_cast<quint32>(std::numeric_limits<qint32>::max())
+       || t_iTileVertices > static_cast<quint32>(std::numeric_limits<qint32>::max())
+       || t_iTileTimes > static_cast<quint32>(std::numeric_limits<qint32>::max())
+       || t_iDataStart > t_iFileSize
+       || t_iIndexOffset < t_iDataStart
+       || t_iIndexOffset > t_iFileSize
+       || t_iNumTiles > (t_iFileSize - t_iIndexOffset) / sizeof(quint64)) {
+        qWarning() << "MNEChunkedSourceEstimate::open - Header does not match the size of" << sFileName;
+        close();
+        return false;
+    }
+
+    m_vecVertices.resize(t_nVertices);
+    for(quint32 i = 0; i < t_nVertices; ++i) {
+        t_stream >> m_vecVertices[i];
+    }
+
+    m_iNumTimes = t_nTimes;
+    m_iTileVertices = t_iTileVertices;
+    m_iTileTimes = t_iTileTimes;
+    m_iNumVertexTiles = t_iNumVertexTiles;
+
+    m_file.seek(t_iIndexOffset);
+    m_vecTileOffsets.resize(t_iNumTiles);
+    for(int i = 0; i < m_vecTileOffsets.size(); ++i) {
+        t_stream >> m_vecTileOffsets[i];
+    }
+
+    if(t_stream.status() != QDataStream::Ok) {
+        qWarning() << "MNEChunkedSourceEstimate::open - Could not read the tile index of" << sFileName;
+        close();
+        return false;
+    }
+
+    // Every tile has to lie between the vertices and the index, slice() relies on this
+    for(int i = 0; i < m_vecTileOffsets.size(); ++i) {
+        const quint64 t_iTileT0 = static_cast<quint64>(i / m_iNumVertexTiles) * m_iTileTimes;
+        const quint64 t_iTileV0 = static_cast<quint64>(i % m_iNumVertexTiles) * m_iTileVertices;
+        const quint64 t_iTileSize = qMin<quint64>(m_iTileVertices, t_nVertices - t_iTileV0)
+                                    * qMin<quint64>(m_iTileTimes, t_nTimes - t_iTileT0)
+                                    * sizeof(float);
+        const quint64 t_iOffset = m_vecTileOffsets.at(i);
+
+        if(t_iOffset < t_iDataStart
+           || t_iOffset % sizeof(float) != 0
+           || t_iOffset > t_iIndexOffset
+           || t_iTileSize > t_iIndexOffset - t_iOffset) {
+            qWarning() << "MNEChunkedSourceEstimate::open - Tile" << i << "at offset" << t_iOffset << "is out of range in" << sFileName;
+            close();
+            return false;
+        }
+    }
+
+    // Only the pages of the tiles which are accessed become resident
+    m_pMap = m_file.map(0, m_file.size());
+    if(!m_pMap) {
+        qWarning() << "MNEChunkedSourceEstimate::open - Could not map" << sFileName;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void MNEChunkedSourceEstimate::close()
+{
+    if(m_pMap) {
+        m_file.unmap(m_pMap);
+        m_pMap = Q_NULLPTR;
+    }
+
+    if(m_file.isOpen()) {
+        m_file.close();
+    }
+
+    m_vecVertices = VectorXi();
+    m_vecTileOffsets.clear();
+    m_iNumTimes = 0;
+    m_iTileVertices = 0;
+    m_iTileTimes = 0;
+    m_iNumVertexTiles = 0;
+    m_fTmin = 0;
+    m_fTstep = -1;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf MNEChunkedSourceEstimate::slice(qint32 iVertexStart,
+                                         qint32 iNumVertices,
+                                         qint32 iTimeStart,
+                                         qint32 iNumTimes) const
+{
+    if(!isOpen()
+       || iVertexStart < 0 || iNumVertices <= 0 || iVertexStart + iNumVertices > m_vecVertices.size()
+       || iTimeStart < 0 || iNumTimes <= 0 || iTimeStart + iNumTimes > m_iNumTimes) {
+        qWarning() << "MNEChunkedSourceEstimate::slice - Invalid slice" << iVertexStart << iNumVertices << iTimeStart << iNumTimes;
+        return MatrixXf();
+    }
+
+    MatrixXf matSlice(iNumVertices, iNumTimes);
+
+    const qint32 iVertexEnd = iVertexStart + iNumVertices;
+    const qint32 iTimeEnd = iTimeStart + iNumTimes;
+
+    for(qint32 tt = iTimeStart / m_iTileTimes; tt * m_iTileTimes < iTimeEnd; ++tt) {
+        const qint32 iTileT0 = tt * m_iTileTimes;
+        const qint32 iTileCols = qMin(m_iTileTimes, m_iNumTimes - iTileT0);
+        const qint32 iT0 = qMax(iTimeStart, iTileT0);
+        const qint32 iT1 = qMin(iTimeEnd, iTileT0 + iTileCols);
+
+        for(qint32 vt = iVertexStart / m_iTileVertices; vt * m_iTileVertices < iVertexEnd; ++vt) {
+            const qint32 iTileV0 = vt * m_iTileVertices;
+            const qint32 iTileRows = qMin(m_iTileVertices, static_cast<qint32>(m_vecVertices.size()) - iTileV0);
+            const qint32 iV0 = qMax(iVertexStart, iTileV0);
+            const qint32 iV1 = qMin(iVertexEnd, iTileV0 + iTileRows);
+
+            const float* pTile = reinterpret_cast<const float*>(m_pMap + m_vecTileOffsets.at(tt * m_iNumVertexTiles + vt));
+            Map<const MatrixXf> matTile(pTile, iTileRows, iTileCols);
+
+            matSlice.block(iV0 - iVertexStart, iT0 - iTimeStart, iV1 - iV0, iT1 - iT0) = matTile.block(iV0 - iTileV0, iT0 - iTileT0, iV1 - iV0, iT1 - iT0);
+        }
+    }
+
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    quint32* pData = reinterpret_cast<quint32*>(matSlice.data());
+    for(qint64 i = 0; i < matSlice.size(); ++i) {
+        pData[i] = qbswap(pData[i]);
+    }
+#endif
+
+    return matSlice;
+}
+
+
+//*************************************************************************************************************
+
+MNESourceEstimate MNEChunkedSourceEstimate::sourceEstimate(qint32 iTimeStart,
+                                                           qint32 iNumTimes) const
+{
+    MatrixXf matData = slice(0, m_vecVertices.size(), iTimeStart, iNumTimes);
+
+    if(matData.size() == 0) {
+        return MNESourceEstimate();
+    }
+
+    return MNESourceEstimate(matData.cast<double>(), m_vecVertices, m_fTmin + iTimeStart * m_fTstep, m_fTstep);
+}
@@ -0,0 +1,265 @@
+//=============================================================================================================
+/**
+* @file     mne_chunked_sourceestimate.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEChunkedSourceEstimate class declaration.
+*
+*/
+
+
+#ifndef MNECHUNKEDSOURCEESTIMATE_H
+#define MNECHUNKEDSOURCEESTIMATE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_global.h"
+#include "mne_sourceestimate.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QString>
+#include <QFile>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+
+//=============================================================================================================
+/**
+* Reads source estimates stored in the chunked format written by MNEChunkedSourceEstimateWriter. The data is
+* split into tiles of (tile vertices x tile samples), each stored contiguously in single precision. An index
+* at the end of the file holds the offset of every tile. The file is memory mapped, so serving a
+* (vertex range, time range) slice only touches the tiles it overlaps and never loads the full estimate.
+*
+* File layout (little endian):
+*   header      "MNECSTC\0", version, n_vertices, n_times, tile_vertices, tile_times, tmin [s], tstep [s],
+*               reserved, index offset
+*   vertices    n_vertices x int32
+*   tiles       ordered by time tile, then vertex tile; column major float32 of the tile size
+*   index       n_time_tiles x n_vertex_tiles x uint64 tile offsets
+*
+* @brief Memory mapped, tiled source estimate reader
+*/
+class MNESHARED_EXPORT MNEChunkedSourceEstimate
+{
+public:
+    typedef QSharedPointer<MNEChunkedSourceEstimate> SPtr;             /**< Shared pointer type for MNEChunkedSourceEstimate. */
+    typedef QSharedPointer<const MNEChunkedSourceEstimate> ConstSPtr;  /**< Const shared pointer type for MNEChunkedSourceEstimate. */
+
+    static const char   FILE_ID[8];         /**< The magic bytes at the start of a chunked source estimate file. */
+    static const quint32 FILE_VERSION;      /**< The file format version. */
+    static const qint64 HEADER_SIZE;        /**< The size of the fixed header in bytes. */
+
+    //=========================================================================================================
+    /**
+    * Default constructor
+    */
+    MNEChunkedSourceEstimate();
+
+    //=========================================================================================================
+    /**
+    * Constructs the reader and opens the given file.
+    *
+    * @param[in] sFileName      The chunked source estimate file.
+    */
+    explicit MNEChunkedSourceEstimate(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Destroys the reader and unmaps the file.
+    */
+    ~MNEChunkedSourceEstimate();
+
+    //=========================================================================================================
+    /**
+    * Opens and maps a chunked source estimate file. A previously opened file is closed.
+    *
+    * @param[in] sFileName      The chunked source estimate file.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool open(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Unmaps and closes the file.
+    */
+    void close();
+
+    //=========================================================================================================
+    /**
+    * Returns whether a file is opened.
+    *
+    * @return true if a file is opened, false otherwise
+    */
+    inline bool isOpen() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the vertex indices.
+    *
+    * @return the vertex indices
+    */
+    inline const Eigen::VectorXi& vertices() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples.
+    *
+    * @return the number of samples
+    */
+    inline qint32 samples() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the time of the first sample in seconds.
+    *
+    * @return the start time
+    */
+    inline float tmin() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the time step in seconds.
+    *
+    * @return the time step
+    */
+    inline float tstep() const;
+
+    //=========================================================================================================
+    /**
+    * Returns a slice of the data. Only the tiles overlapping the slice are read.
+    *
+    * @param[in] iVertexStart   The first vertex (row) of the slice.
+    * @param[in] iNumVertices   The number of vertices.
+    * @param[in] iTimeStart     The first sample of the slice.
+    * @param[in] iNumTimes      The number of samples.
+    *
+    * @return the slice [iNumVertices x iNumTimes], empty if the range is invalid
+    */
+    Eigen::MatrixXf slice(qint32 iVertexStart,
+                          qint32 iNumVertices,
+                          qint32 iTimeStart,
+                          qint32 iNumTimes) const;
+
+    //=========================================================================================================
+    /**
+    * Returns a time window over all vertices as source estimate.
+    *
+    * @param[in] iTimeStart     The first sample of the window.
+    * @param[in] iNumTimes      The number of samples.
+    *
+    * @return the source estimate holding the samples [iTimeStart, iTimeStart + iNumTimes)
+    */
+    MNESourceEstimate sourceEstimate(qint32 iTimeStart,
+                                     qint32 iNumTimes) const;
+
+private:
+    QFile               m_file;             /**< The opened file. */
+    uchar*              m_pMap;             /**< The memory mapped file. */
+    Eigen::VectorXi     m_vecVertices;      /**< The vertex indices. */
+    qint32              m_iNumTimes;        /**< The number of samples. */
+    qint32              m_iTileVertices;    /**< The number of vertices per tile. */
+    qint32              m_iTileTimes;       /**< The number of samples per tile. */
+    qint32              m_iNumVertexTiles;  /**< The number of tiles along the vertices. */
+    float               m_fTmin;            /**< The time of the first sample in seconds. */
+    float               m_fTstep;           /**< The time step in seconds. */
+    QVector<quint64>    m_vecTileOffsets;   /**< The offset of each tile, ordered by time tile, then vertex tile. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool MNEChunkedSourceEstimate::isOpen() const
+{
+    return m_pMap != Q_NULLPTR;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::VectorXi& MNEChunkedSourceEstimate::vertices() const
+{
+    return m_vecVertices;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 MNEChunkedSourceEstimate::samples() const
+{
+    return m_iNumTimes;
+}
+
+
+//*************************************************************************************************************
+
+inline float MNEChunkedSourceEstimate::tmin() const
+{
+    return m_fTmin;
+}
+
+
+//*************************************************************************************************************
+
+inline float MNEChunkedSourceEstimate::tstep() const
+{
+    return m_fTstep;
+}
+
+} //NAMESPACE
+
+#endif // MNECHUNKEDSOURCEESTIMATE_H
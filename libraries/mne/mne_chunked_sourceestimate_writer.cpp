@@ -0,0 +1,350 @@
+//=============================================================================================================
+/**
+* @file     mne_chunked_sourceestimate_writer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEChunkedSourceEstimateWriter class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_chunked_sourceestimate_writer.h"
+#include "mne_chunked_sourceestimate.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QtEndian>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MNEChunkedSourceEstimateWriter::MNEChunkedSourceEstimateWriter(const QString& sFileName,
+                                                               qint32 iTileVertices,
+                                                               qint32 iTileTimes)
+: m_file(sFileName)
+, m_iBuffered(0)
+, m_iNumTimes(0)
+, m_iTileVertices(qMax(1, iTileVertices))
+, m_iTileTimes(qMax(1, iTileTimes))
+, m_fTmin(0)
+, m_fTstep(-1)
+{
+}
+
+
+//*************************************************************************************************************
+
+MNEChunkedSourceEstimateWriter::~MNEChunkedSourceEstimateWriter()
+{
+    if(m_file.isOpen()) {
+        finish();
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::begin(const VectorXi& vecVertices,
+                                           float fTmin,
+                                           float fTstep)
+{
+    if(m_file.isOpen()) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::begin - File is already opened" << m_file.fileName();
+        return false;
+    }
+
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::begin - Could not open" << m_file.fileName();
+        return false;
+    }
+
+    m_vecVertices = vecVertices;
+    m_fTmin = fTmin;
+    m_fTstep = fTstep;
+    m_iNumTimes = 0;
+    m_iBuffered = 0;
+    m_vecTileOffsets.clear();
+    m_matBuffer.resize(m_vecVertices.size(), m_iTileTimes);
+
+    // The header is rewritten with the final number of samples and the index offset in finish()
+    if(!writeHeader(0)) {
+        m_file.close();
+        return false;
+    }
+
+    QDataStream t_stream(&m_file);
+    t_stream.setByteOrder(QDataStream::LittleEndian);
+    for(qint32 i = 0; i < m_vecVertices.size(); ++i) {
+        t_stream << static_cast<qint32>(m_vecVertices[i]);
+    }
+
+    return t_stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::append(const MNESourceEstimate& stc)
+{
+    if(!m_file.isOpen()) {
+        if(!begin(stc.vertices, stc.tmin, stc.tstep)) {
+            return false;
+        }
+    } else if(stc.vertices.size() != m_vecVertices.size()) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::append - Vertices do not match the opened file.";
+        return false;
+    }
+
+    return append(MatrixXf(stc.data.cast<float>()));
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::append(const MatrixXf& matData)
+{
+    if(!m_file.isOpen()) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::append - Call begin first.";
+        return false;
+    }
+
+    if(matData.rows() != m_vecVertices.size()) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::append - Number of rows" << matData.rows() << "does not match the number of vertices" << m_vecVertices.size();
+        return false;
+    }
+
+    qint32 iPos = 0;
+    while(iPos < matData.cols()) {
+        const qint32 iCols = qMin(static_cast<qint32>(matData.cols()) - iPos, m_iTileTimes - m_iBuffered);
+
+        m_matBuffer.middleCols(m_iBuffered, iCols) = matData.middleCols(iPos, iCols);
+        m_iBuffered += iCols;
+        iPos += iCols;
+
+        if(m_iBuffered == m_iTileTimes && !flushTiles()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::finish()
+{
+    if(!m_file.isOpen()) {
+        return false;
+    }
+
+    bool bOk = flushTiles();
+
+    // Tile index
+    const quint64 iIndexOffset = m_file.pos();
+    QDataStream t_stream(&m_file);
+    t_stream.setByteOrder(QDataStream::LittleEndian);
+    for(int i = 0; i < m_vecTileOffsets.size(); ++i) {
+        t_stream << m_vecTileOffsets.at(i);
+    }
+    bOk = bOk && t_stream.status() == QDataStream::Ok;
+
+    bOk = bOk && m_file.seek(0) && writeHeader(iIndexOffset);
+
+    m_file.close();
+    m_matBuffer = MatrixXf();
+
+    return bOk;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::convert(QFile& stcFile,
+                                             const QString& sFileName,
+                                             qint32 iTileVertices,
+                                             qint32 iTileTimes)
+{
+    if(!stcFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::convert - Could not open" << stcFile.fileName();
+        return false;
+    }
+
+    // stc layout (big endian): tmin [ms], tstep [ms], n_vertices, vertices, n_times, data. The header is parsed once.
+    QDataStream t_stream(&stcFile);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+    t_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    float fTmin, fTstep;
+    quint32 iNumVertices, iNumTimes;
+
+    t_stream >> fTmin >> fTstep >> iNumVertices;
+
+    if(t_stream.status() != QDataStream::Ok
+       || iNumVertices == 0
+       || static_cast<quint64>(iNumVertices) * sizeof(quint32) > static_cast<quint64>(stcFile.size())) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::convert - Corrupt header in" << stcFile.fileName();
+        stcFile.close();
+        return false;
+    }
+
+    VectorXi vecVertices(iNumVertices);
+    for(quint32 i = 0; i < iNumVertices; ++i) {
+        quint32 iVertex;
+        t_stream >> iVertex;
+        vecVertices[i] = iVertex;
+    }
+    t_stream >> iNumTimes;
+
+    const qint64 iDataOffset = stcFile.pos();
+    const qint64 iDataSize = static_cast<qint64>(iNumVertices) * iNumTimes * sizeof(float);
+
+    if(t_stream.status() != QDataStream::Ok || iNumTimes == 0 || iDataOffset + iDataSize > stcFile.size()) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::convert - Header does not match the size of" << stcFile.fileName();
+        stcFile.close();
+        return false;
+    }
+
+    // The samples are stored one after another, map them once and hand them over a tile row at a time
+    const quint32* pData = reinterpret_cast<const quint32*>(stcFile.map(iDataOffset, iDataSize));
+    if(!pData) {
+        qWarning() << "MNEChunkedSourceEstimateWriter::convert - Could not map" << stcFile.fileName();
+        stcFile.close();
+        return false;
+    }
+
+    MNEChunkedSourceEstimateWriter writer(sFileName, iTileVertices, iTileTimes);
+    bool bOk = writer.begin(vecVertices, fTmin / 1000.0f, fTstep / 1000.0f);
+
+    MatrixXf matBlock(iNumVertices, writer.m_iTileTimes);
+    for(quint32 t = 0; bOk && t < iNumTimes; t += writer.m_iTileTimes) {
+        const qint32 n = qMin<quint32>(writer.m_iTileTimes, iNumTimes - t);
+        if(n < matBlock.cols()) {
+            matBlock.conservativeResize(NoChange, n);
+        }
+
+        quint32* pBlock = reinterpret_cast<quint32*>(matBlock.data());
+        const quint32* pSrc = pData + static_cast<qint64>(t) * iNumVertices;
+
+        for(qint64 i = 0; i < static_cast<qint64>(n) * iNumVertices; ++i) {
+            pBlock[i] = qFromBigEndian<quint32>(pSrc[i]);
+        }
+
+        bOk = writer.append(matBlock);
+    }
+
+    stcFile.unmap(const_cast<uchar*>(reinterpret_cast<const uchar*>(pData)));
+    stcFile.close();
+
+    return writer.finish() && bOk;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::flushTiles()
+{
+    if(m_iBuffered == 0) {
+        return true;
+    }
+
+    MatrixXf matTile;
+    for(qint32 v = 0; v < m_vecVertices.size(); v += m_iTileVertices) {
+        const qint32 iRows = qMin(m_iTileVertices, static_cast<qint32>(m_vecVertices.size()) - v);
+
+        matTile = m_matBuffer.block(v, 0, iRows, m_iBuffered);
+
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        quint32* pData = reinterpret_cast<quint32*>(matTile.data());
+        for(qint64 i = 0; i < matTile.size(); ++i) {
+            pData[i] = qbswap(pData[i]);
+        }
+#endif
+
+        m_vecTileOffsets.append(m_file.pos());
+
+        const qint64 iSize = matTile.size() * sizeof(float);
+        if(m_file.write(reinterpret_cast<const char*>(matTile.data()), iSize) != iSize) {
+            qWarning() << "MNEChunkedSourceEstimateWriter::flushTiles - Could not write to" << m_file.fileName();
+            return false;
+        }
+    }
+
+    m_iNumTimes += m_iBuffered;
+    m_iBuffered = 0;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEChunkedSourceEstimateWriter::writeHeader(quint64 iIndexOffset)
+{
+    QDataStream t_stream(&m_file);
+    t_stream.setByteOrder(QDataStream::LittleEndian);
+    t_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    t_stream.writeRawData(MNEChunkedSourceEstimate::FILE_ID, sizeof(MNEChunkedSourceEstimate::FILE_ID));
+    t_stream << MNEChunkedSourceEstimate::FILE_VERSION
+             << static_cast<quint32>(m_vecVertices.size())
+             << static_cast<quint32>(m_iNumTimes)
+             << static_cast<quint32>(m_iTileVertices)
+             << static_cast<quint32>(m_iTileTimes)
+             << m_fTmin
+             << m_fTstep
+             << static_cast<quint32>(0)
+             << iIndexOffset;
+
+    return t_stream.status() == QDataStream::Ok && m_file.pos() == MNEChunkedSourceEstimate::HEADER_SIZE;
+}
@@ -0,0 +1,202 @@
+//=============================================================================================================
+/**
+* @file     mne_chunked_sourceestimate_writer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEChunkedSourceEstimateWriter class declaration.
+*
+*/
+
+
+#ifndef MNECHUNKEDSOURCEESTIMATEWRITER_H
+#define MNECHUNKEDSOURCEESTIMATEWRITER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_global.h"
+#include "mne_sourceestimate.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QString>
+#include <QFile>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+
+//=============================================================================================================
+/**
+* Writes source estimates in the chunked format read by MNEChunkedSourceEstimate. Samples can be appended
+* block by block, e.g. while an inverse solution is computed, and only one row of tiles
+* (n_vertices x tile samples) is held in memory.
+*
+* @brief Streaming writer for tiled source estimate files
+*/
+class MNESHARED_EXPORT MNEChunkedSourceEstimateWriter
+{
+public:
+    typedef QSharedPointer<MNEChunkedSourceEstimateWriter> SPtr;             /**< Shared pointer type for MNEChunkedSourceEstimateWriter. */
+    typedef QSharedPointer<const MNEChunkedSourceEstimateWriter> ConstSPtr;  /**< Const shared pointer type for MNEChunkedSourceEstimateWriter. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the writer.
+    *
+    * @param[in] sFileName          The file to write to.
+    * @param[in] iTileVertices      The number of vertices per tile.
+    * @param[in] iTileTimes         The number of samples per tile.
+    */
+    explicit MNEChunkedSourceEstimateWriter(const QString& sFileName,
+                                            qint32 iTileVertices = 1024,
+                                            qint32 iTileTimes = 256);
+
+    //=========================================================================================================
+    /**
+    * Destroys the writer and finishes the file if this was not done already.
+    */
+    ~MNEChunkedSourceEstimateWriter();
+
+    //=========================================================================================================
+    /**
+    * Opens the file and writes the header. Has to be called before samples are appended via append(matData).
+    *
+    * @param[in] vecVertices    The vertex indices.
+    * @param[in] fTmin          The time of the first sample in seconds.
+    * @param[in] fTstep         The time step in seconds.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool begin(const Eigen::VectorXi& vecVertices,
+               float fTmin,
+               float fTstep);
+
+    //=========================================================================================================
+    /**
+    * Appends the samples of a source estimate. The first call opens the file with the vertices, tmin and tstep
+    * of the given estimate.
+    *
+    * @param[in] stc    The source estimate to append.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool append(const MNESourceEstimate& stc);
+
+    //=========================================================================================================
+    /**
+    * Appends samples.
+    *
+    * @param[in] matData    The samples to append [n_vertices x n_samples].
+    *
+    * @return true if successful, false otherwise
+    */
+    bool append(const Eigen::MatrixXf& matData);
+
+    //=========================================================================================================
+    /**
+    * Writes the remaining samples and the tile index and closes the file.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool finish();
+
+    //=========================================================================================================
+    /**
+    * Converts a stc file to the chunked format. The stc header is parsed once, the samples are mapped and
+    * handed over one row of tiles at a time.
+    *
+    * @param[in] stcFile            The stc file to convert.
+    * @param[in] sFileName          The file to write to.
+    * @param[in] iTileVertices      The number of vertices per tile.
+    * @param[in] iTileTimes         The number of samples per tile.
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool convert(QFile& stcFile,
+                        const QString& sFileName,
+                        qint32 iTileVertices = 1024,
+                        qint32 iTileTimes = 256);
+
+private:
+    //=========================================================================================================
+    /**
+    * Writes the buffered samples as one row of tiles.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool flushTiles();
+
+    //=========================================================================================================
+    /**
+    * Writes the header.
+    *
+    * @param[in] iIndexOffset   The offset of the tile index.
+    *
+    * @return true if successful, false otherwise
+    */
+    bool writeHeader(quint64 iIndexOffset);
+
+    QFile               m_file;             /**< The file to write to. */
+    Eigen::VectorXi     m_vecVertices;      /**< The vertex indices. */
+    Eigen::MatrixXf     m_matBuffer;        /**< The samples of the current row of tiles. */
+    qint32              m_iBuffered;        /**< The number of samples in m_matBuffer. */
+    qint32              m_iNumTimes;        /**< The number of samples written so far. */
+    qint32              m_iTileVertices;    /**< The number of vertices per tile. */
+    qint32              m_iTileTimes;       /**< The number of samples per tile. */
+    float               m_fTmin;            /**< The time of the first sample in seconds. */
+    float               m_fTstep;           /**< The time step in seconds. */
+    QVector<quint64>    m_vecTileOffsets;   /**< The offsets of the written tiles. */
+};
+
+} //NAMESPACE
+
+#endif // MNECHUNKEDSOURCEESTIMATEWRITER_H
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "mne_epoch_data_list.h"
+#include "mne_epoch_tensor.h"
 
 #include <utils/mnemath.h>
 
@@ -50,6 +51,17 @@
 
 #include <QPointer>
 #include <QtConcurrent>
+#include <QVector>
+#include <QPair>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <functional>
 
 
 //*************************************************************************************************************
@@ -96,8 +108,32 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
                                               const QString& sChType,
                                               const RowVectorXi& picks)
 {
-    MNEEpochDataList data;
+    MNEEpochTensor<double> tensor = readEpochTensor(raw,
+                                                    events,
+                                                    tmin,
+                                                    tmax,
+                                                    event,
+                                                    dEOGThreshold,
+                                                    sChType,
+                                                    picks);
+
+    qDebug() << "Read total of"<< tensor.epochs() <<"epochs and dropped"<< tensor.rejectedCount() <<"of them";
+
+    return tensor.toEpochDataList();
+}
 
+
+//*************************************************************************************************************
+
+MNEEpochTensor<double> MNEEpochDataList::readEpochTensor(const FiffRawData& raw,
+                                                         const MatrixXi& events,
+                                                         float tmin,
+                                                         float tmax,
+                                                         qint32 event,
+                                                         double dEOGThreshold,
+                                                         const QString& sChType,
+                                                         const RowVectorXi& picks)
+{
     // Select the desired events
     qint32 count = 0;
     qint32 p;
@@ -115,7 +151,7 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
         printf("%d matching events found\n",count);
     } else {
         printf("No desired events found.\n");
-        return MNEEpochDataList();
+        return MNEEpochTensor<double>();
     }
 
     // If picks are empty, pick all
@@ -127,58 +163,133 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
         }
     }
 
+    // Set up all epochs in event order. Epochs which are not completely covered by the raw data are skipped,
+    // all others need to have the same size as the first one.
     fiff_int_t event_samp, from, to;
-    fiff_int_t dropCount = 0;
-    MatrixXd timesDummy;
-    MatrixXd times;
+    qint32 nSamples = -1;
 
-    MNEEpochData* epoch = Q_NULLPTR;
+    QVector<fiff_int_t> vecFrom;
+    QVector<fiff_int_t> vecTo;
+    QVector<QPair<fiff_int_t, qint32> > vecStarts;
 
     for (p = 0; p < count; ++p) {
-        // Read a data segment
         event_samp = events(selected(p),0);
         from = event_samp + tmin*raw.info.sfreq;
         to   = event_samp + floor(tmax*raw.info.sfreq + 0.5);
 
-        epoch = new MNEEpochData();
+        if(from < raw.first_samp || to > raw.last_samp || from > to) {
+            printf("Can't read the event data segments\n");
+            continue;
+        }
 
-        if(raw.read_raw_segment(epoch->epoch, timesDummy, from, to, picksNew)) {
-            if (p == 0) {
-                times.resize(1, to-from+1);
-                for (qint32 i = 0; i < times.cols(); ++i)
-                    times(0, i) = ((float)(from-event_samp+i)) / raw.info.sfreq;
-            }
+        if(nSamples == -1) {
+            nSamples = to-from+1;
+        } else if(to-from+1 != nSamples) {
+            continue;
+        }
+
+        vecStarts.append(qMakePair(from, vecFrom.size()));
+        vecFrom.append(from);
+        vecTo.append(to);
+    }
+
+    if(vecFrom.isEmpty()) {
+        return MNEEpochTensor<double>();
+    }
+
+    // All epochs go into one contiguous block
+    MNEEpochTensor<double> tensor(vecFrom.size(), picksNew.cols(), nSamples);
 
-            epoch->event = event;
-            epoch->tmin = ((float)(from)-(float)(raw.first_samp))/raw.info.sfreq;
-            epoch->tmax = ((float)(to)-(float)(raw.first_samp))/raw.info.sfreq;
+    for(qint32 i = 0; i < vecFrom.size(); ++i) {
+        tensor.setEpochInfo(i,
+                            event,
+                            ((float)(vecFrom.at(i))-(float)(raw.first_samp))/raw.info.sfreq,
+                            ((float)(vecTo.at(i))-(float)(raw.first_samp))/raw.info.sfreq,
+                            false);
+    }
+
+    // Stream the file once in order of the epoch starts. Each buffer is decoded once and scattered into all
+    // epochs it overlaps with.
+    std::sort(vecStarts.begin(), vecStarts.end());
+
+    QList<int> lArtifactChannels = artifactChannels(raw.info, sChType);
+    if(lArtifactChannels.isEmpty()) {
+        qDebug() << "MNEEpochDataList::readEpochTensor - No channels found to scan for artifacts.";
+    }
+
+    SparseMatrix<double> mult = raw.create_operator(picksNew);
+    MatrixXd matBuffer;
+    QList<qint32> lOpen;
+    QVector<bool> vecComplete(tensor.epochs(), false);
+    QList<QFuture<bool> > lRejectFutures;
+    QList<qint32> lRejectIdx;
+    qint32 iNext = 0;
 
-            epoch->bReject = checkForArtifact(epoch->epoch,
-                                              raw.info,
-                                              dEOGThreshold,
-                                              "threshold",
-                                              sChType);
+    for(qint32 k = 0; k < raw.rawdir.size() && (iNext < vecStarts.size() || !lOpen.isEmpty()); ++k) {
+        const FiffRawDir& thisRawDir = raw.rawdir[k];
 
-            if (epoch->bReject) {
-                dropCount++;
+        while(iNext < vecStarts.size() && vecStarts[iNext].first <= thisRawDir.last) {
+            lOpen.append(vecStarts[iNext].second);
+            ++iNext;
+        }
+
+        if(lOpen.isEmpty()) {
+            continue;
+        }
+
+        // Epochs overlapping a buffer which can not be read stay incomplete and are skipped
+        if(!raw.read_raw_buffer(k, mult, matBuffer)) {
+            lOpen.clear();
+            continue;
+        }
+
+        QMutableListIterator<qint32> itOpen(lOpen);
+        while(itOpen.hasNext()) {
+            const qint32 idx = itOpen.next();
+            const fiff_int_t epochFrom = vecFrom.at(idx);
+            const fiff_int_t epochTo = vecTo.at(idx);
+
+            const fiff_int_t first = qMax(epochFrom, thisRawDir.first);
+            const fiff_int_t last = qMin(epochTo, thisRawDir.last);
+
+            if(last >= first) {
+                tensor.epoch(idx).middleCols(first - epochFrom, last - first + 1) = matBuffer.middleCols(first - thisRawDir.first, last - first + 1);
             }
 
-            //Check if data block has the same size as the previous one
-            if(!data.isEmpty()) {
-                if(epoch->epoch.size() == data.last()->epoch.size()) {
-                    data.append(MNEEpochData::SPtr(epoch));//List takes ownwership of the pointer - no delete need
+            // The epoch is complete, scan it for artifacts while reading continues. Only the scanned epoch is
+            // read by the task, later buffers are written to other epochs.
+            if(epochTo <= thisRawDir.last) {
+                vecComplete[idx] = true;
+                if(!lArtifactChannels.isEmpty()) {
+                    const MNEEpochTensor<double>* pTensor = &tensor;
+                    lRejectFutures.append(QtConcurrent::run([pTensor, idx, lArtifactChannels, dEOGThreshold]() {
+                        return pTensor->checkForArtifact(idx, lArtifactChannels, dEOGThreshold, QString("threshold"));
+                    }));
+                    lRejectIdx.append(idx);
                 }
-            } else {
-                data.append(MNEEpochData::SPtr(epoch));//List takes ownwership of the pointer - no delete need
+                itOpen.remove();
             }
-        } else {
-            printf("Can't read the event data segments");
         }
     }
 
-    qDebug() << "Read total of"<< data.size() <<"epochs and dropped"<< dropCount <<"of them";
+    for(qint32 i = 0; i < lRejectFutures.size(); ++i) {
+        tensor.setRejected(lRejectIdx.at(i), lRejectFutures[i].result());
+    }
+
+    // Remove the epochs which could not be read completely
+    QVector<bool> vecIncomplete(tensor.epochs(), false);
+    for(qint32 i = 0; i < tensor.epochs(); ++i) {
+        if(!vecComplete.at(i)) {
+            printf("Can't read the event data segments\n");
+            vecIncomplete[i] = true;
+        }
+    }
+
+    if(vecIncomplete.contains(true)) {
+        tensor.removeEpochs(vecIncomplete);
+    }
 
-    return data;
+    return tensor;
 }
 
 
@@ -284,46 +395,14 @@ bool MNEEpochDataList::checkForArtifact(MatrixXd& data,
     //Prepare concurrent data handling
     QList<ArtifactRejectionData> lchData;
 
-    int iChType = FIFFV_EOG_CH;
-
-    if(sChType.contains("grad", Qt::CaseInsensitive) ||
-       sChType.contains("mag", Qt::CaseInsensitive) ) {
-        iChType = FIFFV_MEG_CH;
-    }
+    const QList<int> lChannels = artifactChannels(pFiffInfo, sChType);
 
-    if(sChType.contains("eeg", Qt::CaseInsensitive)) {
-        iChType = FIFFV_EEG_CH;
-    }
-
-    for(int i = 0; i < pFiffInfo.chs.size(); ++i) {
-        if(pFiffInfo.chs.at(i).kind == iChType
-           && !pFiffInfo.bads.contains(pFiffInfo.chs.at(i).ch_name)
-           && pFiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG
-           && pFiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG2) {
-            if(iChType == FIFFV_MEG_CH) {
-                if(sChType.contains("grad", Qt::CaseInsensitive) &&
-                   pFiffInfo.chs.at(i).unit == FIFF_UNIT_T_M) {
-                    ArtifactRejectionData tempData;
-                    tempData.bRejected = false;
-                    tempData.data = data.row(i);
-                    tempData.dThreshold = dThreshold;
-                    lchData.append(tempData);
-                } else if(sChType.contains("mag", Qt::CaseInsensitive) &&
-                          pFiffInfo.chs.at(i).unit == FIFF_UNIT_T) {
-                    ArtifactRejectionData tempData;
-                    tempData.bRejected = false;
-                    tempData.data = data.row(i);
-                    tempData.dThreshold = dThreshold;
-                    lchData.append(tempData);
-                }
-            } else {
-                ArtifactRejectionData tempData;
-                tempData.bRejected = false;
-                tempData.data = data.row(i);
-                tempData.dThreshold = dThreshold;
-                lchData.append(tempData);
-            }
-        }
+    for(int i = 0; i < lChannels.size(); ++i) {
+        ArtifactRejectionData tempData;
+        tempData.bRejected = false;
+        tempData.data = data.row(lChannels.at(i));
+        tempData.dThreshold = dThreshold;
+        lchData.append(tempData);
     }
 
     if(lchData.isEmpty()) {
@@ -336,9 +415,8 @@ bool MNEEpochDataList::checkForArtifact(MatrixXd& data,
 //    qDebug() << "MNEEpochDataList::checkForArtifact - iChType" << iChType;
 
     if(sCheckType.contains("threshold", Qt::CaseInsensitive)) {
-        //Start the concurrent processing
-        QFuture<void> future = QtConcurrent::map(lchData, checkChThreshold);
-        future.waitForFinished();
+        //Start the concurrent processing. The calling thread takes part, so this can also be called from a pool thread.
+        QtConcurrent::blockingMap(lchData, checkChThreshold);
 
         for(int i = 0; i < lchData.size(); ++i) {
             if(lchData.at(i).bRejected) {
@@ -348,9 +426,8 @@ bool MNEEpochDataList::checkForArtifact(MatrixXd& data,
             }
         }
     } else if(sCheckType.contains("variance", Qt::CaseInsensitive)) {
-        //Start the concurrent processing
-        QFuture<void> future = QtConcurrent::map(lchData, checkChVariance);
-        future.waitForFinished();
+        //Start the concurrent processing. The calling thread takes part, so this can also be called from a pool thread.
+        QtConcurrent::blockingMap(lchData, checkChVariance);
 
         for(int i = 0; i < lchData.size(); ++i) {
             if(lchData.at(i).bRejected) {
@@ -365,6 +442,47 @@ bool MNEEpochDataList::checkForArtifact(MatrixXd& data,
 }
 
 
+//*************************************************************************************************************
+
+QList<int> MNEEpochDataList::artifactChannels(const FiffInfo& pFiffInfo,
+                                              const QString& sChType)
+{
+    QList<int> lChannels;
+
+    int iChType = FIFFV_EOG_CH;
+
+    if(sChType.contains("grad", Qt::CaseInsensitive) ||
+       sChType.contains("mag", Qt::CaseInsensitive) ) {
+        iChType = FIFFV_MEG_CH;
+    }
+
+    if(sChType.contains("eeg", Qt::CaseInsensitive)) {
+        iChType = FIFFV_EEG_CH;
+    }
+
+    for(int i = 0; i < pFiffInfo.chs.size(); ++i) {
+        if(pFiffInfo.chs.at(i).kind == iChType
+           && !pFiffInfo.bads.contains(pFiffInfo.chs.at(i).ch_name)
+           && pFiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG
+           && pFiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG2) {
+            if(iChType == FIFFV_MEG_CH) {
+                if(sChType.contains("grad", Qt::CaseInsensitive) &&
+                   pFiffInfo.chs.at(i).unit == FIFF_UNIT_T_M) {
+                    lChannels.append(i);
+                } else if(sChType.contains("mag", Qt::CaseInsensitive) &&
+                          pFiffInfo.chs.at(i).unit == FIFF_UNIT_T) {
+                    lChannels.append(i);
+                }
+            } else {
+                lChannels.append(i);
+            }
+        }
+    }
+
+    return lChannels;
+}
+
+
 //*************************************************************************************************************
 
 void MNEEpochDataList::checkChVariance(ArtifactRejectionData& inputData)
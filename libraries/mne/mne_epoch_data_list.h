@@ -66,6 +66,15 @@
 namespace MNELIB
 {
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+template<typename T> class MNEEpochTensor;
+
+
 struct ArtifactRejectionData {
     bool bRejected;
     Eigen::RowVectorXd data;
@@ -111,6 +120,8 @@ public:
     *                           The mean is subtracted from the EOG channel data before checking the threshold.
     * @param[in] sChType        The channel data type to scan for. EEG, MEG or EOG (default is EOG).
     * @param[in] picks          Which channels to pick.
+    *
+    * @return   The epochs, copied out of the tensor returned by readEpochTensor.
     */
     static MNEEpochDataList readEpochs(const FIFFLIB::FiffRawData& raw,
                                        const Eigen::MatrixXi& events,
@@ -121,6 +132,34 @@ public:
                                        const QString& sChType = QString("eog"),
                                        const Eigen::RowVectorXi& picks = Eigen::RowVectorXi());
 
+    //=========================================================================================================
+    /**
+    * Read the epochs from a raw file based on provided events into one contiguous epochs x channels x times block.
+    * The file is streamed once, each buffer is scattered into all epochs it overlaps with. Completed epochs are
+    * scanned for artifacts while reading continues. Epochs which are not completely covered by the raw data are
+    * skipped.
+    *
+    * @param[in] raw            The raw data.
+    * @param[in] events         The events provided in samples and event kind.
+    * @param[in] tmin           The start time relative to the event in samples.
+    * @param[in] tmax           The end time relative to the event in samples.
+    * @param[in] event          The event kind.
+    * @param[in] dEOGThreshold  The threshold value to use to reject epochs based on the EOG channel.
+    *                           No filtering is performed on the EOG channel. Default is set to no rejection.
+    * @param[in] sChType        The channel data type to scan for. EEG, MEG or EOG (default is EOG).
+    * @param[in] picks          Which channels to pick.
+    *
+    * @return   The epoch tensor. Rejected epochs are flagged, not removed.
+    */
+    static MNEEpochTensor<double> readEpochTensor(const FIFFLIB::FiffRawData& raw,
+                                                  const Eigen::MatrixXi& events,
+                                                  float tmin,
+                                                  float tmax,
+                                                  qint32 event,
+                                                  double dEOGThreshold = 0.0,
+                                                  const QString& sChType = QString("eog"),
+                                                  const Eigen::RowVectorXi& picks = Eigen::RowVectorXi());
+
     //=========================================================================================================
     /**
     * Averages epoch list.
@@ -169,6 +208,18 @@ public:
                                  const QString& sCheckType = QString("threshold"),
                                  const QString& sChType = QString("eog"));
 
+    //=========================================================================================================
+    /**
+    * Returns the channels which are scanned for artifacts, i.e., all good channels of the given type.
+    *
+    * @param[in] pFiffInfo      The fiff info.
+    * @param[in] sChType        The channel data type to scan for. EEG, MEG (grad, mag) or EOG (default is EOG).
+    *
+    * @return   The indices of the channels to scan.
+    */
+    static QList<int> artifactChannels(const FIFFLIB::FiffInfo& pFiffInfo,
+                                       const QString& sChType = QString("eog"));
+
     static void checkChVariance(ArtifactRejectionData& inputData);
     static void checkChThreshold(ArtifactRejectionData& inputData);
 };
@@ -0,0 +1,910 @@
+//=============================================================================================================
+/**
+* @file     mne_epoch_tensor.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEEpochTensor class declaration.
+*
+*/
+
+
+#ifndef MNE_EPOCH_TENSOR_H
+#define MNE_EPOCH_TENSOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_global.h"
+#include "mne_epoch_data.h"
+#include "mne_epoch_data_list.h"
+
+#include <fiff/fiff_types.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_evoked.h>
+
+#include <utils/mnemath.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QPair>
+#include <QDebug>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//=============================================================================================================
+/**
+* Stores a set of equally sized epochs in a single contiguous allocation. The data are kept as one
+* channels x (times * epochs) matrix, so every epoch is a contiguous column block which can be used
+* as an Eigen view without copying. Averaging, baseline correction, artifact rejection and channel picking
+* run as vectorized kernels on the packed data and are distributed over the available cores.
+*
+* @brief Packed epoch tensor (epochs x channels x times)
+*/
+template<typename T>
+class MNEEpochTensor
+{
+public:
+    typedef QSharedPointer<MNEEpochTensor> SPtr;                                    /**< Shared pointer type for MNEEpochTensor. */
+    typedef QSharedPointer<const MNEEpochTensor> ConstSPtr;                         /**< Const shared pointer type for MNEEpochTensor. */
+
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MatrixT;               /**< Matrix type of the stored data. */
+    typedef Eigen::Block<MatrixT, Eigen::Dynamic, Eigen::Dynamic, true> EpochView;               /**< Writable view of one epoch (channels x times). */
+    typedef const Eigen::Block<const MatrixT, Eigen::Dynamic, Eigen::Dynamic, true> ConstEpochView; /**< Read only view of one epoch (channels x times). */
+
+    //=========================================================================================================
+    /**
+    * Default constructor.
+    */
+    MNEEpochTensor();
+
+    //=========================================================================================================
+    /**
+    * Constructs a zero initialized tensor.
+    *
+    * @param[in] iNumEpochs     The number of epochs.
+    * @param[in] iNumChannels   The number of channels.
+    * @param[in] iNumTimes      The number of time samples per epoch.
+    */
+    MNEEpochTensor(qint32 iNumEpochs,
+                   qint32 iNumChannels,
+                   qint32 iNumTimes);
+
+    //=========================================================================================================
+    /**
+    * Packs an epoch list. All epochs need to have the same size as the first one, others are skipped.
+    *
+    * @param[in] lEpochs        The epochs to pack.
+    */
+    explicit MNEEpochTensor(const MNEEpochDataList& lEpochs);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of epochs.
+    *
+    * @return the number of epochs.
+    */
+    inline qint32 epochs() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of channels.
+    */
+    inline qint32 channels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of time samples per epoch.
+    *
+    * @return the number of time samples.
+    */
+    inline qint32 times() const;
+
+    //=========================================================================================================
+    /**
+    * Returns a view of the data of one epoch.
+    *
+    * @param[in] i      The epoch index.
+    *
+    * @return the epoch data (channels x times).
+    */
+    inline EpochView epoch(qint32 i);
+    inline ConstEpochView epoch(qint32 i) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the packed data (channels x (times * epochs)).
+    *
+    * @return the packed data.
+    */
+    inline const MatrixT& data() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the description of one epoch.
+    *
+    * @param[in] i          The epoch index.
+    * @param[in] event      The event code.
+    * @param[in] tmin       The start time.
+    * @param[in] tmax       The end time.
+    * @param[in] bReject    Whether this epoch is to be rejected.
+    */
+    void setEpochInfo(qint32 i,
+                      FIFFLIB::fiff_int_t event,
+                      float tmin,
+                      float tmax,
+                      bool bReject = false);
+
+    inline FIFFLIB::fiff_int_t event(qint32 i) const;  /**< The event code of epoch i. */
+    inline float tmin(qint32 i) const;                  /**< The start time of epoch i. */
+    inline float tmax(qint32 i) const;                  /**< The end time of epoch i. */
+    inline bool isRejected(qint32 i) const;             /**< Whether epoch i is to be rejected. */
+    inline void setRejected(qint32 i, bool bReject);    /**< Sets whether epoch i is to be rejected. */
+    inline qint32 rejectedCount() const;                /**< The number of epochs to be rejected. */
+
+    //=========================================================================================================
+    /**
+    * Copies one epoch into an MNEEpochData object.
+    *
+    * @param[in] i      The epoch index.
+    *
+    * @return the epoch data.
+    */
+    MNEEpochData::SPtr epochData(qint32 i) const;
+
+    //=========================================================================================================
+    /**
+    * Copies all epochs into an epoch list.
+    *
+    * @return the epoch list.
+    */
+    MNEEpochDataList toEpochDataList() const;
+
+    //=========================================================================================================
+    /**
+    * Averages the epochs.
+    *
+    * @param[in] sel    Which epochs should be averaged (optional, default all).
+    *
+    * @return the average (channels x times).
+    */
+    Eigen::MatrixXd average(const Eigen::VectorXi& sel = FIFFLIB::defaultVectorXi) const;
+
+    //=========================================================================================================
+    /**
+    * Averages the epochs the same way MNEEpochDataList::average does.
+    *
+    * @param[in] info     measurement info
+    * @param[in] first    First time sample
+    * @param[in] last     Last time sample
+    * @param[in] sel      Which epochs should be averaged (optional)
+    * @param[in] proj     Apply SSP projection vectors (optional, default = false)
+    *
+    * @return the evoked data.
+    */
+    FIFFLIB::FiffEvoked average(FIFFLIB::FiffInfo& info,
+                                FIFFLIB::fiff_int_t first,
+                                FIFFLIB::fiff_int_t last,
+                                const Eigen::VectorXi& sel = FIFFLIB::defaultVectorXi,
+                                bool proj = false) const;
+
+    //=========================================================================================================
+    /**
+    * Applies a baseline correction to every epoch in place. The modes are the same as for MNEMath::rescale.
+    *
+    * @param[in] times      Time vector in seconds.
+    * @param[in] baseline   The time interval to apply rescaling / baseline correction. If first is invalid, the beginning
+    *                       of the data is used; if second is invalid the end of the data is used.
+    * @param[in] mode       "logratio" | "ratio" | "zscore" | "mean" | "percent" (default "mean").
+    */
+    void rescale(const Eigen::RowVectorXf& times,
+                 QPair<QVariant,QVariant> baseline,
+                 const QString& mode = QString("mean"));
+
+    //=========================================================================================================
+    /**
+    * Checks all epochs for artifacts, the same way MNEEpochDataList::checkForArtifact does, and marks them as rejected.
+    *
+    * @param[in] pFiffInfo      The fiff info.
+    * @param[in] dThreshold     The thresholded value.
+    * @param[in] sCheckType     The detection type. Threshold or variance based (default is Threshold).
+    * @param[in] sChType        The channel data type to scan for. EEG, MEG or EOG (default is EOG).
+    *
+    * @return   The number of rejected epochs.
+    */
+    qint32 checkForArtifacts(const FIFFLIB::FiffInfo& pFiffInfo,
+                             double dThreshold,
+                             const QString& sCheckType = QString("threshold"),
+                             const QString& sChType = QString("eog"));
+
+    //=========================================================================================================
+    /**
+    * Checks one epoch for artifacts, the same way MNEEpochDataList::checkForArtifact does. The rejection flag of the
+    * epoch is not changed. Can be called for different epochs from several threads at once.
+    *
+    * @param[in] i              The epoch index.
+    * @param[in] lChannels      The channels to scan, see MNEEpochDataList::artifactChannels.
+    * @param[in] dThreshold     The thresholded value.
+    * @param[in] sCheckType     The detection type. Threshold or variance based (default is Threshold).
+    *
+    * @return   Whether an artifact was detected.
+    */
+    bool checkForArtifact(qint32 i,
+                          const QList<int>& lChannels,
+                          double dThreshold,
+                          const QString& sCheckType = QString("threshold")) const;
+
+    //=========================================================================================================
+    /**
+    * Drop/Remove all epochs tagged as rejected. The remaining epochs are moved in place.
+    */
+    void dropRejected();
+
+    //=========================================================================================================
+    /**
+    * Removes the given epochs. The remaining epochs are moved in place.
+    *
+    * @param[in] vecRemove      Whether to remove each epoch, one entry per epoch.
+    */
+    void removeEpochs(const QVector<bool>& vecRemove);
+
+    //=========================================================================================================
+    /**
+    * Reduces all epochs to the selected rows.
+    *
+    * @param[in] sel     The selected rows to keep.
+    */
+    void pick_channels(const Eigen::RowVectorXi& sel);
+
+private:
+    //=========================================================================================================
+    /**
+    * Calls func(iBegin, iEnd) for consecutive ranges which cover [0, iCount) on all available cores.
+    *
+    * @param[in] iCount     The number of items.
+    * @param[in] func       The function to call for each range.
+    */
+    template<typename Func>
+    static void parallelFor(qint32 iCount,
+                            Func func);
+
+    MatrixT                             m_matData;          /**< The packed data (channels x (times * epochs)). */
+    qint32                              m_iNumTimes;        /**< The number of time samples per epoch. */
+    QVector<FIFFLIB::fiff_int_t>        m_vecEvent;         /**< The event code of each epoch. */
+    QVector<float>                      m_vecTmin;          /**< The start time of each epoch. */
+    QVector<float>                      m_vecTmax;          /**< The end time of each epoch. */
+    QVector<bool>                       m_vecReject;        /**< Whether each epoch is to be rejected. */
+};
+
+typedef MNEEpochTensor<double>  MNEEpochTensorD;            /**< Double precision epoch tensor. */
+typedef MNEEpochTensor<float>   MNEEpochTensorF;            /**< Single precision epoch tensor. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename T>
+MNEEpochTensor<T>::MNEEpochTensor()
+: m_iNumTimes(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+MNEEpochTensor<T>::MNEEpochTensor(qint32 iNumEpochs,
+                                  qint32 iNumChannels,
+                                  qint32 iNumTimes)
+: m_matData(MatrixT::Zero(iNumChannels, iNumTimes * iNumEpochs))
+, m_iNumTimes(iNumTimes)
+, m_vecEvent(iNumEpochs, -1)
+, m_vecTmin(iNumEpochs, -1.0f)
+, m_vecTmax(iNumEpochs, -1.0f)
+, m_vecReject(iNumEpochs, false)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+MNEEpochTensor<T>::MNEEpochTensor(const MNEEpochDataList& lEpochs)
+: m_iNumTimes(0)
+{
+    if(lEpochs.isEmpty()) {
+        return;
+    }
+
+    const qint32 iNumChannels = lEpochs.first()->epoch.rows();
+    m_iNumTimes = lEpochs.first()->epoch.cols();
+
+    qint32 iNumEpochs = 0;
+    for(qint32 i = 0; i < lEpochs.size(); ++i) {
+        if(lEpochs.at(i)->epoch.rows() == iNumChannels && lEpochs.at(i)->epoch.cols() == m_iNumTimes) {
+            ++iNumEpochs;
+        }
+    }
+
+    m_matData.resize(iNumChannels, m_iNumTimes * iNumEpochs);
+    m_vecEvent.resize(iNumEpochs);
+    m_vecTmin.resize(iNumEpochs);
+    m_vecTmax.resize(iNumEpochs);
+    m_vecReject.resize(iNumEpochs);
+
+    qint32 e = 0;
+    for(qint32 i = 0; i < lEpochs.size(); ++i) {
+        const MNEEpochData::SPtr& pEpoch = lEpochs.at(i);
+        if(pEpoch->epoch.rows() != iNumChannels || pEpoch->epoch.cols() != m_iNumTimes) {
+            qWarning("MNEEpochTensor - Warning : Epoch %d has a different size and is skipped.\n", i);
+            continue;
+        }
+
+        epoch(e) = pEpoch->epoch.template cast<T>();
+        setEpochInfo(e, pEpoch->event, pEpoch->tmin, pEpoch->tmax, pEpoch->bReject);
+        ++e;
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline qint32 MNEEpochTensor<T>::epochs() const
+{
+    return m_vecEvent.size();
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline qint32 MNEEpochTensor<T>::channels() const
+{
+    return m_matData.rows();
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline qint32 MNEEpochTensor<T>::times() const
+{
+    return m_iNumTimes;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline typename MNEEpochTensor<T>::EpochView MNEEpochTensor<T>::epoch(qint32 i)
+{
+    return m_matData.middleCols(i * m_iNumTimes, m_iNumTimes);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline typename MNEEpochTensor<T>::ConstEpochView MNEEpochTensor<T>::epoch(qint32 i) const
+{
+    return m_matData.middleCols(i * m_iNumTimes, m_iNumTimes);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline const typename MNEEpochTensor<T>::MatrixT& MNEEpochTensor<T>::data() const
+{
+    return m_matData;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void MNEEpochTensor<T>::setEpochInfo(qint32 i,
+                                     FIFFLIB::fiff_int_t event,
+                                     float tmin,
+                                     float tmax,
+                                     bool bReject)
+{
+    m_vecEvent[i] = event;
+    m_vecTmin[i] = tmin;
+    m_vecTmax[i] = tmax;
+    m_vecReject[i] = bReject;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline FIFFLIB::fiff_int_t MNEEpochTensor<T>::event(qint32 i) const
+{
+    return m_vecEvent.at(i);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline float MNEEpochTensor<T>::tmin(qint32 i) const
+{
+    return m_vecTmin.at(i);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline float MNEEpochTensor<T>::tmax(qint32 i) const
+{
+    return m_vecTmax.at(i);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline bool MNEEpochTensor<T>::isRejected(qint32 i) const
+{
+    return m_vecReject.at(i);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline void MNEEpochTensor<T>::setRejected(qint32 i, bool bReject)
+{
+    m_vecReject[i] = bReject;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline qint32 MNEEpochTensor<T>::rejectedCount() const
+{
+    return m_vecReject.count(true);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+MNEEpochData::SPtr MNEEpochTensor<T>::epochData(qint32 i) const
+{
+    MNEEpochData::SPtr pEpoch = MNEEpochData::SPtr(new MNEEpochData());
+    pEpoch->epoch = epoch(i).template cast<double>();
+    pEpoch->event = m_vecEvent.at(i);
+    pEpoch->tmin = m_vecTmin.at(i);
+    pEpoch->tmax = m_vecTmax.at(i);
+    pEpoch->bReject = m_vecReject.at(i);
+
+    return pEpoch;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+MNEEpochDataList MNEEpochTensor<T>::toEpochDataList() const
+{
+    MNEEpochDataList lEpochs;
+    lEpochs.reserve(epochs());
+
+    for(qint32 i = 0; i < epochs(); ++i) {
+        lEpochs.append(epochData(i));
+    }
+
+    return lEpochs;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+Eigen::MatrixXd MNEEpochTensor<T>::average(const Eigen::VectorXi& sel) const
+{
+    const qint32 iNumValues = channels() * m_iNumTimes;
+    const qint32 iNumAve = sel.size() > 0 ? sel.size() : epochs();
+
+    Eigen::MatrixXd matAverage = Eigen::MatrixXd::Zero(channels(), m_iNumTimes);
+
+    if(iNumValues == 0 || iNumAve == 0) {
+        return matAverage;
+    }
+
+    // Every epoch is one column of the (channels * times) x epochs view of the packed data
+    Eigen::Map<const MatrixT> matEpochs(m_matData.data(), iNumValues, epochs());
+    Eigen::Map<Eigen::VectorXd> vecAverage(matAverage.data(), iNumValues);
+
+    parallelFor(iNumValues, [&](qint32 iBegin, qint32 iEnd) {
+        const qint32 iRows = iEnd - iBegin;
+
+        if(sel.size() > 0) {
+            for(qint32 i = 0; i < sel.size(); ++i) {
+                vecAverage.segment(iBegin, iRows) += matEpochs.col(sel(i)).segment(iBegin, iRows).template cast<double>();
+            }
+        } else {
+            vecAverage.segment(iBegin, iRows) = matEpochs.middleRows(iBegin, iRows).template cast<double>().rowwise().sum();
+        }
+
+        vecAverage.segment(iBegin, iRows) /= iNumAve;
+    });
+
+    return matAverage;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+FIFFLIB::FiffEvoked MNEEpochTensor<T>::average(FIFFLIB::FiffInfo& info,
+                                               FIFFLIB::fiff_int_t first,
+                                               FIFFLIB::fiff_int_t last,
+                                               const Eigen::VectorXi& sel,
+                                               bool proj) const
+{
+    FIFFLIB::FiffEvoked p_evoked;
+
+    printf("Calculate evoked... ");
+
+    if(epochs() == 0) {
+        p_evoked.aspect_kind = FIFFV_ASPECT_STD_ERR;
+        return p_evoked;
+    }
+
+    Eigen::MatrixXd matAverage = average(sel);
+    p_evoked.nave = sel.size() > 0 ? sel.size() : epochs();
+
+    printf("%d averages used [done]\n ", p_evoked.nave);
+
+    p_evoked.setInfo(info, proj);
+
+    p_evoked.aspect_kind = FIFFV_ASPECT_AVERAGE;
+
+    p_evoked.first = first;
+    p_evoked.last = last;
+
+    Eigen::RowVectorXf times = Eigen::RowVectorXf(last-first+1);
+    for (qint32 k = 0; k < times.size(); ++k) {
+        times[k] = ((float)(first+k)) / info.sfreq;
+    }
+
+    p_evoked.times = times;
+
+    p_evoked.comment = QString::number(m_vecEvent.first());
+
+    if(p_evoked.proj.rows() > 0) {
+        matAverage = p_evoked.proj * matAverage;
+        printf("\tSSP projectors applied to the evoked data\n");
+    }
+
+    QPair<QVariant,QVariant> pairBaselineSec;
+    pairBaselineSec.first = m_vecTmin.first();
+    pairBaselineSec.second = m_vecTmax.first();
+
+    p_evoked.data = UTILSLIB::MNEMath::rescale(matAverage, times, pairBaselineSec, QString("mean"));
+
+    return p_evoked;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void MNEEpochTensor<T>::rescale(const Eigen::RowVectorXf& times,
+                                QPair<QVariant,QVariant> baseline,
+                                const QString& mode)
+{
+    QStringList valid_modes;
+    valid_modes << "logratio" << "ratio" << "zscore" << "mean" << "percent";
+    if(!valid_modes.contains(mode)) {
+        qWarning() << "\tWarning: mode should be any of : " << valid_modes;
+        return;
+    }
+
+    if(times.size() != m_iNumTimes) {
+        qWarning() << "MNEEpochTensor::rescale - Warning : Size of the time vector does not match the number of samples.";
+        return;
+    }
+
+    // Baseline interval, see MNEMath::rescale
+    qint32 imin = 0;
+    qint32 imax = times.size();
+
+    if(baseline.first.isValid()) {
+        float bmin = baseline.first.toFloat();
+        for(qint32 i = 0; i < times.size(); ++i) {
+            if(times[i] >= bmin) {
+                imin = i;
+                break;
+            }
+        }
+    }
+
+    if(baseline.second.isValid()) {
+        float bmax = baseline.second.toFloat();
+        for(qint32 i = times.size()-1; i >= 0; --i) {
+            if(times[i] <= bmax) {
+                imax = i+1;
+                break;
+            }
+        }
+    }
+
+    if(imax <= imin) {
+        return;
+    }
+
+    const qint32 iNumBase = imax - imin;
+
+    parallelFor(epochs(), [&](qint32 iBegin, qint32 iEnd) {
+        for(qint32 e = iBegin; e < iEnd; ++e) {
+            EpochView matEpoch = epoch(e);
+            const Eigen::Matrix<T, Eigen::Dynamic, 1> vecMean = matEpoch.middleCols(imin, iNumBase).rowwise().mean();
+
+            if(mode.compare("mean") == 0) {
+                matEpoch.colwise() -= vecMean;
+            } else if(mode.compare("logratio") == 0) {
+                for(qint32 j = 0; j < matEpoch.cols(); ++j) {
+                    matEpoch.col(j) = (matEpoch.col(j).array() / vecMean.array()).log10().matrix(); // a value of 1 means 10 times bigger
+                }
+            } else if(mode.compare("ratio") == 0) {
+                matEpoch.array().colwise() /= vecMean.array();
+            } else if(mode.compare("zscore") == 0) {
+                Eigen::Matrix<T, Eigen::Dynamic, 1> vecStd = (matEpoch.middleCols(imin, iNumBase).colwise() - vecMean).array().square().rowwise().mean();
+                vecStd = (vecStd.array() / T(iNumBase)).sqrt();
+
+                matEpoch.colwise() -= vecMean;
+                matEpoch.array().colwise() /= vecStd.array();
+            } else if(mode.compare("percent") == 0) {
+                matEpoch.colwise() -= vecMean;
+                matEpoch.array().colwise() /= vecMean.array();
+            }
+        }
+    });
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+qint32 MNEEpochTensor<T>::checkForArtifacts(const FIFFLIB::FiffInfo& pFiffInfo,
+                                            double dThreshold,
+                                            const QString& sCheckType,
+                                            const QString& sChType)
+{
+    QList<int> lChannels = MNEEpochDataList::artifactChannels(pFiffInfo, sChType);
+
+    for(int i = lChannels.size() - 1; i >= 0; --i) {
+        if(lChannels.at(i) >= channels()) {
+            lChannels.removeAt(i);
+        }
+    }
+
+    if(lChannels.isEmpty()) {
+        qDebug() << "MNEEpochTensor::checkForArtifacts - No channels found to scan for artifacts. Returning.";
+        return 0;
+    }
+
+    if(!sCheckType.contains("threshold", Qt::CaseInsensitive) && !sCheckType.contains("variance", Qt::CaseInsensitive)) {
+        return 0;
+    }
+
+    parallelFor(epochs(), [&](qint32 iBegin, qint32 iEnd) {
+        for(qint32 e = iBegin; e < iEnd; ++e) {
+            m_vecReject[e] = checkForArtifact(e, lChannels, dThreshold, sCheckType);
+        }
+    });
+
+    return m_vecReject.count(true);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool MNEEpochTensor<T>::checkForArtifact(qint32 i,
+                                         const QList<int>& lChannels,
+                                         double dThreshold,
+                                         const QString& sCheckType) const
+{
+    const bool bThreshold = sCheckType.contains("threshold", Qt::CaseInsensitive);
+    const bool bVariance = sCheckType.contains("variance", Qt::CaseInsensitive);
+
+    if(!bThreshold && !bVariance) {
+        return false;
+    }
+
+    ConstEpochView matEpoch = epoch(i);
+
+    for(int c = 0; c < lChannels.size(); ++c) {
+        if(lChannels.at(c) >= channels()) {
+            continue;
+        }
+
+        const Eigen::Array<double, 1, Eigen::Dynamic> row = matEpoch.row(lChannels.at(c)).template cast<double>().array();
+
+        if(bThreshold) {
+            //If absolute value of min or max relative to the first sample is bigger than threshold -> reject
+            if((row - row(0)).abs().maxCoeff() > dThreshold) {
+                return true;
+            }
+        } else {
+            //If variance is bigger than threshold times the median -> reject, see MNEEpochDataList::checkChVariance
+            const double dMedian = row.matrix().norm() / row.cols();
+            if((row - dMedian).matrix().norm() / row.cols() > (dThreshold * std::fabs(dMedian))) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void MNEEpochTensor<T>::dropRejected()
+{
+    removeEpochs(m_vecReject);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void MNEEpochTensor<T>::removeEpochs(const QVector<bool>& vecRemove)
+{
+    if(vecRemove.size() != epochs()) {
+        qWarning("MNEEpochTensor::removeEpochs - Warning : One flag per epoch is needed.\n");
+        return;
+    }
+
+    const QVector<bool> vecDrop = vecRemove;   // vecRemove might be m_vecReject
+    qint32 iKeep = 0;
+
+    for(qint32 e = 0; e < epochs(); ++e) {
+        if(vecDrop.at(e)) {
+            continue;
+        }
+
+        if(iKeep != e) {
+            epoch(iKeep) = epoch(e);
+            setEpochInfo(iKeep, m_vecEvent.at(e), m_vecTmin.at(e), m_vecTmax.at(e), m_vecReject.at(e));
+        }
+        ++iKeep;
+    }
+
+    m_matData.conservativeResize(Eigen::NoChange, iKeep * m_iNumTimes);
+    m_vecEvent.resize(iKeep);
+    m_vecTmin.resize(iKeep);
+    m_vecTmax.resize(iKeep);
+    m_vecReject.resize(iKeep);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void MNEEpochTensor<T>::pick_channels(const Eigen::RowVectorXi& sel)
+{
+    if (sel.cols() == 0) {
+        qWarning("MNEEpochTensor::pick_channels - Warning : No channels were provided.\n");
+        return;
+    }
+
+    for(qint32 l = 0; l < sel.cols(); ++l) {
+        if(sel(l) < 0 || sel(l) >= channels()) {
+            qWarning("MNEEpochTensor::pick_channels - Warning : Selected channel index out of bound.\n");
+            return;
+        }
+    }
+
+    MatrixT matSel(sel.cols(), m_matData.cols());
+
+    parallelFor(sel.cols(), [&](qint32 iBegin, qint32 iEnd) {
+        for(qint32 l = iBegin; l < iEnd; ++l) {
+            matSel.row(l) = m_matData.row(sel(l));
+        }
+    });
+
+    m_matData.swap(matSel);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+template<typename Func>
+void MNEEpochTensor<T>::parallelFor(qint32 iCount,
+                                    Func func)
+{
+    if(iCount <= 0) {
+        return;
+    }
+
+    const qint32 iNumThreads = qBound(1, QThread::idealThreadCount(), iCount);
+    const qint32 iStep = (iCount + iNumThreads - 1) / iNumThreads;
+
+    QVector<QPair<qint32,qint32> > vecRanges;
+    for(qint32 iBegin = 0; iBegin < iCount; iBegin += iStep) {
+        vecRanges.append(qMakePair(iBegin, qMin(iBegin + iStep, iCount)));
+    }
+
+    QtConcurrent::blockingMap(vecRanges, [&func](const QPair<qint32,qint32>& range) {
+        func(range.first, range.second);
+    });
+}
+
+} // NAMESPACE
+
+#endif // MNE_EPOCH_TENSOR_H
@@ -72,6 +72,10 @@
 #include <iostream>
 #include <QtConcurrent>
 #include <QFuture>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QHash>
+#include <QSet>
 
 
 //*************************************************************************************************************
@@ -498,62 +502,7 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
     //
     // Cluster operator D (sources x clusters)
     //
-    qint32 totalNumOfClust = 0;
-    for (qint32 h = 0; h < 2; ++h)
-        totalNumOfClust += p_fwdOut.src[h].cluster_info.clusterVertnos.size();
-
-    if(this->isFixedOrient())
-        p_D = MatrixXd::Zero(this->sol->data.cols(), totalNumOfClust);
-    else
-        p_D = MatrixXd::Zero(this->sol->data.cols(), totalNumOfClust*3);
-
-    QList<VectorXi> t_vertnos = this->src.get_vertno();
-
-//    qDebug() << "Size: " << t_vertnos[0].size()  << t_vertnos[1].size();
-//    qDebug() << "this->sol->data.cols(): " << this->sol->data.cols();
-
-    qint32 currentCluster = 0;
-    for (qint32 h = 0; h < 2; ++h)
-    {
-        int hemiOffset = h == 0 ? 0 : t_vertnos[0].size();
-        for(qint32 i = 0; i < p_fwdOut.src[h].cluster_info.clusterVertnos.size(); ++i)
-        {
-            VectorXi idx_sel;
-            MNEMath::intersect(t_vertnos[h], p_fwdOut.src[h].cluster_info.clusterVertnos[i], idx_sel);
-
-//            std::cout << "\nVertnos:\n" << t_vertnos[h] << std::endl;
-
-//            std::cout << "clusterVertnos[i]:\n" << p_fwdOut.src[h].cluster_info.clusterVertnos[i] << std::endl;
-
-            idx_sel.array() += hemiOffset;
-
-//            std::cout << "idx_sel]:\n" << idx_sel << std::endl;
-
-
-
-            double selectWeight = 1.0/idx_sel.size();
-            if(this->isFixedOrient())
-            {
-                for(qint32 j = 0; j < idx_sel.size(); ++j)
-                    p_D.col(currentCluster)[idx_sel(j)] = selectWeight;
-            }
-            else
-            {
-                qint32 clustOffset = currentCluster*3;
-                for(qint32 j = 0; j < idx_sel.size(); ++j)
-                {
-                    qint32 idx_sel_Offset = idx_sel(j)*3;
-                    //x
-                    p_D(idx_sel_Offset,clustOffset) = selectWeight;
-                    //y
-                    p_D(idx_sel_Offset+1, clustOffset+1) = selectWeight;
-                    //z
-                    p_D(idx_sel_Offset+2, clustOffset+2) = selectWeight;
-                }
-            }
-            ++currentCluster;
-        }
-    }
+    cluster_operator(p_fwdOut, p_D);
 
 //    std::cout << "D:\n" << D.row(0) << std::endl << D.row(1) << std::endl << D.row(2) << std::endl << D.row(3) << std::endl << D.row(4) << std::endl << D.row(5) << std::endl;
 
@@ -721,6 +670,388 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
 }
 
 
+//*************************************************************************************************************
+
+void MNEForwardSolution::cluster_operator(const MNEForwardSolution &p_fwdClustered, MatrixXd& p_D) const
+{
+    qint32 totalNumOfClust = 0;
+    for (qint32 h = 0; h < 2; ++h)
+        totalNumOfClust += p_fwdClustered.src[h].cluster_info.clusterVertnos.size();
+
+    if(this->isFixedOrient())
+        p_D = MatrixXd::Zero(this->sol->data.cols(), totalNumOfClust);
+    else
+        p_D = MatrixXd::Zero(this->sol->data.cols(), totalNumOfClust*3);
+
+    QList<VectorXi> t_vertnos = this->src.get_vertno();
+
+    qint32 currentCluster = 0;
+    for (qint32 h = 0; h < 2; ++h)
+    {
+        int hemiOffset = h == 0 ? 0 : t_vertnos[0].size();
+        for(qint32 i = 0; i < p_fwdClustered.src[h].cluster_info.clusterVertnos.size(); ++i)
+        {
+            VectorXi idx_sel;
+            MNEMath::intersect(t_vertnos[h], p_fwdClustered.src[h].cluster_info.clusterVertnos[i], idx_sel);
+
+            idx_sel.array() += hemiOffset;
+
+            double selectWeight = 1.0/idx_sel.size();
+            if(this->isFixedOrient())
+            {
+                for(qint32 j = 0; j < idx_sel.size(); ++j)
+                    p_D.col(currentCluster)[idx_sel(j)] = selectWeight;
+            }
+            else
+            {
+                qint32 clustOffset = currentCluster*3;
+                for(qint32 j = 0; j < idx_sel.size(); ++j)
+                {
+                    qint32 idx_sel_Offset = idx_sel(j)*3;
+                    //x
+                    p_D(idx_sel_Offset,clustOffset) = selectWeight;
+                    //y
+                    p_D(idx_sel_Offset+1, clustOffset+1) = selectWeight;
+                    //z
+                    p_D(idx_sel_Offset+2, clustOffset+2) = selectWeight;
+                }
+            }
+            ++currentCluster;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+MNEForwardSolution MNEForwardSolution::cluster_forward_solution_cached(const QString &p_sCacheDir, const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, const FiffCov &p_pNoise_cov, const FiffInfo &p_pInfo, QString p_sMethod, qint32 p_iMaxCacheEntries) const
+{
+    QString t_sHash = this->cluster_hash(p_AnnotationSet, p_iClusterSize, p_pNoise_cov, p_pInfo, p_sMethod);
+
+    QDir t_cacheDir(p_sCacheDir);
+    QFile t_cacheFile(t_cacheDir.filePath(QString("clustered-fwd-%1.fif").arg(t_sHash)));
+
+    //
+    // Cache hit -> load the clustered gain matrix and cluster information
+    //
+    if(t_cacheFile.exists())
+    {
+        MNEForwardSolution p_fwdOut;
+        if(this->read_cluster_cache(t_cacheFile, t_sHash, p_fwdOut))
+        {
+            printf("Loaded clustered forward solution from %s.\n", t_cacheFile.fileName().toUtf8().constData());
+            this->cluster_operator(p_fwdOut, p_D);
+            return p_fwdOut;
+        }
+
+        printf("Clustered forward solution cache %s is invalid, clustering again.\n", t_cacheFile.fileName().toUtf8().constData());
+    }
+
+    //
+    // Cache miss -> cluster and store the result
+    //
+    MNEForwardSolution p_fwdOut = this->cluster_forward_solution(p_AnnotationSet, p_iClusterSize, p_D, p_pNoise_cov, p_pInfo, p_sMethod);
+
+    if(p_fwdOut.isClustered() && t_cacheDir.mkpath(QString(".")))
+    {
+        // Write to a temporary file first, so an interrupted write never leaves a truncated cache entry
+        QFile t_tmpFile(t_cacheFile.fileName() + QString(".tmp"));
+        if(this->write_cluster_cache(t_tmpFile, t_sHash, p_fwdOut))
+        {
+            t_cacheFile.remove();
+            if(!t_tmpFile.rename(t_cacheFile.fileName()))
+                t_tmpFile.remove();
+        }
+        else
+        {
+            t_tmpFile.remove();
+        }
+
+        prune_cluster_cache(p_sCacheDir, p_iMaxCacheEntries);
+    }
+
+    return p_fwdOut;
+}
+
+
+//*************************************************************************************************************
+
+qint32 MNEForwardSolution::prune_cluster_cache(const QString &p_sCacheDir, qint32 p_iMaxEntries)
+{
+    QDir t_cacheDir(p_sCacheDir);
+
+    // Newest first
+    QFileInfoList t_entries = t_cacheDir.entryInfoList(QStringList() << "clustered-fwd-*.fif", QDir::Files, QDir::Time);
+
+    qint32 t_iRemoved = 0;
+    for(qint32 i = qMax(0, p_iMaxEntries); i < t_entries.size(); ++i)
+    {
+        if(QFile::remove(t_entries[i].absoluteFilePath()))
+            ++t_iRemoved;
+    }
+
+    if(t_iRemoved > 0)
+        printf("Removed %d clustered forward solution(s) from the cache %s.\n", t_iRemoved, p_sCacheDir.toUtf8().constData());
+
+    return t_iRemoved;
+}
+
+
+//*************************************************************************************************************
+
+QString MNEForwardSolution::cluster_hash(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, const FiffCov &p_pNoise_cov, const FiffInfo &p_pInfo, QString p_sMethod) const
+{
+    QCryptographicHash t_hash(QCryptographicHash::Sha1);
+
+    // Bump the version whenever the clustering or the cache layout changes
+    const qint32 t_iVersion = 2;
+    t_hash.addData(reinterpret_cast<const char*>(&t_iVersion), sizeof(t_iVersion));
+
+    // Forward solution
+    t_hash.addData(reinterpret_cast<const char*>(&this->source_ori), sizeof(this->source_ori));
+    t_hash.addData(reinterpret_cast<const char*>(&this->coord_frame), sizeof(this->coord_frame));
+    const qint64 t_iRows = this->sol->data.rows();
+    const qint64 t_iCols = this->sol->data.cols();
+    t_hash.addData(reinterpret_cast<const char*>(&t_iRows), sizeof(t_iRows));
+    t_hash.addData(reinterpret_cast<const char*>(&t_iCols), sizeof(t_iCols));
+    t_hash.addData(reinterpret_cast<const char*>(this->sol->data.data()), this->sol->data.size() * sizeof(double));
+    t_hash.addData(reinterpret_cast<const char*>(this->source_rr.data()), this->source_rr.size() * sizeof(float));
+    for(qint32 h = 0; h < this->src.size(); ++h)
+        t_hash.addData(reinterpret_cast<const char*>(this->src[h].vertno.data()), this->src[h].vertno.size() * sizeof(int));
+
+    // Annotation set
+    for(qint32 h = 0; h < p_AnnotationSet.size(); ++h)
+    {
+        const VectorXi t_vecLabelIds = p_AnnotationSet[h].getLabelIds();
+        const Colortable t_colortable = p_AnnotationSet[h].getColortable();
+        const VectorXi t_vecColortableIds = t_colortable.getLabelIds();
+        t_hash.addData(reinterpret_cast<const char*>(t_vecLabelIds.data()), t_vecLabelIds.size() * sizeof(int));
+        t_hash.addData(reinterpret_cast<const char*>(t_vecColortableIds.data()), t_vecColortableIds.size() * sizeof(int));
+        t_hash.addData(t_colortable.getNames().join(";").toUtf8());
+    }
+
+    // Clustering parameters
+    t_hash.addData(reinterpret_cast<const char*>(&p_iClusterSize), sizeof(p_iClusterSize));
+    t_hash.addData(p_sMethod.toUtf8());
+
+    // Whitening input
+    t_hash.addData(p_pNoise_cov.names.join(";").toUtf8());
+    t_hash.addData(p_pNoise_cov.bads.join(";").toUtf8());
+    t_hash.addData(reinterpret_cast<const char*>(p_pNoise_cov.data.data()), p_pNoise_cov.data.size() * sizeof(double));
+    t_hash.addData(p_pInfo.ch_names.join(";").toUtf8());
+    t_hash.addData(p_pInfo.bads.join(";").toUtf8());
+    for(qint32 i = 0; i < p_pInfo.projs.size(); ++i)
+    {
+        t_hash.addData(reinterpret_cast<const char*>(&p_pInfo.projs[i].active), sizeof(bool));
+        t_hash.addData(reinterpret_cast<const char*>(p_pInfo.projs[i].data->data.data()), p_pInfo.projs[i].data->data.size() * sizeof(double));
+    }
+
+    return QString(t_hash.result().toHex());
+}
+
+
+//*************************************************************************************************************
+
+bool MNEForwardSolution::write_cluster_cache(QIODevice &p_IODevice, const QString &p_sHash, const MNEForwardSolution &p_fwdClustered) const
+{
+    FiffStream::SPtr t_pStream = FiffStream::start_file(p_IODevice);
+    if(!t_pStream)
+        return false;
+
+    printf("Write clustered forward solution to %s...", t_pStream->streamName().toUtf8().constData());
+
+    t_pStream->start_block(FIFFB_MNE_CLUSTERED_FWD_CACHE);
+    t_pStream->write_string(FIFF_MNE_CLUSTER_HASH, p_sHash);
+    // The gain matrix is kept in double precision, so that a cache hit equals a cache miss
+    const fiff_int_t t_iRows = p_fwdClustered.sol->data.rows();
+    const fiff_int_t t_iCols = p_fwdClustered.sol->data.cols();
+    t_pStream->write_int(FIFF_MNE_NROW, &t_iRows);
+    t_pStream->write_int(FIFF_MNE_NCOL, &t_iCols);
+    t_pStream->write_double(FIFF_MNE_FORWARD_SOLUTION, p_fwdClustered.sol->data.data(), p_fwdClustered.sol->data.size());
+
+    for(qint32 h = 0; h < p_fwdClustered.src.size(); ++h)
+    {
+        const MNEClusterInfo& t_info = p_fwdClustered.src[h].cluster_info;
+        const qint32 nClusters = t_info.clusterVertnos.size();
+
+        t_pStream->start_block(FIFFB_MNE_CLUSTER_INFO);
+        t_pStream->write_int(FIFF_MNE_HEMI, &h);
+        t_pStream->write_int(FIFF_MNE_CLUSTER_VERTNO, p_fwdClustered.src[h].vertno.data(), p_fwdClustered.src[h].vertno.size());
+
+        QStringList t_names;
+        VectorXi t_vecLabelIds(nClusters);
+        for(qint32 i = 0; i < nClusters; ++i)
+        {
+            t_names << t_info.clusterLabelNames[i];
+            t_vecLabelIds[i] = t_info.clusterLabelIds[i];
+        }
+        t_pStream->write_name_list(FIFF_MNE_CLUSTER_LABEL_NAMES, t_names);
+        t_pStream->write_int(FIFF_MNE_CLUSTER_LABEL_IDS, t_vecLabelIds.data(), nClusters);
+
+        // The centroids are only set for clusters of the non empty gain partials
+        VectorXi t_vecCentroidVertno(t_info.centroidVertno.size());
+        MatrixXf t_matCentroidRR(t_info.centroidSource_rr.size(), 3);
+        for(qint32 i = 0; i < t_info.centroidVertno.size(); ++i)
+        {
+            t_vecCentroidVertno[i] = t_info.centroidVertno[i];
+            t_matCentroidRR.row(i) = t_info.centroidSource_rr[i].transpose();
+        }
+        t_pStream->write_int(FIFF_MNE_CLUSTER_CENTROID_VERTNO, t_vecCentroidVertno.data(), t_vecCentroidVertno.size());
+        t_pStream->write_float_matrix(FIFF_MNE_CLUSTER_CENTROID_RR, t_matCentroidRR);
+
+        for(qint32 i = 0; i < nClusters; ++i)
+        {
+            VectorXf t_vecDistances = t_info.clusterDistances[i].cast<float>();
+            t_pStream->write_int(FIFF_MNE_CLUSTER_VERTNOS, t_info.clusterVertnos[i].data(), t_info.clusterVertnos[i].size());
+            t_pStream->write_float_matrix(FIFF_MNE_CLUSTER_SOURCE_RR, t_info.clusterSource_rr[i]);
+            t_pStream->write_float(FIFF_MNE_CLUSTER_DISTANCES, t_vecDistances.data(), t_vecDistances.size());
+        }
+
+        t_pStream->end_block(FIFFB_MNE_CLUSTER_INFO);
+    }
+
+    t_pStream->end_block(FIFFB_MNE_CLUSTERED_FWD_CACHE);
+    t_pStream->end_file();
+
+    printf("[done]\n");
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEForwardSolution::read_cluster_cache(QIODevice &p_IODevice, const QString &p_sHash, MNEForwardSolution &p_fwdClustered) const
+{
+    FiffStream::SPtr t_pStream(new FiffStream(&p_IODevice));
+    if(!t_pStream->open())
+        return false;
+
+    QList<FiffDirNode::SPtr> t_caches = t_pStream->dirtree()->dir_tree_find(FIFFB_MNE_CLUSTERED_FWD_CACHE);
+    FiffTag::SPtr t_pTag;
+
+    if(t_caches.isEmpty() || !t_caches[0]->find_tag(t_pStream, FIFF_MNE_CLUSTER_HASH, t_pTag) || t_pTag->toString() != p_sHash)
+    {
+        t_pStream->close();
+        return false;
+    }
+
+    fiff_int_t t_iRows = 0, t_iCols = 0;
+    if(t_caches[0]->find_tag(t_pStream, FIFF_MNE_NROW, t_pTag) && t_pTag->toInt())
+        t_iRows = *t_pTag->toInt();
+    if(t_caches[0]->find_tag(t_pStream, FIFF_MNE_NCOL, t_pTag) && t_pTag->toInt())
+        t_iCols = *t_pTag->toInt();
+
+    if(t_iRows != this->sol->data.rows() || t_iCols <= 0
+            || !t_caches[0]->find_tag(t_pStream, FIFF_MNE_FORWARD_SOLUTION, t_pTag)
+            || !t_pTag->toDouble()
+            || t_pTag->size() != static_cast<qint64>(t_iRows) * t_iCols * (qint64)sizeof(double))
+    {
+        t_pStream->close();
+        return false;
+    }
+
+    MatrixXd t_G = Map<const MatrixXd>(t_pTag->toDouble(), t_iRows, t_iCols);
+
+    MNEForwardSolution p_fwdOut(*this);
+
+    QList<FiffDirNode::SPtr> t_hemis = t_caches[0]->dir_tree_find(FIFFB_MNE_CLUSTER_INFO);
+    if(t_hemis.size() != p_fwdOut.src.size())
+    {
+        t_pStream->close();
+        return false;
+    }
+
+    for(qint32 k = 0; k < t_hemis.size(); ++k)
+    {
+        if(!t_hemis[k]->find_tag(t_pStream, FIFF_MNE_HEMI, t_pTag))
+        {
+            t_pStream->close();
+            return false;
+        }
+        qint32 h = *t_pTag->toInt();
+        if(h < 0 || h >= p_fwdOut.src.size())
+        {
+            t_pStream->close();
+            return false;
+        }
+
+        MNEClusterInfo& t_info = p_fwdOut.src[h].cluster_info;
+        t_info.clear();
+
+        if(t_hemis[k]->find_tag(t_pStream, FIFF_MNE_CLUSTER_VERTNO, t_pTag))
+            p_fwdOut.src[h].vertno = Map<const VectorXi>(t_pTag->toInt(), t_pTag->size()/sizeof(qint32));
+
+        QStringList t_names;
+        if(t_hemis[k]->find_tag(t_pStream, FIFF_MNE_CLUSTER_LABEL_NAMES, t_pTag))
+            t_names = FiffStream::split_name_list(t_pTag->toString());
+
+        if(t_hemis[k]->find_tag(t_pStream, FIFF_MNE_CLUSTER_LABEL_IDS, t_pTag))
+        {
+            const qint32* t_pIds = t_pTag->toInt();
+            for(qint32 i = 0; i < t_pTag->size()/(int)sizeof(qint32); ++i)
+                t_info.clusterLabelIds.append(t_pIds[i]);
+        }
+
+        if(t_hemis[k]->find_tag(t_pStream, FIFF_MNE_CLUSTER_CENTROID_VERTNO, t_pTag))
+        {
+            const qint32* t_pVertno = t_pTag->toInt();
+            for(qint32 i = 0; i < t_pTag->size()/(int)sizeof(qint32); ++i)
+                t_info.centroidVertno.append(t_pVertno[i]);
+        }
+
+        if(t_hemis[k]->find_tag(t_pStream, FIFF_MNE_CLUSTER_CENTROID_RR, t_pTag))
+        {
+            MatrixXf t_matCentroidRR = t_pTag->toFloatMatrix().transpose();
+            for(qint32 i = 0; i < t_matCentroidRR.rows(); ++i)
+                t_info.centroidSource_rr.append(t_matCentroidRR.row(i).transpose());
+        }
+
+        // Per cluster entries are stored in cluster order
+        for(qint32 e = 0; e < t_hemis[k]->dir.size(); ++e)
+        {
+            fiff_int_t kind = t_hemis[k]->dir[e]->kind;
+            if(kind != FIFF_MNE_CLUSTER_VERTNOS && kind != FIFF_MNE_CLUSTER_SOURCE_RR && kind != FIFF_MNE_CLUSTER_DISTANCES)
+                continue;
+
+            if(!t_pStream->read_tag(t_pTag, t_hemis[k]->dir[e]->pos))
+            {
+                t_pStream->close();
+                return false;
+            }
+
+            if(kind == FIFF_MNE_CLUSTER_VERTNOS)
+                t_info.clusterVertnos.append(Map<const VectorXi>(t_pTag->toInt(), t_pTag->size()/sizeof(qint32)));
+            else if(kind == FIFF_MNE_CLUSTER_SOURCE_RR)
+                t_info.clusterSource_rr.append(t_pTag->toFloatMatrix().transpose());
+            else
+                t_info.clusterDistances.append(Map<const VectorXf>(t_pTag->toFloat(), t_pTag->size()/sizeof(float)).cast<double>());
+        }
+
+        t_info.clusterLabelNames = t_names;
+
+        if(t_info.clusterVertnos.size() != t_info.clusterLabelIds.size()
+                || t_info.clusterSource_rr.size() != t_info.clusterLabelIds.size()
+                || t_info.clusterDistances.size() != t_info.clusterLabelIds.size()
+                || t_info.clusterLabelNames.size() != t_info.clusterLabelIds.size())
+        {
+            t_pStream->close();
+            return false;
+        }
+    }
+
+    t_pStream->close();
+
+    p_fwdOut.sol->data = t_G;
+    p_fwdOut.sol->ncol = t_G.cols();
+    p_fwdOut.nsource = p_fwdOut.sol->ncol/3;
+
+    p_fwdClustered = p_fwdOut;
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 MNEForwardSolution MNEForwardSolution::reduce_forward_solution(qint32 p_iNumDipoles, MatrixXd& p_D) const
@@ -1030,8 +1361,9 @@ MNEForwardSolution MNEForwardSolution::pick_channels(const QStringList& include,
     fwd.info.nchan = nuse;
 
     QStringList bads;
+    QSet<QString> t_pickedNames = ch_names.toSet();
     for(qint32 i = 0; i < fwd.info.bads.size(); ++i)
-        if(ch_names.contains(fwd.info.bads[i]))
+        if(t_pickedNames.contains(fwd.info.bads[i]))
             bads.append(fwd.info.bads[i]);
     fwd.info.bads = bads;
 
@@ -1129,16 +1461,22 @@ void MNEForwardSolution::prepare_forward(const FiffInfo &p_info,
                                          MatrixXd &p_outWhitener,
                                          qint32 &p_outNumNonZero) const
 {
-    QStringList fwd_ch_names, ch_names;
-    for(qint32 i = 0; i < this->info.chs.size(); ++i)
-        fwd_ch_names << this->info.chs[i].ch_name;
+    //Index of the first occurrence of each forward channel name, as QStringList::indexOf would find it
+    QHash<QString, qint32> fwd_ch_index;
+    fwd_ch_index.reserve(this->info.chs.size());
+    for(qint32 i = this->info.chs.size() - 1; i >= 0; --i)
+        fwd_ch_index.insert(this->info.chs[i].ch_name, i);
+
+    QSet<QString> info_bads = p_info.bads.toSet();
+    QSet<QString> cov_bads = p_noise_cov.bads.toSet();
+    QSet<QString> cov_names = p_noise_cov.names.toSet();
 
-    ch_names.clear();
+    QStringList ch_names;
     for(qint32 i = 0; i < p_info.chs.size(); ++i)
-        if(!p_info.bads.contains(p_info.chs[i].ch_name)
-            && !p_noise_cov.bads.contains(p_info.chs[i].ch_name)
-            && p_noise_cov.names.contains(p_info.chs[i].ch_name)
-            && fwd_ch_names.contains(p_info.chs[i].ch_name))
+        if(!info_bads.contains(p_info.chs[i].ch_name)
+            && !cov_bads.contains(p_info.chs[i].ch_name)
+            && cov_names.contains(p_info.chs[i].ch_name)
+            && fwd_ch_index.contains(p_info.chs[i].ch_name))
             ch_names << p_info.chs[i].ch_name;
 
     qint32 n_chan = ch_names.size();
@@ -1192,13 +1530,13 @@ void MNEForwardSolution::prepare_forward(const FiffInfo &p_info,
     qint32 count_info_idx = 0;
     for(qint32 i = 0; i < ch_names.size(); ++i)
     {
-        idx = fwd_ch_names.indexOf(ch_names[i]);
+        idx = fwd_ch_index.value(ch_names[i], -1);
         if(idx > -1)
         {
             fwd_idx[count_fwd_idx] = idx;
             ++count_fwd_idx;
         }
-        idx = p_info.ch_names.indexOf(ch_names[i]);
+        idx = p_info.channel_index(ch_names[i]);
         if(idx > -1)
         {
             info_idx[count_info_idx] = idx;
@@ -53,6 +53,7 @@
 
 #include <utils/mnemath.h>
 #include <utils/kmeans.h>
+#include <utils/fastkmeans.h>
 
 #include <fs/annotationset.h>
 
@@ -153,7 +154,7 @@ struct RegionData
         // Kmeans Reduction
         RegionDataOut p_RegionDataOut;
 
-        KMeans t_kMeans(t_sDistMeasure, QString("sample"), 5);
+        FastKMeans t_kMeans(t_sDistMeasure, 5);
 
         if(bUseWhitened)
         {
@@ -262,6 +263,56 @@ public:
     */
     MNEForwardSolution cluster_forward_solution(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D = defaultD, const FiffCov &p_pNoise_cov = defaultCov, const FiffInfo &p_pInfo = defaultInfo, QString p_sMethod = "cityblock") const;
 
+    //=========================================================================================================
+    /**
+    * Same as cluster_forward_solution, but the result is kept in a cache directory. The cache file is named
+    * after a hash of all clustering inputs (see cluster_hash), so it is only reused when nothing changed. On a
+    * cache hit only the clustered gain matrix and the cluster information are loaded; the cluster operator is
+    * rebuilt from the cluster information. The gain matrix is stored in double precision, so a cache hit returns
+    * the same result as a cache miss. After a new entry is written, the oldest entries beyond p_iMaxCacheEntries
+    * are removed (see prune_cluster_cache).
+    *
+    * @param[in]    p_sCacheDir         Directory which holds the cached clustered forward solutions
+    * @param[in]    p_AnnotationSet     Annotation set containing the annotation of left & right hemisphere
+    * @param[in]    p_iClusterSize      Maximal cluster size per roi
+    * @param[out]   p_D                 The cluster operator
+    * @param[in]    p_pNoise_cov
+    * @param[in]    p_pInfo
+    * @param[in]    p_sMethod           "cityblock" or "sqeuclidean"
+    * @param[in]    p_iMaxCacheEntries  Maximal number of clustered forward solutions kept in p_sCacheDir
+    *
+    * @return clustered MNE forward solution
+    */
+    MNEForwardSolution cluster_forward_solution_cached(const QString &p_sCacheDir, const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D = defaultD, const FiffCov &p_pNoise_cov = defaultCov, const FiffInfo &p_pInfo = defaultInfo, QString p_sMethod = "cityblock", qint32 p_iMaxCacheEntries = 10) const;
+
+    //=========================================================================================================
+    /**
+    * Removes the least recently written clustered forward solutions from a cache directory, so that at most
+    * p_iMaxEntries remain.
+    *
+    * @param[in]    p_sCacheDir         Directory which holds the cached clustered forward solutions
+    * @param[in]    p_iMaxEntries       Maximal number of entries to keep
+    *
+    * @return the number of removed entries
+    */
+    static qint32 prune_cluster_cache(const QString &p_sCacheDir, qint32 p_iMaxEntries);
+
+    //=========================================================================================================
+    /**
+    * Computes the hash identifying a clustering of this forward solution. It covers the gain matrix, the source
+    * space, the annotation set, the cluster size, the noise covariance, the channel names, bads and projectors
+    * of the measurement info and the method.
+    *
+    * @param[in]    p_AnnotationSet     Annotation set containing the annotation of left & right hemisphere
+    * @param[in]    p_iClusterSize      Maximal cluster size per roi
+    * @param[in]    p_pNoise_cov
+    * @param[in]    p_pInfo
+    * @param[in]    p_sMethod           "cityblock" or "sqeuclidean"
+    *
+    * @return the hex encoded hash
+    */
+    QString cluster_hash(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, const FiffCov &p_pNoise_cov = defaultCov, const FiffInfo &p_pInfo = defaultInfo, QString p_sMethod = "cityblock") const;
+
     //=========================================================================================================
     /**
     * Compute orientation prior
@@ -504,6 +555,39 @@ private:
     */
     static bool read_one(FiffStream::SPtr& p_pStream, const FiffDirNode::SPtr& p_Node, MNEForwardSolution& one);
 
+    //=========================================================================================================
+    /**
+    * Computes the cluster operator D (sources x clusters) which maps this forward solution to the clustered one.
+    *
+    * @param[in] p_fwdClustered     The clustered forward solution holding the cluster information
+    * @param[out] p_D               The cluster operator
+    */
+    void cluster_operator(const MNEForwardSolution &p_fwdClustered, MatrixXd& p_D) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the parts of a clustered forward solution which differ from this forward solution to a cache file.
+    *
+    * @param[in] p_IODevice         IO device to write to
+    * @param[in] p_sHash            The hash of the clustering input
+    * @param[in] p_fwdClustered     The clustered forward solution
+    *
+    * @return True if succeeded, false otherwise
+    */
+    bool write_cluster_cache(QIODevice &p_IODevice, const QString &p_sHash, const MNEForwardSolution &p_fwdClustered) const;
+
+    //=========================================================================================================
+    /**
+    * Reads a cache file written by write_cluster_cache and applies it to a copy of this forward solution.
+    *
+    * @param[in] p_IODevice         IO device to read from
+    * @param[in] p_sHash            The expected hash of the clustering input
+    * @param[out] p_fwdClustered    The clustered forward solution
+    *
+    * @return True if succeeded, false otherwise
+    */
+    bool read_cluster_cache(QIODevice &p_IODevice, const QString &p_sHash, MNEForwardSolution &p_fwdClustered) const;
+
 public:
     FiffInfoBase info;                  /**< light weighted measurement info */
     fiff_int_t source_ori;              /**< Source orientation: fixed or free */
@@ -40,9 +40,13 @@
 
 #include "mne_sourceestimate.h"
 
+#include <cstring>
+
 #include <QFile>
 #include <QDataStream>
 #include <QSharedPointer>
+#include <QtEndian>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -53,6 +57,109 @@
 using namespace MNELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Number of floats which are read/written per block when converting between the file and double precision.
+*/
+static const qint64 STC_BLOCK_SIZE = 1 << 20;
+
+
+//*************************************************************************************************************
+
+/**
+* Converts 32 bit values in place between big endian (stc file) and host byte order.
+*/
+static void swapBigEndian(quint32* p_pData, qint64 p_iCount)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // Plain loop over the values lets the compiler vectorize the byte swap
+    for(qint64 i = 0; i < p_iCount; ++i) {
+        p_pData[i] = qbswap(p_pData[i]);
+    }
+#else
+    Q_UNUSED(p_pData);
+    Q_UNUSED(p_iCount);
+#endif
+}
+
+
+//*************************************************************************************************************
+
+static bool readBlock(QIODevice &p_IODevice, char* p_pData, qint64 p_iSize)
+{
+    while(p_iSize > 0) {
+        qint64 iRead = p_IODevice.read(p_pData, p_iSize);
+        if(iRead <= 0) {
+            if(iRead == 0 && p_IODevice.waitForReadyRead(-1)) {
+                continue;
+            }
+            return false;
+        }
+        p_pData += iRead;
+        p_iSize -= iRead;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+static bool readHeader(QIODevice &p_IODevice,
+                       float& p_fTmin,
+                       float& p_fTstep,
+                       VectorXi& p_vecVertices,
+                       quint32& p_iNumTimes)
+{
+    quint32 t_header[3];
+    if(!readBlock(p_IODevice, reinterpret_cast<char*>(t_header), sizeof(t_header))) {
+        return false;
+    }
+    swapBigEndian(t_header, 3);
+
+    // start time and sampling rate are stored in ms
+    memcpy(&p_fTmin, &t_header[0], sizeof(float));
+    memcpy(&p_fTstep, &t_header[1], sizeof(float));
+    p_fTmin /= 1000;
+    p_fTstep /= 1000;
+
+    // vertex indices
+    quint32 t_nVertices = t_header[2];
+
+    // a corrupt count must not trigger a huge allocation, the indices and the number of time points have to fit into the file
+    if(!p_IODevice.isSequential()
+       && (static_cast<qint64>(t_nVertices) + 1) * static_cast<qint64>(sizeof(quint32)) > p_IODevice.size() - p_IODevice.pos()) {
+        printf("MNESourceEstimate - Number of vertices (%u) exceeds the file size.\n", t_nVertices);
+        return false;
+    }
+
+    p_vecVertices.resize(t_nVertices);
+    if(!readBlock(p_IODevice, reinterpret_cast<char*>(p_vecVertices.data()), t_nVertices * sizeof(quint32))) {
+        return false;
+    }
+    swapBigEndian(reinterpret_cast<quint32*>(p_vecVertices.data()), t_nVertices);
+
+    // number of time points
+    if(!readBlock(p_IODevice, reinterpret_cast<char*>(&p_iNumTimes), sizeof(quint32))) {
+        return false;
+    }
+    swapBigEndian(&p_iNumTimes, 1);
+
+    // the same holds for the data, this also keeps the memory map of readTimeWindow inside a truncated file
+    if(!p_IODevice.isSequential()
+       && static_cast<qint64>(t_nVertices) * p_iNumTimes * static_cast<qint64>(sizeof(float)) > p_IODevice.size() - p_IODevice.pos()) {
+        printf("MNESourceEstimate - Data of %u vertices x %u time points exceeds the file size.\n", t_nVertices, p_iNumTimes);
+        return false;
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -140,13 +247,7 @@ MNESourceEstimate MNESourceEstimate::reduce(qint32 start, qint32 n)
 
 bool MNESourceEstimate::read(QIODevice &p_IODevice, MNESourceEstimate& p_stc)
 {
-    QSharedPointer<QDataStream> t_pStream(new QDataStream(&p_IODevice));
-
-    t_pStream->setFloatingPointPrecision(QDataStream::SinglePrecision);
-    t_pStream->setByteOrder(QDataStream::BigEndian);
-    t_pStream->setVersion(QDataStream::Qt_5_0);
-
-    if(!t_pStream->device()->open(QIODevice::ReadOnly))
+    if(!p_IODevice.open(QIODevice::ReadOnly))
         return false;
 
     QFile* t_pFile = qobject_cast<QFile*>(&p_IODevice);
@@ -155,38 +256,41 @@ bool MNESourceEstimate::read(QIODevice &p_IODevice, MNESourceEstimate& p_stc)
     else
         printf("Reading source estimate...");
 
-    // read start time in ms
-    *t_pStream >> p_stc.tmin;
-    p_stc.tmin /= 1000;
-    // read sampling rate in ms
-    *t_pStream >> p_stc.tstep;
-    p_stc.tstep /= 1000;
-    // read number of vertices
-    quint32 t_nVertices;
-    *t_pStream >> t_nVertices;
-    p_stc.vertices = VectorXi(t_nVertices);
-    // read the vertex indices
-    for(quint32 i = 0; i < t_nVertices; ++i)
-        *t_pStream >> p_stc.vertices[i];
-    // read the number of timepts
     quint32 t_nTimePts;
-    *t_pStream >> t_nTimePts;
+    if(!readHeader(p_IODevice, p_stc.tmin, p_stc.tstep, p_stc.vertices, t_nTimePts)) {
+        printf("[failed]\n");
+        p_IODevice.close();
+        return false;
+    }
+
     //
-    // read the data
+    // read the data - the file is stored sample by sample, which is the column major layout of data
     //
-    p_stc.data = MatrixXd(t_nVertices, t_nTimePts);
-    for(qint32 i = 0; i < p_stc.data.array().size(); ++i)
-    {
-        float value;
-        *t_pStream >> value;
-        p_stc.data.array()(i) = value;
+    const qint64 t_nVertices = p_stc.vertices.size();
+    p_stc.data.resize(t_nVertices, t_nTimePts);
+
+    const qint32 t_iBlockCols = t_nVertices > 0 ? qMax<qint64>(1, STC_BLOCK_SIZE / t_nVertices) : 1;
+    MatrixXf t_matBlock(t_nVertices, qMin<qint64>(t_iBlockCols, t_nTimePts));
+
+    for(qint32 t = 0; t < static_cast<qint32>(t_nTimePts); t += t_iBlockCols) {
+        const qint32 t_iCols = qMin<qint32>(t_iBlockCols, t_nTimePts - t);
+        const qint64 t_iCount = t_nVertices * t_iCols;
+
+        if(!readBlock(p_IODevice, reinterpret_cast<char*>(t_matBlock.data()), t_iCount * sizeof(float))) {
+            printf("[failed]\n");
+            p_IODevice.close();
+            return false;
+        }
+        swapBigEndian(reinterpret_cast<quint32*>(t_matBlock.data()), t_iCount);
+
+        p_stc.data.middleCols(t, t_iCols) = t_matBlock.leftCols(t_iCols).cast<double>();
     }
 
     //Update time vector
     p_stc.update_times();
 
     // close the file
-    t_pStream->device()->close();
+    p_IODevice.close();
 
     printf("[done]\n");
 
@@ -194,6 +298,92 @@ bool MNESourceEstimate::read(QIODevice &p_IODevice, MNESourceEstimate& p_stc)
 }
 
 
+//*************************************************************************************************************
+
+bool MNESourceEstimate::readFloat(QIODevice &p_IODevice,
+                                  MatrixXf& p_matData,
+                                  VectorXi& p_vecVertices,
+                                  float& p_fTmin,
+                                  float& p_fTstep)
+{
+    if(!p_IODevice.open(QIODevice::ReadOnly))
+        return false;
+
+    quint32 t_nTimePts;
+    if(!readHeader(p_IODevice, p_fTmin, p_fTstep, p_vecVertices, t_nTimePts)) {
+        p_IODevice.close();
+        return false;
+    }
+
+    // the whole payload is read at once straight into the matrix
+    p_matData.resize(p_vecVertices.size(), t_nTimePts);
+    if(!readBlock(p_IODevice, reinterpret_cast<char*>(p_matData.data()), p_matData.size() * sizeof(float))) {
+        p_IODevice.close();
+        return false;
+    }
+    swapBigEndian(reinterpret_cast<quint32*>(p_matData.data()), p_matData.size());
+
+    p_IODevice.close();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNESourceEstimate::readTimeWindow(QFile &p_file,
+                                       qint32 start,
+                                       qint32 n,
+                                       MNESourceEstimate& p_stc)
+{
+    if(!p_file.open(QIODevice::ReadOnly))
+        return false;
+
+    quint32 t_nTimePts;
+    if(!readHeader(p_file, p_stc.tmin, p_stc.tstep, p_stc.vertices, t_nTimePts)) {
+        p_file.close();
+        return false;
+    }
+
+    if(start < 0 || n <= 0 || static_cast<quint32>(start) + static_cast<quint32>(n) > t_nTimePts) {
+        printf("MNESourceEstimate::readTimeWindow - Requested samples [%d, %d) are out of range [0, %u).\n", start, start + n, t_nTimePts);
+        p_file.close();
+        return false;
+    }
+
+    const qint64 t_nVertices = p_stc.vertices.size();
+    const qint64 t_iOffset = p_file.pos() + static_cast<qint64>(start) * t_nVertices * sizeof(float);
+    const qint64 t_iSize = static_cast<qint64>(n) * t_nVertices * sizeof(float);
+
+    p_stc.data.resize(t_nVertices, n);
+
+    if(t_iSize > 0) {
+        uchar* t_pMap = p_file.map(t_iOffset, t_iSize);
+        if(!t_pMap) {
+            p_file.close();
+            return false;
+        }
+
+        const quint32* t_pSrc = reinterpret_cast<const quint32*>(t_pMap);
+        MatrixXf t_matBlock(t_nVertices, 1);
+        for(qint32 t = 0; t < n; ++t) {
+            memcpy(t_matBlock.data(), t_pSrc + t * t_nVertices, t_nVertices * sizeof(float));
+            swapBigEndian(reinterpret_cast<quint32*>(t_matBlock.data()), t_nVertices);
+            p_stc.data.col(t) = t_matBlock.col(0).cast<double>();
+        }
+
+        p_file.unmap(t_pMap);
+    }
+
+    p_file.close();
+
+    p_stc.tmin += start * p_stc.tstep;
+    p_stc.update_times();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 bool MNESourceEstimate::write(QIODevice &p_IODevice)
@@ -224,15 +414,31 @@ bool MNESourceEstimate::write(QIODevice &p_IODevice)
     // write number of vertices
     *t_pStream << (quint32)this->vertices.size();
     // write the vertex indices
+    QVector<quint32> t_vecVertices(this->vertices.size());
     for(qint32 i = 0; i < this->vertices.size(); ++i)
-        *t_pStream << (quint32)this->vertices[i];
+        t_vecVertices[i] = qToBigEndian<quint32>(this->vertices[i]);
+    t_pStream->writeRawData(reinterpret_cast<const char*>(t_vecVertices.constData()), t_vecVertices.size() * sizeof(quint32));
     // write the number of timepts
     *t_pStream << (quint32)this->data.cols();
     //
     // write the data
     //
-    for(qint32 i = 0; i < this->data.array().size(); ++i)
-        *t_pStream << (float)this->data.array()(i);
+    const qint64 t_nVertices = this->data.rows();
+    const qint32 t_iBlockCols = t_nVertices > 0 ? qMax<qint64>(1, STC_BLOCK_SIZE / t_nVertices) : 1;
+    MatrixXf t_matBlock;
+
+    for(qint32 t = 0; t < this->data.cols(); t += t_iBlockCols) {
+        const qint32 t_iCols = qMin<qint32>(t_iBlockCols, this->data.cols() - t);
+
+        t_matBlock = this->data.middleCols(t, t_iCols).cast<float>();
+        swapBigEndian(reinterpret_cast<quint32*>(t_matBlock.data()), t_matBlock.size());
+
+        if(t_pStream->writeRawData(reinterpret_cast<const char*>(t_matBlock.data()), t_matBlock.size() * sizeof(float)) < 0) {
+            printf("[failed]\n");
+            t_pStream->device()->close();
+            return false;
+        }
+    }
 
     // close the file
     t_pStream->device()->close();
@@ -60,6 +60,7 @@
 #include <QSharedPointer>
 #include <QList>
 #include <QIODevice>
+#include <QFile>
 
 
 //*************************************************************************************************************
@@ -151,7 +152,8 @@ public:
     /**
     * mne_read_stc_file
     *
-    * Reads a source estimate from a given file
+    * Reads a source estimate from a given file. The vertex indices and the data are read in blocks and
+    * byte swapped in place instead of streaming every value.
     *
     * @param [in] p_IODevice    IO device to red the stc from.
     * @param [out] p_stc        the read stc
@@ -160,6 +162,42 @@ public:
     */
     static bool read(QIODevice &p_IODevice, MNESourceEstimate& p_stc);
 
+    //=========================================================================================================
+    /**
+    * Reads a source estimate from a given file and keeps the data in single precision, which is the precision
+    * stored in the file. This needs half the memory of read(p_IODevice, p_stc).
+    *
+    * @param [in] p_IODevice    IO device to red the stc from.
+    * @param [out] p_matData    the data [n_dipoles x n_times]
+    * @param [out] p_vecVertices    the vertex indices
+    * @param [out] p_fTmin      time starting point in s
+    * @param [out] p_fTstep     time step in s
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool readFloat(QIODevice &p_IODevice,
+                          MatrixXf& p_matData,
+                          VectorXi& p_vecVertices,
+                          float& p_fTmin,
+                          float& p_fTstep);
+
+    //=========================================================================================================
+    /**
+    * Reads a time window of a source estimate file. The file is memory mapped and only the requested samples,
+    * which are stored contiguously, are touched.
+    *
+    * @param [in] p_file        stc file to read from.
+    * @param [in] start         The first sample to read.
+    * @param [in] n             The number of samples to read.
+    * @param [out] p_stc        the read stc, holding the samples [start, start + n)
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool readTimeWindow(QFile &p_file,
+                               qint32 start,
+                               qint32 n,
+                               MNESourceEstimate& p_stc);
+
     //=========================================================================================================
     /**
     * mne_write_stc_file
@@ -533,47 +533,79 @@ void RtAve::mergeData(double dTriggerType)
 {
     QMutexLocker locker(&m_qMutex);
 
-    if(m_mapDataPre[dTriggerType].rows() != m_mapDataPost[dTriggerType].rows()) {
+    const MatrixXd& matDataPre = m_mapDataPre[dTriggerType];
+    const MatrixXd& matDataPost = m_mapDataPost[dTriggerType];
+
+    if(matDataPre.rows() != matDataPost.rows()) {
         return;
     }
 
-    MatrixXd mergedData(m_mapDataPre[dTriggerType].rows(), m_mapDataPre[dTriggerType].cols() + m_mapDataPost[dTriggerType].cols());
+    //Keep m_iNumAverages accepted epochs, or only the most recent one if we use zero number of averages
+    const qint32 iCapacity = qMax(1, m_iNumAverages);
+    const qint32 iTimes = matDataPre.cols() + matDataPost.cols();
+
+    if(m_mapStimAve[dTriggerType].epochs() != iCapacity + 1
+       || m_mapStimAve[dTriggerType].channels() != matDataPre.rows()
+       || m_mapStimAve[dTriggerType].times() != iTimes) {
+        resizeStimAve(dTriggerType, iCapacity, matDataPre.rows(), iTimes);
+    }
+
+    //Merge the cut data directly into the free slot of the average buffer
+    MNEEpochTensorD& tensor = m_mapStimAve[dTriggerType];
+    const qint32 iSlot = m_mapStimAveNext[dTriggerType];
 
-    mergedData << m_mapDataPre[dTriggerType], m_mapDataPost[dTriggerType];
+    MNEEpochTensorD::EpochView matEpoch = tensor.epoch(iSlot);
+    matEpoch.leftCols(matDataPre.cols()) = matDataPre;
+    matEpoch.rightCols(matDataPost.cols()) = matDataPost;
 
     //Perform artifact threshold
     bool bArtifactedDetected = false;
+    const QList<int> lArtifactChannels = MNEEpochDataList::artifactChannels(*m_pFiffInfo, QString("eog"));
 
     if(m_bActivateThreshold) {
-        bArtifactedDetected = MNEEpochDataList::checkForArtifact(mergedData,
-                                                                 *m_pFiffInfo,
-                                                                 m_dValueThreshold,
-                                                                 "threshold");
+        bArtifactedDetected = tensor.checkForArtifact(iSlot,
+                                                      lArtifactChannels,
+                                                      m_dValueThreshold,
+                                                      "threshold");
     }
 
     if(m_bActivateVariance) {
-        bArtifactedDetected = MNEEpochDataList::checkForArtifact(mergedData,
-                                                                 *m_pFiffInfo,
-                                                                 m_dValueVariance,
-                                                                 "variance");
+        bArtifactedDetected = tensor.checkForArtifact(iSlot,
+                                                      lArtifactChannels,
+                                                      m_dValueVariance,
+                                                      "variance");
     }
 
     if(bArtifactedDetected == false) {
-        //Add cut data to average buffer
-        m_mapStimAve[dTriggerType].append(mergedData);
+        //Accept the epoch. Once the ring is full this drops the oldest epoch, whose slot is merged into next.
+        m_mapStimAveNext[dTriggerType] = (iSlot + 1) % tensor.epochs();
+        m_mapStimAveCount[dTriggerType] = qMin(m_mapStimAveCount[dTriggerType] + 1, iCapacity);
+    }
+}
 
-        //Pop data from buffer
-        if(m_mapStimAve[dTriggerType].size() > m_iNumAverages && m_iNumAverages >= 1) {
-            for(int i = 0; i < m_mapStimAve[dTriggerType].size()-m_iNumAverages; ++i) {
-                m_mapStimAve[dTriggerType].pop_front();
-            }
-        }
 
-        //Proceed a bit different if we use zero number of averages
-        if(m_mapStimAve[dTriggerType].size() > 1 && m_iNumAverages == 0) {
-            m_mapStimAve[dTriggerType].pop_front();
+//*************************************************************************************************************
+
+void RtAve::resizeStimAve(double dTriggerType, qint32 iCapacity, qint32 iChannels, qint32 iTimes)
+{
+    const MNEEpochTensorD& tensorOld = m_mapStimAve[dTriggerType];
+    MNEEpochTensorD tensorNew(iCapacity + 1, iChannels, iTimes);
+    qint32 iCount = 0;
+
+    if(tensorOld.channels() == iChannels && tensorOld.times() == iTimes && tensorOld.epochs() > 0) {
+        const qint32 iOldCount = m_mapStimAveCount[dTriggerType];
+        const qint32 iOldNext = m_mapStimAveNext[dTriggerType];
+        iCount = qMin(iOldCount, iCapacity);
+
+        for(qint32 i = 0; i < iCount; ++i) {
+            const qint32 iOldSlot = (iOldNext - iCount + i + tensorOld.epochs()) % tensorOld.epochs();
+            tensorNew.epoch(i) = tensorOld.epoch(iOldSlot);
         }
     }
+
+    m_mapStimAve[dTriggerType] = tensorNew;
+    m_mapStimAveCount[dTriggerType] = iCount;
+    m_mapStimAveNext[dTriggerType] = iCount % tensorNew.epochs();
 }
 
 
@@ -583,10 +615,14 @@ void RtAve::generateEvoked(double dTriggerType)
 {
     QMutexLocker locker(&m_qMutex);
 
-    if(m_mapStimAve[dTriggerType].isEmpty()) {
+    const qint32 iCount = m_mapStimAveCount.value(dTriggerType, 0);
+
+    if(iCount == 0) {
         return;
     }
 
+    const MNEEpochTensorD& tensor = m_mapStimAve[dTriggerType];
+    const qint32 iNext = m_mapStimAveNext[dTriggerType];
 
     //Init evoked
     m_pStimEvokedSet->info = *m_pFiffInfo.data();
@@ -619,18 +655,14 @@ void RtAve::generateEvoked(double dTriggerType)
     }
 
     // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
-
     if(m_iAverageMode == 0) {
-        for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-            finalAverage += m_mapStimAve[dTriggerType].at(i);
+        //Average the accepted epochs, which are the iCount slots before the free one
+        VectorXi sel(iCount);
+        for(int i = 0; i < iCount; ++i) {
+            sel(i) = (iNext - iCount + i + tensor.epochs()) % tensor.epochs();
         }
 
-        if(m_mapStimAve[dTriggerType].isEmpty()) {
-            finalAverage = finalAverage/1;
-        } else {
-            finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
-        }
+        MatrixXd finalAverage = tensor.average(sel);
 
         if(m_bDoBaselineCorrection) {
             finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
@@ -644,7 +676,7 @@ void RtAve::generateEvoked(double dTriggerType)
 
         evoked.nave = m_mapNumberCalcAverages[dTriggerType];
     } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_mapStimAve[dTriggerType].last();
+        MatrixXd tempMatrix = tensor.epoch((iNext - 1 + tensor.epochs()) % tensor.epochs());
 
         if(m_bDoBaselineCorrection) {
             tempMatrix = MNEMath::rescale(tempMatrix, evoked.times, m_pairBaselineSec, QString("mean"));
@@ -697,6 +729,8 @@ void RtAve::reset()
 
     m_qMapDetectedTrigger.clear();
     m_mapStimAve.clear();
+    m_mapStimAveCount.clear();
+    m_mapStimAveNext.clear();
     m_mapDataPre.clear();
     m_mapDataPost.clear();
     m_mapMatDataPostIdx.clear();
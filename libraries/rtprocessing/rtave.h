@@ -47,6 +47,8 @@
 #include <fiff/fiff_evoked_set.h>
 #include <fiff/fiff_info.h>
 
+#include <mne/mne_epoch_tensor.h>
+
 #include <utils/generics/circularmatrixbuffer.h>
 
 
@@ -285,6 +287,18 @@ private:
     */
     void generateEvoked(double dTriggerType);
 
+    //=========================================================================================================
+    /**
+    * Resizes the epoch ring of a trigger type, keeping the most recent accepted epochs which still fit.
+    * Epochs of a different size are dropped.
+    *
+    * @param[in] dTriggerType   The trigger type.
+    * @param[in] iCapacity      The number of accepted epochs to hold.
+    * @param[in] iChannels      The number of channels per epoch.
+    * @param[in] iTimes         The number of samples per epoch.
+    */
+    void resizeStimAve(double dTriggerType, qint32 iCapacity, qint32 iChannels, qint32 iTimes);
+
     //=========================================================================================================
     /**
     * Check if data buffer has been initialized
@@ -328,7 +342,9 @@ private:
     FIFFLIB::FiffEvokedSet::SPtr                    m_pStimEvokedSet;           /**< Holds the evoked information. */
 
     QMap<int,QList<int> >                           m_qMapDetectedTrigger;      /**< Detected trigger for each trigger channel. */
-    QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    QMap<double,MNELIB::MNEEpochTensorD>            m_mapStimAve;               /**< The current stimulus average buffer. A ring of m_iNumAverages accepted epochs plus one slot the next epoch is merged into. */
+    QMap<double,qint32>                             m_mapStimAveCount;          /**< The number of accepted epochs in m_mapStimAve for each trigger type. */
+    QMap<double,qint32>                             m_mapStimAveNext;           /**< The slot in m_mapStimAve the next epoch is merged into for each trigger type. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding the pre stim data. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding the post stim data. */
     QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
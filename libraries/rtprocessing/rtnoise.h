@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "rtprocessing_global.h"
+#include "rtwelchpsd.h"
 
 
 //*************************************************************************************************************
@@ -119,9 +120,11 @@ public:
     *
     * @param[in] p_iMaxSamples      Number of samples to use for each data chunk
     * @param[in] p_pFiffInfo        Associated Fiff Information
+    * @param[in] p_dataLen          Number of incoming blocks averaged into one spectrum
+    * @param[in] p_dOverlap         Overlap of the Welch segments as a fraction of p_iMaxSamples (optional)
     * @param[in] parent     Parent QObject (optional)
     */
-    explicit RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_dataLen, QObject *parent = 0);
+    explicit RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_dataLen, double p_dOverlap = 0.5, QObject *parent = 0);
 
     //=========================================================================================================
     /**
@@ -180,8 +183,6 @@ protected:
     */
     virtual void run();
 
-    QVector <float> hanning(int N, short itype);
-
 private:
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
@@ -191,9 +192,10 @@ private:
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 
-    QVector <float> m_fWin;
+    RtWelchPsd::SPtr m_pWelchPsd;       /**< Streaming spectrum estimation, created with the first block. */
 
     double m_Fs;
+    double m_dOverlap;
 
     qint32 m_iFFTlength;
     qint32 m_dataLength;
@@ -204,8 +206,6 @@ protected:
     int m_iSensors;
     int m_iBlockIndex;
 
-    MatrixXd m_matCircBuf;
-
 public:
     MatrixXd m_matSpecData;
     QMutex ReadMutex;
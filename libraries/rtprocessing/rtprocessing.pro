@@ -82,6 +82,7 @@ SOURCES += \
     rtinvop.cpp \
     rtave.cpp \
     rtnoise.cpp \
+    rtwelchpsd.cpp \
     rthpis.cpp \
     rtfilter.cpp \
     rtconnectivity.cpp
@@ -92,6 +93,7 @@ HEADERS +=  \
     rtinvop.h \
     rtave.h \
     rtnoise.h \
+    rtwelchpsd.h \
     rthpis.h \
     rtfilter.h \
     rtconnectivity.h
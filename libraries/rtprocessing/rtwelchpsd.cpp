@@ -0,0 +1,232 @@
+//=============================================================================================================
+/**
+* @file     rtwelchpsd.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RtWelchPsd class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtwelchpsd.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent/QtConcurrent>
+#include <QThread>
+#include <QDebug>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+const int MIN_CHANNELS_PER_CHUNK = 16;  /**< Below this a chunk is not worth a thread. */
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtWelchPsd::RtWelchPsd(int iChannels,
+                       int iFFTLength,
+                       double dSFreq,
+                       double dOverlap)
+: m_iChannels(iChannels > 0 ? iChannels : 0)
+, m_iFFTLength(iFFTLength > 1 ? iFFTLength : 2)
+, m_dSFreq(dSFreq)
+, m_iFill(0)
+, m_iSegments(0)
+{
+    #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+    #endif
+
+    if(dOverlap < 0.0 || dOverlap >= 1.0) {
+        qWarning() << "RtWelchPsd::RtWelchPsd - Overlap" << dOverlap << "is outside [0, 1). Using no overlap.";
+        dOverlap = 0.0;
+    }
+    m_iStep = m_iFFTLength - qRound(dOverlap * m_iFFTLength);
+    if(m_iStep < 1) {
+        m_iStep = 1;
+    }
+
+    // Hanning window without zero end points, same as used by RtNoise before
+    m_vecWindow.resize(m_iFFTLength);
+    for(int i = 0; i < m_iFFTLength; ++i) {
+        m_vecWindow(i) = 0.5 * (1.0 - cos(2.0 * M_PI * (i + 1) / (m_iFFTLength + 1)));
+    }
+
+    // One-sided density: |X|^2 / (fs * sum(w^2)), doubled for all bins except DC and (for even lengths) Nyquist
+    const int iBins = m_iFFTLength / 2 + 1;
+    m_vecBinScale = RowVectorXd::Constant(iBins, 2.0 / (m_dSFreq * m_vecWindow.squaredNorm()));
+    m_vecBinScale(0) *= 0.5;
+    if(m_iFFTLength % 2 == 0) {
+        m_vecBinScale(iBins - 1) *= 0.5;
+    }
+
+    m_matSegment = MatrixXdR::Zero(m_iChannels, m_iFFTLength);
+    m_matPowerSum = MatrixXdR::Zero(m_iChannels, iBins);
+
+    // Split the channels into one chunk per worker thread
+    int iNumChunks = qMin(QThread::idealThreadCount(), (m_iChannels + MIN_CHANNELS_PER_CHUNK - 1) / MIN_CHANNELS_PER_CHUNK);
+    iNumChunks = iNumChunks > 0 ? iNumChunks : 1;
+
+    m_qVecChunks.resize(iNumChunks);
+    for(int i = 0; i < iNumChunks; ++i) {
+        ChannelChunk& chunk = m_qVecChunks[i];
+        chunk.iFirst = (i * m_iChannels) / iNumChunks;
+        chunk.iCount = ((i + 1) * m_iChannels) / iNumChunks - chunk.iFirst;
+        chunk.fft.SetFlag(chunk.fft.HalfSpectrum);
+        chunk.vecWindowed.resize(m_iFFTLength);
+        chunk.vecSpectrum.resize(iBins);
+    }
+}
+
+
+//*************************************************************************************************************
+
+int RtWelchPsd::append(const MatrixXd& matData)
+{
+    if(matData.rows() != m_iChannels) {
+        qWarning() << "RtWelchPsd::append - Expected" << m_iChannels << "channels but got" << matData.rows() << ". Returning.";
+        return 0;
+    }
+
+    int iCompleted = 0;
+    int iCol = 0;
+
+    while(iCol < matData.cols()) {
+        const int iCount = qMin(m_iFFTLength - m_iFill, int(matData.cols()) - iCol);
+        m_matSegment.middleCols(m_iFill, iCount) = matData.middleCols(iCol, iCount);
+        m_iFill += iCount;
+        iCol += iCount;
+
+        if(m_iFill < m_iFFTLength) {
+            break;
+        }
+
+        // The segment is complete -> transform all channels, each chunk on its own thread
+        if(m_qVecChunks.size() == 1) {
+            accumulate(m_qVecChunks[0]);
+        } else {
+            QtConcurrent::blockingMap(m_qVecChunks, [this](ChannelChunk& chunk) {
+                accumulate(chunk);
+            });
+        }
+        ++m_iSegments;
+        ++iCompleted;
+
+        // Keep the overlapping part as the start of the next segment
+        const int iOverlap = m_iFFTLength - m_iStep;
+        if(iOverlap > 0) {
+            m_matSegment.leftCols(iOverlap) = m_matSegment.rightCols(iOverlap).eval();
+        }
+        m_iFill = iOverlap;
+    }
+
+    return iCompleted;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtWelchPsd::psd() const
+{
+    if(m_iSegments == 0) {
+        return MatrixXd::Zero(m_iChannels, m_matPowerSum.cols());
+    }
+
+    MatrixXd matPsd = m_matPowerSum.array().rowwise() * (m_vecBinScale.array() / m_iSegments);
+
+    return matPsd;
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd RtWelchPsd::frequencies() const
+{
+    return RowVectorXd::LinSpaced(m_matPowerSum.cols(), 0, m_matPowerSum.cols() - 1) * (m_dSFreq / m_iFFTLength);
+}
+
+
+//*************************************************************************************************************
+
+void RtWelchPsd::clearAverage()
+{
+    m_matPowerSum.setZero();
+    m_iSegments = 0;
+}
+
+
+//*************************************************************************************************************
+
+void RtWelchPsd::reset()
+{
+    clearAverage();
+    m_iFill = 0;
+}
+
+
+//*************************************************************************************************************
+
+void RtWelchPsd::accumulate(ChannelChunk& chunk)
+{
+    for(int i = chunk.iFirst; i < chunk.iFirst + chunk.iCount; ++i) {
+        chunk.vecWindowed = m_matSegment.row(i).cwiseProduct(m_vecWindow);
+        chunk.fft.fwd(chunk.vecSpectrum, chunk.vecWindowed);
+        m_matPowerSum.row(i) += chunk.vecSpectrum.cwiseAbs2();
+    }
+}
@@ -0,0 +1,216 @@
+//=============================================================================================================
+/**
+* @file     rtwelchpsd.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the RtWelchPsd class.
+*
+*/
+
+
+#ifndef RTWELCHPSD_H
+#define RTWELCHPSD_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+* Streaming power spectral density estimation after Welch. Incoming samples are cut into Hanning windowed,
+* overlapping segments as they arrive. Each completed segment is transformed with a real-to-complex FFT per
+* channel - the channels are split into chunks which are processed in parallel, each chunk with its own
+* FFT plan and scratch buffers - and its periodogram is added in place to a running sum per channel. Window,
+* scaling and plans are set up once in the constructor, so appending data does not allocate.
+*
+* @brief Streaming multichannel Welch PSD estimation.
+*/
+class RTPROCESINGSHARED_EXPORT RtWelchPsd
+{
+
+public:
+    typedef QSharedPointer<RtWelchPsd> SPtr;             /**< Shared pointer type for RtWelchPsd. */
+    typedef QSharedPointer<const RtWelchPsd> ConstSPtr;  /**< Const shared pointer type for RtWelchPsd. */
+
+    //=========================================================================================================
+    /**
+    * Creates the streaming Welch estimator.
+    *
+    * @param[in] iChannels      Number of channels (rows) of the appended data.
+    * @param[in] iFFTLength     Segment and FFT length in samples.
+    * @param[in] dSFreq         Sampling frequency in Hz.
+    * @param[in] dOverlap       Overlap of consecutive segments as a fraction of the segment length, in [0, 1).
+    */
+    explicit RtWelchPsd(int iChannels,
+                        int iFFTLength,
+                        double dSFreq,
+                        double dOverlap = 0.5);
+
+    //=========================================================================================================
+    /**
+    * Appends data and adds the periodograms of all segments completed by it to the running average.
+    *
+    * @param[in] matData    Channels x samples.
+    *
+    * @return The number of segments completed by this call.
+    */
+    int append(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Returns the one-sided power spectral density averaged over all segments since the last clearAverage().
+    *
+    * @return Channels x (FFT length / 2 + 1), in units of the data squared per Hz. Zero if no segment is complete.
+    */
+    Eigen::MatrixXd psd() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the frequencies of the PSD bins.
+    *
+    * @return The bin frequencies in Hz.
+    */
+    Eigen::RowVectorXd frequencies() const;
+
+    //=========================================================================================================
+    /**
+    * Restarts the average. Samples of a partially filled segment are kept, so the segmentation of the stream
+    * stays continuous.
+    */
+    void clearAverage();
+
+    //=========================================================================================================
+    /**
+    * Restarts the average and drops all buffered samples.
+    */
+    void reset();
+
+    inline int channels() const;
+    inline int fftLength() const;
+    inline int segmentCount() const;
+
+private:
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXdR;
+
+    //=========================================================================================================
+    /**
+    * A range of channels which is transformed by one worker, together with its FFT plan and scratch buffers.
+    */
+    struct ChannelChunk {
+        int                 iFirst;         /**< First channel of the chunk. */
+        int                 iCount;         /**< Number of channels in the chunk. */
+        Eigen::FFT<double>  fft;            /**< FFT object holding the plan of this chunk. */
+        Eigen::RowVectorXd  vecWindowed;    /**< Windowed segment of one channel. */
+        Eigen::RowVectorXcd vecSpectrum;    /**< Half spectrum of one channel. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Adds the periodograms of the current segment for the channels of one chunk to the running sum.
+    *
+    * @param[in, out] chunk     The chunk to process.
+    */
+    void accumulate(ChannelChunk& chunk);
+
+    int                     m_iChannels;        /**< Number of channels. */
+    int                     m_iFFTLength;       /**< Segment and FFT length. */
+    int                     m_iStep;            /**< Number of new samples per segment. */
+    double                  m_dSFreq;           /**< Sampling frequency. */
+
+    Eigen::RowVectorXd      m_vecWindow;        /**< Precomputed Hanning window. */
+    Eigen::RowVectorXd      m_vecBinScale;      /**< Density scaling per bin, including the one-sided doubling. */
+
+    MatrixXdR               m_matSegment;       /**< Samples of the segment being filled, one contiguous row per channel. */
+    int                     m_iFill;            /**< Number of valid samples in m_matSegment. */
+
+    MatrixXdR               m_matPowerSum;      /**< Running sum of the unscaled periodograms. */
+    int                     m_iSegments;        /**< Number of segments in m_matPowerSum. */
+
+    QVector<ChannelChunk>   m_qVecChunks;       /**< Channel chunks processed in parallel. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int RtWelchPsd::channels() const
+{
+    return m_iChannels;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtWelchPsd::fftLength() const
+{
+    return m_iFFTLength;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtWelchPsd::segmentCount() const
+{
+    return m_iSegments;
+}
+
+} // NAMESPACE
+
+#endif // RTWELCHPSD_H
@@ -0,0 +1,488 @@
+//=============================================================================================================
+/**
+* @file     fastkmeans.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FastKMeans class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fastkmeans.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <time.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QThread>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+/**
+* Calls func(iBegin, iEnd) for every range on all available cores and returns the sum of the results.
+*/
+template<typename T, typename Func>
+static T forEachRange(const QVector<QPair<qint32,qint32> >& vecRanges,
+                      Func func)
+{
+    QVector<T> vecResults(vecRanges.size(), T(0));
+    QVector<qint32> vecIndices(vecRanges.size());
+    for(qint32 i = 0; i < vecIndices.size(); ++i) {
+        vecIndices[i] = i;
+    }
+
+    QtConcurrent::blockingMap(vecIndices, [&](const qint32& i) {
+        vecResults[i] = func(vecRanges.at(i).first, vecRanges.at(i).second);
+    });
+
+    T sum = T(0);
+    for(qint32 i = 0; i < vecResults.size(); ++i) {
+        sum += vecResults.at(i);
+    }
+
+    return sum;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FastKMeans::FastKMeans(const QString& distance,
+                       qint32 replicates,
+                       qint32 maxit,
+                       quint32 seed)
+: m_sDistance(distance)
+, m_bCityblock(distance.compare("cityblock") == 0)
+, m_iReps(qMax(1, replicates))
+, m_iMaxit(qMax(1, maxit))
+, m_rng(seed != 0 ? seed : static_cast<quint32>(time(NULL)))
+, k(0)
+, n(0)
+, p(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool FastKMeans::calculate(const MatrixXd& X,
+                           qint32 kClusters,
+                           VectorXi& idx,
+                           MatrixXd& C,
+                           VectorXd& sumD,
+                           MatrixXd& D)
+{
+    if(m_sDistance.compare("sqeuclidean") != 0 && !m_bCityblock) {
+        qWarning() << "FastKMeans::calculate - Unsupported distance" << m_sDistance << ". Use sqeuclidean or cityblock.";
+        return false;
+    }
+
+    k = kClusters;
+    n = X.rows();
+    p = X.cols();
+
+    if(k < 1 || n < k) {
+        return false;
+    }
+
+    // Work buffers, one point / centroid per column keeps the distance computations contiguous
+    m_matXT = X.transpose();
+    m_vecIdx.resize(n);
+    m_vecUpper.resize(n);
+    m_vecLower.resize(n);
+    m_vecHalfSep.resize(k);
+    m_vecShift.resize(k);
+    m_vecCounts.resize(k);
+    m_vecOrder.resize(n);
+    m_vecStart.resize(k + 1);
+
+    const qint32 iNumRanges = qBound(1, QThread::idealThreadCount() * 4, qMax(1, n / 64));
+    const qint32 iStep = (n + iNumRanges - 1) / iNumRanges;
+    m_vecRanges.clear();
+    for(qint32 i = 0; i < n; i += iStep) {
+        m_vecRanges.append(qMakePair(i, qMin(i + iStep, n)));
+    }
+
+    double dBestCost = std::numeric_limits<double>::max();
+    MatrixXd matBestCT;
+    VectorXi vecBestIdx;
+
+    for(qint32 rep = 0; rep < m_iReps; ++rep) {
+        seed();
+
+        if(!run()) {
+            printf("Failed To Converge during replicate %d\n", rep);
+        }
+
+        // Exact cost of this replicate
+        double dCost = 0;
+        for(qint32 i = 0; i < n; ++i) {
+            double dDist = metric(m_matXT.col(i), m_matCT.col(m_vecIdx[i]));
+            dCost += m_bCityblock ? dDist : dDist * dDist;
+        }
+
+        if(dCost < dBestCost) {
+            dBestCost = dCost;
+            matBestCT = m_matCT;
+            vecBestIdx = m_vecIdx;
+        }
+    }
+
+    // Return the best solution
+    idx = vecBestIdx;
+    C = matBestCT.transpose();
+
+    D.resize(n, k);
+    for(qint32 j = 0; j < k; ++j) {
+        if(m_bCityblock) {
+            D.col(j) = (m_matXT.colwise() - matBestCT.col(j)).cwiseAbs().colwise().sum().transpose();
+        } else {
+            D.col(j) = (m_matXT.colwise() - matBestCT.col(j)).colwise().squaredNorm().transpose();
+        }
+    }
+
+    sumD = VectorXd::Zero(k);
+    for(qint32 i = 0; i < n; ++i) {
+        sumD[idx[i]] += D(i, idx[i]);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FastKMeans::seed()
+{
+    m_matCT.resize(p, k);
+
+    std::uniform_int_distribution<qint32> uniformIdx(0, n - 1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Greedy k-means++: several candidates are drawn per centroid and the one reducing the potential most is kept
+    const qint32 iNumTrials = 2 + static_cast<qint32>(std::log(static_cast<double>(k)));
+
+    VectorXd vecMinDist(n);
+    MatrixXd matTrialDist(n, iNumTrials);
+    std::vector<double> vecCumSum(n);
+
+    m_matCT.col(0) = m_matXT.col(uniformIdx(m_rng));
+    forEachRange<qint32>(m_vecRanges, [&](qint32 iBegin, qint32 iEnd) {
+        for(qint32 i = iBegin; i < iEnd; ++i) {
+            double dDist = metric(m_matXT.col(i), m_matCT.col(0));
+            vecMinDist[i] = dDist * dDist;
+        }
+        return 0;
+    });
+
+    for(qint32 j = 1; j < k; ++j) {
+        double dSum = 0;
+        for(qint32 i = 0; i < n; ++i) {
+            dSum += vecMinDist[i];
+            vecCumSum[i] = dSum;
+        }
+
+        double dBestPotential = std::numeric_limits<double>::max();
+        qint32 iBestTrial = 0;
+        qint32 iBestPick = 0;
+
+        for(qint32 t = 0; t < iNumTrials; ++t) {
+            qint32 iPick;
+            if(dSum > 0) {
+                iPick = std::lower_bound(vecCumSum.begin(), vecCumSum.end(), uniform(m_rng) * dSum) - vecCumSum.begin();
+                iPick = qMin(iPick, n - 1);
+            } else {
+                iPick = uniformIdx(m_rng);
+            }
+
+            // Squared distance of each point to the closest centroid if this candidate is taken
+            const double dPotential = forEachRange<double>(m_vecRanges, [&](qint32 iBegin, qint32 iEnd) {
+                double dPartial = 0;
+                for(qint32 i = iBegin; i < iEnd; ++i) {
+                    double dDist = metric(m_matXT.col(i), m_matXT.col(iPick));
+                    matTrialDist(i, t) = qMin(vecMinDist[i], dDist * dDist);
+                    dPartial += matTrialDist(i, t);
+                }
+                return dPartial;
+            });
+
+            if(dPotential < dBestPotential) {
+                dBestPotential = dPotential;
+                iBestTrial = t;
+                iBestPick = iPick;
+            }
+        }
+
+        m_matCT.col(j) = m_matXT.col(iBestPick);
+        vecMinDist = matTrialDist.col(iBestTrial);
+    }
+}
+
+
+//*************************************************************************************************************
+
+qint32 FastKMeans::assignAll(qint32 iBegin,
+                             qint32 iEnd)
+{
+    qint32 iChanged = 0;
+
+    for(qint32 i = iBegin; i < iEnd; ++i) {
+        double dBest = std::numeric_limits<double>::max();
+        double dSecond = std::numeric_limits<double>::max();
+        qint32 iBest = 0;
+
+        for(qint32 j = 0; j < k; ++j) {
+            double dDist = metric(m_matXT.col(i), m_matCT.col(j));
+            if(dDist < dBest) {
+                dSecond = dBest;
+                dBest = dDist;
+                iBest = j;
+            } else if(dDist < dSecond) {
+                dSecond = dDist;
+            }
+        }
+
+        if(m_vecIdx[i] != iBest) {
+            m_vecIdx[i] = iBest;
+            ++iChanged;
+        }
+        m_vecUpper[i] = dBest;
+        m_vecLower[i] = dSecond;
+    }
+
+    return iChanged;
+}
+
+
+//*************************************************************************************************************
+
+qint32 FastKMeans::assignPruned(qint32 iBegin,
+                                qint32 iEnd)
+{
+    qint32 iChanged = 0;
+
+    for(qint32 i = iBegin; i < iEnd; ++i) {
+        const qint32 a = m_vecIdx[i];
+        const double dBound = qMax(m_vecHalfSep[a], m_vecLower[i]);
+
+        if(m_vecUpper[i] <= dBound) {
+            continue;
+        }
+
+        // Tighten the upper bound and test again before computing all distances
+        m_vecUpper[i] = metric(m_matXT.col(i), m_matCT.col(a));
+        if(m_vecUpper[i] <= dBound) {
+            continue;
+        }
+
+        iChanged += assignAll(i, i + 1);
+    }
+
+    return iChanged;
+}
+
+
+//*************************************************************************************************************
+
+void FastKMeans::updateCentroids()
+{
+    // Counts and points sorted by cluster
+    m_vecCounts.setZero();
+    for(qint32 i = 0; i < n; ++i) {
+        ++m_vecCounts[m_vecIdx[i]];
+    }
+
+    // Empty clusters take over the point farthest from its centroid
+    for(qint32 j = 0; j < k; ++j) {
+        if(m_vecCounts[j] > 0) {
+            continue;
+        }
+
+        qint32 iFar = -1;
+        for(qint32 i = 0; i < n; ++i) {
+            if(m_vecCounts[m_vecIdx[i]] > 1 && (iFar < 0 || m_vecUpper[i] > m_vecUpper[iFar])) {
+                iFar = i;
+            }
+        }
+
+        if(iFar < 0) {
+            break;
+        }
+
+        --m_vecCounts[m_vecIdx[iFar]];
+        ++m_vecCounts[j];
+        m_vecIdx[iFar] = j;
+        m_vecUpper[iFar] = 0;
+        m_vecLower[iFar] = 0;
+    }
+
+    m_vecStart[0] = 0;
+    for(qint32 j = 0; j < k; ++j) {
+        m_vecStart[j + 1] = m_vecStart[j] + m_vecCounts[j];
+    }
+
+    VectorXi vecFill = m_vecStart.head(k);
+    for(qint32 i = 0; i < n; ++i) {
+        m_vecOrder[vecFill[m_vecIdx[i]]++] = i;
+    }
+
+    // Centroids, the clusters are independent of each other
+    QVector<qint32> vecClusters(k);
+    for(qint32 j = 0; j < k; ++j) {
+        vecClusters[j] = j;
+    }
+
+    QtConcurrent::blockingMap(vecClusters, [this](const qint32& j) {
+        const qint32 iStart = m_vecStart[j];
+        const qint32 iCount = m_vecCounts[j];
+
+        if(iCount == 0) {
+            return;
+        }
+
+        if(!m_bCityblock) {
+            VectorXd vecSum = VectorXd::Zero(p);
+            for(qint32 i = iStart; i < iStart + iCount; ++i) {
+                vecSum += m_matXT.col(m_vecOrder[i]);
+            }
+            m_matCT.col(j) = vecSum / iCount;
+        } else {
+            // Component-wise median
+            std::vector<double> vecValues(iCount);
+            const qint32 iMid = iCount / 2;
+
+            for(qint32 d = 0; d < p; ++d) {
+                for(qint32 i = 0; i < iCount; ++i) {
+                    vecValues[i] = m_matXT(d, m_vecOrder[iStart + i]);
+                }
+
+                std::nth_element(vecValues.begin(), vecValues.begin() + iMid, vecValues.end());
+                double dMedian = vecValues[iMid];
+
+                if(iCount % 2 == 0) {
+                    dMedian = 0.5 * (dMedian + *std::max_element(vecValues.begin(), vecValues.begin() + iMid));
+                }
+
+                m_matCT(d, j) = dMedian;
+            }
+        }
+    });
+}
+
+
+//*************************************************************************************************************
+
+bool FastKMeans::run()
+{
+    m_vecIdx.setConstant(-1);
+    forEachRange<qint32>(m_vecRanges, [this](qint32 iBegin, qint32 iEnd) { return assignAll(iBegin, iEnd); });
+
+    for(qint32 iter = 0; iter < m_iMaxit; ++iter) {
+        m_matCOld = m_matCT;
+        updateCentroids();
+
+        // Centroid movement
+        qint32 iMaxShift = 0;
+        double dMaxShift = 0;
+        double dSecondShift = 0;
+        for(qint32 j = 0; j < k; ++j) {
+            m_vecShift[j] = metric(m_matCOld.col(j), m_matCT.col(j));
+
+            if(m_vecShift[j] > dMaxShift) {
+                dSecondShift = dMaxShift;
+                dMaxShift = m_vecShift[j];
+                iMaxShift = j;
+            } else if(m_vecShift[j] > dSecondShift) {
+                dSecondShift = m_vecShift[j];
+            }
+        }
+
+        // Half distance of each centroid to its closest other centroid
+        m_vecHalfSep.setConstant(std::numeric_limits<double>::max());
+        for(qint32 j = 0; j < k; ++j) {
+            for(qint32 jj = j + 1; jj < k; ++jj) {
+                double dDist = 0.5 * metric(m_matCT.col(j), m_matCT.col(jj));
+                m_vecHalfSep[j] = qMin(m_vecHalfSep[j], dDist);
+                m_vecHalfSep[jj] = qMin(m_vecHalfSep[jj], dDist);
+            }
+        }
+
+        // Bounds follow the centroid movement
+        for(qint32 i = 0; i < n; ++i) {
+            const qint32 a = m_vecIdx[i];
+            m_vecUpper[i] += m_vecShift[a];
+            m_vecLower[i] -= (a == iMaxShift) ? dSecondShift : dMaxShift;
+        }
+
+        const qint32 iChanged = forEachRange<qint32>(m_vecRanges, [this](qint32 iBegin, qint32 iEnd) { return assignPruned(iBegin, iEnd); });
+
+        if(iChanged == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
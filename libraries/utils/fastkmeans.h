@@ -0,0 +1,244 @@
+//=============================================================================================================
+/**
+* @file     fastkmeans.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FastKMeans class declaration.
+*
+*/
+
+
+#ifndef FASTKMEANS_H
+#define FASTKMEANS_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <random>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QSharedPointer>
+#include <QVector>
+#include <QPair>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* K-Means clustering with k-means++ seeding and Hamerly's bound pruning. Each point keeps an upper bound on
+* the distance to its own centroid and a lower bound on the distance to every other centroid, so the full
+* distance computation is skipped for most points once the clustering settles. The assignment step is
+* distributed over the available cores and all work buffers are reused across iterations and replicates.
+*
+* Supported distances are "sqeuclidean" (mean centroids) and "cityblock" (component-wise median centroids).
+* Empty clusters are re-seeded with the point farthest from its centroid.
+*
+* @brief Accelerated K-Means clustering
+*/
+class UTILSSHARED_EXPORT FastKMeans
+{
+public:
+    typedef QSharedPointer<FastKMeans> SPtr;            /**< Shared pointer type for FastKMeans. */
+    typedef QSharedPointer<const FastKMeans> ConstSPtr; /**< Const shared pointer type for FastKMeans. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a FastKMeans algorithm object.
+    *
+    * @param[in] distance   (optional) K-Means distance measure: "sqeuclidean" (default), "cityblock"
+    * @param[in] replicates (optional) Number of K-Means replicates, which are generated. Best is returned.
+    * @param[in] maxit      (optional) maximal number of iterations per replicate; 100 by default
+    * @param[in] seed       (optional) seed of the random generator; 0 (default) seeds from the current time
+    */
+    explicit FastKMeans(const QString& distance = QString("sqeuclidean"),
+                        qint32 replicates = 1,
+                        qint32 maxit = 100,
+                        quint32 seed = 0);
+
+    //=========================================================================================================
+    /**
+    * Clusters input data X
+    *
+    * @param[in] X          Input data (rows = points; cols = p dimensional space)
+    * @param[in] kClusters  Number of k clusters
+    * @param[out] idx       The cluster indeces to which cluster the input points belong to
+    * @param[out] C         Cluster centroids k x p
+    * @param[out] sumD      Summation of the distances to the centroid within one cluster
+    * @param[out] D         Cluster distances to the centroid n x k
+    *
+    * @return true if successful, false otherwise
+    */
+    bool calculate(const Eigen::MatrixXd& X,
+                   qint32 kClusters,
+                   Eigen::VectorXi& idx,
+                   Eigen::MatrixXd& C,
+                   Eigen::VectorXd& sumD,
+                   Eigen::MatrixXd& D);
+
+private:
+    //=========================================================================================================
+    /**
+    * Metric distance between a point and a centroid, i.e. euclidean for "sqeuclidean", which keeps the bounds valid.
+    *
+    * @param[in] x      The point.
+    * @param[in] c      The centroid.
+    *
+    * @return the distance
+    */
+    template<typename DerivedX, typename DerivedC>
+    inline double metric(const Eigen::MatrixBase<DerivedX>& x,
+                         const Eigen::MatrixBase<DerivedC>& c) const;
+
+    //=========================================================================================================
+    /**
+    * Greedy k-means++ seeding: every further centroid is drawn with a probability proportional to the squared
+    * distance to the closest centroid chosen so far. Of several drawn candidates the one with the lowest
+    * resulting potential is kept.
+    *
+    * The points are taken from m_matXT, the centroids are written to m_matCT.
+    */
+    void seed();
+
+    //=========================================================================================================
+    /**
+    * Computes the distances to all centroids and sets assignment, upper and lower bound of the points in [iBegin, iEnd).
+    *
+    * @param[in] iBegin     The first point.
+    * @param[in] iEnd       One past the last point.
+    *
+    * @return the number of points which changed their assignment
+    */
+    qint32 assignAll(qint32 iBegin,
+                     qint32 iEnd);
+
+    //=========================================================================================================
+    /**
+    * Hamerly assignment step for the points in [iBegin, iEnd). Points whose upper bound is below both their lower
+    * bound and half the distance of their centroid to the closest other centroid are skipped.
+    *
+    * @param[in] iBegin     The first point.
+    * @param[in] iEnd       One past the last point.
+    *
+    * @return the number of points which changed their assignment
+    */
+    qint32 assignPruned(qint32 iBegin,
+                        qint32 iEnd);
+
+    //=========================================================================================================
+    /**
+    * Recomputes the centroids in m_matCT from the current assignment. Empty clusters take over the point farthest
+    * from its centroid.
+    */
+    void updateCentroids();
+
+    //=========================================================================================================
+    /**
+    * Runs one replicate starting from the centroids in m_matCT.
+    *
+    * @return true if converged, false otherwise
+    */
+    bool run();
+
+    QString m_sDistance;        /**< Distance measurement to use: "sqeuclidean" (default), "cityblock". */
+    bool m_bCityblock;          /**< Whether the cityblock distance is used. */
+    qint32 m_iReps;             /**< Number of K-Means replicates, which should be generated. */
+    qint32 m_iMaxit;            /**< Maximal number of iterations per replicate */
+
+    std::mt19937 m_rng;         /**< Random generator used for seeding. */
+
+    qint32 k;                   /**< Number of clusters */
+    qint32 n;                   /**< Number of points to be clustered */
+    qint32 p;                   /**< dimension of space in which the clustering is performed */
+
+    QVector<QPair<qint32,qint32> > m_vecRanges;     /**< Point ranges processed in parallel. */
+    Eigen::VectorXi m_vecIdx;                       /**< Current assignment of each point. */
+    Eigen::VectorXd m_vecUpper;                     /**< Upper bound of the distance of each point to its centroid. */
+    Eigen::VectorXd m_vecLower;                     /**< Lower bound of the distance of each point to any other centroid. */
+    Eigen::VectorXd m_vecHalfSep;                   /**< Half the distance of each centroid to its closest other centroid. */
+    Eigen::VectorXd m_vecShift;                     /**< Distance each centroid moved in the last update. */
+    Eigen::VectorXi m_vecCounts;                    /**< Number of points of each cluster. */
+    Eigen::VectorXi m_vecOrder;                     /**< Point indices sorted by cluster. */
+    Eigen::VectorXi m_vecStart;                     /**< Start of each cluster in m_vecOrder. */
+    Eigen::MatrixXd m_matXT;                        /**< Input data, one point per column. */
+    Eigen::MatrixXd m_matCT;                        /**< Centroids, one per column. */
+    Eigen::MatrixXd m_matCOld;                      /**< Centroids of the previous iteration, one per column. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+template<typename DerivedX, typename DerivedC>
+inline double FastKMeans::metric(const Eigen::MatrixBase<DerivedX>& x,
+                                 const Eigen::MatrixBase<DerivedC>& c) const
+{
+    if(m_bCityblock) {
+        return (x - c).template lpNorm<1>();
+    }
+
+    return (x - c).norm();
+}
+
+} // NAMESPACE
+
+#endif // FASTKMEANS_H
@@ -128,6 +128,15 @@ public:
     */
     inline void push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix);
 
+    //=========================================================================================================
+    /**
+    * Adds a whole matrix at the end buffer. Takes any column major view, e.g. a block of a larger matrix,
+    * without copying it first.
+    *
+    * @param [in] matrix Matrix which should be apend to the end.
+    */
+    inline void push(const Eigen::Ref<const Matrix<_Tp, Dynamic, Dynamic> >& matrix);
+
     //=========================================================================================================
     /**
     * Returns the first matrix (first in first out).
@@ -241,15 +250,25 @@ CircularMatrixBuffer<_Tp>::~CircularMatrixBuffer()
 
 template<typename _Tp>
 inline void CircularMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix)
+{
+    push(*pMatrix);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::push(const Eigen::Ref<const Matrix<_Tp, Dynamic, Dynamic> >& matrix)
 {
     if(!m_bPause)
     {
-        unsigned int t_size = pMatrix->size();
+        unsigned int t_size = matrix.size();
         if(t_size == m_uiRows*m_uiCols)
         {
             m_pFreeElements->acquire(t_size);
-            for(unsigned int i = 0; i < t_size; ++i)
-                m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pMatrix->data()[i];
+            for(Index j = 0; j < matrix.cols(); ++j)
+                for(Index i = 0; i < matrix.rows(); ++i)
+                    m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = matrix(i, j);
             m_pUsedElements->release(t_size);
         }
 
@@ -41,12 +41,21 @@
 #include "ioutils.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // Qt INCLUDES
 //=============================================================================================================
 
 #include <QDataStream>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -73,10 +82,9 @@ using namespace UTILSLIB;
 
 qint32 IOUtils::fread3(QDataStream &p_qStream)
 {
-    char* bytes = new char[3];
+    char bytes[3];
     p_qStream.readRawData(bytes, 3);
     qint32 int3 = (((unsigned char) bytes[0]) << 16) + (((unsigned char) bytes[1]) << 8) + ((unsigned char) bytes[2]);
-    delete[] bytes;
     return int3;
 }
 
@@ -87,8 +95,13 @@ VectorXi IOUtils::fread3_many(QDataStream &p_qStream, qint32 count)
 {
     VectorXi res(count);
 
+    //read all bytes at once and assemble the integers afterwards
+    QByteArray bytes(3 * count, 0);
+    p_qStream.readRawData(bytes.data(), bytes.size());
+
+    const unsigned char* data = (const unsigned char*) bytes.constData();
     for(qint32 i = 0; i < count; ++i)
-        res[i] = IOUtils::fread3(p_qStream);
+        res[i] = (data[3*i] << 16) + (data[3*i+1] << 8) + data[3*i+2];
 
     return res;
 }
@@ -253,6 +266,48 @@ void IOUtils::swap_doublep(double *source)
 }
 
 
+//*************************************************************************************************************
+
+void IOUtils::swap_shortp(qint16 *source, qint64 count)
+{
+    quint16 value;
+    for(qint64 i = 0; i < count; ++i)
+    {
+        memcpy(&value, source + i, sizeof(value));
+        value = qbswap(value);
+        memcpy(source + i, &value, sizeof(value));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_intp(qint32 *source, qint64 count)
+{
+    quint32 value;
+    for(qint64 i = 0; i < count; ++i)
+    {
+        memcpy(&value, source + i, sizeof(value));
+        value = qbswap(value);
+        memcpy(source + i, &value, sizeof(value));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_floatp(float *source, qint64 count)
+{
+    quint32 value;
+    for(qint64 i = 0; i < count; ++i)
+    {
+        memcpy(&value, source + i, sizeof(value));
+        value = qbswap(value);
+        memcpy(source + i, &value, sizeof(value));
+    }
+}
+
+
 //*************************************************************************************************************
 
 QStringList IOUtils::get_new_chnames_conventions(const QStringList& chNames)
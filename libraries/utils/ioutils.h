@@ -202,6 +202,36 @@ public:
     */
     static void swap_doublep(double *source);
 
+    //=========================================================================================================
+    /**
+    * swap an array of shorts in place. The loop is kept free of branches, so that the compiler can vectorize it.
+    * The bytes are always swapped, callers converting from big endian files guard the call by Q_BYTE_ORDER.
+    *
+    * @param[in, out] source     shorts to swap
+    * @param[in] count           number of shorts
+    */
+    static void swap_shortp(qint16 *source, qint64 count);
+
+    //=========================================================================================================
+    /**
+    * swap an array of integers in place. The loop is kept free of branches, so that the compiler can vectorize it.
+    * The bytes are always swapped, callers converting from big endian files guard the call by Q_BYTE_ORDER.
+    *
+    * @param[in, out] source     integers to swap
+    * @param[in] count           number of integers
+    */
+    static void swap_intp(qint32 *source, qint64 count);
+
+    //=========================================================================================================
+    /**
+    * swap an array of floats in place. The loop is kept free of branches, so that the compiler can vectorize it.
+    * The bytes are always swapped, callers converting from big endian files guard the call by Q_BYTE_ORDER.
+    *
+    * @param[in, out] source     floats to swap
+    * @param[in] count           number of floats
+    */
+    static void swap_floatp(float *source, qint64 count);
+
     //=========================================================================================================
     /**
     * Write Eigen Matrix to file
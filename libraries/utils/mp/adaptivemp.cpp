@@ -72,6 +72,7 @@
 
 #include <QFuture>
 #include <QtConcurrent>
+#include <QThreadStorage>
 
 
 //*************************************************************************************************************
@@ -82,6 +83,106 @@
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+// per thread buffers of the correlation search, the FFT object keeps its plans for every sample length it was used with
+struct AdaptiveMpWorkspace
+{
+    Eigen::FFT<double> fft;
+    VectorXd envelope;
+    VectorXcd fft_envelope;
+    VectorXcd modulation;
+    VectorXcd modulated_resid;
+    VectorXcd fft_modulated_resid;
+    VectorXd corr_coeffs;
+};
+
+static QThreadStorage<AdaptiveMpWorkspace*> s_workspaces;
+
+static AdaptiveMpWorkspace& local_workspace()
+{
+    if(!s_workspaces.hasLocalData())
+        s_workspaces.setLocalData(new AdaptiveMpWorkspace);
+
+    return *s_workspaces.localData();
+}
+
+//=============================================================================================================
+
+static void fill_modulation(VectorXcd& modulation, qint32 N, qreal k)
+{
+    modulation.resize(N);
+
+    for(qint32 n = 0; n < N; n++)
+        modulation[n] = std::polar(1 / sqrt(qreal(N)), 2 * PI * k / qreal(N) * qreal(n));
+}
+
+//=============================================================================================================
+
+// searches translation and modulation of one dyadic scale, one task per scale runs in the thread pool
+struct AdaptiveMpScaleSearch
+{
+    qreal scale;
+    qint32 j;
+    const MatrixXd* residuum;
+    qint32 channel_count;
+    bool fix_phase;
+    bool trial_separation;
+
+    //returns the best parameters (scale, translation, modulation, phase, scalarproduct, channel) as columns,
+    //one column per channel in case of trial separation, otherwise one column for all channels
+    MatrixXd search() const
+    {
+        const qint32 sample_count = residuum->rows();
+        AdaptiveMpWorkspace& ws = local_workspace();
+
+        MatrixXd best_params = MatrixXd::Zero(6, trial_separation ? channel_count : 1);
+
+        qint32 p = floor(sample_count / 2);      //translation
+        ws.envelope = GaborAtom::gauss_function(sample_count, scale, p);
+        ws.fft.fwd(ws.fft_envelope, ws.envelope);
+
+        qreal k = 0;                             //for modulation 2*pi*k/N
+        while(k < sample_count/2)
+        {
+            fill_modulation(ws.modulation, sample_count, k);
+
+            //iteration for multichannel, depending on boost setting
+            for(qint32 chn = 0; chn < channel_count; chn++)
+            {
+                //complex correlation of signal and sinus-modulated gaussfunction
+                ws.modulated_resid = residuum->col(chn).cast<std::complex<double> >().cwiseProduct(ws.modulation);
+                ws.fft.fwd(ws.fft_modulated_resid, ws.modulated_resid);
+                ws.fft_modulated_resid.array() *= ws.fft_envelope.conjugate().array();
+                ws.fft.inv(ws.corr_coeffs, ws.fft_modulated_resid);
+
+                //find index of maximum correlation-coefficient to use in translation
+                std::ptrdiff_t max_index = 0;
+                ws.corr_coeffs.maxCoeff(&max_index);
+
+                //adapting translation p to create atomtranslation correctly
+                qint32 translation = (max_index >= p) ? max_index - p + 1 : max_index + p;
+
+                VectorXd atom_parameters = AdaptiveMp::calculate_atom(sample_count, scale, translation, k, chn, *residuum, RETURNPARAMETERS, fix_phase);
+
+                qint32 slot = trial_separation ? chn : 0;
+                if(std::fabs(atom_parameters[4]) >= std::fabs(best_params(4, slot)))
+                {
+                    best_params.col(slot).head(5) = atom_parameters;
+                    best_params(5, slot) = chn;
+                }
+            }
+            k += pow(2.0,(-j))*sample_count/2;
+        }
+
+        return best_params;
+    }
+};
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -113,7 +214,6 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
     std::cout << "\nAdaptive Matching Pursuit Algorithm started...\n";
 
     max_it = max_iterations;
-    Eigen::FFT<double> fft;
     MatrixXd residuum = signal; //residuum initialised with signal
     qint32 sample_count = signal.rows();
     qint32 channel_count = signal.cols();
@@ -150,91 +250,48 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
         gabor_Atom->energy = 0;
         qreal phase = 0;
 
+        //the scales are searched in parallel, the results are merged in scale order afterwards
+        QList<AdaptiveMpScaleSearch> scale_searches;
         while(s < sample_count)
         {
-            k = 0;                               //for modulation 2*pi*k/N
-            p = floor(sample_count / 2);         //translation
-            VectorXd envelope = GaborAtom::gauss_function(sample_count, s, p);
-            VectorXcd fft_envelope = RowVectorXcd::Zero(sample_count);
-            fft.fwd(fft_envelope, envelope);
-
-            while(k < sample_count/2)
-            {
-                p = floor(sample_count/2);
-                VectorXcd modulation = modulation_function(sample_count, k);
-                VectorXcd modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_m_e_resid = VectorXcd::Zero(sample_count);
-                VectorXd corr_coeffs = VectorXd::Zero(sample_count);
-
-                //iteration for multichannel, depending on boost setting
-                for(qint32 chn = 0; chn < channel_count; chn++)
-                {
-                    qint32 max_index = 0;
-                    qreal maximum = 0;
-                    phase = 0;
-                    p = floor(sample_count/2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
-
-                    //complex correlation of signal and sinus-modulated gaussfunction
-                    for(qint32 l = 0; l< sample_count; l++)
-                        modulated_resid[l] = residuum(l, chn) * modulation[l];
+            AdaptiveMpScaleSearch scale_search;
+            scale_search.scale = s;
+            scale_search.j = j;
+            scale_search.residuum = &residuum;
+            scale_search.channel_count = channel_count;
+            scale_search.fix_phase = fix_phase;
+            scale_search.trial_separation = trial_separation;
+            scale_searches.append(scale_search);
 
-                    fft.fwd(fft_modulated_resid, modulated_resid);
-
-                    for( qint32 m = 0; m < sample_count; m++)
-                        fft_m_e_resid[m] = fft_modulated_resid[m] * conj(fft_envelope[m]);
-
-                    fft.inv(corr_coeffs, fft_m_e_resid);
-                    maximum = corr_coeffs[0];
-
-                    //find index of maximum correlation-coefficient to use in translation
-                    for(qint32 i = 1; i < corr_coeffs.rows(); i++)
-                        if(maximum < corr_coeffs[i])
-                        {
-                            maximum = corr_coeffs[i];
-                            max_index = i;
-                        }
-
-                    //adapting translation p to create atomtranslation correctly
-                    if(max_index >= p) p = max_index - p + 1;
-                    else p = max_index + p;
-
-                    VectorXd atom_parameters = calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase);
-                    qreal temp_scalar_product = 0;
-                    if(trial_separation) temp_scalar_product = max_scalar_product[chn];
-                    else temp_scalar_product = max_scalar_product[0];
+            j++;
+            s = pow(2.0,j);
+        }
 
-                    if(std::fabs(atom_parameters[4]) >= std::fabs(temp_scalar_product))
-                    {
-                        //set highest scalarproduct, in comparison to best matching atom
-                        gabor_Atom->scale              = atom_parameters[0];
-                        gabor_Atom->translation        = atom_parameters[1];
-                        gabor_Atom->modulation         = atom_parameters[2];
-                        gabor_Atom->phase              = atom_parameters[3];
-                        gabor_Atom->max_scalar_product = atom_parameters[4];
-                        gabor_Atom->bm_channel         = chn;
-
-                        if(trial_separation)
-                        {
-                            max_scalar_product[chn]    = atom_parameters[4];
-
-                            if(atoms_in_chns.length() < channel_count)
-                                atoms_in_chns.append(*gabor_Atom);
-                            else
-                                atoms_in_chns.replace(chn, *gabor_Atom);
-                        }
-                        else
-                            max_scalar_product[0]      = atom_parameters[4];
+        QFuture<MatrixXd> scale_results = QtConcurrent::mapped(scale_searches, &AdaptiveMpScaleSearch::search);
+        scale_results.waitForFinished();
 
-                    }
+        MatrixXd best_params = MatrixXd::Zero(6, trial_separation ? channel_count : 1);
+        QFuture<MatrixXd>::const_iterator result;
+        for(result = scale_results.constBegin(); result != scale_results.constEnd(); result++)
+            for(qint32 slot = 0; slot < best_params.cols(); slot++)
+                if(std::fabs((*result)(4, slot)) >= std::fabs(best_params(4, slot)))
+                    best_params.col(slot) = result->col(slot);
 
-                }
-                k += pow(2.0,(-j))*sample_count/2;
+        //set highest scalarproduct, in comparison to best matching atom
+        for(qint32 slot = 0; slot < best_params.cols() && scale_searches.size() > 0; slot++)
+        {
+            gabor_Atom->scale              = best_params(0, slot);
+            gabor_Atom->translation        = best_params(1, slot);
+            gabor_Atom->modulation         = best_params(2, slot);
+            gabor_Atom->phase              = best_params(3, slot);
+            gabor_Atom->max_scalar_product = best_params(4, slot);
+            gabor_Atom->bm_channel         = best_params(5, slot);
+            max_scalar_product[slot]       = best_params(4, slot);
 
-            }
-            j++;
-            s = pow(2.0,j);
+            if(trial_separation)
+                atoms_in_chns.append(*gabor_Atom);
         }
+
         std::cout << "\n" << "===============" << " found parameters " << it + 1 << "===============" << ":\n\n"<<
                      "scale: " << gabor_Atom->scale << " trans: " << gabor_Atom->translation <<
                      " modu: " << gabor_Atom->modulation << " phase: " << gabor_Atom->phase << " sclr_prdct: " << gabor_Atom->max_scalar_product << "\n";
@@ -392,59 +449,47 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
 
 VectorXcd AdaptiveMp::modulation_function(qint32 N, qreal k)
 {
-    VectorXcd modulation = VectorXcd::Zero(N);
-
-    for(qint32 n = 0; n < N; n++)
-    {
-        modulation[n] = std::polar(1 / sqrt(qreal(N)), 2 * PI * k / qreal(N) * qreal(n));
-    }
+    VectorXcd modulation;
+    fill_modulation(modulation, N, k);
     return modulation;
 }
 
 //*************************************************************************************************************
 
-VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
+VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
 {
-    GaborAtom *gabor_Atom = new GaborAtom();
+    GaborAtom gabor_Atom;
     qreal phase = 0;
     //create complex Gaboratom
-    VectorXcd complex_gabor_atom = gabor_Atom->create_complex(sample_count, scale, translation, modulation);
+    VectorXcd complex_gabor_atom = gabor_Atom.create_complex(sample_count, scale, translation, modulation);
 
-    //calculate Inner Product: preparation to find the parameter phase
+    //calculate Inner Product: preparation to find the parameter phase, <r, conj(g)> = <r, re(g)> - i <r, im(g)>
     std::complex<double> inner_product(0, 0);
 
     if(fix_phase == false)
     {
-        for(qint32 i = 0; i < sample_count; i++)
-            inner_product += residuum(i, channel) * conj(complex_gabor_atom[i]);
+        inner_product = std::complex<double>(residuum.col(channel).head(sample_count).dot(complex_gabor_atom.real()),
+                                             -residuum.col(channel).head(sample_count).dot(complex_gabor_atom.imag()));
     }
-    else
+    else if(residuum.cols() != 0)
     {
-        for(qint32 chn = 0; chn < residuum.cols(); chn++)
-        {
-            for(qint32 i = 0; i < sample_count; i++)
-                inner_product += residuum(i, chn) * conj(complex_gabor_atom[i]);
-        }
-        if(residuum.cols() != 0)
-            inner_product /= residuum.cols();
+        //the mean inner product over all channels equals the inner product with the channel mean
+        VectorXd channel_mean = residuum.topRows(sample_count).rowwise().sum() / residuum.cols();
+        inner_product = std::complex<double>(channel_mean.dot(complex_gabor_atom.real()),
+                                             -channel_mean.dot(complex_gabor_atom.imag()));
     }
 
     //calculate phase to create realGaborAtoms
     phase = std::arg(inner_product);
     if (phase < 0) phase = 2 * PI - phase;
-    VectorXd real_gabor_atom = gabor_Atom->create_real(sample_count, scale, translation, modulation, phase);
-
-    delete gabor_Atom;
+    VectorXd real_gabor_atom = gabor_Atom.create_real(sample_count, scale, translation, modulation, phase);
 
     switch(return_value)
     {
     case RETURNPARAMETERS:
     {
 
-        qreal scalar_product = 0;
-
-        for(qint32 i = 0; i < sample_count; i++)
-            scalar_product += real_gabor_atom[i] * residuum(i, channel);
+        qreal scalar_product = real_gabor_atom.dot(residuum.col(channel).head(sample_count));
 
         VectorXd atom_parameters = VectorXd::Zero(5);
 
@@ -467,7 +512,7 @@ VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 tra
 //*************************************************************************************************************
 
 void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                                      GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn)
+                                      GaborAtom *gabor_Atom, const VectorXd& max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn)
 {
     //Maximisation Simplex Algorithm implemented by Botao Jia, adapted to the MP Algorithm by Martin Henfling. Copyright (C) 2010 Botao Jia
     //ToDo: change to clean use of EIGEN, @present its mixed with Namespace std and <vector>
@@ -52,6 +52,7 @@
 
 #include <iostream>
 #include <vector>
+#include <limits>
 #include <math.h>
 
 
@@ -73,6 +74,9 @@
 #include <QtConcurrent>
 #include <QFuture>
 #include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QDateTime>
 #include <QStringList>
 
 
@@ -83,6 +87,114 @@
 
 using namespace UTILSLIB;
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+static const quint32 DICT_CACHE_MAGIC = 0x4D504443;     // "MPDC"
+static const qint32 DICT_CACHE_VERSION = 1;
+static const qint32 RESIDUUM_SPECTRA_REFRESH = 64;      // iterations between a full recalculation of the residuum spectra
+
+//=============================================================================================================
+
+// maps the index of the correlation maximum to the atom translation, the atoms are centered in the signal
+static qint32 atom_translation(std::ptrdiff_t max_index, qint32 signal_length)
+{
+    qint32 p = floor(signal_length / 2);
+
+    if(max_index >= p && signal_length % 2 == 0)
+        return max_index - p;
+    else if(max_index >= p && signal_length % 2 != 0)
+        return max_index - p - 1;
+
+    return max_index + p;
+}
+
+//=============================================================================================================
+
+// half spectra of the first channel_count residuum channels
+static void calc_residuum_spectra(const MatrixXd& residuum, qint32 channel_count, MatrixXcd& resid_spectra)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    resid_spectra.resize(residuum.rows() / 2 + 1, channel_count);
+
+    VectorXcd fft_signal;
+    for(qint32 chn = 0; chn < channel_count; chn++)
+    {
+        fft.fwd(fft_signal, residuum.col(chn));
+        resid_spectra.col(chn) = fft_signal;
+    }
+}
+
+//=============================================================================================================
+
+// QDataStream reads and writes raw data in chunks of at most INT_MAX bytes
+static bool write_raw(QDataStream& stream, const char* data, qint64 bytes)
+{
+    while(bytes > 0)
+    {
+        const int chunk = (int) qMin<qint64>(bytes, std::numeric_limits<int>::max());
+        if(stream.writeRawData(data, chunk) != chunk)
+            return false;
+        data += chunk;
+        bytes -= chunk;
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+// the requested size is checked against the rest of the file before anything is allocated by the caller
+static bool can_read_raw(QDataStream& stream, qint64 bytes)
+{
+    return bytes >= 0 && stream.device() && bytes <= stream.device()->bytesAvailable();
+}
+
+//=============================================================================================================
+
+static bool read_raw(QDataStream& stream, char* data, qint64 bytes)
+{
+    while(bytes > 0)
+    {
+        const int chunk = (int) qMin<qint64>(bytes, std::numeric_limits<int>::max());
+        if(stream.readRawData(data, chunk) != chunk)
+            return false;
+        data += chunk;
+        bytes -= chunk;
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+static bool write_vector(QDataStream& stream, const VectorXd& vec)
+{
+    stream << (qint32) vec.size();
+    return write_raw(stream, reinterpret_cast<const char*>(vec.data()), (qint64) vec.size() * sizeof(double));
+}
+
+//=============================================================================================================
+
+static bool read_vector(QDataStream& stream, VectorXd& vec)
+{
+    qint32 size = 0;
+    stream >> size;
+
+    const qint64 bytes = (qint64) size * sizeof(double);
+    if(stream.status() != QDataStream::Ok || !can_read_raw(stream, bytes))
+        return false;
+
+    vec.resize(size);
+    return read_raw(stream, reinterpret_cast<char*>(vec.data()), bytes);
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -112,6 +224,7 @@ FixDictMp::~FixDictMp()
 Dictionary::Dictionary()
 : type(GABORATOM)
 , sample_count(0)
+, spectra_length(0)
 {
 
 }
@@ -145,7 +258,36 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     bool sample_count_mismatch = false;
 
     this->residuum = signal;
-    parsed_dicts = parse_xml_dict(path);
+    parsed_dicts = load_dict(path, sample_count);
+
+    qint32 observed_channels = channel_count * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
+    if(boost == 0 || observed_channels == 0)
+        observed_channels = 1;
+
+    //split the dictionaries into blocks of atoms, so that all threads stay busy even for few large dictionaries
+    qint32 total_atoms = 0;
+    for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        total_atoms += parsed_dicts.at(i).atoms.length();
+
+    qint32 block_size = qMax(1, total_atoms / (4 * QThread::idealThreadCount()));
+
+    MatrixXcd resid_spectra;
+    calc_residuum_spectra(this->residuum, observed_channels, resid_spectra);
+
+    QList<find_best_matching> list_of_best;
+    for(qint32 i = 0; i < parsed_dicts.length(); i++)
+    {
+        for(qint32 first = 0; first < parsed_dicts.at(i).atoms.length(); first += block_size)
+        {
+            find_best_matching current_best_matching;
+            current_best_matching.pdict = &parsed_dicts.at(i);
+            current_best_matching.first_atom = first;
+            current_best_matching.last_atom = qMin(first + block_size, parsed_dicts.at(i).atoms.length());
+            current_best_matching.resid_spectra = &resid_spectra;
+            current_best_matching.signal_length = sample_count;
+            list_of_best.append(current_best_matching);
+        }
+    }
 
     //calculate signal_energy
     for(qint32 channel = 0; channel < channel_count; channel++)
@@ -163,16 +305,6 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     {
         FixDictAtom global_best_matching;
 
-        QList<find_best_matching> list_of_best;
-        for(qint32 i = 0; i < parsed_dicts.length(); i++)
-        {
-            find_best_matching current_best_matching;
-            current_best_matching.pdict = parsed_dicts.at(i);
-            current_best_matching.current_resid = this->residuum;
-            current_best_matching.boost = boost;
-            list_of_best.append(current_best_matching);
-        }
-
         QFuture<FixDictAtom> mapped_best_matchings = QtConcurrent::mapped(list_of_best, &find_best_matching::parallel_correlation);// parse_threads;
         mapped_best_matchings.waitForFinished();
 
@@ -223,6 +355,23 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
             }
         }
 
+        //update the residuum spectra with the spectrum of the subtracted atom instead of transforming all channels again
+        if((it + 1) % RESIDUUM_SPECTRA_REFRESH == 0)
+        {
+            calc_residuum_spectra(this->residuum, observed_channels, resid_spectra);
+        }
+        else
+        {
+            Eigen::FFT<double> fft;
+            fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+            VectorXcd fft_fitted_atom;
+            fft.fwd(fft_fitted_atom, fitted_atom);
+
+            for(qint32 chn = 0; chn < observed_channels; chn++)
+                resid_spectra.col(chn) -= global_best_matching.max_scalar_list.at(chn) * fft_fitted_atom;
+        }
+
         global_best_matching.atom_samples = fitted_atom;
 
 
@@ -287,89 +436,68 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
 // calc scalarproduct of Atom and Signal
 FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost)
 {
-    #ifdef EIGEN_FFTW_DEFAULT
-        fftw_make_planner_thread_safe();
-    #endif
-
     qint32 channel_count = current_resid.cols() * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
     if(boost == 0 || channel_count == 0)
         channel_count = 1;
 
-    Eigen::FFT<double> fft;
-    std::ptrdiff_t max_index;
-    VectorXcd fft_atom = VectorXcd::Zero(current_resid.rows());
-
-    FixDictAtom best_matching;
-    qreal max_scalar_product = 0;
+    if(current_pdict.spectra_length != current_resid.rows())
+        current_pdict.calc_atom_spectra(current_resid.rows());
 
-    for(qint32 i = 0; i < current_pdict.atoms.length(); i++)
-    {
-        VectorXd fitted_atom = VectorXd::Zero(current_resid.rows());
-        qint32 p = floor(current_resid.rows() / 2);//translation
+    MatrixXcd resid_spectra;
+    calc_residuum_spectra(current_resid, channel_count, resid_spectra);
 
-        VectorXd resized_atom = VectorXd::Zero(current_resid.rows());
+    return correlation(current_pdict, 0, current_pdict.atoms.length(), resid_spectra, current_resid.rows());
+}
 
-        if(current_pdict.atoms.at(i).atom_samples.rows() > current_resid.rows())
-            for(qint32 k = 0; k < current_resid.rows(); k++)
-                resized_atom[k] = current_pdict.atoms.at(i).atom_samples[k + floor(current_pdict.atoms.at(i).atom_samples.rows() / 2) - floor(current_resid.rows() / 2)];
-        else resized_atom = current_pdict.atoms.at(i).atom_samples;
 
-        if(resized_atom.rows() < current_resid.rows())
-            for(qint32 k = 0; k < resized_atom.rows(); k++)
-                fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
-        else fitted_atom = resized_atom;
+//*************************************************************************************************************
 
-        //normalization
-        qreal norm = 0;
-        norm = fitted_atom.norm();
-        if(norm != 0) fitted_atom /= norm;
+FixDictAtom FixDictMp::correlation(const Dictionary& current_pdict, qint32 first_atom, qint32 last_atom, const MatrixXcd& resid_spectra, qint32 signal_length)
+{
+    #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+    #endif
 
-        fft.fwd(fft_atom, fitted_atom);
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
 
-        for(qint32 chn = 0; chn < channel_count; chn++)
-        {
-            p = floor(current_resid.rows() / 2);//translation
-            VectorXd corr_coeffs = VectorXd::Zero(current_resid.rows());
-            VectorXcd fft_signal = VectorXcd::Zero(current_resid.rows());
-            VectorXcd fft_sig_atom = VectorXcd::Zero(current_resid.rows());
+    std::ptrdiff_t max_index;
+    VectorXd corr_coeffs(signal_length);
+    MatrixXcd fft_sig_atom(resid_spectra.rows(), resid_spectra.cols());
 
-            fft.fwd(fft_signal, current_resid.col(chn));
+    qint32 best_atom = -1;
+    qreal best_scalar_product = 0;
+    qint32 best_translation = 0;
 
-            for( qint32 m = 0; m < current_resid.rows(); m++)
-                fft_sig_atom[m] = fft_signal[m] * conj(fft_atom[m]);
+    for(qint32 i = first_atom; i < last_atom; i++)
+    {
+        //cross spectra of all observed channels with the current atom
+        fft_sig_atom = (resid_spectra.array().colwise() * current_pdict.atom_spectra.col(i).conjugate().array()).matrix();
 
-            fft.inv(corr_coeffs, fft_sig_atom);
+        for(qint32 chn = 0; chn < fft_sig_atom.cols(); chn++)
+        {
+            fft.inv(corr_coeffs, fft_sig_atom.col(chn), signal_length);
 
             //find index of maximum correlation-coefficient to use in translation
-            max_scalar_product = corr_coeffs.maxCoeff(&max_index);
-
-            if(i == 0)
-            {
-                best_matching = current_pdict.atoms.at(i);
-                best_matching.max_scalar_product = max_scalar_product;
-
-                //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
-                else p = max_index + p;
+            qreal max_scalar_product = corr_coeffs.maxCoeff(&max_index);
 
-                best_matching.translation = p;
-            }
-
-            else if(std::fabs(max_scalar_product) > std::fabs(best_matching.max_scalar_product))
+            if(best_atom < 0 || std::fabs(max_scalar_product) > std::fabs(best_scalar_product))
             {
-                best_matching = current_pdict.atoms.at(i);
-                best_matching.max_scalar_product = max_scalar_product;
-
-                //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
-                else p = max_index + p;
-
-                best_matching.translation = p;
+                best_atom = i;
+                best_scalar_product = max_scalar_product;
+                best_translation = atom_translation(max_index, signal_length);
             }
         }
     }
+
+    FixDictAtom best_matching;
+    if(best_atom >= 0)
+    {
+        best_matching = current_pdict.atoms.at(best_atom);
+        best_matching.max_scalar_product = best_scalar_product;
+        best_matching.translation = best_translation;
+    }
+
     best_matching.atom_formula = current_pdict.atom_formula;
     best_matching.dict_source = current_pdict.source;
     best_matching.type = current_pdict.type;
@@ -429,6 +557,189 @@ QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
 }
 
 
+//*************************************************************************************************************
+
+QList<Dictionary> FixDictMp::load_dict(QString path, qint32 signal_length)
+{
+    QList<Dictionary> parsed_dicts;
+    bool update_cache = false;
+
+    if(!read_dict_cache(path, parsed_dicts))
+    {
+        parsed_dicts = parse_xml_dict(path);
+        update_cache = true;
+    }
+    else
+    {
+        for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        {
+            if(parsed_dicts.at(i).sample_count != signal_length)
+            {
+                emit send_warning(2);
+                break;
+            }
+        }
+    }
+
+    //atom spectra only need to be recalculated if the signal length changed
+    QList<Dictionary*> outdated_dicts;
+    for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        if(parsed_dicts[i].spectra_length != signal_length)
+            outdated_dicts.append(&parsed_dicts[i]);
+
+    if(!outdated_dicts.isEmpty())
+    {
+        std::cout << "calculating atom spectra...";
+
+        //the FFT plans of the dictionaries are created concurrently
+        #ifdef EIGEN_FFTW_DEFAULT
+            fftw_make_planner_thread_safe();
+        #endif
+
+        QtConcurrent::blockingMap(outdated_dicts, [signal_length](Dictionary* pdict) {
+            pdict->calc_atom_spectra(signal_length);
+        });
+        std::cout << "   done.\n\n";
+        update_cache = true;
+    }
+
+    if(update_cache && !write_dict_cache(path, parsed_dicts))
+        std::cout << "could not write dictionary cache " << qPrintable(path + ".cache") << "\n";
+
+    return parsed_dicts;
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::read_dict_cache(const QString& path, QList<Dictionary>& dicts)
+{
+    QFileInfo xml_info(path);
+    QFile cache_file(path + ".cache");
+
+    if(!xml_info.exists() || !cache_file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&cache_file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    //the magic is stored raw, a cache of a machine with different byte order is rejected here
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint64 xml_size = 0;
+    QDateTime xml_modified;
+
+    stream.readRawData(reinterpret_cast<char*>(&magic), sizeof(magic));
+    stream >> version >> xml_size >> xml_modified;
+
+    if(magic != DICT_CACHE_MAGIC || version != DICT_CACHE_VERSION
+            || xml_size != xml_info.size() || xml_modified != xml_info.lastModified())
+        return false;
+
+    qint32 dict_count = 0;
+    stream >> dict_count;
+
+    QList<Dictionary> cached_dicts;
+    for(qint32 i = 0; i < dict_count && stream.status() == QDataStream::Ok; i++)
+    {
+        Dictionary current_dict;
+        qint32 type = 0;
+        qint32 atom_count = 0;
+
+        stream >> current_dict.source >> current_dict.atom_formula >> type >> current_dict.sample_count >> atom_count;
+        current_dict.type = (AtomType) type;
+
+        for(qint32 j = 0; j < atom_count && stream.status() == QDataStream::Ok; j++)
+        {
+            FixDictAtom current_atom;
+            stream >> current_atom.id
+                   >> current_atom.gabor_atom.scale >> current_atom.gabor_atom.modulation >> current_atom.gabor_atom.phase
+                   >> current_atom.chirp_atom.scale >> current_atom.chirp_atom.modulation >> current_atom.chirp_atom.phase >> current_atom.chirp_atom.chirp
+                   >> current_atom.formula_atom.a >> current_atom.formula_atom.b >> current_atom.formula_atom.c >> current_atom.formula_atom.d
+                   >> current_atom.formula_atom.e >> current_atom.formula_atom.f >> current_atom.formula_atom.g >> current_atom.formula_atom.h;
+
+            if(!read_vector(stream, current_atom.atom_samples))
+                return false;
+
+            current_dict.atoms.append(current_atom);
+        }
+
+        qint32 spectra_rows = 0;
+        qint32 spectra_cols = 0;
+        stream >> current_dict.spectra_length >> spectra_rows >> spectra_cols;
+
+        if(spectra_rows < 0 || spectra_cols != (current_dict.spectra_length > 0 ? current_dict.atoms.length() : 0))
+            return false;
+
+        const qint64 col_bytes = (qint64) spectra_cols * sizeof(std::complex<double>);
+        if(stream.status() != QDataStream::Ok || (col_bytes > 0 && spectra_rows > cache_file.bytesAvailable() / col_bytes))
+            return false;
+
+        const qint64 bytes = (qint64) spectra_rows * col_bytes;
+        if(!can_read_raw(stream, bytes))
+            return false;
+
+        current_dict.atom_spectra.resize(spectra_rows, spectra_cols);
+        if(!read_raw(stream, reinterpret_cast<char*>(current_dict.atom_spectra.data()), bytes))
+            return false;
+
+        cached_dicts.append(current_dict);
+    }
+
+    if(stream.status() != QDataStream::Ok)
+        return false;
+
+    dicts = cached_dicts;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::write_dict_cache(const QString& path, const QList<Dictionary>& dicts)
+{
+    QFileInfo xml_info(path);
+    QFile cache_file(path + ".cache");
+
+    if(!xml_info.exists() || !cache_file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&cache_file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream.writeRawData(reinterpret_cast<const char*>(&DICT_CACHE_MAGIC), sizeof(DICT_CACHE_MAGIC));
+    stream << DICT_CACHE_VERSION << (qint64) xml_info.size() << xml_info.lastModified();
+    stream << (qint32) dicts.length();
+
+    for(qint32 i = 0; i < dicts.length(); i++)
+    {
+        const Dictionary& current_dict = dicts.at(i);
+
+        stream << current_dict.source << current_dict.atom_formula << (qint32) current_dict.type << current_dict.sample_count << (qint32) current_dict.atoms.length();
+
+        for(qint32 j = 0; j < current_dict.atoms.length(); j++)
+        {
+            const FixDictAtom& current_atom = current_dict.atoms.at(j);
+            stream << current_atom.id
+                   << current_atom.gabor_atom.scale << current_atom.gabor_atom.modulation << current_atom.gabor_atom.phase
+                   << current_atom.chirp_atom.scale << current_atom.chirp_atom.modulation << current_atom.chirp_atom.phase << current_atom.chirp_atom.chirp
+                   << current_atom.formula_atom.a << current_atom.formula_atom.b << current_atom.formula_atom.c << current_atom.formula_atom.d
+                   << current_atom.formula_atom.e << current_atom.formula_atom.f << current_atom.formula_atom.g << current_atom.formula_atom.h;
+
+            if(!write_vector(stream, current_atom.atom_samples))
+                return false;
+        }
+
+        stream << current_dict.spectra_length << (qint32) current_dict.atom_spectra.rows() << (qint32) current_dict.atom_spectra.cols();
+        if(!write_raw(stream, reinterpret_cast<const char*>(current_dict.atom_spectra.data()), (qint64) current_dict.atom_spectra.size() * sizeof(std::complex<double>)))
+            return false;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+
 //*************************************************************************************************************
 
 Dictionary FixDictMp::fill_dict(const QDomNode &pdict)
@@ -592,9 +903,58 @@ qint32 Dictionary::atom_count()
      this->atom_formula = "";
      this->sample_count = 0;
      this->source = "";
+     this->atom_spectra.resize(0, 0);
+     this->spectra_length = 0;
  }
 
 
+ //*************************************************************************************************************
+
+void Dictionary::calc_atom_spectra(qint32 signal_length)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    atom_spectra.resize(signal_length / 2 + 1, atoms.length());
+
+    VectorXcd fft_atom;
+    for(qint32 i = 0; i < atoms.length(); i++)
+    {
+        fft.fwd(fft_atom, fit_atom(atoms.at(i).atom_samples, signal_length));
+        atom_spectra.col(i) = fft_atom;
+    }
+
+    spectra_length = signal_length;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd Dictionary::fit_atom(const VectorXd& atom_samples, qint32 signal_length)
+{
+    VectorXd fitted_atom = VectorXd::Zero(signal_length);
+    qint32 p = floor(signal_length / 2);//translation
+
+    VectorXd resized_atom = VectorXd::Zero(signal_length);
+
+    if(atom_samples.rows() > signal_length)
+        for(qint32 k = 0; k < signal_length; k++)
+            resized_atom[k] = atom_samples[k + floor(atom_samples.rows() / 2) - floor(signal_length / 2)];
+    else resized_atom = atom_samples;
+
+    if(resized_atom.rows() < signal_length)
+        for(qint32 k = 0; k < resized_atom.rows(); k++)
+            fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
+    else fitted_atom = resized_atom;
+
+    //normalization
+    qreal norm = fitted_atom.norm();
+    if(norm != 0) fitted_atom /= norm;
+
+    return fitted_atom;
+}
+
+
  //*************************************************************************************************************
 
 /*
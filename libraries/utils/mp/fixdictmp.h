@@ -120,11 +120,33 @@ public:
     QString source;
     QString atom_formula;
     qint32 sample_count;
+    MatrixXcd atom_spectra;     /**< Half spectra of the normalized, signal fitted atoms, one column per atom. */
+    qint32 spectra_length;      /**< Signal length the atom spectra were calculated for, 0 if not calculated. */
 
     qint32 atom_count();
 
     void clear();
 
+    //=========================================================================================================
+    /**
+    * Calculates the half spectra of all atoms, fitted (cropped or zero padded and centered) to the signal length
+    * and normalized, so that the correlation with a residuum reduces to a product in the frequency domain.
+    *
+    * @param[in] signal_length  Number of samples of the signal the dictionary is matched against.
+    */
+    void calc_atom_spectra(qint32 signal_length);
+
+    //=========================================================================================================
+    /**
+    * Fits the atom samples to the signal length by cropping or centered zero padding and normalizes the result.
+    *
+    * @param[in] atom_samples   The samples of the atom.
+    * @param[in] signal_length  Number of samples of the signal.
+    *
+    * @return the fitted and normalized atom.
+    */
+    static VectorXd fit_atom(const VectorXd& atom_samples, qint32 signal_length);
+
 };//class
 
 
@@ -182,6 +204,22 @@ public:
 
     FixDictAtom correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost);
 
+    //=========================================================================================================
+    /**
+    * Finds the best matching atom in the atom range [first_atom, last_atom) of a dictionary. The cross correlation
+    * of every atom with all observed channels is evaluated as a product of the precalculated atom spectra with the
+    * residuum spectra, followed by one inverse FFT per channel.
+    *
+    * @param[in] current_pdict  Dictionary with calculated atom spectra (see Dictionary::calc_atom_spectra).
+    * @param[in] first_atom     First atom of the range.
+    * @param[in] last_atom      One past the last atom of the range.
+    * @param[in] resid_spectra  Half spectra of the observed residuum channels, one column per channel.
+    * @param[in] signal_length  Number of samples of the residuum.
+    *
+    * @return the best matching atom of the range.
+    */
+    static FixDictAtom correlation(const Dictionary& current_pdict, qint32 first_atom, qint32 last_atom, const MatrixXcd& resid_spectra, qint32 signal_length);
+
     //=========================================================================================================
 
     //static void create_tree_dict(QString save_path);
@@ -194,21 +232,55 @@ public:
 
     struct find_best_matching
     {
-        Dictionary pdict;
-        MatrixXd current_resid;
-        qint32 boost;
+        const Dictionary* pdict;
+        qint32 first_atom;
+        qint32 last_atom;
+        const MatrixXcd* resid_spectra;
+        qint32 signal_length;
 
         FixDictAtom parallel_correlation() const
         {
-            FixDictAtom best_matching;
-            FixDictMp fix_dict_mp;
-            best_matching = fix_dict_mp.correlation(this->pdict, this->current_resid, this->boost);
-            return best_matching;
+            return FixDictMp::correlation(*this->pdict, this->first_atom, this->last_atom, *this->resid_spectra, this->signal_length);
         }
     };
 
     QList<Dictionary> parse_xml_dict(QString path);
 
+    //=========================================================================================================
+    /**
+    * Loads the dictionaries of an xml dictionary file together with their atom spectra for the given signal length.
+    * The parsed atoms and spectra are kept in a binary cache next to the xml file (<path>.cache), which is used as
+    * long as the xml file is unchanged. Spectra of a different signal length are recalculated and the cache updated.
+    *
+    * @param[in] path           Path to the xml dictionary.
+    * @param[in] signal_length  Number of samples of the signal the dictionaries are matched against.
+    *
+    * @return the dictionaries with calculated atom spectra.
+    */
+    QList<Dictionary> load_dict(QString path, qint32 signal_length);
+
+    //=========================================================================================================
+    /**
+    * Reads the binary dictionary cache of an xml dictionary file.
+    *
+    * @param[in] path       Path to the xml dictionary.
+    * @param[out] dicts     The cached dictionaries.
+    *
+    * @return true if a valid and up to date cache was read, false otherwise.
+    */
+    static bool read_dict_cache(const QString& path, QList<Dictionary>& dicts);
+
+    //=========================================================================================================
+    /**
+    * Writes the binary dictionary cache of an xml dictionary file.
+    *
+    * @param[in] path   Path to the xml dictionary.
+    * @param[in] dicts  The dictionaries to cache, including their atom spectra.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    static bool write_dict_cache(const QString& path, const QList<Dictionary>& dicts);
+
     //=========================================================================================================
 
     Dictionary fill_dict(const QDomNode &pdict);
@@ -0,0 +1,328 @@
+//=============================================================================================================
+/**
+* @file     sensorfeaturepipeline.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the SensorFeaturePipeline class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "sensorfeaturepipeline.h"
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SensorFeaturePipeline::SensorFeaturePipeline()
+: m_iDecimation(1)
+, m_iPhase(0)
+, m_iWindowLength(0)
+, m_iRingPos(0)
+, m_iFilled(0)
+, m_featureType(Variance)
+, m_bSubtractMean(true)
+, m_iFeatureCount(0)
+, m_dBias(0.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setChannelPicks(const QVector<int>& vecPicks)
+{
+    m_vecPicks = vecPicks;
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setDecimation(int iStep)
+{
+    iStep = iStep < 1 ? 1 : iStep;
+
+    if(iStep != m_iDecimation) {
+        m_iDecimation = iStep;
+        m_iPhase = 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setFilter(const RowVectorXd& vecCoeffs)
+{
+    m_vecCoeffs = vecCoeffs;
+    m_matHistory = MatrixXd::Zero(channels(), m_vecCoeffs.size() > 0 ? m_vecCoeffs.size() - 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setWindowLength(int iSamples)
+{
+    m_iWindowLength = iSamples < 0 ? 0 : iSamples;
+    m_matRawRing = MatrixXd::Zero(channels(), 2 * m_iWindowLength);
+    m_matFilteredRing = MatrixXd::Zero(channels(), 2 * m_iWindowLength);
+    m_iRingPos = 0;
+    m_iFilled = 0;
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setFeatureType(FeatureType type)
+{
+    m_featureType = type;
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setSubtractMean(bool bSubtractMean)
+{
+    m_bSubtractMean = bSubtractMean;
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setClassifier(double dBias, const VectorXd& vecWeights)
+{
+    m_dBias = dBias;
+    m_vecWeights = vecWeights;
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::setFeatureCapacity(int iCount)
+{
+    m_matFeatures.resize(channels(), iCount < 1 ? 1 : iCount);
+    m_iFeatureCount = 0;
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::reset()
+{
+    m_iPhase = 0;
+    setFilter(m_vecCoeffs);
+    setWindowLength(m_iWindowLength);
+    setFeatureCapacity(m_matFeatures.cols());
+}
+
+
+//*************************************************************************************************************
+
+const MatrixXd& SensorFeaturePipeline::acquire(const MatrixXd& matBlock)
+{
+    const int iChannels = channels();
+    const int iSamples = m_iPhase < matBlock.cols() ? (matBlock.cols() - m_iPhase + m_iDecimation - 1) / m_iDecimation : 0;
+
+    // Gather the picked rows into a contiguous buffer, keeping every m_iDecimation-th sample
+    m_matPicked.resize(iChannels, iSamples);
+    if(m_iDecimation == 1 && m_iPhase == 0) {
+        for(int i = 0; i < iChannels; ++i) {
+            m_matPicked.row(i) = matBlock.row(m_vecPicks[i]);
+        }
+    } else {
+        for(int j = 0, iCol = m_iPhase; j < iSamples; ++j, iCol += m_iDecimation) {
+            for(int i = 0; i < iChannels; ++i) {
+                m_matPicked(i, j) = matBlock(m_vecPicks[i], iCol);
+            }
+        }
+    }
+    m_iPhase += iSamples * m_iDecimation - matBlock.cols();
+
+    if(m_vecCoeffs.size() == 0) {
+        return m_matPicked;
+    }
+
+    // Direct form FIR over all channels at once: y[n] = sum_t c[t] x[n-t], where the history supplies x[n-t] for n < t
+    const int iTaps = m_vecCoeffs.size();
+    const int iHistory = iTaps - 1;
+
+    m_matExtended.resize(iChannels, iHistory + iSamples);
+    m_matExtended.leftCols(iHistory) = m_matHistory;
+    m_matExtended.rightCols(iSamples) = m_matPicked;
+
+    m_matFiltered.noalias() = m_vecCoeffs(0) * m_matPicked;
+    for(int t = 1; t < iTaps; ++t) {
+        m_matFiltered.noalias() += m_vecCoeffs(t) * m_matExtended.middleCols(iHistory - t, iSamples);
+    }
+
+    m_matHistory = m_matExtended.rightCols(iHistory);
+
+    return m_matFiltered;
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::push(const MatrixXd& matBlock)
+{
+    const MatrixXd& matFiltered = acquire(matBlock);
+
+    if(m_iWindowLength == 0 || m_matPicked.cols() == 0) {
+        return;
+    }
+
+    writeRing(m_matRawRing, m_matPicked);
+    writeRing(m_matFilteredRing, matFiltered);
+
+    const int iWritten = m_matPicked.cols() < m_iWindowLength ? m_matPicked.cols() : m_iWindowLength;
+    m_iRingPos = (m_iRingPos + iWritten) % m_iWindowLength;
+    m_iFilled = m_iFilled + iWritten < m_iWindowLength ? m_iFilled + iWritten : m_iWindowLength;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd::ConstColsBlockXpr SensorFeaturePipeline::rawWindow() const
+{
+    return m_matRawRing.middleCols(m_iRingPos, m_iWindowLength);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd::ConstColsBlockXpr SensorFeaturePipeline::filteredWindow() const
+{
+    return m_matFilteredRing.middleCols(m_iRingPos, m_iWindowLength);
+}
+
+
+//*************************************************************************************************************
+
+double SensorFeaturePipeline::peakAmplitude() const
+{
+    if(m_iWindowLength == 0 || channels() == 0) {
+        return 0.0;
+    }
+
+    MatrixXd::ConstColsBlockXpr matWindow = rawWindow();
+
+    if(m_bSubtractMean) {
+        return (matWindow.colwise() - matWindow.rowwise().mean()).cwiseAbs().maxCoeff();
+    }
+
+    return matWindow.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd::ConstColXpr SensorFeaturePipeline::computeFeatures()
+{
+    if(m_iFeatureCount == m_matFeatures.cols()) {
+        m_matFeatures.conservativeResize(channels(), m_matFeatures.cols() > 0 ? 2 * m_matFeatures.cols() : 1);
+    }
+
+    MatrixXd::ColXpr vecFeatures = m_matFeatures.col(m_iFeatureCount);
+    MatrixXd::ConstColsBlockXpr matWindow = filteredWindow();
+
+    // Energy of all channels in one pass over the window
+    if(m_bSubtractMean) {
+        vecFeatures = (matWindow.colwise() - matWindow.rowwise().mean()).rowwise().squaredNorm();
+    } else {
+        vecFeatures = matWindow.rowwise().squaredNorm();
+    }
+
+    if(m_featureType == LogVariance) {
+        vecFeatures = vecFeatures.array().log10().abs();
+    }
+
+    const MatrixXd& matFeatures = m_matFeatures;
+    return matFeatures.col(m_iFeatureCount++);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd::ConstColsBlockXpr SensorFeaturePipeline::features() const
+{
+    return m_matFeatures.leftCols(m_iFeatureCount);
+}
+
+
+//*************************************************************************************************************
+
+double SensorFeaturePipeline::classify()
+{
+    if(m_iFeatureCount == 0 || m_vecWeights.size() != channels()) {
+        m_vecScores.resize(0);
+        return 0.0;
+    }
+
+    m_vecScores.noalias() = features().transpose() * m_vecWeights;
+    m_vecScores.array() += m_dBias;
+
+    return m_vecScores.mean();
+}
+
+
+//*************************************************************************************************************
+
+void SensorFeaturePipeline::writeRing(MatrixXd& matRing, const MatrixXd& matSamples) const
+{
+    // Every sample is stored at pos and pos + window length, so the latest window is always one contiguous block
+    const int iCount = matSamples.cols() < m_iWindowLength ? matSamples.cols() : m_iWindowLength;
+    const int iFirst = matSamples.cols() - iCount;
+    const int iHead = m_iWindowLength - m_iRingPos < iCount ? m_iWindowLength - m_iRingPos : iCount;
+
+    matRing.middleCols(m_iRingPos, iHead) = matSamples.middleCols(iFirst, iHead);
+    matRing.middleCols(m_iRingPos + m_iWindowLength, iHead) = matSamples.middleCols(iFirst, iHead);
+
+    if(iCount > iHead) {
+        matRing.leftCols(iCount - iHead) = matSamples.middleCols(iFirst + iHead, iCount - iHead);
+        matRing.middleCols(m_iWindowLength, iCount - iHead) = matSamples.middleCols(iFirst + iHead, iCount - iHead);
+    }
+}
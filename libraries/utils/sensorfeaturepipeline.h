@@ -0,0 +1,349 @@
+//=============================================================================================================
+/**
+* @file     sensorfeaturepipeline.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the SensorFeaturePipeline class.
+*
+*/
+
+
+#ifndef SENSORFEATUREPIPELINE_H
+#define SENSORFEATUREPIPELINE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Fused sensor level processing for the BCI plugins. Incoming blocks (all channels x samples) are reduced to
+* the picked channels, optionally decimated and passed through a stateful multichannel FIR filter, so every
+* sample is filtered exactly once no matter how much the analysis windows overlap. The raw and the filtered
+* sliding windows are kept in mirrored ring buffers, which makes the current window a contiguous block that
+* can be handed out without copying. Band power features of all channels are computed in one vectorised pass
+* and collected column by column in a contiguous feature buffer, which a linear classifier turns into scores
+* with a single matrix-vector product.
+*
+* The pipeline is not thread safe; it is meant to be owned and driven by one processing thread.
+*
+* @brief Stateful filter, band power features and linear classification on multichannel sensor data.
+*/
+class UTILSSHARED_EXPORT SensorFeaturePipeline
+{
+public:
+    typedef QSharedPointer<SensorFeaturePipeline> SPtr;              /**< Shared pointer type for SensorFeaturePipeline. */
+    typedef QSharedPointer<const SensorFeaturePipeline> ConstSPtr;   /**< Const shared pointer type for SensorFeaturePipeline. */
+
+    enum FeatureType {
+        Variance = 0,       /**< Energy (sum of squares) of the filtered window. */
+        LogVariance = 1     /**< Absolute value of the decadic logarithm of the energy. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty pipeline without channels, filter or classifier.
+    */
+    SensorFeaturePipeline();
+
+    //=========================================================================================================
+    /**
+    * Sets the rows of the incoming blocks which are processed. Resets the pipeline.
+    *
+    * @param[in] vecPicks   Row indices into the incoming blocks.
+    */
+    void setChannelPicks(const QVector<int>& vecPicks);
+
+    //=========================================================================================================
+    /**
+    * Keeps only every iStep-th incoming sample. The decimation phase is carried over from block to block.
+    * Does nothing if the step did not change.
+    *
+    * @param[in] iStep      Decimation step, 1 keeps all samples.
+    */
+    void setDecimation(int iStep);
+
+    //=========================================================================================================
+    /**
+    * Sets the FIR filter applied to the picked channels and clears the filter state.
+    *
+    * @param[in] vecCoeffs  The filter taps. An empty vector switches filtering off.
+    */
+    void setFilter(const Eigen::RowVectorXd& vecCoeffs);
+
+    //=========================================================================================================
+    /**
+    * Sets the length of the sliding window and empties it.
+    *
+    * @param[in] iSamples   Window length in (decimated) samples.
+    */
+    void setWindowLength(int iSamples);
+
+    //=========================================================================================================
+    /**
+    * Sets how features are computed from the filtered window.
+    *
+    * @param[in] type       The feature type.
+    */
+    void setFeatureType(FeatureType type);
+
+    //=========================================================================================================
+    /**
+    * Sets whether the window mean is removed before features and peak amplitudes are computed.
+    *
+    * @param[in] bSubtractMean  Whether to remove the mean.
+    */
+    void setSubtractMean(bool bSubtractMean);
+
+    //=========================================================================================================
+    /**
+    * Sets the linear decision function f(x) = dBias + vecWeights^T x.
+    *
+    * @param[in] dBias          The offset of the decision function.
+    * @param[in] vecWeights     One weight per picked channel.
+    */
+    void setClassifier(double dBias, const Eigen::VectorXd& vecWeights);
+
+    //=========================================================================================================
+    /**
+    * Reserves room for the given number of feature vectors.
+    *
+    * @param[in] iCount     Number of feature vectors collected before they are classified.
+    */
+    void setFeatureCapacity(int iCount);
+
+    //=========================================================================================================
+    /**
+    * Clears the filter state, the sliding windows, the decimation phase and the collected features.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Picks, decimates and filters a block without touching the sliding windows.
+    *
+    * @param[in] matBlock   All channels x samples of the incoming block.
+    *
+    * @return The processed samples (picked channels x kept samples). The reference stays valid until the next call.
+    */
+    const Eigen::MatrixXd& acquire(const Eigen::MatrixXd& matBlock);
+
+    //=========================================================================================================
+    /**
+    * Runs acquire() on the block and appends the picked raw and the filtered samples to the sliding windows.
+    *
+    * @param[in] matBlock   All channels x samples of the incoming block.
+    */
+    void push(const Eigen::MatrixXd& matBlock);
+
+    //=========================================================================================================
+    /**
+    * Returns the unfiltered sliding window, oldest sample first, as a view into the ring buffer.
+    *
+    * @return Picked channels x window length.
+    */
+    Eigen::MatrixXd::ConstColsBlockXpr rawWindow() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the filtered sliding window, oldest sample first, as a view into the ring buffer.
+    *
+    * @return Picked channels x window length.
+    */
+    Eigen::MatrixXd::ConstColsBlockXpr filteredWindow() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the largest absolute amplitude in the unfiltered window, after mean removal if enabled.
+    *
+    * @return The peak amplitude.
+    */
+    double peakAmplitude() const;
+
+    //=========================================================================================================
+    /**
+    * Computes one feature per channel from the filtered window and appends it to the feature buffer.
+    *
+    * @return The features of the current window.
+    */
+    Eigen::MatrixXd::ConstColXpr computeFeatures();
+
+    //=========================================================================================================
+    /**
+    * Returns the collected feature vectors, one column per window.
+    *
+    * @return Picked channels x featureCount().
+    */
+    Eigen::MatrixXd::ConstColsBlockXpr features() const;
+
+    //=========================================================================================================
+    /**
+    * Scores all collected feature vectors with the linear decision function.
+    *
+    * @return The mean score, 0 if no classifier matching the channel count is set or no features were collected.
+    */
+    double classify();
+
+    //=========================================================================================================
+    /**
+    * Returns the scores of the last classify() call, one per collected feature vector.
+    *
+    * @return The scores.
+    */
+    inline const Eigen::VectorXd& scores() const;
+
+    //=========================================================================================================
+    /**
+    * Drops all collected feature vectors.
+    */
+    inline void clearFeatures();
+
+    inline int channels() const;
+    inline int windowLength() const;
+    inline int featureCount() const;
+    inline bool isWindowFull() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Writes samples into a mirrored ring buffer of twice the window length.
+    *
+    * @param[in, out] matRing   The ring buffer.
+    * @param[in] matSamples     The samples to append.
+    */
+    void writeRing(Eigen::MatrixXd& matRing, const Eigen::MatrixXd& matSamples) const;
+
+    QVector<int>        m_vecPicks;         /**< Picked rows of the incoming blocks. */
+    int                 m_iDecimation;      /**< Decimation step. */
+    int                 m_iPhase;           /**< Position of the next kept sample relative to the next block. */
+
+    Eigen::RowVectorXd  m_vecCoeffs;        /**< FIR taps, empty if filtering is off. */
+    Eigen::MatrixXd     m_matHistory;       /**< Last taps-1 input samples of every channel. */
+    Eigen::MatrixXd     m_matExtended;      /**< Filter history followed by the current block. */
+    Eigen::MatrixXd     m_matPicked;        /**< Picked and decimated samples of the current block. */
+    Eigen::MatrixXd     m_matFiltered;      /**< Filtered samples of the current block. */
+
+    int                 m_iWindowLength;    /**< Sliding window length. */
+    int                 m_iRingPos;         /**< Next write position in the ring buffers. */
+    int                 m_iFilled;          /**< Number of valid samples in the window. */
+    Eigen::MatrixXd     m_matRawRing;       /**< Mirrored ring buffer of the raw window. */
+    Eigen::MatrixXd     m_matFilteredRing;  /**< Mirrored ring buffer of the filtered window. */
+
+    FeatureType         m_featureType;      /**< How features are computed. */
+    bool                m_bSubtractMean;    /**< Whether the window mean is removed. */
+    Eigen::MatrixXd     m_matFeatures;      /**< Collected features, one column per window. */
+    int                 m_iFeatureCount;    /**< Number of collected feature vectors. */
+
+    double              m_dBias;            /**< Offset of the decision function. */
+    Eigen::VectorXd     m_vecWeights;       /**< Weights of the decision function. */
+    Eigen::VectorXd     m_vecScores;        /**< Scores of the last classification. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::VectorXd& SensorFeaturePipeline::scores() const
+{
+    return m_vecScores;
+}
+
+
+//*************************************************************************************************************
+
+inline void SensorFeaturePipeline::clearFeatures()
+{
+    m_iFeatureCount = 0;
+}
+
+
+//*************************************************************************************************************
+
+inline int SensorFeaturePipeline::channels() const
+{
+    return m_vecPicks.size();
+}
+
+
+//*************************************************************************************************************
+
+inline int SensorFeaturePipeline::windowLength() const
+{
+    return m_iWindowLength;
+}
+
+
+//*************************************************************************************************************
+
+inline int SensorFeaturePipeline::featureCount() const
+{
+    return m_iFeatureCount;
+}
+
+
+//*************************************************************************************************************
+
+inline bool SensorFeaturePipeline::isWindowFull() const
+{
+    return m_iWindowLength > 0 && m_iFilled >= m_iWindowLength;
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // SENSORFEATUREPIPELINE_H
@@ -61,7 +61,8 @@ else {
 }
 
 SOURCES += \
-    kmeans.cpp \
+    kmeans.cpp \
+    fastkmeans.cpp \
     mnemath.cpp \
     ioutils.cpp \
     layoutloader.cpp \
@@ -83,10 +84,12 @@ SOURCES += \
     generics/circularbuffer.cpp \
     generics/circularmatrixbuffer.cpp \
     generics/observerpattern.cpp \
-    spectral.cpp
+    spectral.cpp \
+    sensorfeaturepipeline.cpp
 
 HEADERS += \
-    kmeans.h\
+    kmeans.h\
+    fastkmeans.h \
     utils_global.h \
     mnemath.h \
     ioutils.h \
@@ -115,7 +118,8 @@ HEADERS += \
     generics/commandpattern.h \
     generics/observerpattern.h \
     generics/typename_old.h \
-    spectral.h
+    spectral.h \
+    sensorfeaturepipeline.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
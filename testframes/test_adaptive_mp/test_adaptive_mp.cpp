@@ -0,0 +1,276 @@
+//=============================================================================================================
+/**
+* @file     test_adaptive_mp.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the atom search of the adaptive matching pursuit
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/mp/adaptivemp.h>
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+/**
+* Parameters of one atom of the decomposition.
+*/
+struct AtomReference
+{
+    int iteration;
+    int atom;
+    double scale;
+    int translation;
+    double modulation;
+    double phase;
+    double scalar_product;
+    int channel;
+};
+
+//*************************************************************************************************************
+
+// Atoms selected by the sequential scale search for the signal of TestAdaptiveMp::initTestCase, three iterations
+// with boost 100 and without simplex maximisation
+
+const AtomReference ATOMS_DEFAULT[] = {
+    {0, 0, 96.0, 48, 28.5, 1.42478745302, 4.7822360011, 1},
+    {1, 0, 32.0, 55, 13.5, 0.267098835705, 3.16193960116, 2},
+    {2, 0, 64.0, 61, 9.75, 0.580819722791, 2.38098047478, 2}
+};
+
+const AtomReference ATOMS_FIX_PHASE[] = {
+    {0, 0, 96.0, 48, 28.5, 1.42893489333, 4.78219487091, 1},
+    {1, 0, 32.0, 55, 13.5, 0.407588272405, 3.13078316242, 2},
+    {2, 0, 64.0, 61, 9.75, 6.39974193184, 2.13373965608, 2}
+};
+
+const AtomReference ATOMS_TRIAL_SEPARATION[] = {
+    {0, 0, 96.0, 48, 28.5, 1.44897353707, 1.79161426393, 0},
+    {0, 1, 96.0, 48, 28.5, 1.42478745302, 4.7822360011, 1},
+    {0, 2, 32.0, 55, 13.5, 0.267063049597, 3.16208131231, 2},
+    {1, 0, 16.0, 44, 9.0, 0.643037151584, 1.63265225199, 0},
+    {1, 1, 32.0, 53, 13.5, 0.541476630305, 2.14977684435, 1},
+    {1, 2, 64.0, 61, 9.75, 0.578686786116, 2.37487449237, 2},
+    {2, 0, 4.0, 33, 12.0, 7.63439204153, -0.936862757525, 0},
+    {2, 1, 64.0, 65, 11.25, 1.02243548077, 1.81422097526, 1},
+    {2, 2, 96.0, 48, 11.25, 1.75028162716, 1.98032747503, 2}
+};
+
+const AtomReference ATOMS_FIX_PHASE_TRIAL_SEPARATION[] = {
+    {0, 0, 96.0, 48, 28.5, 1.42893489333, 1.79125456708, 0},
+    {0, 1, 96.0, 48, 28.5, 1.42893489333, 4.78219487091, 1},
+    {0, 2, 32.0, 55, 13.5, 0.407486048086, 3.13095610327, 2},
+    {1, 0, 64.0, 51, 11.25, 1.27128699691, 1.275879657, 0},
+    {1, 1, 32.0, 53, 13.5, 0.522644197557, 2.14939332202, 1},
+    {1, 2, 64.0, 61, 9.75, 6.38801328643, 2.11796735263, 2},
+    {2, 0, 32.0, 49, 13.5, 1.06214867199, 1.10218600615, 0},
+    {2, 1, 64.0, 65, 11.25, 1.31860237803, 1.72785285994, 1},
+    {2, 2, 64.0, 92, 11.25, 1.50775466879, 1.90935318237, 2}
+};
+
+} // NAMESPACE
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestAdaptiveMp
+*
+* @brief The TestAdaptiveMp class decomposes a fixed multichannel signal and compares the selected atoms with the
+*        ones of the sequential scale search
+*
+*/
+class TestAdaptiveMp: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestAdaptiveMp();
+
+private slots:
+    void initTestCase();
+    void compareDefault();
+    void compareFixPhase();
+    void compareTrialSeparation();
+    void compareFixPhaseTrialSeparation();
+    void cleanupTestCase();
+
+private:
+    void compareAtoms(bool bFixPhase, bool bTrialSeparation, const AtomReference* pReference, int iNumAtoms);
+
+    double epsilon;
+
+    MatrixXd m_matSignal;
+    qint32 m_iIterations;
+};
+
+
+//*************************************************************************************************************
+
+TestAdaptiveMp::TestAdaptiveMp()
+: epsilon(0.000001)
+, m_iIterations(3)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    //
+    //   Three channels: a shifted gabor burst with growing amplitude, a sinusoid which is strongest in the second
+    //   channel and a small channel dependent oscillation
+    //
+    const qint32 iNumSamples = 96;
+    const qint32 iNumChannels = 3;
+
+    m_matSignal.resize(iNumSamples, iNumChannels);
+    for(qint32 c = 0; c < iNumChannels; ++c) {
+        for(qint32 n = 0; n < iNumSamples; ++n) {
+            const double dEnvelope = std::exp(-std::pow((n - 40.0 - 6 * c) / 9.0, 2));
+            m_matSignal(n, c) = (1.0 + 0.5 * c) * dEnvelope * std::cos(2 * M_PI * 0.12 * n + 0.4 * c)
+                                + (c == 1 ? 0.8 : 0.3) * std::cos(2 * M_PI * 0.3 * n + 0.5)
+                                + 0.05 * std::sin(1.7 * n * (c + 1));
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::compareDefault()
+{
+    compareAtoms(false, false, ATOMS_DEFAULT, sizeof(ATOMS_DEFAULT) / sizeof(AtomReference));
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::compareFixPhase()
+{
+    compareAtoms(true, false, ATOMS_FIX_PHASE, sizeof(ATOMS_FIX_PHASE) / sizeof(AtomReference));
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::compareTrialSeparation()
+{
+    compareAtoms(false, true, ATOMS_TRIAL_SEPARATION, sizeof(ATOMS_TRIAL_SEPARATION) / sizeof(AtomReference));
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::compareFixPhaseTrialSeparation()
+{
+    compareAtoms(true, true, ATOMS_FIX_PHASE_TRIAL_SEPARATION, sizeof(ATOMS_FIX_PHASE_TRIAL_SEPARATION) / sizeof(AtomReference));
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::compareAtoms(bool bFixPhase, bool bTrialSeparation, const AtomReference* pReference, int iNumAtoms)
+{
+    // A fresh object per run, the iteration counter and the atom list are members
+    AdaptiveMp adaptiveMp;
+    QList<QList<GaborAtom> > atomList = adaptiveMp.matching_pursuit(m_matSignal, m_iIterations, 0.0, bFixPhase, 100, 0,
+                                                                    1.0, 0.2, 0.5, 0.5, bTrialSeparation);
+
+    QCOMPARE(atomList.size(), m_iIterations);
+
+    int iNumFound = 0;
+    for(int i = 0; i < atomList.size(); ++i) {
+        QCOMPARE(atomList.at(i).size(), bTrialSeparation ? static_cast<int>(m_matSignal.cols()) : 1);
+        iNumFound += atomList.at(i).size();
+    }
+    QCOMPARE(iNumFound, iNumAtoms);
+
+    for(int a = 0; a < iNumAtoms; ++a) {
+        const AtomReference& ref = pReference[a];
+        const GaborAtom& atom = atomList.at(ref.iteration).at(ref.atom);
+
+        // Dyadic grid parameters are exact, phase and scalar product follow from the residuum
+        QVERIFY(std::fabs(atom.scale - ref.scale) < epsilon);
+        QCOMPARE(atom.translation, ref.translation);
+        QVERIFY(std::fabs(atom.modulation - ref.modulation) < epsilon);
+        QCOMPARE(atom.bm_channel, ref.channel);
+        QVERIFY(std::fabs(atom.phase - ref.phase) < epsilon);
+        QVERIFY(std::fabs(atom.max_scalar_product - ref.scalar_product) < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestAdaptiveMp)
+#include "test_adaptive_mp.moc"
@@ -0,0 +1,341 @@
+//=============================================================================================================
+/**
+* @file     test_epidetect_metrics.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The EpiDetect metrics unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <calcmetric.h>
+#include <slidingwindowstats.h>
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* Batch kurtosis and standard deviation of every row, as EpiDetect computed them before the sliding window.
+*/
+VectorXd batchKurtosis(const MatrixXd& data, VectorXd& stdDev)
+{
+    int length = data.cols();
+    VectorXd mean = data.rowwise().mean();
+    VectorXd kurtosis(data.rows());
+    stdDev.resize(data.rows());
+
+    for(int i = 0; i < data.rows(); i++)
+    {
+        stdDev(i) = 0;
+        kurtosis(i) = 0;
+
+        for(int j = 0; j < length; j++)
+        {
+            double sum = data(i,j) - mean(i);
+            stdDev(i) = stdDev(i) + pow(sum, 2);
+            kurtosis(i) = kurtosis(i) + pow(sum, 4);
+        }
+
+        stdDev(i) = stdDev(i)/(length-1);
+        stdDev(i) = sqrt(stdDev(i));
+        kurtosis(i) = kurtosis(i)/(length*pow((stdDev(i)*sqrt(length-1))/sqrt(length), 4));
+    }
+
+    return kurtosis;
+}
+
+
+//=============================================================================================================
+/**
+* Batch peak-to-peak magnitude of every row.
+*/
+VectorXd batchP2P(const MatrixXd& data)
+{
+    return data.rowwise().maxCoeff() - data.rowwise().minCoeff();
+}
+
+
+//=============================================================================================================
+/**
+* Fuzzy Entropy of one channel, as EpiDetect computed it before the lag wise rewrite.
+*/
+double batchFuzzyEn(const RowVectorXd& data, double mean, double stdDev, int dim, double r, double n)
+{
+    int length = data.cols();
+    VectorXd dataNorm = ((data.array() - mean)/stdDev).transpose();
+    Vector2d phi;
+
+    for(int j = 0; j < 2; j++)
+    {
+        int m = dim+j;
+        MatrixXd patterns(m, length-m+1);
+
+        for(int i = 0; i < m; i++)
+            patterns.row(i) = dataNorm.segment(i, length-m+1).transpose();
+
+        VectorXd patternsMean = patterns.colwise().mean();
+        patterns = patterns.rowwise() - patternsMean.transpose();
+        VectorXd aux(length-m+1);
+
+        for(int i = 0; i < length-m+1; i++)
+        {
+            MatrixXd column(patterns.rows(), patterns.cols());
+            for(int l = 0; l < patterns.cols(); l++)
+                column.col(l) = patterns.col(i);
+
+            VectorXd distance = ((patterns.array()-column.array()).abs()).colwise().maxCoeff();
+            VectorXd similarity = (((-1)*(distance.array().pow(n)))/r).exp();
+
+            aux(i) = (similarity.sum()-1)/(length-m-1);
+        }
+
+        phi[j] = aux.sum()/(length-m);
+    }
+
+    return log(phi[0])-log(phi[1]);
+}
+
+
+//=============================================================================================================
+/**
+* Random channels with an offset and sparse spikes, so that kurtosis and peak-to-peak magnitude change while the
+* window slides.
+*/
+MatrixXd randomData(int channels, int samples)
+{
+    std::srand(42);
+    MatrixXd data = MatrixXd::Random(channels, samples);
+
+    for(int i = 0; i < channels; i++)
+    {
+        data.row(i).array() += 100.0*(i+1);
+        for(int j = (17*i) % 97; j < samples; j += 311)
+            data(i,j) += 5.0*(i+1);
+    }
+
+    return data;
+}
+
+} // NAMESPACE
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestEpidetectMetrics
+*
+* @brief The TestEpidetectMetrics class compares the incremental EpiDetect metrics with the batch formulas they
+* replaced
+*
+*/
+class TestEpidetectMetrics: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestEpidetectMetrics();
+
+private slots:
+    void initTestCase();
+    void compareSlidingWindowStats();
+    void compareCalcMetric();
+    void compareFuzzyEn();
+    void cleanupTestCase();
+
+private:
+    void compareVectors(const VectorXd& vecResult, const VectorXd& vecReference) const;
+
+    double epsilon;
+
+    MatrixXd m_matData;     /**< Random test data. */
+};
+
+
+//*************************************************************************************************************
+
+TestEpidetectMetrics::TestEpidetectMetrics()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestEpidetectMetrics::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    m_matData = randomData(6, 5000);
+}
+
+
+//*************************************************************************************************************
+
+void TestEpidetectMetrics::compareSlidingWindowStats()
+{
+    //Block sizes below, at and above the window length
+    int iWindowLength = 400;
+    int blockSizes[] = {1, 37, 200, 399, 400, 523};
+    int iNumBlockSizes = sizeof(blockSizes)/sizeof(int);
+
+    SlidingWindowStats stats;
+    stats.reset(m_matData.rows(), iWindowLength);
+
+    int iPushed = 0;
+    for(int k = 0; iPushed < m_matData.cols(); ++k) {
+        int iBlock = qMin(blockSizes[k % iNumBlockSizes], int(m_matData.cols()) - iPushed);
+        stats.push(m_matData.middleCols(iPushed, iBlock));
+        iPushed += iBlock;
+
+        int iCount = qMin(iPushed, iWindowLength);
+        QCOMPARE(stats.count(), iCount);
+
+        if(iCount < 2)
+            continue;
+
+        MatrixXd matWindow = m_matData.middleCols(iPushed - iCount, iCount);
+        VectorXd vecStdDev;
+        VectorXd vecKurtosis = batchKurtosis(matWindow, vecStdDev);
+
+        compareVectors(stats.mean(), matWindow.rowwise().mean());
+        compareVectors(stats.stdDev(), vecStdDev);
+        compareVectors(stats.kurtosis(), vecKurtosis);
+        compareVectors(stats.p2p(), batchP2P(matWindow));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestEpidetectMetrics::compareCalcMetric()
+{
+    //Windows overlap by half, like EpiDetect slides them over the incoming blocks
+    int iWindowLength = 500;
+    int iHalf = iWindowLength/2;
+
+    CalcMetric calculator;
+    calculator.calcAll(m_matData.leftCols(iWindowLength), 3, 0.3, 3, -1);
+
+    for(int iStart = 0; iStart + iWindowLength <= m_matData.cols(); iStart += iHalf) {
+        MatrixXd matWindow = m_matData.middleCols(iStart, iWindowLength);
+
+        if(iStart > 0)
+            calculator.calcAll(matWindow, 3, 0.3, 3, iHalf);
+
+        VectorXd vecStdDev;
+        compareVectors(calculator.getKurtosis(), batchKurtosis(matWindow, vecStdDev));
+        compareVectors(calculator.getP2P(), batchP2P(matWindow));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestEpidetectMetrics::compareFuzzyEn()
+{
+    //n = 2 takes the squared distance path, n = 3 the general power
+    MatrixXd matWindow = m_matData.leftCols(300);
+    QList<int> lChannels;
+    for(int i = 0; i < matWindow.rows(); ++i)
+        lChannels << i;
+
+    VectorXd vecStdDev;
+    batchKurtosis(matWindow, vecStdDev);
+    VectorXd vecMean = matWindow.rowwise().mean();
+
+    double nValues[] = {2.0, 3.0};
+    for(int k = 0; k < 2; ++k) {
+        CalcMetric calculator;
+        calculator.calcAll(matWindow, 3, 0.3, nValues[k], -1);
+        VectorXd vecFuzzyEn = calculator.onSeizureDetection(3, 0.3, nValues[k], lChannels);
+
+        VectorXd vecReference(matWindow.rows());
+        for(int i = 0; i < matWindow.rows(); ++i)
+            vecReference(i) = batchFuzzyEn(matWindow.row(i), vecMean(i), vecStdDev(i), 3, 0.3, nValues[k]);
+
+        compareVectors(vecFuzzyEn, vecReference);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestEpidetectMetrics::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestEpidetectMetrics::compareVectors(const VectorXd& vecResult, const VectorXd& vecReference) const
+{
+    QCOMPARE(vecResult.size(), vecReference.size());
+
+    for(int i = 0; i < vecReference.size(); ++i) {
+        QVERIFY(std::isfinite(vecResult(i)));
+        QVERIFY(std::fabs(vecResult(i) - vecReference(i)) <= epsilon*qMax(1.0, std::fabs(vecReference(i))));
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestEpidetectMetrics)
+#include "test_epidetect_metrics.moc"
@@ -0,0 +1,348 @@
+//=============================================================================================================
+/**
+* @file     test_fast_kmeans.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the accelerated K-Means clustering
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/fastkmeans.h>
+
+#include <algorithm>
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+const quint32 SEED = 42;    /**< Fixed seed of the k-means++ seeding. */
+
+//*************************************************************************************************************
+
+/**
+* Centroid of the given points: mean for "sqeuclidean", component-wise median for "cityblock".
+*/
+RowVectorXd centroid(const MatrixXd& matPoints, bool bCityblock)
+{
+    if(!bCityblock) {
+        return matPoints.colwise().mean();
+    }
+
+    RowVectorXd vecMedian(matPoints.cols());
+    for(int d = 0; d < matPoints.cols(); ++d) {
+        std::vector<double> vecValues(matPoints.rows());
+        for(int i = 0; i < matPoints.rows(); ++i) {
+            vecValues[i] = matPoints(i, d);
+        }
+        std::sort(vecValues.begin(), vecValues.end());
+
+        const size_t iMid = vecValues.size() / 2;
+        vecMedian[d] = vecValues.size() % 2 == 0 ? 0.5 * (vecValues[iMid - 1] + vecValues[iMid]) : vecValues[iMid];
+    }
+
+    return vecMedian;
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Squared euclidean or cityblock distance, as reported in D.
+*/
+double distance(const RowVectorXd& x, const RowVectorXd& c, bool bCityblock)
+{
+    return bCityblock ? (x - c).cwiseAbs().sum() : (x - c).squaredNorm();
+}
+
+} // NAMESPACE
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFastKMeans
+*
+* @brief The TestFastKMeans class clusters well separated blobs with FastKMeans and compares the result with the
+*        known partition
+*
+*/
+class TestFastKMeans: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFastKMeans();
+
+private slots:
+    void initTestCase();
+    void compareSqeuclidean();
+    void compareCityblock();
+    void compareSingleCluster();
+    void reseedEmptyCluster();
+    void cleanupTestCase();
+
+private:
+    void compareClustering(const QString& sDistance, qint32 kClusters);
+
+    double epsilon;
+
+    MatrixXd m_matX;
+    VectorXi m_vecBlob;
+    qint32 m_iNumBlobs;
+};
+
+
+//*************************************************************************************************************
+
+TestFastKMeans::TestFastKMeans()
+: epsilon(0.000001)
+, m_iNumBlobs(3)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    //
+    //   Three blobs of different size, their radius is far below their separation. The points of the blobs are
+    //   interleaved, more than 128 points give several ranges for the parallel assignment.
+    //
+    MatrixXd matCenters(m_iNumBlobs, 3);
+    matCenters << 0.0, 0.0, 0.0,
+                  8.0, 1.0, -2.0,
+                  2.0, 9.0, 4.0;
+    const qint32 iSizes[] = {60, 50, 70};
+
+    const qint32 iNumPoints = iSizes[0] + iSizes[1] + iSizes[2];
+    m_matX.resize(iNumPoints, 3);
+    m_vecBlob.resize(iNumPoints);
+
+    qint32 iCount[] = {0, 0, 0};
+    for(qint32 i = 0; i < iNumPoints; ++i) {
+        qint32 b = i % m_iNumBlobs;
+        while(iCount[b] == iSizes[b]) {
+            b = (b + 1) % m_iNumBlobs;
+        }
+
+        const double r = 0.1 + 0.01 * iCount[b];
+        const double a = 2.4 * iCount[b];
+        m_matX.row(i) = matCenters.row(b) + RowVector3d(r * std::cos(a), r * std::sin(a), 0.5 * r * std::cos(0.7 * a));
+        m_vecBlob[i] = b;
+        ++iCount[b];
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::compareSqeuclidean()
+{
+    compareClustering(QString("sqeuclidean"), m_iNumBlobs);
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::compareCityblock()
+{
+    compareClustering(QString("cityblock"), m_iNumBlobs);
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::compareSingleCluster()
+{
+    compareClustering(QString("sqeuclidean"), 1);
+    compareClustering(QString("cityblock"), 1);
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::reseedEmptyCluster()
+{
+    //
+    //   Five equal points and one outlier: the seeding has to pick a duplicate for the third centroid, which ends
+    //   up empty and takes over one of the equal points
+    //
+    MatrixXd matX(6, 2);
+    matX << 1.0, 1.0,
+            1.0, 1.0,
+            5.0, 5.0,
+            1.0, 1.0,
+            1.0, 1.0,
+            1.0, 1.0;
+
+    VectorXi idx;
+    MatrixXd C;
+    VectorXd sumD;
+    MatrixXd D;
+
+    FastKMeans kMeans(QString("sqeuclidean"), 1, 100, SEED);
+    QVERIFY(kMeans.calculate(matX, 3, idx, C, sumD, D));
+
+    QCOMPARE(static_cast<qint32>(idx.size()), 6);
+    QCOMPARE(static_cast<qint32>(C.rows()), 3);
+    QCOMPARE(static_cast<qint32>(D.rows()), 6);
+    QCOMPARE(static_cast<qint32>(D.cols()), 3);
+
+    // Every cluster holds at least one point, the outlier is alone
+    VectorXi vecCounts = VectorXi::Zero(3);
+    for(qint32 i = 0; i < idx.size(); ++i) {
+        QVERIFY(idx[i] >= 0 && idx[i] < 3);
+        ++vecCounts[idx[i]];
+    }
+    std::sort(vecCounts.data(), vecCounts.data() + vecCounts.size());
+    QVERIFY(vecCounts == Vector3i(1, 1, 4));
+
+    for(qint32 i = 0; i < idx.size(); ++i) {
+        if(i != 2) {
+            QVERIFY(idx[i] != idx[2]);
+        }
+        QVERIFY((C.row(idx[i]) - matX.row(i)).cwiseAbs().maxCoeff() < epsilon);
+    }
+
+    QVERIFY(sumD.cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFastKMeans::compareClustering(const QString& sDistance, qint32 kClusters)
+{
+    const bool bCityblock = sDistance == QString("cityblock");
+    const qint32 n = m_matX.rows();
+
+    VectorXi idx;
+    MatrixXd C;
+    VectorXd sumD;
+    MatrixXd D;
+
+    FastKMeans kMeans(sDistance, 3, 100, SEED);
+    QVERIFY(kMeans.calculate(m_matX, kClusters, idx, C, sumD, D));
+
+    QCOMPARE(static_cast<qint32>(idx.size()), n);
+    QCOMPARE(static_cast<qint32>(C.rows()), kClusters);
+    QCOMPARE(static_cast<qint32>(C.cols()), static_cast<qint32>(m_matX.cols()));
+    QCOMPARE(static_cast<qint32>(sumD.size()), kClusters);
+    QCOMPARE(static_cast<qint32>(D.rows()), n);
+    QCOMPARE(static_cast<qint32>(D.cols()), kClusters);
+
+    // Known partition, up to the numbering of the clusters
+    VectorXi vecReference = kClusters == 1 ? VectorXi::Zero(n) : m_vecBlob;
+    VectorXi vecLabel = VectorXi::Constant(kClusters, -1);
+    for(qint32 i = 0; i < n; ++i) {
+        QVERIFY(idx[i] >= 0 && idx[i] < kClusters);
+        if(vecLabel[vecReference[i]] < 0) {
+            vecLabel[vecReference[i]] = idx[i];
+        }
+        QCOMPARE(idx[i], vecLabel[vecReference[i]]);
+    }
+    for(qint32 j = 0; j < kClusters; ++j) {
+        for(qint32 jj = j + 1; jj < kClusters; ++jj) {
+            QVERIFY(vecLabel[j] != vecLabel[jj]);
+        }
+    }
+
+    // Centroids and within cluster sums of the known partition
+    for(qint32 j = 0; j < kClusters; ++j) {
+        MatrixXd matPoints(n, m_matX.cols());
+        qint32 iNumPoints = 0;
+        for(qint32 i = 0; i < n; ++i) {
+            if(vecReference[i] == j) {
+                matPoints.row(iNumPoints++) = m_matX.row(i);
+            }
+        }
+
+        const RowVectorXd vecCentroid = centroid(matPoints.topRows(iNumPoints), bCityblock);
+        QVERIFY((C.row(vecLabel[j]) - vecCentroid).cwiseAbs().maxCoeff() < epsilon);
+
+        double dSum = 0;
+        for(qint32 i = 0; i < iNumPoints; ++i) {
+            dSum += distance(matPoints.row(i), vecCentroid, bCityblock);
+        }
+        QVERIFY(std::fabs(sumD[vecLabel[j]] - dSum) < epsilon);
+    }
+
+    // Distances of every point to every centroid
+    for(qint32 i = 0; i < n; ++i) {
+        for(qint32 j = 0; j < kClusters; ++j) {
+            QVERIFY(std::fabs(D(i, j) - distance(m_matX.row(i), C.row(j), bCityblock)) < epsilon);
+        }
+        QCOMPARE(D.row(i).minCoeff(), D(i, idx[i]));
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFastKMeans)
+#include "test_fast_kmeans.moc"
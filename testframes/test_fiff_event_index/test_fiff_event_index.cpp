@@ -0,0 +1,265 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_event_index.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The trigger event index unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <fiff/fiff_event_index.h>
+#include <utils/detecttrigger.h>
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QBuffer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffEventIndex
+*
+* @brief The TestFiffEventIndex class compares FiffEventIndex with a scan of the trigger channel of the fully
+* read raw data
+*
+*/
+class TestFiffEventIndex: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffEventIndex();
+
+private slots:
+    void initTestCase();
+    void compareAllChanges();
+    void compareOnsets();
+    void compareRange();
+    void compareWriteRead();
+    void cleanupTestCase();
+
+private:
+    MatrixXi rowsInRange(const MatrixXi& events, fiff_int_t iFrom, fiff_int_t iTo) const;
+
+    double epsilon;
+
+    FiffEventIndex m_eventIndex;    /**< The index of the raw file. */
+    MatrixXi m_matRefEvents;        /**< The events found by scanning the read trigger channel. */
+    fiff_int_t m_iFirstSample;      /**< First sample of the raw file. */
+    fiff_int_t m_iLastSample;       /**< Last sample of the raw file. */
+};
+
+
+//*************************************************************************************************************
+
+TestFiffEventIndex::TestFiffEventIndex()
+: epsilon(0.000001)
+, m_iFirstSample(0)
+, m_iLastSample(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffEventIndex::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QFile t_fileRaw("./mne-cpp-test-data/MEG/sample/test_raw.fif");
+    FiffRawData raw(t_fileRaw);
+    m_iFirstSample = raw.first_samp;
+    m_iLastSample = raw.last_samp;
+
+    //Index, without storing it next to the test data
+    QVERIFY(m_eventIndex.build(raw));
+    QVERIFY(!m_eventIndex.isEmpty());
+
+    //Reference: read the whole trigger channel and scan it for rising and falling flanks
+    qint32 iCh = raw.info.channel_index(m_eventIndex.trigger_channel());
+    QVERIFY(iCh >= 0);
+
+    RowVectorXi sel(1);
+    sel << iCh;
+    MatrixXd data, times;
+    QVERIFY(raw.read_raw_segment(data, times, m_iFirstSample, m_iLastSample, sel));
+    data = data.unaryExpr([](double v) { return double(qRound(v)); });
+
+    QList<QPair<int,double> > lRising = DetectTrigger::detectTriggerFlanksGrad(data, 0, m_iFirstSample, 0.5, false, "Rising", 0);
+    QList<QPair<int,double> > lFalling = DetectTrigger::detectTriggerFlanksGrad(data, 0, m_iFirstSample, 0.5, false, "Falling", 0);
+
+    QMap<int,int> mapChanges;
+    for(qint32 i = 0; i < lRising.size(); ++i) {
+        mapChanges.insert(lRising[i].first, 0);
+    }
+    for(qint32 i = 0; i < lFalling.size(); ++i) {
+        mapChanges.insert(lFalling[i].first, 0);
+    }
+
+    //The index compares the first sample with zero
+    if(qRound(data(0,0)) != 0) {
+        mapChanges.insert(m_iFirstSample, 0);
+    }
+
+    m_matRefEvents.resize(mapChanges.size(), 3);
+    qint32 iRow = 0;
+    QMap<int,int>::const_iterator it;
+    for(it = mapChanges.constBegin(); it != mapChanges.constEnd(); ++it, ++iRow) {
+        qint32 s = it.key() - m_iFirstSample;
+        m_matRefEvents(iRow, 0) = it.key();
+        m_matRefEvents(iRow, 1) = s > 0 ? qRound(data(0, s-1)) : 0;
+        m_matRefEvents(iRow, 2) = qRound(data(0, s));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffEventIndex::compareAllChanges()
+{
+    MatrixXi matEvents = m_eventIndex.events(false);
+
+    QCOMPARE(matEvents.rows(), m_matRefEvents.rows());
+    QVERIFY(matEvents == m_matRefEvents);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffEventIndex::compareOnsets()
+{
+    MatrixXi matOnsets = m_eventIndex.events();
+
+    qint32 iNumOnsets = (m_matRefEvents.col(2).array() != 0).count();
+    QCOMPARE(qint32(matOnsets.rows()), iNumOnsets);
+
+    qint32 iRow = 0;
+    for(qint32 i = 0; i < m_matRefEvents.rows(); ++i) {
+        if(m_matRefEvents(i, 2) != 0) {
+            QVERIFY(matOnsets.row(iRow) == m_matRefEvents.row(i));
+            ++iRow;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffEventIndex::compareRange()
+{
+    //A range in the middle of the file, bounds inclusive
+    fiff_int_t iFrom = m_iFirstSample + (m_iLastSample - m_iFirstSample) / 4;
+    fiff_int_t iTo = m_iFirstSample + 3 * (m_iLastSample - m_iFirstSample) / 4;
+
+    MatrixXi matRange = m_eventIndex.events_in_range(iFrom, iTo, false);
+    MatrixXi matRefRange = rowsInRange(m_matRefEvents, iFrom, iTo);
+
+    QCOMPARE(matRange.rows(), matRefRange.rows());
+    QVERIFY(matRange == matRefRange);
+
+    //An event sample as bound
+    if(m_matRefEvents.rows() > 0) {
+        fiff_int_t iSample = m_matRefEvents(0, 0);
+        QVERIFY(m_eventIndex.events_in_range(iSample, iSample, false) == rowsInRange(m_matRefEvents, iSample, iSample));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffEventIndex::compareWriteRead()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QVERIFY(m_eventIndex.write(buffer));
+    buffer.close();
+
+    FiffEventIndex readIndex;
+    QVERIFY(readIndex.read(buffer));
+
+    QVERIFY(readIndex.table() == m_eventIndex.table());
+    QCOMPARE(readIndex.trigger_channel(), m_eventIndex.trigger_channel());
+    QCOMPARE(readIndex.mask(), m_eventIndex.mask());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffEventIndex::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi TestFiffEventIndex::rowsInRange(const MatrixXi& events, fiff_int_t iFrom, fiff_int_t iTo) const
+{
+    MatrixXi matRange(events.rows(), 3);
+    qint32 iRows = 0;
+    for(qint32 i = 0; i < events.rows(); ++i) {
+        if(events(i, 0) >= iFrom && events(i, 0) <= iTo) {
+            matRange.row(iRows++) = events.row(i);
+        }
+    }
+    matRange.conservativeResize(iRows, 3);
+    return matRange;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffEventIndex)
+#include "test_fiff_event_index.moc"
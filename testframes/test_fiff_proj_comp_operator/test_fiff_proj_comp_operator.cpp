@@ -0,0 +1,240 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_proj_comp_operator.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The combined projection and compensation operator unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffProjCompOperator
+*
+* @brief The TestFiffProjCompOperator class compares FiffInfo::proj_comp_operator with the dense
+* make_projector * make_compensator
+*
+*/
+class TestFiffProjCompOperator: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffProjCompOperator();
+
+private slots:
+    void initTestCase();
+    void compareProjection();
+    void compareProjectionAndCompensation();
+    void compareZeroBads();
+    void compareCache();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+
+    FiffInfo m_info;        /**< Measurement info with active projectors and a synthetic compensator. */
+    MatrixXd m_matData;     /**< Test data (channels x samples). */
+};
+
+
+//*************************************************************************************************************
+
+TestFiffProjCompOperator::TestFiffProjCompOperator()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffProjCompOperator::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+    m_info = raw.info;
+
+    QVERIFY(m_info.nchan > 40);
+    QVERIFY(!m_info.projs.isEmpty());
+
+    for(qint32 k = 0; k < m_info.projs.size(); ++k) {
+        m_info.projs[k].active = true;
+    }
+
+    //The sample data has no compensators, compensate channels 10..39 with the reference channels 0..2
+    QStringList rowNames, colNames;
+    for(qint32 k = 10; k < 40; ++k) {
+        rowNames << m_info.ch_names[k];
+    }
+    for(qint32 k = 0; k < 3; ++k) {
+        colNames << m_info.ch_names[k];
+    }
+
+    FiffCtfComp comp;
+    comp.kind = 1;
+    comp.save_calibrated = false;
+    comp.data = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(rowNames.size(), colNames.size(), rowNames, colNames, 0.1 * MatrixXd::Random(rowNames.size(), colNames.size())));
+    m_info.comps.append(comp);
+
+    m_matData = MatrixXd::Random(m_info.nchan, 100);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffProjCompOperator::compareProjection()
+{
+    MatrixXd matProj;
+    QVERIFY(m_info.make_projector(matProj) > 0);
+
+    FiffProjCompOperator::ConstSPtr pOperator = m_info.proj_comp_operator();
+    QVERIFY(pOperator->hasProj());
+    QVERIFY(!pOperator->hasComp());
+
+    MatrixXd matDiff = pOperator->apply(m_matData) - matProj * m_matData;
+    QVERIFY(matDiff.cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffProjCompOperator::compareProjectionAndCompensation()
+{
+    MatrixXd matProj;
+    QVERIFY(m_info.make_projector(matProj) > 0);
+
+    FiffCtfComp comp;
+    QVERIFY(m_info.make_compensator(0, 1, comp));
+
+    FiffProjCompOperator::ConstSPtr pOperator = m_info.proj_comp_operator(1);
+    QVERIFY(pOperator->hasProj());
+    QVERIFY(pOperator->hasComp());
+
+    MatrixXd matDiff = pOperator->apply(m_matData) - matProj * comp.data->data * m_matData;
+    QVERIFY(matDiff.cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffProjCompOperator::compareZeroBads()
+{
+    QVERIFY(!m_info.bads.isEmpty());
+
+    MatrixXd matProj;
+    QVERIFY(m_info.make_projector(matProj) > 0);
+
+    MatrixXd matExpected = matProj * m_matData;
+    for(qint32 k = 0; k < m_info.bads.size(); ++k) {
+        qint32 idx = m_info.ch_names.indexOf(m_info.bads[k]);
+        if(idx >= 0) {
+            matExpected.row(idx).setZero();
+        }
+    }
+
+    MatrixXd matDiff = m_info.proj_comp_operator(0, true)->apply(m_matData) - matExpected;
+    QVERIFY(matDiff.cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffProjCompOperator::compareCache()
+{
+    FiffInfo info = m_info;
+
+    //Callers with different arguments must not evict each other
+    FiffProjCompOperator::ConstSPtr pPlain = info.proj_comp_operator();
+    FiffProjCompOperator::ConstSPtr pComp = info.proj_comp_operator(1);
+    FiffProjCompOperator::ConstSPtr pZeroBads = info.proj_comp_operator(0, true);
+
+    QVERIFY(info.proj_comp_operator() == pPlain);
+    QVERIFY(info.proj_comp_operator(1) == pComp);
+    QVERIFY(info.proj_comp_operator(0, true) == pZeroBads);
+    QVERIFY(pPlain != pComp && pPlain != pZeroBads);
+
+    //A changed projector gives a new operator, which matches the dense projector
+    info.projs[0].active = false;
+    FiffProjCompOperator::ConstSPtr pChanged = info.proj_comp_operator(1);
+    QVERIFY(pChanged != pComp);
+
+    MatrixXd matProj;
+    info.make_projector(matProj);
+    FiffCtfComp comp;
+    QVERIFY(info.make_compensator(0, 1, comp));
+
+    MatrixXd matDiff = pChanged->apply(m_matData) - matProj * comp.data->data * m_matData;
+    QVERIFY(matDiff.cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffProjCompOperator::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffProjCompOperator)
+#include "test_fiff_proj_comp_operator.moc"
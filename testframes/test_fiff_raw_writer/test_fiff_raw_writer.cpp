@@ -0,0 +1,293 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_raw_writer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The streaming raw writer unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <fiff/fiff_raw_writer.h>
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+    const qint64 s_iNoSplit = 2000000000;                   /**< Split size which is never reached. */
+    const qint64 s_iMaxPendingBytes = 512*1024*1024;        /**< Pending limit which is never reached. */
+}
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffRawWriter
+*
+* @brief The TestFiffRawWriter class writes buffers with FiffRawWriter, drops some of them and splits the
+* recording, and reads the files back
+*
+*/
+class TestFiffRawWriter: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffRawWriter();
+
+private slots:
+    void initTestCase();
+    void compareCounters();
+    void compareFirstSamples();
+    void compareData();
+    void cleanupTestCase();
+
+private:
+    void waitForDisk(const FiffRawWriter& writer);
+
+    double epsilon;
+
+    fiff_int_t m_iFirstSample;      /**< First sample number of the recording. */
+    QVector<qint32> m_vecSizes;     /**< Number of samples of each buffer. */
+    QVector<bool> m_vecDropped;     /**< Whether a buffer was dropped. */
+    MatrixXf m_matRaw;              /**< The uncalibrated data of all buffers. */
+    RowVectorXd m_vecCals;          /**< The calibration of all channels. */
+
+    int m_iDroppedBuffers;
+    qint64 m_iSamplesDropped;
+    qint64 m_iSamplesWritten;
+    QStringList m_lFileNames;
+};
+
+
+//*************************************************************************************************************
+
+TestFiffRawWriter::TestFiffRawWriter()
+: epsilon(0.000001)
+, m_iFirstSample(1000)
+, m_iDroppedBuffers(0)
+, m_iSamplesDropped(0)
+, m_iSamplesWritten(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QString sFileOut("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_writer_out.fif");
+
+    FiffRawData raw(t_fileIn);
+    FiffInfo info = raw.info;
+    QVERIFY(info.nchan > 0);
+
+    //The writer resets the ranges, the calibration is the plain cal
+    m_vecCals.resize(info.nchan);
+    for(qint32 k = 0; k < info.nchan; ++k) {
+        m_vecCals[k] = info.chs[k].cal;
+    }
+
+    //Buffer 2 is skipped with FIFF_DATA_SKIP, buffer 5 right before the split, buffer 9 is shorter than the
+    //following buffer and is written as zeros
+    const qint32 iNumBuffers = 12;
+    m_vecSizes.fill(200, iNumBuffers);
+    m_vecSizes[9] = 100;
+    m_vecDropped.fill(false, iNumBuffers);
+    m_vecDropped[2] = m_vecDropped[5] = m_vecDropped[9] = true;
+
+    qint32 iNumSamples = 0;
+    for(qint32 i = 0; i < iNumBuffers; ++i) {
+        iNumSamples += m_vecSizes[i];
+    }
+    m_matRaw = MatrixXf::Random(info.nchan, iNumSamples);
+
+    FiffRawWriter writer;
+    writer.setSplitSize(s_iNoSplit);
+    QVERIFY(writer.open(sFileOut, info, defaultMatrixXi, m_iFirstSample, true));
+
+    qint32 iOffset = 0;
+    for(qint32 i = 0; i < iNumBuffers; ++i) {
+        MatrixXd matData = m_vecCals.transpose().asDiagonal() * m_matRaw.middleCols(iOffset, m_vecSizes[i]).cast<double>();
+        iOffset += m_vecSizes[i];
+
+        if(i == 6) {
+            //Split in front of buffer 6, right after the dropped buffer 5
+            waitForDisk(writer);
+            writer.setSplitSize(1);
+        }
+
+        if(m_vecDropped[i]) {
+            //No buffer fits into zero pending bytes
+            writer.setMaxPendingBytes(0);
+            QVERIFY(!writer.write(matData));
+            writer.setMaxPendingBytes(s_iMaxPendingBytes);
+        } else {
+            QVERIFY(writer.write(matData));
+        }
+
+        if(i == 6) {
+            waitForDisk(writer);
+            writer.setSplitSize(s_iNoSplit);
+        }
+    }
+
+    writer.close();
+
+    m_iDroppedBuffers = writer.droppedBuffers();
+    m_iSamplesDropped = writer.samplesDropped();
+    m_iSamplesWritten = writer.samplesWritten();
+    m_lFileNames = writer.fileNames();
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::compareCounters()
+{
+    qint64 iSamplesDropped = m_vecSizes[2] + m_vecSizes[5] + m_vecSizes[9];
+
+    QCOMPARE(m_iDroppedBuffers, 3);
+    QCOMPARE(m_iSamplesDropped, iSamplesDropped);
+    QCOMPARE(m_iSamplesWritten, qint64(m_matRaw.cols()) - iSamplesDropped);
+    QCOMPARE(m_lFileNames.size(), 2);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::compareFirstSamples()
+{
+    QCOMPARE(m_lFileNames.size(), 2);
+
+    //The first sample of the split file counts the dropped buffer 5
+    fiff_int_t iSplitSample = m_iFirstSample;
+    for(qint32 i = 0; i < 6; ++i) {
+        iSplitSample += m_vecSizes[i];
+    }
+
+    QFile t_fileFirst(m_lFileNames[0]);
+    FiffRawData first(t_fileFirst);
+    QCOMPARE(first.first_samp, m_iFirstSample);
+    QCOMPARE(first.last_samp, iSplitSample - m_vecSizes[5] - 1);
+
+    QFile t_fileSecond(m_lFileNames[1]);
+    FiffRawData second(t_fileSecond);
+    QCOMPARE(second.first_samp, iSplitSample);
+    QCOMPARE(second.last_samp, fiff_int_t(m_iFirstSample + m_matRaw.cols() - 1));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::compareData()
+{
+    //The expected data, dropped samples read as zeros
+    MatrixXd matExpected = m_matRaw.cast<double>();
+    qint32 iOffset = 0;
+    for(qint32 i = 0; i < m_vecSizes.size(); ++i) {
+        if(m_vecDropped[i]) {
+            matExpected.middleCols(iOffset, m_vecSizes[i]).setZero();
+        }
+        iOffset += m_vecSizes[i];
+    }
+
+    for(qint32 i = 0; i < m_lFileNames.size(); ++i) {
+        QFile t_file(m_lFileNames[i]);
+        FiffRawData raw(t_file);
+
+        MatrixXd data, times;
+        QVERIFY(raw.read_raw_segment(data, times, raw.first_samp, raw.last_samp));
+
+        //Compare the uncalibrated values, the channels differ by orders of magnitude
+        MatrixXd matRead = m_vecCals.transpose().cwiseInverse().asDiagonal() * data;
+        MatrixXd matDiff = matRead - matExpected.middleCols(raw.first_samp - m_iFirstSample, matRead.cols());
+        QVERIFY(matDiff.cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::cleanupTestCase()
+{
+    for(qint32 i = 0; i < m_lFileNames.size(); ++i) {
+        QFile::remove(m_lFileNames[i]);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawWriter::waitForDisk(const FiffRawWriter& writer)
+{
+    while(writer.pendingBytes() > 0) {
+        QTest::qSleep(1);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffRawWriter)
+#include "test_fiff_raw_writer.moc"
@@ -78,6 +78,7 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareBufferRead();
     void cleanupTestCase();
 
 private:
@@ -319,6 +320,39 @@ void TestFiffRWR::compareInfo()
     }
 }
 
+//*************************************************************************************************************
+
+void TestFiffRWR::compareBufferRead()
+{
+    //Reading the buffers one by one with a precomputed operator has to give the same data as reading the segment
+    RowVectorXi sel(3);
+    sel << 0, 10, 20;
+
+    fiff_int_t from = first_in_raw.rawdir[1].first + 5;
+    fiff_int_t to = first_in_raw.rawdir[3].last - 5;
+
+    MatrixXd segment_data, segment_times;
+    QVERIFY( first_in_raw.read_raw_segment(segment_data, segment_times, from, to, sel) );
+
+    SparseMatrix<double> mult = first_in_raw.create_operator(sel);
+    QVERIFY( mult.rows() == sel.size() );
+
+    MatrixXd buffer_data(sel.size(), to - from + 1);
+    MatrixXd one;
+    for(qint32 k = 1; k <= 3; ++k)
+    {
+        QVERIFY( first_in_raw.read_raw_buffer(k, mult, one) );
+
+        fiff_int_t first = qMax(from, first_in_raw.rawdir[k].first);
+        fiff_int_t last = qMin(to, first_in_raw.rawdir[k].last);
+        buffer_data.block(0, first - from, one.rows(), last - first + 1) = one.block(0, first - first_in_raw.rawdir[k].first, one.rows(), last - first + 1);
+    }
+
+    MatrixXd data_diff = segment_data - buffer_data;
+    QVERIFY( data_diff.cwiseAbs().maxCoeff() < epsilon );
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffRWR::cleanupTestCase()
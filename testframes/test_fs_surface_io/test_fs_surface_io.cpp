@@ -0,0 +1,410 @@
+//=============================================================================================================
+/**
+* @file     test_fs_surface_io.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the bulk FreeSurfer surface, curvature and annotation readers
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fs/surface.h>
+#include <fs/annotation.h>
+#include <utils/ioutils.h>
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FSLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+/**
+* Reads a 3 byte big endian integer.
+*/
+qint32 read3(QDataStream& stream)
+{
+    quint8 b1, b2, b3;
+    stream >> b1 >> b2 >> b3;
+    return (qint32(b1) << 16) + (qint32(b2) << 8) + qint32(b3);
+}
+
+//*************************************************************************************************************
+
+/**
+* Per element reference reader for triangle surface files, scaled to m like Surface::read.
+*/
+bool readTriangleSurface(const QString& sFile, MatrixX3f& matRR, MatrixX3i& matTris)
+{
+    QFile t_File(sFile);
+    if(!t_File.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream t_Stream(&t_File);
+    t_Stream.setByteOrder(QDataStream::BigEndian);
+    t_Stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    if(read3(t_Stream) != 16777214) {
+        return false;
+    }
+    t_File.readLine();
+    t_File.readLine();
+
+    qint32 nvert, nface;
+    t_Stream >> nvert >> nface;
+
+    matRR.resize(nvert, 3);
+    for(qint32 i = 0; i < nvert; ++i) {
+        for(qint32 j = 0; j < 3; ++j) {
+            float fVal;
+            t_Stream >> fVal;
+            matRR(i, j) = fVal * 0.001f;
+        }
+    }
+
+    matTris.resize(nface, 3);
+    for(qint32 i = 0; i < nface; ++i) {
+        for(qint32 j = 0; j < 3; ++j) {
+            t_Stream >> matTris(i, j);
+        }
+    }
+
+    return t_Stream.status() == QDataStream::Ok;
+}
+
+//*************************************************************************************************************
+
+/**
+* Per element reference reader for new style curvature files.
+*/
+bool readCurvature(const QString& sFile, VectorXf& vecCurv)
+{
+    QFile t_File(sFile);
+    if(!t_File.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream t_Stream(&t_File);
+    t_Stream.setByteOrder(QDataStream::BigEndian);
+    t_Stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    if(read3(t_Stream) != 16777215) {
+        return false;
+    }
+
+    qint32 vnum, fnum, valsPerVertex;
+    t_Stream >> vnum >> fnum >> valsPerVertex;
+
+    vecCurv.resize(vnum);
+    for(qint32 i = 0; i < vnum; ++i) {
+        t_Stream >> vecCurv[i];
+    }
+
+    return t_Stream.status() == QDataStream::Ok;
+}
+
+//*************************************************************************************************************
+
+/**
+* Per element reference reader for the vertex/label pairs of an annotation file.
+*/
+bool readAnnotation(const QString& sFile, VectorXi& vecVertices, VectorXi& vecLabelIds)
+{
+    QFile t_File(sFile);
+    if(!t_File.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream t_Stream(&t_File);
+    t_Stream.setByteOrder(QDataStream::BigEndian);
+
+    qint32 numEl;
+    t_Stream >> numEl;
+
+    vecVertices.resize(numEl);
+    vecLabelIds.resize(numEl);
+    for(qint32 i = 0; i < numEl; ++i) {
+        t_Stream >> vecVertices[i] >> vecLabelIds[i];
+    }
+
+    return t_Stream.status() == QDataStream::Ok;
+}
+
+//*************************************************************************************************************
+
+/**
+* Vertex normals as computed by Surface::compute_normals: each vertex takes the normal of the last triangle it
+* belongs to.
+*/
+MatrixX3f vertexNormals(const MatrixX3f& matRR, const MatrixX3i& matTris)
+{
+    MatrixX3f matNN = MatrixX3f::Zero(matRR.rows(), 3);
+
+    for(qint32 p = 0; p < matTris.rows(); ++p) {
+        Vector3f r1 = matRR.row(matTris(p, 0)).transpose();
+        Vector3f x = matRR.row(matTris(p, 1)).transpose() - r1;
+        Vector3f y = matRR.row(matTris(p, 2)).transpose() - r1;
+        Vector3f nn = x.cross(y);
+        if(nn.norm() != 0) {
+            nn.normalize();
+        }
+
+        for(qint32 j = 0; j < 3; ++j) {
+            matNN.row(matTris(p, j)) = nn.transpose();
+        }
+    }
+
+    return matNN;
+}
+
+} // NAMESPACE
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFsSurfaceIo
+*
+* @brief The TestFsSurfaceIo class compares the bulk surface, curvature and annotation readers with per element
+*        reference readers and the bulk byte swaps with the scalar ones
+*
+*/
+class TestFsSurfaceIo: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFsSurfaceIo();
+
+private slots:
+    void initTestCase();
+    void compareSwaps();
+    void compareSurface();
+    void compareCurvature();
+    void compareAnnotation();
+    void rejectTruncatedCurvature();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+
+    QString m_sSurfFile;
+    QString m_sCurvFile;
+    QString m_sAnnotFile;
+
+    QTemporaryDir m_tempDir;
+};
+
+
+//*************************************************************************************************************
+
+TestFsSurfaceIo::TestFsSurfaceIo()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    m_sSurfFile = QDir::currentPath() + "/mne-cpp-test-data/subjects/sample/surf/lh.white";
+    m_sCurvFile = QDir::currentPath() + "/mne-cpp-test-data/subjects/sample/surf/lh.curv";
+    m_sAnnotFile = QDir::currentPath() + "/mne-cpp-test-data/subjects/sample/label/lh.aparc.annot";
+
+    QVERIFY(QFile::exists(m_sSurfFile));
+    QVERIFY(QFile::exists(m_sCurvFile));
+    QVERIFY(QFile::exists(m_sAnnotFile));
+    QVERIFY(m_tempDir.isValid());
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::compareSwaps()
+{
+    // Counts around typical vector widths leave loop remainders
+    QList<qint32> lCounts;
+    lCounts << 0 << 1 << 3 << 7 << 8 << 17 << 1001;
+
+    for(int c = 0; c < lCounts.size(); ++c) {
+        const qint32 iCount = lCounts.at(c);
+
+        QVector<qint16> vecShorts(iCount);
+        QVector<qint32> vecInts(iCount);
+        QVector<float> vecFloats(iCount);
+        for(qint32 i = 0; i < iCount; ++i) {
+            vecShorts[i] = static_cast<qint16>(i * 263 - 30000);
+            vecInts[i] = i * 2654435 - 1234567;
+            // Keep the swapped bit patterns away from NaN, swap_float returns by value
+            vecFloats[i] = 1.0f + 0.25f * i;
+        }
+
+        QVector<qint16> vecShortsSwapped = vecShorts;
+        QVector<qint32> vecIntsSwapped = vecInts;
+        QVector<float> vecFloatsSwapped = vecFloats;
+        IOUtils::swap_shortp(vecShortsSwapped.data(), iCount);
+        IOUtils::swap_intp(vecIntsSwapped.data(), iCount);
+        IOUtils::swap_floatp(vecFloatsSwapped.data(), iCount);
+
+        for(qint32 i = 0; i < iCount; ++i) {
+            QCOMPARE(vecShortsSwapped[i], IOUtils::swap_short(vecShorts[i]));
+            QCOMPARE(vecIntsSwapped[i], IOUtils::swap_int(vecInts[i]));
+
+            const float fReference = IOUtils::swap_float(vecFloats[i]);
+            QVERIFY(memcmp(&vecFloatsSwapped[i], &fReference, sizeof(float)) == 0);
+        }
+
+        // Swapping twice restores the values
+        IOUtils::swap_intp(vecIntsSwapped.data(), iCount);
+        QVERIFY(vecIntsSwapped == vecInts);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::compareSurface()
+{
+    MatrixX3f matRR;
+    MatrixX3i matTris;
+    QVERIFY(readTriangleSurface(m_sSurfFile, matRR, matTris));
+
+    Surface surf;
+    QVERIFY(Surface::read(m_sSurfFile, surf, false));
+
+    QCOMPARE(surf.hemi(), 0);
+    QCOMPARE(surf.rr().rows(), matRR.rows());
+    QCOMPARE(surf.tris().rows(), matTris.rows());
+    QVERIFY(surf.rr() == matRR);
+    QVERIFY(surf.tris() == matTris);
+
+    QCOMPARE(surf.nn().rows(), matRR.rows());
+    QVERIFY((surf.nn() - vertexNormals(matRR, matTris)).cwiseAbs().maxCoeff() < 1e-5);
+
+    // The curvature is loaded next to the surface
+    Surface surfCurv;
+    QVERIFY(Surface::read(m_sSurfFile, surfCurv, true));
+    QCOMPARE(surfCurv.curv().size(), matRR.rows());
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::compareCurvature()
+{
+    VectorXf vecCurv;
+    QVERIFY(readCurvature(m_sCurvFile, vecCurv));
+
+    VectorXf vecBulk = Surface::read_curv(m_sCurvFile);
+
+    QCOMPARE(vecBulk.size(), vecCurv.size());
+    QVERIFY(vecBulk == vecCurv);
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::compareAnnotation()
+{
+    VectorXi vecVertices, vecLabelIds;
+    QVERIFY(readAnnotation(m_sAnnotFile, vecVertices, vecLabelIds));
+
+    Annotation annot;
+    QVERIFY(Annotation::read(m_sAnnotFile, annot));
+
+    QCOMPARE(annot.getVertices().size(), vecVertices.size());
+    QVERIFY(annot.getVertices() == vecVertices);
+    QVERIFY(annot.getLabelIds() == vecLabelIds);
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::rejectTruncatedCurvature()
+{
+    QFile t_File(m_sCurvFile);
+    QVERIFY(t_File.open(QIODevice::ReadOnly));
+    const QByteArray data = t_File.readAll();
+    t_File.close();
+
+    // Cut into the values
+    const QString sFile = m_tempDir.path() + "/lh.curv";
+    QFile t_FileTruncated(sFile);
+    QVERIFY(t_FileTruncated.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(t_FileTruncated.write(data.left(data.size() - 5)), static_cast<qint64>(data.size() - 5));
+    t_FileTruncated.close();
+
+    QCOMPARE(Surface::read_curv(sFile).size(), static_cast<Eigen::Index>(0));
+}
+
+
+//*************************************************************************************************************
+
+void TestFsSurfaceIo::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFsSurfaceIo)
+#include "test_fs_surface_io.moc"
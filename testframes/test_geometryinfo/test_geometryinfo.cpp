@@ -77,6 +77,8 @@ private slots:
     void testEmptyInputsForProjecting();
     void testEmptyInputsForSCDC();
     void testDimensionsForSCDC();
+    void testVertexIndexQueries();
+    void testSparseSCDC();
     void cleanupTestCase();
 
 private:
@@ -200,6 +202,81 @@ void TestGeometryInfo::testDimensionsForSCDC() {
 }
 
 
+//*************************************************************************************************************
+
+void TestGeometryInfo::testVertexIndexQueries() {
+    VertexKdTree::ConstSPtr pIndex = GeometryInfo::vertexIndex(realSurface.rr);
+    QVERIFY(pIndex->size() == realSurface.rr.rows());
+
+    // the index is cached per surface
+    QVERIFY(GeometryInfo::vertexIndex(realSurface.rr) == pIndex);
+
+    const qint32 k = 5;
+    const float fRadius = 0.02f;
+
+    QVector<Vector3f> vecPoints;
+    for(qint32 i = 0; i < 50; ++i) {
+        vecPoints.push_back(realSurface.rr.row(rand() % realSurface.rr.rows()).transpose() + 0.01f * Vector3f::Random());
+    }
+
+    QVector<qint32> vecNearest = GeometryInfo::projectSensors(realSurface.rr, vecPoints);
+    QVector<QVector<qint32> > vecKNearest = pIndex->kNearestNeighbors(vecPoints, k);
+    QVector<QVector<qint32> > vecInRadius = pIndex->radiusSearch(vecPoints, fRadius);
+
+    // compare with linear search
+    for(qint32 p = 0; p < vecPoints.size(); ++p) {
+        QVector<QPair<float, qint32> > vecDists;
+        QVector<qint32> vecExpectedInRadius;
+        for(qint32 i = 0; i < realSurface.rr.rows(); ++i) {
+            const float fDist = (realSurface.rr.row(i).transpose() - vecPoints[p]).squaredNorm();
+            vecDists.push_back(qMakePair(fDist, i));
+            if(fDist <= fRadius * fRadius) {
+                vecExpectedInRadius.push_back(i);
+            }
+        }
+        std::sort(vecDists.begin(), vecDists.end());
+
+        QCOMPARE(vecNearest[p], vecDists[0].second);
+        QCOMPARE(vecKNearest[p].size(), k);
+        for(qint32 j = 0; j < k; ++j) {
+            QCOMPARE(vecKNearest[p][j], vecDists[j].second);
+        }
+        QCOMPARE(vecInRadius[p], vecExpectedInRadius);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryInfo::testSparseSCDC() {
+    const double dCancelDist = 0.03;
+    QVector<qint32> vecSubset;
+    for(qint32 i = 0; i < realSurface.rr.rows(); i += 50) {
+        vecSubset.push_back(i);
+    }
+
+    QSharedPointer<MatrixXd> matDense = GeometryInfo::scdc(realSurface.rr, realSurface.neighbor_vert, vecSubset, dCancelDist);
+    QSharedPointer<SparseMatrix<double, RowMajor> > matSparse = GeometryInfo::scdcSparse(realSurface.rr, realSurface.neighbor_vert, vecSubset, dCancelDist);
+
+    QCOMPARE(matSparse->rows(), matDense->rows());
+    QCOMPARE(matSparse->cols(), matDense->cols());
+
+    // every distance within the cancel distance has to be stored with the same value, all others must be missing
+    MatrixXd matSparseAsDense = MatrixXd(*matSparse);
+    qint32 iNumWithin = 0;
+    for(qint32 r = 0; r < matDense->rows(); ++r) {
+        for(qint32 c = 0; c < matDense->cols(); ++c) {
+            const double dDist = matDense->coeff(r, c);
+            if(dDist <= dCancelDist) {
+                QVERIFY(std::fabs(matSparseAsDense(r, c) - dDist) < 1e-9);
+                ++iNumWithin;
+            }
+        }
+    }
+    QCOMPARE(static_cast<qint32>(matSparse->nonZeros()), iNumWithin);
+}
+
+
 //*************************************************************************************************************
 
 void TestGeometryInfo::cleanupTestCase() {
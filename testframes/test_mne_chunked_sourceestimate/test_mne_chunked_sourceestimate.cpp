@@ -0,0 +1,314 @@
+//=============================================================================================================
+/**
+* @file     test_mne_chunked_sourceestimate.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for converting, reading and slicing chunked source estimates
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/mne_sourceestimate.h>
+#include <mne/mne_chunked_sourceestimate.h>
+#include <mne/mne_chunked_sourceestimate_writer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneChunkedSourceEstimate
+*
+* @brief The TestMneChunkedSourceEstimate class converts a stc file to the chunked format and compares the slices
+*        with MNESourceEstimate::read
+*
+*/
+class TestMneChunkedSourceEstimate: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneChunkedSourceEstimate();
+
+private slots:
+    void initTestCase();
+    void compareHeader();
+    void compareFullData();
+    void compareSlices();
+    void compareSourceEstimate();
+    void rejectTruncatedFile();
+    void rejectCorruptTileIndex();
+    void cleanupTestCase();
+
+private:
+    bool copyFile(const QString& sFrom, const QString& sTo, qint64 iSize = -1);
+
+    double epsilon;
+
+    QTemporaryDir m_tempDir;
+    QString m_sStcFile;
+    QString m_sChunkedFile;
+
+    MNESourceEstimate m_stcRef;
+};
+
+
+//*************************************************************************************************************
+
+TestMneChunkedSourceEstimate::TestMneChunkedSourceEstimate()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QVERIFY(m_tempDir.isValid());
+
+    m_sStcFile = m_tempDir.path() + "/test-lh.stc";
+    m_sChunkedFile = m_tempDir.path() + "/test-lh.cstc";
+
+    //
+    //   Write a source estimate whose size is not a multiple of the tile size
+    //
+    const qint32 iNumVertices = 250;
+    const qint32 iNumTimes = 101;
+
+    VectorXi vecVertices(iNumVertices);
+    for(qint32 i = 0; i < iNumVertices; ++i) {
+        vecVertices[i] = 3 * i + 1;
+    }
+
+    std::srand(42);
+    MatrixXd matData = MatrixXd::Random(iNumVertices, iNumTimes) * 1e-9;
+
+    MNESourceEstimate stc(matData, vecVertices, -0.1f, 0.001f);
+    QFile t_fileStc(m_sStcFile);
+    QVERIFY(stc.write(t_fileStc));
+
+    //
+    //   Convert with tiles which do not divide the sizes
+    //
+    QFile t_fileStcIn(m_sStcFile);
+    QVERIFY(MNEChunkedSourceEstimateWriter::convert(t_fileStcIn, m_sChunkedFile, 37, 13));
+
+    //
+    //   Reference
+    //
+    QFile t_fileStcRef(m_sStcFile);
+    QVERIFY(MNESourceEstimate::read(t_fileStcRef, m_stcRef));
+    QCOMPARE(static_cast<qint32>(m_stcRef.data.rows()), iNumVertices);
+    QCOMPARE(static_cast<qint32>(m_stcRef.data.cols()), iNumTimes);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::compareHeader()
+{
+    MNEChunkedSourceEstimate chunked(m_sChunkedFile);
+
+    QVERIFY(chunked.isOpen());
+    QCOMPARE(chunked.samples(), static_cast<qint32>(m_stcRef.data.cols()));
+    QVERIFY(chunked.vertices() == m_stcRef.vertices);
+    QVERIFY(std::fabs(chunked.tmin() - m_stcRef.tmin) < epsilon);
+    QVERIFY(std::fabs(chunked.tstep() - m_stcRef.tstep) < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::compareFullData()
+{
+    MNEChunkedSourceEstimate chunked(m_sChunkedFile);
+
+    MatrixXf matSlice = chunked.slice(0, m_stcRef.data.rows(), 0, m_stcRef.data.cols());
+
+    QCOMPARE(matSlice.rows(), m_stcRef.data.rows());
+    QCOMPARE(matSlice.cols(), m_stcRef.data.cols());
+
+    // Both hold the single precision values stored in the stc file
+    QVERIFY((matSlice.cast<double>() - m_stcRef.data).cwiseAbs().maxCoeff() == 0.0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::compareSlices()
+{
+    MNEChunkedSourceEstimate chunked(m_sChunkedFile);
+
+    // Slices inside one tile, across tile borders and touching the last, partial tiles
+    QList<QVector<qint32> > lSlices;
+    lSlices << (QVector<qint32>() << 0 << 1 << 0 << 1)
+            << (QVector<qint32>() << 5 << 20 << 3 << 7)
+            << (QVector<qint32>() << 30 << 50 << 10 << 20)
+            << (QVector<qint32>() << 36 << 2 << 12 << 2)
+            << (QVector<qint32>() << 200 << 50 << 90 << 11)
+            << (QVector<qint32>() << 249 << 1 << 100 << 1);
+
+    for(int i = 0; i < lSlices.size(); ++i) {
+        const QVector<qint32>& s = lSlices.at(i);
+        MatrixXf matSlice = chunked.slice(s[0], s[1], s[2], s[3]);
+
+        QCOMPARE(static_cast<qint32>(matSlice.rows()), s[1]);
+        QCOMPARE(static_cast<qint32>(matSlice.cols()), s[3]);
+        QVERIFY((matSlice.cast<double>() - m_stcRef.data.block(s[0], s[2], s[1], s[3])).cwiseAbs().maxCoeff() == 0.0);
+    }
+
+    // Invalid ranges give an empty slice
+    QVERIFY(chunked.slice(-1, 2, 0, 1).size() == 0);
+    QVERIFY(chunked.slice(0, 251, 0, 1).size() == 0);
+    QVERIFY(chunked.slice(0, 1, 100, 2).size() == 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::compareSourceEstimate()
+{
+    MNEChunkedSourceEstimate chunked(m_sChunkedFile);
+
+    MNESourceEstimate stc = chunked.sourceEstimate(20, 30);
+    MNESourceEstimate stcRef = m_stcRef.reduce(20, 30);
+
+    QVERIFY(stc.vertices == stcRef.vertices);
+    QVERIFY(std::fabs(stc.tmin - stcRef.tmin) < epsilon);
+    QVERIFY((stc.data - stcRef.data).cwiseAbs().maxCoeff() == 0.0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::rejectTruncatedFile()
+{
+    QFile t_file(m_sChunkedFile);
+    const qint64 iSize = t_file.size();
+
+    // Cut into the tile index and into the tiles
+    QList<qint64> lSizes;
+    lSizes << iSize - 1 << iSize / 2 << MNEChunkedSourceEstimate::HEADER_SIZE + 10;
+
+    for(int i = 0; i < lSizes.size(); ++i) {
+        const QString sFile = m_tempDir.path() + QString("/truncated_%1.cstc").arg(i);
+        QVERIFY(copyFile(m_sChunkedFile, sFile, lSizes.at(i)));
+
+        MNEChunkedSourceEstimate chunked;
+        QVERIFY(!chunked.open(sFile));
+        QVERIFY(!chunked.isOpen());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::rejectCorruptTileIndex()
+{
+    const QString sFile = m_tempDir.path() + "/corrupt.cstc";
+    QVERIFY(copyFile(m_sChunkedFile, sFile));
+
+    QFile t_file(sFile);
+    QVERIFY(t_file.open(QIODevice::ReadWrite));
+
+    QDataStream t_stream(&t_file);
+    t_stream.setByteOrder(QDataStream::LittleEndian);
+
+    // The index offset is the last header entry
+    quint64 iIndexOffset;
+    t_file.seek(MNEChunkedSourceEstimate::HEADER_SIZE - sizeof(quint64));
+    t_stream >> iIndexOffset;
+
+    // Let the last tile point past the index
+    const qint64 iNumTiles = (t_file.size() - iIndexOffset) / sizeof(quint64);
+    t_file.seek(iIndexOffset + (iNumTiles - 1) * sizeof(quint64));
+    t_stream << static_cast<quint64>(t_file.size() - 4);
+    t_file.close();
+
+    MNEChunkedSourceEstimate chunked;
+    QVERIFY(!chunked.open(sFile));
+    QVERIFY(!chunked.isOpen());
+}
+
+
+//*************************************************************************************************************
+
+void TestMneChunkedSourceEstimate::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+bool TestMneChunkedSourceEstimate::copyFile(const QString& sFrom, const QString& sTo, qint64 iSize)
+{
+    QFile t_fileFrom(sFrom);
+    QFile t_fileTo(sTo);
+
+    if(!t_fileFrom.open(QIODevice::ReadOnly) || !t_fileTo.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    const QByteArray data = iSize < 0 ? t_fileFrom.readAll() : t_fileFrom.read(iSize);
+
+    return t_fileTo.write(data) == data.size();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneChunkedSourceEstimate)
+#include "test_mne_chunked_sourceestimate.moc"
@@ -0,0 +1,235 @@
+//=============================================================================================================
+/**
+* @file     test_mne_cluster_cache.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the clustered forward solution cache
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fs/annotationset.h>
+#include <mne/mne_forwardsolution.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FSLIB;
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneClusterCache
+*
+* @brief The TestMneClusterCache class compares cache hits of the clustered forward solution with cache misses
+*        and checks the eviction of old cache entries
+*
+*/
+class TestMneClusterCache: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneClusterCache();
+
+private slots:
+    void initTestCase();
+    void compareHitWithMiss();
+    void evictOldEntries();
+    void cleanupTestCase();
+
+private:
+    bool touchEntry(const QString& sName);
+
+    double epsilon;
+
+    QTemporaryDir m_tempDir;
+    MNEForwardSolution m_fwd;
+    AnnotationSet m_annotationSet;
+};
+
+
+//*************************************************************************************************************
+
+TestMneClusterCache::TestMneClusterCache()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneClusterCache::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QVERIFY(m_tempDir.isValid());
+
+    QFile t_fileFwd("./MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QVERIFY(t_fileFwd.exists());
+
+    m_fwd = MNEForwardSolution(t_fileFwd);
+    QVERIFY(!m_fwd.isEmpty());
+
+    m_annotationSet = AnnotationSet("sample", 2, "aparc.a2009s", "./MNE-sample-data/subjects");
+    QVERIFY(!m_annotationSet.isEmpty());
+}
+
+
+//*************************************************************************************************************
+
+void TestMneClusterCache::compareHitWithMiss()
+{
+    const QString sCacheDir = m_tempDir.path() + "/hit";
+
+    // Miss: clusters and writes the cache entry
+    MatrixXd matDMiss;
+    MNEForwardSolution fwdMiss = m_fwd.cluster_forward_solution_cached(sCacheDir, m_annotationSet, 40, matDMiss);
+
+    QVERIFY(fwdMiss.isClustered());
+    QCOMPARE(QDir(sCacheDir).entryList(QStringList() << "clustered-fwd-*.fif", QDir::Files).size(), 1);
+
+    // Hit: reads the cache entry
+    MatrixXd matDHit;
+    MNEForwardSolution fwdHit = m_fwd.cluster_forward_solution_cached(sCacheDir, m_annotationSet, 40, matDHit);
+
+    QVERIFY(fwdHit.isClustered());
+
+    // The gain is stored in double precision, a hit has to give exactly the same gain as the miss
+    QCOMPARE(fwdHit.sol->data.rows(), fwdMiss.sol->data.rows());
+    QCOMPARE(fwdHit.sol->data.cols(), fwdMiss.sol->data.cols());
+    QVERIFY(fwdHit.sol->data == fwdMiss.sol->data);
+    QCOMPARE(fwdHit.sol->ncol, fwdMiss.sol->ncol);
+    QCOMPARE(fwdHit.nsource, fwdMiss.nsource);
+
+    QCOMPARE(matDHit.rows(), matDMiss.rows());
+    QCOMPARE(matDHit.cols(), matDMiss.cols());
+    QVERIFY((matDHit - matDMiss).cwiseAbs().maxCoeff() < epsilon);
+
+    for(qint32 h = 0; h < fwdMiss.src.size(); ++h) {
+        const MNEClusterInfo& infoMiss = fwdMiss.src[h].cluster_info;
+        const MNEClusterInfo& infoHit = fwdHit.src[h].cluster_info;
+
+        QVERIFY(fwdHit.src[h].vertno == fwdMiss.src[h].vertno);
+        QCOMPARE(infoHit.clusterLabelIds, infoMiss.clusterLabelIds);
+        QCOMPARE(infoHit.clusterLabelNames, infoMiss.clusterLabelNames);
+        QCOMPARE(infoHit.centroidVertno, infoMiss.centroidVertno);
+        QCOMPARE(infoHit.clusterVertnos.size(), infoMiss.clusterVertnos.size());
+
+        for(qint32 i = 0; i < infoMiss.clusterVertnos.size(); ++i) {
+            QVERIFY(infoHit.clusterVertnos[i] == infoMiss.clusterVertnos[i]);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneClusterCache::evictOldEntries()
+{
+    const QString sCacheDir = m_tempDir.path() + "/evict";
+    QVERIFY(QDir().mkpath(sCacheDir));
+
+    // Entries are evicted by their write time, give each its own second
+    QStringList lOld;
+    lOld << "clustered-fwd-old0.fif" << "clustered-fwd-old1.fif" << "clustered-fwd-old2.fif";
+    for(int i = 0; i < lOld.size(); ++i) {
+        QVERIFY(touchEntry(sCacheDir + "/" + lOld.at(i)));
+        QTest::qSleep(1100);
+    }
+
+    // Files which are no cache entries are never removed
+    QVERIFY(touchEntry(sCacheDir + "/readme.txt"));
+
+    QCOMPARE(MNEForwardSolution::prune_cluster_cache(sCacheDir, 2), 1);
+    QVERIFY(!QFile::exists(sCacheDir + "/" + lOld.at(0)));
+    QVERIFY(QFile::exists(sCacheDir + "/" + lOld.at(1)));
+    QVERIFY(QFile::exists(sCacheDir + "/" + lOld.at(2)));
+    QVERIFY(QFile::exists(sCacheDir + "/readme.txt"));
+
+    // A new entry pushes out the oldest remaining one
+    MatrixXd matD;
+    MNEForwardSolution fwd = m_fwd.cluster_forward_solution_cached(sCacheDir, m_annotationSet, 40, matD, FiffCov(), FiffInfo(), "cityblock", 2);
+    QVERIFY(fwd.isClustered());
+
+    const QStringList lEntries = QDir(sCacheDir).entryList(QStringList() << "clustered-fwd-*.fif", QDir::Files);
+    QCOMPARE(lEntries.size(), 2);
+    QVERIFY(!lEntries.contains(lOld.at(1)));
+    QVERIFY(lEntries.contains(lOld.at(2)));
+}
+
+
+//*************************************************************************************************************
+
+void TestMneClusterCache::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+bool TestMneClusterCache::touchEntry(const QString& sName)
+{
+    QFile t_file(sName);
+
+    if(!t_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    return t_file.write("x", 1) == 1;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneClusterCache)
+#include "test_mne_cluster_cache.moc"
@@ -0,0 +1,354 @@
+//=============================================================================================================
+/**
+* @file     test_mne_epoch_tensor.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for the contiguous epoch tensor
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <mne/mne_epoch_data_list.h>
+#include <mne/mne_epoch_tensor.h>
+
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneEpochTensor
+*
+* @brief The TestMneEpochTensor class compares the epoch tensor against the epoch list implementation
+*
+*/
+class TestMneEpochTensor: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneEpochTensor();
+
+private slots:
+    void initTestCase();
+    void compareEpochs();
+    void compareAverage();
+    void compareThresholdRejection();
+    void compareVarianceRejection();
+    void compareDropRejected();
+    void cleanupTestCase();
+
+private:
+    double epsilon;
+
+    float m_fTMin;
+    float m_fTMax;
+    qint32 m_iEvent;
+    double m_dThreshold;
+
+    FiffRawData m_raw;
+    MatrixXi m_events;
+
+    MNEEpochDataList m_lEpochsRef;
+    MNEEpochTensorD m_tensor;
+};
+
+
+//*************************************************************************************************************
+
+TestMneEpochTensor::TestMneEpochTensor()
+: epsilon(0.000001)
+, m_fTMin(-0.1f)
+, m_fTMax(0.4f)
+, m_iEvent(1)
+, m_dThreshold(0.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+
+    m_raw = FiffRawData(t_fileIn);
+
+    QVERIFY(m_raw.info.nchan > 0);
+
+    //
+    //   Artificial events every 0.7 s, so that the epochs overlap buffer boundaries at different positions
+    //
+    const fiff_int_t iStep = static_cast<fiff_int_t>(0.7f * m_raw.info.sfreq);
+    const qint32 iNumEvents = (m_raw.last_samp - m_raw.first_samp) / iStep;
+
+    m_events = MatrixXi::Zero(iNumEvents, 3);
+    for(qint32 i = 0; i < iNumEvents; ++i) {
+        m_events(i, 0) = m_raw.first_samp + (i + 1) * iStep;
+        m_events(i, 2) = m_iEvent;
+    }
+
+    //
+    //   Reference epochs, read one by one
+    //
+    for(qint32 i = 0; i < m_events.rows(); ++i) {
+        fiff_int_t from = m_events(i, 0) + m_fTMin * m_raw.info.sfreq;
+        fiff_int_t to = m_events(i, 0) + floor(m_fTMax * m_raw.info.sfreq + 0.5);
+
+        if(from < m_raw.first_samp || to > m_raw.last_samp) {
+            continue;
+        }
+
+        MNEEpochData::SPtr epoch = MNEEpochData::SPtr(new MNEEpochData());
+        MatrixXd times;
+        QVERIFY(m_raw.read_raw_segment(epoch->epoch, times, from, to));
+        epoch->event = m_iEvent;
+        epoch->tmin = ((float)(from) - (float)(m_raw.first_samp)) / m_raw.info.sfreq;
+        epoch->tmax = ((float)(to) - (float)(m_raw.first_samp)) / m_raw.info.sfreq;
+        m_lEpochsRef.append(epoch);
+    }
+
+    QVERIFY(m_lEpochsRef.size() > 2);
+
+    //
+    //   Threshold in the middle of the EOG peak to peak values, so that some epochs are rejected and some are not
+    //
+    const QList<int> lChannels = MNEEpochDataList::artifactChannels(m_raw.info, QString("eog"));
+    QVERIFY(!lChannels.isEmpty());
+
+    QVector<double> vecRanges;
+    for(qint32 i = 0; i < m_lEpochsRef.size(); ++i) {
+        const RowVectorXd row = m_lEpochsRef.at(i)->epoch.row(lChannels.first());
+        vecRanges.append((row.array() - row(0)).abs().maxCoeff());
+    }
+    std::sort(vecRanges.begin(), vecRanges.end());
+    m_dThreshold = vecRanges.at(vecRanges.size() / 2);
+
+    for(qint32 i = 0; i < m_lEpochsRef.size(); ++i) {
+        m_lEpochsRef[i]->bReject = MNEEpochDataList::checkForArtifact(m_lEpochsRef[i]->epoch,
+                                                                      m_raw.info,
+                                                                      m_dThreshold,
+                                                                      QString("threshold"),
+                                                                      QString("eog"));
+    }
+
+    //
+    //   Read the same epochs into the contiguous tensor
+    //
+    m_tensor = MNEEpochDataList::readEpochTensor(m_raw,
+                                                 m_events,
+                                                 m_fTMin,
+                                                 m_fTMax,
+                                                 m_iEvent,
+                                                 m_dThreshold,
+                                                 QString("eog"));
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::compareEpochs()
+{
+    QCOMPARE(m_tensor.epochs(), m_lEpochsRef.size());
+    QCOMPARE(m_tensor.channels(), static_cast<qint32>(m_lEpochsRef.first()->epoch.rows()));
+    QCOMPARE(m_tensor.times(), static_cast<qint32>(m_lEpochsRef.first()->epoch.cols()));
+
+    for(qint32 i = 0; i < m_tensor.epochs(); ++i) {
+        MatrixXd data_diff = m_tensor.epoch(i) - m_lEpochsRef.at(i)->epoch;
+        QVERIFY(data_diff.cwiseAbs().maxCoeff() < epsilon);
+        QCOMPARE(m_tensor.event(i), m_lEpochsRef.at(i)->event);
+        QCOMPARE(m_tensor.tmin(i), m_lEpochsRef.at(i)->tmin);
+        QCOMPARE(m_tensor.tmax(i), m_lEpochsRef.at(i)->tmax);
+    }
+
+    // The list reader is a copy of the tensor
+    MNEEpochDataList lEpochs = MNEEpochDataList::readEpochs(m_raw,
+                                                            m_events,
+                                                            m_fTMin,
+                                                            m_fTMax,
+                                                            m_iEvent,
+                                                            m_dThreshold,
+                                                            QString("eog"));
+    QCOMPARE(lEpochs.size(), m_lEpochsRef.size());
+
+    for(qint32 i = 0; i < lEpochs.size(); ++i) {
+        MatrixXd data_diff = lEpochs.at(i)->epoch - m_lEpochsRef.at(i)->epoch;
+        QVERIFY(data_diff.cwiseAbs().maxCoeff() < epsilon);
+        QCOMPARE(lEpochs.at(i)->bReject, m_lEpochsRef.at(i)->bReject);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::compareAverage()
+{
+    FiffEvoked evokedRef = m_lEpochsRef.average(m_raw.info, m_raw.first_samp, m_raw.last_samp);
+    FiffEvoked evoked = m_tensor.average(m_raw.info, m_raw.first_samp, m_raw.last_samp);
+
+    QCOMPARE(evoked.nave, evokedRef.nave);
+    QCOMPARE(evoked.first, evokedRef.first);
+    QCOMPARE(evoked.last, evokedRef.last);
+    QCOMPARE(evoked.data.rows(), evokedRef.data.rows());
+    QCOMPARE(evoked.data.cols(), evokedRef.data.cols());
+    QVERIFY((evoked.data - evokedRef.data).cwiseAbs().maxCoeff() < epsilon);
+    QVERIFY((evoked.times - evokedRef.times).cwiseAbs().maxCoeff() < epsilon);
+
+    // Average of a selection
+    VectorXi sel(2);
+    sel << 0, m_lEpochsRef.size() - 1;
+
+    evokedRef = m_lEpochsRef.average(m_raw.info, m_raw.first_samp, m_raw.last_samp, sel);
+    evoked = m_tensor.average(m_raw.info, m_raw.first_samp, m_raw.last_samp, sel);
+
+    QCOMPARE(evoked.nave, evokedRef.nave);
+    QVERIFY((evoked.data - evokedRef.data).cwiseAbs().maxCoeff() < epsilon);
+
+    MatrixXd matAverage = m_tensor.average(sel);
+    QVERIFY((matAverage - evokedRef.data).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::compareThresholdRejection()
+{
+    qint32 iRejectedRef = 0;
+
+    for(qint32 i = 0; i < m_lEpochsRef.size(); ++i) {
+        QCOMPARE(m_tensor.isRejected(i), m_lEpochsRef.at(i)->bReject);
+        if(m_lEpochsRef.at(i)->bReject) {
+            ++iRejectedRef;
+        }
+    }
+
+    // The threshold is the median, both cases need to be covered
+    QVERIFY(iRejectedRef > 0);
+    QVERIFY(iRejectedRef < m_lEpochsRef.size());
+
+    MNEEpochTensorD tensor = m_tensor;
+    QCOMPARE(tensor.checkForArtifacts(m_raw.info, m_dThreshold, QString("threshold"), QString("eog")), iRejectedRef);
+    QCOMPARE(tensor.rejectedCount(), iRejectedRef);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::compareVarianceRejection()
+{
+    MNEEpochTensorD tensor = m_tensor;
+    const QList<int> lChannels = MNEEpochDataList::artifactChannels(m_raw.info, QString("eog"));
+
+    QList<double> lThresholds;
+    lThresholds << 0.5 << 1.0 << 2.0;
+
+    for(int t = 0; t < lThresholds.size(); ++t) {
+        tensor.checkForArtifacts(m_raw.info, lThresholds.at(t), QString("variance"), QString("eog"));
+
+        for(qint32 i = 0; i < m_lEpochsRef.size(); ++i) {
+            MatrixXd matEpoch = m_lEpochsRef.at(i)->epoch;
+            bool bRejectRef = MNEEpochDataList::checkForArtifact(matEpoch,
+                                                                 m_raw.info,
+                                                                 lThresholds.at(t),
+                                                                 QString("variance"),
+                                                                 QString("eog"));
+
+            QCOMPARE(tensor.isRejected(i), bRejectRef);
+            QCOMPARE(tensor.checkForArtifact(i, lChannels, lThresholds.at(t), QString("variance")), bRejectRef);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::compareDropRejected()
+{
+    MNEEpochDataList lEpochsRef = m_lEpochsRef;
+    MNEEpochTensorD tensor = m_tensor;
+
+    lEpochsRef.dropRejected();
+    tensor.dropRejected();
+
+    QCOMPARE(tensor.epochs(), lEpochsRef.size());
+
+    for(qint32 i = 0; i < tensor.epochs(); ++i) {
+        QVERIFY(!tensor.isRejected(i));
+        QCOMPARE(tensor.tmin(i), lEpochsRef.at(i)->tmin);
+        MatrixXd data_diff = tensor.epoch(i) - lEpochsRef.at(i)->epoch;
+        QVERIFY(data_diff.cwiseAbs().maxCoeff() < epsilon);
+    }
+
+    FiffEvoked evokedRef = lEpochsRef.average(m_raw.info, m_raw.first_samp, m_raw.last_samp);
+    FiffEvoked evoked = tensor.average(m_raw.info, m_raw.first_samp, m_raw.last_samp);
+
+    QCOMPARE(evoked.nave, evokedRef.nave);
+    QVERIFY((evoked.data - evokedRef.data).cwiseAbs().maxCoeff() < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneEpochTensor::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneEpochTensor)
+#include "test_mne_epoch_tensor.moc"
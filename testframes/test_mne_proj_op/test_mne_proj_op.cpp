@@ -0,0 +1,281 @@
+//=============================================================================================================
+/**
+* @file     test_mne_proj_op.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for applying the MNE projection operator to vectors
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/c/mne_proj_op.h>
+#include <mne/c/mne_named_matrix.h>
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef FAIL
+#define FAIL -1
+#endif
+
+#ifndef OK
+#define OK 0
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneProjOp
+*
+* @brief The TestMneProjOp class compares mne_proj_op_proj_vector with the dense projection I - V^T V
+*
+*/
+class TestMneProjOp: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneProjOp();
+
+private slots:
+    void initTestCase();
+    void compareWithDenseProjection();
+    void compareWorkSpaces();
+    void projectConcurrently();
+    void rejectSizeMismatch();
+    void cleanupTestCase();
+
+private:
+    static float** allocMatrix(int nrow, int ncol);
+
+    double epsilon;
+
+    int m_iNChan;
+    int m_iNVec;
+    MatrixXd m_matVecs;     /**< Orthonormal projection vectors (rows). */
+    MatrixXd m_matData;     /**< Test vectors (columns). */
+    MneProjOp* m_pProjOp;
+};
+
+
+//*************************************************************************************************************
+
+TestMneProjOp::TestMneProjOp()
+: epsilon(0.000001)
+, m_iNChan(64)
+, m_iNVec(5)
+, m_pProjOp(NULL)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjOp::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    std::srand(42);
+
+    // Orthonormal projection vectors
+    HouseholderQR<MatrixXd> qr(MatrixXd::Random(m_iNChan, m_iNVec));
+    m_matVecs = (qr.householderQ() * MatrixXd::Identity(m_iNChan, m_iNVec)).transpose();
+
+    m_matData = MatrixXd::Random(m_iNChan, 200);
+
+    // The operator needs an item to be active, the projector itself is set up directly
+    QStringList lRows, lCols;
+    for(int p = 0; p < m_iNVec; ++p) {
+        lRows << QString("PCA-%1").arg(p);
+    }
+    for(int k = 0; k < m_iNChan; ++k) {
+        lCols << QString("MEG %1").arg(k, 4, 10, QChar('0'));
+    }
+
+    float** pItemData = allocMatrix(m_iNVec, m_iNChan);
+    float** pProjData = allocMatrix(m_iNVec, m_iNChan);
+    for(int p = 0; p < m_iNVec; ++p) {
+        for(int k = 0; k < m_iNChan; ++k) {
+            pItemData[p][k] = pProjData[p][k] = (float) m_matVecs(p, k);
+        }
+    }
+
+    MneNamedMatrix* pVecs = MneNamedMatrix::build_named_matrix(m_iNVec, m_iNChan, lRows, lCols, pItemData);
+
+    m_pProjOp = new MneProjOp();
+    MneProjOp::mne_proj_op_add_item(m_pProjOp, pVecs, FIFFV_PROJ_ITEM_FIELD, "test");
+    delete pVecs;
+
+    m_pProjOp->nch = m_iNChan;
+    m_pProjOp->nvec = m_iNVec;
+    m_pProjOp->proj_data = pProjData;
+
+    QCOMPARE(m_pProjOp->nitems, 1);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjOp::compareWithDenseProjection()
+{
+    MatrixXd matProj = m_matVecs.transpose() * m_matVecs;
+    MatrixXd matCompl = MatrixXd::Identity(m_iNChan, m_iNChan) - matProj;
+
+    VectorXf vecWork(m_iNChan);
+
+    for(int s = 0; s < m_matData.cols(); ++s) {
+        VectorXf vec = m_matData.col(s).cast<float>();
+        QCOMPARE(MneProjOp::mne_proj_op_proj_vector(m_pProjOp, vec.data(), m_iNChan, TRUE, vecWork.data()), OK);
+        QVERIFY((vec.cast<double>() - matCompl * m_matData.col(s)).cwiseAbs().maxCoeff() < 1e-5);
+
+        vec = m_matData.col(s).cast<float>();
+        QCOMPARE(MneProjOp::mne_proj_op_proj_vector(m_pProjOp, vec.data(), m_iNChan, FALSE, vecWork.data()), OK);
+        QVERIFY((vec.cast<double>() - matProj * m_matData.col(s)).cwiseAbs().maxCoeff() < 1e-5);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjOp::compareWorkSpaces()
+{
+    VectorXf vecWork(m_iNChan);
+
+    for(int s = 0; s < m_matData.cols(); ++s) {
+        VectorXf vecOwn = m_matData.col(s).cast<float>();
+        VectorXf vecOp = vecOwn;
+
+        QCOMPARE(MneProjOp::mne_proj_op_proj_vector(m_pProjOp, vecOwn.data(), m_iNChan, TRUE, vecWork.data()), OK);
+        QCOMPARE(MneProjOp::mne_proj_op_proj_vector(m_pProjOp, vecOp.data(), m_iNChan, TRUE), OK);
+
+        QVERIFY(vecOwn == vecOp);
+    }
+
+    QVERIFY(m_pProjOp->proj_work != NULL);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjOp::projectConcurrently()
+{
+    MatrixXf matSerial = m_matData.cast<float>();
+    VectorXf vecWork(m_iNChan);
+    for(int s = 0; s < matSerial.cols(); ++s) {
+        QCOMPARE(MneProjOp::mne_proj_op_proj_vector(m_pProjOp, matSerial.col(s).data(), m_iNChan, TRUE, vecWork.data()), OK);
+    }
+
+    // Each worker brings its own work space
+    MatrixXf matConcurrent = m_matData.cast<float>();
+    QVector<int> vecCols(matConcurrent.cols());
+    for(int s = 0; s < vecCols.size(); ++s) {
+        vecCols[s] = s;
+    }
+
+    MneProjOp* pProjOp = m_pProjOp;
+    int iNChan = m_iNChan;
+    QtConcurrent::blockingMap(vecCols, [&matConcurrent, pProjOp, iNChan](const int& s) {
+        VectorXf vecWorkLocal(iNChan);
+        MneProjOp::mne_proj_op_proj_vector(pProjOp, matConcurrent.col(s).data(), iNChan, TRUE, vecWorkLocal.data());
+    });
+
+    QVERIFY(matSerial == matConcurrent);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjOp::rejectSizeMismatch()
+{
+    VectorXf vec = VectorXf::Ones(m_iNChan - 1);
+    QCOMPARE(MneProjOp::mne_proj_op_proj_vector(m_pProjOp, vec.data(), m_iNChan - 1, TRUE), FAIL);
+    QVERIFY(vec == VectorXf::Ones(m_iNChan - 1));
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjOp::cleanupTestCase()
+{
+    delete m_pProjOp;
+}
+
+
+//*************************************************************************************************************
+
+float** TestMneProjOp::allocMatrix(int nrow, int ncol)
+{
+    // Same layout as the MNE-C matrices, which are released with a free of the data and the row pointers
+    float** m = (float **) malloc(nrow*sizeof(float *));
+    m[0] = (float *) malloc(nrow*ncol*sizeof(float));
+    for(int k = 1; k < nrow; ++k) {
+        m[k] = m[k-1] + ncol;
+    }
+    return m;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneProjOp)
+#include "test_mne_proj_op.moc"
@@ -0,0 +1,322 @@
+//=============================================================================================================
+/**
+* @file     test_mne_sourceestimate_io.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test for writing and reading back a source estimate
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/mne_sourceestimate.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneSourceEstimateIo
+*
+* @brief The TestMneSourceEstimateIo class writes a source estimate and compares read, readFloat and
+*        readTimeWindow with the written values
+*
+*/
+class TestMneSourceEstimateIo: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneSourceEstimateIo();
+
+private slots:
+    void initTestCase();
+    void compareRead();
+    void compareReadFloat();
+    void compareReadTimeWindow();
+    void rejectOutOfRangeWindow();
+    void rejectTruncatedFile();
+    void rejectCorruptVertexCount();
+    void cleanupTestCase();
+
+private:
+    bool copyFile(const QString& sFrom, const QString& sTo, qint64 iSize = -1);
+
+    double epsilon;
+
+    QTemporaryDir m_tempDir;
+    QString m_sStcFile;
+
+    MatrixXd m_matData;
+    VectorXi m_vecVertices;
+    float m_fTmin;
+    float m_fTstep;
+};
+
+
+//*************************************************************************************************************
+
+TestMneSourceEstimateIo::TestMneSourceEstimateIo()
+: epsilon(0.000001)
+, m_fTmin(-0.1f)
+, m_fTstep(0.001f)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QVERIFY(m_tempDir.isValid());
+
+    m_sStcFile = m_tempDir.path() + "/test-lh.stc";
+
+    const qint32 iNumVertices = 57;
+    const qint32 iNumTimes = 83;
+
+    m_vecVertices.resize(iNumVertices);
+    for(qint32 i = 0; i < iNumVertices; ++i) {
+        m_vecVertices[i] = 5 * i + 2;
+    }
+
+    // The file stores single precision, keep the reference exactly representable
+    std::srand(7);
+    m_matData = (MatrixXd::Random(iNumVertices, iNumTimes) * 1e-9).cast<float>().cast<double>();
+
+    MNESourceEstimate stc(m_matData, m_vecVertices, m_fTmin, m_fTstep);
+    QFile t_fileStc(m_sStcFile);
+    QVERIFY(stc.write(t_fileStc));
+
+    // header, vertex indices, number of time points and the data
+    QCOMPARE(QFile(m_sStcFile).size(), static_cast<qint64>(4 * (4 + iNumVertices + iNumVertices * iNumTimes)));
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::compareRead()
+{
+    MNESourceEstimate stc;
+    QFile t_file(m_sStcFile);
+    QVERIFY(MNESourceEstimate::read(t_file, stc));
+
+    QVERIFY(stc.vertices == m_vecVertices);
+    QVERIFY(stc.data == m_matData);
+    QVERIFY(std::fabs(stc.tmin - m_fTmin) < epsilon);
+    QVERIFY(std::fabs(stc.tstep - m_fTstep) < epsilon);
+
+    QCOMPARE(stc.times.size(), m_matData.cols());
+    QVERIFY(std::fabs(stc.times[stc.times.size() - 1] - (m_fTmin + (m_matData.cols() - 1) * m_fTstep)) < 1e-5);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::compareReadFloat()
+{
+    MatrixXf matData;
+    VectorXi vecVertices;
+    float fTmin, fTstep;
+
+    QFile t_file(m_sStcFile);
+    QVERIFY(MNESourceEstimate::readFloat(t_file, matData, vecVertices, fTmin, fTstep));
+
+    QVERIFY(vecVertices == m_vecVertices);
+    QVERIFY(matData.cast<double>() == m_matData);
+    QVERIFY(std::fabs(fTmin - m_fTmin) < epsilon);
+    QVERIFY(std::fabs(fTstep - m_fTstep) < epsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::compareReadTimeWindow()
+{
+    // First sample, inner window, last sample and the whole file
+    QList<QPair<qint32, qint32> > lWindows;
+    lWindows << qMakePair(0, 1)
+             << qMakePair(10, 20)
+             << qMakePair(static_cast<qint32>(m_matData.cols()) - 1, 1)
+             << qMakePair(0, static_cast<qint32>(m_matData.cols()));
+
+    for(int i = 0; i < lWindows.size(); ++i) {
+        const qint32 iStart = lWindows.at(i).first;
+        const qint32 iNum = lWindows.at(i).second;
+
+        MNESourceEstimate stc;
+        QFile t_file(m_sStcFile);
+        QVERIFY(MNESourceEstimate::readTimeWindow(t_file, iStart, iNum, stc));
+
+        QVERIFY(stc.vertices == m_vecVertices);
+        QVERIFY(stc.data == m_matData.middleCols(iStart, iNum));
+        QVERIFY(std::fabs(stc.tmin - (m_fTmin + iStart * m_fTstep)) < epsilon);
+        QVERIFY(std::fabs(stc.tstep - m_fTstep) < epsilon);
+        QCOMPARE(stc.times.size(), static_cast<Eigen::Index>(iNum));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::rejectOutOfRangeWindow()
+{
+    const qint32 iNumTimes = m_matData.cols();
+
+    QList<QPair<qint32, qint32> > lWindows;
+    lWindows << qMakePair(-1, 2)
+             << qMakePair(iNumTimes - 3, 4)
+             << qMakePair(iNumTimes, 1)
+             << qMakePair(0, 0)
+             << qMakePair(0, iNumTimes + 1);
+
+    for(int i = 0; i < lWindows.size(); ++i) {
+        MNESourceEstimate stc;
+        QFile t_file(m_sStcFile);
+        QVERIFY(!MNESourceEstimate::readTimeWindow(t_file, lWindows.at(i).first, lWindows.at(i).second, stc));
+        QVERIFY(!t_file.isOpen());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::rejectTruncatedFile()
+{
+    const qint64 iSize = QFile(m_sStcFile).size();
+    const qint64 iNumVertices = m_vecVertices.size();
+
+    // Cut into the header, the vertex indices, the number of time points and the data
+    QList<qint64> lSizes;
+    lSizes << 6 << 12 + 4 * (iNumVertices / 2) << 12 + 4 * iNumVertices + 2 << iSize / 2 << iSize - 1;
+
+    for(int i = 0; i < lSizes.size(); ++i) {
+        const QString sFile = m_tempDir.path() + QString("/truncated_%1-lh.stc").arg(i);
+        QVERIFY(copyFile(m_sStcFile, sFile, lSizes.at(i)));
+
+        MNESourceEstimate stc;
+        QFile t_file(sFile);
+        QVERIFY(!MNESourceEstimate::read(t_file, stc));
+
+        MatrixXf matData;
+        VectorXi vecVertices;
+        float fTmin, fTstep;
+        QFile t_fileFloat(sFile);
+        QVERIFY(!MNESourceEstimate::readFloat(t_fileFloat, matData, vecVertices, fTmin, fTstep));
+
+        // The window at the end of the file is missing in all truncated files
+        MNESourceEstimate stcWindow;
+        QFile t_fileWindow(sFile);
+        QVERIFY(!MNESourceEstimate::readTimeWindow(t_fileWindow, m_matData.cols() - 1, 1, stcWindow));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::rejectCorruptVertexCount()
+{
+    const QString sFile = m_tempDir.path() + "/corrupt-lh.stc";
+    QVERIFY(copyFile(m_sStcFile, sFile));
+
+    // Replace the vertex count, the third header entry, by a count far beyond the file size
+    QFile t_file(sFile);
+    QVERIFY(t_file.open(QIODevice::ReadWrite));
+    QDataStream t_stream(&t_file);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+    t_file.seek(8);
+    t_stream << static_cast<quint32>(0x7fffffff);
+    t_file.close();
+
+    MNESourceEstimate stc;
+    QFile t_fileRead(sFile);
+    QVERIFY(!MNESourceEstimate::read(t_fileRead, stc));
+
+    MatrixXf matData;
+    VectorXi vecVertices;
+    float fTmin, fTstep;
+    QFile t_fileFloat(sFile);
+    QVERIFY(!MNESourceEstimate::readFloat(t_fileFloat, matData, vecVertices, fTmin, fTstep));
+    QVERIFY(vecVertices.size() == 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSourceEstimateIo::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+bool TestMneSourceEstimateIo::copyFile(const QString& sFrom, const QString& sTo, qint64 iSize)
+{
+    QFile t_fileFrom(sFrom);
+    QFile t_fileTo(sTo);
+
+    if(!t_fileFrom.open(QIODevice::ReadOnly) || !t_fileTo.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    const QByteArray data = iSize < 0 ? t_fileFrom.readAll() : t_fileFrom.read(iSize);
+
+    return t_fileTo.write(data) == data.size();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneSourceEstimateIo)
+#include "test_mne_sourceestimate_io.moc"
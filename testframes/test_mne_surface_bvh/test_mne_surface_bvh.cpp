@@ -0,0 +1,296 @@
+//=============================================================================================================
+/**
+* @file     test_mne_surface_bvh.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The surface bounding volume hierarchy unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_file.h>
+#include <mne/c/mne_surface_old.h>
+#include <mne/c/mne_surface_bvh.h>
+#include <mne/c/mne_triangle.h>
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneSurfaceBvh
+*
+* @brief The TestMneSurfaceBvh class compares the hierarchical inside and closest vertex queries on the inner skull
+* surface with the exact solid angle sum and a scan over all vertices
+*
+*/
+class TestMneSurfaceBvh: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneSurfaceBvh();
+
+private slots:
+    void initTestCase();
+    void compareIsInside();
+    void compareSumSolids();
+    void compareClosestVertex();
+    void compareClosestVertexLimit();
+    void cleanupTestCase();
+
+private:
+    float closestVertex(int iPoint, int& iNearest) const;
+
+    double epsilon;
+
+    MneSurfaceOld*              m_pSurf;        /**< The inner skull surface. */
+    MneSurfaceBvh*              m_pBvh;         /**< The hierarchy over m_pSurf. */
+    Matrix<float, 3, Dynamic>   m_matPoints;    /**< Test points, near the surface and spread over its bounding box. */
+    VectorXd                    m_vecSolids;    /**< Exact solid angle sums at the test points. */
+};
+
+
+//*************************************************************************************************************
+
+TestMneSurfaceBvh::TestMneSurfaceBvh()
+: epsilon(0.000001)
+, m_pSurf(NULL)
+, m_pBvh(NULL)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    m_pSurf = MneSurfaceOld::read_bem_surface("./mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif", FIFFV_BEM_SURF_ID_BRAIN, FALSE, NULL);
+    QVERIFY(m_pSurf != NULL);
+    QVERIFY(m_pSurf->ntri > 0);
+
+    m_pBvh = new MneSurfaceBvh(m_pSurf);
+
+    //Points 0.5 to 4 mm in front of and behind every 10th triangle
+    float offsets[] = {0.0005f, 0.001f, 0.002f, 0.004f};
+    int iNumOffsets = sizeof(offsets)/sizeof(float);
+    int iNumNear = 2 * iNumOffsets * ((m_pSurf->ntri + 9) / 10);
+    int iNumSpread = 500;
+
+    m_matPoints.resize(3, iNumNear + iNumSpread);
+
+    int iPoint = 0;
+    for(int k = 0; k < m_pSurf->ntri; k += 10) {
+        MneTriangle* tri = m_pSurf->tris + k;
+        Vector3f r1 = Map<Vector3f>(tri->r1);
+        Vector3f r2 = Map<Vector3f>(tri->r2);
+        Vector3f r3 = Map<Vector3f>(tri->r3);
+        Vector3f cent = (r1 + r2 + r3) / 3.0f;
+        Vector3f nn = (r2 - r1).cross(r3 - r1).normalized();
+
+        for(int j = 0; j < iNumOffsets; ++j) {
+            m_matPoints.col(iPoint++) = cent + offsets[j] * nn;
+            m_matPoints.col(iPoint++) = cent - offsets[j] * nn;
+        }
+    }
+
+    //Points spread over the bounding box, enlarged by 1 cm
+    Vector3f bmin = Map<Vector3f>(m_pSurf->rr[0]);
+    Vector3f bmax = bmin;
+    for(int k = 1; k < m_pSurf->np; ++k) {
+        bmin = bmin.cwiseMin(Map<Vector3f>(m_pSurf->rr[k]));
+        bmax = bmax.cwiseMax(Map<Vector3f>(m_pSurf->rr[k]));
+    }
+    bmin.array() -= 0.01f;
+    bmax.array() += 0.01f;
+
+    std::srand(5);
+    for(int k = 0; k < iNumSpread; ++k) {
+        Vector3f t = (Vector3f::Random().array() + 1.0f) / 2.0f;
+        m_matPoints.col(iPoint++) = bmin + t.cwiseProduct(bmax - bmin);
+    }
+
+    QCOMPARE(iPoint, int(m_matPoints.cols()));
+
+    m_vecSolids.resize(m_matPoints.cols());
+    for(int k = 0; k < m_matPoints.cols(); ++k) {
+        m_vecSolids(k) = MneSurfaceOrVolume::sum_solids(m_matPoints.col(k).data(), m_pSurf);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareIsInside()
+{
+    //Same criterion as the filter used with the exact sum
+    int iInside = 0;
+    for(int k = 0; k < m_matPoints.cols(); ++k) {
+        bool bInside = std::fabs(m_vecSolids(k) / (4 * M_PI) - 1.0) <= 1e-5;
+        QCOMPARE(m_pBvh->is_inside(m_matPoints.col(k).data()), bInside);
+        iInside += bInside ? 1 : 0;
+    }
+
+    //Both sides are covered
+    QVERIFY(iInside > 0);
+    QVERIFY(iInside < m_matPoints.cols());
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareSumSolids()
+{
+    //The far field approximation stays within a few percent of 4 pi
+    for(int k = 0; k < m_matPoints.cols(); ++k) {
+        QVERIFY(std::fabs(m_pBvh->sum_solids(m_matPoints.col(k).data()) - m_vecSolids(k)) <= 0.05 * 4 * M_PI);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareClosestVertex()
+{
+    //A limit beyond every point returns the closest vertex itself
+    for(int k = 0; k < m_matPoints.cols(); ++k) {
+        int iRefNearest;
+        float fRefDist = closestVertex(k, iRefNearest);
+
+        int iNearest;
+        float fDist = m_pBvh->closest_vertex(m_matPoints.col(k).data(), 1.0f, &iNearest);
+
+        QCOMPARE(iNearest, iRefNearest);
+        QVERIFY(std::fabs(fDist - fRefDist) <= epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::compareClosestVertexLimit()
+{
+    //The limit which the source space filter uses
+    float fLimit = 0.005f;
+    int iCloser = 0;
+
+    for(int k = 0; k < m_matPoints.cols(); ++k) {
+        int iRefNearest;
+        float fRefDist = closestVertex(k, iRefNearest);
+
+        int iNearest;
+        float fDist = m_pBvh->closest_vertex(m_matPoints.col(k).data(), fLimit, &iNearest);
+
+        if(fRefDist < fLimit) {
+            QCOMPARE(iNearest, iRefNearest);
+            QVERIFY(std::fabs(fDist - fRefDist) <= epsilon);
+            ++iCloser;
+        } else {
+            QCOMPARE(iNearest, -1);
+            QCOMPARE(fDist, fLimit);
+        }
+    }
+
+    QVERIFY(iCloser > 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneSurfaceBvh::cleanupTestCase()
+{
+    delete m_pBvh;
+    delete m_pSurf;
+}
+
+
+//*************************************************************************************************************
+
+float TestMneSurfaceBvh::closestVertex(int iPoint, int& iNearest) const
+{
+    //Scan over all vertices, the first one wins on ties
+    float fMinDist = 1.0f;
+    iNearest = -1;
+
+    for(int p = 0; p < m_pSurf->np; ++p) {
+        float diff[3];
+        for(int c = 0; c < 3; ++c) {
+            diff[c] = m_pSurf->rr[p][c] - m_matPoints(c, iPoint);
+        }
+        float fDist = sqrt(diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2]);
+        if(fDist < fMinDist) {
+            fMinDist = fDist;
+            iNearest = p;
+        }
+    }
+
+    return fMinDist;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneSurfaceBvh)
+#include "test_mne_surface_bvh.moc"
@@ -0,0 +1,361 @@
+//=============================================================================================================
+/**
+* @file     test_rt_source_data_worker.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The real-time source data worker unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <disp3D/engine/model/workers/rtSourceLoc/rtsourcedataworker.h>
+#include <disp/plots/helpers/colormap.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QVector3D>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace DISPLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+const double THRESHOLD_X = 0.1;      /**< Lower threshold, smaller values keep the original color. */
+const double THRESHOLD_Z = 1.0;      /**< Upper threshold, larger values get the last color. */
+const int LUT_STEPS = 1023;          /**< Number of steps of the color look up table of the worker. */
+
+//=============================================================================================================
+/**
+* Worker whose playback is driven by a fixed number of due samples per call instead of the wall clock.
+*/
+class SteppedSourceDataWorker : public RtSourceDataWorker
+{
+public:
+    SteppedSourceDataWorker() : m_iDue(1) {}
+
+    int m_iDue;     /**< Number of samples which are due on every call to streamData. */
+
+protected:
+    int samplesDue()
+    {
+        return m_iDue;
+    }
+};
+
+//=============================================================================================================
+/**
+* Color of a normalized value, as the per-vertex ColorMap path computed it.
+*/
+Vector3f hotColor(double dValue)
+{
+    QRgb qRgb = ColorMap::valueToHot(qBound(0.0, dValue, 1.0));
+    return Vector3f(qRed(qRgb)/255.0f, qGreen(qRgb)/255.0f, qBlue(qRgb)/255.0f);
+}
+
+} // NAMESPACE
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtSourceDataWorker
+*
+* @brief The TestRtSourceDataWorker class streams known source data through the RtSourceDataWorker and checks the
+* emitted frames and vertex colors
+*
+*/
+class TestRtSourceDataWorker: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtSourceDataWorker();
+
+private slots:
+    void initTestCase();
+    void compareSingleSampleFrames();
+    void compareLatestFrame();
+    void compareLatestFrameAcrossLoopEnd();
+    void cleanupTestCase();
+
+private:
+    void compareScenario(int iNumAvr, int iDue, int iCalls);
+    QList<VectorXd> expectedFrames(int iNumAvr, int iDue, int iCalls) const;
+    void setupWorker(SteppedSourceDataWorker& worker, bool bSmoothed, int iNumAvr, int iDue) const;
+    void compareColors(const MatrixX3f& matColors, const SparseMatrix<float>& matInterpolation, const VectorXd& vecSources) const;
+
+    double epsilon;
+
+    MatrixXd m_matData;                                     /**< The streamed source data <n_sources x n_samples>. */
+    QSharedPointer<SparseMatrix<float> > m_pMatInterLeft;   /**< Interpolation matrix of the left hemisphere. */
+    QSharedPointer<SparseMatrix<float> > m_pMatInterRight;  /**< Interpolation matrix of the right hemisphere. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtSourceDataWorker::TestRtSourceDataWorker()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    //Two sources on the left, three on the right, every sample different, values below and above the thresholds
+    m_matData.resize(5, 30);
+    for(int r = 0; r < m_matData.rows(); ++r) {
+        for(int s = 0; s < m_matData.cols(); ++s) {
+            m_matData(r,s) = (r % 2 == 0 ? 1.0 : -1.0) * 0.04 * (s + 1) * (1.0 + 0.2 * r);
+        }
+    }
+
+    QList<Triplet<float> > lTripletsLeft;
+    lTripletsLeft << Triplet<float>(0, 0, 1.0f) << Triplet<float>(1, 1, 1.0f)
+                  << Triplet<float>(2, 0, 0.5f) << Triplet<float>(2, 1, 0.5f)
+                  << Triplet<float>(3, 0, 0.9f) << Triplet<float>(3, 1, 0.1f)
+                  << Triplet<float>(4, 0, 0.2f) << Triplet<float>(5, 1, 0.7f);
+    m_pMatInterLeft = QSharedPointer<SparseMatrix<float> >(new SparseMatrix<float>(6, 2));
+    m_pMatInterLeft->setFromTriplets(lTripletsLeft.begin(), lTripletsLeft.end());
+
+    QList<Triplet<float> > lTripletsRight;
+    lTripletsRight << Triplet<float>(0, 0, 1.0f) << Triplet<float>(1, 1, 0.6f)
+                   << Triplet<float>(1, 2, 0.4f) << Triplet<float>(2, 2, 1.0f)
+                   << Triplet<float>(3, 0, 0.3f) << Triplet<float>(3, 1, 0.3f) << Triplet<float>(3, 2, 0.3f);
+    m_pMatInterRight = QSharedPointer<SparseMatrix<float> >(new SparseMatrix<float>(4, 3));
+    m_pMatInterRight->setFromTriplets(lTripletsRight.begin(), lTripletsRight.end());
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::compareSingleSampleFrames()
+{
+    //Every sample is a frame, the queue is streamed and then looped twice
+    compareScenario(1, 1, 90);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::compareLatestFrame()
+{
+    //Seven samples are due per call, so frames of four samples are dropped in between
+    compareScenario(4, 7, 16);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::compareLatestFrameAcrossLoopEnd()
+{
+    //The loop length is no multiple of the frame length, so frames span the end of the loop
+    compareScenario(7, 11, 20);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::compareScenario(int iNumAvr, int iDue, int iCalls)
+{
+    QList<VectorXd> lExpected = expectedFrames(iNumAvr, iDue, iCalls);
+    QVERIFY(!lExpected.isEmpty());
+
+    //Raw streaming emits the averaged frame itself
+    SteppedSourceDataWorker rawWorker;
+    setupWorker(rawWorker, false, iNumAvr, iDue);
+
+    QList<VectorXd> lRawFrames;
+    connect(&rawWorker, &RtSourceDataWorker::newRtRawData,
+            [&lRawFrames](const VectorXd& vecLeft, const VectorXd& vecRight) {
+                VectorXd vecFrame(vecLeft.size() + vecRight.size());
+                vecFrame << vecLeft, vecRight;
+                lRawFrames << vecFrame;
+            });
+
+    for(int i = 0; i < iCalls; ++i) {
+        rawWorker.streamData();
+    }
+
+    QCOMPARE(lRawFrames.size(), lExpected.size());
+    for(int i = 0; i < lExpected.size(); ++i) {
+        QVERIFY((lRawFrames[i] - lExpected[i]).cwiseAbs().maxCoeff() <= epsilon);
+    }
+
+    //Smoothed streaming emits the colors of the same frames
+    SteppedSourceDataWorker smoothedWorker;
+    setupWorker(smoothedWorker, true, iNumAvr, iDue);
+
+    QList<QPair<MatrixX3f, MatrixX3f> > lColors;
+    connect(&smoothedWorker, &RtSourceDataWorker::newRtSmoothedData,
+            [&lColors](const MatrixX3f& matLeft, const MatrixX3f& matRight) {
+                lColors << qMakePair(matLeft, matRight);
+            });
+
+    for(int i = 0; i < iCalls; ++i) {
+        smoothedWorker.streamData();
+    }
+
+    QCOMPARE(lColors.size(), lExpected.size());
+    for(int i = 0; i < lExpected.size(); ++i) {
+        compareColors(lColors[i].first, *m_pMatInterLeft, lExpected[i].head(2));
+        compareColors(lColors[i].second, *m_pMatInterRight, lExpected[i].tail(3));
+    }
+}
+
+
+//*************************************************************************************************************
+
+QList<VectorXd> TestRtSourceDataWorker::expectedFrames(int iNumAvr, int iDue, int iCalls) const
+{
+    //The queue is streamed once, then the loop data repeats it. Whenever frames were completed by a call, the
+    //latest of them is emitted.
+    const int iCols = m_matData.cols();
+    QList<VectorXd> lFrames;
+    int iQueuePos = 0;
+    int iLoopPos = 0;
+
+    for(int i = 0; i < iCalls; ++i) {
+        int iStart = -1;
+
+        if(iQueuePos < iCols) {
+            int iNewPos = qMin(iQueuePos + iDue, iCols);
+            if(iNewPos / iNumAvr > iQueuePos / iNumAvr) {
+                iStart = (iNewPos / iNumAvr - 1) * iNumAvr;
+            }
+            iQueuePos = iNewPos;
+        } else {
+            int iNewPos = iLoopPos + iDue;
+            if(iNewPos / iNumAvr > iLoopPos / iNumAvr) {
+                iStart = ((iNewPos / iNumAvr - 1) * iNumAvr) % iCols;
+            }
+            iLoopPos = iNewPos;
+        }
+
+        if(iStart >= 0) {
+            VectorXd vecFrame = VectorXd::Zero(m_matData.rows());
+            for(int j = 0; j < iNumAvr; ++j) {
+                vecFrame += m_matData.col((iStart + j) % iCols);
+            }
+            lFrames << vecFrame / iNumAvr;
+        }
+    }
+
+    return lFrames;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::setupWorker(SteppedSourceDataWorker& worker, bool bSmoothed, int iNumAvr, int iDue) const
+{
+    worker.m_iDue = iDue;
+    worker.setLoopState(true);
+    worker.setStreamSmoothedData(bSmoothed);
+    worker.setNumberVertices(m_pMatInterLeft->rows(), m_pMatInterRight->rows());
+    worker.setInterpolationMatrixLeft(m_pMatInterLeft);
+    worker.setInterpolationMatrixRight(m_pMatInterRight);
+    worker.setThresholds(QVector3D(THRESHOLD_X, (THRESHOLD_X + THRESHOLD_Z) / 2.0, THRESHOLD_Z));
+    worker.setNumberAverages(iNumAvr);
+    worker.addData(m_matData);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSourceDataWorker::compareColors(const MatrixX3f& matColors, const SparseMatrix<float>& matInterpolation, const VectorXd& vecSources) const
+{
+    VectorXf vecValues = matInterpolation * vecSources.cast<float>();
+
+    QCOMPARE(matColors.rows(), vecValues.rows());
+
+    for(int r = 0; r < vecValues.rows(); ++r) {
+        double dSample = std::fabs(vecValues(r));
+
+        //Below the lower threshold the original color (black) stays
+        if(dSample < THRESHOLD_X) {
+            QVERIFY(matColors.row(r).isZero());
+            continue;
+        }
+
+        double dNorm = dSample >= THRESHOLD_Z ? 1.0 : (dSample - THRESHOLD_X) / (THRESHOLD_Z - THRESHOLD_X);
+        Vector3f vecRef = hotColor(dNorm);
+
+        //The look up table rounds to the closest of its entries
+        float fTol = qMax((hotColor(dNorm - 1.0 / LUT_STEPS) - vecRef).cwiseAbs().maxCoeff(),
+                          (hotColor(dNorm + 1.0 / LUT_STEPS) - vecRef).cwiseAbs().maxCoeff()) + 1.0f / 255.0f;
+
+        QVERIFY((matColors.row(r).transpose() - vecRef).cwiseAbs().maxCoeff() <= fTol);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtSourceDataWorker)
+#include "test_rt_source_data_worker.moc"
@@ -0,0 +1,295 @@
+//=============================================================================================================
+/**
+* @file     test_rt_welch_psd.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The streaming Welch PSD unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <rtprocessing/rtwelchpsd.h>
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtWelchPsd
+*
+* @brief The TestRtWelchPsd class compares the streamed Welch PSD with a direct computation over the whole data,
+* for several overlaps and with segments which span the appended blocks
+*
+*/
+class TestRtWelchPsd: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtWelchPsd();
+
+private slots:
+    void initTestCase();
+    void compareNoOverlap();
+    void compareHalfOverlap();
+    void compareOddLengthOverlap();
+    void compareClearAverage();
+    void compareFrequencies();
+    void cleanupTestCase();
+
+private:
+    void compareStreamed(int iFFTLength, double dOverlap);
+    int appendInBlocks(RtWelchPsd& welch, const MatrixXd& matData) const;
+    MatrixXd directWelch(const MatrixXd& matData, int iFFTLength, int iStep, int iFirstSegment) const;
+    void compareMatrices(const MatrixXd& matResult, const MatrixXd& matReference) const;
+
+    double epsilon;
+
+    double m_dSFreq;        /**< Sampling frequency. */
+    MatrixXd m_matData;     /**< The test data, more channels than one worker chunk holds. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtWelchPsd::TestRtWelchPsd()
+: epsilon(0.000001)
+, m_dSFreq(1000.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    //Noise with a different sine on every channel
+    std::srand(3);
+    m_matData = MatrixXd::Random(20, 3000);
+    RowVectorXd vecTime = RowVectorXd::LinSpaced(m_matData.cols(), 0, m_matData.cols() - 1) / m_dSFreq;
+    for(int i = 0; i < m_matData.rows(); ++i) {
+        m_matData.row(i) += (5.0 * (2.0 * M_PI * (10.0 + 7.0 * i) * vecTime).array().sin()).matrix();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareNoOverlap()
+{
+    compareStreamed(256, 0.0);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareHalfOverlap()
+{
+    compareStreamed(256, 0.5);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareOddLengthOverlap()
+{
+    //No Nyquist bin for odd lengths
+    compareStreamed(201, 0.75);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareClearAverage()
+{
+    //The average restarts, the partial segment at the clear is completed with the following samples
+    int iFFTLength = 256;
+    int iStep = iFFTLength - qRound(0.5 * iFFTLength);
+    int iSplit = 1300;
+
+    RtWelchPsd welch(m_matData.rows(), iFFTLength, m_dSFreq, 0.5);
+    appendInBlocks(welch, m_matData.leftCols(iSplit));
+    welch.clearAverage();
+    QCOMPARE(welch.segmentCount(), 0);
+
+    appendInBlocks(welch, m_matData.rightCols(m_matData.cols() - iSplit));
+
+    //First segment which ends after the split
+    int iFirstSegment = (iSplit - iFFTLength) / iStep + 1;
+    int iSegments = (m_matData.cols() - iFFTLength) / iStep + 1 - iFirstSegment;
+    QCOMPARE(welch.segmentCount(), iSegments);
+
+    compareMatrices(welch.psd(), directWelch(m_matData, iFFTLength, iStep, iFirstSegment));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareFrequencies()
+{
+    RtWelchPsd welch(1, 256, m_dSFreq);
+    RowVectorXd vecFreqs = welch.frequencies();
+
+    QCOMPARE(int(vecFreqs.size()), 129);
+    QVERIFY(std::fabs(vecFreqs(0)) <= epsilon);
+    QVERIFY(std::fabs(vecFreqs(128) - m_dSFreq / 2.0) <= epsilon);
+
+    //No complete segment yet
+    QVERIFY(welch.psd().isZero());
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareStreamed(int iFFTLength, double dOverlap)
+{
+    int iStep = iFFTLength - qRound(dOverlap * iFFTLength);
+    int iSegments = (m_matData.cols() - iFFTLength) / iStep + 1;
+
+    RtWelchPsd welch(m_matData.rows(), iFFTLength, m_dSFreq, dOverlap);
+
+    QCOMPARE(appendInBlocks(welch, m_matData), iSegments);
+    QCOMPARE(welch.segmentCount(), iSegments);
+
+    compareMatrices(welch.psd(), directWelch(m_matData, iFFTLength, iStep, 0));
+}
+
+
+//*************************************************************************************************************
+
+int TestRtWelchPsd::appendInBlocks(RtWelchPsd& welch, const MatrixXd& matData) const
+{
+    //Block sizes which do not divide the segment step, so segments span several blocks
+    int blockSizes[] = {37, 150, 1, 523, 64};
+    int iNumBlockSizes = sizeof(blockSizes)/sizeof(int);
+
+    int iCompleted = 0;
+    int iAppended = 0;
+    for(int k = 0; iAppended < matData.cols(); ++k) {
+        int iBlock = qMin(blockSizes[k % iNumBlockSizes], int(matData.cols()) - iAppended);
+        iCompleted += welch.append(matData.middleCols(iAppended, iBlock));
+        iAppended += iBlock;
+    }
+
+    return iCompleted;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtWelchPsd::directWelch(const MatrixXd& matData, int iFFTLength, int iStep, int iFirstSegment) const
+{
+    int iBins = iFFTLength / 2 + 1;
+
+    RowVectorXd vecWindow(iFFTLength);
+    RowVectorXd vecCos(iFFTLength), vecSin(iFFTLength);
+    for(int i = 0; i < iFFTLength; ++i) {
+        vecWindow(i) = 0.5 * (1.0 - cos(2.0 * M_PI * (i + 1) / (iFFTLength + 1)));
+        vecCos(i) = cos(2.0 * M_PI * i / iFFTLength);
+        vecSin(i) = sin(2.0 * M_PI * i / iFFTLength);
+    }
+
+    //Periodograms by a direct DFT of every windowed segment
+    MatrixXd matPsd = MatrixXd::Zero(matData.rows(), iBins);
+    int iSegments = 0;
+    for(int iStart = iFirstSegment * iStep; iStart + iFFTLength <= matData.cols(); iStart += iStep, ++iSegments) {
+        for(int c = 0; c < matData.rows(); ++c) {
+            RowVectorXd vecSegment = matData.row(c).segment(iStart, iFFTLength).cwiseProduct(vecWindow);
+            for(int f = 0; f < iBins; ++f) {
+                double dRe = 0.0, dIm = 0.0;
+                for(int n = 0; n < iFFTLength; ++n) {
+                    int iPhase = (f * n) % iFFTLength;
+                    dRe += vecSegment(n) * vecCos(iPhase);
+                    dIm -= vecSegment(n) * vecSin(iPhase);
+                }
+                matPsd(c, f) += dRe * dRe + dIm * dIm;
+            }
+        }
+    }
+
+    //One-sided density, DC and Nyquist are not doubled
+    RowVectorXd vecScale = RowVectorXd::Constant(iBins, 2.0 / (m_dSFreq * vecWindow.squaredNorm() * iSegments));
+    vecScale(0) *= 0.5;
+    if(iFFTLength % 2 == 0) {
+        vecScale(iBins - 1) *= 0.5;
+    }
+
+    return matPsd.array().rowwise() * vecScale.array();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtWelchPsd::compareMatrices(const MatrixXd& matResult, const MatrixXd& matReference) const
+{
+    QCOMPARE(matResult.rows(), matReference.rows());
+    QCOMPARE(matResult.cols(), matReference.cols());
+    QVERIFY((matResult - matReference).cwiseAbs().maxCoeff() <= epsilon * matReference.cwiseAbs().maxCoeff());
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtWelchPsd)
+#include "test_rt_welch_psd.moc"
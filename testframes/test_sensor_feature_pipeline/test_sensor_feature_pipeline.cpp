@@ -0,0 +1,253 @@
+//=============================================================================================================
+/**
+* @file     test_sensor_feature_pipeline.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2017
+*
+* @section  LICENSE
+*
+* Copyright (C) 2017, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    The sensor feature pipeline unit test
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/sensorfeaturepipeline.h>
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestSensorFeaturePipeline
+*
+* @brief The TestSensorFeaturePipeline class feeds blocks shorter and longer than the sliding window through the
+* SensorFeaturePipeline and compares its windows and features with a direct computation over the whole stream
+*
+*/
+class TestSensorFeaturePipeline: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSensorFeaturePipeline();
+
+private slots:
+    void initTestCase();
+    void compareMixedBlocks();
+    void compareLongBlocks();
+    void cleanupTestCase();
+
+private:
+    void setupPipeline(SensorFeaturePipeline& pipeline) const;
+    void compareWindows(const SensorFeaturePipeline& pipeline, int iSamplesPushed) const;
+    void compareMatrices(const MatrixXd& matResult, const MatrixXd& matReference) const;
+
+    double epsilon;
+
+    QVector<int> m_vecPicks;        /**< Picked rows. */
+    int m_iDecimation;              /**< Decimation step. */
+    int m_iWindowLength;            /**< Window length in decimated samples. */
+    RowVectorXd m_vecCoeffs;        /**< FIR taps. */
+
+    MatrixXd m_matData;             /**< The whole input stream. */
+    MatrixXd m_matRefPicked;        /**< Picked and decimated stream. */
+    MatrixXd m_matRefFiltered;      /**< Filtered picked and decimated stream. */
+};
+
+
+//*************************************************************************************************************
+
+TestSensorFeaturePipeline::TestSensorFeaturePipeline()
+: epsilon(0.000001)
+, m_iDecimation(3)
+, m_iWindowLength(50)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    std::srand(7);
+    m_matData = MatrixXd::Random(8, 3000);
+    m_vecPicks << 3 << 0 << 5;
+    m_vecCoeffs = RowVectorXd::Random(11);
+
+    //Reference: pick and decimate the whole stream, then convolve with zero initial history
+    int iKept = (m_matData.cols() + m_iDecimation - 1) / m_iDecimation;
+    m_matRefPicked.resize(m_vecPicks.size(), iKept);
+    for(int i = 0; i < m_vecPicks.size(); ++i) {
+        for(int j = 0; j < iKept; ++j) {
+            m_matRefPicked(i, j) = m_matData(m_vecPicks[i], j * m_iDecimation);
+        }
+    }
+
+    m_matRefFiltered = MatrixXd::Zero(m_matRefPicked.rows(), iKept);
+    for(int j = 0; j < iKept; ++j) {
+        for(int t = 0; t < m_vecCoeffs.size() && t <= j; ++t) {
+            m_matRefFiltered.col(j) += m_vecCoeffs(t) * m_matRefPicked.col(j - t);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::compareMixedBlocks()
+{
+    //Decimated, the 173 and 400 sample blocks are longer than the window
+    int blockSizes[] = {40, 173, 1, 400, 17, 95, 2};
+    int iNumBlockSizes = sizeof(blockSizes)/sizeof(int);
+
+    SensorFeaturePipeline pipeline;
+    setupPipeline(pipeline);
+
+    int iPushed = 0;
+    for(int k = 0; iPushed < m_matData.cols(); ++k) {
+        int iBlock = qMin(blockSizes[k % iNumBlockSizes], int(m_matData.cols()) - iPushed);
+        pipeline.push(m_matData.middleCols(iPushed, iBlock));
+        iPushed += iBlock;
+
+        compareWindows(pipeline, iPushed);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::compareLongBlocks()
+{
+    //Every block spans many windows, the ring wraps several times per block
+    int iBlock = 1000;
+
+    SensorFeaturePipeline pipeline;
+    setupPipeline(pipeline);
+
+    VectorXd vecWeights = VectorXd::LinSpaced(m_vecPicks.size(), 1.0, 2.0);
+    pipeline.setClassifier(0.5, vecWeights);
+
+    MatrixXd matRefFeatures(m_vecPicks.size(), m_matData.cols() / iBlock);
+
+    for(int k = 0; k < matRefFeatures.cols(); ++k) {
+        pipeline.push(m_matData.middleCols(k * iBlock, iBlock));
+        compareWindows(pipeline, (k + 1) * iBlock);
+
+        VectorXd vecFeatures = pipeline.computeFeatures();
+        MatrixXd matWindow = pipeline.filteredWindow();
+        matRefFeatures.col(k) = (matWindow.colwise() - matWindow.rowwise().mean()).rowwise().squaredNorm();
+        compareMatrices(vecFeatures, matRefFeatures.col(k));
+    }
+
+    QCOMPARE(pipeline.featureCount(), int(matRefFeatures.cols()));
+
+    VectorXd vecRefScores = (matRefFeatures.transpose() * vecWeights).array() + 0.5;
+    double dScore = pipeline.classify();
+    compareMatrices(pipeline.scores(), vecRefScores);
+    QVERIFY(std::fabs(dScore - vecRefScores.mean()) <= epsilon*qMax(1.0, std::fabs(vecRefScores.mean())));
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::setupPipeline(SensorFeaturePipeline& pipeline) const
+{
+    pipeline.setChannelPicks(m_vecPicks);
+    pipeline.setDecimation(m_iDecimation);
+    pipeline.setFilter(m_vecCoeffs);
+    pipeline.setWindowLength(m_iWindowLength);
+    pipeline.setFeatureCapacity(2);
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::compareWindows(const SensorFeaturePipeline& pipeline, int iSamplesPushed) const
+{
+    int iKept = (iSamplesPushed + m_iDecimation - 1) / m_iDecimation;
+
+    QCOMPARE(pipeline.isWindowFull(), iKept >= m_iWindowLength);
+
+    if(!pipeline.isWindowFull()) {
+        //The newest samples are at the end of the window
+        compareMatrices(pipeline.rawWindow().rightCols(iKept), m_matRefPicked.leftCols(iKept));
+        compareMatrices(pipeline.filteredWindow().rightCols(iKept), m_matRefFiltered.leftCols(iKept));
+        return;
+    }
+
+    compareMatrices(pipeline.rawWindow(), m_matRefPicked.middleCols(iKept - m_iWindowLength, m_iWindowLength));
+    compareMatrices(pipeline.filteredWindow(), m_matRefFiltered.middleCols(iKept - m_iWindowLength, m_iWindowLength));
+}
+
+
+//*************************************************************************************************************
+
+void TestSensorFeaturePipeline::compareMatrices(const MatrixXd& matResult, const MatrixXd& matReference) const
+{
+    QCOMPARE(matResult.rows(), matReference.rows());
+    QCOMPARE(matResult.cols(), matReference.cols());
+    QVERIFY((matResult - matReference).cwiseAbs().maxCoeff() <= epsilon);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestSensorFeaturePipeline)
+#include "test_sensor_feature_pipeline.moc"
@@ -46,12 +46,28 @@ SUBDIRS += \
     test_fiff_cov \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \
+    test_mne_epoch_tensor \
+    test_mne_chunked_sourceestimate \
+    test_mne_cluster_cache \
+    test_mne_proj_op \
+    test_fiff_raw_writer \
+    test_fiff_proj_comp_operator \
+    test_fiff_event_index \
+    test_epidetect_metrics \
+    test_sensor_feature_pipeline \
+    test_rt_welch_psd \
+    test_mne_surface_bvh \
+    test_mne_sourceestimate_io \
+    test_fast_kmeans \
+    test_adaptive_mp \
+    test_fs_surface_io \
 
 !contains(MNECPP_CONFIG, minimalVersion) {
     qtHaveModule(charts) {
         SUBDIRS += \
             test_interpolation \
             test_geometryinfo \
-            test_spectral_connectivity
+            test_spectral_connectivity \
+            test_rt_source_data_worker
     }
 }